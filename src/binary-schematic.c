@@ -0,0 +1,604 @@
+/*
+ * binary-schematic.c
+ *
+ *
+ * Authors:
+ *  Michi <st101564@stud.uni-stuttgart.de>
+ *
+ * Web page: https://ahoi.io/project/oregano
+ *
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+
+#include <string.h>
+#include <glib.h>
+#include <glib/gi18n.h>
+
+#include "binary-schematic.h"
+#include "oregano.h"
+#include "oregano-config.h"
+#include "load-common.h"
+#include "part.h"
+#include "part-private.h"
+#include "part-label.h"
+#include "wire.h"
+#include "textbox.h"
+#include "sim-settings.h"
+#include "sim-settings-gui.h"
+#include "errors.h"
+#include "engines/netlist-helper.h"
+
+static const gchar magic[8] = "OREGBIN";
+
+#define N_SECTIONS BINARY_SCHEMATIC_TEXTBOXES
+#define HEADER_LENGTH (sizeof(magic) + 2 * 4)
+#define SECTION_ENTRY_LENGTH (2 * 4 + 2 * 8)
+
+#define INFO_LENGTH (4 * 4)
+#define PART_LENGTH (10 * 4 + 2 * 8)
+#define PROPERTY_LENGTH (2 * 4)
+#define LABEL_LENGTH (2 * 4 + 2 * 8)
+#define WIRE_LENGTH (4 * 8)
+#define TEXTBOX_LENGTH (2 * 4 + 2 * 8)
+
+// index of a string that was NULL
+#define NO_STRING G_MAXUINT32
+
+static const gsize record_lengths[N_SECTIONS + 1] = {
+    [BINARY_SCHEMATIC_STRINGS] = 0,          [BINARY_SCHEMATIC_INFO] = INFO_LENGTH,
+    [BINARY_SCHEMATIC_SIMULATION] = 1,       [BINARY_SCHEMATIC_PARTS] = PART_LENGTH,
+    [BINARY_SCHEMATIC_PROPERTIES] = PROPERTY_LENGTH, [BINARY_SCHEMATIC_LABELS] = LABEL_LENGTH,
+    [BINARY_SCHEMATIC_WIRES] = WIRE_LENGTH,  [BINARY_SCHEMATIC_TEXTBOXES] = TEXTBOX_LENGTH,
+};
+
+/**
+ * Writer
+ */
+
+typedef struct
+{
+	GByteArray *sections[N_SECTIONS + 1];
+	guint32 counts[N_SECTIONS + 1];
+
+	// string -> index + 1
+	GHashTable *string_ids;
+	GByteArray *string_data;
+} BinaryWriter;
+
+static void put_u32 (GByteArray *buffer, guint32 value)
+{
+	value = GUINT32_TO_LE (value);
+	g_byte_array_append (buffer, (const guint8 *)&value, sizeof(value));
+}
+
+static void put_u64 (GByteArray *buffer, guint64 value)
+{
+	value = GUINT64_TO_LE (value);
+	g_byte_array_append (buffer, (const guint8 *)&value, sizeof(value));
+}
+
+static void put_f64 (GByteArray *buffer, gdouble value)
+{
+	guint64 bits;
+
+	memcpy (&bits, &value, sizeof(bits));
+	put_u64 (buffer, bits);
+}
+
+static void put_padding (GByteArray *buffer)
+{
+	static const guint8 zeros[8] = {0};
+
+	g_byte_array_append (buffer, zeros, (8 - buffer->len % 8) % 8);
+}
+
+static guint32 writer_add_string (BinaryWriter *writer, const gchar *string)
+{
+	gpointer id;
+
+	if (string == NULL)
+		return NO_STRING;
+
+	id = g_hash_table_lookup (writer->string_ids, string);
+	if (id != NULL)
+		return GPOINTER_TO_UINT (id) - 1;
+
+	put_u32 (writer->sections[BINARY_SCHEMATIC_STRINGS], writer->string_data->len);
+	g_byte_array_append (writer->string_data, (const guint8 *)string, strlen (string) + 1);
+	g_hash_table_insert (writer->string_ids, g_strdup (string),
+	                     GUINT_TO_POINTER (++writer->counts[BINARY_SCHEMATIC_STRINGS]));
+
+	return writer->counts[BINARY_SCHEMATIC_STRINGS] - 1;
+}
+
+static void write_binary_part (Part *part, BinaryWriter *writer)
+{
+	GByteArray *buffer = writer->sections[BINARY_SCHEMATIC_PARTS];
+	GByteArray *properties = writer->sections[BINARY_SCHEMATIC_PROPERTIES];
+	GByteArray *labels = writer->sections[BINARY_SCHEMATIC_LABELS];
+	PartPriv *priv = part->priv;
+	guint32 first_property, first_label;
+	GSList *iter;
+	Coords pos;
+
+	first_property = writer->counts[BINARY_SCHEMATIC_PROPERTIES];
+	for (iter = priv->properties; iter; iter = iter->next) {
+		Property *property = iter->data;
+
+		put_u32 (properties, writer_add_string (writer, property->name));
+		put_u32 (properties, writer_add_string (writer, property->value));
+		writer->counts[BINARY_SCHEMATIC_PROPERTIES]++;
+	}
+
+	first_label = writer->counts[BINARY_SCHEMATIC_LABELS];
+	for (iter = priv->labels; iter; iter = iter->next) {
+		PartLabel *label = iter->data;
+
+		put_u32 (labels, writer_add_string (writer, label->name));
+		put_u32 (labels, writer_add_string (writer, label->text));
+		put_f64 (labels, label->pos.x);
+		put_f64 (labels, label->pos.y);
+		writer->counts[BINARY_SCHEMATIC_LABELS]++;
+	}
+
+	item_data_get_pos (ITEM_DATA (part), &pos);
+	put_u32 (buffer, writer_add_string (writer, priv->name));
+	put_u32 (buffer, writer_add_string (writer, priv->library ? priv->library->name : NULL));
+	put_u32 (buffer, writer_add_string (writer, priv->symbol_name));
+	put_u32 (buffer, (guint32)part_get_rotation (part));
+	put_u32 (buffer, priv->flip);
+	put_u32 (buffer, first_property);
+	put_u32 (buffer, writer->counts[BINARY_SCHEMATIC_PROPERTIES] - first_property);
+	put_u32 (buffer, first_label);
+	put_u32 (buffer, writer->counts[BINARY_SCHEMATIC_LABELS] - first_label);
+	put_u32 (buffer, 0);
+	put_f64 (buffer, pos.x);
+	put_f64 (buffer, pos.y);
+	writer->counts[BINARY_SCHEMATIC_PARTS]++;
+}
+
+static void write_binary_wire (Wire *wire, BinaryWriter *writer)
+{
+	GByteArray *buffer = writer->sections[BINARY_SCHEMATIC_WIRES];
+	Coords start_pos, end_pos;
+
+	wire_get_start_pos (wire, &start_pos);
+	wire_get_end_pos (wire, &end_pos);
+
+	put_f64 (buffer, start_pos.x);
+	put_f64 (buffer, start_pos.y);
+	put_f64 (buffer, end_pos.x);
+	put_f64 (buffer, end_pos.y);
+	writer->counts[BINARY_SCHEMATIC_WIRES]++;
+}
+
+static void write_binary_textbox (ItemData *data, BinaryWriter *writer)
+{
+	GByteArray *buffer = writer->sections[BINARY_SCHEMATIC_TEXTBOXES];
+	Coords pos;
+
+	if (!IS_TEXTBOX (data))
+		return;
+
+	item_data_get_pos (data, &pos);
+	put_u32 (buffer, writer_add_string (writer, textbox_get_text (TEXTBOX (data))));
+	put_u32 (buffer, 0);
+	put_f64 (buffer, pos.x);
+	put_f64 (buffer, pos.y);
+	writer->counts[BINARY_SCHEMATIC_TEXTBOXES]++;
+}
+
+static void write_binary_info (Schematic *sm, BinaryWriter *writer)
+{
+	GByteArray *buffer = writer->sections[BINARY_SCHEMATIC_INFO];
+	gchar *data;
+	gsize length;
+
+	put_u32 (buffer, writer_add_string (writer, schematic_get_author (sm)));
+	put_u32 (buffer, writer_add_string (writer, schematic_get_title (sm)));
+	put_u32 (buffer, writer_add_string (writer, schematic_get_version (sm)));
+	put_u32 (buffer, writer_add_string (writer, schematic_get_comments (sm)));
+	writer->counts[BINARY_SCHEMATIC_INFO] = 1;
+
+	data = sim_settings_to_data (schematic_get_sim_settings (sm), &length);
+	g_byte_array_append (writer->sections[BINARY_SCHEMATIC_SIMULATION], (const guint8 *)data,
+	                     length);
+	writer->counts[BINARY_SCHEMATIC_SIMULATION] = length;
+	g_free (data);
+}
+
+static GByteArray *write_binary_schematic (Schematic *sm)
+{
+	BinaryWriter writer = {{NULL}};
+	GByteArray *file;
+	gsize offset;
+	gint i;
+
+	for (i = 1; i <= N_SECTIONS; i++)
+		writer.sections[i] = g_byte_array_new ();
+	writer.string_ids = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+	writer.string_data = g_byte_array_new ();
+
+	write_binary_info (sm, &writer);
+	schematic_parts_foreach (sm, (ForeachItemDataFunc)write_binary_part, &writer);
+	schematic_wires_foreach (sm, (ForeachItemDataFunc)write_binary_wire, &writer);
+	schematic_items_foreach (sm, (ForeachItemDataFunc)write_binary_textbox, &writer);
+
+	// the offsets of the strings are followed by the strings
+	for (i = 0; i < writer.counts[BINARY_SCHEMATIC_STRINGS]; i++) {
+		guint32 *string_offset = (guint32 *)writer.sections[BINARY_SCHEMATIC_STRINGS]->data + i;
+		*string_offset = GUINT32_TO_LE (GUINT32_FROM_LE (*string_offset) +
+		                                writer.counts[BINARY_SCHEMATIC_STRINGS] * 4);
+	}
+	g_byte_array_append (writer.sections[BINARY_SCHEMATIC_STRINGS], writer.string_data->data,
+	                     writer.string_data->len);
+
+	file = g_byte_array_new ();
+	g_byte_array_append (file, (const guint8 *)magic, sizeof(magic));
+	put_u32 (file, BINARY_SCHEMATIC_VERSION);
+	put_u32 (file, N_SECTIONS);
+
+	offset = HEADER_LENGTH + N_SECTIONS * SECTION_ENTRY_LENGTH;
+	for (i = 1; i <= N_SECTIONS; i++) {
+		offset += (8 - offset % 8) % 8;
+		put_u32 (file, i);
+		put_u32 (file, writer.counts[i]);
+		put_u64 (file, offset);
+		put_u64 (file, writer.sections[i]->len);
+		offset += writer.sections[i]->len;
+	}
+
+	for (i = 1; i <= N_SECTIONS; i++) {
+		put_padding (file);
+		g_byte_array_append (file, writer.sections[i]->data, writer.sections[i]->len);
+		g_byte_array_unref (writer.sections[i]);
+	}
+
+	g_hash_table_unref (writer.string_ids);
+	g_byte_array_unref (writer.string_data);
+
+	return file;
+}
+
+gboolean schematic_write_binary (Schematic *sm, GError **error)
+{
+	GByteArray *file;
+	gboolean success;
+	char *filename;
+
+	g_return_val_if_fail (sm != NULL, FALSE);
+
+	filename = schematic_get_filename (sm);
+	if (filename == NULL) {
+		g_warning ("Schematic has no filename!!\n");
+		return FALSE;
+	}
+
+	file = write_binary_schematic (sm);
+	// written to a temporary file and renamed
+	success = g_file_set_contents (filename, (const gchar *)file->data, file->len, error);
+	g_byte_array_unref (file);
+
+	return success;
+}
+
+/**
+ * Reader
+ */
+
+typedef struct
+{
+	const guint8 *data[N_SECTIONS + 1];
+	guint32 counts[N_SECTIONS + 1];
+	gsize string_length;
+	gboolean failed;
+} BinaryReader;
+
+static guint32 get_u32 (const guint8 *data)
+{
+	guint32 value;
+
+	memcpy (&value, data, sizeof(value));
+	return GUINT32_FROM_LE (value);
+}
+
+static guint64 get_u64 (const guint8 *data)
+{
+	guint64 value;
+
+	memcpy (&value, data, sizeof(value));
+	return GUINT64_FROM_LE (value);
+}
+
+static gdouble get_f64 (const guint8 *data)
+{
+	guint64 bits = get_u64 (data);
+	gdouble value;
+
+	memcpy (&value, &bits, sizeof(value));
+	return value;
+}
+
+// points into the mapping of the file
+static gchar *reader_get_string (BinaryReader *reader, const guint8 *id_data)
+{
+	const guint8 *strings = reader->data[BINARY_SCHEMATIC_STRINGS];
+	guint32 id = get_u32 (id_data);
+	guint32 offset;
+
+	if (id == NO_STRING)
+		return NULL;
+
+	if (id >= reader->counts[BINARY_SCHEMATIC_STRINGS]) {
+		reader->failed = TRUE;
+		return NULL;
+	}
+
+	offset = get_u32 (strings + id * 4);
+	if (offset >= reader->string_length ||
+	    memchr (strings + offset, '\0', reader->string_length - offset) == NULL) {
+		reader->failed = TRUE;
+		return NULL;
+	}
+
+	return (gchar *)strings + offset;
+}
+
+static gboolean reader_init (BinaryReader *reader, const guint8 *data, gsize length)
+{
+	guint32 version, n_sections, kind, count;
+	guint64 offset, section_length;
+	const guint8 *entry;
+	guint32 i;
+
+	if (length < HEADER_LENGTH || memcmp (data, magic, sizeof(magic)) != 0)
+		return FALSE;
+
+	version = get_u32 (data + sizeof(magic));
+	n_sections = get_u32 (data + sizeof(magic) + 4);
+	if (version != BINARY_SCHEMATIC_VERSION ||
+	    n_sections > (length - HEADER_LENGTH) / SECTION_ENTRY_LENGTH)
+		return FALSE;
+
+	for (i = 0; i < n_sections; i++) {
+		entry = data + HEADER_LENGTH + i * SECTION_ENTRY_LENGTH;
+		kind = get_u32 (entry);
+		count = get_u32 (entry + 4);
+		offset = get_u64 (entry + 8);
+		section_length = get_u64 (entry + 16);
+
+		if (offset > length || section_length > length - offset)
+			return FALSE;
+		if (kind == 0 || kind > N_SECTIONS)
+			continue;
+
+		if (kind == BINARY_SCHEMATIC_STRINGS) {
+			if (count > section_length / 4)
+				return FALSE;
+			reader->string_length = section_length;
+		} else if (count > section_length / record_lengths[kind]) {
+			return FALSE;
+		}
+
+		reader->data[kind] = data + offset;
+		reader->counts[kind] = count;
+	}
+
+	return TRUE;
+}
+
+static Library *find_library (const gchar *name)
+{
+	GList *libs;
+
+	if (name == NULL)
+		return NULL;
+
+	for (libs = oregano.libraries; libs; libs = libs->next) {
+		Library *lib = libs->data;
+		if (g_ascii_strcasecmp (name, lib->name) == 0)
+			return lib;
+	}
+	return NULL;
+}
+
+static void read_binary_part (BinaryReader *reader, Schematic *sm, const guint8 *record)
+{
+	LibraryPart library_part = {0};
+	Part *part;
+	Coords pos;
+	guint32 first, n, i;
+	gint rotation;
+	IDFlip flip;
+
+	library_part.name = reader_get_string (reader, record);
+	library_part.library = find_library (reader_get_string (reader, record + 4));
+	library_part.symbol_name = reader_get_string (reader, record + 8);
+	rotation = (gint32)get_u32 (record + 12);
+	flip = get_u32 (record + 16);
+
+	// prepended, the part reverses them again like for the XML format
+	first = get_u32 (record + 20);
+	n = get_u32 (record + 24);
+	if (first > reader->counts[BINARY_SCHEMATIC_PROPERTIES] ||
+	    n > reader->counts[BINARY_SCHEMATIC_PROPERTIES] - first) {
+		reader->failed = TRUE;
+		return;
+	}
+	for (i = first; i < first + n; i++) {
+		const guint8 *data = reader->data[BINARY_SCHEMATIC_PROPERTIES] + i * PROPERTY_LENGTH;
+		Property *property = g_new0 (Property, 1);
+
+		property->name = reader_get_string (reader, data);
+		property->value = reader_get_string (reader, data + 4);
+		library_part.properties = g_slist_prepend (library_part.properties, property);
+	}
+
+	first = get_u32 (record + 28);
+	n = get_u32 (record + 32);
+	if (first > reader->counts[BINARY_SCHEMATIC_LABELS] ||
+	    n > reader->counts[BINARY_SCHEMATIC_LABELS] - first) {
+		reader->failed = TRUE;
+		g_slist_free_full (library_part.properties, g_free);
+		return;
+	}
+	for (i = first; i < first + n; i++) {
+		const guint8 *data = reader->data[BINARY_SCHEMATIC_LABELS] + i * LABEL_LENGTH;
+		PartLabel *label = g_new0 (PartLabel, 1);
+
+		label->name = reader_get_string (reader, data);
+		label->text = reader_get_string (reader, data + 4);
+		label->pos.x = get_f64 (data + 8);
+		label->pos.y = get_f64 (data + 16);
+		library_part.labels = g_slist_prepend (library_part.labels, label);
+	}
+
+	part = NULL;
+	if (!reader->failed && library_part.name != NULL && library_part.symbol_name != NULL)
+		part = part_new_from_library_part (&library_part);
+
+	// the part copied the strings
+	g_slist_free_full (library_part.properties, g_free);
+	g_slist_free_full (library_part.labels, g_free);
+
+	if (part == NULL) {
+		g_warning ("Failed to create Part from LibraryPart");
+		return;
+	}
+
+	pos.x = get_f64 (record + 40);
+	pos.y = get_f64 (record + 48);
+	item_data_set_pos (ITEM_DATA (part), &pos);
+	item_data_rotate (ITEM_DATA (part), rotation, NULL);
+	if (flip & ID_FLIP_HORIZ)
+		item_data_flip (ITEM_DATA (part), ID_FLIP_HORIZ, NULL);
+	if (flip & ID_FLIP_VERT)
+		item_data_flip (ITEM_DATA (part), ID_FLIP_VERT, NULL);
+
+	schematic_add_item (sm, ITEM_DATA (part));
+}
+
+static void read_binary_wire (Schematic *sm, const guint8 *record)
+{
+	Coords start_pos, length;
+	Wire *wire;
+
+	start_pos.x = get_f64 (record);
+	start_pos.y = get_f64 (record + 8);
+	length.x = get_f64 (record + 16) - start_pos.x;
+	length.y = get_f64 (record + 24) - start_pos.y;
+
+	wire = wire_new ();
+	wire_set_length (wire, &length);
+	item_data_set_pos (ITEM_DATA (wire), &start_pos);
+	schematic_add_item (sm, ITEM_DATA (wire));
+}
+
+static void read_binary_textbox (BinaryReader *reader, Schematic *sm, const guint8 *record)
+{
+	Textbox *textbox;
+	Coords pos;
+
+	pos.x = get_f64 (record + 8);
+	pos.y = get_f64 (record + 16);
+
+	textbox = textbox_new (NULL);
+	textbox_set_text (textbox, reader_get_string (reader, record));
+	item_data_set_pos (ITEM_DATA (textbox), &pos);
+	schematic_add_item (sm, ITEM_DATA (textbox));
+}
+
+static void read_binary_info (BinaryReader *reader, Schematic *sm)
+{
+	const guint8 *info = reader->data[BINARY_SCHEMATIC_INFO];
+	SimSettingsGui *sim_settings_gui;
+	SimSettings *sim_settings;
+	GError *e = NULL;
+
+	if (reader->counts[BINARY_SCHEMATIC_INFO] > 0) {
+		schematic_set_author (sm, reader_get_string (reader, info));
+		schematic_set_title (sm, reader_get_string (reader, info + 4));
+		schematic_set_version (sm, reader_get_string (reader, info + 8));
+		schematic_set_comments (sm, reader_get_string (reader, info + 12));
+	}
+
+	if (reader->data[BINARY_SCHEMATIC_SIMULATION] == NULL)
+		return;
+
+	sim_settings = sim_settings_new_from_data (
+	    (const gchar *)reader->data[BINARY_SCHEMATIC_SIMULATION],
+	    reader->counts[BINARY_SCHEMATIC_SIMULATION], &e);
+	if (sim_settings == NULL) {
+		g_warning ("Could not read the simulation settings: %s", e->message);
+		g_clear_error (&e);
+		reader->failed = TRUE;
+		return;
+	}
+
+	sim_settings_gui = schematic_get_sim_settings_gui (sm);
+	sim_settings_finalize (sim_settings_gui->sim_settings);
+	sim_settings_gui->sim_settings = sim_settings;
+}
+
+gint schematic_parse_binary_file (Schematic *sm, const gchar *filename, GError **error)
+{
+	BinaryReader reader = {{NULL}};
+	GMappedFile *mapped;
+	const guint8 *data;
+	guint32 i;
+
+	mapped = g_mapped_file_new (filename, FALSE, error);
+	if (mapped == NULL)
+		return -1;
+
+	// the parts are looked up in all libraries
+	oregano_libraries_ensure_loaded ();
+
+	data = (const guint8 *)g_mapped_file_get_contents (mapped);
+	if (data == NULL || !reader_init (&reader, data, g_mapped_file_get_length (mapped))) {
+		g_mapped_file_unref (mapped);
+		g_set_error (error, OREGANO_ERROR, OREGANO_SCHEMATIC_BAD_FILE_FORMAT,
+		             _ ("Bad file format."));
+		return -1;
+	}
+
+	read_binary_info (&reader, sm);
+
+	for (i = 0; i < reader.counts[BINARY_SCHEMATIC_PARTS] && !reader.failed; i++)
+		read_binary_part (&reader, sm, reader.data[BINARY_SCHEMATIC_PARTS] + i * PART_LENGTH);
+
+	for (i = 0; i < reader.counts[BINARY_SCHEMATIC_WIRES]; i++)
+		read_binary_wire (sm, reader.data[BINARY_SCHEMATIC_WIRES] + i * WIRE_LENGTH);
+
+	for (i = 0; i < reader.counts[BINARY_SCHEMATIC_TEXTBOXES] && !reader.failed; i++)
+		read_binary_textbox (&reader, sm,
+		                     reader.data[BINARY_SCHEMATIC_TEXTBOXES] + i * TEXTBOX_LENGTH);
+
+	g_mapped_file_unref (mapped);
+
+	if (reader.failed) {
+		g_set_error (error, OREGANO_ERROR, OREGANO_SCHEMATIC_BAD_FILE_FORMAT,
+		             _ ("Bad file format."));
+		return -1;
+	}
+
+	schematic_set_filename (sm, filename);
+	update_schematic (sm);
+
+	return 0;
+}
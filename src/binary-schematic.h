@@ -0,0 +1,79 @@
+/*
+ * binary-schematic.h
+ *
+ *
+ * Authors:
+ *  Michi <st101564@stud.uni-stuttgart.de>
+ *
+ * Web page: https://ahoi.io/project/oregano
+ *
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+
+#ifndef BINARY_SCHEMATIC_H_
+#define BINARY_SCHEMATIC_H_
+
+#include <glib.h>
+
+#include "schematic.h"
+
+/**
+ * A binary schematic format that loads without parsing text. It holds
+ * the same as the XML format, so files can be converted back and forth
+ * by saving them under the other extension.
+ *
+ * Everything is little endian, sections start at multiples of 8:
+ *
+ *   "OREGBIN" '\0'                                magic
+ *   u32 version, u32 number of sections
+ *   sections: u32 kind, u32 count, u64 offset, u64 length
+ *
+ * Strings are stored once in the STRINGS section and referred to by
+ * their index everywhere else. All other sections are arrays of count
+ * records of a fixed size, so they are read in place from a mapping of
+ * the file. Sections of unknown kind are skipped.
+ */
+
+#define BINARY_SCHEMATIC_VERSION 1
+
+typedef enum {
+	// u32 offset of each string into the section, then the strings,
+	// each terminated by '\0'
+	BINARY_SCHEMATIC_STRINGS = 1,
+	// u32 author, title, version, comments
+	BINARY_SCHEMATIC_INFO,
+	// see sim_settings_to_data, count is its length
+	BINARY_SCHEMATIC_SIMULATION,
+	// u32 name, library, symbol, i32 rotation, u32 flip,
+	// u32 first property, number of properties, first label, number of labels,
+	// u32 unused, f64 x, y
+	BINARY_SCHEMATIC_PARTS,
+	// u32 name, value
+	BINARY_SCHEMATIC_PROPERTIES,
+	// u32 name, text, f64 x, y
+	BINARY_SCHEMATIC_LABELS,
+	// f64 start x, y, end x, y
+	BINARY_SCHEMATIC_WIRES,
+	// u32 text, unused, f64 x, y
+	BINARY_SCHEMATIC_TEXTBOXES
+} BinarySchematicSection;
+
+gint schematic_parse_binary_file (Schematic *sm, const gchar *filename, GError **error);
+gboolean schematic_write_binary (Schematic *sm, GError **error);
+
+#endif /* BINARY_SCHEMATIC_H_ */
@@ -33,91 +33,122 @@
 #include <glib.h>
 
 #include "oregano.h"
-#include "sheet-item.h"
+#include "load-schematic.h"
+#include "save-schematic.h"
 #include "clipboard.h"
 
-struct _ClipboardData
+typedef struct
 {
-	ItemData *item_data;
-	SheetItemClass *item_class;
+	GCallback callback;
+	gpointer user_data;
+} ClipboardRequest;
+
+static GtkTargetEntry clipboard_targets[] = {
+    {CLIPBOARD_TARGET_ITEMS, 0, 0},
 };
 
-void clipboard_empty (void)
+GtkClipboard *clipboard_get (void) { return gtk_clipboard_get (GDK_SELECTION_CLIPBOARD); }
+
+static void clipboard_get_func (GtkClipboard *clipboard, GtkSelectionData *selection_data,
+                                guint info, GBytes *bytes)
 {
-	GSList *list;
-	ClipboardData *cb_data;
+	gsize length;
+	const guchar *data = g_bytes_get_data (bytes, &length);
 
-	if (oregano.clipboard == NULL)
-		return;
+	gtk_selection_data_set (selection_data, gdk_atom_intern_static_string (CLIPBOARD_TARGET_ITEMS),
+	                        8, data, length);
+}
 
-	for (list = oregano.clipboard; list; list = list->next) {
-		cb_data = list->data;
+static void clipboard_clear_func (GtkClipboard *clipboard, GBytes *bytes) { g_bytes_unref (bytes); }
 
-		g_object_unref (G_OBJECT (cb_data->item_data));
-		g_free (cb_data);
+/**
+ * Serializes @items, a list of ItemData, once. Pasting only copies the
+ * serialized fragment, no matter which instance asks for it.
+ */
+void clipboard_set_items (GList *items)
+{
+	GtkClipboard *clipboard = clipboard_get ();
+	GBytes *bytes;
+
+	bytes = schematic_write_xml_items (items);
+	g_return_if_fail (bytes != NULL);
+
+	if (!gtk_clipboard_set_with_data (clipboard, clipboard_targets,
+	                                  G_N_ELEMENTS (clipboard_targets),
+	                                  (GtkClipboardGetFunc)clipboard_get_func,
+	                                  (GtkClipboardClearFunc)clipboard_clear_func, bytes)) {
+		g_bytes_unref (bytes);
+		return;
 	}
 
-	g_slist_free (oregano.clipboard);
-	oregano.clipboard = NULL;
+	// keep it for other instances after this one quit
+	gtk_clipboard_set_can_store (clipboard, clipboard_targets, G_N_ELEMENTS (clipboard_targets));
 }
 
-gboolean clipboard_is_empty (void)
+static void clipboard_received_items (GtkClipboard *clipboard, GtkSelectionData *selection_data,
+                                      ClipboardRequest *request)
 {
-	if (oregano.clipboard == NULL)
-		return TRUE;
+	GList *items = NULL;
+	GError *error = NULL;
+	const guchar *data;
+	gint length;
+
+	data = gtk_selection_data_get_data (selection_data);
+	length = gtk_selection_data_get_length (selection_data);
+
+	if (data != NULL && length > 0) {
+		items = schematic_parse_xml_items ((const gchar *)data, length, &error);
+		if (error != NULL) {
+			g_warning ("Could not paste: %s", error->message);
+			g_clear_error (&error);
+		}
+	}
 
-	return g_slist_length (oregano.clipboard) > 0 ? FALSE : TRUE;
+	((ClipboardItemsFunc)request->callback) (items, request->user_data);
+	g_free (request);
 }
 
-void clipboard_foreach (ClipBoardFunction callback, gpointer user_data)
+/**
+ * Asks the owner of the clipboard for the items. @callback is called
+ * from the main loop, also if there are no items.
+ */
+void clipboard_request_items (ClipboardItemsFunc callback, gpointer user_data)
 {
-	GSList *list;
-	ClipboardData *data;
+	ClipboardRequest *request = g_new (ClipboardRequest, 1);
 
-	if (!oregano.clipboard)
-		return;
+	request->callback = G_CALLBACK (callback);
+	request->user_data = user_data;
 
-	for (list = oregano.clipboard; list; list = list->next) {
-		data = list->data;
-		callback (data, user_data);
-	}
+	gtk_clipboard_request_contents (clipboard_get (),
+	                                gdk_atom_intern_static_string (CLIPBOARD_TARGET_ITEMS),
+	                                (GtkClipboardReceivedFunc)clipboard_received_items, request);
 }
 
-void clipboard_add_object (GObject *item)
+static void clipboard_received_targets (GtkClipboard *clipboard, GdkAtom *atoms, gint n_atoms,
+                                        ClipboardRequest *request)
 {
-	ItemDataClass *id_class;
-	ItemData *item_data, *clone;
-	ClipboardData *cb_data;
-
-	g_return_if_fail (item != NULL);
-
-	item_data = sheet_item_get_data (SHEET_ITEM (item));
-	g_return_if_fail (item_data != NULL);
-
-	id_class = ITEM_DATA_CLASS (G_OBJECT_GET_CLASS (item_data));
-	if (id_class->clone == NULL)
-		return;
+	GdkAtom target = gdk_atom_intern_static_string (CLIPBOARD_TARGET_ITEMS);
+	gboolean available = FALSE;
+	gint i;
 
-	// Duplicate the data for the object and add to the clipboard.
-	clone = id_class->clone (item_data);
+	for (i = 0; i < n_atoms && !available; i++)
+		available = atoms[i] == target;
 
-	cb_data = g_new0 (ClipboardData, 1);
-	cb_data->item_data = clone;
-	cb_data->item_class = SHEET_ITEM_CLASS (G_OBJECT_GET_CLASS (item));
-
-	oregano.clipboard = g_slist_prepend (oregano.clipboard, cb_data);
+	((ClipboardAvailableFunc)request->callback) (available, request->user_data);
+	g_free (request);
 }
 
-GObject *clipboard_data_get_item_data (ClipboardData *data)
+/**
+ * Only asks for the targets, the items themselves are not transferred.
+ */
+void clipboard_request_available (ClipboardAvailableFunc callback, gpointer user_data)
 {
-	g_return_val_if_fail (data != NULL, NULL);
+	ClipboardRequest *request = g_new (ClipboardRequest, 1);
 
-	return G_OBJECT (data->item_data);
-}
-
-GObjectClass *clipboard_data_get_item_class (ClipboardData *data)
-{
-	g_return_val_if_fail (data != NULL, NULL);
+	request->callback = G_CALLBACK (callback);
+	request->user_data = user_data;
 
-	return G_OBJECT_CLASS (data->item_class);
+	gtk_clipboard_request_targets (clipboard_get (),
+	                               (GtkClipboardTargetsReceivedFunc)clipboard_received_targets,
+	                               request);
 }
@@ -33,15 +33,22 @@
 #ifndef __CLIPBOARD_H
 #define __CLIPBOARD_H
 
-typedef struct _ClipboardData ClipboardData;
+#include <gtk/gtk.h>
 
-typedef void (*ClipBoardFunction)(ClipboardData *data, gpointer user_data);
+/**
+ * The items are put on the clipboard of the desktop as a fragment in the
+ * format of a schematic file, so they can be pasted into other instances
+ * of oregano as well.
+ */
+#define CLIPBOARD_TARGET_ITEMS "application/x-oregano-items"
+
+// @items: the parsed ItemData, owned by the callback, NULL if there are none
+typedef void (*ClipboardItemsFunc)(GList *items, gpointer user_data);
+typedef void (*ClipboardAvailableFunc)(gboolean available, gpointer user_data);
 
-void clipboard_empty (void);
-gboolean clipboard_is_empty (void);
-void clipboard_foreach (ClipBoardFunction callback, gpointer user_data);
-void clipboard_add_object (GObject *item);
-GObjectClass *clipboard_data_get_item_class (ClipboardData *data);
-GObject *clipboard_data_get_item_data (ClipboardData *data);
+GtkClipboard *clipboard_get (void);
+void clipboard_set_items (GList *items);
+void clipboard_request_items (ClipboardItemsFunc callback, gpointer user_data);
+void clipboard_request_available (ClipboardAvailableFunc callback, gpointer user_data);
 
 #endif
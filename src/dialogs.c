@@ -36,6 +36,7 @@
 
 #include "dialogs.h"
 #include "oregano.h"
+#include "mem-stats.h"
 
 #include "pixmaps/logo.xpm"
 
@@ -230,3 +231,29 @@ void dialog_about (void)
 	gtk_widget_destroy (about);
 	about = NULL;
 }
+
+/*
+ * Shows the counters of mem-stats.h, refreshed on request.
+ */
+void dialog_memory_stats (void)
+{
+	GtkWidget *dialog;
+	gchar *dump, *markup;
+	enum { RESPONSE_REFRESH = 1 };
+
+	dialog = gtk_message_dialog_new (NULL, GTK_DIALOG_MODAL, GTK_MESSAGE_INFO, GTK_BUTTONS_NONE,
+	                                 _ ("Memory held by subsystem"));
+	gtk_dialog_add_buttons (GTK_DIALOG (dialog), _ ("_Refresh"), RESPONSE_REFRESH, _ ("_Close"),
+	                        GTK_RESPONSE_CLOSE, NULL);
+	gtk_dialog_set_default_response (GTK_DIALOG (dialog), GTK_RESPONSE_CLOSE);
+
+	do {
+		dump = mem_stats_dump ();
+		markup = g_markup_printf_escaped ("<tt>%s</tt>", dump);
+		gtk_message_dialog_format_secondary_markup (GTK_MESSAGE_DIALOG (dialog), "%s", markup);
+		g_free (markup);
+		g_free (dump);
+	} while (gtk_dialog_run (GTK_DIALOG (dialog)) == RESPONSE_REFRESH);
+
+	gtk_widget_destroy (dialog);
+}
@@ -63,5 +63,6 @@ void oregano_warning_with_title (gchar *title, gchar *msg);
 gboolean oregano_schedule_question (OreganoQuestionAnswer *qa);
 gint oregano_question (gchar *msg);
 void dialog_about (void);
+void dialog_memory_stats (void);
 
 #endif
@@ -64,4 +64,6 @@ struct _OreganoEngineClass
 	void (*abort)();
 };
 
+gchar *oregano_engine_new_temp_base (void);
+
 #endif
@@ -28,9 +28,11 @@
  */
 
 #include <glib/gi18n.h>
+#include <unistd.h>
 
 #include "engine.h"
 #include "engine-internal.h"
+#include "errors.h"
 #include "gnucap.h"
 #include "ngspice.h"
 
@@ -101,6 +103,134 @@ void oregano_engine_start (OreganoEngine *self) { OREGANO_ENGINE_GET_CLASS (self
 
 void oregano_engine_stop (OreganoEngine *self) { OREGANO_ENGINE_GET_CLASS (self)->stop (self); }
 
+/*
+ * Run state of oregano_engine_run_async. Engines report the end of a
+ * run with the "done" and "aborted" signals in the main context, the
+ * run turns them into the result of a GTask.
+ */
+typedef struct
+{
+	gulong done_handler;
+	gulong aborted_handler;
+	GCancellable *cancellable;
+	gulong cancelled_handler;
+	gboolean completed;
+} EngineRun;
+
+static void engine_run_free (EngineRun *run)
+{
+	g_clear_object (&run->cancellable);
+	g_free (run);
+}
+
+/**
+ * @error: nullable, taken over
+ */
+static void engine_run_complete (GTask *task, GError *error)
+{
+	OreganoEngine *engine = g_task_get_source_object (task);
+	EngineRun *run = g_task_get_task_data (task);
+
+	if (run->completed) {
+		g_clear_error (&error);
+		return;
+	}
+	run->completed = TRUE;
+
+	g_signal_handler_disconnect (engine, run->done_handler);
+	g_signal_handler_disconnect (engine, run->aborted_handler);
+	if (run->cancellable != NULL)
+		g_cancellable_disconnect (run->cancellable, run->cancelled_handler);
+
+	if (error != NULL)
+		g_task_return_error (task, error);
+	else
+		// owned by the engine
+		g_task_return_pointer (task, oregano_engine_get_results (engine), NULL);
+	g_object_unref (task);
+}
+
+static void engine_run_done_cb (OreganoEngine *engine, GTask *task)
+{
+	engine_run_complete (task, NULL);
+}
+
+static void engine_run_aborted_cb (OreganoEngine *engine, GTask *task)
+{
+	engine_run_complete (task, g_error_new_literal (OREGANO_ERROR, OREGANO_SIMULATE_ERROR_ABORTED,
+	                                                _ ("The simulation was aborted, see the log "
+	                                                   "for details.")));
+}
+
+static gboolean engine_run_cancelled_idle (GTask *task)
+{
+	EngineRun *run = g_task_get_task_data (task);
+
+	if (!run->completed) {
+		oregano_engine_stop (g_task_get_source_object (task));
+		// not every engine reports a stopped run, so do not wait for it
+		engine_run_complete (task, g_error_new_literal (G_IO_ERROR, G_IO_ERROR_CANCELLED,
+		                                                _ ("The simulation was canceled.")));
+	}
+	return G_SOURCE_REMOVE;
+}
+
+/**
+ * Possibly called in another thread and with the cancellable locked,
+ * so the engine is stopped from the main context of the run.
+ */
+static void engine_run_cancelled_cb (GCancellable *cancellable, GTask *task)
+{
+	GSource *source = g_idle_source_new ();
+	// before the engine gets the chance to report anything else
+	g_source_set_priority (source, G_PRIORITY_DEFAULT);
+	g_source_set_callback (source, (GSourceFunc)engine_run_cancelled_idle, g_object_ref (task),
+	                       g_object_unref);
+	g_source_attach (source, g_task_get_context (task));
+	g_source_unref (source);
+}
+
+/**
+ * Starts a run of @engine. @callback is invoked in the thread default
+ * main context of the caller when the engine is done, was aborted or
+ * @cancellable was triggered. Many engines can run at the same time,
+ * each one runs once.
+ */
+void oregano_engine_run_async (OreganoEngine *self, GCancellable *cancellable,
+                               GAsyncReadyCallback callback, gpointer user_data)
+{
+	g_return_if_fail (OREGANO_IS_ENGINE (self));
+
+	GTask *task = g_task_new (self, cancellable, callback, user_data);
+	EngineRun *run = g_new0 (EngineRun, 1);
+
+	g_task_set_source_tag (task, oregano_engine_run_async);
+	g_task_set_task_data (task, run, (GDestroyNotify)engine_run_free);
+
+	// the reference of the task is dropped when it completes
+	run->done_handler = g_signal_connect (self, "done", G_CALLBACK (engine_run_done_cb), task);
+	run->aborted_handler =
+	    g_signal_connect (self, "aborted", G_CALLBACK (engine_run_aborted_cb), task);
+	if (cancellable != NULL) {
+		run->cancellable = g_object_ref (cancellable);
+		run->cancelled_handler = g_cancellable_connect (
+		    cancellable, G_CALLBACK (engine_run_cancelled_cb), task, NULL);
+	}
+
+	if (!g_cancellable_is_cancelled (cancellable))
+		oregano_engine_start (self);
+}
+
+/**
+ * @returns the analyses of the run, owned by the engine
+ */
+GList *oregano_engine_run_finish (OreganoEngine *self, GAsyncResult *result, GError **error)
+{
+	g_return_val_if_fail (g_task_is_valid (result, self), NULL);
+
+	return g_task_propagate_pointer (G_TASK (result), error);
+}
+
 gboolean oregano_engine_has_warnings (OreganoEngine *self)
 {
 	return OREGANO_ENGINE_GET_CLASS (self)->has_warnings (self);
@@ -123,8 +253,28 @@ void oregano_engine_get_progress_reader (OreganoEngine *self, double *p)
 	OREGANO_ENGINE_GET_CLASS (self)->progress_reader (self, p);
 }
 
+/**
+ * Makes the engine simulate @netlist as it is instead of the netlist of
+ * its schematic, e.g. the text of the netlist editor. The simulation
+ * settings of the schematic are still used to read the results.
+ *
+ * @netlist: nullable, NULL goes back to the schematic
+ */
+void oregano_engine_set_netlist (OreganoEngine *self, GBytes *netlist)
+{
+	g_object_set_data_full (G_OBJECT (self), "netlist", netlist ? g_bytes_ref (netlist) : NULL,
+	                        (GDestroyNotify)g_bytes_unref);
+}
+
 gboolean oregano_engine_generate_netlist (OreganoEngine *self, const gchar *file, GError **error)
 {
+	GBytes *netlist = g_object_get_data (G_OBJECT (self), "netlist");
+
+	if (netlist != NULL) {
+		gsize size;
+		const gchar *data = g_bytes_get_data (netlist, &size);
+		return g_file_set_contents (file, data, size, error);
+	}
 	return OREGANO_ENGINE_GET_CLASS (self)->get_netlist (self, file, error);
 }
 
@@ -162,6 +312,21 @@ OreganoEngine *oregano_engine_factory_create_engine (gint type, Schematic *sm)
 	return engine;
 }
 
+/**
+ * A path in the temporary directory without extension, different for
+ * every engine of every oregano process, so engines can run side by
+ * side without overwriting each others netlist.
+ */
+gchar *oregano_engine_new_temp_base (void)
+{
+	static gint counter = 0;
+	gchar *name = g_strdup_printf ("oregano-%d-%d", (gint)getpid (), g_atomic_int_add (&counter, 1));
+	gchar *path = g_build_filename (g_get_tmp_dir (), name, NULL);
+
+	g_free (name);
+	return path;
+}
+
 gchar *oregano_engine_get_analysis_name_by_type(AnalysisType type) {
 	return g_strdup(_(analysis_names[type]));
 }
@@ -48,9 +48,13 @@ OreganoEngine *oregano_engine_factory_create_engine (gint type, Schematic *sm);
 GType oregano_engine_get_type (void);
 void oregano_engine_start (OreganoEngine *engine);
 void oregano_engine_stop (OreganoEngine *engine);
+void oregano_engine_run_async (OreganoEngine *engine, GCancellable *cancellable,
+                               GAsyncReadyCallback callback, gpointer user_data);
+GList *oregano_engine_run_finish (OreganoEngine *engine, GAsyncResult *result, GError **error);
 gboolean oregano_engine_has_warnings (OreganoEngine *engine);
 void oregano_engine_get_progress_solver (OreganoEngine *engine, double *p);
 void oregano_engine_get_progress_reader (OreganoEngine *engine, double *p);
+void oregano_engine_set_netlist (OreganoEngine *engine, GBytes *netlist);
 gboolean oregano_engine_generate_netlist (OreganoEngine *engine, const gchar *file, GError **error);
 GList *oregano_engine_get_results (OreganoEngine *engine);
 gchar *oregano_engine_get_current_operation_solver (OreganoEngine *);
@@ -33,6 +33,7 @@
 #include <sys/wait.h>
 #include <ctype.h>
 #include <glib/gi18n.h>
+#include <glib/gstdio.h>
 
 #include "gnucap.h"
 #include "netlist-helper.h"
@@ -41,6 +42,7 @@
 
 // TODO Move analysis data and result to another file
 #include "simulation.h"
+#include "stall-detector.h"
 
 
 struct analysis_tag
@@ -68,6 +70,7 @@ struct _OreganoGnuCapPriv
 	GIOChannel *child_iochannel;
 	gint child_iochannel_watch;
 	Schematic *schematic;
+	gchar *netlist_file;
 
 	gboolean aborted;
 
@@ -161,6 +164,9 @@ static void gnucap_finalize (GObject *object)
 	g_list_free (gnucap->priv->analysis);
 	gnucap->priv->analysis = NULL;
 
+	g_remove (gnucap->priv->netlist_file);
+	g_free (gnucap->priv->netlist_file);
+
 	parent_class->finalize (object);
 }
 
@@ -363,11 +369,13 @@ static gboolean gnucap_child_stdout_cb (GIOChannel *source, GIOCondition conditi
 	GIOStatus status;
 	GError *error = NULL;
 
+	stall_detector_begin ("gnucap line reader");
 	status = g_io_channel_read_line (source, &line, &len, &terminator, &error);
 	if ((status & G_IO_STATUS_NORMAL) && (len > 0)) {
 		gnucap_parse (line, len, gnucap);
 		g_free (line);
 	}
+	stall_detector_end ();
 
 	// Let UI update
 	g_main_context_iteration (NULL, FALSE);
@@ -378,10 +386,10 @@ static void gnucap_start (OreganoEngine *self)
 {
 	OreganoGnuCap *gnucap;
 	GError *error = NULL;
-	char *argv[] = {"gnucap", "-b", "/tmp/netlist.tmp", NULL};
-
 	gnucap = OREGANO_GNUCAP (self);
-	oregano_engine_generate_netlist (self, "/tmp/netlist.tmp", &error);
+	char *argv[] = {"gnucap", "-b", gnucap->priv->netlist_file, NULL};
+
+	oregano_engine_generate_netlist (self, gnucap->priv->netlist_file, &error);
 	if (error != NULL) {
 		gnucap->priv->aborted = TRUE;
 		schematic_log_append_error (gnucap->priv->schematic, error->message);
@@ -454,6 +462,10 @@ static void gnucap_instance_init (GTypeInstance *instance, gpointer g_class)
 	self->priv->analysis = NULL;
 	self->priv->current = NULL;
 	self->priv->aborted = FALSE;
+
+	gchar *temp_base = oregano_engine_new_temp_base ();
+	self->priv->netlist_file = g_strconcat (temp_base, ".netlist", NULL);
+	g_free (temp_base);
 }
 
 OreganoEngine *oregano_gnucap_new (Schematic *sc)
@@ -48,6 +48,7 @@
 #include "part-private.h"
 #include "part-property.h"
 #include "netlist-helper.h"
+#include "task-scheduler.h"
 #include "errors.h"
 #include "dialogs.h"
 
@@ -64,6 +65,11 @@ static gboolean netlist_helper_foreach_model_save (gpointer key, gpointer model,
 static char *netlist_helper_linebreak (char *str);
 static void netlist_helper_nl_node_traverse (Node *node, GSList **lst);
 
+// Designs with fewer parts are formatted in one go, 0 never goes parallel.
+static guint parallel_min_parts = NETLIST_HELPER_PARALLEL_MIN_PARTS;
+// Parts per task at least, below that the scheduling costs more than it saves.
+static guint parallel_chunk_parts = NETLIST_HELPER_PARALLEL_CHUNK_PARTS;
+
 static void netlist_helper_nl_wire_traverse (Wire *wire, GSList **lst)
 {
 	GSList *iter;
@@ -362,15 +368,219 @@ void update_schematic(Schematic *sm) {
 	return;
 }
 
+/*
+ * Appends the netlist line of @part to @template_out. Only touches the pins
+ * of @part, so different parts can be formatted in parallel.
+ * Returns FALSE if a pin of @part is not connected to any node.
+ */
+static gboolean netlist_helper_append_part (Part *part, NetlistData *data, gchar **node2real,
+                                            GRegex *regex, GString *template_out)
+{
+	gint pin_nr;
+	Pin *pins;
+	gchar *template, **template_split;
+	gchar *tmp, *internal;
+	GString *str;
+	GMatchInfo *match_info;
+	GError *error = NULL;
+	gboolean ok = TRUE;
+	int i;
+
+	internal = part_get_property (part, "internal");
+	if (internal != NULL) {
+		gint node_nr;
+		if (g_ascii_strcasecmp (internal, "clamp") != 0) {
+			g_free (internal);
+			return TRUE;
+		}
+
+		// Got a clamp!, set node number
+		pins = part_get_pins (part);
+		node_nr = GPOINTER_TO_INT (g_hash_table_lookup (data->pins, &pins[0]));
+		if (!node_nr) {
+			g_warning ("Couldn't find part, pin_nr %d.", 0);
+		} else {
+			// need to substrac 1, netlist starts in 0, and node_nr in 1
+			pins[0].node_nr = atoi (node2real[node_nr]);
+		}
+		g_free (internal);
+		return TRUE;
+	}
+
+	tmp = part_get_property (part, "template");
+	if (!tmp) {
+		return TRUE;
+	}
+
+	template = part_property_expand_macros (part, tmp);
+	NG_DEBUG ("Template: '%s'\n"
+	          "macro   : '%s'\n",
+	          tmp, template);
+
+	g_free (tmp);
+	tmp = netlist_helper_linebreak (template);
+
+	g_free (template);
+	template = tmp;
+
+	pins = part_get_pins (part);
+
+	g_regex_match_full (regex, template, -1, 0, 0, &match_info, &error);
+	template_split = g_regex_split (regex, template, 0);
+
+	str = g_string_new ("");
+
+	NG_DEBUG ("Reading pins.\n)");
+
+	for (i = 0; g_match_info_matches (match_info); i++) {
+		g_string_append (str, template_split[i]);
+
+		gchar *word = g_match_info_fetch (match_info, 0);
+
+		pin_nr = g_ascii_strtoll (word + 1, NULL, 10) - 1;
+		gint node_nr = 0;
+		node_nr = GPOINTER_TO_INT (g_hash_table_lookup (data->pins, &pins[pin_nr]));
+		g_free (word);
+		if (!node_nr) {
+			// FIXME the error never reaches the caller
+			g_set_error (&error, OREGANO_ERROR, OREGANO_SIMULATE_ERROR_NO_SUCH_PART,
+			             _ ("Could not find part in library, pin #%d."), pin_nr);
+			ok = FALSE;
+			break;
+		} else {
+			// need to substrac 1, netlist starts in 0, and node_nr in 1
+			pins[pin_nr].node_nr = atoi (node2real[node_nr]);
+			g_string_append (str, node2real[node_nr]);
+			NG_DEBUG ("str: %s\n", str->str);
+		}
+
+		g_match_info_next (match_info, NULL);
+	}
+	g_match_info_free (match_info);
+	g_free (template);
+	if (ok && template_split[i] != NULL) {
+		g_string_append (str, template_split[i]);
+	}
+	g_strfreev (template_split);
+	if (error != NULL) {
+		if (ok)
+			g_printerr ("Error while matching: %s\n", error->message);
+		g_error_free (error);
+	}
+
+	if (ok) {
+		NG_DEBUG ("Done with pins, i = %d\n", i);
+		NG_DEBUG ("str: %s\n", str->str);
+		g_string_append_len (template_out, str->str, str->len);
+		g_string_append_c (template_out, '\n');
+	}
+	g_string_free (str, TRUE);
+
+	return ok;
+}
+
+/*
+ * A run of consecutive parts, formatted by one task into a buffer of its
+ * own.
+ */
+typedef struct
+{
+	GList *first;
+	guint n_parts;
+	NetlistData *data;
+	gchar **node2real;
+	GRegex *regex;
+	GString *template;
+	gboolean ok;
+} NetlistHelperChunk;
+
+static void netlist_helper_chunk_func (NetlistHelperChunk *chunk, CancelInfo *cancel_info)
+{
+	GList *iter = chunk->first;
+	guint i;
+
+	chunk->ok = TRUE;
+	for (i = 0; i < chunk->n_parts && chunk->ok; i++, iter = iter->next)
+		chunk->ok = netlist_helper_append_part (iter->data, chunk->data, chunk->node2real,
+		                                        chunk->regex, chunk->template);
+}
+
+/*
+ * Appends the lines of all @parts to @template. Large designs are split
+ * into chunks that are formatted on the task scheduler; the buffers are
+ * joined in the order of @parts, so the output is the same as the one
+ * of the serial loop. Stops after the first part that fails.
+ */
+static gboolean netlist_helper_append_parts (GList *parts, NetlistData *data, gchar **node2real,
+                                             GString *template)
+{
+	GRegex *regex;
+	NetlistHelperChunk *chunks;
+	Task **tasks;
+	guint n_parts, n_chunks, i;
+	gboolean ok = TRUE;
+
+	regex = g_regex_new ("%\\d*", 0, 0, NULL);
+	n_parts = g_list_length (parts);
+
+	n_chunks = 1;
+	if (parallel_min_parts != 0 && n_parts >= parallel_min_parts)
+		n_chunks = CLAMP (n_parts / parallel_chunk_parts, 1, 4 * g_get_num_processors ());
+
+	if (n_chunks == 1) {
+		for (; parts && ok; parts = parts->next)
+			ok = netlist_helper_append_part (parts->data, data, node2real, regex, template);
+		g_regex_unref (regex);
+		return ok;
+	}
+
+	chunks = g_new0 (NetlistHelperChunk, n_chunks);
+	tasks = g_new0 (Task *, n_chunks);
+	for (i = 0; i < n_chunks; i++) {
+		NetlistHelperChunk *chunk = &chunks[i];
+
+		// the first n_parts % n_chunks chunks get one part more
+		chunk->n_parts = n_parts / n_chunks + (i < n_parts % n_chunks ? 1 : 0);
+		chunk->first = parts;
+		chunk->data = data;
+		chunk->node2real = node2real;
+		chunk->regex = regex;
+		chunk->template = g_string_sized_new (64 * chunk->n_parts);
+		parts = g_list_nth (parts, chunk->n_parts);
+
+		tasks[i] = task_scheduler_run (task_scheduler_get_default (),
+		                               (TaskFunc)netlist_helper_chunk_func, chunk, NULL,
+		                               TASK_PRIORITY_HIGH);
+	}
+
+	for (i = 0; i < n_chunks; i++) {
+		task_wait (tasks[i]);
+		task_unref (tasks[i]);
+		if (ok) {
+			g_string_append_len (template, chunks[i].template->str, chunks[i].template->len);
+			ok = chunks[i].ok;
+		}
+		g_string_free (chunks[i].template, TRUE);
+	}
+
+	g_free (tasks);
+	g_free (chunks);
+	g_regex_unref (regex);
+	return ok;
+}
+
+void netlist_helper_set_parallel (guint min_parts, guint chunk_parts)
+{
+	parallel_min_parts = min_parts;
+	parallel_chunk_parts = MAX (chunk_parts, 1);
+}
+
 // FIXME this one piece of ugly+bad code
 void netlist_helper_create (Schematic *sm, Netlist *out, GError **error)
 {
 	NetlistData data;
 	GList *iter;
-	Part *part;
-	gint pin_nr, num_nodes, num_gnd_nodes, i, j, num_clamps;
-	Pin *pins;
-	gchar *template, **template_split;
+	gint num_nodes, num_gnd_nodes, i, j, num_clamps;
 	NodeStore *store;
 	gchar **node2real;
 
@@ -435,122 +645,15 @@ void netlist_helper_create (Schematic *sm, Netlist *out, GError **error)
 		// Fill in the netlist node names for all the used nodes.
 		for (iter = data.node_and_number_list; iter; iter = iter->next) {
 			NodeAndNumber *nan = iter->data;
-			if (nan->node->netlist_node_name != NULL)
-				g_free (nan->node->netlist_node_name);
+			g_clear_pointer (&nan->node->netlist_node_name, g_free);
 			if (nan->node_nr != 0)
 				nan->node->netlist_node_name = g_strdup (node2real[nan->node_nr]);
 		}
 
 		// Initialize out->template
 		out->template = g_string_new ("");
-		for (iter = store->parts; iter; iter = iter->next) {
-			part = iter->data;
-
-			gchar *tmp, *internal;
-			GString *str;
-
-			internal = part_get_property (part, "internal");
-			if (internal != NULL) {
-				gint node_nr;
-				Pin *pins;
-				if (g_ascii_strcasecmp (internal, "clamp") != 0) {
-					g_free (internal);
-					continue;
-				}
-
-				// Got a clamp!, set node number
-				pins = part_get_pins (part);
-				node_nr = GPOINTER_TO_INT (g_hash_table_lookup (data.pins, &pins[0]));
-				if (!node_nr) {
-					g_warning ("Couldn't find part, pin_nr %d.", 0);
-				} else {
-					// need to substrac 1, netlist starts in 0, and node_nr in 1
-					pins[0].node_nr = atoi (node2real[node_nr]);
-				}
-				g_free (internal);
-				continue;
-			}
-
-			tmp = part_get_property (part, "template");
-			if (!tmp) {
-				continue;
-			}
-
-			template = part_property_expand_macros (part, tmp);
-			NG_DEBUG ("Template: '%s'\n"
-			          "macro   : '%s'\n",
-			          tmp, template);
-
-			g_free (tmp);
-			tmp = netlist_helper_linebreak (template);
-
-			g_free (template);
-			template = tmp;
-
-			pins = part_get_pins (part);
-
-
-
-
-			GRegex *regex;
-			GMatchInfo *match_info;
-			GError *error = NULL;
-
-			regex = g_regex_new("%\\d*", 0, 0, NULL);
-			g_regex_match_full(regex, template, -1, 0, 0, &match_info, &error);
-			template_split = g_regex_split(regex, template, 0);
-
-			str = g_string_new ("");
-
-			NG_DEBUG ("Reading pins.\n)");
-
-			int i;
-			for (i = 0; g_match_info_matches(match_info); i++) {
-				g_string_append (str, template_split[i]);
-
-				gchar *word = g_match_info_fetch(match_info, 0);
-
-
-				pin_nr = g_ascii_strtoll(word + 1, NULL, 10) - 1;
-				gint node_nr = 0;
-				node_nr = GPOINTER_TO_INT (g_hash_table_lookup (data.pins, &pins[pin_nr]));
-				if (!node_nr) {
-					g_set_error (&error, OREGANO_ERROR, OREGANO_SIMULATE_ERROR_NO_SUCH_PART,
-					             _ ("Could not find part in library, pin #%d."), pin_nr);
-					return; // FIXME wtf?? this leaks like hell and did for ages!
-				} else {
-					gchar *tmp;
-					tmp = node2real[node_nr];
-
-					// need to substrac 1, netlist starts in 0, and node_nr in 1
-					pins[pin_nr].node_nr = atoi (node2real[node_nr]);
-					g_string_append (str, tmp);
-					NG_DEBUG ("str: %s\n", str->str);
-				}
-
-				g_free(word);
-				g_match_info_next(match_info, NULL);
-			}
-			g_match_info_free(match_info);
-			g_free (template);
-			template = NULL;
-			g_regex_unref(regex);
-			if (template_split[i] != NULL) {
-				g_string_append (str, template_split[i]);
-			}
-			g_strfreev (template_split);
-			if (error != NULL) {
-				g_printerr("Error while matching: %s\n", error->message);
-				g_error_free(error);
-			}
-
-			NG_DEBUG ("Done with pins, i = %d\n", i);
-
-			NG_DEBUG ("str: %s\n", str->str);
-			out->template = g_string_append (out->template, str->str);
-			out->template = g_string_append_c (out->template, '\n');
-			g_string_free (str, TRUE);
-		}
+		if (!netlist_helper_append_parts (store->parts, &data, node2real, out->template))
+			return; // FIXME wtf?? this leaks like hell and did for ages!
 
 		g_strfreev (node2real);
 
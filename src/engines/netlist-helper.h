@@ -39,6 +39,9 @@
 #include "schematic.h"
 #include "sim-settings.h"
 
+#define NETLIST_HELPER_PARALLEL_MIN_PARTS 2000
+#define NETLIST_HELPER_PARALLEL_CHUNK_PARTS 250
+
 typedef struct
 {
 	gint node_nr; ///< Node number
@@ -76,6 +79,9 @@ typedef struct
 void update_schematic(Schematic *sm);
 void netlist_helper_init_data (NetlistData *data);
 void netlist_helper_create (Schematic *sm, Netlist *out, GError **error);
+// Formats the part lines in parallel from @min_parts parts on, in chunks
+// of at least @chunk_parts. @min_parts 0 keeps it serial.
+void netlist_helper_set_parallel (guint min_parts, guint chunk_parts);
 char *netlist_helper_create_analysis_string (NodeStore *store, gboolean do_ac);
 GSList *netlist_helper_get_voltmeters_list (Schematic *sm, GError **error, gboolean with_type);
 GSList *netlist_helper_get_voltage_sources_list (Schematic *sm, GError **error, gboolean ac_only);
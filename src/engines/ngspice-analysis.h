@@ -37,6 +37,7 @@
 #include <glib/gi18n.h>
 #include "../tools/thread-pipe.h"
 #include "../tools/cancel-info.h"
+#include "../tools/task-scheduler.h"
 #include "ngspice.h"
 #include "netlist-helper.h"
 #include "dialogs.h"
@@ -81,9 +82,13 @@ typedef struct {
 struct _OreganoNgSpicePriv
 {
 	GPid child_pid;
-	GThread *saver;
+	Task *saver;
+	// set while a simulation daemon runs the netlist
+	GCancellable *daemon_cancellable;
 
 	Schematic *schematic;
+	gchar *netlist_file;
+	gchar *result_file;
 
 	gboolean aborted;
 	CancelInfo *cancel_info;
@@ -29,6 +29,7 @@
 #include <math.h>
 
 #include "../tools/thread-pipe.h"
+#include "../tools/task-scheduler.h"
 #include "ngspice.h"
 #include "ngspice-analysis.h"
 #include "../log-interface.h"
@@ -78,14 +79,14 @@ typedef struct {
 
 //data wrapper
 typedef struct {
-	GThread *worker;
-	GThread **saver;
+	Task *worker;
+	Task **saver;
 	LogInterface log;
 	const void* emit_instance;
 	GPid *child_pid;
 	gboolean *aborted;
 	guint *num_analysis;
-	GMainLoop *main_loop;
+	gint status;
 	gchar *netlist_file;
 	gchar *ngspice_result_file;
 	enum ERROR_STATE *error_state;
@@ -94,30 +95,28 @@ typedef struct {
 } NgSpiceWatcherWatchNgSpiceResources;
 
 /**
- * Wraps the heavy work of a function into a thread.
+ * Wraps the heavy work of a function into a task.
+ *
+ * Runs also if canceled, because it has to read the pipe to the end.
  */
-static gpointer ngspice_worker (NgspiceAnalysisResources *resources) {
+static void ngspice_worker (NgspiceAnalysisResources *resources, CancelInfo *cancel_info) {
 
 	ngspice_analysis(resources);
 
 	cancel_info_unsubscribe(resources->cancel_info);
 	g_free(resources);
-
-	return NULL;
 }
 
 /**
- * Wraps the heavy work of a function into a thread.
+ * Wraps the heavy work of a function into a task.
  */
-static gpointer ngspice_saver (NgSpiceSaverResources *resources)
+static void ngspice_saver (NgSpiceSaverResources *resources, CancelInfo *cancel_info)
 {
 	ngspice_save(resources->path_to_file, resources->pipe, resources->cancel_info);
 
 	cancel_info_unsubscribe(resources->cancel_info);
 	g_free(resources->path_to_file);
 	g_free(resources);
-
-	return NULL;
 }
 
 /**
@@ -167,21 +166,11 @@ static gboolean g_signal_emit_by_name_main_thread(NgspiceEmitData *data) {
 	g_free(data);
 	g_signal_emit_by_name (G_OBJECT (emit_instance), signal_name);
 	g_free(signal_name);
+	// taken at launch
+	g_object_unref (G_OBJECT (emit_instance));
 	return G_SOURCE_REMOVE;
 }
 
-/**
- * main function of the ngspice watcher
- */
-static gpointer ngspice_watcher_main(GMainLoop *main_loop) {
-	g_main_loop_run(main_loop);
-
-	// unrefs its GMainContext by 1
-	g_main_loop_unref(main_loop);
-
-	return NULL;
-}
-
 /**
  * forks data to file and heap
  */
@@ -252,8 +241,6 @@ static gboolean ngspice_watcher_watch_stdout(GIOChannel *channel, GIOCondition c
 }
 
 static void ngspice_watch_ngspice_resources_finalize(NgSpiceWatcherWatchNgSpiceResources *resources) {
-	g_source_destroy(g_main_current_source());
-	g_main_loop_quit(resources->main_loop);
 	g_spawn_close_pid (*resources->child_pid);
 	*resources->child_pid = 0;
 
@@ -301,8 +288,8 @@ enum NGSPICE_WATCHER_RETURN_VALUE {
  */
 static enum NGSPICE_WATCHER_RETURN_VALUE
 ngspice_watcher_watch_ngspice_resources (GPid pid, gint status, NgSpiceWatcherWatchNgSpiceResources *resources) {
-	GThread *worker = resources->worker;
-	GThread **saver = resources->saver;
+	Task *worker = resources->worker;
+	Task **saver = resources->saver;
 	LogInterface log = resources->log;
 	guint *num_analysis = resources->num_analysis;
 	enum ERROR_STATE *error_state = resources->error_state;
@@ -319,7 +306,8 @@ ngspice_watcher_watch_ngspice_resources (GPid pid, gint status, NgSpiceWatcherWa
 	if (exit_error != NULL)
 		g_error_free(exit_error);
 
-	g_thread_join(worker);
+	task_wait(worker);
+	task_unref(worker);
 	// saver will be unrefed in ngspice finalize
 
 	if (cancel_info_is_cancel(resources->cancel_info))
@@ -337,7 +325,8 @@ ngspice_watcher_watch_ngspice_resources (GPid pid, gint status, NgSpiceWatcherWa
 		else
 			log.log_append_error(log.log, "### ngspice exited abnormally ###\n");
 
-		g_thread_join(*saver);
+		task_wait(*saver);
+		task_unref(*saver);
 		*saver = NULL;
 
 		switch (*error_state) {
@@ -376,11 +365,11 @@ ngspice_watcher_watch_ngspice_resources (GPid pid, gint status, NgSpiceWatcherWa
  * source function is finished with reading to
  * - clean up,
  * - check if all went good or fail,
- * - wait for data conversion thread,
+ * - wait for data conversion task,
  * - return the main program flow to the gui thread.
  */
-static void ngspice_watcher_watch_ngspice (GPid pid, gint status, NgSpiceWatcherWatchNgSpiceResources *resources) {
-	enum NGSPICE_WATCHER_RETURN_VALUE ret_val = ngspice_watcher_watch_ngspice_resources (pid, status, resources);
+static void ngspice_watcher_watch_ngspice (NgSpiceWatcherWatchNgSpiceResources *resources, CancelInfo *cancel_info) {
+	enum NGSPICE_WATCHER_RETURN_VALUE ret_val = ngspice_watcher_watch_ngspice_resources (*resources->child_pid, resources->status, resources);
 
 	NgspiceEmitData *emitData = g_malloc(sizeof(NgspiceEmitData));
 	emitData->emit_instance = resources->emit_instance;
@@ -408,6 +397,21 @@ static void ngspice_watcher_watch_ngspice (GPid pid, gint status, NgSpiceWatcher
 	g_main_context_invoke(NULL, (GSourceFunc)g_signal_emit_by_name_main_thread, emitData);
 }
 
+/**
+ * ngspice death source function
+ *
+ * Runs in the io context of the task scheduler, which must not block.
+ * The waiting for stderr and the worker is done by a blocking task.
+ */
+static void ngspice_watcher_child_exited (GPid pid, gint status, NgSpiceWatcherWatchNgSpiceResources *resources) {
+	resources->status = status;
+
+	Task *task = task_new((TaskFunc)ngspice_watcher_watch_ngspice, resources, NULL);
+	task_set_flags(task, TASK_FLAG_BLOCKING);
+	task_set_cancel_info(task, resources->cancel_info);
+	task_scheduler_submit(task_scheduler_get_default(), task);
+}
+
 /**
  * Extracts a progress number (time of transient analysis)
  * out of a string (if existing) and saves it to the thread-shared
@@ -489,19 +493,19 @@ static gboolean ngspice_child_stderr_cb (GIOChannel *channel, GIOCondition condi
 /**
  * @resources: caller frees
  *
- * Prepares data structures to launch some threads and finally launches them.
+ * Prepares data structures to launch some tasks and finally launches them.
  *
- * The launched threads are:
+ * The launched tasks are:
  * - process ngspice
- * - thread watcher
- * - thread saver
- * - thread worker
+ * - watches in the io context of the task scheduler
+ * - task saver
+ * - task worker
  *
  * As you should know ngspice is the program that actually simulates the simulation.
  *
- * The watcher thread handles stdout- and death-events of the ngspice process.
- * stdout data is forked to the threads "saver" and "worker".
- * As response to the death-event of ngspice, the watcher
+ * The watches handle stdout- and death-events of the ngspice process.
+ * stdout data is forked to the tasks "saver" and "worker".
+ * As response to the death-event of ngspice, a blocking task
  * - cleans the field of war,
  * - checks if all went good and creates error messages if not all went good,
  * - waits for the worker to finish work,
@@ -528,22 +532,29 @@ void ngspice_watcher_build_and_launch(const NgspiceWatcherBuildAndLaunchResource
 	ProgressResources *progress_reader = resources->progress_reader;
 	GList **analysis = resources->analysis;
 	AnalysisTypeShared *current = resources->current;
-	GThread **saver = resources->saver;
+	Task **saver = resources->saver;
+	TaskScheduler *scheduler = task_scheduler_get_default();
 
 
 	GError *e = NULL;
-	char *argv[] = {"ngspice", "-b", resources->netlist_file, NULL};
+	const gchar *default_simulator[] = {"ngspice", "-b", NULL};
+	GPtrArray *argv = g_ptr_array_new();
+	for (const gchar * const *arg = resources->simulator ? resources->simulator : default_simulator; *arg != NULL; arg++)
+		g_ptr_array_add(argv, (gpointer)*arg);
+	g_ptr_array_add(argv, resources->netlist_file);
+	g_ptr_array_add(argv, NULL);
 
 	gint ngspice_stdout_fd;
 	gint ngspice_stderr_fd;
 	// Launch ngspice
 	if (!g_spawn_async_with_pipes (NULL, // Working directory
-		                              argv, NULL, G_SPAWN_DO_NOT_REAP_CHILD | G_SPAWN_SEARCH_PATH, NULL,
+		                              (gchar **)argv->pdata, NULL, G_SPAWN_DO_NOT_REAP_CHILD | G_SPAWN_SEARCH_PATH, NULL,
 		                              NULL, child_pid,
 		                              NULL,                // STDIN
 		                              &ngspice_stdout_fd, // STDOUT
 		                              &ngspice_stderr_fd,  // STDERR
 		                              &e)) {
+		g_ptr_array_free(argv, TRUE);
 
 		*aborted = TRUE;
 		log.log_append_error(log.log, _("Unable to execute NgSpice.\n"));
@@ -552,6 +563,11 @@ void ngspice_watcher_build_and_launch(const NgspiceWatcherBuildAndLaunchResource
 		return;
 
 	}
+	g_ptr_array_free(argv, TRUE);
+
+	// The watchers write into the engine, so it has to stay alive until
+	// the run is over, also if the run was canceled and the owner is gone.
+	g_object_ref (G_OBJECT (emit_instance));
 
 	// synchronizes stderr listener with is_ngspice_finished listener (needed for error handling)
 	IsNgspiceStderrDestroyed *is_ngspice_stderr_destroyed = g_new0(IsNgspiceStderrDestroyed, 1);
@@ -562,9 +578,7 @@ void ngspice_watcher_build_and_launch(const NgspiceWatcherBuildAndLaunchResource
 	// variable needed for error handling
 	enum ERROR_STATE *error_state = g_new0(enum ERROR_STATE, 1);
 
-	GMainContext *forker_context = g_main_context_new();
-	GMainLoop *forker_main_loop = g_main_loop_new(forker_context, FALSE);
-	g_main_context_unref(forker_context);
+	GMainContext *io_context = task_scheduler_get_io_context(scheduler);
 
 	// Create pipes to fork the stdout data of ngspice
 	ThreadPipe *thread_pipe_worker = thread_pipe_new(20, 2048);
@@ -586,7 +600,12 @@ void ngspice_watcher_build_and_launch(const NgspiceWatcherBuildAndLaunchResource
 	ngspice_worker_resources->cancel_info = resources->cancel_info;
 	cancel_info_subscribe(ngspice_worker_resources->cancel_info);
 
-	GThread *worker = g_thread_new("ngspice worker", (GThreadFunc)ngspice_worker, ngspice_worker_resources);
+	// blocking, because it waits for the pipe most of the time
+	Task *worker = task_new((TaskFunc)ngspice_worker, ngspice_worker_resources, NULL);
+	task_set_priority(worker, TASK_PRIORITY_HIGH);
+	task_set_flags(worker, TASK_FLAG_BLOCKING);
+	task_set_cancel_info(worker, resources->cancel_info);
+	task_scheduler_submit(scheduler, task_ref(worker));
 
 	/**
 	 * Launch output saver
@@ -597,7 +616,11 @@ void ngspice_watcher_build_and_launch(const NgspiceWatcherBuildAndLaunchResource
 	ngspice_saver_resources->cancel_info = resources->cancel_info;
 	cancel_info_subscribe(ngspice_saver_resources->cancel_info);
 
-	*saver = g_thread_new("ngspice saver", (GThreadFunc)ngspice_saver, ngspice_saver_resources);
+	*saver = task_new((TaskFunc)ngspice_saver, ngspice_saver_resources, NULL);
+	task_set_priority(*saver, TASK_PRIORITY_LOW);
+	task_set_flags(*saver, TASK_FLAG_BLOCKING);
+	task_set_cancel_info(*saver, resources->cancel_info);
+	task_scheduler_submit(scheduler, task_ref(*saver));
 
 	/**
 	 * Add an ngspice-is-finished watcher
@@ -610,7 +633,6 @@ void ngspice_watcher_build_and_launch(const NgspiceWatcherBuildAndLaunchResource
 	ngspice_watcher_watch_ngspice_resources->num_analysis = num_analysis;
 	ngspice_watcher_watch_ngspice_resources->worker = worker;
 	ngspice_watcher_watch_ngspice_resources->saver = saver;
-	ngspice_watcher_watch_ngspice_resources->main_loop = forker_main_loop;
 	ngspice_watcher_watch_ngspice_resources->ngspice_result_file = g_strdup(resources->ngspice_result_file);
 	ngspice_watcher_watch_ngspice_resources->netlist_file = g_strdup(resources->netlist_file);
 	ngspice_watcher_watch_ngspice_resources->error_state = error_state;
@@ -620,8 +642,8 @@ void ngspice_watcher_build_and_launch(const NgspiceWatcherBuildAndLaunchResource
 
 	GSource *child_watch_source = g_child_watch_source_new (*child_pid);
 	g_source_set_priority (child_watch_source, G_PRIORITY_LOW);
-	g_source_set_callback (child_watch_source, (GSourceFunc)ngspice_watcher_watch_ngspice, ngspice_watcher_watch_ngspice_resources, NULL);
-	g_source_attach (child_watch_source, forker_context);
+	g_source_set_callback (child_watch_source, (GSourceFunc)ngspice_watcher_child_exited, ngspice_watcher_watch_ngspice_resources, NULL);
+	g_source_attach (child_watch_source, io_context);
 	g_source_unref (child_watch_source);
 
 	/**
@@ -639,7 +661,7 @@ void ngspice_watcher_build_and_launch(const NgspiceWatcherBuildAndLaunchResource
 	g_io_channel_unref(ngspice_stdout_channel);
 	g_source_set_priority (ngspice_stdout_source, G_PRIORITY_HIGH);
 	g_source_set_callback (ngspice_stdout_source, (GSourceFunc)ngspice_watcher_watch_stdout, ngspice_watch_stdout_resources, NULL);
-	g_source_attach (ngspice_stdout_source, forker_context);
+	g_source_attach (ngspice_stdout_source, io_context);
 	g_source_unref (ngspice_stdout_source);
 
 	/**
@@ -664,9 +686,6 @@ void ngspice_watcher_build_and_launch(const NgspiceWatcherBuildAndLaunchResource
 	g_source_set_callback (channel_stderr_watch_source, (GSourceFunc)ngspice_child_stderr_cb, ngspice_watch_stderr_resources, NULL);
 	g_source_attach (channel_stderr_watch_source, NULL);
 	g_source_unref (channel_stderr_watch_source);
-
-	// Launch watcher
-	g_thread_unref(g_thread_new("ngspice forker", (GThreadFunc)ngspice_watcher_main, forker_main_loop));
 }
 
 NgspiceWatcherBuildAndLaunchResources *ngspice_watcher_build_and_launch_resources_new(OreganoNgSpice *ngspice) {
@@ -689,8 +708,8 @@ NgspiceWatcherBuildAndLaunchResources *ngspice_watcher_build_and_launch_resource
 	resources->progress_reader = &ngspice->priv->progress_reader;
 	resources->sim_settings = schematic_get_sim_settings(ngspice->priv->schematic);
 
-	resources->netlist_file = g_strdup("/tmp/netlist.tmp");
-	resources->ngspice_result_file = g_strdup("/tmp/netlist.lst");
+	resources->netlist_file = g_strdup(ngspice->priv->netlist_file);
+	resources->ngspice_result_file = g_strdup(ngspice->priv->result_file);
 
 	resources->cancel_info = ngspice->priv->cancel_info;
 	cancel_info_subscribe(resources->cancel_info);
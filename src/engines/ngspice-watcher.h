@@ -50,8 +50,10 @@ struct _NgspiceWatcherBuildAndLaunchResources {
 	AnalysisTypeShared* current;//out
 	gchar* ngspice_result_file;//in
 	gchar* netlist_file;//in
+	// NULL for ngspice -b, the netlist is appended
+	const gchar * const *simulator;//in
 	CancelInfo *cancel_info;//in
-	GThread **saver;//out
+	Task **saver;//out
 };
 
 NgspiceWatcherBuildAndLaunchResources *ngspice_watcher_build_and_launch_resources_new(OreganoNgSpice *ngspice);
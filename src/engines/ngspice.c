@@ -37,6 +37,7 @@
 #include <sys/wait.h>
 #include <ctype.h>
 #include <glib/gi18n.h>
+#include <glib/gstdio.h>
 
 #include "ngspice.h"
 #include "netlist-helper.h"
@@ -44,8 +45,10 @@
 #include "engine-internal.h"
 #include "ngspice-analysis.h"
 #include "errors.h"
+#include "oregano.h"
 
 #include "ngspice-watcher.h"
+#include "sim-daemon.h"
 
 static void ngspice_class_init (OreganoNgSpiceClass *klass);
 static void ngspice_finalize (GObject *object);
@@ -122,7 +125,12 @@ static void ngspice_finalize (GObject *object)
 	g_mutex_clear(&ngspice->priv->current.mutex);
 	cancel_info_unsubscribe(ngspice->priv->cancel_info);
 	if (ngspice->priv->saver != NULL)
-		g_thread_unref(ngspice->priv->saver);
+		task_unref(ngspice->priv->saver);
+	g_clear_object(&ngspice->priv->daemon_cancellable);
+	g_remove(ngspice->priv->netlist_file);
+	g_remove(ngspice->priv->result_file);
+	g_free(ngspice->priv->netlist_file);
+	g_free(ngspice->priv->result_file);
 	g_free(ngspice->priv);
 
 	parent_class->finalize (object);
@@ -145,38 +153,16 @@ static gboolean ngspice_is_available (OreganoEngine *self)
 }
 
 /**
- * \brief create a netlist buffer from the engine inernals
- *
- * @engine
- * @error [allow-none]
+ * \brief print everything but the analyses: title, options, models and
+ * the circuit itself
  */
-static GString *ngspice_generate_netlist_buffer (OreganoEngine *engine, GError **error)
+static void ngspice_append_circuit (GString *buffer, Netlist *output)
 {
-	OreganoNgSpice *ngspice;
-	Netlist output;
 	GList *iter;
-	GError *e = NULL;
-
-	GString *buffer = NULL;
-
-	ngspice = OREGANO_NGSPICE (engine);
-
-	netlist_helper_create (ngspice->priv->schematic, &output, &e);
-	if (e) {
-		g_propagate_error (error, e);
-		return NULL;
-	}
 
-	buffer = g_string_sized_new (500);
-	if (!buffer) {
-		g_set_error_literal (&e, OREGANO_ERROR, OREGANO_OOM,
-		                     "Failed to allocate intermediate buffer.");
-		g_propagate_error (error, e);
-		return NULL;
-	}
 	// Prints title
 	g_string_append (buffer, "* ");
-	g_string_append (buffer, output.title ? output.title : "Title: <unset>");
+	g_string_append (buffer, output->title ? output->title : "Title: <unset>");
 	g_string_append (buffer, "\n"
 	                         "*----------------------------------------------"
 	                         "\n"
@@ -186,7 +172,7 @@ static GString *ngspice_generate_netlist_buffer (OreganoEngine *engine, GError *
 	// Prints Options
 	g_string_append (buffer, ".options OUT=120 ");
 
-	iter = sim_settings_get_options (output.settings);
+	iter = sim_settings_get_options (output->settings);
 	for (; iter; iter = iter->next) {
 		const SimOption *so = iter->data;
 		// Prevent send NULL text
@@ -200,7 +186,7 @@ static GString *ngspice_generate_netlist_buffer (OreganoEngine *engine, GError *
 
 	// Include of subckt models
 	g_string_append (buffer, "*------------- Models -------------------------\n");
-	for (iter = output.models; iter; iter = iter->next) {
+	for (iter = output->models; iter; iter = iter->next) {
 		const gchar *model = iter->data;
 		gchar *model_with_ext = g_strdup_printf ("%s.model", model);
 		gchar *model_path = g_build_filename (OREGANO_MODELDIR, model_with_ext, NULL);
@@ -211,8 +197,40 @@ static GString *ngspice_generate_netlist_buffer (OreganoEngine *engine, GError *
 
 	// Prints template parts
 	g_string_append (buffer, "*------------- Circuit Description-------------\n");
-	g_string_append (buffer, output.template->str);
+	g_string_append (buffer, output->template->str);
 	g_string_append (buffer, "\n*----------------------------------------------\n");
+}
+
+/**
+ * \brief create a netlist buffer from the engine inernals
+ *
+ * @engine
+ * @error [allow-none]
+ */
+static GString *ngspice_generate_netlist_buffer (OreganoEngine *engine, GError **error)
+{
+	OreganoNgSpice *ngspice;
+	Netlist output;
+	GError *e = NULL;
+
+	GString *buffer = NULL;
+
+	ngspice = OREGANO_NGSPICE (engine);
+
+	netlist_helper_create (ngspice->priv->schematic, &output, &e);
+	if (e) {
+		g_propagate_error (error, e);
+		return NULL;
+	}
+
+	buffer = g_string_sized_new (500);
+	if (!buffer) {
+		g_set_error_literal (&e, OREGANO_ERROR, OREGANO_OOM,
+		                     "Failed to allocate intermediate buffer.");
+		g_propagate_error (error, e);
+		return NULL;
+	}
+	ngspice_append_circuit (buffer, &output);
 
 	// Prints Transient Analysis
 	if (sim_settings_get_trans (output.settings)) {
@@ -307,6 +325,36 @@ static GString *ngspice_generate_netlist_buffer (OreganoEngine *engine, GError *
 	return buffer;
 }
 
+/**
+ * \brief netlist that only computes the operating point and prints every
+ * node voltage and branch current of it as "name = value"
+ *
+ * The analyses of the simulation settings are left out.
+ */
+GString *ngspice_generate_op_netlist_buffer (Schematic *sm, GError **error)
+{
+	Netlist output;
+	GError *e = NULL;
+	GString *buffer;
+
+	netlist_helper_create (sm, &output, &e);
+	if (e) {
+		g_propagate_error (error, e);
+		return NULL;
+	}
+
+	buffer = g_string_sized_new (500);
+	ngspice_append_circuit (buffer, &output);
+	g_string_append (buffer, ".control\n"
+	                         "  op\n"
+	                         "  print all\n"
+	                         "  quit\n"
+	                         ".endc\n"
+	                         "\n.END\n");
+
+	return buffer;
+}
+
 /**
  * \brief generate a netlist and write to file
  *
@@ -361,6 +409,8 @@ static void ngspice_stop (OreganoEngine *self)
 {
 	OreganoNgSpice *ngspice = OREGANO_NGSPICE (self);
 	cancel_info_set_cancel(ngspice->priv->cancel_info);
+	if (ngspice->priv->daemon_cancellable != NULL)
+		g_cancellable_cancel (ngspice->priv->daemon_cancellable);
 	GPid child_pid = ngspice->priv->child_pid;
 	if (child_pid != 0) {
 		// CTRL+C (Terminal quit signal.)
@@ -369,13 +419,67 @@ static void ngspice_stop (OreganoEngine *self)
 	}
 }
 
+static void ngspice_daemon_done (GObject *source, GAsyncResult *result, OreganoNgSpice *ngspice)
+{
+	OreganoNgSpicePriv *priv = ngspice->priv;
+	GError *e = NULL;
+
+	GList *analysis = sim_daemon_client_run_finish (result, &e);
+	g_clear_object (&priv->daemon_cancellable);
+
+	if (analysis == NULL) {
+		priv->aborted = TRUE;
+		if (!g_error_matches (e, G_IO_ERROR, G_IO_ERROR_CANCELLED)) {
+			schematic_log_append_error (priv->schematic, e->message);
+			schematic_log_append_error (priv->schematic, "\n");
+		}
+		g_clear_error (&e);
+		g_signal_emit_by_name (G_OBJECT (ngspice), "aborted");
+	} else {
+		priv->analysis = analysis;
+		priv->num_analysis = g_list_length (analysis);
+		g_signal_emit_by_name (G_OBJECT (ngspice), "done");
+	}
+
+	// taken at start
+	g_object_unref (ngspice);
+}
+
+/**
+ * Sends the netlist to a simulation daemon that is shared with other
+ * instances. Returns FALSE if there is none, then ngspice runs locally.
+ */
+static gboolean ngspice_start_daemon (OreganoNgSpice *ngspice)
+{
+	OreganoNgSpicePriv *priv = ngspice->priv;
+	gchar *socket_path = sim_daemon_get_default_socket_path ();
+	gchar *netlist = NULL;
+
+	if (!sim_daemon_client_is_available (socket_path) ||
+	    !g_file_get_contents (priv->netlist_file, &netlist, NULL, NULL)) {
+		schematic_log_append (priv->schematic,
+		                      _ ("No simulation daemon running, ngspice runs locally.\n"));
+		g_free (socket_path);
+		return FALSE;
+	}
+
+	priv->daemon_cancellable = g_cancellable_new ();
+	sim_daemon_client_run_async (socket_path, netlist, schematic_get_sim_settings (priv->schematic),
+	                             priv->daemon_cancellable, (GAsyncReadyCallback)ngspice_daemon_done,
+	                             g_object_ref (ngspice));
+
+	g_free (netlist);
+	g_free (socket_path);
+	return TRUE;
+}
+
 static void ngspice_start (OreganoEngine *self)
 {
 	OreganoNgSpice *ngspice = OREGANO_NGSPICE (self);
 	OreganoNgSpicePriv *priv = ngspice->priv;
 
 	GError *e = NULL;
-	if (!oregano_engine_generate_netlist (self, "/tmp/netlist.tmp", &e)) {
+	if (!oregano_engine_generate_netlist (self, priv->netlist_file, &e)) {
 		priv->aborted = TRUE;
 		if (e)
 			schematic_log_append_error (priv->schematic, e->message);
@@ -386,6 +490,9 @@ static void ngspice_start (OreganoEngine *self)
 		return;
 	}
 
+	if (oregano.sim_daemon && ngspice_start_daemon (ngspice))
+		return;
+
 	NgspiceWatcherBuildAndLaunchResources *resources = ngspice_watcher_build_and_launch_resources_new(ngspice);
 	ngspice_watcher_build_and_launch(resources);
 	ngspice_watcher_build_and_launch_resources_finalize(resources);
@@ -402,6 +509,9 @@ static gchar *ngspice_get_operation_ngspice (OreganoEngine *self)
 {
 	OreganoNgSpicePriv *priv = OREGANO_NGSPICE (self)->priv;
 
+	if (priv->daemon_cancellable != NULL)
+		return g_strdup(_("simulation daemon solving"));
+
 	g_mutex_lock(&priv->progress_ngspice.progress_mutex);
 	gint64 old_time = priv->progress_ngspice.time;
 	g_mutex_unlock(&priv->progress_ngspice.progress_mutex);
@@ -456,6 +566,11 @@ static void ngspice_instance_init (GTypeInstance *instance, gpointer g_class)
 	self->priv->aborted = FALSE;
 
 	self->priv->cancel_info = cancel_info_new();
+
+	gchar *temp_base = oregano_engine_new_temp_base();
+	self->priv->netlist_file = g_strconcat(temp_base, ".netlist", NULL);
+	self->priv->result_file = g_strconcat(temp_base, ".lst", NULL);
+	g_free(temp_base);
 }
 
 OreganoEngine *oregano_ngspice_new (Schematic *sc)
@@ -63,5 +63,6 @@ struct _OreganoNgSpiceClass
 GType oregano_ngspice_get_type (void);
 OreganoEngine *oregano_ngspice_new (Schematic *sm);
 void ngspice_analysis_finalize(GList *analysis);
+GString *ngspice_generate_op_netlist_buffer (Schematic *sm, GError **error);
 
 #endif
@@ -0,0 +1,192 @@
+/*
+ * op-values.c
+ *
+ *
+ * Authors:
+ *  Michi <st101564@stud.uni-stuttgart.de>
+ *
+ * Web page: https://ahoi.io/project/oregano
+ *
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include <glib.h>
+#include <glib/gstdio.h>
+#include <gio/gio.h>
+#include <string.h>
+
+#include "../errors.h"
+#include "engine-internal.h"
+#include "ngspice.h"
+#include "op-values.h"
+
+static OpValues *op_values_new() {
+	OpValues *values = g_new0(OpValues, 1);
+
+	values->voltages = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, g_free);
+	values->currents = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, g_free);
+	return values;
+}
+
+void op_values_free(OpValues *values) {
+	if (values == NULL)
+		return;
+	g_hash_table_destroy(values->voltages);
+	g_hash_table_destroy(values->currents);
+	g_free(values);
+}
+
+static void op_values_insert(GHashTable *table, const gchar *name, gsize length, gdouble value) {
+	gdouble *slot = g_new(gdouble, 1);
+
+	*slot = value;
+	g_hash_table_insert(table, g_ascii_strdown(name, length), slot);
+}
+
+/**
+ * Everything that is not a "name = number" line (the banner, warnings,
+ * device parameters like @r1[i]) is skipped.
+ */
+OpValues *op_values_parse(const gchar *output) {
+	OpValues *values = op_values_new();
+	gchar **lines = g_strsplit(output, "\n", -1);
+
+	for (gchar **line = lines; *line != NULL; line++) {
+		gchar *name = g_strstrip(*line);
+		gchar *equal = strstr(name, " = ");
+		gchar *end;
+
+		if (equal == NULL || *name == '@')
+			continue;
+		gdouble value = g_ascii_strtod(equal + 3, &end);
+		if (end == equal + 3 || *end != '\0')
+			continue;
+		*equal = '\0';
+		g_strchomp(name);
+
+		gsize length = strlen(name);
+		if (g_str_has_suffix(name, "#branch"))
+			op_values_insert(values->currents, name, length - strlen("#branch"), value);
+		else if (length > 3 && g_ascii_tolower(name[0]) == 'v' && name[1] == '(' && name[length - 1] == ')')
+			op_values_insert(values->voltages, name + 2, length - 3, value);
+		else
+			op_values_insert(values->voltages, name, length, value);
+	}
+
+	g_strfreev(lines);
+	return values;
+}
+
+static gboolean op_values_lookup(GHashTable *table, const gchar *name, gdouble *value) {
+	g_autofree gchar *key = g_ascii_strdown(name, -1);
+	gdouble *slot = g_hash_table_lookup(table, key);
+
+	if (slot == NULL)
+		return FALSE;
+	*value = *slot;
+	return TRUE;
+}
+
+gboolean op_values_get_voltage(const OpValues *values, const gchar *node, gdouble *voltage) {
+	// ground is not printed
+	if (g_strcmp0(node, "0") == 0) {
+		*voltage = 0;
+		return TRUE;
+	}
+	return op_values_lookup(values->voltages, node, voltage);
+}
+
+gboolean op_values_get_current(const OpValues *values, const gchar *device, gdouble *current) {
+	return op_values_lookup(values->currents, device, current);
+}
+
+typedef struct {
+	gchar *netlist_file;
+	GCancellable *cancellable;
+	gulong cancel_id;
+} OpValuesRun;
+
+static void op_values_run_free(OpValuesRun *run) {
+	g_unlink(run->netlist_file);
+	g_free(run->netlist_file);
+	if (run->cancel_id != 0)
+		g_cancellable_disconnect(run->cancellable, run->cancel_id);
+	g_clear_object(&run->cancellable);
+	g_free(run);
+}
+
+static void op_values_kill(GCancellable *cancellable, GSubprocess *process) {
+	g_subprocess_force_exit(process);
+}
+
+static void op_values_communicated(GSubprocess *process, GAsyncResult *result, GTask *task) {
+	GError *e = NULL;
+	gchar *out = NULL;
+	gchar *err = NULL;
+
+	if (!g_subprocess_communicate_utf8_finish(process, result, &out, &err, &e)) {
+		g_task_return_error(task, e);
+	} else if (!g_subprocess_get_successful(process)) {
+		g_strstrip(err);
+		g_task_return_new_error(task, OREGANO_ERROR, OREGANO_SIMULATE_ERROR_ABORTED, "%s", err);
+	} else {
+		g_task_return_pointer(task, op_values_parse(out), (GDestroyNotify)op_values_free);
+	}
+
+	g_free(out);
+	g_free(err);
+	g_object_unref(task);
+}
+
+void op_values_run_async(Schematic *sm, GCancellable *cancellable, GAsyncReadyCallback callback, gpointer user_data) {
+	GError *e = NULL;
+	GTask *task = g_task_new(NULL, cancellable, callback, user_data);
+	OpValuesRun *run = g_new0(OpValuesRun, 1);
+	g_autofree gchar *temp_base = oregano_engine_new_temp_base();
+
+	run->netlist_file = g_strconcat(temp_base, ".netlist", NULL);
+	g_task_set_task_data(task, run, (GDestroyNotify)op_values_run_free);
+
+	GString *netlist = ngspice_generate_op_netlist_buffer(sm, &e);
+	if (netlist == NULL || !g_file_set_contents(run->netlist_file, netlist->str, netlist->len, &e)) {
+		if (netlist != NULL)
+			g_string_free(netlist, TRUE);
+		g_task_return_error(task, e);
+		g_object_unref(task);
+		return;
+	}
+	g_string_free(netlist, TRUE);
+
+	GSubprocess *process = g_subprocess_new(G_SUBPROCESS_FLAGS_STDOUT_PIPE | G_SUBPROCESS_FLAGS_STDERR_PIPE, &e, "ngspice", "-b", run->netlist_file, NULL);
+	if (process == NULL) {
+		g_task_return_error(task, e);
+		g_object_unref(task);
+		return;
+	}
+
+	// canceling only ends the communication, ngspice is killed separately
+	if (cancellable != NULL) {
+		run->cancellable = g_object_ref(cancellable);
+		run->cancel_id = g_cancellable_connect(cancellable, G_CALLBACK(op_values_kill), g_object_ref(process), g_object_unref);
+	}
+	g_subprocess_communicate_utf8_async(process, NULL, cancellable, (GAsyncReadyCallback)op_values_communicated, task);
+	g_object_unref(process);
+}
+
+OpValues *op_values_run_finish(GAsyncResult *result, GError **error) {
+	return g_task_propagate_pointer(G_TASK(result), error);
+}
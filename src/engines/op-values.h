@@ -0,0 +1,65 @@
+/*
+ * op-values.h
+ *
+ *
+ * Authors:
+ *  Michi <st101564@stud.uni-stuttgart.de>
+ *
+ * Web page: https://ahoi.io/project/oregano
+ *
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef ENGINES_OP_VALUES_H_
+#define ENGINES_OP_VALUES_H_
+
+#include <glib.h>
+#include <gio/gio.h>
+
+#include "schematic.h"
+
+/**
+ * The DC operating point of a schematic, without any of the analyses of
+ * the simulation settings, so it is cheap enough to annotate the sheet
+ * with it.
+ *
+ * ngspice prints the operating point as "name = value" lines, node
+ * voltages as v(node) and branch currents as device#branch. All names
+ * are lower case, lookups are case insensitive.
+ */
+
+typedef struct {
+	// node name -> gdouble
+	GHashTable *voltages;
+	// device name (like v_v1) -> gdouble
+	GHashTable *currents;
+} OpValues;
+
+OpValues *op_values_parse(const gchar *output);
+void op_values_free(OpValues *values);
+gboolean op_values_get_voltage(const OpValues *values, const gchar *node, gdouble *voltage);
+gboolean op_values_get_current(const OpValues *values, const gchar *device, gdouble *current);
+
+/**
+ * The netlist is generated right away, so the schematic may change
+ * while ngspice runs. Failures of ngspice are reported as
+ * OREGANO_SIMULATE_ERROR_ABORTED with its stderr.
+ */
+void op_values_run_async(Schematic *sm, GCancellable *cancellable, GAsyncReadyCallback callback, gpointer user_data);
+OpValues *op_values_run_finish(GAsyncResult *result, GError **error);
+
+#endif /* ENGINES_OP_VALUES_H_ */
@@ -0,0 +1,622 @@
+/*
+ * sim-daemon.c
+ *
+ *
+ * Authors:
+ *  Michi <st101564@stud.uni-stuttgart.de>
+ *
+ * Web page: https://ahoi.io/project/oregano
+ *
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include <glib.h>
+#include <glib/gi18n.h>
+#include <glib/gstdio.h>
+#include <glib-unix.h>
+#include <gio/gio.h>
+#include <gio/gunixsocketaddress.h>
+#include <string.h>
+#include <signal.h>
+
+#include "../tools/thread-pipe.h"
+#include "../tools/task-scheduler.h"
+#include "../sim-data-file.h"
+#include "../errors.h"
+#include "ngspice.h"
+#include "ngspice-analysis.h"
+#include "sim-daemon.h"
+
+#define SIM_DAEMON_MAGIC "OREGSIM"
+// netlists and settings are text, everything beyond is garbage
+#define SIM_DAEMON_MAX_REQUEST_BLOCK (64 << 20)
+
+struct _SimDaemon {
+	GSocketService *service;
+	gchar *socket_path;
+	// guards argv, set_simulator may be called while runs are going on
+	GMutex mutex;
+	gchar **argv;
+};
+
+gchar *sim_daemon_get_default_socket_path() {
+	return g_build_filename(g_get_user_runtime_dir(), "oregano-sim.sock", NULL);
+}
+
+/**
+ * Reads a u32 length followed by as many bytes. The block is 0 terminated
+ * for convenience.
+ */
+static gchar *sim_daemon_read_block(GDataInputStream *input, gsize max_length, gsize *length, GCancellable *cancellable, GError **error) {
+	GError *e = NULL;
+	gsize read;
+
+	guint32 n = g_data_input_stream_read_uint32(input, cancellable, &e);
+	if (e != NULL) {
+		g_propagate_error(error, e);
+		return NULL;
+	}
+	if (n > max_length) {
+		g_set_error(error, G_IO_ERROR, G_IO_ERROR_INVALID_DATA, "block of %u bytes is too large", n);
+		return NULL;
+	}
+
+	gchar *block = g_malloc((gsize)n + 1);
+	if (!g_input_stream_read_all(G_INPUT_STREAM(input), block, n, &read, cancellable, error)) {
+		g_free(block);
+		return NULL;
+	}
+	if (read != n) {
+		g_set_error(error, G_IO_ERROR, G_IO_ERROR_INVALID_DATA, "connection closed in the middle of a block");
+		g_free(block);
+		return NULL;
+	}
+	block[n] = 0;
+	*length = n;
+	return block;
+}
+
+static gboolean sim_daemon_write_block(GDataOutputStream *output, const gchar *block, gsize length, GCancellable *cancellable, GError **error) {
+	return g_data_output_stream_put_uint32(output, length, cancellable, error) &&
+			g_output_stream_write_all(G_OUTPUT_STREAM(output), block, length, NULL, cancellable, error);
+}
+
+static gboolean sim_daemon_write_frame(GDataOutputStream *output, SimDaemonFrame kind, const gchar *payload, gsize length, GError **error) {
+	return g_data_output_stream_put_uint32(output, kind, NULL, error) &&
+			sim_daemon_write_block(output, payload, length, NULL, error);
+}
+
+static GDataInputStream *sim_daemon_input_new(GIOStream *stream) {
+	GDataInputStream *input = g_data_input_stream_new(g_io_stream_get_input_stream(stream));
+	g_data_input_stream_set_byte_order(input, G_DATA_STREAM_BYTE_ORDER_LITTLE_ENDIAN);
+	return input;
+}
+
+static GDataOutputStream *sim_daemon_output_new(GIOStream *stream) {
+	GDataOutputStream *output = g_data_output_stream_new(g_io_stream_get_output_stream(stream));
+	g_data_output_stream_set_byte_order(output, G_DATA_STREAM_BYTE_ORDER_LITTLE_ENDIAN);
+	return output;
+}
+
+/**
+ * Daemon
+ */
+
+static gboolean sim_daemon_read_request(GDataInputStream *input, gchar **settings_data, gsize *settings_length, gchar **netlist, gsize *netlist_length, GError **error) {
+	gchar magic[sizeof(SIM_DAEMON_MAGIC)];
+	gsize read;
+	GError *e = NULL;
+
+	if (!g_input_stream_read_all(G_INPUT_STREAM(input), magic, sizeof(magic), &read, NULL, error))
+		return FALSE;
+	if (read != sizeof(magic) || memcmp(magic, SIM_DAEMON_MAGIC, sizeof(magic)) != 0) {
+		g_set_error(error, G_IO_ERROR, G_IO_ERROR_INVALID_DATA, "not a simulation request");
+		return FALSE;
+	}
+
+	guint32 version = g_data_input_stream_read_uint32(input, NULL, &e);
+	if (e != NULL) {
+		g_propagate_error(error, e);
+		return FALSE;
+	}
+	if (version != SIM_DAEMON_VERSION) {
+		g_set_error(error, G_IO_ERROR, G_IO_ERROR_NOT_SUPPORTED, "protocol version %u is not supported", version);
+		return FALSE;
+	}
+
+	*settings_data = sim_daemon_read_block(input, SIM_DAEMON_MAX_REQUEST_BLOCK, settings_length, NULL, error);
+	if (*settings_data == NULL)
+		return FALSE;
+	*netlist = sim_daemon_read_block(input, SIM_DAEMON_MAX_REQUEST_BLOCK, netlist_length, NULL, error);
+	return *netlist != NULL;
+}
+
+/**
+ * Wraps the parser into a task.
+ *
+ * Runs also if canceled, because it has to read the pipe to the end.
+ */
+static void sim_daemon_parse(NgspiceAnalysisResources *resources, CancelInfo *cancel_info) {
+	ngspice_analysis(resources);
+}
+
+static void sim_daemon_set_failed(GError **error, const gchar *stderr_file) {
+	gchar *message = NULL;
+
+	g_file_get_contents(stderr_file, &message, NULL, NULL);
+	if (message != NULL)
+		g_strstrip(message);
+	if (message == NULL || *message == 0)
+		g_set_error(error, OREGANO_ERROR, OREGANO_SIMULATE_ERROR_ABORTED, "the simulator exited abnormally");
+	else
+		g_set_error(error, OREGANO_ERROR, OREGANO_SIMULATE_ERROR_ABORTED, "%s", message);
+	g_free(message);
+}
+
+/**
+ * Runs the simulator on @netlist and parses its stdout while it is written,
+ * the same way ngspice-watcher does for a local run. stderr goes to a file,
+ * it is only interesting if something went wrong.
+ */
+static GList *sim_daemon_simulate(SimDaemon *daemon, const gchar *netlist, gsize netlist_length, const SimSettings *sim_settings, GError **error) {
+	gchar *netlist_file = NULL;
+	GList *analysis = NULL;
+
+	gint fd = g_file_open_tmp("oregano-daemon-XXXXXX.netlist", &netlist_file, error);
+	if (fd < 0)
+		return NULL;
+	g_close(fd, NULL);
+	gchar *stderr_file = g_strconcat(netlist_file, ".err", NULL);
+
+	if (!g_file_set_contents(netlist_file, netlist, netlist_length, error))
+		goto out;
+
+	g_mutex_lock(&daemon->mutex);
+	GPtrArray *argv = g_ptr_array_new_with_free_func(g_free);
+	for (int i = 0; daemon->argv[i] != NULL; i++)
+		g_ptr_array_add(argv, g_strdup(daemon->argv[i]));
+	g_mutex_unlock(&daemon->mutex);
+	g_ptr_array_add(argv, g_strdup(netlist_file));
+	g_ptr_array_add(argv, NULL);
+
+	GSubprocessLauncher *launcher = g_subprocess_launcher_new(G_SUBPROCESS_FLAGS_STDOUT_PIPE);
+	g_subprocess_launcher_set_stderr_file_path(launcher, stderr_file);
+	GSubprocess *process = g_subprocess_launcher_spawnv(launcher, (const gchar * const *)argv->pdata, error);
+	g_object_unref(launcher);
+	g_ptr_array_free(argv, TRUE);
+	if (process == NULL)
+		goto out;
+
+	guint num_analysis = 0;
+	AnalysisTypeShared current;
+	current.type = ANALYSIS_TYPE_NONE;
+	g_mutex_init(&current.mutex);
+	ProgressResources progress_reader;
+	progress_reader.progress = 0.0;
+	progress_reader.time = g_get_monotonic_time();
+	g_mutex_init(&progress_reader.progress_mutex);
+
+	NgspiceAnalysisResources resources = {0};
+	resources.pipe = thread_pipe_new(THREAD_PIPE_MAX_BUFFER_BLOCK_COUNTER_DEFAULT, THREAD_PIPE_MAX_BUFFER_SIZE_TOTAL_DEFAULT);
+	resources.sim_settings = sim_settings;
+	resources.current = &current;
+	resources.analysis = &analysis;
+	resources.num_analysis = &num_analysis;
+	resources.progress_reader = &progress_reader;
+	resources.cancel_info = cancel_info_new();
+
+	// blocking, because it waits for the pipe most of the time
+	Task *parser = task_new((TaskFunc)sim_daemon_parse, &resources, NULL);
+	task_set_priority(parser, TASK_PRIORITY_HIGH);
+	task_set_flags(parser, TASK_FLAG_BLOCKING);
+	task_set_cancel_info(parser, resources.cancel_info);
+	task_scheduler_submit(task_scheduler_get_default(), task_ref(parser));
+
+	// the parser wants the lines with their terminator, like g_io_channel_read_line gives them
+	GDataInputStream *stdout_stream = g_data_input_stream_new(g_subprocess_get_stdout_pipe(process));
+	GString *line_buffer = g_string_new(NULL);
+	gchar *line;
+	gsize length;
+	while ((line = g_data_input_stream_read_line(stdout_stream, &length, NULL, NULL)) != NULL) {
+		g_string_assign(line_buffer, line);
+		g_string_append_c(line_buffer, '\n');
+		thread_pipe_push(resources.pipe, line_buffer->str, line_buffer->len + 1);
+		g_free(line);
+	}
+	thread_pipe_set_write_eof(resources.pipe);
+	g_string_free(line_buffer, TRUE);
+	g_object_unref(stdout_stream);
+
+	gboolean exited_normal = g_subprocess_wait(process, NULL, NULL) && g_subprocess_get_successful(process);
+	g_object_unref(process);
+
+	task_wait(parser);
+	task_unref(parser);
+	cancel_info_unsubscribe(resources.cancel_info);
+	g_mutex_clear(&current.mutex);
+	g_mutex_clear(&progress_reader.progress_mutex);
+
+	if (!exited_normal) {
+		sim_daemon_set_failed(error, stderr_file);
+		ngspice_analysis_finalize(analysis);
+		analysis = NULL;
+	} else if (num_analysis == 0) {
+		g_set_error(error, OREGANO_ERROR, OREGANO_SIMULATE_ERROR_ABORTED, _("Too few or none analysis found"));
+		ngspice_analysis_finalize(analysis);
+		analysis = NULL;
+	}
+
+out:
+	g_remove(netlist_file);
+	g_remove(stderr_file);
+	g_free(netlist_file);
+	g_free(stderr_file);
+	return analysis;
+}
+
+/**
+ * Handles one connection, in a thread of the socket service. The number
+ * of threads is the number of simulators that may run at once.
+ */
+static gboolean sim_daemon_run(GThreadedSocketService *service, GSocketConnection *connection, GObject *source_object, SimDaemon *daemon) {
+	GDataInputStream *input = sim_daemon_input_new(G_IO_STREAM(connection));
+	GDataOutputStream *output = sim_daemon_output_new(G_IO_STREAM(connection));
+	gchar *settings_data = NULL;
+	gchar *netlist = NULL;
+	gsize settings_length, netlist_length;
+	SimSettings *sim_settings = NULL;
+	GList *analysis = NULL;
+	GError *e = NULL;
+
+	if (sim_daemon_read_request(input, &settings_data, &settings_length, &netlist, &netlist_length, &e) &&
+			(sim_settings = sim_settings_new_from_data(settings_data, settings_length, &e)) != NULL)
+		analysis = sim_daemon_simulate(daemon, netlist, netlist_length, sim_settings, &e);
+
+	if (e != NULL) {
+		// the client might be gone already, nothing to do about it then
+		sim_daemon_write_frame(output, SIM_DAEMON_FRAME_ERROR, e->message, strlen(e->message), NULL);
+		g_clear_error(&e);
+	} else {
+		for (GList *iter = analysis; iter != NULL && e == NULL; iter = iter->next) {
+			GList single = {iter->data, NULL, NULL};
+			GString *buffer = sim_data_file_serialize(&single);
+			if (buffer->len > SIM_DAEMON_MAX_RESPONSE_BLOCK) {
+				// the client would refuse it
+				g_set_error(&e, OREGANO_ERROR, OREGANO_SIMULATE_ERROR_ABORTED, _("The results of the simulation are too large"));
+				sim_daemon_write_frame(output, SIM_DAEMON_FRAME_ERROR, e->message, strlen(e->message), NULL);
+			} else {
+				sim_daemon_write_frame(output, SIM_DAEMON_FRAME_ANALYSIS, buffer->str, buffer->len, &e);
+			}
+			g_string_free(buffer, TRUE);
+		}
+		if (e == NULL)
+			sim_daemon_write_frame(output, SIM_DAEMON_FRAME_END, "", 0, NULL);
+		g_clear_error(&e);
+	}
+
+	ngspice_analysis_finalize(analysis);
+	if (sim_settings != NULL)
+		sim_settings_finalize(sim_settings);
+	g_free(settings_data);
+	g_free(netlist);
+	g_object_unref(input);
+	g_object_unref(output);
+	return TRUE;
+}
+
+/**
+ * A socket file that nobody answers on was left behind by a daemon that
+ * did not exit cleanly.
+ */
+static gboolean sim_daemon_claim_socket_path(const gchar *socket_path, GError **error) {
+	if (!g_file_test(socket_path, G_FILE_TEST_EXISTS))
+		return TRUE;
+
+	if (sim_daemon_client_is_available(socket_path)) {
+		g_set_error(error, G_IO_ERROR, G_IO_ERROR_ADDRESS_IN_USE, _("A simulation daemon is already listening on %s"), socket_path);
+		return FALSE;
+	}
+	g_remove(socket_path);
+	return TRUE;
+}
+
+static void sim_daemon_destroy(SimDaemon *daemon, GClosure *closure) {
+	g_mutex_clear(&daemon->mutex);
+	g_strfreev(daemon->argv);
+	g_free(daemon->socket_path);
+	g_free(daemon);
+}
+
+//data wrapper
+typedef struct {
+	SimDaemon *daemon;
+	guint n_simulators;
+	GError *error;
+	gboolean finished;
+	GMutex mutex;
+	GCond cond;
+} SimDaemonStart;
+
+/**
+ * Runs in the io context, so the service accepts there.
+ */
+static gboolean sim_daemon_start(SimDaemonStart *start) {
+	SimDaemon *daemon = start->daemon;
+	GSocketAddress *address = g_unix_socket_address_new(daemon->socket_path);
+
+	daemon->service = g_threaded_socket_service_new(start->n_simulators);
+	if (g_socket_listener_add_address(G_SOCKET_LISTENER(daemon->service), address, G_SOCKET_TYPE_STREAM, G_SOCKET_PROTOCOL_DEFAULT, NULL, NULL, &start->error)) {
+		// the daemon lives as long as the service, which waits for its runs
+		g_signal_connect_data(daemon->service, "run", G_CALLBACK(sim_daemon_run), daemon, (GClosureNotify)sim_daemon_destroy, 0);
+		g_socket_service_start(daemon->service);
+	}
+	g_object_unref(address);
+
+	g_mutex_lock(&start->mutex);
+	start->finished = TRUE;
+	g_cond_signal(&start->cond);
+	g_mutex_unlock(&start->mutex);
+	return G_SOURCE_REMOVE;
+}
+
+SimDaemon *sim_daemon_new(const gchar *socket_path, guint n_simulators, GError **error) {
+	const gchar * const argv[] = {"ngspice", "-b", NULL};
+	SimDaemonStart start = {0};
+
+	g_return_val_if_fail(socket_path != NULL, NULL);
+	g_return_val_if_fail(n_simulators > 0, NULL);
+
+	if (!sim_daemon_claim_socket_path(socket_path, error))
+		return NULL;
+
+	SimDaemon *daemon = g_new0(SimDaemon, 1);
+	daemon->socket_path = g_strdup(socket_path);
+	daemon->argv = g_strdupv((gchar **)argv);
+	g_mutex_init(&daemon->mutex);
+
+	start.daemon = daemon;
+	start.n_simulators = n_simulators;
+	g_mutex_init(&start.mutex);
+	g_cond_init(&start.cond);
+	g_main_context_invoke(task_scheduler_get_io_context(task_scheduler_get_default()), (GSourceFunc)sim_daemon_start, &start);
+	g_mutex_lock(&start.mutex);
+	while (!start.finished)
+		g_cond_wait(&start.cond, &start.mutex);
+	g_mutex_unlock(&start.mutex);
+	g_mutex_clear(&start.mutex);
+	g_cond_clear(&start.cond);
+
+	if (start.error != NULL) {
+		g_propagate_error(error, start.error);
+		g_object_unref(daemon->service);
+		sim_daemon_destroy(daemon, NULL);
+		return NULL;
+	}
+	return daemon;
+}
+
+void sim_daemon_free(SimDaemon *daemon) {
+	g_return_if_fail(daemon != NULL);
+
+	g_socket_service_stop(daemon->service);
+	g_socket_listener_close(G_SOCKET_LISTENER(daemon->service));
+	g_remove(daemon->socket_path);
+	// daemon itself goes with the last run
+	g_object_unref(daemon->service);
+}
+
+void sim_daemon_set_simulator(SimDaemon *daemon, const gchar * const *argv) {
+	g_return_if_fail(daemon != NULL);
+	g_return_if_fail(argv != NULL && argv[0] != NULL);
+
+	g_mutex_lock(&daemon->mutex);
+	g_strfreev(daemon->argv);
+	daemon->argv = g_strdupv((gchar **)argv);
+	g_mutex_unlock(&daemon->mutex);
+}
+
+static gboolean sim_daemon_quit(GMainLoop *loop) {
+	g_main_loop_quit(loop);
+	return G_SOURCE_CONTINUE;
+}
+
+int sim_daemon_main(const gchar *socket_path) {
+	GError *e = NULL;
+	gchar *path = socket_path != NULL ? g_strdup(socket_path) : sim_daemon_get_default_socket_path();
+
+	SimDaemon *daemon = sim_daemon_new(path, g_get_num_processors(), &e);
+	if (daemon == NULL) {
+		g_printerr("oregano: %s\n", e->message);
+		g_clear_error(&e);
+		g_free(path);
+		return 1;
+	}
+	g_print(_("Simulation daemon listening on %s\n"), path);
+
+	GMainLoop *loop = g_main_loop_new(NULL, FALSE);
+	guint sigint = g_unix_signal_add(SIGINT, (GSourceFunc)sim_daemon_quit, loop);
+	guint sigterm = g_unix_signal_add(SIGTERM, (GSourceFunc)sim_daemon_quit, loop);
+	g_main_loop_run(loop);
+	g_source_remove(sigint);
+	g_source_remove(sigterm);
+	g_main_loop_unref(loop);
+
+	sim_daemon_free(daemon);
+	g_free(path);
+	return 0;
+}
+
+/**
+ * Client
+ */
+
+static GSocketConnection *sim_daemon_client_connect(const gchar *socket_path, GCancellable *cancellable, GError **error) {
+	GSocketClient *client = g_socket_client_new();
+	GSocketAddress *address = g_unix_socket_address_new(socket_path);
+
+	GSocketConnection *connection = g_socket_client_connect(client, G_SOCKET_CONNECTABLE(address), cancellable, error);
+
+	g_object_unref(address);
+	g_object_unref(client);
+	return connection;
+}
+
+gboolean sim_daemon_client_is_available(const gchar *socket_path) {
+	GSocketConnection *connection = sim_daemon_client_connect(socket_path, NULL, NULL);
+
+	if (connection == NULL)
+		return FALSE;
+	g_object_unref(connection);
+	return TRUE;
+}
+
+static gboolean sim_daemon_client_send(GDataOutputStream *output, const gchar *settings_data, gsize settings_length, const gchar *netlist, GCancellable *cancellable, GError **error) {
+	return g_output_stream_write_all(G_OUTPUT_STREAM(output), SIM_DAEMON_MAGIC, sizeof(SIM_DAEMON_MAGIC), NULL, cancellable, error) &&
+			g_data_output_stream_put_uint32(output, SIM_DAEMON_VERSION, cancellable, error) &&
+			sim_daemon_write_block(output, settings_data, settings_length, cancellable, error) &&
+			sim_daemon_write_block(output, netlist, strlen(netlist), cancellable, error);
+}
+
+/**
+ * Collects the analyses until the daemon says it is done.
+ */
+static GList *sim_daemon_client_receive(GDataInputStream *input, GCancellable *cancellable, GError **error) {
+	GList *analysis = NULL;
+
+	for (;;) {
+		GError *e = NULL;
+		gsize length;
+
+		SimDaemonFrame kind = g_data_input_stream_read_uint32(input, cancellable, &e);
+		gchar *payload = e == NULL ? sim_daemon_read_block(input, SIM_DAEMON_MAX_RESPONSE_BLOCK, &length, cancellable, &e) : NULL;
+		if (payload == NULL) {
+			g_propagate_error(error, e);
+			break;
+		}
+
+		if (kind == SIM_DAEMON_FRAME_ANALYSIS) {
+			GList *single = sim_data_file_deserialize(payload, length, error);
+			g_free(payload);
+			if (single == NULL)
+				break;
+			analysis = g_list_concat(analysis, single);
+			continue;
+		}
+
+		if (kind == SIM_DAEMON_FRAME_END && analysis != NULL) {
+			g_free(payload);
+			return analysis;
+		} else if (kind == SIM_DAEMON_FRAME_END) {
+			g_set_error(error, OREGANO_ERROR, OREGANO_SIMULATE_ERROR_ABORTED, _("Too few or none analysis found"));
+		} else if (kind == SIM_DAEMON_FRAME_ERROR) {
+			g_set_error(error, OREGANO_ERROR, OREGANO_SIMULATE_ERROR_ABORTED, "%s", payload);
+		} else {
+			g_set_error(error, G_IO_ERROR, G_IO_ERROR_INVALID_DATA, "unknown frame %u from the simulation daemon", kind);
+		}
+		g_free(payload);
+		break;
+	}
+
+	sim_data_file_free_analyses(analysis);
+	return NULL;
+}
+
+static GList *sim_daemon_client_run_data(const gchar *socket_path, const gchar *netlist, const gchar *settings_data, gsize settings_length, GCancellable *cancellable, GError **error) {
+	GSocketConnection *connection = sim_daemon_client_connect(socket_path, cancellable, error);
+	GList *analysis = NULL;
+
+	if (connection == NULL)
+		return NULL;
+
+	GDataOutputStream *output = sim_daemon_output_new(G_IO_STREAM(connection));
+	GDataInputStream *input = sim_daemon_input_new(G_IO_STREAM(connection));
+
+	if (sim_daemon_client_send(output, settings_data, settings_length, netlist, cancellable, error))
+		analysis = sim_daemon_client_receive(input, cancellable, error);
+
+	g_object_unref(input);
+	g_object_unref(output);
+	// closing makes a daemon that is still simulating drop the results
+	g_object_unref(connection);
+	return analysis;
+}
+
+GList *sim_daemon_client_run(const gchar *socket_path, const gchar *netlist, const SimSettings *sim_settings, GCancellable *cancellable, GError **error) {
+	gsize settings_length;
+	gchar *settings_data = sim_settings_to_data(sim_settings, &settings_length);
+
+	GList *analysis = sim_daemon_client_run_data(socket_path, netlist, settings_data, settings_length, cancellable, error);
+
+	g_free(settings_data);
+	return analysis;
+}
+
+//data wrapper
+typedef struct {
+	gchar *socket_path;
+	gchar *netlist;
+	gchar *settings_data;
+	gsize settings_length;
+} SimDaemonClientInput;
+
+static void sim_daemon_client_input_free(SimDaemonClientInput *input) {
+	g_free(input->socket_path);
+	g_free(input->netlist);
+	g_free(input->settings_data);
+	g_free(input);
+}
+
+static void sim_daemon_client_task(GTask *task, CancelInfo *cancel_info) {
+	SimDaemonClientInput *input = g_task_get_task_data(task);
+	GError *e = NULL;
+
+	GList *analysis = sim_daemon_client_run_data(input->socket_path, input->netlist, input->settings_data, input->settings_length, g_task_get_cancellable(task), &e);
+	if (analysis == NULL)
+		g_task_return_error(task, e);
+	else
+		g_task_return_pointer(task, analysis, (GDestroyNotify)sim_data_file_free_analyses);
+}
+
+/**
+ * Like sim_daemon_client_run, but waits for the daemon in the task
+ * scheduler. The netlist and the settings are copied before this
+ * returns. @callback is invoked in the thread default main context of
+ * the caller.
+ */
+void sim_daemon_client_run_async(const gchar *socket_path, const gchar *netlist, const SimSettings *sim_settings, GCancellable *cancellable, GAsyncReadyCallback callback, gpointer user_data) {
+	GTask *task = g_task_new(NULL, cancellable, callback, user_data);
+	SimDaemonClientInput *input = g_new0(SimDaemonClientInput, 1);
+
+	g_task_set_source_tag(task, sim_daemon_client_run_async);
+
+	input->socket_path = g_strdup(socket_path);
+	input->netlist = g_strdup(netlist);
+	input->settings_data = sim_settings_to_data(sim_settings, &input->settings_length);
+	g_task_set_task_data(task, input, (GDestroyNotify)sim_daemon_client_input_free);
+
+	// blocking, because it waits for the daemon most of the time
+	Task *scheduler_task = task_new((TaskFunc)sim_daemon_client_task, g_object_ref(task), g_object_unref);
+	task_set_flags(scheduler_task, TASK_FLAG_BLOCKING);
+	task_scheduler_submit(task_scheduler_get_default(), scheduler_task);
+	g_object_unref(task);
+}
+
+GList *sim_daemon_client_run_finish(GAsyncResult *result, GError **error) {
+	g_return_val_if_fail(g_task_is_valid(result, NULL), NULL);
+
+	return g_task_propagate_pointer(G_TASK(result), error);
+}
@@ -0,0 +1,99 @@
+/*
+ * sim-daemon.h
+ *
+ *
+ * Authors:
+ *  Michi <st101564@stud.uni-stuttgart.de>
+ *
+ * Web page: https://ahoi.io/project/oregano
+ *
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef ENGINES_SIM_DAEMON_H_
+#define ENGINES_SIM_DAEMON_H_
+
+#include <glib.h>
+#include <gio/gio.h>
+
+#include "../sim-settings.h"
+
+/**
+ * A local simulation server several Oregano instances share over a
+ * UNIX domain socket.
+ *
+ * A client sends one netlist together with the simulation settings
+ * (the parser needs them to make sense of the output) per connection.
+ * The daemon runs at most n_simulators simulator processes at once,
+ * further connections wait until one is free. The output is parsed in
+ * the daemon and every analysis is sent back as soon as the simulator
+ * is done, in the format of sim-data-file.
+ *
+ * Protocol, everything little endian:
+ *
+ *   request:  "OREGSIM" '\0', u32 version,
+ *             u32 length + settings (see sim_settings_to_data),
+ *             u32 length + netlist
+ *   response: frames of u32 kind + u32 length + payload,
+ *             kind is one of SimDaemonFrame, the last one is END or ERROR
+ */
+
+#define SIM_DAEMON_VERSION 1
+
+// larger response payloads are refused by the client
+#define SIM_DAEMON_MAX_RESPONSE_BLOCK (512 << 20)
+
+typedef enum {
+	// payload: one analysis, see sim_data_file_serialize
+	SIM_DAEMON_FRAME_ANALYSIS = 1,
+	// payload: empty
+	SIM_DAEMON_FRAME_END,
+	// payload: message
+	SIM_DAEMON_FRAME_ERROR
+} SimDaemonFrame;
+
+typedef struct _SimDaemon SimDaemon;
+
+// $XDG_RUNTIME_DIR/oregano-sim.sock
+gchar *sim_daemon_get_default_socket_path();
+
+/**
+ * Starts listening on @socket_path. The connections are accepted in the
+ * io context of the task scheduler, so no main loop is needed.
+ */
+SimDaemon *sim_daemon_new(const gchar *socket_path, guint n_simulators, GError **error);
+// Stops listening, runs that are in progress are finished.
+void sim_daemon_free(SimDaemon *daemon);
+// The path of the netlist is appended to @argv. Default: ngspice -b
+void sim_daemon_set_simulator(SimDaemon *daemon, const gchar * const *argv);
+
+// Runs a daemon until it gets SIGINT or SIGTERM, for oregano --sim-daemon.
+int sim_daemon_main(const gchar *socket_path);
+
+/**
+ * Client
+ *
+ * The analyses are owned by the caller, free them with
+ * sim_data_file_free_analyses. A failed simulation is reported as
+ * OREGANO_SIMULATE_ERROR_ABORTED with the stderr of the simulator.
+ */
+gboolean sim_daemon_client_is_available(const gchar *socket_path);
+GList *sim_daemon_client_run(const gchar *socket_path, const gchar *netlist, const SimSettings *sim_settings, GCancellable *cancellable, GError **error);
+void sim_daemon_client_run_async(const gchar *socket_path, const gchar *netlist, const SimSettings *sim_settings, GCancellable *cancellable, GAsyncReadyCallback callback, gpointer user_data);
+GList *sim_daemon_client_run_finish(GAsyncResult *result, GError **error);
+
+#endif /* ENGINES_SIM_DAEMON_H_ */
@@ -46,7 +46,15 @@ typedef enum {
 	OREGANO_SCHEMATIC_BAD_FILE_FORMAT,
 	OREGANO_SCHEMATIC_FILE_NOT_FOUND,
 	OREGANO_UI_ERROR_NO_BUILDER,
-	OREGANO_OOM
+	OREGANO_OOM,
+	OREGANO_MEASURE_ERROR_NO_SUCH_VARIABLE,
+	OREGANO_MEASURE_ERROR_BAD_DATA,
+	OREGANO_MEASURE_ERROR_NOT_FOUND,
+	OREGANO_RESULT_FILE_BAD_FORMAT,
+	OREGANO_RESULT_ERROR_DROPPED,
+	OREGANO_COMPARE_ERROR_MISMATCH,
+	OREGANO_COMPARE_ERROR_NO_OVERLAP,
+	OREGANO_SIMULATE_ERROR_ABORTED
 } OREGANO_ERRORS;
 
 #endif
@@ -31,7 +31,9 @@
 #include "file-manager.h"
 
 FileType file_types[] = {
-    FILE_TYPE ("oregano", "Oregano Schematic File", schematic_parse_xml_file, schematic_write_xml)};
+    FILE_TYPE ("oregano", "Oregano Schematic File", schematic_parse_xml_file, schematic_write_xml),
+    FILE_TYPE ("oregbin", "Oregano Binary Schematic File", schematic_parse_binary_file,
+               schematic_write_binary)};
 
 #define FILE_TYPES_COUNT (sizeof(file_types) / sizeof(FileType))
 
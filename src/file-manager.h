@@ -37,6 +37,7 @@
 #include "schematic.h"
 #include "load-schematic.h"
 #include "save-schematic.h"
+#include "binary-schematic.h"
 
 #define FILE_TYPE(a, b, c, d)                                                                      \
 	{                                                                                              \
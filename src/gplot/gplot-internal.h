@@ -68,6 +68,8 @@ struct _GPlotFunctionClass
 
 	void (*draw)(GPlotFunction *, cairo_t *, GPlotFunctionBBox *);
 	void (*get_bbox)(GPlotFunction *, GPlotFunctionBBox *);
+	gboolean (*get_value)(GPlotFunction *, gdouble, gdouble *);
+	gboolean (*get_range)(GPlotFunction *, gdouble, gdouble, gdouble *, gdouble *);
 };
 
 #endif
@@ -33,6 +33,8 @@
 #include "gplot.h"
 
 #define BORDER_SIZE 50
+// how close (in pixels) the pointer has to be to grab a cursor
+#define CURSOR_GRAB_DISTANCE 5
 
 static void g_plot_class_init (GPlotClass *class);
 static void g_plot_init (GPlot *plot);
@@ -42,12 +44,24 @@ static gboolean g_plot_motion_cb (GtkWidget *, GdkEventMotion *, GPlot *);
 static gboolean g_plot_button_press_cb (GtkWidget *, GdkEventButton *, GPlot *);
 static gboolean g_plot_button_release_cb (GtkWidget *, GdkEventButton *, GPlot *);
 static void g_plot_update_bbox (GPlot *);
+static void g_plot_autoscale_y (GPlot *);
 static void g_plot_finalize (GObject *object);
 static void g_plot_dispose (GObject *object);
 
 static void get_order_of_magnitude (gdouble val, gdouble *man, gdouble *pw);
 
-enum { ACTION_NONE, ACTION_STARTING_PAN, ACTION_PAN, ACTION_STARTING_REGION, ACTION_REGION };
+enum {
+	ACTION_NONE,
+	ACTION_STARTING_PAN,
+	ACTION_PAN,
+	ACTION_STARTING_REGION,
+	ACTION_REGION,
+	ACTION_CURSOR
+};
+
+enum { CURSORS_CHANGED, LAST_SIGNAL };
+
+static guint g_plot_signals[LAST_SIGNAL] = {0};
 
 static GtkLayoutClass *parent_class = NULL;
 
@@ -81,6 +95,13 @@ struct _GPlotPriv
 	GPlotFunctionBBox viewport_bbox;
 
 	GPlotFunctionBBox rubberband;
+
+	gboolean autoscale_y;
+
+	// measurement cursors, in window coordinates
+	gboolean cursor_visible[GPLOT_N_CURSORS];
+	gdouble cursor_x[GPLOT_N_CURSORS];
+	guint dragged_cursor;
 };
 
 GType g_plot_get_type ()
@@ -107,6 +128,10 @@ static void g_plot_class_init (GPlotClass *class)
 
 	widget_class->draw = g_plot_draw;
 
+	g_plot_signals[CURSORS_CHANGED] =
+	    g_signal_new ("cursors-changed", TYPE_GPLOT, G_SIGNAL_RUN_FIRST, 0, NULL, NULL,
+	                  g_cclosure_marshal_VOID__VOID, G_TYPE_NONE, 0);
+
 	object_class->dispose = g_plot_dispose;
 	object_class->finalize = g_plot_finalize;
 }
@@ -316,6 +341,8 @@ static gboolean g_plot_draw (GtkWidget *widget, cairo_t *cr)
 	if (!priv->window_valid) {
 		g_plot_update_bbox (plot);
 	}
+	if (priv->autoscale_y)
+		g_plot_autoscale_y (plot);
 
 	width = gtk_widget_get_allocated_width (widget);
 	height = gtk_widget_get_allocated_height (widget);
@@ -468,6 +495,34 @@ static gboolean g_plot_draw (GtkWidget *widget, cairo_t *cr)
 		cairo_restore (cr);
 	}
 
+	//plot measurement cursors
+	cairo_save (cr);
+	cairo_rectangle (cr, priv->left_border, priv->right_border, graph_width, graph_height);
+	cairo_clip (cr);
+	cairo_set_line_width (cr, 1);
+	cairo_set_font_size (cr, 12);
+	for (guint i = 0; i < GPLOT_N_CURSORS; i++) {
+		gdouble x, y = 0.0;
+
+		if (!priv->cursor_visible[i])
+			continue;
+
+		x = priv->cursor_x[i];
+		cairo_matrix_transform_point (&priv->matrix, &x, &y);
+		x = floor (x) + 0.5;
+
+		if (i == GPLOT_CURSOR_A)
+			cairo_set_source_rgb (cr, 1.0, 1.0, 0.0);
+		else
+			cairo_set_source_rgb (cr, 0.0, 1.0, 1.0);
+		cairo_move_to (cr, x, priv->viewport_bbox.ymin);
+		cairo_line_to (cr, x, priv->viewport_bbox.ymax);
+		cairo_stroke (cr);
+		cairo_move_to (cr, x + 3, priv->viewport_bbox.ymin + 12);
+		cairo_show_text (cr, i == GPLOT_CURSOR_A ? "A" : "B");
+	}
+	cairo_restore (cr);
+
 	//plot rubberband (zoom-in-rectangle)
 	if (priv->action == ACTION_REGION) {
 		gdouble x, y, w, h;
@@ -507,6 +562,7 @@ static void g_plot_init (GPlot *plot)
 	plot->priv->xlabel_unit = NULL;
 	plot->priv->ylabel = NULL;
 	plot->priv->ylabel_unit = NULL;
+	plot->priv->dragged_cursor = GPLOT_N_CURSORS;
 }
 
 GtkWidget *g_plot_new ()
@@ -539,8 +595,67 @@ int g_plot_add_function (GPlot *plot, GPlotFunction *func)
 	return 0;
 }
 
+/**
+ * Removes @func from the plot and drops the reference the plot took
+ * over in g_plot_add_function.
+ */
+void g_plot_remove_function (GPlot *plot, GPlotFunction *func)
+{
+	GList *link;
+
+	g_return_if_fail (IS_GPLOT (plot));
+
+	link = g_list_find (plot->priv->functions, func);
+	if (link == NULL)
+		return;
+
+	plot->priv->functions = g_list_delete_link (plot->priv->functions, link);
+	plot->priv->window_valid = FALSE;
+	g_object_unref (G_OBJECT (func));
+}
+
+static gdouble g_plot_device_to_window_x (GPlot *p, gdouble x)
+{
+	gdouble y = 0.0;
+	cairo_matrix_t t = p->priv->matrix;
+
+	cairo_matrix_invert (&t);
+	cairo_matrix_transform_point (&t, &x, &y);
+	return x;
+}
+
+/**
+ * The visible cursor within CURSOR_GRAB_DISTANCE of the device
+ * coordinate @x, GPLOT_N_CURSORS if there is none.
+ */
+static guint g_plot_cursor_at (GPlot *p, gdouble x)
+{
+	guint found = GPLOT_N_CURSORS;
+	gdouble best = CURSOR_GRAB_DISTANCE;
+
+	for (guint i = 0; i < GPLOT_N_CURSORS; i++) {
+		gdouble cx = p->priv->cursor_x[i], cy = 0.0;
+
+		if (!p->priv->cursor_visible[i])
+			continue;
+		cairo_matrix_transform_point (&p->priv->matrix, &cx, &cy);
+		if (fabs (cx - x) <= best) {
+			best = fabs (cx - x);
+			found = i;
+		}
+	}
+	return found;
+}
+
 static gboolean g_plot_motion_cb (GtkWidget *w, GdkEventMotion *e, GPlot *p)
 {
+	if (p->priv->action == ACTION_CURSOR) {
+		gdouble x = CLAMP (e->x, p->priv->viewport_bbox.xmin, p->priv->viewport_bbox.xmax);
+
+		g_plot_set_cursor (p, p->priv->dragged_cursor, TRUE, g_plot_device_to_window_x (p, x));
+		return FALSE;
+	}
+
 	switch (p->priv->zoom_mode) {
 	case GPLOT_ZOOM_INOUT:
 		if ((p->priv->action == ACTION_STARTING_PAN) || (p->priv->action == ACTION_PAN)) {
@@ -593,6 +708,27 @@ static gboolean g_plot_button_press_cb (GtkWidget *w, GdkEventButton *e, GPlot *
 
 	if (e->type == GDK_2BUTTON_PRESS) {
 		/* TODO : Check function below cursor and open a property dialog :) */
+	} else if (e->button == 2) {
+		// grab the cursor under the pointer, else bring up a hidden one
+		// or move the closer one of both
+		guint cursor = g_plot_cursor_at (p, e->x);
+		gdouble x = g_plot_device_to_window_x (p, e->x);
+
+		if (cursor == GPLOT_N_CURSORS) {
+			if (!p->priv->cursor_visible[GPLOT_CURSOR_A])
+				cursor = GPLOT_CURSOR_A;
+			else if (!p->priv->cursor_visible[GPLOT_CURSOR_B])
+				cursor = GPLOT_CURSOR_B;
+			else if (fabs (p->priv->cursor_x[GPLOT_CURSOR_A] - x) <=
+			         fabs (p->priv->cursor_x[GPLOT_CURSOR_B] - x))
+				cursor = GPLOT_CURSOR_A;
+			else
+				cursor = GPLOT_CURSOR_B;
+		}
+
+		p->priv->action = ACTION_CURSOR;
+		p->priv->dragged_cursor = cursor;
+		g_plot_set_cursor (p, cursor, TRUE, x);
 	} else {
 		switch (p->priv->zoom_mode) {
 		case GPLOT_ZOOM_INOUT:
@@ -624,6 +760,14 @@ static gboolean g_plot_button_release_cb (GtkWidget *w, GdkEventButton *e, GPlot
 
 	g_return_val_if_fail (IS_GPLOT (p), TRUE);
 
+	if (p->priv->action == ACTION_CURSOR) {
+		if (e->button == 2) {
+			p->priv->action = ACTION_NONE;
+			p->priv->dragged_cursor = GPLOT_N_CURSORS;
+		}
+		return TRUE;
+	}
+
 	switch (p->priv->zoom_mode) {
 	case GPLOT_ZOOM_INOUT:
 		if (p->priv->action != ACTION_PAN) {
@@ -734,6 +878,60 @@ static void g_plot_update_bbox (GPlot *p)
 	priv->window_valid = TRUE;
 }
 
+/**
+ * Sets the y range of the window to what the visible functions reach
+ * between the left and the right border of it. Every function answers
+ * that from its own range index, this runs on every redraw of a pan.
+ */
+static void g_plot_autoscale_y (GPlot *p)
+{
+	GPlotPriv *priv = p->priv;
+	gdouble ymin = G_MAXDOUBLE, ymax = -G_MAXDOUBLE, margin;
+	gboolean found = FALSE;
+	GList *lst;
+
+	for (lst = priv->functions; lst; lst = lst->next) {
+		GPlotFunction *f = (GPlotFunction *)lst->data;
+		gdouble lo, hi;
+
+		if (!g_plot_function_get_visible (f))
+			continue;
+		if (!g_plot_function_get_range (f, priv->window_bbox.xmin, priv->window_bbox.xmax, &lo,
+		                                &hi))
+			continue;
+		ymin = MIN (ymin, lo);
+		ymax = MAX (ymax, hi);
+		found = TRUE;
+	}
+
+	// nothing to fit, keep what is shown
+	if (!found)
+		return;
+
+	if (ymin == ymax)
+		margin = ymin != 0.0 ? fabs (ymin) * 0.1 : 1.0;
+	else
+		margin = (ymax - ymin) * 0.05;
+
+	priv->window_bbox.ymin = ymin - margin;
+	priv->window_bbox.ymax = ymax + margin;
+}
+
+void g_plot_set_autoscale_y (GPlot *p, gboolean autoscale)
+{
+	g_return_if_fail (IS_GPLOT (p));
+
+	p->priv->autoscale_y = autoscale;
+	gtk_widget_queue_draw (GTK_WIDGET (p));
+}
+
+gboolean g_plot_get_autoscale_y (GPlot *p)
+{
+	g_return_val_if_fail (IS_GPLOT (p), FALSE);
+
+	return p->priv->autoscale_y;
+}
+
 void g_plot_reset_zoom (GPlot *p)
 {
 	g_return_if_fail (IS_GPLOT (p));
@@ -829,3 +1027,45 @@ static void get_order_of_magnitude (gdouble val, gdouble *man, gdouble *pw)
 	*man = val / sx;
 	*pw = b;
 }
+
+void g_plot_set_cursor (GPlot *plot, guint cursor, gboolean visible, gdouble x)
+{
+	g_return_if_fail (IS_GPLOT (plot));
+	g_return_if_fail (cursor < GPLOT_N_CURSORS);
+
+	plot->priv->cursor_visible[cursor] = visible;
+	plot->priv->cursor_x[cursor] = x;
+
+	g_signal_emit (G_OBJECT (plot), g_plot_signals[CURSORS_CHANGED], 0);
+	gtk_widget_queue_draw (GTK_WIDGET (plot));
+}
+
+/**
+ * Shows both cursors at a third and at two thirds of what is shown of
+ * the x axis, for those without a middle button.
+ */
+void g_plot_place_cursors (GPlot *plot)
+{
+	GPlotFunctionBBox *bbox;
+
+	g_return_if_fail (IS_GPLOT (plot));
+
+	if (!plot->priv->window_valid)
+		g_plot_update_bbox (plot);
+	bbox = &plot->priv->window_bbox;
+
+	plot->priv->cursor_visible[GPLOT_CURSOR_A] = TRUE;
+	plot->priv->cursor_x[GPLOT_CURSOR_A] = bbox->xmin + (bbox->xmax - bbox->xmin) / 3.0;
+	g_plot_set_cursor (plot, GPLOT_CURSOR_B, TRUE,
+	                   bbox->xmin + 2.0 * (bbox->xmax - bbox->xmin) / 3.0);
+}
+
+gboolean g_plot_get_cursor (GPlot *plot, guint cursor, gdouble *x)
+{
+	g_return_val_if_fail (IS_GPLOT (plot), FALSE);
+	g_return_val_if_fail (cursor < GPLOT_N_CURSORS, FALSE);
+
+	if (x)
+		*x = plot->priv->cursor_x[cursor];
+	return plot->priv->cursor_visible[cursor];
+}
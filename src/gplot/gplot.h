@@ -45,14 +45,26 @@ typedef struct _GPlotFunction
 
 enum { GPLOT_ZOOM_INOUT, GPLOT_ZOOM_REGION };
 
+// Vertical measurement cursors, dragged with the middle button
+enum { GPLOT_CURSOR_A, GPLOT_CURSOR_B, GPLOT_N_CURSORS };
+
 GType g_plot_get_type ();
 GtkWidget *g_plot_new ();
 void g_plot_clear (GPlot *);
 int g_plot_add_function (GPlot *, GPlotFunction *);
+void g_plot_remove_function (GPlot *, GPlotFunction *);
 void g_plot_set_zoom_mode (GPlot *, guint);
 guint g_plot_get_zoom_mode (GPlot *);
 void g_plot_reset_zoom (GPlot *);
+// Fits the y axis to the visible traces within the shown x range.
+void g_plot_set_autoscale_y (GPlot *, gboolean);
+gboolean g_plot_get_autoscale_y (GPlot *);
 void g_plot_set_axis_labels (GPlot *, gchar *, gchar *);
 void g_plot_window_to_device (GPlot *, double *x, double *y);
+// Both emit "cursors-changed".
+void g_plot_set_cursor (GPlot *, guint cursor, gboolean visible, gdouble x);
+void g_plot_place_cursors (GPlot *);
+// FALSE if @cursor is hidden, @x is in window coordinates
+gboolean g_plot_get_cursor (GPlot *, guint cursor, gdouble *x);
 
 #endif
@@ -75,3 +75,31 @@ void g_plot_function_get_bbox (GPlotFunction *self, GPlotFunctionBBox *bbox)
 	if (GPLOT_FUNCTION_GET_CLASS (self)->get_bbox)
 		GPLOT_FUNCTION_GET_CLASS (self)->get_bbox (self, bbox);
 }
+
+gboolean g_plot_function_get_value (GPlotFunction *self, gdouble x, gdouble *y)
+{
+	if (GPLOT_FUNCTION_GET_CLASS (self)->get_value)
+		return GPLOT_FUNCTION_GET_CLASS (self)->get_value (self, x, y);
+	return FALSE;
+}
+
+gboolean g_plot_function_get_range (GPlotFunction *self, gdouble xmin, gdouble xmax, gdouble *ymin,
+                                    gdouble *ymax)
+{
+	if (GPLOT_FUNCTION_GET_CLASS (self)->get_range)
+		return GPLOT_FUNCTION_GET_CLASS (self)->get_range (self, xmin, xmax, ymin, ymax);
+	return FALSE;
+}
+
+void g_plot_function_set_visible (GPlotFunction *self, gboolean visible)
+{
+	g_object_set (G_OBJECT (self), "visible", visible, NULL);
+}
+
+gboolean g_plot_function_get_visible (GPlotFunction *self)
+{
+	gboolean visible;
+
+	g_object_get (G_OBJECT (self), "visible", &visible, NULL);
+	return visible;
+}
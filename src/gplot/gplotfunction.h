@@ -47,5 +47,11 @@ void g_plot_function_draw (GPlotFunction *, cairo_t *, GPlotFunctionBBox *);
 void g_plot_function_get_bbox (GPlotFunction *, GPlotFunctionBBox *);
 void g_plot_function_set_visible (GPlotFunction *, gboolean);
 gboolean g_plot_function_get_visible (GPlotFunction *);
+// The value of the function at @x, FALSE if @x is outside of its samples.
+gboolean g_plot_function_get_value (GPlotFunction *, gdouble x, gdouble *y);
+// The extent of the function between @xmin and @xmax, FALSE if it has
+// no values there.
+gboolean g_plot_function_get_range (GPlotFunction *, gdouble xmin, gdouble xmax, gdouble *ymin,
+                                    gdouble *ymax);
 
 #endif
@@ -27,10 +27,12 @@
  * Boston, MA 02110-1301, USA.
  */
 
+#include <math.h>
 #include <string.h>
 
 #include "gplot-internal.h"
 #include "gplotlines.h"
+#include "mem-stats.h"
 
 typedef struct _GPlotLines GPlotLines;
 typedef struct _GPlotLinesPriv GPlotLinesPriv;
@@ -54,6 +56,8 @@ static void g_plot_lines_class_init (GPlotLinesClass *class);
 static void g_plot_lines_init (GPlotLines *plot);
 static void g_plot_lines_draw (GPlotFunction *, cairo_t *, GPlotFunctionBBox *);
 static void g_plot_lines_get_bbox (GPlotFunction *, GPlotFunctionBBox *);
+static gboolean g_plot_lines_get_value (GPlotFunction *, gdouble, gdouble *);
+static gboolean g_plot_lines_get_range (GPlotFunction *, gdouble, gdouble, gdouble *, gdouble *);
 static void g_plot_lines_function_init (GPlotFunctionClass *iface);
 static void g_plot_lines_set_property (GObject *object, guint prop_id, const GValue *value,
                                        GParamSpec *spec);
@@ -62,7 +66,27 @@ static void g_plot_lines_get_property (GObject *object, guint prop_id, GValue *v
 
 static GObjectClass *parent_class = NULL;
 
-enum { ARG_0, ARG_WIDTH, ARG_COLOR, ARG_COLOR_GDKCOLOR, ARG_VISIBLE, ARG_GRAPH_TYPE, ARG_SHIFT };
+// samples per block of the range pyramid, and blocks per block above
+#define RANGE_BLOCK 16
+#define RANGE_MAX_LEVELS 16
+
+/**
+ * Minima and maxima of the y values in blocks of RANGE_BLOCK samples,
+ * of blocks of RANGE_BLOCK of those blocks and so on. The extent of any
+ * range of samples is put together from at most 2 * RANGE_BLOCK values
+ * per level, so the autoscale of the plot does not have to look at all
+ * samples in the window on every step of a pan.
+ */
+typedef struct
+{
+	guint n_levels;
+	guint len[RANGE_MAX_LEVELS];
+	gdouble *min[RANGE_MAX_LEVELS];
+	gdouble *max[RANGE_MAX_LEVELS];
+	gsize bytes;
+} GPlotLinesRange;
+
+enum { ARG_0, ARG_WIDTH, ARG_COLOR, ARG_COLOR_GDKCOLOR, ARG_VISIBLE, ARG_GRAPH_TYPE, ARG_SHIFT, ARG_DASHED };
 
 struct _GPlotLinesPriv
 {
@@ -85,6 +109,12 @@ struct _GPlotLinesPriv
 
 	// Shift for pulse drawings
 	gdouble shift;
+
+	// Dashed lines tell overlays apart from the simulated curves
+	gboolean dashed;
+
+	// built on the first g_plot_function_get_range
+	GPlotLinesRange *range;
 };
 
 #define TYPE_GPLOT_LINES (g_plot_lines_get_type ())
@@ -110,6 +140,8 @@ static void g_plot_lines_function_init (GPlotFunctionClass *iface)
 {
 	iface->draw = g_plot_lines_draw;
 	iface->get_bbox = g_plot_lines_get_bbox;
+	iface->get_value = g_plot_lines_get_value;
+	iface->get_range = g_plot_lines_get_range;
 }
 
 static void g_plot_lines_dispose (GObject *object)
@@ -124,6 +156,18 @@ static void g_plot_lines_finalize (GObject *object)
 	lines = GPLOT_LINES (object);
 
 	if (lines->priv) {
+		GPlotLinesRange *range = lines->priv->range;
+
+		mem_stats_add (MEM_STATS_PLOT_LINES, -1,
+		               -(gssize)(2 * lines->priv->points * sizeof(gdouble)));
+		if (range) {
+			mem_stats_add (MEM_STATS_PLOT_LINES, 0, -(gssize)range->bytes);
+			for (guint level = 0; level < range->n_levels; level++) {
+				g_free (range->min[level]);
+				g_free (range->max[level]);
+			}
+			g_free (range);
+		}
 		g_free (lines->priv->x);
 		g_free (lines->priv->y);
 		g_free (lines->priv->color_string);
@@ -171,6 +215,11 @@ static void g_plot_lines_class_init (GPlotLinesClass *class)
 	                                 g_param_spec_double ("shift", "GPlotLines::shift",
 	                                                      "the shift for multiple pulses", 0.0,
 	                                                      500.0, 50.0, G_PARAM_READWRITE));
+
+	g_object_class_install_property (object_class, ARG_DASHED,
+	                                 g_param_spec_boolean ("dashed", "GPlotLines::dashed",
+	                                                       "draw the line dashed", FALSE,
+	                                                       G_PARAM_READWRITE));
 }
 
 static void g_plot_lines_init (GPlotLines *plot)
@@ -185,6 +234,8 @@ static void g_plot_lines_init (GPlotLines *plot)
 	priv->visible = TRUE;
 	priv->color_string = g_strdup ("white");
 	memset (&priv->color, 0xFF, sizeof(GdkColor));
+
+	mem_stats_add (MEM_STATS_PLOT_LINES, 1, 0);
 }
 
 static void g_plot_lines_set_property (GObject *object, guint prop_id, const GValue *value,
@@ -210,6 +261,9 @@ static void g_plot_lines_set_property (GObject *object, guint prop_id, const GVa
 	case ARG_SHIFT:
 		plot->priv->shift = g_value_get_double (value);
 		break;
+	case ARG_DASHED:
+		plot->priv->dashed = g_value_get_boolean (value);
+		break;
 	default:
 		break;
 	}
@@ -236,6 +290,9 @@ static void g_plot_lines_get_property (GObject *object, guint prop_id, GValue *v
 	case ARG_SHIFT:
 		g_value_set_double (value, plot->priv->shift);
 		break;
+	case ARG_DASHED:
+		g_value_set_boolean (value, plot->priv->dashed);
+		break;
 	default:
 		G_OBJECT_WARN_INVALID_PROPERTY_ID (plot, prop_id, spec);
 	}
@@ -250,6 +307,9 @@ GPlotFunction *g_plot_lines_new (gdouble *x, gdouble *y, guint points)
 	plot->priv->y = y;
 	plot->priv->points = points;
 
+	// the object itself was counted by init
+	mem_stats_add (MEM_STATS_PLOT_LINES, 0, 2 * points * sizeof(gdouble));
+
 	return GPLOT_FUNCTION (plot);
 }
 
@@ -286,6 +346,235 @@ static void g_plot_lines_get_bbox (GPlotFunction *f, GPlotFunctionBBox *bbox)
 	(*bbox) = plot->priv->bbox;
 }
 
+/**
+ * Finds the samples @x lies between by bisection, so the cursors of
+ * the plot stay cheap with millions of points. The x values have to be
+ * sorted, ascending like the time of a transient analysis or descending
+ * like a DC sweep from a higher to a lower value.
+ *
+ * @return FALSE if @x is outside of the samples
+ */
+static gboolean g_plot_lines_find_interval (const gdouble *x, guint points, gdouble value,
+                                            guint *lo, guint *hi)
+{
+	gboolean ascending;
+	guint a, b;
+
+	if (points == 0)
+		return FALSE;
+
+	ascending = x[points - 1] >= x[0];
+	if (ascending ? (value < x[0] || value > x[points - 1])
+	              : (value > x[0] || value < x[points - 1]))
+		return FALSE;
+
+	// invariant: x[a] <= value <= x[b] (reversed if descending)
+	a = 0;
+	b = points - 1;
+	while (b - a > 1) {
+		guint m = a + (b - a) / 2;
+
+		if (ascending ? x[m] <= value : x[m] >= value)
+			a = m;
+		else
+			b = m;
+	}
+
+	*lo = a;
+	*hi = b;
+	return TRUE;
+}
+
+/**
+ * Curves are interpolated linearly between the samples like they are
+ * drawn, pulses give the sample that is closest to @x.
+ */
+static gboolean g_plot_lines_get_value (GPlotFunction *f, gdouble x, gdouble *y)
+{
+	GPlotLines *plot;
+	gdouble *xs, *ys;
+	guint lo, hi;
+
+	g_return_val_if_fail (IS_GPLOT_LINES (f), FALSE);
+
+	plot = GPLOT_LINES (f);
+	xs = plot->priv->x;
+	ys = plot->priv->y;
+
+	if (plot->priv->graphic_type == FREQUENCY_PULSE)
+		x -= plot->priv->shift;
+
+	if (!g_plot_lines_find_interval (xs, plot->priv->points, x, &lo, &hi))
+		return FALSE;
+
+	if (plot->priv->graphic_type == FREQUENCY_PULSE)
+		*y = fabs (x - xs[lo]) <= fabs (xs[hi] - x) ? ys[lo] : ys[hi];
+	else if (xs[hi] == xs[lo])
+		// a breakpoint of the simulator, the later sample wins
+		*y = ys[hi];
+	else
+		*y = ys[lo] + (ys[hi] - ys[lo]) * (x - xs[lo]) / (xs[hi] - xs[lo]);
+
+	return TRUE;
+}
+
+/**
+ * The number of samples that come before @value in the direction of
+ * the sweep. With @inclusive, samples equal to @value count as well.
+ */
+static guint g_plot_lines_bisect (const gdouble *x, guint points, gdouble value, gboolean ascending,
+                                  gboolean inclusive)
+{
+	guint a = 0, b = points;
+
+	while (a < b) {
+		guint m = a + (b - a) / 2;
+		gboolean before;
+
+		if (ascending)
+			before = inclusive ? x[m] <= value : x[m] < value;
+		else
+			before = inclusive ? x[m] >= value : x[m] > value;
+
+		if (before)
+			a = m + 1;
+		else
+			b = m;
+	}
+	return a;
+}
+
+static GPlotLinesRange *g_plot_lines_range_new (const gdouble *y, guint points)
+{
+	GPlotLinesRange *range = g_new0 (GPlotLinesRange, 1);
+	const gdouble *below_min = y, *below_max = y;
+	guint below_len = points;
+
+	while (below_len > RANGE_BLOCK && range->n_levels < RANGE_MAX_LEVELS) {
+		guint level = range->n_levels++;
+		guint len = (below_len + RANGE_BLOCK - 1) / RANGE_BLOCK;
+		gdouble *min = g_new (gdouble, len);
+		gdouble *max = g_new (gdouble, len);
+
+		for (guint j = 0; j < len; j++) {
+			guint end = MIN ((j + 1) * RANGE_BLOCK, below_len);
+
+			min[j] = below_min[j * RANGE_BLOCK];
+			max[j] = below_max[j * RANGE_BLOCK];
+			for (guint i = j * RANGE_BLOCK + 1; i < end; i++) {
+				min[j] = MIN (min[j], below_min[i]);
+				max[j] = MAX (max[j], below_max[i]);
+			}
+		}
+
+		range->len[level] = len;
+		range->min[level] = min;
+		range->max[level] = max;
+		range->bytes += 2 * len * sizeof(gdouble);
+
+		below_min = min;
+		below_max = max;
+		below_len = len;
+	}
+
+	return range;
+}
+
+/**
+ * Extends @ymin and @ymax by the entries @lo to @hi of @level, level -1
+ * are the samples themselves. Whole blocks in the middle are taken from
+ * the level above, only the ragged ends are looked at here.
+ */
+static void g_plot_lines_range_query (const GPlotLinesRange *range, const gdouble *y, gint level,
+                                      guint lo, guint hi, gdouble *ymin, gdouble *ymax)
+{
+	const gdouble *min = level < 0 ? y : range->min[level];
+	const gdouble *max = level < 0 ? y : range->max[level];
+
+	if (level + 1 < (gint)range->n_levels && hi - lo + 1 >= 2 * RANGE_BLOCK) {
+		guint first = (lo + RANGE_BLOCK - 1) / RANGE_BLOCK;
+		guint last = (hi + 1) / RANGE_BLOCK;
+
+		g_plot_lines_range_query (range, y, level + 1, first, last - 1, ymin, ymax);
+		for (guint i = lo; i < first * RANGE_BLOCK; i++) {
+			*ymin = MIN (*ymin, min[i]);
+			*ymax = MAX (*ymax, max[i]);
+		}
+		lo = last * RANGE_BLOCK;
+	}
+
+	for (guint i = lo; i <= hi; i++) {
+		*ymin = MIN (*ymin, min[i]);
+		*ymax = MAX (*ymax, max[i]);
+	}
+}
+
+/**
+ * Besides the samples between @xmin and @xmax the curve is cut at both
+ * borders, its values there count as well. Spectral lines always reach
+ * down to zero.
+ */
+static gboolean g_plot_lines_get_range (GPlotFunction *f, gdouble xmin, gdouble xmax,
+                                        gdouble *ymin, gdouble *ymax)
+{
+	GPlotLines *plot;
+	GPlotLinesPriv *priv;
+	gboolean ascending, found = FALSE;
+	gdouble lo_y = G_MAXDOUBLE, hi_y = -G_MAXDOUBLE;
+	guint first, end;
+
+	g_return_val_if_fail (IS_GPLOT_LINES (f), FALSE);
+
+	plot = GPLOT_LINES (f);
+	priv = plot->priv;
+
+	if (priv->points == 0)
+		return FALSE;
+
+	if (priv->graphic_type == FREQUENCY_PULSE) {
+		xmin -= priv->shift;
+		xmax -= priv->shift;
+	}
+
+	ascending = priv->x[(guint)priv->points - 1] >= priv->x[0];
+	first = g_plot_lines_bisect (priv->x, priv->points, ascending ? xmin : xmax, ascending, FALSE);
+	end = g_plot_lines_bisect (priv->x, priv->points, ascending ? xmax : xmin, ascending, TRUE);
+
+	if (first < end) {
+		if (priv->range == NULL) {
+			priv->range = g_plot_lines_range_new (priv->y, priv->points);
+			mem_stats_add (MEM_STATS_PLOT_LINES, 0, priv->range->bytes);
+		}
+		g_plot_lines_range_query (priv->range, priv->y, -1, first, end - 1, &lo_y, &hi_y);
+		found = TRUE;
+	}
+
+	if (priv->graphic_type == FREQUENCY_PULSE) {
+		if (found) {
+			lo_y = MIN (lo_y, 0.0);
+			hi_y = MAX (hi_y, 0.0);
+		}
+	} else {
+		gdouble borders[] = {xmin, xmax};
+
+		for (guint i = 0; i < G_N_ELEMENTS (borders); i++) {
+			gdouble y;
+
+			if (g_plot_lines_get_value (f, borders[i], &y)) {
+				lo_y = MIN (lo_y, y);
+				hi_y = MAX (hi_y, y);
+				found = TRUE;
+			}
+		}
+	}
+
+	if (found) {
+		*ymin = lo_y;
+		*ymax = hi_y;
+	}
+	return found;
+}
+
 // This procedure is in charge to link points with ligne.
 // Modified to only draw spectral ray for Fourier analysis.
 static void g_plot_lines_draw (GPlotFunction *f, cairo_t *cr, GPlotFunctionBBox *bbox)
@@ -344,6 +633,10 @@ static void g_plot_lines_draw (GPlotFunction *f, cairo_t *cr, GPlotFunctionBBox
 	                      plot->priv->color.blue / 65535.0);
 	cairo_identity_matrix (cr);
 	cairo_set_line_width (cr, plot->priv->width);
+	if (plot->priv->dashed) {
+		static const gdouble dashes[] = {6.0, 4.0};
+		cairo_set_dash (cr, dashes, G_N_ELEMENTS (dashes), 0.0);
+	}
 	cairo_stroke (cr);
 	cairo_restore (cr);
 }
@@ -0,0 +1,189 @@
+/*
+ * library-monitor.c
+ *
+ *
+ * Authors:
+ *  Michi <st101564@stud.uni-stuttgart.de>
+ *
+ * Web page: https://ahoi.io/project/oregano
+ *
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+
+#include <string.h>
+#include <glib.h>
+
+#include "library-monitor.h"
+#include "oregano-config.h"
+#include "schematic-view.h"
+
+#define OREGLIB_SUFFIX ".oreglib"
+#define MODEL_SUFFIX ".model"
+
+// GFileMonitor of each watched directory
+static GList *monitors = NULL;
+// file names that changed since the last flush
+static GHashTable *pending = NULL;
+static guint timeout_id = 0;
+
+static void library_monitor_handle (const gchar *filename)
+{
+	gchar *basename;
+
+	if (g_str_has_suffix (filename, OREGLIB_SUFFIX)) {
+		oregano_reload_library (filename);
+	} else if (g_str_has_suffix (filename, MODEL_SUFFIX)) {
+		// the netlist includes OREGANO_MODELDIR/<model>.model
+		basename = g_path_get_basename (filename);
+		basename[strlen (basename) - strlen (MODEL_SUFFIX)] = '\0';
+		schematic_view_model_changed (basename);
+		g_free (basename);
+	}
+}
+
+void library_monitor_flush (void)
+{
+	GHashTableIter iter;
+	gpointer filename;
+	GHashTable *files;
+
+	if (timeout_id != 0) {
+		g_source_remove (timeout_id);
+		timeout_id = 0;
+	}
+
+	if (pending == NULL)
+		return;
+
+	// handling a file can take long enough for more changes to come in
+	files = pending;
+	pending = NULL;
+
+	g_hash_table_iter_init (&iter, files);
+	while (g_hash_table_iter_next (&iter, &filename, NULL))
+		library_monitor_handle (filename);
+
+	g_hash_table_unref (files);
+}
+
+static gboolean library_monitor_timeout (gpointer user_data)
+{
+	timeout_id = 0;
+	library_monitor_flush ();
+
+	return G_SOURCE_REMOVE;
+}
+
+void library_monitor_file_changed (const gchar *filename)
+{
+	g_return_if_fail (filename != NULL);
+
+	if (!g_str_has_suffix (filename, OREGLIB_SUFFIX) && !g_str_has_suffix (filename, MODEL_SUFFIX))
+		return;
+
+	if (pending == NULL)
+		pending = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+	g_hash_table_add (pending, g_strdup (filename));
+
+	// every change starts the delay over
+	if (timeout_id != 0)
+		g_source_remove (timeout_id);
+	timeout_id = g_timeout_add (LIBRARY_MONITOR_DELAY_MS, library_monitor_timeout, NULL);
+}
+
+static void library_monitor_changed_cb (GFileMonitor *monitor, GFile *file, GFile *other_file,
+                                        GFileMonitorEvent event, gpointer user_data)
+{
+	gchar *filename;
+
+	switch (event) {
+	case G_FILE_MONITOR_EVENT_CHANGED:
+	case G_FILE_MONITOR_EVENT_CHANGES_DONE_HINT:
+	case G_FILE_MONITOR_EVENT_DELETED:
+	case G_FILE_MONITOR_EVENT_CREATED:
+	case G_FILE_MONITOR_EVENT_MOVED_IN:
+	case G_FILE_MONITOR_EVENT_MOVED_OUT:
+	case G_FILE_MONITOR_EVENT_RENAMED:
+		break;
+	default:
+		return;
+	}
+
+	filename = g_file_get_path (file);
+	if (filename != NULL)
+		library_monitor_file_changed (filename);
+	g_free (filename);
+
+	// saved by renaming a temporary file over it
+	if (other_file != NULL) {
+		filename = g_file_get_path (other_file);
+		if (filename != NULL)
+			library_monitor_file_changed (filename);
+		g_free (filename);
+	}
+}
+
+gboolean library_monitor_add_directory (const gchar *path, GError **error)
+{
+	GFileMonitor *monitor;
+	GFile *directory;
+
+	g_return_val_if_fail (path != NULL, FALSE);
+
+	directory = g_file_new_for_path (path);
+	monitor = g_file_monitor_directory (directory, G_FILE_MONITOR_WATCH_MOVES, NULL, error);
+	g_object_unref (directory);
+
+	if (monitor == NULL)
+		return FALSE;
+
+	g_file_monitor_set_rate_limit (monitor, LIBRARY_MONITOR_DELAY_MS);
+	g_signal_connect (monitor, "changed", G_CALLBACK (library_monitor_changed_cb), NULL);
+	monitors = g_list_prepend (monitors, monitor);
+
+	return TRUE;
+}
+
+void library_monitor_start (void)
+{
+	const gchar *directories[] = {OREGANO_LIBRARYDIR, OREGANO_MODELDIR};
+	GError *e = NULL;
+	gint i;
+
+	if (monitors != NULL)
+		return;
+
+	for (i = 0; i < G_N_ELEMENTS (directories); i++) {
+		if (!library_monitor_add_directory (directories[i], &e)) {
+			g_warning ("Could not watch %s: %s", directories[i], e->message);
+			g_clear_error (&e);
+		}
+	}
+}
+
+void library_monitor_stop (void)
+{
+	if (timeout_id != 0) {
+		g_source_remove (timeout_id);
+		timeout_id = 0;
+	}
+	g_clear_pointer (&pending, g_hash_table_unref);
+
+	g_list_free_full (monitors, (GDestroyNotify)g_object_unref);
+	monitors = NULL;
+}
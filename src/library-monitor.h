@@ -0,0 +1,59 @@
+/*
+ * library-monitor.h
+ *
+ *
+ * Authors:
+ *  Michi <st101564@stud.uni-stuttgart.de>
+ *
+ * Web page: https://ahoi.io/project/oregano
+ *
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+
+#ifndef LIBRARY_MONITOR_H_
+#define LIBRARY_MONITOR_H_
+
+#include <gio/gio.h>
+
+/**
+ * Watches the directories of the part libraries and the models, so
+ * edits to them show up without restarting.
+ *
+ * Editors write a file in several steps, so the changed files are
+ * collected and only handled once none of them changed for the delay.
+ * Only the changed files are looked at: a library is parsed again and
+ * the open schematics are bound to it, the schematics that use a
+ * model are told they changed, so they are simulated again if they
+ * follow their edits.
+ *
+ * Lives in the main loop.
+ */
+
+#define LIBRARY_MONITOR_DELAY_MS 300
+
+// Watches OREGANO_LIBRARYDIR and OREGANO_MODELDIR.
+void library_monitor_start (void);
+void library_monitor_stop (void);
+gboolean library_monitor_add_directory (const gchar *path, GError **error);
+
+// What the file monitors report, a file that was created, changed or removed.
+void library_monitor_file_changed (const gchar *filename);
+// Handles the collected files right away instead of after the delay.
+void library_monitor_flush (void);
+
+#endif /* LIBRARY_MONITOR_H_ */
@@ -51,9 +51,14 @@ typedef struct
 
 typedef struct
 {
+	// see library_ref, every part holds one
+	gint ref_count;
+
 	gchar *name;
 	gchar *author;
 	gchar *version;
+	// the file it was parsed from
+	gchar *filename;
 
 	GSList *parts_list;
 
@@ -40,6 +40,8 @@
 #include "load-common.h"
 #include "load-library.h"
 #include "part-label.h"
+#include "mem-stats.h"
+#include "oregano-config.h"
 
 typedef enum {
 	PARSE_START,
@@ -95,6 +97,8 @@ typedef struct
 } ParseState;
 
 static xmlEntityPtr get_entity (void *user_data, const xmlChar *name);
+static void library_symbol_free (LibrarySymbol *symbol);
+static void library_part_free (LibraryPart *part);
 static void start_document (ParseState *state);
 static void end_document (ParseState *state);
 static void start_element (ParseState *state, const xmlChar *name, const xmlChar **attrs);
@@ -148,6 +152,19 @@ LibrarySymbol *library_get_symbol (const gchar *symbol_name)
 			break;
 	}
 
+	// it might be in a library that is still being parsed
+	if (symbol == NULL) {
+		GList *last = g_list_last (oregano.libraries);
+
+		oregano_libraries_ensure_loaded ();
+		for (iter = last ? last->next : oregano.libraries; iter; iter = iter->next) {
+			library = iter->data;
+			symbol = g_hash_table_lookup (library->symbol_hash, symbol_name);
+			if (symbol)
+				break;
+		}
+	}
+
 	if (symbol == NULL) {
 		g_message (_ ("Could not find the requested symbol: %s\n"), symbol_name);
 	}
@@ -169,24 +186,191 @@ LibraryPart *library_get_part (Library *library, const gchar *part_name)
 	return part;
 }
 
+/*
+ * The symbol or part that was being read when the file ended, it is not
+ * in the library yet.
+ */
+static void free_pending (ParseState *state)
+{
+	State current = state->state == PARSE_UNKNOWN ? state->prev_state : state->state;
+
+	switch (current) {
+	case PARSE_SYMBOL_LINE:
+	case PARSE_SYMBOL_ARC:
+	case PARSE_SYMBOL_TEXT:
+		g_free (state->object);
+		mem_stats_add (MEM_STATS_LIBRARY, -1, -(gssize)sizeof(SymbolObject));
+		library_symbol_free (state->symbol);
+		break;
+	case PARSE_SYMBOL_CONNECTION:
+		g_free (state->connection);
+		mem_stats_add (MEM_STATS_LIBRARY, -1, -(gssize)sizeof(Connection));
+		library_symbol_free (state->symbol);
+		break;
+	case PARSE_SYMBOL:
+	case PARSE_SYMBOL_NAME:
+	case PARSE_SYMBOL_OBJECTS:
+	case PARSE_SYMBOL_CONNECTIONS:
+		library_symbol_free (state->symbol);
+		break;
+
+	case PARSE_PART_LABEL:
+	case PARSE_PART_LABEL_NAME:
+	case PARSE_PART_LABEL_TEXT:
+	case PARSE_PART_LABEL_POS:
+		g_free (state->label->name);
+		g_free (state->label->text);
+		g_free (state->label);
+		library_part_free (state->part);
+		break;
+	case PARSE_PART_PROPERTY:
+	case PARSE_PART_PROPERTY_NAME:
+	case PARSE_PART_PROPERTY_VALUE:
+		g_free (state->property->name);
+		g_free (state->property->value);
+		g_free (state->property);
+		library_part_free (state->part);
+		break;
+	case PARSE_PART:
+	case PARSE_PART_NAME:
+	case PARSE_PART_DESCRIPTION:
+	case PARSE_PART_USESYMBOL:
+	case PARSE_PART_LABELS:
+	case PARSE_PART_PROPERTIES:
+		library_part_free (state->part);
+		break;
+
+	default:
+		break;
+	}
+}
+
 Library *library_parse_xml_file (const gchar *filename)
 {
 	Library *library;
 	ParseState state;
+	gboolean well_formed;
+
+	// not set by the parser if the file can not be opened
+	state.library = NULL;
+	state.state = PARSE_ERROR;
 
-	if (!oreganoXmlSAXParseFile (&oreganoSAXParser, &state, filename)) {
+	well_formed = oreganoXmlSAXParseFile (&oreganoSAXParser, &state, filename);
+	if (!well_formed) {
 		g_warning ("Library '%s' not well formed!", filename);
 	}
 
-	if (state.state == PARSE_ERROR) {
+	// a file that is cut off (e.g. still being written) is no library either
+	if (!well_formed || state.state == PARSE_ERROR) {
+		if (state.library != NULL)
+			free_pending (&state);
+		library_unref (state.library);
 		library = NULL;
 	} else {
 		library = state.library;
+		library->filename = g_strdup (filename);
 	}
 
 	return library;
 }
 
+/*
+ * Libraries are shared by the list of loaded libraries and the parts
+ * made from them. A library that was parsed again or removed lives on
+ * until the last part of it, e.g. one in the undo history, is gone.
+ * NULL is accepted, parts of unknown libraries have none.
+ */
+Library *library_ref (Library *library)
+{
+	if (library != NULL)
+		g_atomic_int_inc (&library->ref_count);
+	return library;
+}
+
+static void library_symbol_free (LibrarySymbol *symbol)
+{
+	GSList *list;
+
+	for (list = symbol->connections; list; list = list->next) {
+		g_free (list->data);
+		mem_stats_add (MEM_STATS_LIBRARY, -1, -(gssize)sizeof(Connection));
+	}
+	g_slist_free (symbol->connections);
+
+	for (list = symbol->symbol_objects; list; list = list->next) {
+		SymbolObject *object = list->data;
+
+		if (object->type == SYMBOL_OBJECT_LINE)
+			goo_canvas_points_unref (object->u.uline.line);
+		g_free (object);
+		mem_stats_add (MEM_STATS_LIBRARY, -1, -(gssize)sizeof(SymbolObject));
+	}
+	g_slist_free (symbol->symbol_objects);
+
+	g_free (symbol->name);
+	g_free (symbol);
+	mem_stats_add (MEM_STATS_LIBRARY, -1, -(gssize)sizeof(LibrarySymbol));
+}
+
+static void library_part_free (LibraryPart *part)
+{
+	GSList *list;
+
+	for (list = part->labels; list; list = list->next) {
+		PartLabel *label = list->data;
+
+		g_free (label->name);
+		g_free (label->text);
+		g_free (label);
+	}
+	g_slist_free (part->labels);
+
+	for (list = part->properties; list; list = list->next) {
+		Property *property = list->data;
+
+		g_free (property->name);
+		g_free (property->value);
+		g_free (property);
+	}
+	g_slist_free (part->properties);
+
+	g_free (part->name);
+	g_free (part->description);
+	g_free (part->symbol_name);
+	g_free (part->refdes);
+	g_free (part->template);
+	g_free (part->model);
+	g_free (part);
+	mem_stats_add (MEM_STATS_LIBRARY, -1, -(gssize)sizeof(LibraryPart));
+}
+
+void library_unref (Library *library)
+{
+	GHashTableIter iter;
+	gpointer value;
+
+	if (library == NULL || !g_atomic_int_dec_and_test (&library->ref_count))
+		return;
+
+	// the hash tables are keyed by the names in the values
+	g_hash_table_iter_init (&iter, library->part_hash);
+	while (g_hash_table_iter_next (&iter, NULL, &value))
+		library_part_free (value);
+	g_hash_table_destroy (library->part_hash);
+
+	g_hash_table_iter_init (&iter, library->symbol_hash);
+	while (g_hash_table_iter_next (&iter, NULL, &value))
+		library_symbol_free (value);
+	g_hash_table_destroy (library->symbol_hash);
+
+	g_free (library->name);
+	g_free (library->author);
+	g_free (library->version);
+	g_free (library->filename);
+	g_free (library);
+	mem_stats_add (MEM_STATS_LIBRARY, -1, -(gssize)sizeof(Library));
+}
+
 static void start_document (ParseState *state)
 {
 	state->state = PARSE_START;
@@ -201,6 +385,8 @@ static void start_document (ParseState *state)
 	state->property = NULL;
 
 	state->library = g_new0 (Library, 1);
+	mem_stats_add (MEM_STATS_LIBRARY, 1, sizeof(Library));
+	state->library->ref_count = 1;
 	state->library->name = NULL;
 	state->library->author = NULL;
 	state->library->version = NULL;
@@ -250,6 +436,7 @@ static void start_element (ParseState *state, const xmlChar *xml_name, const xml
 		if (!strcmp (name, "ogo:symbol")) {
 			state->state = PARSE_SYMBOL;
 			state->symbol = g_new0 (LibrarySymbol, 1);
+			mem_stats_add (MEM_STATS_LIBRARY, 1, sizeof(LibrarySymbol));
 		} else {
 			state->prev_state = state->state;
 			state->state = PARSE_UNKNOWN;
@@ -274,16 +461,19 @@ static void start_element (ParseState *state, const xmlChar *xml_name, const xml
 	case PARSE_SYMBOL_OBJECTS:
 		if (!strcmp (name, "ogo:line")) {
 			state->object = g_new0 (SymbolObject, 1);
+			mem_stats_add (MEM_STATS_LIBRARY, 1, sizeof(SymbolObject));
 			state->object->type = SYMBOL_OBJECT_LINE;
 			state->state = PARSE_SYMBOL_LINE;
 			g_string_truncate (state->content, 0);
 		} else if (!strcmp (name, "ogo:arc")) {
 			state->object = g_new0 (SymbolObject, 1);
+			mem_stats_add (MEM_STATS_LIBRARY, 1, sizeof(SymbolObject));
 			state->object->type = SYMBOL_OBJECT_ARC;
 			state->state = PARSE_SYMBOL_ARC;
 			g_string_truncate (state->content, 0);
 		} else if (!strcmp (name, "ogo:text")) {
 			state->object = g_new0 (SymbolObject, 1);
+			mem_stats_add (MEM_STATS_LIBRARY, 1, sizeof(SymbolObject));
 			state->object->type = SYMBOL_OBJECT_TEXT;
 			state->state = PARSE_SYMBOL_TEXT;
 			g_string_truncate (state->content, 0);
@@ -298,6 +488,7 @@ static void start_element (ParseState *state, const xmlChar *xml_name, const xml
 		if (!strcmp (name, "ogo:connection")) {
 			state->state = PARSE_SYMBOL_CONNECTION;
 			state->connection = g_new0 (Connection, 1);
+			mem_stats_add (MEM_STATS_LIBRARY, 1, sizeof(Connection));
 			g_string_truncate (state->content, 0);
 		} else {
 			state->prev_state = state->state;
@@ -310,6 +501,7 @@ static void start_element (ParseState *state, const xmlChar *xml_name, const xml
 		if (!strcmp (name, "ogo:part")) {
 			state->state = PARSE_PART;
 			state->part = g_new0 (LibraryPart, 1);
+			mem_stats_add (MEM_STATS_LIBRARY, 1, sizeof(LibraryPart));
 			state->part->library = state->library;
 		} else {
 			state->prev_state = state->state;
@@ -442,10 +634,16 @@ static void end_element (ParseState *state, const xmlChar *name)
 	case PARSE_SYMBOLS:
 		state->state = PARSE_LIBRARY;
 		break;
-	case PARSE_SYMBOL:
-		g_hash_table_insert (state->library->symbol_hash, state->symbol->name, state->symbol);
+	case PARSE_SYMBOL: {
+		// a later definition wins, the key is the name of the one kept
+		LibrarySymbol *previous =
+		    g_hash_table_lookup (state->library->symbol_hash, state->symbol->name);
+
+		g_hash_table_replace (state->library->symbol_hash, state->symbol->name, state->symbol);
+		if (previous != NULL)
+			library_symbol_free (previous);
 		state->state = PARSE_SYMBOLS;
-		break;
+	} break;
 	case PARSE_SYMBOL_NAME:
 		state->symbol->name = g_strdup (state->content->str);
 		state->state = PARSE_SYMBOL;
@@ -524,10 +722,14 @@ static void end_element (ParseState *state, const xmlChar *name)
 	case PARSE_PARTS:
 		state->state = PARSE_LIBRARY;
 		break;
-	case PARSE_PART:
-		g_hash_table_insert (state->library->part_hash, state->part->name, state->part);
+	case PARSE_PART: {
+		LibraryPart *previous = g_hash_table_lookup (state->library->part_hash, state->part->name);
+
+		g_hash_table_replace (state->library->part_hash, state->part->name, state->part);
+		if (previous != NULL)
+			library_part_free (previous);
 		state->state = PARSE_PARTS;
-		break;
+	} break;
 	case PARSE_PART_NAME:
 		state->part->name = g_strdup (state->content->str);
 		state->state = PARSE_PART;
@@ -77,6 +77,8 @@ struct _SymbolObject
 };
 
 Library *library_parse_xml_file (const gchar *filename);
+Library *library_ref (Library *library);
+void library_unref (Library *library);
 LibrarySymbol *library_get_symbol (const gchar *symbol_name);
 LibraryPart *library_get_part (Library *library, const gchar *part_name);
 
@@ -48,6 +48,7 @@
 #include "textbox.h"
 #include "errors.h"
 #include "engines/netlist-helper.h"
+#include "oregano-config.h"
 
 #include "debug.h"
 
@@ -146,6 +147,8 @@ typedef struct
 	int unknown_depth;
 	GString *content;
 	Schematic *schematic;
+	// items of a fragment, when there is no schematic to add them to
+	GList *items;
 	SimSettings *sim_settings;
 
 	char *author;
@@ -181,6 +184,7 @@ static void my_characters (ParseState *state, const xmlChar *chars, int len);
 static void my_warning (void *user_data, const char *msg, ...);
 static void my_error (void *user_data, const char *msg, ...);
 static void my_fatal_error (void *user_data, const char *msg, ...);
+static void fragment_error (ParseState *state, const char *msg, ...);
 
 static void create_wire (ParseState *state);
 static void create_part (ParseState *state);
@@ -212,6 +216,14 @@ static xmlSAXHandler oreganoSAXParser = {
     (fatalErrorSAXFunc)my_fatal_error,    // fatalError
 };
 
+static void add_item (ParseState *state, ItemData *data)
+{
+	if (state->schematic)
+		schematic_add_item (state->schematic, data);
+	else
+		state->items = g_list_prepend (state->items, data);
+}
+
 static void create_textbox (ParseState *state)
 {
 	Textbox *textbox;
@@ -219,7 +231,7 @@ static void create_textbox (ParseState *state)
 	textbox = textbox_new (NULL);
 	textbox_set_text (textbox, state->textbox_text);
 	item_data_set_pos (ITEM_DATA (textbox), &state->pos);
-	schematic_add_item (state->schematic, ITEM_DATA (textbox));
+	add_item (state, ITEM_DATA (textbox));
 }
 
 static void create_wire (ParseState *state)
@@ -236,7 +248,7 @@ static void create_wire (ParseState *state)
 	wire_set_length (wire, &length);
 
 	item_data_set_pos (ITEM_DATA (wire), &state->wire_start);
-	schematic_add_item (state->schematic, ITEM_DATA (wire));
+	add_item (state, ITEM_DATA (wire));
 }
 
 static void create_part (ParseState *state)
@@ -257,7 +269,7 @@ static void create_part (ParseState *state)
 	if (state->flip & ID_FLIP_VERT)
 		item_data_flip (ITEM_DATA (part), ID_FLIP_VERT, NULL);
 
-	schematic_add_item (state->schematic, ITEM_DATA (part));
+	add_item (state, ITEM_DATA (part));
 }
 
 int schematic_parse_xml_file (Schematic *sm, const char *filename, GError **error)
@@ -266,12 +278,16 @@ int schematic_parse_xml_file (Schematic *sm, const char *filename, GError **erro
 	int retval = 0;
 
 	state.schematic = sm;
+	state.items = NULL;
 	state.sim_settings = schematic_get_sim_settings (sm);
 	state.author = NULL;
 	state.title = NULL;
 	state.oregano_version = NULL;
 	state.comments = NULL;
 
+	// the parts are looked up in all libraries
+	oregano_libraries_ensure_loaded ();
+
 	if (!oreganoXmlSAXParseFile (&oreganoSAXParser, &state, filename)) {
 		g_warning ("Document not well formed!");
 		if (error != NULL) {
@@ -305,6 +321,45 @@ int schematic_parse_xml_file (Schematic *sm, const char *filename, GError **erro
 	return retval;
 }
 
+/**
+ * Parses a fragment in the format of a schematic file, see
+ * schematic_write_xml_items. The items are not added to any schematic.
+ *
+ * @returns the items in the order of the fragment, NULL on errors
+ */
+GList *schematic_parse_xml_items (const gchar *buffer, gsize length, GError **error)
+{
+	ParseState state = {0};
+	xmlSAXHandler sax = oreganoSAXParser;
+
+	// the fragment comes from another program, it must not abort this one
+	sax.error = (errorSAXFunc)fragment_error;
+	sax.fatalError = (fatalErrorSAXFunc)fragment_error;
+
+	// the settings of a fragment are not used
+	state.sim_settings = sim_settings_new ();
+
+	oregano_libraries_ensure_loaded ();
+
+	if (!oreganoXmlSAXParseMemory (&sax, &state, buffer, length) ||
+	    state.state == PARSE_ERROR) {
+		g_set_error (error, OREGANO_ERROR, OREGANO_SCHEMATIC_BAD_FILE_FORMAT,
+		             _ ("Bad file format."));
+		g_list_free_full (state.items, g_object_unref);
+		state.items = NULL;
+	}
+
+	sim_settings_finalize (state.sim_settings);
+	g_free (state.author);
+	g_free (state.title);
+	g_free (state.oregano_version);
+	g_free (state.comments);
+	if (state.content)
+		g_string_free (state.content, TRUE);
+
+	return g_list_reverse (state.items);
+}
+
 static void start_document (ParseState *state)
 {
 	state->state = PARSE_START;
@@ -790,7 +845,8 @@ static void end_element (ParseState *state, const xmlChar *name)
 		double zoom;
 
 		zoom = g_strtod (state->content->str, NULL);
-		schematic_set_zoom (state->schematic, zoom);
+		if (state->schematic)
+			schematic_set_zoom (state->schematic, zoom);
 		state->state = PARSE_SCHEMATIC;
 
 		break;
@@ -1138,3 +1194,8 @@ static void my_fatal_error (void *user_data, const char *msg, ...)
 	g_logv ("XML", G_LOG_LEVEL_ERROR, msg, args);
 	va_end (args);
 }
+
+static void fragment_error (ParseState *state, const char *msg, ...)
+{
+	state->state = PARSE_ERROR;
+}
@@ -38,5 +38,6 @@
 #include "schematic.h"
 
 gint schematic_parse_xml_file (Schematic *sm, const gchar *filename, GError **);
+GList *schematic_parse_xml_items (const gchar *buffer, gsize length, GError **error);
 
 #endif
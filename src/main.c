@@ -39,6 +39,10 @@
 #include "oregano.h"
 #include "options.h"
 #include "schematic.h"
+#include "sim-daemon.h"
+#include "mem-stats.h"
+#include "stall-detector.h"
+#include "startup-timer.h"
 
 int main (int argc, char *argv[])
 {
@@ -71,18 +75,48 @@ int main (int argc, char *argv[])
 			 " Main Developer: Bernhard Schuster\n");
 		return 0;
 	}
+	if (oregano_options_sim_daemon ())
+		return sim_daemon_main (oregano_options_sim_daemon_socket ());
+
+	if (oregano_options_debug_startup ())
+		startup_timer_start (oregano_options_startup_budget ());
 
 	// required?
 	gtk_init (&argc, &argv);
+	startup_timer_mark ("gtk init");
 
 	// required, as we possibly need signal
 	// information within oregano.c _before_ the
 	// first Schematic instance exists
 	class = g_type_class_ref (TYPE_SCHEMATIC);
 	app = oregano_new ();
+	startup_timer_mark ("application");
+
+	if (oregano_options_debug_stalls ())
+		stall_detector_start (STALL_DETECTOR_THRESHOLD_DEFAULT);
 
 	status = g_application_run (G_APPLICATION (app), argc, argv);
 
+	if (stall_detector_is_running ()) {
+		gchar *report = stall_detector_report (10);
+		g_printf ("%s", report);
+		g_free (report);
+		stall_detector_stop ();
+	}
+
+	if (startup_timer_is_running ()) {
+		gchar *report = startup_timer_report ();
+		g_printf ("%s", report);
+		g_free (report);
+		startup_timer_stop ();
+	}
+
+	if (oregano_options_debug_memory ()) {
+		gchar *dump = mem_stats_dump ();
+		g_printf ("Memory held by subsystem:\n%s", dump);
+		g_free (dump);
+	}
+
 	g_object_unref (app);
 	g_type_class_unref (class);
 
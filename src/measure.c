@@ -0,0 +1,781 @@
+/*
+ * measure.c
+ *
+ *
+ * Authors:
+ *  Michi <st101564@stud.uni-stuttgart.de>
+ *
+ * Web page: https://ahoi.io/project/oregano
+ *
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include <math.h>
+#include <string.h>
+#include <glib.h>
+#include <glib/gi18n.h>
+
+#include "measure.h"
+#include "tools/task-scheduler.h"
+#include "errors.h"
+
+/*
+ * The crossing search runs in blocks: first a branch free pass
+ * classifies every sample of the block as above or below the level
+ * (which the compiler turns into SIMD compares), then the block is
+ * only scanned sample by sample if it contains a transition at all.
+ * Long flat stretches of a waveform cost one compare per sample.
+ */
+#define MEASURE_BLOCK_SIZE 256
+
+static const gchar *measure_type_names[MEASURE_N_TYPES] = {
+    "min",  "max",       "pp",        "avg",           "rms",    "integ",     "cross",
+    "rise", "fall",      "overshoot", "settling_time", "period", "frequency", "duty_cycle"};
+
+Measurement *measurement_new (const gchar *name, MeasureType type, const gchar *variable)
+{
+	Measurement *m = g_new0 (Measurement, 1);
+
+	m->name = g_strdup (name);
+	m->type = type;
+	m->variable = g_strdup (variable);
+	m->from = -G_MAXDOUBLE;
+	m->to = G_MAXDOUBLE;
+	m->threshold = NAN;
+	m->edge = MEASURE_EDGE_ANY;
+	m->occurrence = 1;
+	m->low = 0.1;
+	m->high = 0.9;
+	m->tolerance = 0.02;
+
+	return m;
+}
+
+Measurement *measurement_copy (const Measurement *m)
+{
+	g_return_val_if_fail (m != NULL, NULL);
+
+	Measurement *copy = g_memdup (m, sizeof(Measurement));
+	copy->name = g_strdup (m->name);
+	copy->variable = g_strdup (m->variable);
+
+	return copy;
+}
+
+void measurement_free (Measurement *m)
+{
+	if (m == NULL)
+		return;
+	g_free (m->name);
+	g_free (m->variable);
+	g_free (m);
+}
+
+const gchar *measurement_type_to_string (MeasureType type)
+{
+	g_return_val_if_fail (type < MEASURE_N_TYPES, NULL);
+
+	return measure_type_names[type];
+}
+
+/**
+ * @returns MEASURE_N_TYPES if @string is not a known measurement
+ */
+MeasureType measurement_type_from_string (const gchar *string)
+{
+	g_return_val_if_fail (string != NULL, MEASURE_N_TYPES);
+
+	for (MeasureType type = 0; type < MEASURE_N_TYPES; type++)
+		if (g_ascii_strcasecmp (string, measure_type_names[type]) == 0)
+			return type;
+
+	return MEASURE_N_TYPES;
+}
+
+/**
+ * @returns the index of the first element of @x that is not smaller
+ * than @value or @n if there is none
+ */
+gsize measure_lower_bound (const gdouble *x, gsize n, gdouble value)
+{
+	gsize low = 0, high = n;
+
+	while (low < high) {
+		gsize mid = low + (high - low) / 2;
+		if (x[mid] < value)
+			low = mid + 1;
+		else
+			high = mid;
+	}
+
+	return low;
+}
+
+/**
+ * Linear interpolation of the function (x, y) at @at. Outside of the
+ * data range the first respectively last value is returned.
+ */
+gdouble measure_interpolate (const gdouble *x, const gdouble *y, gsize n, gdouble at)
+{
+	g_return_val_if_fail (n > 0, NAN);
+
+	if (at <= x[0])
+		return y[0];
+	if (at >= x[n - 1])
+		return y[n - 1];
+
+	gsize i = measure_lower_bound (x, n, at);
+	if (x[i] == at)
+		return y[i];
+
+	gdouble dx = x[i] - x[i - 1];
+	if (dx == 0)
+		return y[i];
+	return y[i - 1] + (at - x[i - 1]) / dx * (y[i] - y[i - 1]);
+}
+
+/**
+ * Searches the transitions of (x, y) through @level between the samples
+ * @begin and @end (exclusive). The x positions of the crossings are
+ * interpolated linearly and stored in @out if it is not NULL.
+ *
+ * @returns the number of crossings found (at most @max_out if @out is
+ * given)
+ */
+gsize measure_crossings (const gdouble *x, const gdouble *y, gsize begin, gsize end, gdouble level,
+                         MeasureEdge edge, gdouble *out, gsize max_out)
+{
+	guint8 above[MEASURE_BLOCK_SIZE + 1];
+	gsize count = 0;
+
+	if (out != NULL && max_out == 0)
+		return 0;
+
+	for (gsize start = begin; start + 1 < end; start += MEASURE_BLOCK_SIZE) {
+		// one sample overlap, so the transition between two blocks is seen
+		gsize len = MIN (MEASURE_BLOCK_SIZE + 1, end - start);
+		const gdouble *yb = y + start;
+		guint8 changes = 0;
+
+		for (gsize i = 0; i < len; i++)
+			above[i] = yb[i] >= level;
+		for (gsize i = 0; i + 1 < len; i++)
+			changes |= above[i] ^ above[i + 1];
+		if (!changes)
+			continue;
+
+		for (gsize i = 0; i + 1 < len; i++) {
+			if (above[i] == above[i + 1])
+				continue;
+			if (edge == MEASURE_EDGE_RISE && !above[i + 1])
+				continue;
+			if (edge == MEASURE_EDGE_FALL && above[i + 1])
+				continue;
+
+			if (out != NULL) {
+				gdouble x0 = x[start + i], x1 = x[start + i + 1];
+				gdouble y0 = yb[i], y1 = yb[i + 1];
+				gdouble t = y1 != y0 ? (level - y0) / (y1 - y0) : 0;
+				out[count] = x0 + t * (x1 - x0);
+			}
+			count++;
+			if (out != NULL && count == max_out)
+				return count;
+		}
+	}
+
+	return count;
+}
+
+/**
+ * Statistics of (x, y) over the window [@from, @to], assuming linear
+ * behaviour between the samples. The window boundaries are interpolated,
+ * so the result does not depend on where the simulator placed its
+ * time steps.
+ *
+ * @returns FALSE if the window does not overlap the data
+ */
+gboolean measure_window_stats (const gdouble *x, const gdouble *y, gsize n, gdouble from,
+                               gdouble to, MeasureStats *stats)
+{
+	g_return_val_if_fail (stats != NULL, FALSE);
+
+	if (n == 0)
+		return FALSE;
+	from = MAX (from, x[0]);
+	to = MIN (to, x[n - 1]);
+	if (from > to)
+		return FALSE;
+
+	gdouble y_from = measure_interpolate (x, y, n, from);
+	gdouble y_to = measure_interpolate (x, y, n, to);
+
+	// samples strictly inside the window are [i0, i1)
+	gsize i0 = measure_lower_bound (x, n, from);
+	gsize i1 = measure_lower_bound (x, n, to);
+	while (i0 < i1 && x[i0] == from)
+		i0++;
+
+	gdouble min = MIN (y_from, y_to), max = MAX (y_from, y_to);
+	gdouble x_min = y_from <= y_to ? from : to, x_max = y_from >= y_to ? from : to;
+	for (gsize i = i0; i < i1; i++) {
+		if (y[i] < min) {
+			min = y[i];
+			x_min = x[i];
+		}
+		if (y[i] > max) {
+			max = y[i];
+			x_max = x[i];
+		}
+	}
+
+	// The integral of y and y^2 of a linear segment are exact with the
+	// trapezoid rule respectively (y0^2 + y0 y1 + y1^2) / 3.
+	gdouble integral = 0, square = 0;
+	gdouble px = from, py = y_from;
+	if (i0 < i1) {
+		integral += (x[i0] - from) * (y_from + y[i0]);
+		square += (x[i0] - from) * (y_from * y_from + y_from * y[i0] + y[i0] * y[i0]);
+		for (gsize i = i0; i + 1 < i1; i++) {
+			gdouble dx = x[i + 1] - x[i];
+			integral += dx * (y[i] + y[i + 1]);
+			square += dx * (y[i] * y[i] + y[i] * y[i + 1] + y[i + 1] * y[i + 1]);
+		}
+		px = x[i1 - 1];
+		py = y[i1 - 1];
+	}
+	integral += (to - px) * (py + y_to);
+	square += (to - px) * (py * py + py * y_to + y_to * y_to);
+	integral /= 2;
+	square /= 3;
+
+	stats->min = min;
+	stats->max = max;
+	stats->x_min = x_min;
+	stats->x_max = x_max;
+	stats->integral = integral;
+	if (to > from) {
+		stats->avg = integral / (to - from);
+		stats->rms = sqrt (square / (to - from));
+	} else {
+		stats->avg = y_from;
+		stats->rms = fabs (y_from);
+	}
+
+	return TRUE;
+}
+
+/**
+ * Crossings inside [@from, @to]. The segment that straddles @from is
+ * included in the search, crossings outside the window are dropped.
+ *
+ * @returns an array of gdouble, free with g_array_free
+ */
+static GArray *measure_window_crossings (const gdouble *x, const gdouble *y, gsize n, gdouble from,
+                                         gdouble to, gdouble level, MeasureEdge edge)
+{
+	gsize begin = measure_lower_bound (x, n, from);
+	gsize end = MIN (measure_lower_bound (x, n, to) + 1, n);
+	if (begin > 0)
+		begin--;
+
+	gsize count = measure_crossings (x, y, begin, end, level, edge, NULL, 0);
+	GArray *crossings = g_array_sized_new (FALSE, FALSE, sizeof(gdouble), count);
+	g_array_set_size (crossings, count);
+	measure_crossings (x, y, begin, end, level, edge, (gdouble *)crossings->data, count);
+
+	guint j = 0;
+	for (guint i = 0; i < crossings->len; i++) {
+		gdouble c = g_array_index (crossings, gdouble, i);
+		if (c >= from && c <= to)
+			g_array_index (crossings, gdouble, j++) = c;
+	}
+	g_array_set_size (crossings, j);
+
+	return crossings;
+}
+
+static gint measure_find_variable (const SimulationData *sdat, const gchar *name)
+{
+	for (gint i = 0; i < sdat->n_variables; i++)
+		if (sdat->var_names[i] && g_ascii_strcasecmp (sdat->var_names[i], name) == 0)
+			return i;
+	return -1;
+}
+
+static gboolean measure_nth_crossing (const gdouble *x, const gdouble *y, gsize n, gdouble from,
+                                      gdouble to, gdouble level, MeasureEdge edge,
+                                      guint occurrence, gdouble *result)
+{
+	GArray *crossings = measure_window_crossings (x, y, n, from, to, level, edge);
+	gboolean found = occurrence >= 1 && occurrence <= crossings->len;
+
+	if (found)
+		*result = g_array_index (crossings, gdouble, occurrence - 1);
+	g_array_free (crossings, TRUE);
+
+	return found;
+}
+
+/**
+ * Time the waveform needs from crossing @first to crossing @second.
+ * Used for rise and fall time.
+ */
+static gboolean measure_transition (const gdouble *x, const gdouble *y, gsize n, gdouble from,
+                                    gdouble to, gdouble first, gdouble second, MeasureEdge edge,
+                                    guint occurrence, gdouble *result)
+{
+	gdouble t_first, t_second;
+
+	if (!measure_nth_crossing (x, y, n, from, to, first, edge, occurrence, &t_first))
+		return FALSE;
+	if (!measure_nth_crossing (x, y, n, t_first, to, second, edge, 1, &t_second))
+		return FALSE;
+
+	*result = t_second - t_first;
+	return TRUE;
+}
+
+static gboolean measure_settling_time (const gdouble *x, const gdouble *y, gsize n, gdouble from,
+                                       gdouble to, gdouble tolerance, gdouble *result)
+{
+	gdouble initial = measure_interpolate (x, y, n, from);
+	gdouble final = measure_interpolate (x, y, n, to);
+	gdouble band = tolerance * fabs (final - initial);
+
+	gsize i0 = measure_lower_bound (x, n, from);
+	gsize i1 = measure_lower_bound (x, n, to);
+
+	// search backwards for the last sample outside of the band
+	gsize i = i1;
+	while (i > i0 && fabs (y[i - 1] - final) <= band)
+		i--;
+	if (i == i0) {
+		*result = 0;
+		return TRUE;
+	}
+	i--;
+	if (i + 1 >= n)
+		return FALSE;
+
+	gdouble target = y[i] > final ? final + band : final - band;
+	gdouble t = (target - y[i]) / (y[i + 1] - y[i]);
+	*result = x[i] + t * (x[i + 1] - x[i]) - from;
+
+	return TRUE;
+}
+
+static gboolean measure_duty_cycle (const gdouble *x, const gdouble *y, gsize n, gdouble from,
+                                    gdouble to, gdouble level, gdouble *result)
+{
+	GArray *rising = measure_window_crossings (x, y, n, from, to, level, MEASURE_EDGE_RISE);
+	GArray *falling = measure_window_crossings (x, y, n, from, to, level, MEASURE_EDGE_FALL);
+	gdouble high = 0, total = 0;
+	guint f = 0;
+
+	// only full periods (rising edge to rising edge) count
+	for (guint r = 0; r + 1 < rising->len; r++) {
+		gdouble rise = g_array_index (rising, gdouble, r);
+		gdouble next = g_array_index (rising, gdouble, r + 1);
+		while (f < falling->len && g_array_index (falling, gdouble, f) < rise)
+			f++;
+		if (f == falling->len)
+			break;
+		high += MIN (g_array_index (falling, gdouble, f), next) - rise;
+		total += next - rise;
+	}
+	g_array_free (rising, TRUE);
+	g_array_free (falling, TRUE);
+
+	if (total <= 0)
+		return FALSE;
+	*result = high / total;
+	return TRUE;
+}
+
+/**
+ * Evaluates @m on @sdat.
+ *
+ * Overshoot and duty cycle are reported as fractions (0.1 == 10 %),
+ * times in the unit of the independent variable.
+ *
+ * @returns FALSE and sets @error if the measurement can not be
+ * evaluated, e.g. because the signal never crosses the level
+ */
+gboolean measurement_evaluate (const Measurement *m, const SimulationData *sdat, gdouble *result,
+                               GError **error)
+{
+	g_return_val_if_fail (m != NULL, FALSE);
+	g_return_val_if_fail (sdat != NULL, FALSE);
+	g_return_val_if_fail (result != NULL, FALSE);
+
+	if (sdat->type == ANALYSIS_TYPE_OP_POINT || sdat->n_variables < 2 || sdat->data == NULL ||
+	    sdat->data[0] == NULL || sdat->data[0]->len < 2) {
+		g_set_error (error, OREGANO_ERROR, OREGANO_MEASURE_ERROR_BAD_DATA,
+		             _ ("Measurement \"%s\" needs a swept analysis"), m->name);
+		return FALSE;
+	}
+
+	gint column = measure_find_variable (sdat, m->variable);
+	if (column < 0 || sdat->data[column] == NULL) {
+		g_set_error (error, OREGANO_ERROR, OREGANO_MEASURE_ERROR_NO_SUCH_VARIABLE,
+		             _ ("Measurement \"%s\": no variable \"%s\""), m->name, m->variable);
+		return FALSE;
+	}
+
+	const gdouble *x = (const gdouble *)sdat->data[0]->data;
+	const gdouble *y = (const gdouble *)sdat->data[column]->data;
+	gsize n = MIN (sdat->data[0]->len, sdat->data[column]->len);
+
+	for (gsize i = 1; i < n; i++) {
+		if (x[i] < x[i - 1]) {
+			g_set_error (error, OREGANO_ERROR, OREGANO_MEASURE_ERROR_BAD_DATA,
+			             _ ("Measurement \"%s\": %s is not monotonic"), m->name,
+			             sdat->var_names[0]);
+			return FALSE;
+		}
+	}
+
+	gdouble from = MAX (m->from, x[0]);
+	gdouble to = MIN (m->to, x[n - 1]);
+	MeasureStats stats;
+	if (!measure_window_stats (x, y, n, from, to, &stats)) {
+		g_set_error (error, OREGANO_ERROR, OREGANO_MEASURE_ERROR_BAD_DATA,
+		             _ ("Measurement \"%s\": the window is empty"), m->name);
+		return FALSE;
+	}
+
+	gdouble swing = stats.max - stats.min;
+	gdouble level = isnan (m->threshold) ? stats.min + swing / 2 : m->threshold;
+	gdouble step = measure_interpolate (x, y, n, to) - measure_interpolate (x, y, n, from);
+	gboolean found = TRUE;
+
+	switch (m->type) {
+	case MEASURE_MIN:
+		*result = stats.min;
+		break;
+	case MEASURE_MAX:
+		*result = stats.max;
+		break;
+	case MEASURE_PEAK_TO_PEAK:
+		*result = swing;
+		break;
+	case MEASURE_AVG:
+		*result = stats.avg;
+		break;
+	case MEASURE_RMS:
+		*result = stats.rms;
+		break;
+	case MEASURE_INTEGRAL:
+		*result = stats.integral;
+		break;
+	case MEASURE_CROSS:
+		found = measure_nth_crossing (x, y, n, from, to, level, m->edge, m->occurrence, result);
+		break;
+	case MEASURE_RISE_TIME:
+		found = swing > 0 &&
+		        measure_transition (x, y, n, from, to, stats.min + m->low * swing,
+		                            stats.min + m->high * swing, MEASURE_EDGE_RISE,
+		                            m->occurrence, result);
+		break;
+	case MEASURE_FALL_TIME:
+		found = swing > 0 &&
+		        measure_transition (x, y, n, from, to, stats.min + m->high * swing,
+		                            stats.min + m->low * swing, MEASURE_EDGE_FALL,
+		                            m->occurrence, result);
+		break;
+	case MEASURE_OVERSHOOT: {
+		gdouble final = measure_interpolate (x, y, n, to);
+		found = step != 0;
+		if (found)
+			*result = MAX (0, (step > 0 ? stats.max - final : final - stats.min) / fabs (step));
+		break;
+	}
+	case MEASURE_SETTLING_TIME:
+		found = step != 0 && measure_settling_time (x, y, n, from, to, m->tolerance, result);
+		break;
+	case MEASURE_PERIOD:
+	case MEASURE_FREQUENCY: {
+		MeasureEdge edge = m->edge == MEASURE_EDGE_FALL ? MEASURE_EDGE_FALL : MEASURE_EDGE_RISE;
+		GArray *crossings = measure_window_crossings (x, y, n, from, to, level, edge);
+		found = crossings->len >= 2;
+		if (found) {
+			gdouble period = (g_array_index (crossings, gdouble, crossings->len - 1) -
+			                  g_array_index (crossings, gdouble, 0)) /
+			                 (crossings->len - 1);
+			*result = m->type == MEASURE_PERIOD ? period : 1 / period;
+		}
+		g_array_free (crossings, TRUE);
+		break;
+	}
+	case MEASURE_DUTY_CYCLE:
+		found = measure_duty_cycle (x, y, n, from, to, level, result);
+		break;
+	default:
+		g_return_val_if_reached (FALSE);
+	}
+
+	if (!found) {
+		g_set_error (error, OREGANO_ERROR, OREGANO_MEASURE_ERROR_NOT_FOUND,
+		             _ ("Measurement \"%s\" (%s of %s) not found in the window"), m->name,
+		             measurement_type_to_string (m->type), m->variable);
+		return FALSE;
+	}
+
+	return TRUE;
+}
+
+struct _MeasureTable {
+	// Measurement *, owned
+	GPtrArray *measurements;
+	// gchar *
+	GPtrArray *labels;
+	// const SimulationData *, not owned
+	GPtrArray *runs;
+
+	// runs x measurements, row major, NAN for failed measurements
+	gdouble *results;
+	gchar **errors;
+};
+
+MeasureTable *measure_table_new (void)
+{
+	MeasureTable *table = g_new0 (MeasureTable, 1);
+
+	table->measurements = g_ptr_array_new_with_free_func ((GDestroyNotify)measurement_free);
+	table->labels = g_ptr_array_new_with_free_func (g_free);
+	table->runs = g_ptr_array_new ();
+
+	return table;
+}
+
+static void measure_table_clear_results (MeasureTable *table)
+{
+	if (table->errors != NULL) {
+		guint count = table->runs->len * table->measurements->len;
+		for (guint i = 0; i < count; i++)
+			g_free (table->errors[i]);
+	}
+	g_clear_pointer (&table->errors, g_free);
+	g_clear_pointer (&table->results, g_free);
+}
+
+void measure_table_free (MeasureTable *table)
+{
+	if (table == NULL)
+		return;
+	measure_table_clear_results (table);
+	g_ptr_array_unref (table->measurements);
+	g_ptr_array_unref (table->labels);
+	g_ptr_array_unref (table->runs);
+	g_free (table);
+}
+
+/**
+ * @m is owned by @table afterwards.
+ */
+void measure_table_add_measurement (MeasureTable *table, Measurement *m)
+{
+	g_return_if_fail (table != NULL);
+	g_return_if_fail (m != NULL);
+
+	measure_table_clear_results (table);
+	g_ptr_array_add (table->measurements, m);
+}
+
+/**
+ * @sdat has to stay alive until the table is evaluated.
+ */
+void measure_table_add_run (MeasureTable *table, const gchar *label, const SimulationData *sdat)
+{
+	g_return_if_fail (table != NULL);
+	g_return_if_fail (sdat != NULL);
+
+	measure_table_clear_results (table);
+	g_ptr_array_add (table->labels, g_strdup (label));
+	g_ptr_array_add (table->runs, (gpointer)sdat);
+}
+
+guint measure_table_get_n_measurements (const MeasureTable *table)
+{
+	return table->measurements->len;
+}
+
+guint measure_table_get_n_runs (const MeasureTable *table)
+{
+	return table->runs->len;
+}
+
+typedef struct
+{
+	MeasureTable *table;
+	guint run;
+} MeasureTableRun;
+
+/**
+ * Evaluates all measurements of one run. The runs write to disjoint
+ * parts of the result arrays, so no locking is needed.
+ */
+static void measure_table_evaluate_run (MeasureTableRun *job, CancelInfo *cancel_info)
+{
+	MeasureTable *table = job->table;
+	guint run = job->run;
+	const SimulationData *sdat = g_ptr_array_index (table->runs, run);
+
+	for (guint j = 0; j < table->measurements->len; j++) {
+		guint slot = run * table->measurements->len + j;
+		GError *e = NULL;
+
+		if (!measurement_evaluate (g_ptr_array_index (table->measurements, j), sdat,
+		                           &table->results[slot], &e)) {
+			table->results[slot] = NAN;
+			table->errors[slot] = g_strdup (e->message);
+			g_clear_error (&e);
+		}
+	}
+}
+
+/**
+ * Evaluates every measurement for every run. The runs are distributed
+ * over the workers of the task scheduler. Blocks until all results are
+ * there.
+ */
+void measure_table_evaluate (MeasureTable *table)
+{
+	g_return_if_fail (table != NULL);
+
+	measure_table_clear_results (table);
+	guint count = table->runs->len * table->measurements->len;
+	table->results = g_new0 (gdouble, count);
+	table->errors = g_new0 (gchar *, count);
+
+	if (table->runs->len == 1) {
+		MeasureTableRun job = {table, 0};
+		measure_table_evaluate_run (&job, NULL);
+		return;
+	}
+
+	// the user waits for it
+	TaskScheduler *scheduler = task_scheduler_get_default ();
+	Task **tasks = g_new (Task *, table->runs->len);
+
+	for (guint run = 0; run < table->runs->len; run++) {
+		MeasureTableRun *job = g_new (MeasureTableRun, 1);
+		job->table = table;
+		job->run = run;
+		tasks[run] = task_scheduler_run (scheduler, (TaskFunc)measure_table_evaluate_run, job,
+		                                 g_free, TASK_PRIORITY_HIGH);
+	}
+
+	for (guint run = 0; run < table->runs->len; run++) {
+		task_wait (tasks[run]);
+		task_unref (tasks[run]);
+	}
+	g_free (tasks);
+}
+
+/**
+ * @returns NAN if the table was not evaluated or the measurement failed
+ */
+gdouble measure_table_get (const MeasureTable *table, guint run, guint measurement)
+{
+	g_return_val_if_fail (table != NULL, NAN);
+	g_return_val_if_fail (run < table->runs->len, NAN);
+	g_return_val_if_fail (measurement < table->measurements->len, NAN);
+
+	if (table->results == NULL)
+		return NAN;
+	return table->results[run * table->measurements->len + measurement];
+}
+
+/**
+ * @returns the reason why a measurement failed or NULL
+ */
+const gchar *measure_table_get_error (const MeasureTable *table, guint run, guint measurement)
+{
+	g_return_val_if_fail (table != NULL, NULL);
+	g_return_val_if_fail (run < table->runs->len, NULL);
+	g_return_val_if_fail (measurement < table->measurements->len, NULL);
+
+	if (table->errors == NULL)
+		return NULL;
+	return table->errors[run * table->measurements->len + measurement];
+}
+
+static void measure_csv_append_field (GString *csv, const gchar *field)
+{
+	if (field == NULL)
+		return;
+	if (strpbrk (field, ",\"\n") == NULL) {
+		g_string_append (csv, field);
+		return;
+	}
+
+	g_string_append_c (csv, '"');
+	for (const gchar *c = field; *c; c++) {
+		if (*c == '"')
+			g_string_append_c (csv, '"');
+		g_string_append_c (csv, *c);
+	}
+	g_string_append_c (csv, '"');
+}
+
+/**
+ * One line per run, one column per measurement. Failed measurements
+ * are left empty. Numbers are written locale independent.
+ *
+ * @returns a newly allocated string
+ */
+gchar *measure_table_to_csv (const MeasureTable *table)
+{
+	g_return_val_if_fail (table != NULL, NULL);
+
+	GString *csv = g_string_new ("run");
+	gchar buffer[G_ASCII_DTOSTR_BUF_SIZE];
+
+	for (guint j = 0; j < table->measurements->len; j++) {
+		const Measurement *m = g_ptr_array_index (table->measurements, j);
+		g_string_append_c (csv, ',');
+		measure_csv_append_field (csv, m->name);
+	}
+	g_string_append_c (csv, '\n');
+
+	for (guint run = 0; run < table->runs->len; run++) {
+		measure_csv_append_field (csv, g_ptr_array_index (table->labels, run));
+		for (guint j = 0; j < table->measurements->len; j++) {
+			gdouble value = measure_table_get (table, run, j);
+			g_string_append_c (csv, ',');
+			if (!isnan (value))
+				g_string_append (csv, g_ascii_dtostr (buffer, sizeof(buffer), value));
+		}
+		g_string_append_c (csv, '\n');
+	}
+
+	return g_string_free (csv, FALSE);
+}
+
+gboolean measure_table_save (const MeasureTable *table, const gchar *filename, GError **error)
+{
+	g_return_val_if_fail (table != NULL, FALSE);
+	g_return_val_if_fail (filename != NULL, FALSE);
+
+	gchar *csv = measure_table_to_csv (table);
+	gboolean success = g_file_set_contents (filename, csv, -1, error);
+	g_free (csv);
+
+	return success;
+}
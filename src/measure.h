@@ -0,0 +1,142 @@
+/*
+ * measure.h
+ *
+ *
+ * Authors:
+ *  Michi <st101564@stud.uni-stuttgart.de>
+ *
+ * Web page: https://ahoi.io/project/oregano
+ *
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef MEASURE_H_
+#define MEASURE_H_
+
+#include <glib.h>
+
+#include "simulation.h"
+
+/**
+ * Waveform measurements (in the spirit of spice's .meas statement)
+ * evaluated on the columns of a SimulationData. Column 0 is the
+ * independent variable (time, frequency, sweep value) and has to be
+ * non-decreasing, which allows binary searching for window boundaries.
+ */
+
+typedef enum {
+	MEASURE_MIN = 0,
+	MEASURE_MAX,
+	MEASURE_PEAK_TO_PEAK,
+	MEASURE_AVG,
+	MEASURE_RMS,
+	MEASURE_INTEGRAL,
+	MEASURE_CROSS,
+	MEASURE_RISE_TIME,
+	MEASURE_FALL_TIME,
+	MEASURE_OVERSHOOT,
+	MEASURE_SETTLING_TIME,
+	MEASURE_PERIOD,
+	MEASURE_FREQUENCY,
+	MEASURE_DUTY_CYCLE,
+	MEASURE_N_TYPES
+} MeasureType;
+
+typedef enum {
+	MEASURE_EDGE_ANY = 0,
+	MEASURE_EDGE_RISE,
+	MEASURE_EDGE_FALL
+} MeasureEdge;
+
+typedef struct _Measurement Measurement;
+
+struct _Measurement {
+	gchar *name;
+	MeasureType type;
+	// name of the column as in SimulationData.var_names
+	gchar *variable;
+
+	// window on the independent variable, defaults to everything
+	gdouble from;
+	gdouble to;
+
+	// level for MEASURE_CROSS, MEASURE_PERIOD, MEASURE_FREQUENCY and
+	// MEASURE_DUTY_CYCLE. NAN means the middle between min and max
+	// inside the window.
+	gdouble threshold;
+	MeasureEdge edge;
+	// 1 based, which crossing to report for MEASURE_CROSS and which
+	// edge to start at for rise and fall time
+	guint occurrence;
+
+	// reference levels for rise and fall time as fraction of the swing
+	gdouble low;
+	gdouble high;
+
+	// settling band as fraction of the step height
+	gdouble tolerance;
+};
+
+typedef struct {
+	gdouble min;
+	gdouble max;
+	gdouble x_min;
+	gdouble x_max;
+	gdouble avg;
+	gdouble rms;
+	gdouble integral;
+} MeasureStats;
+
+Measurement *measurement_new (const gchar *name, MeasureType type, const gchar *variable);
+Measurement *measurement_copy (const Measurement *m);
+void measurement_free (Measurement *m);
+
+const gchar *measurement_type_to_string (MeasureType type);
+MeasureType measurement_type_from_string (const gchar *string);
+
+gboolean measurement_evaluate (const Measurement *m, const SimulationData *sdat, gdouble *result,
+                               GError **error);
+
+/*
+ * Kernels working on plain arrays. x has to be non-decreasing.
+ */
+gsize measure_lower_bound (const gdouble *x, gsize n, gdouble value);
+gdouble measure_interpolate (const gdouble *x, const gdouble *y, gsize n, gdouble at);
+gsize measure_crossings (const gdouble *x, const gdouble *y, gsize begin, gsize end, gdouble level,
+                         MeasureEdge edge, gdouble *out, gsize max_out);
+gboolean measure_window_stats (const gdouble *x, const gdouble *y, gsize n, gdouble from,
+                               gdouble to, MeasureStats *stats);
+
+/*
+ * A table of measurements evaluated for several runs (e.g. the
+ * analyses of one simulation or the results of a parameter sweep).
+ */
+typedef struct _MeasureTable MeasureTable;
+
+MeasureTable *measure_table_new (void);
+void measure_table_free (MeasureTable *table);
+void measure_table_add_measurement (MeasureTable *table, Measurement *m);
+void measure_table_add_run (MeasureTable *table, const gchar *label, const SimulationData *sdat);
+guint measure_table_get_n_measurements (const MeasureTable *table);
+guint measure_table_get_n_runs (const MeasureTable *table);
+void measure_table_evaluate (MeasureTable *table);
+gdouble measure_table_get (const MeasureTable *table, guint run, guint measurement);
+const gchar *measure_table_get_error (const MeasureTable *table, guint run, guint measurement);
+gchar *measure_table_to_csv (const MeasureTable *table);
+gboolean measure_table_save (const MeasureTable *table, const gchar *filename, GError **error);
+
+#endif /* MEASURE_H_ */
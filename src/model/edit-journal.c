@@ -0,0 +1,371 @@
+/*
+ * edit-journal.c
+ *
+ *
+ * Authors:
+ *  Michi <st101564@stud.uni-stuttgart.de>
+ *
+ * Web page: https://ahoi.io/project/oregano
+ *
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+
+#include <string.h>
+
+#include "edit-journal.h"
+
+typedef enum { EDIT_ADD, EDIT_REMOVE, EDIT_MOVE, EDIT_ROTATE, EDIT_FLIP } EditKind;
+
+typedef struct
+{
+	EditKind kind;
+	guint n_items;
+	// referenced, not copied
+	ItemData **items;
+	// per item for EDIT_MOVE and EDIT_FLIP, NULL if all of them use delta
+	Coords *deltas;
+	Coords delta;
+	Coords center;
+	gint angle;
+	IDFlip direction;
+} EditEntry;
+
+struct _EditJournal
+{
+	Schematic *sm;
+	// of EditEntry, newest first
+	GQueue undo;
+	GQueue redo;
+	guint n_items;
+	guint max_steps;
+	guint max_items;
+};
+
+EditJournal *edit_journal_new (Schematic *sm)
+{
+	EditJournal *journal = g_new0 (EditJournal, 1);
+
+	journal->sm = sm;
+	g_queue_init (&journal->undo);
+	g_queue_init (&journal->redo);
+	journal->max_steps = EDIT_JOURNAL_MAX_STEPS;
+	journal->max_items = EDIT_JOURNAL_MAX_ITEMS;
+
+	return journal;
+}
+
+static void edit_entry_free (EditEntry *entry)
+{
+	for (guint i = 0; i < entry->n_items; i++)
+		g_object_unref (entry->items[i]);
+	g_free (entry->items);
+	g_free (entry->deltas);
+	g_free (entry);
+}
+
+static void edit_journal_drop_all (EditJournal *journal, GQueue *queue)
+{
+	EditEntry *entry;
+
+	while ((entry = g_queue_pop_head (queue)) != NULL) {
+		journal->n_items -= entry->n_items;
+		edit_entry_free (entry);
+	}
+}
+
+void edit_journal_free (EditJournal *journal)
+{
+	if (journal == NULL)
+		return;
+
+	edit_journal_drop_all (journal, &journal->undo);
+	edit_journal_drop_all (journal, &journal->redo);
+	g_free (journal);
+}
+
+static void edit_journal_changed (EditJournal *journal)
+{
+	g_signal_emit_by_name (journal->sm, "journal_changed");
+}
+
+// forgets the oldest edits until the journal fits into its limits again
+static void edit_journal_trim (EditJournal *journal)
+{
+	EditEntry *entry;
+
+	while (journal->undo.length > 1 && (journal->undo.length > journal->max_steps ||
+	                                    journal->n_items > journal->max_items)) {
+		entry = g_queue_pop_tail (&journal->undo);
+		journal->n_items -= entry->n_items;
+		edit_entry_free (entry);
+	}
+}
+
+void edit_journal_set_limits (EditJournal *journal, guint max_steps, guint max_items)
+{
+	g_return_if_fail (journal != NULL);
+
+	journal->max_steps = MAX (max_steps, 1);
+	journal->max_items = max_items;
+	edit_journal_trim (journal);
+	edit_journal_changed (journal);
+}
+
+static EditEntry *edit_entry_new (EditKind kind, GList *items)
+{
+	EditEntry *entry = g_new0 (EditEntry, 1);
+	guint i = 0;
+
+	entry->kind = kind;
+	entry->items = g_new (ItemData *, g_list_length (items));
+	for (; items; items = items->next)
+		if (items->data != NULL)
+			entry->items[i++] = g_object_ref (items->data);
+	entry->n_items = i;
+
+	return entry;
+}
+
+// a new edit makes the undone ones unreachable
+static void edit_journal_push (EditJournal *journal, EditEntry *entry)
+{
+	if (entry->n_items == 0) {
+		edit_entry_free (entry);
+		return;
+	}
+
+	edit_journal_drop_all (journal, &journal->redo);
+	g_queue_push_head (&journal->undo, entry);
+	journal->n_items += entry->n_items;
+	edit_journal_trim (journal);
+	edit_journal_changed (journal);
+}
+
+void edit_journal_add (EditJournal *journal, GList *items)
+{
+	g_return_if_fail (journal != NULL);
+
+	edit_journal_push (journal, edit_entry_new (EDIT_ADD, items));
+}
+
+void edit_journal_remove (EditJournal *journal, GList *items)
+{
+	g_return_if_fail (journal != NULL);
+
+	edit_journal_push (journal, edit_entry_new (EDIT_REMOVE, items));
+}
+
+void edit_journal_move (EditJournal *journal, GList *items, const Coords *delta)
+{
+	EditEntry *entry;
+
+	g_return_if_fail (journal != NULL);
+	g_return_if_fail (delta != NULL);
+
+	entry = edit_entry_new (EDIT_MOVE, items);
+	entry->delta = *delta;
+	edit_journal_push (journal, entry);
+}
+
+// NULL if every delta is the same as the first one
+static Coords *edit_entry_copy_deltas (EditEntry *entry, const Coords *deltas)
+{
+	if (deltas == NULL || entry->n_items == 0)
+		return NULL;
+
+	entry->delta = deltas[0];
+	for (guint i = 1; i < entry->n_items; i++)
+		if (deltas[i].x != deltas[0].x || deltas[i].y != deltas[0].y)
+			return memcpy (g_new (Coords, entry->n_items), deltas,
+			               entry->n_items * sizeof (Coords));
+
+	return NULL;
+}
+
+void edit_journal_move_each (EditJournal *journal, GList *items, const Coords *deltas)
+{
+	EditEntry *entry;
+
+	g_return_if_fail (journal != NULL);
+	g_return_if_fail (deltas != NULL);
+
+	entry = edit_entry_new (EDIT_MOVE, items);
+	entry->deltas = edit_entry_copy_deltas (entry, deltas);
+	edit_journal_push (journal, entry);
+}
+
+void edit_journal_rotate (EditJournal *journal, GList *items, gint angle, const Coords *center)
+{
+	EditEntry *entry;
+
+	g_return_if_fail (journal != NULL);
+	g_return_if_fail (center != NULL);
+
+	entry = edit_entry_new (EDIT_ROTATE, items);
+	entry->angle = angle;
+	entry->center = *center;
+	edit_journal_push (journal, entry);
+}
+
+void edit_journal_flip (EditJournal *journal, GList *items, IDFlip direction,
+                        const Coords *center, const Coords *deltas)
+{
+	EditEntry *entry;
+
+	g_return_if_fail (journal != NULL);
+	g_return_if_fail (center != NULL);
+
+	entry = edit_entry_new (EDIT_FLIP, items);
+	entry->direction = direction;
+	entry->center = *center;
+	entry->deltas = edit_entry_copy_deltas (entry, deltas);
+	edit_journal_push (journal, entry);
+}
+
+static void edit_entry_move_item (EditEntry *entry, guint i, gboolean forward)
+{
+	Coords delta = entry->deltas ? entry->deltas[i] : entry->delta;
+
+	if (!forward) {
+		delta.x = -delta.x;
+		delta.y = -delta.y;
+	}
+	if (delta.x != 0. || delta.y != 0.)
+		item_data_move (entry->items[i], &delta);
+}
+
+/**
+ * Does the edit again (@forward) or reverts it. Items are changed the
+ * way the sheet changes them, unregistered from the node store while
+ * they are transformed.
+ */
+static void edit_entry_apply (EditJournal *journal, EditEntry *entry, gboolean forward)
+{
+	guint i;
+
+	switch (entry->kind) {
+	case EDIT_ADD:
+	case EDIT_REMOVE:
+		if ((entry->kind == EDIT_ADD) == forward) {
+			for (i = 0; i < entry->n_items; i++)
+				schematic_readd_item (journal->sm, entry->items[i]);
+		} else {
+			for (i = entry->n_items; i-- > 0;)
+				schematic_remove_item (journal->sm, entry->items[i]);
+		}
+		break;
+
+	case EDIT_MOVE:
+		for (i = 0; i < entry->n_items; i++) {
+			item_data_unregister (entry->items[i]);
+			edit_entry_move_item (entry, i, forward);
+			item_data_register (entry->items[i]);
+		}
+		break;
+
+	case EDIT_ROTATE:
+		for (i = 0; i < entry->n_items; i++) {
+			item_data_unregister (entry->items[i]);
+			item_data_rotate (entry->items[i], forward ? entry->angle : 360 - entry->angle % 360,
+			                  &entry->center);
+			item_data_register (entry->items[i]);
+		}
+		break;
+
+	case EDIT_FLIP:
+		// flipping twice is no flip, the snap after it is undone first
+		for (i = 0; i < entry->n_items; i++) {
+			item_data_unregister (entry->items[i]);
+			if (!forward)
+				edit_entry_move_item (entry, i, FALSE);
+			item_data_flip (entry->items[i], entry->direction, &entry->center);
+			if (forward)
+				edit_entry_move_item (entry, i, TRUE);
+			item_data_register (entry->items[i]);
+		}
+		break;
+	}
+}
+
+static gboolean edit_journal_replay (EditJournal *journal, GQueue *from, GQueue *to,
+                                     gboolean forward)
+{
+	EditEntry *entry;
+
+	g_return_val_if_fail (journal != NULL, FALSE);
+
+	entry = g_queue_pop_head (from);
+	if (entry == NULL)
+		return FALSE;
+
+	edit_entry_apply (journal, entry, forward);
+	g_queue_push_head (to, entry);
+	edit_journal_changed (journal);
+
+	return TRUE;
+}
+
+gboolean edit_journal_undo (EditJournal *journal)
+{
+	return edit_journal_replay (journal, &journal->undo, &journal->redo, FALSE);
+}
+
+gboolean edit_journal_redo (EditJournal *journal)
+{
+	return edit_journal_replay (journal, &journal->redo, &journal->undo, TRUE);
+}
+
+gboolean edit_journal_can_undo (EditJournal *journal)
+{
+	g_return_val_if_fail (journal != NULL, FALSE);
+
+	return !g_queue_is_empty (&journal->undo);
+}
+
+gboolean edit_journal_can_redo (EditJournal *journal)
+{
+	g_return_val_if_fail (journal != NULL, FALSE);
+
+	return !g_queue_is_empty (&journal->redo);
+}
+
+void edit_journal_clear (EditJournal *journal)
+{
+	g_return_if_fail (journal != NULL);
+
+	if (g_queue_is_empty (&journal->undo) && g_queue_is_empty (&journal->redo))
+		return;
+
+	edit_journal_drop_all (journal, &journal->undo);
+	edit_journal_drop_all (journal, &journal->redo);
+	edit_journal_changed (journal);
+}
+
+guint edit_journal_get_n_steps (EditJournal *journal)
+{
+	g_return_val_if_fail (journal != NULL, 0);
+
+	return journal->undo.length + journal->redo.length;
+}
+
+guint edit_journal_get_n_items (EditJournal *journal)
+{
+	g_return_val_if_fail (journal != NULL, 0);
+
+	return journal->n_items;
+}
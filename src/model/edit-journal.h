@@ -0,0 +1,79 @@
+/*
+ * edit-journal.h
+ *
+ *
+ * Authors:
+ *  Michi <st101564@stud.uni-stuttgart.de>
+ *
+ * Web page: https://ahoi.io/project/oregano
+ *
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+
+#ifndef __EDIT_JOURNAL_H
+#define __EDIT_JOURNAL_H
+
+#include <glib.h>
+
+#include "schematic.h"
+#include "item-data.h"
+
+// Limits of the default journal of a schematic. The oldest edits are
+// forgotten first, the newest one is always kept.
+#define EDIT_JOURNAL_MAX_STEPS 100
+#define EDIT_JOURNAL_MAX_ITEMS 20000
+
+/**
+ * Undo and redo of the edits of a schematic.
+ *
+ * An edit is journaled as the items it touched together with what was
+ * done to them (a delta, an angle, a flip), never as copies of the items.
+ * Undo and redo replay the edit the same way it was done first, so they
+ * cost as much as the edit itself. Removed items are kept alive by the
+ * journal until their edit is forgotten.
+ *
+ * Every change of the journal is announced by the "journal_changed"
+ * signal of the schematic.
+ */
+
+EditJournal *edit_journal_new (Schematic *sm);
+void edit_journal_free (EditJournal *journal);
+// @max_items is the number of item references kept by both stacks
+void edit_journal_set_limits (EditJournal *journal, guint max_steps, guint max_items);
+
+// @items is a list of ItemData
+void edit_journal_add (EditJournal *journal, GList *items);
+void edit_journal_remove (EditJournal *journal, GList *items);
+void edit_journal_move (EditJournal *journal, GList *items, const Coords *delta);
+// one delta per item, in the order of @items
+void edit_journal_move_each (EditJournal *journal, GList *items, const Coords *deltas);
+void edit_journal_rotate (EditJournal *journal, GList *items, gint angle, const Coords *center);
+// @deltas are the moves made after flipping (snapping), NULL if none
+void edit_journal_flip (EditJournal *journal, GList *items, IDFlip direction,
+                        const Coords *center, const Coords *deltas);
+
+gboolean edit_journal_can_undo (EditJournal *journal);
+gboolean edit_journal_can_redo (EditJournal *journal);
+gboolean edit_journal_undo (EditJournal *journal);
+gboolean edit_journal_redo (EditJournal *journal);
+void edit_journal_clear (EditJournal *journal);
+
+guint edit_journal_get_n_steps (EditJournal *journal);
+guint edit_journal_get_n_items (EditJournal *journal);
+
+#endif /* __EDIT_JOURNAL_H */
@@ -50,6 +50,7 @@
 #include "part.h"
 #include "wire.h"
 #include "wire-private.h"
+#include "mem-stats.h"
 
 #include "debug.h"
 
@@ -82,11 +83,18 @@ static void node_store_dispose (GObject *self)
 	G_OBJECT_CLASS (node_store_parent_class)->dispose (self);
 }
 
+static void node_store_unref_node (gpointer key, Node *node, gpointer user_data)
+{
+	g_object_unref (node);
+}
+
 static void node_store_finalize (GObject *object)
 {
 	NodeStore *self = NODE_STORE (object);
 
 	if (self->nodes) {
+		// nodes of items that were never removed from the store
+		g_hash_table_foreach (self->nodes, (GHFunc)node_store_unref_node, NULL);
 		g_hash_table_destroy (self->nodes);
 		self->nodes = NULL;
 	}
@@ -104,6 +112,8 @@ static void node_store_finalize (GObject *object)
 		self->items = NULL;
 	}
 
+	mem_stats_add (MEM_STATS_NODE_STORE, -1, -(gssize)sizeof(NodeStore));
+
 	G_OBJECT_CLASS (node_store_parent_class)->finalize (object);
 }
 
@@ -135,6 +145,8 @@ static void node_store_init (NodeStore *self)
 	self->parts = NULL;
 	self->items = NULL;
 	self->textbox = NULL;
+
+	mem_stats_add (MEM_STATS_NODE_STORE, 1, sizeof(NodeStore));
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -676,8 +688,20 @@ gint node_store_count_items (NodeStore *store, NodeRect *rect)
 	return n;
 }
 
-static void draw_dot (Coords *pos, Node *value, cairo_t *cr)
+typedef struct
+{
+	cairo_t *cr;
+	NodeRect *rect;
+} DrawDotData;
+
+static void draw_dot (Coords *pos, Node *value, DrawDotData *data)
 {
+	cairo_t *cr = data->cr;
+
+	if (data->rect != NULL && (pos->x < data->rect->x0 || pos->x > data->rect->x1 ||
+	                           pos->y < data->rect->y0 || pos->y > data->rect->y1))
+		return;
+
 	if (node_needs_dot (value)) {
 		cairo_save (cr);
 		cairo_set_source_rgb (cr, 0.0, 0.0, 0.0);
@@ -689,10 +713,17 @@ static void draw_dot (Coords *pos, Node *value, cairo_t *cr)
 	}
 }
 
-void node_store_print_items (NodeStore *store, cairo_t *cr, SchematicPrintContext *ctx)
+/**
+ * Prints the items whose bounds intersect @rect, all of them if @rect is
+ * NULL. A page of a large print out only pays for what is on it.
+ */
+void node_store_print_items (NodeStore *store, cairo_t *cr, SchematicPrintContext *ctx,
+                             NodeRect *rect)
 {
 	GList *list;
 	ItemData *data;
+	Coords p1, p2;
+	DrawDotData dot_data = {cr, rect};
 
 	g_return_if_fail (store != NULL);
 	g_return_if_fail (IS_NODE_STORE (store));
@@ -700,10 +731,15 @@ void node_store_print_items (NodeStore *store, cairo_t *cr, SchematicPrintContex
 	cairo_set_line_join (cr, CAIRO_LINE_JOIN_ROUND);
 	for (list = store->items; list; list = list->next) {
 		data = ITEM_DATA (list->data);
+		if (rect != NULL) {
+			item_data_get_absolute_bbox (data, &p1, &p2);
+			if (p1.x > rect->x1 || p1.y > rect->y1 || p2.x < rect->x0 || p2.y < rect->y0)
+				continue;
+		}
 		item_data_print (data, cr, ctx);
 	}
 
-	g_hash_table_foreach (store->nodes, (GHFunc)draw_dot, cr);
+	g_hash_table_foreach (store->nodes, (GHFunc)draw_dot, &dot_data);
 }
 
 gboolean node_store_is_pin_at_pos (NodeStore *store, Coords pos)
@@ -102,7 +102,8 @@ GList *node_store_get_nodes (NodeStore *store);
 void node_store_dump_wires (NodeStore *store);
 void node_store_get_bounds (NodeStore *store, NodeRect *rect);
 gint node_store_count_items (NodeStore *store, NodeRect *rect);
-void node_store_print_items (NodeStore *store, cairo_t *opc, SchematicPrintContext *ctx);
+void node_store_print_items (NodeStore *store, cairo_t *opc, SchematicPrintContext *ctx,
+                             NodeRect *rect);
 Node *node_store_get_or_create_node (NodeStore *store, Coords pos);
 
 #endif
@@ -34,6 +34,7 @@
 
 #include "node.h"
 #include "part.h"
+#include "mem-stats.h"
 
 #include "debug.h"
 
@@ -60,6 +61,10 @@ static void node_finalize (GObject *object)
 	if (NODE (object)->wires) {
 		g_slist_free (NODE (object)->wires);
 	}
+	g_free (NODE (object)->netlist_node_name);
+
+	mem_stats_add (MEM_STATS_NODE_STORE, -1, -(gssize)sizeof(Node));
+
 	G_OBJECT_CLASS (node_parent_class)->finalize (object);
 }
 
@@ -92,6 +97,8 @@ static void node_init (Node *node)
 	node->pins = NULL;
 	node->wires = NULL;
 	node->visited = FALSE;
+
+	mem_stats_add (MEM_STATS_NODE_STORE, 1, sizeof(Node));
 }
 
 Node *node_new (Coords pos)
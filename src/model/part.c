@@ -133,6 +133,7 @@ static void part_finalize (GObject *object)
 
 		g_free (priv->pins);
 		g_free (priv->symbol_name);
+		library_unref (priv->library);
 
 		g_slice_free (PartPriv, priv);
 	}
@@ -221,7 +222,7 @@ Part *part_new_from_library_part (LibraryPart *library_part)
 
 	priv->name = g_strdup (library_part->name);
 	priv->symbol_name = g_strdup (library_part->symbol_name);
-	priv->library = library_part->library;
+	priv->library = library_ref (library_part->library);
 
 	part_update_bbox (part);
 
@@ -500,6 +501,52 @@ gboolean part_set_pins (Part *part, GSList *pins)
 	return TRUE;
 }
 
+Library *part_get_library (Part *part)
+{
+	g_return_val_if_fail (part != NULL, NULL);
+	g_return_val_if_fail (IS_PART (part), NULL);
+
+	return part->priv->library;
+}
+
+/**
+ * bind the part to its library after the library was parsed again
+ *
+ * The symbol is looked up by name anyway, only the bounding box has to
+ * follow it. The pins are kept as they are, since they were rotated and
+ * flipped together with the part. Returns FALSE if the new symbol has
+ * different pins, the part has to be placed again to get them.
+ */
+gboolean part_rebind_library (Part *part, Library *library)
+{
+	PartPriv *priv;
+	LibrarySymbol *symbol;
+	GSList *list;
+	int i;
+
+	g_return_val_if_fail (part != NULL, FALSE);
+	g_return_val_if_fail (IS_PART (part), FALSE);
+
+	priv = part->priv;
+	library_ref (library);
+	library_unref (priv->library);
+	priv->library = library;
+	part_update_bbox (part);
+
+	symbol = library_get_symbol (priv->symbol_name);
+	if (symbol == NULL || g_slist_length (symbol->connections) != priv->num_pins)
+		return FALSE;
+
+	for (list = symbol->connections, i = 0; list; list = list->next, i++) {
+		Connection *connection = list->data;
+
+		if (!coords_equal (&connection->pos, &priv->pins_orig[i].offset))
+			return FALSE;
+	}
+
+	return TRUE;
+}
+
 GSList *part_get_labels (Part *part)
 {
 	PartPriv *priv;
@@ -764,7 +811,8 @@ static void part_copy (ItemData *dest, ItemData *src)
 	//	dest_part->priv->rotation = src_part->priv->rotation;
 	dest_part->priv->flip = src_part->priv->flip;
 	dest_part->priv->num_pins = src_part->priv->num_pins;
-	dest_part->priv->library = src_part->priv->library;
+	library_unref (dest_part->priv->library);
+	dest_part->priv->library = library_ref (src_part->priv->library);
 	dest_part->priv->name = g_strdup (src_part->priv->name);
 	dest_part->priv->symbol_name = g_strdup (src_part->priv->symbol_name);
 
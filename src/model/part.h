@@ -39,7 +39,6 @@
 #include <gtk/gtk.h>
 
 #include "coords.h"
-#include "clipboard.h"
 #include "load-common.h"
 
 #define TYPE_PART (part_get_type ())
@@ -84,6 +83,8 @@ Part *part_new_from_library_part (LibraryPart *library_part);
 gint part_get_num_pins (Part *part);
 Pin *part_get_pins (Part *part);
 gboolean part_set_pins (Part *part, GSList *connections);
+Library *part_get_library (Part *part);
+gboolean part_rebind_library (Part *part, Library *library);
 gboolean part_get_rotation (Part *part);
 IDFlip part_get_flip (Part *part);
 void part_labels_rotate (Part *part, int rotation);
@@ -92,6 +93,4 @@ char *part_get_property (Part *part, char *name);
 GSList *part_get_properties (Part *part);
 GSList *part_get_labels (Part *part);
 
-ClipboardData *part_clipboard_dup (Part *part);
-
 #endif
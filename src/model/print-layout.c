@@ -0,0 +1,142 @@
+/*
+ * print-layout.c
+ *
+ *
+ * Authors:
+ *  Michi <st101564@stud.uni-stuttgart.de>
+ *
+ * Web page: https://ahoi.io/project/oregano
+ *
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+
+
+#include <math.h>
+
+#include "print-layout.h"
+
+// An empty schematic still gets one (empty) page.
+static void print_layout_set_bounds (PrintLayout *layout, const NodeRect *bounds)
+{
+	layout->bounds = *bounds;
+	if (bounds->x1 < bounds->x0 || bounds->y1 < bounds->y0) {
+		layout->bounds.x0 = layout->bounds.y0 = 0.0;
+		layout->bounds.x1 = layout->bounds.y1 = 0.0;
+	}
+}
+
+/**
+ * Scales the schematic down, or up, to fill a single page.
+ */
+void print_layout_fit (PrintLayout *layout, const NodeRect *bounds, gdouble area_w,
+                       gdouble area_h)
+{
+	gdouble width, height, scale;
+
+	g_return_if_fail (layout != NULL);
+	g_return_if_fail (bounds != NULL);
+
+	print_layout_set_bounds (layout, bounds);
+
+	width = layout->bounds.x1 - layout->bounds.x0;
+	height = layout->bounds.y1 - layout->bounds.y0;
+
+	scale = PRINT_LAYOUT_DEFAULT_SCALE;
+	if (width > 0.0 && height > 0.0)
+		scale = MIN (area_w / width, area_h / height);
+	else if (width > 0.0)
+		scale = area_w / width;
+	else if (height > 0.0)
+		scale = area_h / height;
+
+	layout->scale = scale;
+	layout->tile_w = layout->step_x = area_w / scale;
+	layout->tile_h = layout->step_y = area_h / scale;
+	layout->overlap = 0.0;
+	layout->columns = 1;
+	layout->rows = 1;
+}
+
+static gint print_layout_count_tiles (gdouble length, gdouble tile, gdouble step)
+{
+	if (length <= tile)
+		return 1;
+
+	return 1 + (gint)ceil ((length - tile) / step);
+}
+
+/**
+ * Keeps @scale and uses as many pages as needed. The overlap is limited
+ * to half of a page.
+ */
+void print_layout_tile (PrintLayout *layout, const NodeRect *bounds, gdouble area_w,
+                        gdouble area_h, gdouble scale, gdouble overlap)
+{
+	g_return_if_fail (layout != NULL);
+	g_return_if_fail (bounds != NULL);
+	g_return_if_fail (scale > 0.0);
+
+	print_layout_set_bounds (layout, bounds);
+
+	overlap = CLAMP (overlap, 0.0, MIN (area_w, area_h) / 2.0);
+
+	layout->scale = scale;
+	layout->overlap = overlap;
+	layout->tile_w = area_w / scale;
+	layout->tile_h = area_h / scale;
+	layout->step_x = (area_w - overlap) / scale;
+	layout->step_y = (area_h - overlap) / scale;
+	layout->columns = print_layout_count_tiles (layout->bounds.x1 - layout->bounds.x0,
+	                                            layout->tile_w, layout->step_x);
+	layout->rows = print_layout_count_tiles (layout->bounds.y1 - layout->bounds.y0,
+	                                         layout->tile_h, layout->step_y);
+}
+
+gint print_layout_get_n_pages (const PrintLayout *layout)
+{
+	g_return_val_if_fail (layout != NULL, 0);
+
+	return layout->columns * layout->rows;
+}
+
+/**
+ * The pages go row by row, from the top left to the bottom right.
+ * @tile gets the part of the schematic on the page, in model units.
+ */
+void print_layout_get_tile (const PrintLayout *layout, gint page_nr, gint *column, gint *row,
+                            NodeRect *tile)
+{
+	gint c, r;
+
+	g_return_if_fail (layout != NULL);
+	g_return_if_fail (page_nr >= 0 && page_nr < print_layout_get_n_pages (layout));
+
+	c = page_nr % layout->columns;
+	r = page_nr / layout->columns;
+
+	if (column)
+		*column = c;
+	if (row)
+		*row = r;
+	if (tile) {
+		tile->x0 = layout->bounds.x0 + c * layout->step_x;
+		tile->y0 = layout->bounds.y0 + r * layout->step_y;
+		tile->x1 = tile->x0 + layout->tile_w;
+		tile->y1 = tile->y0 + layout->tile_h;
+	}
+}
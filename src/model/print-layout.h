@@ -0,0 +1,67 @@
+/*
+ * print-layout.h
+ *
+ *
+ * Authors:
+ *  Michi <st101564@stud.uni-stuttgart.de>
+ *
+ * Web page: https://ahoi.io/project/oregano
+ *
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+
+
+#ifndef __PRINT_LAYOUT_H
+#define __PRINT_LAYOUT_H
+
+#include <glib.h>
+
+#include "node-store.h"
+
+// Millimeters per model unit when printing at 100%.
+#define PRINT_LAYOUT_DEFAULT_SCALE 0.4
+
+/**
+ * Splits the bounds of a schematic into the pages of a print out.
+ *
+ * All sizes of the printable area and the overlap are in millimeters,
+ * the tiles and the bounds are in model units. Neighbouring tiles share
+ * a strip of the size of the overlap, so the pages can be glued.
+ */
+typedef struct _PrintLayout
+{
+	NodeRect bounds;
+	// millimeters per model unit
+	gdouble scale;
+	// size of a tile and distance between tiles
+	gdouble tile_w, tile_h;
+	gdouble step_x, step_y;
+	gdouble overlap;
+	gint columns;
+	gint rows;
+} PrintLayout;
+
+void print_layout_fit (PrintLayout *layout, const NodeRect *bounds, gdouble area_w,
+                       gdouble area_h);
+void print_layout_tile (PrintLayout *layout, const NodeRect *bounds, gdouble area_w,
+                        gdouble area_h, gdouble scale, gdouble overlap);
+gint print_layout_get_n_pages (const PrintLayout *layout);
+void print_layout_get_tile (const PrintLayout *layout, gint page_nr, gint *column, gint *row,
+                            NodeRect *tile);
+
+#endif
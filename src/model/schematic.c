@@ -39,6 +39,8 @@
 #include <math.h>
 
 #include "schematic.h"
+#include "edit-journal.h"
+#include "save-journal.h"
 #include "node-store.h"
 #include "file-manager.h"
 #include "settings.h"
@@ -46,7 +48,9 @@
 #include "simulation.h"
 #include "errors.h"
 #include "schematic-print-context.h"
+#include "print-layout.h"
 #include "log.h"
+#include "stall-detector.h"
 
 #include "debug.h"
 typedef struct _SchematicsPrintOptions
@@ -56,6 +60,9 @@ typedef struct _SchematicsPrintOptions
 	GtkColorButton *wires;
 	GtkColorButton *text;
 	GtkColorButton *background;
+	GtkToggleButton *fit;
+	GtkSpinButton *scale;
+	GtkSpinButton *overlap;
 } SchematicPrintOptions;
 
 struct _SchematicPriv
@@ -69,6 +76,11 @@ struct _SchematicPriv
 
 	SchematicColors colors;
 	SchematicPrintOptions *printoptions;
+	// fit on one page, or tiles at print_scale percent
+	gboolean print_fit;
+	gdouble print_scale;
+	gdouble print_overlap;
+	PrintLayout print_layout;
 
 	// Data for various dialogs.
 	gpointer settings;
@@ -76,6 +88,8 @@ struct _SchematicPriv
 	gpointer simulation;
 
 	GList *current_items;
+	EditJournal *journal;
+	SaveJournal *save_journal;
 
 	NodeStore *store;
 	GHashTable *symbols;
@@ -110,10 +124,13 @@ typedef struct
 enum {
 	TITLE_CHANGED,
 	ITEM_DATA_ADDED,
+	ITEM_DATA_REMOVED,
 	LOG_UPDATED,
 	NODE_DOT_ADDED,
 	NODE_DOT_REMOVED,
 	LAST_SCHEMATIC_DESTROYED,
+	CHANGED,
+	JOURNAL_CHANGED,
 	LAST_SIGNAL
 };
 
@@ -125,6 +142,8 @@ static void schematic_finalize (GObject *object);
 static void schematic_dispose (GObject *object);
 static void item_data_destroy_callback (gpointer s, GObject *data);
 static void item_moved_callback (ItemData *data, Coords *pos, Schematic *sm);
+static void item_changed_callback (ItemData *data, Schematic *sm);
+static void wire_deleted_callback (ItemData *data, Schematic *sm);
 
 static int schematic_get_lowest_available_refdes (Schematic *schematic, char *prefix);
 static void schematic_set_lowest_available_refdes (Schematic *schematic, char *prefix, int num);
@@ -157,6 +176,11 @@ static void schematic_class_init (SchematicClass *klass)
 	                  G_STRUCT_OFFSET (SchematicClass, item_data_added), NULL, NULL,
 	                  g_cclosure_marshal_VOID__POINTER, G_TYPE_NONE, 1, G_TYPE_POINTER);
 
+	schematic_signals[ITEM_DATA_REMOVED] =
+	    g_signal_new ("item_data_removed", TYPE_SCHEMATIC, G_SIGNAL_RUN_FIRST,
+	                  G_STRUCT_OFFSET (SchematicClass, item_data_removed), NULL, NULL,
+	                  g_cclosure_marshal_VOID__POINTER, G_TYPE_NONE, 1, G_TYPE_POINTER);
+
 	schematic_signals[NODE_DOT_ADDED] =
 	    g_signal_new ("node_dot_added", TYPE_SCHEMATIC, G_SIGNAL_RUN_FIRST,
 	                  G_STRUCT_OFFSET (SchematicClass, node_dot_added), NULL, NULL,
@@ -172,6 +196,18 @@ static void schematic_class_init (SchematicClass *klass)
 	                  G_STRUCT_OFFSET (SchematicClass, log_updated), NULL, NULL,
 	                  g_cclosure_marshal_VOID__VOID, G_TYPE_NONE, 0);
 
+	// the circuit was edited (an item was added, removed, moved or changed)
+	schematic_signals[CHANGED] =
+	    g_signal_new ("changed", TYPE_SCHEMATIC, G_SIGNAL_RUN_FIRST,
+	                  G_STRUCT_OFFSET (SchematicClass, changed), NULL, NULL,
+	                  g_cclosure_marshal_VOID__VOID, G_TYPE_NONE, 0);
+
+	// something can be undone or redone now, or not anymore
+	schematic_signals[JOURNAL_CHANGED] =
+	    g_signal_new ("journal_changed", TYPE_SCHEMATIC, G_SIGNAL_RUN_FIRST,
+	                  G_STRUCT_OFFSET (SchematicClass, journal_changed), NULL, NULL,
+	                  g_cclosure_marshal_VOID__VOID, G_TYPE_NONE, 0);
+
 	object_class->finalize = schematic_finalize;
 	object_class->dispose = schematic_dispose;
 }
@@ -199,6 +235,9 @@ static void schematic_init (Schematic *schematic)
 	priv = schematic->priv = g_new0 (SchematicPriv, 1);
 
 	priv->printoptions = NULL;
+	priv->print_fit = TRUE;
+	priv->print_scale = 100.0;
+	priv->print_overlap = 10.0;
 	// Colors
 	priv->colors.components.red = 65535;
 	priv->colors.components.green = 0;
@@ -216,6 +255,8 @@ static void schematic_init (Schematic *schematic)
 	priv->symbols = g_hash_table_new (g_str_hash, g_str_equal);
 	priv->refdes_values = g_hash_table_new (g_str_hash, g_str_equal);
 	priv->store = node_store_new ();
+	priv->journal = edit_journal_new (schematic);
+	priv->save_journal = save_journal_new ();
 	priv->dirty = FALSE;
 	priv->logstore = log_new ();
 	priv->log = gtk_text_buffer_new (NULL); // LEGACY
@@ -272,7 +313,18 @@ static void schematic_dispose (GObject *object)
 		g_signal_emit_by_name (schematic, "last_schematic_destroyed", NULL);
 	}
 
-	g_list_free_full (list, g_object_unref);
+	// the journal holds references of removed items
+	edit_journal_free (schematic->priv->journal);
+	schematic->priv->journal = NULL;
+
+	// waits for a rewrite of the file
+	save_journal_free (schematic->priv->save_journal);
+	schematic->priv->save_journal = NULL;
+
+	// the items were added with the reference of their creator, removing
+	// them unregisters them from the store
+	g_list_free_full (schematic->priv->current_items, g_object_unref);
+	schematic->priv->current_items = NULL;
 
 	G_OBJECT_CLASS (parent_class)->dispose (G_OBJECT (schematic));
 }
@@ -291,6 +343,7 @@ static void schematic_finalize (GObject *object)
 		g_free (priv->author);
 		g_free (priv->filename);
 		sim_settings_gui_finalize(priv->sim_settings);
+		g_clear_object (&priv->store);
 		g_free (priv);
 	}
 
@@ -573,6 +626,12 @@ Schematic *schematic_read (const char *name, GError **error)
 		return NULL;
 	}
 
+	// the changes that were saved incrementally
+	if (!save_journal_replay (new_sm->priv->save_journal, new_sm, fname, &e)) {
+		g_warning ("%s", e->message);
+		g_clear_error (&e);
+	}
+
 	schematic_set_dirty (new_sm, FALSE);
 
 	return new_sm;
@@ -593,9 +652,22 @@ gint schematic_save_file (Schematic *sm, GError **error)
 		return FALSE;
 	}
 
+	// only the changes, if that is enough; the journal is compacted into XML
+	if (ft->save_func == schematic_write_xml &&
+	    save_journal_append (sm->priv->save_journal, sm, &e)) {
+		schematic_set_dirty (sm, FALSE);
+		save_journal_compact_if_needed (sm->priv->save_journal, sm);
+		return TRUE;
+	}
+	if (e) {
+		g_warning ("%s", e->message);
+		g_clear_error (&e);
+	}
+
 	if (ft->save_func (sm, &e)) {
 		schematic_set_title (sm, g_path_get_basename (sm->priv->filename));
 		schematic_set_dirty (sm, FALSE);
+		save_journal_reset (sm->priv->save_journal, sm);
 		return TRUE;
 	}
 
@@ -604,22 +676,42 @@ gint schematic_save_file (Schematic *sm, GError **error)
 	return FALSE; // Save fails!
 }
 
+// takes over the reference of the caller
+static void schematic_insert_item (Schematic *sm, ItemData *data)
+{
+	sm->priv->current_items = g_list_prepend (sm->priv->current_items, data);
+	g_object_weak_ref (G_OBJECT (data), item_data_destroy_callback, G_OBJECT (sm));
+
+	// if the item gets moved or changed mark the schematic as dirty
+	g_signal_connect_object (data, "moved", G_CALLBACK (item_moved_callback), sm, 0);
+	g_signal_connect_object (data, "changed", G_CALLBACK (item_changed_callback), sm, 0);
+	// the node store merged the wire into another one
+	if (IS_WIRE (data))
+		g_signal_connect_object (data, "delete", G_CALLBACK (wire_deleted_callback), sm, 0);
+
+	// causes a canvas item (view) to be generated
+	g_signal_emit_by_name (sm, "item_data_added", data);
+
+	schematic_set_dirty (sm, TRUE);
+}
+
 /**
  * \brief add an ItemData object to a Schematic
  *
  * @param sm the schematic the item will be added to
  * @param data fully initilalized ItemData object
+ * @returns FALSE if the item could not be registered and was not added
  */
-void schematic_add_item (Schematic *sm, ItemData *data)
+gboolean schematic_add_item (Schematic *sm, ItemData *data)
 {
 	NodeStore *store;
 	char *prefix = NULL, *refdes = NULL;
 	int num;
 
-	g_return_if_fail (sm);
-	g_return_if_fail (IS_SCHEMATIC (sm));
-	g_return_if_fail (data);
-	g_return_if_fail (IS_ITEM_DATA (data));
+	g_return_val_if_fail (sm, FALSE);
+	g_return_val_if_fail (IS_SCHEMATIC (sm), FALSE);
+	g_return_val_if_fail (data, FALSE);
+	g_return_val_if_fail (IS_ITEM_DATA (data), FALSE);
 
 	store = sm->priv->store;
 	g_assert (store);
@@ -631,7 +723,7 @@ void schematic_add_item (Schematic *sm, ItemData *data)
 	// for parts e.g. this ends up in <node_store_add_part>
 	// which requires a valid position to add the node dots
 	if (item_data_register (data) == -1) {
-		return;
+		return FALSE;
 	}
 
 	// Some items need a reference designator, so get a good one
@@ -646,16 +738,123 @@ void schematic_add_item (Schematic *sm, ItemData *data)
 	g_free (prefix);
 	g_free (refdes);
 
-	sm->priv->current_items = g_list_prepend (sm->priv->current_items, data);
-	g_object_weak_ref (G_OBJECT (data), item_data_destroy_callback, G_OBJECT (sm));
+	schematic_insert_item (sm, data);
+	return TRUE;
+}
 
-	sm->priv->dirty = TRUE;
+/**
+ * \brief add an item again that was removed with schematic_remove_item
+ *
+ * Unlike schematic_add_item the reference designator is kept and the
+ * schematic takes a reference of its own.
+ */
+gboolean schematic_readd_item (Schematic *sm, ItemData *data)
+{
+	g_return_val_if_fail (sm, FALSE);
+	g_return_val_if_fail (IS_SCHEMATIC (sm), FALSE);
+	g_return_val_if_fail (data, FALSE);
+	g_return_val_if_fail (IS_ITEM_DATA (data), FALSE);
 
-	// if the item gets moved mark the schematic as dirty
-	g_signal_connect_object (data, "moved", G_CALLBACK (item_moved_callback), sm, 0);
+	g_object_set (G_OBJECT (data), "store", sm->priv->store, NULL);
+	if (item_data_register (data) == -1)
+		return FALSE;
 
-	// causes a canvas item (view) to be generated
-	g_signal_emit_by_name (sm, "item_data_added", data);
+	schematic_insert_item (sm, g_object_ref (data));
+	return TRUE;
+}
+
+// the item is not part of the node store anymore, @link is its element of current_items
+static void schematic_detach_item (Schematic *sm, GList *link)
+{
+	ItemData *data = link->data;
+
+	sm->priv->current_items = g_list_delete_link (sm->priv->current_items, link);
+	g_object_weak_unref (G_OBJECT (data), item_data_destroy_callback, G_OBJECT (sm));
+	g_signal_handlers_disconnect_by_data (data, sm);
+
+	// causes the canvas item (view) to be destroyed
+	g_signal_emit_by_name (sm, "item_data_removed", data);
+
+	schematic_set_dirty (sm, TRUE);
+	g_object_unref (data);
+}
+
+/**
+ * \brief remove an ItemData object from a Schematic
+ *
+ * The reference of the schematic is dropped, hold one to keep the item.
+ */
+void schematic_remove_item (Schematic *sm, ItemData *data)
+{
+	GList *link;
+
+	g_return_if_fail (sm);
+	g_return_if_fail (IS_SCHEMATIC (sm));
+	g_return_if_fail (data);
+	g_return_if_fail (IS_ITEM_DATA (data));
+
+	link = g_list_find (sm->priv->current_items, data);
+	if (link == NULL)
+		return;
+
+	item_data_unregister (data);
+	schematic_detach_item (sm, link);
+}
+
+static void collect_library_parts (Part *part, gpointer *data)
+{
+	if (part_get_library (part) == data[0])
+		data[1] = g_list_prepend (data[1], part);
+}
+
+/**
+ * \brief bind the parts of a library that was parsed again to the new one
+ *
+ * The parts are removed and added again, so every view draws them anew
+ * from the new symbols. Nothing of the schematic itself changes, so it
+ * does not get dirty and the undo history stays valid.
+ */
+void schematic_rebind_library (Schematic *sm, Library *old_library, Library *new_library)
+{
+	gpointer data[2] = {old_library, NULL};
+	gboolean dirty;
+	GList *iter;
+
+	g_return_if_fail (sm != NULL);
+	g_return_if_fail (IS_SCHEMATIC (sm));
+
+	schematic_parts_foreach (sm, (ForeachItemDataFunc)collect_library_parts, data);
+	if (data[1] == NULL)
+		return;
+
+	dirty = schematic_is_dirty (sm);
+	for (iter = data[1]; iter; iter = iter->next) {
+		Part *part = g_object_ref (iter->data);
+
+		schematic_remove_item (sm, ITEM_DATA (part));
+		if (!part_rebind_library (part, new_library)) {
+			gchar *refdes = part_get_property (part, "refdes");
+			gchar *message = g_strdup_printf (
+			    _ ("The pins of %s changed in the library, place it again to use them.\n"),
+			    refdes);
+			schematic_log_append_error (sm, message);
+			g_free (message);
+			g_free (refdes);
+		}
+		schematic_readd_item (sm, ITEM_DATA (part));
+		g_object_unref (part);
+	}
+	schematic_set_dirty (sm, dirty);
+
+	g_list_free (data[1]);
+}
+
+EditJournal *schematic_get_journal (Schematic *sm)
+{
+	g_return_val_if_fail (sm != NULL, NULL);
+	g_return_val_if_fail (IS_SCHEMATIC (sm), NULL);
+
+	return sm->priv->journal;
 }
 
 void schematic_parts_foreach (Schematic *schematic, ForeachItemDataFunc func, gpointer user_data)
@@ -765,6 +964,8 @@ void schematic_set_dirty (Schematic *sm, gboolean b)
 	g_return_if_fail (IS_SCHEMATIC (sm));
 
 	sm->priv->dirty = b;
+	if (b)
+		g_signal_emit (sm, schematic_signals[CHANGED], 0);
 }
 
 static void item_moved_callback (ItemData *data, Coords *pos, Schematic *sm)
@@ -775,14 +976,22 @@ static void item_moved_callback (ItemData *data, Coords *pos, Schematic *sm)
 	schematic_set_dirty (sm, TRUE);
 }
 
-static void schematic_render (Schematic *sm, cairo_t *cr)
+static void item_changed_callback (ItemData *data, Schematic *sm)
+{
+	g_return_if_fail (data != NULL);
+	g_return_if_fail (IS_ITEM_DATA (data));
+
+	schematic_set_dirty (sm, TRUE);
+}
+
+static void schematic_render (Schematic *sm, cairo_t *cr, NodeRect *rect)
 {
 	NodeStore *store;
 	SchematicPrintContext schematic_print_context;
 	schematic_print_context.colors = sm->priv->colors;
 	store = schematic_get_store (sm);
 
-	node_store_print_items (store, cr, &schematic_print_context);
+	node_store_print_items (store, cr, &schematic_print_context, rect);
 }
 
 GdkRGBA convert_to_grayscale (GdkRGBA *source)
@@ -811,6 +1020,8 @@ void schematic_export (Schematic *sm, const gchar *filename, gint img_w, gint im
 	gdouble scale, scalew, scaleh;
 	SchematicColors colors;
 
+	stall_detector_begin ("schematic_export");
+
 	if (!color) {
 		colors = sm->priv->colors;
 		sm->priv->colors.components = convert_to_grayscale (&sm->priv->colors.components);
@@ -874,7 +1085,7 @@ void schematic_export (Schematic *sm, const gchar *filename, gint img_w, gint im
 	cairo_set_line_width (cr, 0.5);
 
 	// Render...
-	schematic_render (sm, cr);
+	schematic_render (sm, cr, NULL);
 
 	cairo_restore (cr);
 	cairo_show_page (cr);
@@ -889,57 +1100,161 @@ void schematic_export (Schematic *sm, const gchar *filename, gint img_w, gint im
 	if (!color) {
 		sm->priv->colors = colors;
 	}
+
+	stall_detector_end ();
 }
 
-static void draw_rotule (Schematic *sm, cairo_t *cr)
+// Margins of the frame and height of the title block, in millimeters.
+#define PRINT_FRAME_LEFT 20.0
+#define PRINT_FRAME_RIGHT 10.0
+#define PRINT_FRAME_TOP 10.0
+#define PRINT_FRAME_BOTTOM 10.0
+#define PRINT_ROTULE_HEIGHT 30.0
+// Labels may stick out of the bounds of their part.
+#define PRINT_CULL_MARGIN 20.0
+
+static void draw_rotule (Schematic *sm, cairo_t *cr, gint page_nr)
 {
+	PrintLayout *layout = &sm->priv->print_layout;
+	gint column, row;
+	gchar *str;
+
 	cairo_save (cr);
 	cairo_set_source_rgb (cr, 0.0, 0.0, 0.0);
 	cairo_set_line_width (cr, 0.5);
 	cairo_rectangle (cr, 0, 0, 180, 20);
 	cairo_rectangle (cr, 0, 20, 180, 10);
 	cairo_stroke (cr);
+
+	print_layout_get_tile (layout, page_nr, &column, &row, NULL);
+	str = g_strdup_printf (_ ("Page %d of %d, row %d, column %d"), page_nr + 1,
+	                       print_layout_get_n_pages (layout), row + 1, column + 1);
+	cairo_set_font_size (cr, 3.5);
+	cairo_move_to (cr, 2, 27);
+	cairo_show_text (cr, str);
+	g_free (str);
+
+	cairo_restore (cr);
+}
+
+static void print_get_area (GtkPrintContext *context, gdouble *area_w, gdouble *area_h)
+{
+	*area_w = gtk_print_context_get_width (context) - PRINT_FRAME_LEFT - PRINT_FRAME_RIGHT;
+	*area_h = gtk_print_context_get_height (context) - PRINT_FRAME_TOP - PRINT_FRAME_BOTTOM -
+	          PRINT_ROTULE_HEIGHT;
+}
+
+static void begin_print (GtkPrintOperation *operation, GtkPrintContext *context, Schematic *sm)
+{
+	SchematicPriv *priv = sm->priv;
+	NodeRect bbox;
+	gdouble area_w, area_h;
+
+	node_store_get_bounds (schematic_get_store (sm), &bbox);
+	print_get_area (context, &area_w, &area_h);
+
+	if (priv->print_fit)
+		print_layout_fit (&priv->print_layout, &bbox, area_w, area_h);
+	else
+		print_layout_tile (&priv->print_layout, &bbox, area_w, area_h,
+		                   PRINT_LAYOUT_DEFAULT_SCALE * priv->print_scale / 100.0,
+		                   priv->print_overlap);
+
+	gtk_print_operation_set_n_pages (operation, print_layout_get_n_pages (&priv->print_layout));
+}
+
+// Short ticks where the neighbouring pages start, to line them up.
+static void draw_overlap_marks (PrintLayout *layout, cairo_t *cr, gint column, gint row,
+                                gdouble area_w, gdouble area_h)
+{
+	const gdouble tick = 4.0;
+	gdouble x, y;
+
+	if (layout->overlap <= 0.0)
+		return;
+
+	cairo_save (cr);
+	cairo_set_source_rgb (cr, 0.0, 0.0, 0.0);
+	cairo_set_line_width (cr, 0.25);
+	if (column > 0) {
+		x = layout->overlap;
+		cairo_move_to (cr, x, -tick);
+		cairo_line_to (cr, x, 0);
+		cairo_move_to (cr, x, area_h);
+		cairo_line_to (cr, x, area_h + tick);
+	}
+	if (column < layout->columns - 1) {
+		x = area_w - layout->overlap;
+		cairo_move_to (cr, x, -tick);
+		cairo_line_to (cr, x, 0);
+		cairo_move_to (cr, x, area_h);
+		cairo_line_to (cr, x, area_h + tick);
+	}
+	if (row > 0) {
+		y = layout->overlap;
+		cairo_move_to (cr, -tick, y);
+		cairo_line_to (cr, 0, y);
+		cairo_move_to (cr, area_w, y);
+		cairo_line_to (cr, area_w + tick, y);
+	}
+	if (row < layout->rows - 1) {
+		y = area_h - layout->overlap;
+		cairo_move_to (cr, -tick, y);
+		cairo_line_to (cr, 0, y);
+		cairo_move_to (cr, area_w, y);
+		cairo_line_to (cr, area_w + tick, y);
+	}
+	cairo_stroke (cr);
 	cairo_restore (cr);
 }
 
 static void draw_page (GtkPrintOperation *operation, GtkPrintContext *context, int page_nr,
                        Schematic *sm)
 {
-	NodeStore *store;
-	NodeRect bbox;
-	gdouble page_w, page_h;
+	PrintLayout *layout = &sm->priv->print_layout;
+	NodeRect tile, cull;
+	gdouble page_w, page_h, area_w, area_h;
+	gint column, row;
 
 	page_w = gtk_print_context_get_width (context);
 	page_h = gtk_print_context_get_height (context);
+	print_get_area (context, &area_w, &area_h);
 
 	cairo_t *cr = gtk_print_context_get_cairo_context (context);
 
-	// Draw a red rectangle, as wide as the paper (inside the margins)
+	// Draw a rectangle, as wide as the paper (inside the margins)
 	cairo_save (cr);
 	cairo_set_source_rgb (cr, 0.0, 0.0, 0.0);
 	cairo_set_line_width (cr, 0.5);
-	cairo_rectangle (cr, 20, 10, page_w - 30, page_h - 20);
+	cairo_rectangle (cr, PRINT_FRAME_LEFT, PRINT_FRAME_TOP,
+	                 page_w - PRINT_FRAME_LEFT - PRINT_FRAME_RIGHT,
+	                 page_h - PRINT_FRAME_TOP - PRINT_FRAME_BOTTOM);
 	cairo_stroke (cr);
 	cairo_restore (cr);
 
 	cairo_save (cr);
 	cairo_translate (cr, page_w - 190, page_h - 40);
-	draw_rotule (sm, cr);
+	draw_rotule (sm, cr, page_nr);
 	cairo_restore (cr);
 
-	store = schematic_get_store (sm);
-
-	node_store_get_bounds (store, &bbox);
+	print_layout_get_tile (layout, page_nr, &column, &row, &tile);
 
 	cairo_save (cr);
+	cairo_translate (cr, PRINT_FRAME_LEFT, PRINT_FRAME_TOP);
+	draw_overlap_marks (layout, cr, column, row, area_w, area_h);
+
+	cairo_rectangle (cr, 0, 0, area_w, area_h);
+	cairo_clip (cr);
 	cairo_set_line_width (cr, 0.5);
 	cairo_set_source_rgb (cr, 0, 0, 0);
-	cairo_translate (cr, page_w * 0.1, page_h * 0.1);
-	// 0.4 is the convert factor between Model unit and
-	// milimeters, unit used in printing
-	cairo_scale (cr, 0.4, 0.4);
-	cairo_translate (cr, -bbox.x0, -bbox.y0);
-	schematic_render (sm, cr);
+	cairo_scale (cr, layout->scale, layout->scale);
+	cairo_translate (cr, -tile.x0, -tile.y0);
+
+	cull.x0 = tile.x0 - PRINT_CULL_MARGIN;
+	cull.y0 = tile.y0 - PRINT_CULL_MARGIN;
+	cull.x1 = tile.x1 + PRINT_CULL_MARGIN;
+	cull.y1 = tile.y1 + PRINT_CULL_MARGIN;
+	schematic_render (sm, cr, &cull);
 	cairo_restore (cr);
 }
 
@@ -969,6 +1284,16 @@ static GObject *print_options (GtkPrintOperation *operation, Schematic *sm)
 	sm->priv->printoptions->text = GTK_COLOR_BUTTON (gtk_builder_get_object (gui, "color_text"));
 	sm->priv->printoptions->background =
 	    GTK_COLOR_BUTTON (gtk_builder_get_object (gui, "color_background"));
+	sm->priv->printoptions->fit = GTK_TOGGLE_BUTTON (gtk_builder_get_object (gui, "page_fit"));
+	sm->priv->printoptions->scale = GTK_SPIN_BUTTON (gtk_builder_get_object (gui, "page_scale"));
+	sm->priv->printoptions->overlap =
+	    GTK_SPIN_BUTTON (gtk_builder_get_object (gui, "page_overlap"));
+
+	gtk_toggle_button_set_active (GTK_TOGGLE_BUTTON (gtk_builder_get_object (gui, "page_tile")),
+	                              !sm->priv->print_fit);
+	gtk_toggle_button_set_active (sm->priv->printoptions->fit, sm->priv->print_fit);
+	gtk_spin_button_set_value (sm->priv->printoptions->scale, sm->priv->print_scale);
+	gtk_spin_button_set_value (sm->priv->printoptions->overlap, sm->priv->print_overlap);
 
 	// Set default colors
 	gtk_color_chooser_set_rgba (
@@ -999,6 +1324,10 @@ static void read_print_options (GtkPrintOperation *operation, GtkWidget *widget,
 	gtk_color_chooser_get_rgba (GTK_COLOR_CHOOSER (colors->background),
 	                            &sm->priv->colors.background);
 
+	sm->priv->print_fit = gtk_toggle_button_get_active (colors->fit);
+	sm->priv->print_scale = gtk_spin_button_get_value (colors->scale);
+	sm->priv->print_overlap = gtk_spin_button_get_value (colors->overlap);
+
 	g_free (sm->priv->printoptions);
 	sm->priv->printoptions = NULL;
 }
@@ -1013,12 +1342,12 @@ void schematic_print (Schematic *sm, GtkPageSetup *page, GtkPrintSettings *setti
 
 	gtk_print_operation_set_print_settings (op, settings);
 	gtk_print_operation_set_default_page_setup (op, page);
-	gtk_print_operation_set_n_pages (op, 1);
 	gtk_print_operation_set_unit (op, GTK_UNIT_MM);
 	gtk_print_operation_set_use_full_page (op, TRUE);
 
 	g_signal_connect (op, "create-custom-widget", G_CALLBACK (print_options), sm);
 	g_signal_connect (op, "custom-widget-apply", G_CALLBACK (read_print_options), sm);
+	g_signal_connect (op, "begin-print", G_CALLBACK (begin_print), sm);
 	g_signal_connect (op, "draw_page", G_CALLBACK (draw_page), sm);
 
 	gtk_print_operation_set_custom_tab_label (op, _ ("Schematic"));
@@ -1031,3 +1360,16 @@ void schematic_print (Schematic *sm, GtkPageSetup *page, GtkPrintSettings *setti
 	if (res == GTK_PRINT_OPERATION_RESULT_CANCEL) {
 	}
 }
+
+/**
+ * The node store merged the wire into an overlapping one and removed it
+ * already. The journaled edits do not match the wires anymore.
+ */
+static void wire_deleted_callback (ItemData *data, Schematic *sm)
+{
+	GList *link = g_list_find (sm->priv->current_items, data);
+
+	if (link != NULL)
+		schematic_detach_item (sm, link);
+	edit_journal_clear (sm->priv->journal);
+}
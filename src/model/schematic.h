@@ -35,6 +35,7 @@
 
 // typedefing before including makes circular dependencies possible.
 typedef struct _Schematic Schematic;
+typedef struct _EditJournal EditJournal;
 
 #include <gtk/gtk.h>
 #include <cairo/cairo.h>
@@ -82,10 +83,13 @@ struct _SchematicClass
 	// signals
 	void (*title_changed)(Schematic *, gchar *);
 	void (*item_data_added)(Schematic *, gpointer *);
+	void (*item_data_removed)(Schematic *, gpointer *);
 	void (*log_updated)(gpointer);
 	void (*node_dot_added)(Schematic *);
 	void (*node_dot_removed)(Schematic *, gpointer *);
 	void (*last_schematic_destroyed)(Schematic *);
+	void (*changed)(Schematic *);
+	void (*journal_changed)(Schematic *);
 };
 
 GType schematic_get_type (void);
@@ -105,7 +109,11 @@ void schematic_set_netlist_filename (Schematic *schematic, char *filename);
 int schematic_count (void);
 double schematic_get_zoom (Schematic *schematic);
 void schematic_set_zoom (Schematic *schematic, double zoom);
-void schematic_add_item (Schematic *sm, ItemData *data);
+gboolean schematic_add_item (Schematic *sm, ItemData *data);
+gboolean schematic_readd_item (Schematic *sm, ItemData *data);
+void schematic_remove_item (Schematic *sm, ItemData *data);
+void schematic_rebind_library (Schematic *sm, Library *old_library, Library *new_library);
+EditJournal *schematic_get_journal (Schematic *sm);
 void schematic_parts_foreach (Schematic *schematic, ForeachItemDataFunc func, gpointer user_data);
 void schematic_wires_foreach (Schematic *schematic, ForeachItemDataFunc func, gpointer user_data);
 void schematic_items_foreach (Schematic *schematic, ForeachItemDataFunc func, gpointer user_data);
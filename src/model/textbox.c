@@ -34,7 +34,6 @@
 #include <goocanvas.h>
 
 #include "textbox.h"
-#include "clipboard.h"
 #include "node-store.h"
 #include "schematic-print-context.h"
 
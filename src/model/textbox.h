@@ -35,7 +35,6 @@
 
 #include <gtk/gtk.h>
 
-#include "clipboard.h"
 #include "item-data.h"
 
 #define TYPE_TEXTBOX (textbox_get_type ())
@@ -39,7 +39,6 @@
 #include "node.h"
 #include "wire.h"
 #include "wire-private.h"
-#include "clipboard.h"
 #include "schematic-print-context.h"
 #include "oregano-utils.h"
 
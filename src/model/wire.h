@@ -38,7 +38,6 @@
 #include <gtk/gtk.h>
 
 #include "coords.h"
-#include "clipboard.h"
 
 #define TYPE_WIRE (wire_get_type ())
 #define WIRE(obj) (G_TYPE_CHECK_INSTANCE_CAST ((obj), TYPE_WIRE, Wire))
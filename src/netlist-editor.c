@@ -31,6 +31,7 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <glib/gi18n.h>
 #include <glib.h>
 #include <gtk/gtk.h>
@@ -40,6 +41,7 @@
 
 #include "netlist-editor.h"
 #include "netlist-helper.h"
+#include "netlist-pager.h"
 #include "simulation.h"
 #include "file.h"
 #include "dialogs.h"
@@ -55,6 +57,12 @@ void netlist_editor_init (NetlistEditor *nle);
 
 static GObjectClass *parent_class = NULL;
 
+// larger netlists are shown a page at a time and can not be edited
+#define NETLIST_EDITOR_PAGED_SIZE (4 * 1024 * 1024)
+#define NETLIST_EDITOR_PAGE_LINES 5000
+// lines copied out of the buffer at once when saving
+#define NETLIST_EDITOR_SAVE_LINES 4096
+
 struct _NetlistEditorPriv
 {
 	SchematicView *sv;
@@ -63,7 +71,17 @@ struct _NetlistEditorPriv
 	GtkTextView *view;
 	GtkSourceBuffer *buffer;
 	GtkWindow *toplevel;
-	GtkButton *save, *close;
+	GtkButton *save, *close, *simulate;
+	GtkWidget *prev_page, *next_page;
+	GtkLabel *page_label;
+
+	// the paged view, NULL if the whole netlist is in the buffer
+	NetlistPager *pager;
+	guint64 first_line;
+	// the page was not UTF-8 and had to be converted
+	gboolean page_converted;
+	// where the next search in the file starts
+	gsize search_offset;
 };
 
 static void netlist_editor_class_init (NetlistEditorClass *klass)
@@ -84,9 +102,14 @@ static void netlist_editor_finalize (GObject *object)
 	if (nle->priv) {
 		// kill the priv struct
 		if (nle->priv->toplevel) {
+			g_signal_handlers_disconnect_by_data (nle->priv->toplevel, nle);
 			gtk_widget_destroy (GTK_WIDGET (nle->priv->toplevel));
 			nle->priv->toplevel = NULL;
 		}
+		if (nle->priv->sv)
+			g_object_remove_weak_pointer (G_OBJECT (nle->priv->sv),
+			                              (gpointer *)&nle->priv->sv);
+		netlist_pager_free (nle->priv->pager);
 		g_free (nle->priv);
 	}
 
@@ -118,38 +141,264 @@ GType netlist_editor_get_type (void)
 	return netlist_editor_type;
 }
 
+/*
+ * Writes the buffer a few lines at a time instead of copying all of it,
+ * the paged view writes the file it shows.
+ */
+static gboolean netlist_editor_write (NetlistEditor *nle, const gchar *filename, GError **error)
+{
+	GtkTextBuffer *buffer = GTK_TEXT_BUFFER (nle->priv->buffer);
+	GFile *file;
+	GFileOutputStream *stream;
+	GtkTextIter start, end;
+	gboolean success = TRUE;
+
+	if (nle->priv->pager) {
+		GBytes *bytes = netlist_pager_get_bytes (nle->priv->pager);
+		gsize size;
+		const gchar *data = g_bytes_get_data (bytes, &size);
+
+		success = g_file_set_contents (filename, data, size, error);
+		g_bytes_unref (bytes);
+		return success;
+	}
+
+	file = g_file_new_for_path (filename);
+	stream = g_file_replace (file, NULL, FALSE, G_FILE_CREATE_NONE, NULL, error);
+	g_object_unref (file);
+	if (stream == NULL)
+		return FALSE;
+
+	gtk_text_buffer_get_start_iter (buffer, &start);
+	while (success && !gtk_text_iter_is_end (&start)) {
+		gchar *text;
+
+		end = start;
+		gtk_text_iter_forward_lines (&end, NETLIST_EDITOR_SAVE_LINES);
+		text = gtk_text_buffer_get_text (buffer, &start, &end, FALSE);
+		success = g_output_stream_write_all (G_OUTPUT_STREAM (stream), text, strlen (text), NULL,
+		                                     NULL, error);
+		g_free (text);
+		start = end;
+	}
+
+	// an error on close discards the new file
+	if (success)
+		success = g_output_stream_close (G_OUTPUT_STREAM (stream), NULL, error);
+	g_object_unref (stream);
+	return success;
+}
+
 void netlist_editor_save (GtkWidget *widget, NetlistEditor *nle)
 {
 	char *name;
+	GError *e = NULL;
 
 	name = dialog_netlist_file ((SchematicView *)NULL);
+	if (name == NULL)
+		return;
+
+	if (!netlist_editor_write (nle, name, &e)) {
+		gchar *msg;
+		msg = g_strdup_printf (_ ("The file %s could not be saved: %s"), name, e->message);
+		oregano_error_with_title (_ ("Could not save the netlist file"), msg);
+		g_free (msg);
+		g_clear_error (&e);
+	}
+	g_free (name);
+}
+
+static void netlist_editor_simulate (GtkWidget *widget, NetlistEditor *nle)
+{
+	GBytes *netlist;
 
-	if (name != NULL) {
-		GtkTextView *tview;
-		GtkTextBuffer *buffer;
+	if (nle->priv->sv == NULL)
+		return;
+
+	if (nle->priv->pager) {
+		netlist = netlist_pager_get_bytes (nle->priv->pager);
+	} else {
+		GtkTextBuffer *buffer = GTK_TEXT_BUFFER (nle->priv->buffer);
 		GtkTextIter start, end;
-		FILE *fp;
+		gchar *text;
 
-		tview = nle->priv->view;
-		buffer = gtk_text_view_get_buffer (tview);
+		gtk_text_buffer_get_bounds (buffer, &start, &end);
+		text = gtk_text_buffer_get_text (buffer, &start, &end, FALSE);
+		netlist = g_bytes_new_take (text, strlen (text));
+	}
 
-		gtk_text_buffer_get_start_iter (buffer, &start);
-		gtk_text_buffer_get_end_iter (buffer, &end);
+	simulation_run_netlist (nle->priv->sv, netlist);
+	g_bytes_unref (netlist);
+}
 
-		fp = fopen (name, "wt");
-		if (!fp) {
-			gchar *msg;
-			msg = g_strdup_printf (_ ("The file %s could not be saved"), name);
-			oregano_error_with_title (_ ("Could not save temporary netlist file"), msg);
-			g_free (msg);
-			return;
-		}
+/*
+ * Text buffers only take UTF-8, netlists that are not are most likely
+ * Latin-1.
+ *
+ * Returns: TRUE if the text had to be converted
+ */
+static gboolean netlist_editor_set_text (GtkSourceBuffer *buffer, const gchar *text, gsize length)
+{
+	gchar *converted = NULL;
 
-		fputs (gtk_text_buffer_get_text (buffer, &start, &end, FALSE), fp);
-		fclose (fp);
+	if (!g_utf8_validate (text, length, NULL)) {
+		converted = g_convert (text, length, "UTF-8", "ISO-8859-1", NULL, &length, NULL);
+		text = converted ? converted : "";
+		length = converted ? length : 0;
+	}
+
+	gtk_source_buffer_begin_not_undoable_action (buffer);
+	gtk_text_buffer_set_text (GTK_TEXT_BUFFER (buffer), text, length);
+	gtk_source_buffer_end_not_undoable_action (buffer);
 
-		g_free (name);
+	g_free (converted);
+	return converted != NULL;
+}
+
+static void netlist_editor_show_page (NetlistEditor *nle, guint64 line)
+{
+	NetlistEditorPriv *priv = nle->priv;
+	guint64 n_lines = netlist_pager_get_n_lines (priv->pager);
+	guint64 last;
+	const gchar *text;
+	gsize length;
+	gchar *label;
+
+	priv->first_line = line - line % NETLIST_EDITOR_PAGE_LINES;
+	text = netlist_pager_get_lines (priv->pager, priv->first_line, NETLIST_EDITOR_PAGE_LINES,
+	                                &length);
+	priv->page_converted = netlist_editor_set_text (priv->buffer, text, length);
+
+	last = MIN (priv->first_line + NETLIST_EDITOR_PAGE_LINES, n_lines);
+	label = g_strdup_printf (_ ("Lines %" G_GUINT64_FORMAT " to %" G_GUINT64_FORMAT
+	                            " of %" G_GUINT64_FORMAT),
+	                         MIN (priv->first_line + 1, last), last, n_lines);
+	gtk_label_set_text (priv->page_label, label);
+	g_free (label);
+
+	gtk_widget_set_sensitive (priv->prev_page, priv->first_line > 0);
+	gtk_widget_set_sensitive (priv->next_page, last < n_lines);
+}
+
+static void netlist_editor_prev_page (GtkWidget *widget, NetlistEditor *nle)
+{
+	NetlistEditorPriv *priv = nle->priv;
+
+	if (priv->first_line < NETLIST_EDITOR_PAGE_LINES)
+		return;
+	netlist_editor_show_page (nle, priv->first_line - NETLIST_EDITOR_PAGE_LINES);
+	priv->search_offset = netlist_pager_get_line_offset (priv->pager, priv->first_line);
+}
+
+static void netlist_editor_next_page (GtkWidget *widget, NetlistEditor *nle)
+{
+	NetlistEditorPriv *priv = nle->priv;
+
+	if (priv->first_line + NETLIST_EDITOR_PAGE_LINES >= netlist_pager_get_n_lines (priv->pager))
+		return;
+	netlist_editor_show_page (nle, priv->first_line + NETLIST_EDITOR_PAGE_LINES);
+	priv->search_offset = netlist_pager_get_line_offset (priv->pager, priv->first_line);
+}
+
+/*
+ * The pager searches the mapped file, the page with the match is
+ * loaded into the buffer afterwards.
+ */
+static gboolean netlist_editor_search_pager (NetlistEditor *nle, const gchar *needle,
+                                             GtkTextIter *start, GtkTextIter *end)
+{
+	NetlistEditorPriv *priv = nle->priv;
+	GtkTextBuffer *buffer = GTK_TEXT_BUFFER (priv->buffer);
+	gsize match, index;
+	guint64 line;
+
+	// wraps around at the end
+	if (!netlist_pager_find (priv->pager, needle, priv->search_offset, &match) &&
+	    !netlist_pager_find (priv->pager, needle, 0, &match))
+		return FALSE;
+	priv->search_offset = match + 1;
+
+	line = netlist_pager_get_line_at (priv->pager, match);
+	if (line < priv->first_line || line >= priv->first_line + NETLIST_EDITOR_PAGE_LINES)
+		netlist_editor_show_page (nle, line);
+
+	// byte offsets do not hold after a conversion, the line has to do then
+	if (priv->page_converted) {
+		gtk_text_buffer_get_iter_at_line (buffer, start, line - priv->first_line);
+		*end = *start;
+		return TRUE;
+	}
+
+	// a match never spans lines and starts and ends at characters
+	index = match - netlist_pager_get_line_offset (priv->pager, line);
+	gtk_text_buffer_get_iter_at_line_index (buffer, start, line - priv->first_line, index);
+	gtk_text_buffer_get_iter_at_line_index (buffer, end, line - priv->first_line,
+	                                        index + strlen (needle));
+	return TRUE;
+}
+
+static gboolean netlist_editor_search_buffer (NetlistEditor *nle, const gchar *needle,
+                                              GtkTextIter *start, GtkTextIter *end)
+{
+	GtkTextBuffer *buffer = GTK_TEXT_BUFFER (nle->priv->buffer);
+	GtkTextIter selection, from;
+
+	// after the current match, wraps around at the end
+	gtk_text_buffer_get_selection_bounds (buffer, &selection, &from);
+	if (gtk_text_iter_forward_search (&from, needle, GTK_TEXT_SEARCH_CASE_INSENSITIVE, start,
+	                                  end, NULL))
+		return TRUE;
+
+	gtk_text_buffer_get_start_iter (buffer, &from);
+	return gtk_text_iter_forward_search (&from, needle, GTK_TEXT_SEARCH_CASE_INSENSITIVE, start,
+	                                     end, NULL);
+}
+
+static void netlist_editor_search (GtkEntry *entry, NetlistEditor *nle)
+{
+	GtkTextBuffer *buffer = GTK_TEXT_BUFFER (nle->priv->buffer);
+	const gchar *needle = gtk_entry_get_text (entry);
+	GtkTextIter start, end;
+	gboolean found;
+
+	if (*needle == '\0')
+		return;
+
+	if (nle->priv->pager)
+		found = netlist_editor_search_pager (nle, needle, &start, &end);
+	else
+		found = netlist_editor_search_buffer (nle, needle, &start, &end);
+
+	if (!found) {
+		gtk_widget_error_bell (GTK_WIDGET (entry));
+		return;
 	}
+
+	gtk_text_buffer_select_range (buffer, &start, &end);
+	gtk_text_view_scroll_to_mark (nle->priv->view, gtk_text_buffer_get_insert (buffer), 0.1,
+	                              FALSE, 0.0, 0.0);
+}
+
+static void netlist_editor_set_pager (NetlistEditor *nle, NetlistPager *pager)
+{
+	NetlistEditorPriv *priv = nle->priv;
+
+	priv->pager = pager;
+	priv->search_offset = 0;
+
+	gtk_text_view_set_editable (priv->view, FALSE);
+	gtk_window_set_title (priv->toplevel, _ ("Net List Viewer (read only)"));
+	gtk_widget_show (priv->prev_page);
+	gtk_widget_show (priv->next_page);
+	gtk_widget_show (GTK_WIDGET (priv->page_label));
+
+	netlist_editor_show_page (nle, 0);
+}
+
+static void netlist_editor_destroy_cb (GtkWidget *widget, NetlistEditor *nle)
+{
+	nle->priv->toplevel = NULL;
+	g_object_unref (nle);
 }
 
 // This method append OREGANO_LANGDIR directory where the netlist.lang file
@@ -194,7 +443,7 @@ NetlistEditor *netlist_editor_new (GtkSourceBuffer *textbuffer)
 	GtkScrolledWindow *scroll;
 	GtkSourceView *source_view;
 	GtkSourceLanguageManager *lm;
-	GtkButton *save, *close;
+	GtkButton *save, *close, *simulate;
 	GtkSourceLanguage *lang = NULL;
 
 	if (!textbuffer)
@@ -248,11 +497,27 @@ NetlistEditor *netlist_editor_new (GtkSourceBuffer *textbuffer)
 
 	gtk_container_add (GTK_CONTAINER (scroll), GTK_WIDGET (source_view));
 
+	// the editor lives as long as its window
+	g_signal_connect (G_OBJECT (toplevel), "destroy", G_CALLBACK (netlist_editor_destroy_cb), nle);
 	close = GTK_BUTTON (gtk_builder_get_object (gui, "btn_close"));
-	g_signal_connect_swapped (G_OBJECT (close), "clicked", G_CALLBACK (g_object_unref),
-	                          G_OBJECT (nle));
+	g_signal_connect_swapped (G_OBJECT (close), "clicked", G_CALLBACK (gtk_widget_destroy),
+	                          toplevel);
 	save = GTK_BUTTON (gtk_builder_get_object (gui, "btn_save"));
 	g_signal_connect (G_OBJECT (save), "clicked", G_CALLBACK (netlist_editor_save), nle);
+	// needs the schematic for the simulation settings
+	simulate = GTK_BUTTON (gtk_builder_get_object (gui, "btn_simulate"));
+	gtk_widget_set_sensitive (GTK_WIDGET (simulate), FALSE);
+	g_signal_connect (G_OBJECT (simulate), "clicked", G_CALLBACK (netlist_editor_simulate), nle);
+
+	g_signal_connect (gtk_builder_get_object (gui, "search_entry"), "activate",
+	                  G_CALLBACK (netlist_editor_search), nle);
+	nle->priv->prev_page = GTK_WIDGET (gtk_builder_get_object (gui, "btn_prev_page"));
+	g_signal_connect (G_OBJECT (nle->priv->prev_page), "clicked",
+	                  G_CALLBACK (netlist_editor_prev_page), nle);
+	nle->priv->next_page = GTK_WIDGET (gtk_builder_get_object (gui, "btn_next_page"));
+	g_signal_connect (G_OBJECT (nle->priv->next_page), "clicked",
+	                  G_CALLBACK (netlist_editor_next_page), nle);
+	nle->priv->page_label = GTK_LABEL (gtk_builder_get_object (gui, "page_label"));
 
 	//  Set tab, fonts, wrap mode, colors, etc. according
 	//  to preferences
@@ -260,6 +525,7 @@ NetlistEditor *netlist_editor_new (GtkSourceBuffer *textbuffer)
 	nle->priv->toplevel = GTK_WINDOW (toplevel);
 	nle->priv->save = save;
 	nle->priv->close = close;
+	nle->priv->simulate = simulate;
 	nle->priv->buffer = textbuffer;
 
 	gtk_widget_show_all (GTK_WIDGET (toplevel));
@@ -270,8 +536,7 @@ NetlistEditor *netlist_editor_new (GtkSourceBuffer *textbuffer)
 NetlistEditor *netlist_editor_new_from_file (gchar *filename)
 {
 	GtkSourceBuffer *buffer;
-	gchar *content;
-	gsize length;
+	NetlistPager *pager;
 	GError *error = NULL;
 	NetlistEditor *editor;
 
@@ -286,11 +551,30 @@ NetlistEditor *netlist_editor_new_from_file (gchar *filename)
 		return NULL;
 	}
 
+	pager = netlist_pager_new (filename, &error);
+	if (pager == NULL) {
+		oregano_error_with_title (_ ("Could not read the netlist file"), error->message);
+		g_clear_error (&error);
+		return NULL;
+	}
+
 	buffer = gtk_source_buffer_new (NULL);
-	g_file_get_contents (filename, &content, &length, &error);
-	gtk_text_buffer_set_text (GTK_TEXT_BUFFER (buffer), content, -1);
+	if (netlist_pager_get_size (pager) < NETLIST_EDITOR_PAGED_SIZE) {
+		gsize length;
+		const gchar *text = netlist_pager_get_lines (pager, 0, G_MAXUINT64, &length);
+
+		netlist_editor_set_text (buffer, text, length);
+		g_clear_pointer (&pager, netlist_pager_free);
+	}
 
 	editor = netlist_editor_new (buffer);
+	// the view keeps it
+	g_object_unref (buffer);
+
+	if (editor && pager)
+		netlist_editor_set_pager (editor, pager);
+	else
+		netlist_pager_free (pager);
 
 	return editor;
 }
@@ -334,6 +618,8 @@ NetlistEditor *netlist_editor_new_from_schematic_view (SchematicView *sv)
 	editor = netlist_editor_new_from_file (name);
 	if (editor) {
 		editor->priv->sv = sv;
+		g_object_add_weak_pointer (G_OBJECT (sv), (gpointer *)&editor->priv->sv);
+		gtk_widget_set_sensitive (GTK_WIDGET (editor->priv->simulate), TRUE);
 	}
 
 	return editor;
@@ -0,0 +1,199 @@
+/*
+ * netlist-pager.c
+ *
+ *
+ * Authors:
+ *  Michi <st101564@stud.uni-stuttgart.de>
+ *
+ * Web page: https://ahoi.io/project/oregano
+ *
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+
+#include <string.h>
+#include <glib.h>
+
+#include "netlist-pager.h"
+
+struct _NetlistPager
+{
+	GMappedFile *file;
+	const gchar *data;
+	gsize size;
+	guint64 n_lines;
+	// offset of every NETLIST_PAGER_INDEX_STRIDE-th line, gsize
+	GArray *index;
+};
+
+NetlistPager *netlist_pager_new (const gchar *filename, GError **error)
+{
+	GMappedFile *file;
+	NetlistPager *pager;
+	const gchar *p, *end;
+	gsize offset = 0;
+
+	file = g_mapped_file_new (filename, FALSE, error);
+	if (file == NULL)
+		return NULL;
+
+	pager = g_new0 (NetlistPager, 1);
+	pager->file = file;
+	pager->size = g_mapped_file_get_length (file);
+	pager->data = pager->size > 0 ? g_mapped_file_get_contents (file) : "";
+	pager->index = g_array_new (FALSE, FALSE, sizeof(gsize));
+
+	p = pager->data;
+	end = pager->data + pager->size;
+	g_array_append_val (pager->index, offset);
+	while (p < end) {
+		const gchar *nl = memchr (p, '\n', end - p);
+
+		// the last line does not need a line break
+		p = nl != NULL ? nl + 1 : end;
+		pager->n_lines++;
+		if (pager->n_lines % NETLIST_PAGER_INDEX_STRIDE == 0) {
+			offset = p - pager->data;
+			g_array_append_val (pager->index, offset);
+		}
+	}
+
+	return pager;
+}
+
+void netlist_pager_free (NetlistPager *pager)
+{
+	if (pager == NULL)
+		return;
+
+	g_array_free (pager->index, TRUE);
+	g_mapped_file_unref (pager->file);
+	g_free (pager);
+}
+
+gsize netlist_pager_get_size (const NetlistPager *pager) { return pager->size; }
+
+guint64 netlist_pager_get_n_lines (const NetlistPager *pager) { return pager->n_lines; }
+
+GBytes *netlist_pager_get_bytes (const NetlistPager *pager)
+{
+	return g_mapped_file_get_bytes (pager->file);
+}
+
+gsize netlist_pager_get_line_offset (const NetlistPager *pager, guint64 line)
+{
+	gsize offset;
+	guint64 i;
+
+	if (line >= pager->n_lines)
+		return pager->size;
+
+	offset = g_array_index (pager->index, gsize, line / NETLIST_PAGER_INDEX_STRIDE);
+	// every line before the last one ends with a line break
+	for (i = line % NETLIST_PAGER_INDEX_STRIDE; i > 0; i--) {
+		const gchar *nl = memchr (pager->data + offset, '\n', pager->size - offset);
+		offset = nl + 1 - pager->data;
+	}
+	return offset;
+}
+
+guint64 netlist_pager_get_line_at (const NetlistPager *pager, gsize offset)
+{
+	guint lo = 0, hi = pager->index->len;
+	const gchar *p, *end;
+	guint64 line;
+
+	offset = MIN (offset, pager->size);
+
+	// the last indexed line that starts at or before offset
+	while (hi - lo > 1) {
+		guint mid = lo + (hi - lo) / 2;
+		if (g_array_index (pager->index, gsize, mid) <= offset)
+			lo = mid;
+		else
+			hi = mid;
+	}
+
+	line = (guint64)lo * NETLIST_PAGER_INDEX_STRIDE;
+	p = pager->data + g_array_index (pager->index, gsize, lo);
+	end = pager->data + offset;
+	while (p < end && (p = memchr (p, '\n', end - p)) != NULL) {
+		line++;
+		p++;
+	}
+	return line;
+}
+
+const gchar *netlist_pager_get_lines (const NetlistPager *pager, guint64 first, guint64 n_lines,
+                                     gsize *length)
+{
+	gsize start, end;
+
+	first = MIN (first, pager->n_lines);
+	n_lines = MIN (n_lines, pager->n_lines - first);
+
+	start = netlist_pager_get_line_offset (pager, first);
+	end = netlist_pager_get_line_offset (pager, first + n_lines);
+
+	*length = end - start;
+	return pager->data + start;
+}
+
+gboolean netlist_pager_find (const NetlistPager *pager, const gchar *needle, gsize offset,
+                             gsize *match)
+{
+	gsize length = strlen (needle);
+	gchar lower, upper;
+	const gchar *p, *last, *next_lower = NULL, *next_upper = NULL;
+
+	if (length == 0 || length > pager->size || offset > pager->size - length)
+		return FALSE;
+
+	lower = g_ascii_tolower (needle[0]);
+	upper = g_ascii_toupper (needle[0]);
+	p = pager->data + offset;
+	last = pager->data + pager->size - length;
+
+	/*
+	 * memchr does the scanning for both cases of the first character,
+	 * the position of each one is only looked up again once it is passed.
+	 */
+	while (p <= last) {
+		if (next_lower == NULL || next_lower < p) {
+			next_lower = memchr (p, lower, last - p + 1);
+			if (next_lower == NULL)
+				next_lower = last + 1;
+		}
+		if (upper == lower) {
+			next_upper = next_lower;
+		} else if (next_upper == NULL || next_upper < p) {
+			next_upper = memchr (p, upper, last - p + 1);
+			if (next_upper == NULL)
+				next_upper = last + 1;
+		}
+
+		p = MIN (next_lower, next_upper);
+		if (p > last)
+			break;
+		if (g_ascii_strncasecmp (p + 1, needle + 1, length - 1) == 0) {
+			*match = p - pager->data;
+			return TRUE;
+		}
+		p++;
+	}
+	return FALSE;
+}
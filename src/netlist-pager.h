@@ -0,0 +1,75 @@
+/*
+ * netlist-pager.h
+ *
+ *
+ * Authors:
+ *  Michi <st101564@stud.uni-stuttgart.de>
+ *
+ * Web page: https://ahoi.io/project/oregano
+ *
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+
+#ifndef NETLIST_PAGER_H_
+#define NETLIST_PAGER_H_
+
+#include <glib.h>
+
+/**
+ * Read only access to a netlist file that is too large for a text
+ * buffer, for the paged view of the netlist editor.
+ *
+ * The file is mapped into memory and never copied. Opening it scans it
+ * once for line breaks and keeps the offset of every
+ * NETLIST_PAGER_INDEX_STRIDE-th line, the other lines are found from
+ * there with memchr. Lines are counted from 0 and end at '\n'.
+ */
+
+#define NETLIST_PAGER_INDEX_STRIDE 64
+
+typedef struct _NetlistPager NetlistPager;
+
+NetlistPager *netlist_pager_new (const gchar *filename, GError **error);
+void netlist_pager_free (NetlistPager *pager);
+
+gsize netlist_pager_get_size (const NetlistPager *pager);
+guint64 netlist_pager_get_n_lines (const NetlistPager *pager);
+// The whole file, it keeps the mapping alive after the pager is freed.
+GBytes *netlist_pager_get_bytes (const NetlistPager *pager);
+
+// Offset of the first byte of @line, the size of the file for n_lines.
+gsize netlist_pager_get_line_offset (const NetlistPager *pager, guint64 line);
+// The line the byte at @offset belongs to.
+guint64 netlist_pager_get_line_at (const NetlistPager *pager, gsize offset);
+/**
+ * The text of up to @n_lines lines starting at @first, line breaks
+ * included. Points into the mapping, it is not 0 terminated.
+ */
+const gchar *netlist_pager_get_lines (const NetlistPager *pager, guint64 first, guint64 n_lines,
+                                     gsize *length);
+
+/**
+ * Looks for @needle from @offset on, ignoring the case of ASCII letters
+ * like SPICE does. No wrap around.
+ *
+ * Returns: TRUE and the offset of the match in @match if found.
+ */
+gboolean netlist_pager_find (const NetlistPager *pager, const gchar *needle, gsize offset,
+                             gsize *match);
+
+#endif /* NETLIST_PAGER_H_ */
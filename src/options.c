@@ -1,12 +1,17 @@
 #include "options.h"
+#include "startup-timer.h"
 #include <gtk/gtk.h> //for gtk_get_option_group
 
 OreganoOptions opts = {
-    .debug = {.wires = FALSE, .boxes = FALSE, .dots = FALSE, .directions = FALSE, .all = FALSE}};
+    .debug = {.wires = FALSE, .boxes = FALSE, .dots = FALSE, .directions = FALSE, .memory = FALSE, .stalls = FALSE, .startup = FALSE, .all = FALSE}};
 
 GOptionEntry entries[] = {
     {"version", 0, 0, G_OPTION_ARG_NONE, &(opts.version),
      "Print the version and quit.", NULL},
+    {"sim-daemon", 0, 0, G_OPTION_ARG_NONE, &(opts.sim_daemon),
+     "Serve simulations to other instances instead of opening a window.", NULL},
+    {"sim-daemon-socket", 0, 0, G_OPTION_ARG_FILENAME, &(opts.sim_daemon_socket),
+     "Socket of the simulation daemon.", "PATH"},
     {"debug-wires", 0, 0, G_OPTION_ARG_NONE, &(opts.debug.wires),
      "Give them randomly alternating colors.", NULL},
     {"debug-boundingboxes", 0, 0, G_OPTION_ARG_NONE, &(opts.debug.boxes),
@@ -15,6 +20,14 @@ GOptionEntry entries[] = {
      "Draw an extra color circle around dots which are always shown.", NULL},
     {"debug-directions", 0, 0, G_OPTION_ARG_NONE, &(opts.debug.directions),
      "Draw fancy direction arrows top left edge of the sheet.", NULL},
+    {"debug-memory", 0, 0, G_OPTION_ARG_NONE, &(opts.debug.memory),
+     "Print the memory held by each subsystem when quitting.", NULL},
+    {"debug-stalls", 0, 0, G_OPTION_ARG_NONE, &(opts.debug.stalls),
+     "Print how long the user interface was blocked and by what when quitting.", NULL},
+    {"debug-startup", 0, 0, G_OPTION_ARG_NONE, &(opts.debug.startup),
+     "Print how long each step of the start took when quitting.", NULL},
+    {"startup-budget", 0, 0, G_OPTION_ARG_INT, &(opts.startup_budget),
+     "Time to the first window --debug-startup is content with, in milliseconds.", "MS"},
     {"debug-all", 0, 0, G_OPTION_ARG_NONE, &(opts.debug.all), "Enable all debug-* options.", NULL},
     {NULL}};
 
@@ -47,6 +60,10 @@ gboolean oregano_options_parse (int *argc, char **argv[], GError **e)
 
 inline gboolean oregano_options_version () { return opts.version; }
 
+inline gboolean oregano_options_sim_daemon () { return opts.sim_daemon; }
+
+inline const gchar *oregano_options_sim_daemon_socket () { return opts.sim_daemon_socket; }
+
 inline gboolean oregano_options_debug_wires () { return opts.debug.wires || opts.debug.all; }
 
 inline gboolean oregano_options_debug_boxes () { return opts.debug.boxes || opts.debug.all; }
@@ -57,3 +74,14 @@ inline gboolean oregano_options_debug_directions ()
 {
 	return opts.debug.directions || opts.debug.all;
 }
+
+inline gboolean oregano_options_debug_memory () { return opts.debug.memory || opts.debug.all; }
+
+inline gboolean oregano_options_debug_stalls () { return opts.debug.stalls || opts.debug.all; }
+
+inline gboolean oregano_options_debug_startup () { return opts.debug.startup || opts.debug.all; }
+
+guint oregano_options_startup_budget ()
+{
+	return opts.startup_budget > 0 ? opts.startup_budget : STARTUP_TIMER_BUDGET_DEFAULT;
+}
@@ -10,12 +10,18 @@
 typedef struct
 {
 	gboolean version;
+	gboolean sim_daemon;
+	gchar *sim_daemon_socket;
+	gint startup_budget;
 	struct
 	{
 		gboolean wires;
 		gboolean boxes;
 		gboolean dots;
 		gboolean directions;
+		gboolean memory;
+		gboolean stalls;
+		gboolean startup;
 		gboolean all;
 	} debug;
 
@@ -25,6 +31,10 @@ gboolean oregano_options_parse (int *argc, char **argv[], GError **e);
 
 gboolean oregano_options_version ();
 
+gboolean oregano_options_sim_daemon ();
+
+const gchar *oregano_options_sim_daemon_socket ();
+
 gboolean oregano_options_debug_wires ();
 
 gboolean oregano_options_debug_boxes ();
@@ -33,4 +43,12 @@ gboolean oregano_options_debug_dots ();
 
 gboolean oregano_options_debug_directions ();
 
+gboolean oregano_options_debug_memory ();
+
+gboolean oregano_options_debug_stalls ();
+
+gboolean oregano_options_debug_startup ();
+
+guint oregano_options_startup_budget ();
+
 #endif /* OPTION_H__ */
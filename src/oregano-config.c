@@ -41,6 +41,11 @@
 #include "load-library.h"
 #include "dialogs.h"
 #include "engine.h"
+#include "result-manager.h"
+#include "stall-detector.h"
+#include "startup-timer.h"
+#include "task-scheduler.h"
+#include "schematic-view.h"
 
 #define OREGLIB_EXT "oreglib"
 
@@ -52,22 +57,130 @@ void oregano_config_load (void)
 	oregano.settings = g_settings_new ("io.ahoi.oregano");
 	oregano.engine = g_settings_get_int (oregano.settings, "engine");
 	oregano.compress_files = g_settings_get_boolean (oregano.settings, "compress-files");
+	oregano.incremental_save = g_settings_get_boolean (oregano.settings, "incremental-save");
 	oregano.show_log = g_settings_get_boolean (oregano.settings, "show-log");
 	oregano.show_splash = g_settings_get_boolean (oregano.settings, "show-splash");
+	oregano.result_memory_budget = g_settings_get_int (oregano.settings, "result-memory-budget");
+	oregano.result_spill = g_settings_get_boolean (oregano.settings, "result-spill");
+	oregano.sim_daemon = g_settings_get_boolean (oregano.settings, "sim-daemon");
 
 	// Let's deal with first use -I don't like this-
 	if ((oregano.engine < 0) || (oregano.engine >= OREGANO_ENGINE_COUNT))
 		oregano.engine = 0;
+	if (oregano.result_memory_budget < 0)
+		oregano.result_memory_budget = 0;
+
+	oregano_config_apply_result_budget ();
+}
+
+void oregano_config_apply_result_budget (void)
+{
+	result_manager_set_budget ((guint64)oregano.result_memory_budget << 20);
+
+	if (oregano.result_spill) {
+		gchar *directory = g_build_filename (g_get_user_cache_dir (), "oregano", "results", NULL);
+		result_manager_set_spill_directory (directory);
+		g_free (directory);
+	} else {
+		result_manager_set_spill_directory (NULL);
+	}
 }
 
 void oregano_config_save (void)
 {
 	g_settings_set_int (oregano.settings, "engine", oregano.engine);
 	g_settings_set_boolean (oregano.settings, "compress-files", oregano.compress_files);
+	g_settings_set_boolean (oregano.settings, "incremental-save", oregano.incremental_save);
 	g_settings_set_boolean (oregano.settings, "show-log", oregano.show_log);
 	g_settings_set_boolean (oregano.settings, "show-splash", oregano.show_splash);
+	g_settings_set_int (oregano.settings, "result-memory-budget", oregano.result_memory_budget);
+	g_settings_set_boolean (oregano.settings, "result-spill", oregano.result_spill);
+	g_settings_set_boolean (oregano.settings, "sim-daemon", oregano.sim_daemon);
+}
+
+// Libraries that are parsed on the task scheduler, in directory order
+typedef struct
+{
+	gchar *fname;
+	Library *library;
+	Task *task;
+} PendingLibrary;
+
+static GQueue pending_libraries = G_QUEUE_INIT;
+
+static void load_library (gchar *fname)
+{
+	Library *library;
+
+	stall_detector_begin ("library parsing");
+	library = library_parse_xml_file (fname);
+	stall_detector_end ();
+
+	if (library)
+		oregano.libraries = g_list_append (oregano.libraries, library);
+	else
+		load_library_error (fname);
+}
+
+static void parse_library_func (PendingLibrary *pending, CancelInfo *cancel_info)
+{
+	pending->library = library_parse_xml_file (pending->fname);
+}
+
+/*
+ * Takes over the libraries that are parsed from the head of the queue,
+ * so the list keeps the order of the directory however the tasks finish.
+ */
+static void add_parsed_libraries (void)
+{
+	PendingLibrary *pending;
+	gboolean changed = FALSE;
+
+	while ((pending = g_queue_peek_head (&pending_libraries)) != NULL &&
+	       task_is_done (pending->task)) {
+		g_queue_pop_head (&pending_libraries);
+		if (pending->library)
+			oregano.libraries = g_list_append (oregano.libraries, pending->library);
+		else
+			load_library_error (pending->fname);
+
+		task_unref (pending->task);
+		g_free (pending->fname);
+		g_free (pending);
+		changed = TRUE;
+	}
+
+	if (!changed)
+		return;
+	schematic_view_libraries_changed ();
+	if (g_queue_is_empty (&pending_libraries))
+		startup_timer_mark ("remaining libraries");
 }
 
+// the queue may have been taken over by oregano_libraries_ensure_loaded already
+static void library_parsed (gpointer data, gboolean canceled) { add_parsed_libraries (); }
+
+static void queue_library (gchar *fname)
+{
+	PendingLibrary *pending = g_new0 (PendingLibrary, 1);
+	Task *task;
+
+	pending->fname = fname;
+	task = task_new ((TaskFunc)parse_library_func, pending, NULL);
+	// after the parts of the first window
+	task_set_priority (task, TASK_PRIORITY_LOW);
+	task_set_done_func (task, library_parsed, NULL);
+	pending->task = task_ref (task);
+	g_queue_push_tail (&pending_libraries, pending);
+	task_scheduler_submit (task_scheduler_get_default (), task);
+}
+
+/*
+ * Only default.oreglib is parsed right away, it is all a new schematic
+ * needs. The other libraries are parsed on the task scheduler and
+ * added once they are done. With a splash screen everything is loaded
+ * here, the splash is there to show it.
+ */
 void oregano_lookup_libraries (Splash *sp)
 {
 	gchar *fname;
@@ -75,21 +188,20 @@ void oregano_lookup_libraries (Splash *sp)
 	struct dirent *libentry;
 	Library *library;
 
-	oregano.libraries = NULL;
+	if (oregano.libraries != NULL || !g_queue_is_empty (&pending_libraries))
+		return;
+
 	libdir = opendir (OREGANO_LIBRARYDIR);
 
 	if (libdir == NULL)
 		return;
 
-	if (oregano.libraries != NULL) {
-		closedir (libdir);
-		return;
-	}
-
 	fname = g_build_filename (OREGANO_LIBRARYDIR, "default.oreglib", NULL);
 
 	if (g_file_test (fname, G_FILE_TEST_EXISTS)) {
+		stall_detector_begin ("library parsing");
 		library = library_parse_xml_file (fname);
+		stall_detector_end ();
 		oregano.libraries = g_list_append (oregano.libraries, library);
 	}
 	g_free (fname);
@@ -105,19 +217,73 @@ void oregano_lookup_libraries (Splash *sp)
 				sprintf (txt, _ ("Loading %s ..."), libentry->d_name);
 
 				oregano_splash_step (sp, txt);
+				load_library (fname);
+				g_free (fname);
+			} else {
+				queue_library (fname);
 			}
+		}
+	}
+	closedir (libdir);
 
-			library = library_parse_xml_file (fname);
+	// without the default library there is nothing to start with
+	if (oregano.libraries == NULL)
+		oregano_libraries_ensure_loaded ();
+}
 
-			if (library)
-				oregano.libraries = g_list_append (oregano.libraries, library);
-			else
-				load_library_error (fname);
+void oregano_libraries_ensure_loaded (void)
+{
+	for (GList *iter = pending_libraries.head; iter; iter = iter->next)
+		task_wait (((PendingLibrary *)iter->data)->task);
+	add_parsed_libraries ();
+}
+
+/*
+ * A library that was read from the file before is replaced at its place
+ * in the list, so the part browsers keep their order. The list drops its
+ * reference to the old one, it is freed as soon as no part, e.g. one in
+ * the undo history, refers to it anymore. While the file does not parse
+ * (it may be half written), the old definitions are kept.
+ */
+void oregano_reload_library (const gchar *filename)
+{
+	Library *old_library = NULL, *new_library = NULL;
+	GList *link;
+
+	g_return_if_fail (filename != NULL);
 
-			g_free (fname);
+	// it would be appended a second time from the queue
+	oregano_libraries_ensure_loaded ();
+
+	for (link = oregano.libraries; link; link = link->next) {
+		if (g_strcmp0 (((Library *)link->data)->filename, filename) == 0) {
+			old_library = link->data;
+			break;
 		}
 	}
-	closedir (libdir);
+
+	if (g_file_test (filename, G_FILE_TEST_EXISTS)) {
+		stall_detector_begin ("library parsing");
+		new_library = library_parse_xml_file (filename);
+		stall_detector_end ();
+
+		if (new_library == NULL) {
+			g_warning ("Keeping the parts of %s until it can be read again", filename);
+			return;
+		}
+	}
+
+	if (old_library != NULL && new_library != NULL)
+		link->data = new_library;
+	else if (old_library != NULL)
+		oregano.libraries = g_list_delete_link (oregano.libraries, link);
+	else if (new_library != NULL)
+		oregano.libraries = g_list_append (oregano.libraries, new_library);
+	else
+		return;
+
+	schematic_view_library_reloaded (old_library, new_library);
+	library_unref (old_library);
 }
 
 static gboolean is_oregano_library_name (gchar *name)
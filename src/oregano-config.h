@@ -37,6 +37,7 @@
 
 void oregano_config_load (void);
 void oregano_config_save (void);
+void oregano_config_apply_result_budget (void);
 
 /*
  * Feb 2000, Elker Cavina <e.cavina@libero.it>
@@ -44,5 +45,9 @@ void oregano_config_save (void);
  */
 
 void oregano_lookup_libraries (Splash *sp);
+// Parses the libraries still waiting for idle time right now.
+void oregano_libraries_ensure_loaded (void);
+// Parses a library file again that was created, changed or removed.
+void oregano_reload_library (const gchar *filename);
 
 #endif
@@ -57,6 +57,9 @@
 #include "stock.h"
 #include "oregano.h"
 #include "splash.h"
+#include "result-manager.h"
+#include "startup-timer.h"
+#include "library-monitor.h"
 
 #include <libintl.h>
 
@@ -74,6 +77,8 @@ static void oregano_open (GApplication *application, GFile **files, gint n_files
 static void oregano_finalize (GObject *object)
 {
 	cursors_shutdown ();
+	library_monitor_stop ();
+	result_manager_shutdown ();
 	G_OBJECT_CLASS (oregano_parent_class)->finalize (object);
 }
 
@@ -118,6 +123,13 @@ static gboolean quit_hook (GSignalInvocationHint *ihint, guint n_param_values,
 	return FALSE;
 }
 
+static gboolean first_window_drawn (GtkWidget *widget, cairo_t *cr, gpointer user_data)
+{
+	startup_timer_first_window ();
+	g_signal_handlers_disconnect_by_func (widget, first_window_drawn, user_data);
+	return FALSE;
+}
+
 static void oregano_application (GApplication *app, GFile *file)
 {
 	Schematic *schematic = NULL;
@@ -143,6 +155,7 @@ static void oregano_application (GApplication *app, GFile *file)
 	}
 	// splash == NULL if showing splash is disabled
 	oregano_lookup_libraries (splash);
+	startup_timer_mark ("default library");
 
 	if (oregano.libraries == NULL) {
 		oregano_error (_ ("Could not find a parts library.\n\n"
@@ -150,7 +163,8 @@ static void oregano_application (GApplication *app, GFile *file)
 		return;
 	}
 
-	oregano.clipboard = NULL;
+	// edits of the libraries and models show up right away
+	library_monitor_start ();
 
 	schematic = NULL;
 
@@ -172,6 +186,12 @@ static void oregano_application (GApplication *app, GFile *file)
 		gtk_widget_show_all (schematic_view_get_toplevel (schematic_view));
 	}
 
+	if (schematic_view != NULL && startup_timer_is_running ()) {
+		startup_timer_mark ("main window");
+		g_signal_connect_after (G_OBJECT (schematic_view_get_toplevel (schematic_view)), "draw",
+		                        G_CALLBACK (first_window_drawn), NULL);
+	}
+
 	g_signal_add_emission_hook (g_signal_lookup ("last_schematic_destroyed", TYPE_SCHEMATIC), 0,
 	                            quit_hook, NULL, NULL);
 
@@ -62,7 +62,6 @@ typedef struct
 typedef struct
 {
 	GList *libraries;
-	GSList *clipboard;
 
 	// list for library paths
 	GList *lib_path;
@@ -76,8 +75,12 @@ typedef struct
 	GSettings *settings;
 	gint engine;
 	gboolean compress_files;
+	gboolean incremental_save;
 	gboolean show_log;
 	gboolean show_splash;
+	gint result_memory_budget;
+	gboolean result_spill;
+	gboolean sim_daemon;
 } OreganoApp;
 
 extern OreganoApp oregano;
@@ -46,6 +46,7 @@
 #include "dialogs.h"
 #include "coords.h"
 #include "sheet.h"
+#include "startup-timer.h"
 
 #include "debug.h"
 
@@ -66,6 +67,9 @@ struct _Browser
 	GtkTreeModel *filter_model;
 	GtkEntry *filter_entry;
 	gint filter_len;
+	GtkWidget *library_combo;
+	// the part list is filled in idle time, after the window is drawn
+	guint populate_id;
 };
 
 typedef struct
@@ -89,6 +93,7 @@ static void library_switch_cb (GtkWidget *item, Browser *br);
 static void preview_realized (GtkWidget *widget, Browser *br);
 static void wrap_string (char *str, int width);
 static void place_cmd (GtkWidget *widget, Browser *br);
+static gboolean populate_list (Browser *br);
 
 static gboolean part_list_filter_func (GtkTreeModel *model, GtkTreeIter *iter, gpointer data)
 {
@@ -127,6 +132,10 @@ static int part_search_change (GtkWidget *widget, Browser *br)
 {
 	const char *s = gtk_entry_get_text (GTK_ENTRY (widget));
 
+	// searched before the list was filled in idle time
+	if (br->populate_id != 0)
+		populate_list (br);
+
 	if (s) {
 		// Keep record of the filter text length for each item.
 		br->filter_len = strlen (s);
@@ -323,9 +332,39 @@ static void update_list (Browser *br)
 {
 	GtkListStore *model;
 
+	if (br->populate_id != 0) {
+		g_source_remove (br->populate_id);
+		br->populate_id = 0;
+	}
+
 	model = GTK_LIST_STORE (br->real_model);
 	gtk_list_store_clear (model);
-	g_hash_table_foreach (br->library->part_hash, (GHFunc)add_part, br);
+	// all libraries may have been removed
+	if (br->library != NULL)
+		g_hash_table_foreach (br->library->part_hash, (GHFunc)add_part, br);
+}
+
+static gboolean populate_list (Browser *br)
+{
+	GtkTreePath *path;
+
+	br->populate_id = 0;
+	update_list (br);
+
+	path = gtk_tree_path_new_first ();
+	gtk_tree_view_set_cursor (GTK_TREE_VIEW (br->list), path, NULL, FALSE);
+	gtk_tree_path_free (path);
+
+	startup_timer_mark ("part list");
+	return G_SOURCE_REMOVE;
+}
+
+static void list_destroyed (GtkWidget *list, Browser *br)
+{
+	if (br->populate_id != 0) {
+		g_source_remove (br->populate_id);
+		br->populate_id = 0;
+	}
 }
 
 // Show a part browser. If one already exists, just bring it up, otherwise
@@ -435,7 +474,6 @@ GtkWidget *part_browser_create (SchematicView *schematic_view)
 	static GtkTargetEntry dnd_types[] = {{"x-application/oregano-part", 0, DRAG_PART_INFO}};
 
 	static int dnd_num_types = sizeof(dnd_types) / sizeof(dnd_types[0]);
-	GtkTreePath *path;
 
 	if ((builder = gtk_builder_new ()) == NULL) {
 		oregano_error (_ ("Could not create part browser"));
@@ -526,7 +564,8 @@ GtkWidget *part_browser_create (SchematicView *schematic_view)
 		gtk_tree_view_set_model (GTK_TREE_VIEW (w), br->sort_model);
 
 	gtk_tree_view_append_column (GTK_TREE_VIEW (w), cell_column);
-	update_list (br);
+	br->populate_id = g_idle_add_full (G_PRIORITY_LOW, (GSourceFunc)populate_list, br, NULL);
+	g_signal_connect (G_OBJECT (w), "destroy", G_CALLBACK (list_destroyed), br);
 
 	// Set up TreeView dnd.
 	g_signal_connect (G_OBJECT (w), "drag_data_get", G_CALLBACK (drag_data_get), br);
@@ -539,10 +578,6 @@ GtkWidget *part_browser_create (SchematicView *schematic_view)
 
 	br->viewport = GTK_WIDGET (gtk_builder_get_object (builder, "part_browser_vbox"));
 
-	path = gtk_tree_path_new_first ();
-	gtk_tree_view_set_cursor (GTK_TREE_VIEW (w), path, NULL, FALSE);
-	gtk_tree_path_free (path);
-
 	gtk_widget_unparent (br->viewport);
 	return br->viewport;
 }
@@ -552,9 +587,6 @@ static void part_browser_setup_libs (Browser *br, GtkBuilder *builder)
 
 	GtkWidget *combo_box, *w;
 
-	GList *libs;
-	gboolean first = FALSE;
-
 	w = GTK_WIDGET (gtk_builder_get_object (builder, "library_optionmenu"));
 	gtk_widget_destroy (w);
 
@@ -562,18 +594,62 @@ static void part_browser_setup_libs (Browser *br, GtkBuilder *builder)
 	combo_box = gtk_combo_box_text_new ();
 	gtk_grid_attach (GTK_GRID (w), combo_box, 1, 0, 1, 1);
 
-	libs = oregano.libraries;
+	br->library_combo = combo_box;
+	part_browser_update_libraries (br);
+	g_signal_connect (G_OBJECT (combo_box), "changed", G_CALLBACK (library_switch_cb), br);
+}
+
+// Adds the libraries that were parsed since the combo box was filled.
+void part_browser_update_libraries (gpointer p)
+{
+	Browser *br = p;
+	GtkTreeModel *model;
+	GList *libs;
+	gint n_items;
+
+	g_return_if_fail (br != NULL);
 
-	while (libs) {
-		gtk_combo_box_text_append_text (GTK_COMBO_BOX_TEXT (combo_box),
+	model = gtk_combo_box_get_model (GTK_COMBO_BOX (br->library_combo));
+	n_items = gtk_tree_model_iter_n_children (model, NULL);
+
+	for (libs = g_list_nth (oregano.libraries, n_items); libs; libs = libs->next)
+		gtk_combo_box_text_append_text (GTK_COMBO_BOX_TEXT (br->library_combo),
 		                                ((Library *)libs->data)->name);
-		libs = libs->next;
-		if (!first) {
-			gtk_combo_box_set_active (GTK_COMBO_BOX (combo_box), 0);
-			first = TRUE;
-		}
+
+	if (n_items == 0 && oregano.libraries != NULL)
+		gtk_combo_box_set_active (GTK_COMBO_BOX (br->library_combo), 0);
+}
+
+// A library was parsed again or removed, the combo box is filled anew.
+void part_browser_reload_libraries (gpointer p)
+{
+	Browser *br = p;
+	gchar *active_name;
+	GList *libs;
+	gint i, active = 0;
+
+	g_return_if_fail (br != NULL);
+
+	active_name = gtk_combo_box_text_get_active_text (GTK_COMBO_BOX_TEXT (br->library_combo));
+	gtk_combo_box_text_remove_all (GTK_COMBO_BOX_TEXT (br->library_combo));
+
+	for (libs = oregano.libraries, i = 0; libs; libs = libs->next, i++) {
+		Library *library = libs->data;
+
+		gtk_combo_box_text_append_text (GTK_COMBO_BOX_TEXT (br->library_combo), library->name);
+		if (g_strcmp0 (library->name, active_name) == 0)
+			active = i;
+	}
+	g_free (active_name);
+
+	// library_switch_cb shows the parts of the new library
+	if (oregano.libraries != NULL) {
+		gtk_combo_box_set_active (GTK_COMBO_BOX (br->library_combo), active);
+	} else {
+		// the old one is freed by the caller
+		br->library = NULL;
+		update_list (br);
 	}
-	g_signal_connect (G_OBJECT (combo_box), "changed", G_CALLBACK (library_switch_cb), br);
 }
 
 static void library_switch_cb (GtkWidget *combo_box, Browser *br)
@@ -581,6 +657,10 @@ static void library_switch_cb (GtkWidget *combo_box, Browser *br)
 	GtkTreePath *path;
 	GList *libs = oregano.libraries;
 
+	// emptied by part_browser_reload_libraries
+	if (gtk_combo_box_get_active (GTK_COMBO_BOX (combo_box)) < 0)
+		return;
+
 	br->library =
 	    (Library *)g_list_nth_data (libs, gtk_combo_box_get_active (GTK_COMBO_BOX (combo_box)));
 
@@ -42,5 +42,7 @@ GtkWidget *part_browser_create (SchematicView *schematic_view);
 void part_browser_dnd (GtkSelectionData *selection_data, gint x, gint y);
 void part_browser_place_selected_part (Schematic *sm);
 void part_browser_reparent (gpointer *br, GtkWidget *new_parent);
+void part_browser_update_libraries (gpointer br);
+void part_browser_reload_libraries (gpointer br);
 
 #endif
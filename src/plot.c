@@ -46,6 +46,10 @@
 #include "gplotfunction.h"
 #include "gplotlines.h"
 #include "plot-add-function.h"
+#include "sim-data-model.h"
+#include "result-manager.h"
+#include "sim-compare.h"
+#include "sim-data-export.h"
 
 #define PLOT_PADDING_X 50
 #define PLOT_PADDING_Y 40
@@ -58,6 +62,21 @@
 #define GET_X_POINT(x_val, x_min, factor) (((x_val) - (x_min)) * (factor))
 #define GET_X_VALUE(x_point, x_min, factor) ((x_min) + (x_point) / (factor))
 
+// columns of the variable list
+enum {
+	VARIABLE_VISIBLE = 0,
+	VARIABLE_NAME,
+	VARIABLE_TOGGLEABLE,
+	VARIABLE_COLOR,
+	VARIABLE_FUNCTION,
+	// column in SimulationData.data, -1 for the parent rows and functions
+	VARIABLE_DATA_COLUMN,
+	// rows of a comparison: 2 * trace + 1 for the other run, 2 * trace + 2
+	// for the difference, -1 for their parent and 0 for all other rows
+	VARIABLE_COMPARE_TRACE,
+	VARIABLE_N_COLUMNS
+};
+
 #define PLOT_AXIS_COLOR "black"
 #define PLOT_CURVE_COLOR "medium sea green"
 #include "debug.h"
@@ -73,10 +92,21 @@ typedef struct
 	GtkWidget *window;
 	GtkWidget *canvas;
 	GtkWidget *coord; // shows the coordinates of the mouse
+	GtkWidget *cursor_readout; // values of the traces at the cursors
 	GtkWidget *combo_box;
 
 	GtkWidget *plot;
 
+	// all variables, the tree view shows them through a filter
+	GtkTreeStore *variables;
+	GtkTreeModel *variables_filter;
+	gchar *search_key;
+
+	// overlay of another run of the same analysis
+	SimCompareResult *comparison;
+	gchar *comparison_label;
+	GCancellable *comparison_cancellable;
+
 	gboolean show_cursor;
 
 	OreganoEngine *sim;
@@ -110,6 +140,14 @@ static gint delete_event_cb (GtkWidget *widget, GdkEvent *event, Plot *plot);
 static void plot_canvas_movement (GtkWidget *, GdkEventMotion *, Plot *);
 static void add_function (GtkMenuItem *menuitem, Plot *plot);
 static void close_window (GtkMenuItem *menuitem, Plot *plot);
+static void show_data (GtkMenuItem *menuitem, Plot *plot);
+static void export_data (GtkMenuItem *menuitem, Plot *plot);
+static void compare_with (GtkMenuItem *menuitem, Plot *plot);
+static void place_cursors (GtkMenuItem *menuitem, Plot *plot);
+static void hide_cursors (GtkMenuItem *menuitem, Plot *plot);
+static void autoscale_toggled (GtkCheckMenuItem *menuitem, Plot *plot);
+static void plot_update_cursor_readout (Plot *plot);
+static void plot_comparison_forget (Plot *plot);
 
 static gchar *get_variable_units (gchar *str)
 {
@@ -140,6 +178,10 @@ static gint delete_event_cb (GtkWidget *widget, GdkEvent *event, Plot *plot)
 	g_object_unref (plot->sim);
 	if (plot->ytitle)
 		g_free (plot->ytitle);
+	plot_comparison_forget (plot);
+	g_object_unref (plot->variables_filter);
+	g_object_unref (plot->variables);
+	g_free (plot->search_key);
 	g_free (plot);
 	plot = NULL;
 	return FALSE;
@@ -156,33 +198,14 @@ static void destroy_window (GtkWidget *widget, Plot *plot)
 	plot->window = NULL;
 	if (plot->title)
 		g_free (plot->title);
+	plot_comparison_forget (plot);
+	g_object_unref (plot->variables_filter);
+	g_object_unref (plot->variables);
+	g_free (plot->search_key);
 	g_free (plot);
 	plot = NULL;
 }
 
-static void on_plot_selected (GtkCellRendererToggle *cell_renderer, gchar *path, Plot *plot)
-{
-	GPlotFunction *f;
-	GtkTreeIter iter;
-	GtkTreeModel *model;
-	GtkTreeView *treeview;
-	gboolean visible = FALSE;
-
-	treeview = GTK_TREE_VIEW (g_object_get_data (G_OBJECT (plot->window), "clist"));
-
-	model = gtk_tree_view_get_model (treeview);
-	if (!gtk_tree_model_get_iter_from_string (model, &iter, path))
-		return;
-
-	gtk_tree_model_get (model, &iter, 0, &visible, 4, &f, -1);
-	visible = !visible;
-	gtk_tree_store_set (GTK_TREE_STORE (model), &iter, 0, visible, -1);
-
-	g_object_set (G_OBJECT (f), "visible", visible, NULL);
-
-	gtk_widget_queue_draw (plot->plot);
-}
-
 static GPlotFunction *create_plot_function_from_simulation_data (guint i, SimulationData *current)
 {
 	GPlotFunction *f;
@@ -219,12 +242,137 @@ static GPlotFunction *create_plot_function_from_simulation_data (guint i, Simula
 	return f;
 }
 
+/**
+ * @index 2 * trace for the other run, drawn dashed, 2 * trace + 1 for
+ * the difference
+ */
+static GPlotFunction *create_plot_function_from_comparison (SimCompareResult *comparison,
+                                                            gint index)
+{
+	GPlotFunction *f;
+	SimCompareTrace *trace;
+	gboolean difference = index % 2;
+
+	g_return_val_if_fail (index / 2 < (gint)comparison->traces->len, NULL);
+	trace = g_ptr_array_index (comparison->traces, index / 2);
+
+	f = g_plot_lines_new (g_memdup (comparison->x, comparison->n * sizeof(gdouble)),
+	                      g_memdup (difference ? trace->difference : trace->other,
+	                                comparison->n * sizeof(gdouble)),
+	                      comparison->n);
+	g_object_set (G_OBJECT (f), "color", plot_curve_colors[(next_color++) % n_curve_colors],
+	              "dashed", !difference, NULL);
+
+	return f;
+}
+
+/**
+ * Older runs may have been moved out of memory by the result manager,
+ * call this before reading the columns of plot->current.
+ */
+static gboolean plot_results_available (Plot *plot)
+{
+	GError *e = NULL;
+
+	if (result_manager_ensure_loaded (G_OBJECT (plot->sim), &e))
+		return TRUE;
+
+	oregano_warning_with_title (_ ("The simulation results are not available anymore."),
+	                            e->message);
+	g_clear_error (&e);
+	return FALSE;
+}
+
+static gboolean on_window_focus_in (GtkWidget *widget, GdkEvent *event, Plot *plot)
+{
+	result_manager_touch (G_OBJECT (plot->sim));
+	return FALSE;
+}
+
+/**
+ * The plot functions of the variables are only created when they are
+ * shown for the first time. A big design easily has thousands of
+ * variables, most of which are never looked at.
+ */
+static void on_plot_selected (GtkCellRendererToggle *cell_renderer, gchar *path, Plot *plot)
+{
+	GPlotFunction *f;
+	GtkTreeIter filter_iter, iter;
+	GtkTreeModel *model = GTK_TREE_MODEL (plot->variables);
+	gboolean visible = FALSE;
+	gint column, compare;
+
+	if (!gtk_tree_model_get_iter_from_string (plot->variables_filter, &filter_iter, path))
+		return;
+	gtk_tree_model_filter_convert_iter_to_child_iter (GTK_TREE_MODEL_FILTER (plot->variables_filter),
+	                                                  &iter, &filter_iter);
+
+	gtk_tree_model_get (model, &iter, VARIABLE_VISIBLE, &visible, VARIABLE_FUNCTION, &f,
+	                    VARIABLE_DATA_COLUMN, &column, VARIABLE_COMPARE_TRACE, &compare, -1);
+	visible = !visible;
+
+	if (f == NULL) {
+		gchar *color;
+
+		if (compare > 0 && plot->comparison != NULL)
+			f = create_plot_function_from_comparison (plot->comparison, compare - 1);
+		else if (column >= 0 && plot->current != NULL && plot_results_available (plot))
+			f = create_plot_function_from_simulation_data (column, plot->current);
+		if (f == NULL)
+			return;
+		g_object_get (G_OBJECT (f), "color", &color, NULL);
+		g_plot_add_function (GPLOT (plot->plot), f);
+		gtk_tree_store_set (plot->variables, &iter, VARIABLE_COLOR, color, VARIABLE_FUNCTION, f,
+		                    -1);
+		g_free (color);
+	}
+
+	gtk_tree_store_set (plot->variables, &iter, VARIABLE_VISIBLE, visible, -1);
+	g_object_set (G_OBJECT (f), "visible", visible, NULL);
+
+	plot_update_cursor_readout (plot);
+	gtk_widget_queue_draw (plot->plot);
+}
+
+static gboolean variable_visible_func (GtkTreeModel *model, GtkTreeIter *iter, Plot *plot)
+{
+	gchar *name, *key;
+	gboolean visible;
+
+	if (plot->search_key == NULL || *plot->search_key == '\0')
+		return TRUE;
+
+	// keep the "Nodes", "Functions" and comparison parents
+	if (gtk_tree_store_iter_depth (GTK_TREE_STORE (model), iter) == 0)
+		return TRUE;
+
+	gtk_tree_model_get (model, iter, VARIABLE_NAME, &name, -1);
+	if (name == NULL)
+		return TRUE;
+
+	key = g_utf8_casefold (name, -1);
+	visible = strstr (key, plot->search_key) != NULL;
+	g_free (key);
+	g_free (name);
+
+	return visible;
+}
+
+static void on_variable_search_changed (GtkSearchEntry *entry, Plot *plot)
+{
+	g_free (plot->search_key);
+	plot->search_key = g_utf8_casefold (gtk_entry_get_text (GTK_ENTRY (entry)), -1);
+	gtk_tree_model_filter_refilter (GTK_TREE_MODEL_FILTER (plot->variables_filter));
+
+	GtkTreeView *list = GTK_TREE_VIEW (g_object_get_data (G_OBJECT (plot->window), "clist"));
+	gtk_tree_view_expand_all (list);
+}
+
 static void analysis_selected (GtkWidget *combo_box, Plot *plot)
 {
 	int i;
 	const gchar *ca;
 	GtkTreeView *list;
-	GtkTreeModel *model;
 	GtkTreeIter parent_nodes, parent_functions;
 	GList *analysis;
 	SimulationData *sdat;
@@ -267,52 +415,49 @@ static void analysis_selected (GtkWidget *combo_box, Plot *plot)
 	    g_strdup_printf (_ ("Plot - %s"), analysis_name);
 	g_free(analysis_name);
 
+	// a comparison belongs to the analysis it was made for, its
+	// functions go away with g_plot_clear below
+	plot_comparison_forget (plot);
+
 	//  Set the variable names in the list
-	model = gtk_tree_view_get_model (GTK_TREE_VIEW (list));
-	gtk_tree_store_clear (GTK_TREE_STORE (model));
+	gtk_tree_store_clear (plot->variables);
 
 	// Create root nodes
-	gtk_tree_store_append (GTK_TREE_STORE (model), &parent_nodes, NULL);
-	gtk_tree_store_set (GTK_TREE_STORE (model), &parent_nodes, 0, FALSE, 1, _ ("Nodes"), 2, FALSE,
-	                    3, "white", -1);
+	gtk_tree_store_append (plot->variables, &parent_nodes, NULL);
+	gtk_tree_store_set (plot->variables, &parent_nodes, VARIABLE_VISIBLE, FALSE, VARIABLE_NAME,
+	                    _ ("Nodes"), VARIABLE_TOGGLEABLE, FALSE, VARIABLE_COLOR, "white",
+	                    VARIABLE_DATA_COLUMN, -1, -1);
 
-	gtk_tree_store_append (GTK_TREE_STORE (model), &parent_functions, NULL);
-	gtk_tree_store_set (GTK_TREE_STORE (model), &parent_functions, 0, NULL, 1, _ ("Functions"), 2,
-	                    FALSE, 3, "white", -1);
+	gtk_tree_store_append (plot->variables, &parent_functions, NULL);
+	gtk_tree_store_set (plot->variables, &parent_functions, VARIABLE_VISIBLE, FALSE,
+	                    VARIABLE_NAME, _ ("Functions"), VARIABLE_TOGGLEABLE, FALSE,
+	                    VARIABLE_COLOR, "white", VARIABLE_DATA_COLUMN, -1, -1);
 
 	g_plot_set_axis_labels (GPLOT (plot->plot), plot->xtitle, plot->ytitle);
 	g_plot_clear (GPLOT (plot->plot));
 
+	// The list is detached from the view while it is filled, otherwise
+	// the view handles a signal for every single row.
+	g_object_ref (plot->variables_filter);
+	gtk_tree_view_set_model (list, NULL);
+
+	//FIXME extra axis scaling for current/voltage
+	//FIXME or extra plot window for current/voltage
+	//FIXME or extra analysis for current/voltage
 	for (i = 1; i < plot->current->n_variables; i++) {
 		GtkTreeIter iter;
-		GPlotFunction *f;
-		if (plot->current->type != ANALYSIS_TYPE_DC_TRANSFER) {
-			//FIXME extra axis scaling for current/voltage
-			//FIXME or extra plot window for current/voltage
-			//FIXME or extra analysis for current/voltage
-			gchar *color;
-
-			f = create_plot_function_from_simulation_data (i, plot->current);
-			g_object_set (G_OBJECT (f), "visible", FALSE, NULL);
-			g_object_get (G_OBJECT (f), "color", &color, NULL);
-
-			g_plot_add_function (GPLOT (plot->plot), f);
-			gtk_tree_store_append (GTK_TREE_STORE (model), &iter, &parent_nodes);
-			gtk_tree_store_set (GTK_TREE_STORE (model), &iter, 0, FALSE, 1,
-			                    plot->current->var_names[i], 2, TRUE, 3, color, 4, f, -1);
-		} else {
-			gchar *color;
-
-			f = create_plot_function_from_simulation_data (i, plot->current);
-			g_object_set (G_OBJECT (f), "visible", FALSE, NULL);
-			g_object_get (G_OBJECT (f), "color", &color, NULL);
-
-			g_plot_add_function (GPLOT (plot->plot), f);
-			gtk_tree_store_append (GTK_TREE_STORE (model), &iter, &parent_nodes);
-			gtk_tree_store_set (GTK_TREE_STORE (model), &iter, 0, FALSE, 1,
-			                    plot->current->var_names[i], 2, TRUE, 3, color, 4, f, -1);
-		}
+
+		gtk_tree_store_insert_with_values (plot->variables, &iter, &parent_nodes, -1,
+		                                   VARIABLE_VISIBLE, FALSE, VARIABLE_NAME,
+		                                   plot->current->var_names[i], VARIABLE_TOGGLEABLE, TRUE,
+		                                   VARIABLE_DATA_COLUMN, i, -1);
 	}
+
+	gtk_tree_view_set_model (list, plot->variables_filter);
+	g_object_unref (plot->variables_filter);
+	gtk_tree_view_expand_all (list);
+
+	plot_update_cursor_readout (plot);
 	gtk_widget_queue_draw (plot->plot);
 }
 
@@ -333,10 +478,113 @@ static void plot_canvas_movement (GtkWidget *w, GdkEventMotion *event, Plot *plo
 	g_free (coordstr);
 }
 
+typedef struct
+{
+	GString *text;
+	gboolean visible[GPLOT_N_CURSORS];
+	gdouble x[GPLOT_N_CURSORS];
+} CursorReadout;
+
+static gboolean cursor_readout_add_trace (GtkTreeModel *model, GtkTreePath *path,
+                                          GtkTreeIter *iter, CursorReadout *readout)
+{
+	GPlotFunction *f;
+	gboolean visible;
+	gboolean valid[GPLOT_N_CURSORS] = {FALSE};
+	gdouble y[GPLOT_N_CURSORS];
+	gchar *name;
+
+	gtk_tree_model_get (model, iter, VARIABLE_VISIBLE, &visible, VARIABLE_FUNCTION, &f, -1);
+	if (!visible || f == NULL)
+		return FALSE;
+
+	for (guint i = 0; i < GPLOT_N_CURSORS; i++)
+		if (readout->visible[i])
+			valid[i] = g_plot_function_get_value (f, readout->x[i], &y[i]);
+
+	gtk_tree_model_get (model, iter, VARIABLE_NAME, &name, -1);
+	g_string_append_printf (readout->text, "\n%s:", name);
+	g_free (name);
+
+	for (guint i = 0; i < GPLOT_N_CURSORS; i++) {
+		if (valid[i])
+			g_string_append_printf (readout->text, "  %c = %g", 'A' + i, y[i]);
+		else if (readout->visible[i])
+			g_string_append_printf (readout->text, "  %c = -", 'A' + i);
+	}
+	if (valid[GPLOT_CURSOR_A] && valid[GPLOT_CURSOR_B]) {
+		gdouble dy = y[GPLOT_CURSOR_B] - y[GPLOT_CURSOR_A];
+		gdouble dx = readout->x[GPLOT_CURSOR_B] - readout->x[GPLOT_CURSOR_A];
+
+		g_string_append_printf (readout->text, "  dY = %g", dy);
+		if (dx != 0.0)
+			g_string_append_printf (readout->text, "  dY/dX = %g", dy / dx);
+	}
+
+	return FALSE;
+}
+
+/**
+ * Shows the values of all visible traces at the cursors. Every value is
+ * a bisection of the samples of a trace, so this is cheap enough to run
+ * on every motion event of a cursor drag.
+ */
+static void plot_update_cursor_readout (Plot *plot)
+{
+	CursorReadout readout;
+
+	if (plot->cursor_readout == NULL)
+		return;
+
+	for (guint i = 0; i < GPLOT_N_CURSORS; i++)
+		readout.visible[i] = g_plot_get_cursor (GPLOT (plot->plot), i, &readout.x[i]);
+
+	if (!readout.visible[GPLOT_CURSOR_A] && !readout.visible[GPLOT_CURSOR_B]) {
+		gtk_widget_hide (plot->cursor_readout);
+		return;
+	}
+
+	readout.text = g_string_new (NULL);
+	for (guint i = 0; i < GPLOT_N_CURSORS; i++)
+		if (readout.visible[i])
+			g_string_append_printf (readout.text, "%c: %g  ", 'A' + i, readout.x[i]);
+	if (readout.visible[GPLOT_CURSOR_A] && readout.visible[GPLOT_CURSOR_B]) {
+		gdouble dx = readout.x[GPLOT_CURSOR_B] - readout.x[GPLOT_CURSOR_A];
+
+		g_string_append_printf (readout.text, "dX = %g", dx);
+		if (dx != 0.0)
+			g_string_append_printf (readout.text, "  1/dX = %g", 1.0 / dx);
+	}
+
+	gtk_tree_model_foreach (GTK_TREE_MODEL (plot->variables),
+	                        (GtkTreeModelForeachFunc)cursor_readout_add_trace, &readout);
+
+	gtk_label_set_text (GTK_LABEL (plot->cursor_readout), readout.text->str);
+	gtk_widget_show (plot->cursor_readout);
+	g_string_free (readout.text, TRUE);
+}
+
+static void plot_cursors_changed (GPlot *gplot, Plot *plot) { plot_update_cursor_readout (plot); }
+
+static void place_cursors (GtkMenuItem *menuitem, Plot *plot)
+{
+	g_plot_place_cursors (GPLOT (plot->plot));
+}
+
+static void hide_cursors (GtkMenuItem *menuitem, Plot *plot)
+{
+	for (guint i = 0; i < GPLOT_N_CURSORS; i++)
+		g_plot_set_cursor (GPLOT (plot->plot), i, FALSE, 0.0);
+}
+
+static void autoscale_toggled (GtkCheckMenuItem *menuitem, Plot *plot)
+{
+	g_plot_set_autoscale_y (GPLOT (plot->plot), gtk_check_menu_item_get_active (menuitem));
+}
+
 static GtkWidget *plot_window_create (Plot *plot)
 {
 	GtkTreeView *list;
-	GtkTreeStore *tree_model;
 	GtkCellRenderer *cell;
 	GtkTreeViewColumn *column;
 
@@ -351,6 +599,7 @@ static GtkWidget *plot_window_create (Plot *plot)
 	gtk_window_set_title (GTK_WINDOW (window), _ ("Oregano - Plot"));
 	gtk_container_set_border_width (GTK_CONTAINER (window), 0);
 	g_signal_connect (G_OBJECT (window), "delete-event", G_CALLBACK (delete_event_cb), plot);
+	g_signal_connect (G_OBJECT (window), "focus-in-event", G_CALLBACK (on_window_focus_in), plot);
 	accel_group = gtk_accel_group_new ();
 	gtk_window_add_accel_group (GTK_WINDOW (window), accel_group);
 
@@ -370,6 +619,7 @@ static GtkWidget *plot_window_create (Plot *plot)
 	outer_table = GTK_WIDGET (gtk_builder_get_object (gui, "plot_grid"));
 	plot_scrolled = plot->canvas = GTK_WIDGET (gtk_builder_get_object (gui, "plot_scrolled"));
 	plot->coord = GTK_WIDGET (gtk_builder_get_object (gui, "pos_label"));
+	plot->cursor_readout = GTK_WIDGET (gtk_builder_get_object (gui, "cursor_readout"));
 
 	plot->plot = g_plot_new ();
 
@@ -378,6 +628,8 @@ static GtkWidget *plot_window_create (Plot *plot)
 
 	g_signal_connect (G_OBJECT (plot->plot), "motion_notify_event",
 	                  G_CALLBACK (plot_canvas_movement), plot);
+	g_signal_connect (G_OBJECT (plot->plot), "cursors-changed",
+	                  G_CALLBACK (plot_cursors_changed), plot);
 
 	// Creation of the menubar
 	vbox = gtk_box_new (GTK_ORIENTATION_VERTICAL, 0);
@@ -392,6 +644,32 @@ static GtkWidget *plot_window_create (Plot *plot)
 	gtk_menu_shell_append (GTK_MENU_SHELL (menu), menuitem);
 	g_signal_connect (menuitem, "activate", G_CALLBACK (add_function), plot);
 	gtk_widget_show (menuitem);
+	menuitem = gtk_menu_item_new_with_label (_ ("Show Data"));
+	gtk_menu_shell_append (GTK_MENU_SHELL (menu), menuitem);
+	g_signal_connect (menuitem, "activate", G_CALLBACK (show_data), plot);
+	gtk_widget_show (menuitem);
+	menuitem = gtk_menu_item_new_with_label (_ ("Export Data..."));
+	gtk_menu_shell_append (GTK_MENU_SHELL (menu), menuitem);
+	g_signal_connect (menuitem, "activate", G_CALLBACK (export_data), plot);
+	gtk_widget_show (menuitem);
+	menuitem = gtk_menu_item_new_with_label (_ ("Compare With..."));
+	gtk_menu_shell_append (GTK_MENU_SHELL (menu), menuitem);
+	g_signal_connect (menuitem, "activate", G_CALLBACK (compare_with), plot);
+	gtk_widget_show (menuitem);
+	menuitem = gtk_menu_item_new_with_label (_ ("Place Cursors"));
+	gtk_menu_shell_append (GTK_MENU_SHELL (menu), menuitem);
+	g_signal_connect (menuitem, "activate", G_CALLBACK (place_cursors), plot);
+	gtk_widget_show (menuitem);
+	menuitem = gtk_menu_item_new_with_label (_ ("Hide Cursors"));
+	gtk_menu_shell_append (GTK_MENU_SHELL (menu), menuitem);
+	g_signal_connect (menuitem, "activate", G_CALLBACK (hide_cursors), plot);
+	gtk_widget_show (menuitem);
+	menuitem = gtk_check_menu_item_new_with_label (_ ("Autoscale Y Axis"));
+	gtk_check_menu_item_set_active (GTK_CHECK_MENU_ITEM (menuitem), TRUE);
+	g_plot_set_autoscale_y (GPLOT (plot->plot), TRUE);
+	gtk_menu_shell_append (GTK_MENU_SHELL (menu), menuitem);
+	g_signal_connect (menuitem, "toggled", G_CALLBACK (autoscale_toggled), plot);
+	gtk_widget_show (menuitem);
 	//add separator
 	menuitem = gtk_separator_menu_item_new ();
 	gtk_menu_shell_append (GTK_MENU_SHELL (menu), menuitem);
@@ -420,28 +698,44 @@ static GtkWidget *plot_window_create (Plot *plot)
 	g_signal_connect (G_OBJECT (button), "clicked", G_CALLBACK (destroy_window), plot);
 
 	list = GTK_TREE_VIEW (gtk_builder_get_object (gui, "variable_list"));
-	tree_model = gtk_tree_store_new (5, G_TYPE_BOOLEAN, G_TYPE_STRING, G_TYPE_BOOLEAN,
-	                                 G_TYPE_STRING, G_TYPE_POINTER);
+	plot->variables = gtk_tree_store_new (VARIABLE_N_COLUMNS, G_TYPE_BOOLEAN, G_TYPE_STRING,
+	                                      G_TYPE_BOOLEAN, G_TYPE_STRING, G_TYPE_POINTER, G_TYPE_INT,
+	                                      G_TYPE_INT);
+	plot->variables_filter = gtk_tree_model_filter_new (GTK_TREE_MODEL (plot->variables), NULL);
+	gtk_tree_model_filter_set_visible_func (GTK_TREE_MODEL_FILTER (plot->variables_filter),
+	                                        (GtkTreeModelFilterVisibleFunc)variable_visible_func,
+	                                        plot, NULL);
+
+	w = GTK_WIDGET (gtk_builder_get_object (gui, "variable_search"));
+	g_signal_connect (G_OBJECT (w), "search-changed", G_CALLBACK (on_variable_search_changed),
+	                  plot);
 
 	// One Column with 2 CellRenderer. First the Toggle and next a Text
 	column = gtk_tree_view_column_new ();
+	// all rows have the same height, so the view only has to measure the
+	// rows it actually shows
+	gtk_tree_view_column_set_sizing (column, GTK_TREE_VIEW_COLUMN_FIXED);
+	gtk_tree_view_column_set_fixed_width (column, 180);
 
 	cell = gtk_cell_renderer_toggle_new ();
 	g_signal_connect (G_OBJECT (cell), "toggled", G_CALLBACK (on_plot_selected), plot);
 	gtk_tree_view_column_pack_start (column, cell, FALSE);
-	gtk_tree_view_column_set_attributes (column, cell, "active", 0, "visible", 2, NULL);
+	gtk_tree_view_column_set_attributes (column, cell, "active", VARIABLE_VISIBLE, "visible",
+	                                     VARIABLE_TOGGLEABLE, NULL);
 
 	cell = gtk_cell_renderer_text_new ();
 	gtk_tree_view_column_pack_start (column, cell, FALSE);
-	gtk_tree_view_column_set_attributes (column, cell, "text", 1, NULL);
+	gtk_tree_view_column_set_attributes (column, cell, "text", VARIABLE_NAME, NULL);
 
 	cell = gtk_cell_renderer_text_new ();
 	gtk_tree_view_column_pack_start (column, cell, FALSE);
 	gtk_cell_renderer_set_fixed_size (cell, 20, 20);
-	gtk_tree_view_column_set_attributes (column, cell, "background", 3, NULL);
+	gtk_tree_view_column_set_attributes (column, cell, "background", VARIABLE_COLOR, NULL);
 
 	gtk_tree_view_append_column (list, column);
-	gtk_tree_view_set_model (list, GTK_TREE_MODEL (tree_model));
+	gtk_tree_view_set_fixed_height_mode (list, TRUE);
+	gtk_tree_view_set_enable_search (list, FALSE);
+	gtk_tree_view_set_model (list, plot->variables_filter);
 
 	g_object_set_data (G_OBJECT (window), "clist", list);
 
@@ -462,7 +756,13 @@ static GtkWidget *plot_window_create (Plot *plot)
 	return window;
 }
 
-int plot_show (OreganoEngine *engine)
+int plot_show (OreganoEngine *engine) { return plot_show_window (engine) != NULL; }
+
+/**
+ * Like plot_show, but returns the new window, NULL if there is nothing
+ * to plot.
+ */
+GtkWidget *plot_show_window (OreganoEngine *engine)
 {
 	GList *analysis = NULL;
 	GList *analysis_backup = NULL;
@@ -473,7 +773,7 @@ int plot_show (OreganoEngine *engine)
 	SimulationData *sdat = NULL;
 	gboolean abort = TRUE;
 
-	g_return_val_if_fail (engine != NULL, FALSE);
+	g_return_val_if_fail (engine != NULL, NULL);
 
 	// Get the analysis we have
 	analysis = analysis_backup = oregano_engine_get_results (engine);
@@ -486,7 +786,7 @@ int plot_show (OreganoEngine *engine)
 	}
 
 	if (abort)
-		return FALSE;
+		return NULL;
 
 	plot = g_new0 (Plot, 1);
 
@@ -530,7 +830,7 @@ int plot_show (OreganoEngine *engine)
 
 	analysis_selected ((plot->combo_box), plot);
 
-	return TRUE;
+	return plot->window;
 }
 
 static GPlotFunction *create_plot_function_from_data (SimulationFunction *func,
@@ -592,27 +892,28 @@ static void close_window (GtkMenuItem *menuitem, Plot *plot)
 
 static void add_function (GtkMenuItem *menuitem, Plot *plot)
 {
-	GtkTreeView *tree;
-	GtkTreeModel *model;
+	GtkTreeModel *model = GTK_TREE_MODEL (plot->variables);
 	GtkTreeIter iter;
 	GtkTreePath *path;
 	GList *lst;
 	gchar *color;
 
-	plot_add_function_show (plot->sim, plot->current);
+	if (plot->current == NULL || !plot_results_available (plot))
+		return;
 
-	tree = GTK_TREE_VIEW (g_object_get_data (G_OBJECT (plot->window), "clist"));
-	model = gtk_tree_view_get_model (tree);
+	plot_add_function_show (plot->sim, plot->current);
 
 	path = gtk_tree_path_new_from_string ("1");
 	gtk_tree_model_get_iter (model, &iter, path);
 	gtk_tree_path_free (path);
 
-	gtk_tree_store_remove (GTK_TREE_STORE (model), &iter);
+	gtk_tree_store_remove (plot->variables, &iter);
 
-	gtk_tree_store_append (GTK_TREE_STORE (model), &iter, NULL);
-	gtk_tree_store_set (GTK_TREE_STORE (model), &iter, 0, FALSE, 1, _ ("Functions"), 2, FALSE, 3,
-	                    "white", -1);
+	// a comparison may follow, "Functions" stays the second row
+	gtk_tree_store_insert (plot->variables, &iter, NULL, 1);
+	gtk_tree_store_set (plot->variables, &iter, VARIABLE_VISIBLE, FALSE, VARIABLE_NAME,
+	                    _ ("Functions"), VARIABLE_TOGGLEABLE, FALSE, VARIABLE_COLOR, "white",
+	                    VARIABLE_DATA_COLUMN, -1, -1);
 
 	lst = plot->current->functions;
 	while (lst) {
@@ -643,13 +944,401 @@ static void add_function (GtkMenuItem *menuitem, Plot *plot)
 
 		g_plot_add_function (GPLOT (plot->plot), f);
 
-		gtk_tree_store_append (GTK_TREE_STORE (model), &child, &iter);
-		gtk_tree_store_set (GTK_TREE_STORE (model), &child, 0, TRUE, 1, str, 2, TRUE, 3, color, 4,
-		                    f, -1);
+		gtk_tree_store_append (plot->variables, &child, &iter);
+		gtk_tree_store_set (plot->variables, &child, VARIABLE_VISIBLE, TRUE, VARIABLE_NAME, str,
+		                    VARIABLE_TOGGLEABLE, TRUE, VARIABLE_COLOR, color, VARIABLE_FUNCTION, f,
+		                    VARIABLE_DATA_COLUMN, -1, -1);
 
 		lst = lst->next;
 	}
 	g_list_free_full (lst, g_object_unref);
 
+	plot_update_cursor_readout (plot);
 	gtk_widget_queue_draw (plot->plot);
 }
+
+static void show_data_cell (GtkTreeViewColumn *column, GtkCellRenderer *cell, GtkTreeModel *model,
+                            GtkTreeIter *iter, gpointer index)
+{
+	gdouble value;
+	gchar buffer[32];
+
+	gtk_tree_model_get (model, iter, GPOINTER_TO_INT (index), &value, -1);
+	g_snprintf (buffer, sizeof(buffer), "%.6g", value);
+	g_object_set (cell, "text", buffer, NULL);
+}
+
+/**
+ * The x axis and the data columns of the variables that are shown,
+ * only the x axis if none is.
+ */
+static GArray *plot_get_shown_columns (Plot *plot)
+{
+	GtkTreeIter parent, iter;
+	GArray *columns;
+
+	columns = g_array_new (FALSE, FALSE, sizeof(guint));
+	guint x_column = 0;
+	g_array_append_val (columns, x_column);
+
+	if (gtk_tree_model_get_iter_first (GTK_TREE_MODEL (plot->variables), &parent) &&
+	    gtk_tree_model_iter_children (GTK_TREE_MODEL (plot->variables), &iter, &parent)) {
+		do {
+			gboolean visible;
+			gint column;
+
+			gtk_tree_model_get (GTK_TREE_MODEL (plot->variables), &iter, VARIABLE_VISIBLE,
+			                    &visible, VARIABLE_DATA_COLUMN, &column, -1);
+			if (visible && column > 0) {
+				guint data_column = column;
+				g_array_append_val (columns, data_column);
+			}
+		} while (gtk_tree_model_iter_next (GTK_TREE_MODEL (plot->variables), &iter));
+	}
+
+	return columns;
+}
+
+/**
+ * Shows the values of the current analysis as a table: the independent
+ * variable and all plotted variables, or every variable if nothing is
+ * plotted yet. The view reads the arrays of the simulation data through
+ * a SimDataModel, nothing is copied.
+ */
+static void show_data (GtkMenuItem *menuitem, Plot *plot)
+{
+	GArray *columns;
+	SimDataModel *model;
+	GtkWidget *window, *scrolled, *view;
+	gchar *analysis_name, *title;
+
+	if (plot->current == NULL || !plot_results_available (plot))
+		return;
+
+	columns = plot_get_shown_columns (plot);
+
+	if (columns->len > 1)
+		model = sim_data_model_new (plot->current, (guint *)columns->data, columns->len,
+		                            G_OBJECT (plot->sim));
+	else
+		model = sim_data_model_new (plot->current, NULL, 0, G_OBJECT (plot->sim));
+	g_array_free (columns, TRUE);
+
+	view = gtk_tree_view_new_with_model (GTK_TREE_MODEL (model));
+
+	for (gint i = 0; i < gtk_tree_model_get_n_columns (GTK_TREE_MODEL (model)); i++) {
+		GtkCellRenderer *cell = gtk_cell_renderer_text_new ();
+		GtkTreeViewColumn *column = gtk_tree_view_column_new ();
+		guint data_column = sim_data_model_get_data_column (model, i);
+
+		g_object_set (cell, "xalign", 1.0, NULL);
+		gtk_tree_view_column_set_title (column, plot->current->var_names[data_column]);
+		gtk_tree_view_column_pack_start (column, cell, TRUE);
+		gtk_tree_view_column_set_cell_data_func (column, cell, show_data_cell,
+		                                         GINT_TO_POINTER (i), NULL);
+		gtk_tree_view_column_set_sizing (column, GTK_TREE_VIEW_COLUMN_FIXED);
+		gtk_tree_view_column_set_fixed_width (column, 110);
+		gtk_tree_view_column_set_resizable (column, TRUE);
+		gtk_tree_view_append_column (GTK_TREE_VIEW (view), column);
+	}
+	gtk_tree_view_set_fixed_height_mode (GTK_TREE_VIEW (view), TRUE);
+	g_object_unref (model);
+	gtk_tree_view_set_grid_lines (GTK_TREE_VIEW (view), GTK_TREE_VIEW_GRID_LINES_BOTH);
+
+	analysis_name = oregano_engine_get_analysis_name (plot->current);
+	title = g_strdup_printf (_ ("Data - %s"), analysis_name);
+	window = gtk_window_new (GTK_WINDOW_TOPLEVEL);
+	gtk_window_set_title (GTK_WINDOW (window), title);
+	gtk_window_set_default_size (GTK_WINDOW (window), 500, 600);
+	gtk_window_set_transient_for (GTK_WINDOW (window), GTK_WINDOW (plot->window));
+	g_free (title);
+	g_free (analysis_name);
+
+	scrolled = gtk_scrolled_window_new (NULL, NULL);
+	gtk_container_add (GTK_CONTAINER (scrolled), view);
+	gtk_container_add (GTK_CONTAINER (window), scrolled);
+	gtk_widget_show_all (window);
+}
+
+static GtkFileFilter *export_filter_new (const gchar *name, const gchar *pattern)
+{
+	GtkFileFilter *filter = gtk_file_filter_new ();
+
+	gtk_file_filter_set_name (filter, name);
+	gtk_file_filter_add_pattern (filter, pattern);
+	// the extension a name without one gets
+	g_object_set_data_full (G_OBJECT (filter), "extension", g_strdup (pattern + 1), g_free);
+	return filter;
+}
+
+/**
+ * Writes the shown variables, or all of them, to a file for other
+ * programs. The format follows the extension of the file name.
+ */
+static void export_data (GtkMenuItem *menuitem, Plot *plot)
+{
+	GtkWidget *dialog, *only_shown;
+	GArray *columns;
+
+	if (plot->current == NULL || !plot_results_available (plot))
+		return;
+
+	dialog = gtk_file_chooser_dialog_new (_ ("Export Data"), GTK_WINDOW (plot->window),
+	                                      GTK_FILE_CHOOSER_ACTION_SAVE, _ ("_Cancel"),
+	                                      GTK_RESPONSE_CANCEL, _ ("_Export"), GTK_RESPONSE_ACCEPT,
+	                                      NULL);
+	gtk_file_chooser_set_local_only (GTK_FILE_CHOOSER (dialog), TRUE);
+	gtk_file_chooser_set_do_overwrite_confirmation (GTK_FILE_CHOOSER (dialog), TRUE);
+	gtk_file_chooser_add_filter (GTK_FILE_CHOOSER (dialog),
+	                             export_filter_new (_ ("Comma separated values (*.csv)"), "*.csv"));
+	gtk_file_chooser_add_filter (GTK_FILE_CHOOSER (dialog),
+	                             export_filter_new (_ ("Tab separated values (*.tsv)"), "*.tsv"));
+	gtk_file_chooser_add_filter (GTK_FILE_CHOOSER (dialog),
+	                             export_filter_new (_ ("Binary columns (*.oregcol)"), "*.oregcol"));
+
+	columns = plot_get_shown_columns (plot);
+	only_shown = gtk_check_button_new_with_label (_ ("Only the variables that are shown"));
+	gtk_toggle_button_set_active (GTK_TOGGLE_BUTTON (only_shown), columns->len > 1);
+	gtk_widget_set_sensitive (only_shown, columns->len > 1);
+	gtk_file_chooser_set_extra_widget (GTK_FILE_CHOOSER (dialog), only_shown);
+
+	if (gtk_dialog_run (GTK_DIALOG (dialog)) == GTK_RESPONSE_ACCEPT) {
+		gchar *filename = gtk_file_chooser_get_filename (GTK_FILE_CHOOSER (dialog));
+		GtkFileFilter *filter = gtk_file_chooser_get_filter (GTK_FILE_CHOOSER (dialog));
+		gboolean all = !gtk_toggle_button_get_active (GTK_TOGGLE_BUTTON (only_shown));
+		gchar *basename = g_path_get_basename (filename);
+		GError *e = NULL;
+
+		if (filter && strchr (basename, '.') == NULL) {
+			gchar *tmp = filename;
+			filename =
+			    g_strconcat (tmp, g_object_get_data (G_OBJECT (filter), "extension"), NULL);
+			g_free (tmp);
+		}
+		g_free (basename);
+
+		if (!sim_data_export (plot->current, all ? NULL : (guint *)columns->data,
+		                      all ? 0 : columns->len,
+		                      sim_data_export_format_from_filename (filename), filename, &e)) {
+			oregano_error_with_title (_ ("Could not export the data."), e->message);
+			g_clear_error (&e);
+		}
+		g_free (filename);
+	}
+
+	gtk_widget_destroy (dialog);
+	g_array_free (columns, TRUE);
+}
+
+/**
+ * Stops a running comparison and drops the finished one. The rows and
+ * plot functions of the comparison are left alone.
+ */
+static void plot_comparison_forget (Plot *plot)
+{
+	if (plot->comparison_cancellable) {
+		g_cancellable_cancel (plot->comparison_cancellable);
+		g_clear_object (&plot->comparison_cancellable);
+	}
+	g_clear_pointer (&plot->comparison, sim_compare_result_free);
+	g_clear_pointer (&plot->comparison_label, g_free);
+}
+
+static gboolean plot_comparison_find_parent (Plot *plot, GtkTreeIter *parent)
+{
+	GtkTreeModel *model = GTK_TREE_MODEL (plot->variables);
+	gint compare;
+
+	if (!gtk_tree_model_get_iter_first (model, parent))
+		return FALSE;
+	do {
+		gtk_tree_model_get (model, parent, VARIABLE_COMPARE_TRACE, &compare, -1);
+		if (compare < 0)
+			return TRUE;
+	} while (gtk_tree_model_iter_next (model, parent));
+
+	return FALSE;
+}
+
+static void plot_comparison_remove_rows (Plot *plot)
+{
+	GtkTreeModel *model = GTK_TREE_MODEL (plot->variables);
+	GtkTreeIter parent, iter;
+
+	if (!plot_comparison_find_parent (plot, &parent))
+		return;
+
+	if (gtk_tree_model_iter_children (model, &iter, &parent)) {
+		do {
+			GPlotFunction *f;
+
+			gtk_tree_model_get (model, &iter, VARIABLE_FUNCTION, &f, -1);
+			if (f != NULL)
+				g_plot_remove_function (GPLOT (plot->plot), f);
+		} while (gtk_tree_model_iter_next (model, &iter));
+	}
+	gtk_tree_store_remove (plot->variables, &parent);
+}
+
+static void plot_comparison_add_rows (Plot *plot)
+{
+	GtkTreeView *list = GTK_TREE_VIEW (g_object_get_data (G_OBJECT (plot->window), "clist"));
+	GtkTreeIter parent;
+	gchar *name;
+
+	name = g_strdup_printf (_ ("Compared with %s"), plot->comparison_label);
+	gtk_tree_store_append (plot->variables, &parent, NULL);
+	gtk_tree_store_set (plot->variables, &parent, VARIABLE_VISIBLE, FALSE, VARIABLE_NAME, name,
+	                    VARIABLE_TOGGLEABLE, FALSE, VARIABLE_COLOR, "white",
+	                    VARIABLE_DATA_COLUMN, -1, VARIABLE_COMPARE_TRACE, -1, -1);
+	g_free (name);
+
+	g_object_ref (plot->variables_filter);
+	gtk_tree_view_set_model (list, NULL);
+
+	for (guint i = 0; i < plot->comparison->traces->len; i++) {
+		SimCompareTrace *trace = g_ptr_array_index (plot->comparison->traces, i);
+		GtkTreeIter iter;
+
+		name = g_strdup_printf (_ ("%s (other run)"), trace->name);
+		gtk_tree_store_insert_with_values (plot->variables, &iter, &parent, -1, VARIABLE_VISIBLE,
+		                                   FALSE, VARIABLE_NAME, name, VARIABLE_TOGGLEABLE, TRUE,
+		                                   VARIABLE_DATA_COLUMN, -1, VARIABLE_COMPARE_TRACE,
+		                                   2 * i + 1, -1);
+		g_free (name);
+
+		name = g_strdup_printf (_ ("%s difference (max %.3g at %.3g, rms %.3g)"), trace->name,
+		                        trace->max_abs, trace->x_max_abs, trace->rms);
+		gtk_tree_store_insert_with_values (plot->variables, &iter, &parent, -1, VARIABLE_VISIBLE,
+		                                   FALSE, VARIABLE_NAME, name, VARIABLE_TOGGLEABLE, TRUE,
+		                                   VARIABLE_DATA_COLUMN, -1, VARIABLE_COMPARE_TRACE,
+		                                   2 * i + 2, -1);
+		g_free (name);
+	}
+
+	gtk_tree_view_set_model (list, plot->variables_filter);
+	g_object_unref (plot->variables_filter);
+	gtk_tree_view_expand_all (list);
+}
+
+static void compare_done (GObject *source, GAsyncResult *res, gpointer user_data)
+{
+	GError *e = NULL;
+	SimCompareResult *result = sim_compare_finish (res, &e);
+	Plot *plot = user_data;
+
+	if (result == NULL) {
+		// canceled because the window was closed or the analysis
+		// changed, plot may be gone already
+		if (!g_error_matches (e, G_IO_ERROR, G_IO_ERROR_CANCELLED)) {
+			g_clear_object (&plot->comparison_cancellable);
+			oregano_warning_with_title (_ ("Could not compare the simulations."), e->message);
+		}
+		g_clear_error (&e);
+		return;
+	}
+
+	g_clear_object (&plot->comparison_cancellable);
+	plot_comparison_remove_rows (plot);
+	g_clear_pointer (&plot->comparison, sim_compare_result_free);
+	plot->comparison = result;
+	plot_comparison_add_rows (plot);
+
+	gtk_widget_queue_draw (plot->plot);
+}
+
+/**
+ * Compares plot->current with the analysis of the same kind of @other.
+ * The columns are copied before the comparison moves to a worker
+ * thread, so both runs only have to be in memory for that moment.
+ */
+static void plot_compare (Plot *plot, GObject *other, SimCompareInterpolation interpolation)
+{
+	SimulationData *sdat = NULL;
+	GError *e = NULL;
+
+	for (GList *iter = oregano_engine_get_results (OREGANO_ENGINE (other)); iter;
+	     iter = iter->next) {
+		if (SIM_DATA (iter->data)->type == plot->current->type) {
+			sdat = SIM_DATA (iter->data);
+			break;
+		}
+	}
+	if (sdat == NULL) {
+		oregano_warning (_ ("The other simulation has no results of this analysis."));
+		return;
+	}
+
+	result_manager_hold (other);
+	result_manager_hold (G_OBJECT (plot->sim));
+	if (!result_manager_ensure_loaded (other, &e)) {
+		oregano_warning_with_title (_ ("The simulation results are not available anymore."),
+		                            e->message);
+		g_clear_error (&e);
+	} else if (plot_results_available (plot)) {
+		if (plot->comparison_cancellable)
+			g_cancellable_cancel (plot->comparison_cancellable);
+		g_clear_object (&plot->comparison_cancellable);
+		plot->comparison_cancellable = g_cancellable_new ();
+		g_free (plot->comparison_label);
+		plot->comparison_label = g_strdup (result_manager_get_label (other));
+
+		sim_compare_async (plot->current, sdat, interpolation, plot->comparison_cancellable,
+		                   compare_done, plot);
+	}
+	result_manager_release (G_OBJECT (plot->sim));
+	result_manager_release (other);
+}
+
+static void compare_with (GtkMenuItem *menuitem, Plot *plot)
+{
+	GtkWidget *dialog, *content, *combo_box, *cubic;
+	GList *runs, *iter, *others = NULL;
+
+	if (plot->current == NULL)
+		return;
+
+	runs = result_manager_get_runs ();
+	for (iter = runs; iter; iter = iter->next)
+		if (iter->data != G_OBJECT (plot->sim))
+			others = g_list_append (others, iter->data);
+	g_list_free (runs);
+
+	if (others == NULL) {
+		oregano_warning (_ ("There is no other simulation to compare with. Change the circuit "
+		                    "and simulate again first."));
+		return;
+	}
+
+	dialog = gtk_dialog_new_with_buttons (
+	    _ ("Compare With"), GTK_WINDOW (plot->window),
+	    GTK_DIALOG_MODAL | GTK_DIALOG_DESTROY_WITH_PARENT, _ ("_Cancel"), GTK_RESPONSE_CANCEL,
+	    _ ("C_ompare"), GTK_RESPONSE_ACCEPT, NULL);
+	content = gtk_dialog_get_content_area (GTK_DIALOG (dialog));
+	gtk_container_set_border_width (GTK_CONTAINER (content), 6);
+	gtk_box_set_spacing (GTK_BOX (content), 6);
+
+	// most recently used first, usually the run before this one
+	combo_box = gtk_combo_box_text_new ();
+	for (iter = others; iter; iter = iter->next)
+		gtk_combo_box_text_append_text (GTK_COMBO_BOX_TEXT (combo_box),
+		                                result_manager_get_label (iter->data));
+	gtk_combo_box_set_active (GTK_COMBO_BOX (combo_box), 0);
+	gtk_box_pack_start (GTK_BOX (content), combo_box, FALSE, TRUE, 0);
+
+	cubic = gtk_check_button_new_with_label (_ ("Cubic interpolation"));
+	gtk_toggle_button_set_active (GTK_TOGGLE_BUTTON (cubic), TRUE);
+	gtk_box_pack_start (GTK_BOX (content), cubic, FALSE, TRUE, 0);
+
+	gtk_widget_show_all (dialog);
+	if (gtk_dialog_run (GTK_DIALOG (dialog)) == GTK_RESPONSE_ACCEPT) {
+		gint active = gtk_combo_box_get_active (GTK_COMBO_BOX (combo_box));
+		GObject *other = g_list_nth_data (others, MAX (active, 0));
+
+		plot_compare (plot, other,
+		              gtk_toggle_button_get_active (GTK_TOGGLE_BUTTON (cubic)) ? SIM_COMPARE_CUBIC
+		                                                                       : SIM_COMPARE_LINEAR);
+	}
+	gtk_widget_destroy (dialog);
+	g_list_free (others);
+}
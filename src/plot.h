@@ -36,5 +36,6 @@
 #include "engine.h"
 
 int plot_show (OreganoEngine *engine);
+GtkWidget *plot_show_window (OreganoEngine *engine);
 
 #endif
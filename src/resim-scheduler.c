@@ -0,0 +1,144 @@
+/*
+ * resim-scheduler.c
+ *
+ *
+ * Authors:
+ *  Michi <st101564@stud.uni-stuttgart.de>
+ *
+ * Web page: https://ahoi.io/project/oregano
+ *
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include "resim-scheduler.h"
+
+struct _ResimScheduler
+{
+	guint delay_ms;
+	ResimSchedulerRunFunc run;
+	gpointer user_data;
+
+	guint timeout_id;
+	// cancellable of the run in flight, NULL if there is none
+	GCancellable *cancellable;
+	// the delay passed while a run was in flight
+	gboolean pending;
+
+	ResimSchedulerStats stats;
+};
+
+static void resim_scheduler_start (ResimScheduler *scheduler)
+{
+	scheduler->pending = FALSE;
+	scheduler->cancellable = g_cancellable_new ();
+	scheduler->stats.started++;
+
+	scheduler->run (scheduler->cancellable, scheduler->user_data);
+}
+
+static gboolean resim_scheduler_timeout (ResimScheduler *scheduler)
+{
+	scheduler->timeout_id = 0;
+
+	// wait for the stale run to go away first
+	if (scheduler->cancellable != NULL)
+		scheduler->pending = TRUE;
+	else
+		resim_scheduler_start (scheduler);
+
+	return G_SOURCE_REMOVE;
+}
+
+ResimScheduler *resim_scheduler_new (guint delay_ms, ResimSchedulerRunFunc run, gpointer user_data)
+{
+	ResimScheduler *scheduler;
+
+	g_return_val_if_fail (run != NULL, NULL);
+
+	scheduler = g_new0 (ResimScheduler, 1);
+	scheduler->delay_ms = delay_ms;
+	scheduler->run = run;
+	scheduler->user_data = user_data;
+
+	return scheduler;
+}
+
+void resim_scheduler_free (ResimScheduler *scheduler)
+{
+	g_return_if_fail (scheduler != NULL);
+
+	if (scheduler->timeout_id != 0)
+		g_source_remove (scheduler->timeout_id);
+	if (scheduler->cancellable != NULL) {
+		g_cancellable_cancel (scheduler->cancellable);
+		g_object_unref (scheduler->cancellable);
+	}
+	g_free (scheduler);
+}
+
+void resim_scheduler_touch (ResimScheduler *scheduler)
+{
+	g_return_if_fail (scheduler != NULL);
+
+	scheduler->stats.requested++;
+
+	if (scheduler->cancellable != NULL)
+		g_cancellable_cancel (scheduler->cancellable);
+
+	// the waiting run is replaced by a newer one
+	if (scheduler->timeout_id != 0) {
+		g_source_remove (scheduler->timeout_id);
+		scheduler->stats.coalesced++;
+	} else if (scheduler->pending) {
+		scheduler->pending = FALSE;
+		scheduler->stats.coalesced++;
+	}
+
+	scheduler->timeout_id =
+	    g_timeout_add (scheduler->delay_ms, (GSourceFunc)resim_scheduler_timeout, scheduler);
+}
+
+void resim_scheduler_run_done (ResimScheduler *scheduler, gboolean canceled)
+{
+	g_return_if_fail (scheduler != NULL);
+	g_return_if_fail (scheduler->cancellable != NULL);
+
+	// a run that ended on its own after it was canceled is stale all the same
+	if (canceled || g_cancellable_is_cancelled (scheduler->cancellable))
+		scheduler->stats.canceled++;
+	else
+		scheduler->stats.completed++;
+	g_clear_object (&scheduler->cancellable);
+
+	if (scheduler->pending)
+		resim_scheduler_start (scheduler);
+}
+
+gboolean resim_scheduler_is_running (const ResimScheduler *scheduler)
+{
+	g_return_val_if_fail (scheduler != NULL, FALSE);
+
+	return scheduler->cancellable != NULL;
+}
+
+void resim_scheduler_get_stats (const ResimScheduler *scheduler, ResimSchedulerStats *stats)
+{
+	g_return_if_fail (scheduler != NULL);
+	g_return_if_fail (stats != NULL);
+
+	*stats = scheduler->stats;
+}
@@ -0,0 +1,72 @@
+/*
+ * resim-scheduler.h
+ *
+ *
+ * Authors:
+ *  Michi <st101564@stud.uni-stuttgart.de>
+ *
+ * Web page: https://ahoi.io/project/oregano
+ *
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef RESIM_SCHEDULER_H_
+#define RESIM_SCHEDULER_H_
+
+#include <gio/gio.h>
+
+/**
+ * Decides when to simulate again while the schematic is edited.
+ *
+ * Every edit is reported with resim_scheduler_touch (). A burst of edits
+ * only leads to one run, started when no edit came in for the delay.
+ * An edit makes the run in flight stale, so its cancellable is canceled
+ * right away (the engine is stopped through oregano_engine_run_async).
+ * The next run is not started before the owner reported the end of the
+ * stale one, so there is never more than one run in flight and at most
+ * one waiting, which is always the newest.
+ *
+ * Lives in the main loop, like the engines.
+ */
+
+typedef struct _ResimScheduler ResimScheduler;
+
+typedef struct
+{
+	// edits reported
+	guint requested;
+	// edits that did not lead to a run of their own
+	guint coalesced;
+	guint started;
+	guint completed;
+	guint canceled;
+} ResimSchedulerStats;
+
+// Starts a run, which has to end with resim_scheduler_run_done ().
+typedef void (*ResimSchedulerRunFunc) (GCancellable *cancellable, gpointer user_data);
+
+ResimScheduler *resim_scheduler_new (guint delay_ms, ResimSchedulerRunFunc run, gpointer user_data);
+// Cancels the run in flight, its end need not be reported anymore.
+void resim_scheduler_free (ResimScheduler *scheduler);
+
+void resim_scheduler_touch (ResimScheduler *scheduler);
+void resim_scheduler_run_done (ResimScheduler *scheduler, gboolean canceled);
+
+gboolean resim_scheduler_is_running (const ResimScheduler *scheduler);
+void resim_scheduler_get_stats (const ResimScheduler *scheduler, ResimSchedulerStats *stats);
+
+#endif /* RESIM_SCHEDULER_H_ */
@@ -0,0 +1,404 @@
+/*
+ * result-manager.c
+ *
+ *
+ * Authors:
+ *  Michi <st101564@stud.uni-stuttgart.de>
+ *
+ * Web page: https://ahoi.io/project/oregano
+ *
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include <glib.h>
+#include <glib/gi18n.h>
+#include <glib/gstdio.h>
+
+#include "result-manager.h"
+#include "sim-data-file.h"
+#include "simulation.h"
+#include "errors.h"
+#include "mem-stats.h"
+#include "debug.h"
+
+typedef struct
+{
+	// weak reference
+	GObject *owner;
+	// owned by owner
+	GList *analyses;
+	gchar *label;
+	// size of the analyses while they are resident
+	guint64 bytes;
+	ResultState state;
+	// written once, the columns never change afterwards
+	gchar *spill_filename;
+	gboolean spill_failed;
+	// held runs are not evicted
+	guint holds;
+} ResultRun;
+
+static struct
+{
+	// ResultRun *, most recently used first
+	GQueue runs;
+	guint64 budget;
+	guint64 resident_bytes;
+	gchar *spill_directory;
+	// private directory of this process inside spill_directory
+	gchar *spill_run_directory;
+	guint next_id;
+} manager = {G_QUEUE_INIT, G_MAXUINT64, 0, NULL, NULL, 0};
+
+static void result_manager_enforce_budget (void);
+
+static GList *result_manager_find_link (GObject *owner)
+{
+	for (GList *iter = manager.runs.head; iter; iter = iter->next)
+		if (((ResultRun *)iter->data)->owner == owner)
+			return iter;
+	return NULL;
+}
+
+static ResultRun *result_manager_find (GObject *owner)
+{
+	GList *link = result_manager_find_link (owner);
+	return link ? link->data : NULL;
+}
+
+static void result_run_free (ResultRun *run)
+{
+	if (run->spill_filename) {
+		g_unlink (run->spill_filename);
+		g_free (run->spill_filename);
+	}
+	g_free (run->label);
+	g_free (run);
+}
+
+static void result_manager_owner_finalized (gpointer data, GObject *where_the_object_was)
+{
+	GList *link = result_manager_find_link (where_the_object_was);
+
+	g_return_if_fail (link != NULL);
+
+	ResultRun *run = link->data;
+	if (run->state == RESULT_RESIDENT)
+		manager.resident_bytes -= run->bytes;
+	mem_stats_add (MEM_STATS_SIM_DATA, -1, run->state == RESULT_RESIDENT ? -(gssize)run->bytes : 0);
+	g_queue_delete_link (&manager.runs, link);
+	result_run_free (run);
+}
+
+/**
+ * @bytes 0 means unlimited
+ */
+void result_manager_set_budget (guint64 bytes)
+{
+	manager.budget = bytes > 0 ? bytes : G_MAXUINT64;
+	result_manager_enforce_budget ();
+}
+
+guint64 result_manager_get_budget (void) { return manager.budget; }
+
+/**
+ * @directory where evicted runs are written to, NULL disables spilling
+ * and evicted runs are dropped
+ */
+void result_manager_set_spill_directory (const gchar *directory)
+{
+	g_free (manager.spill_directory);
+	manager.spill_directory = g_strdup (directory);
+}
+
+static gsize result_manager_get_analyses_size (GList *analyses)
+{
+	gsize bytes = 0;
+
+	for (GList *iter = analyses; iter; iter = iter->next)
+		bytes += sim_data_get_size (SIM_DATA (iter->data));
+	return bytes;
+}
+
+/**
+ * Starts tracking the @analyses of @owner. The run counts as the most
+ * recently used one.
+ */
+void result_manager_add (GObject *owner, GList *analyses, const gchar *label)
+{
+	g_return_if_fail (G_IS_OBJECT (owner));
+	g_return_if_fail (result_manager_find (owner) == NULL);
+
+	ResultRun *run = g_new0 (ResultRun, 1);
+	run->owner = owner;
+	run->analyses = analyses;
+	run->label = g_strdup (label);
+	run->bytes = result_manager_get_analyses_size (analyses);
+	run->state = RESULT_RESIDENT;
+
+	g_object_weak_ref (owner, result_manager_owner_finalized, NULL);
+	g_queue_push_head (&manager.runs, run);
+	manager.resident_bytes += run->bytes;
+	mem_stats_add (MEM_STATS_SIM_DATA, 1, run->bytes);
+
+	NG_DEBUG ("result manager: added \"%s\" with %" G_GUINT64_FORMAT " bytes", label, run->bytes);
+
+	result_manager_enforce_budget ();
+}
+
+/**
+ * Marks the run of @owner as the most recently used one.
+ */
+void result_manager_touch (GObject *owner)
+{
+	GList *link = result_manager_find_link (owner);
+
+	if (link == NULL || link == manager.runs.head)
+		return;
+	g_queue_unlink (&manager.runs, link);
+	g_queue_push_head_link (&manager.runs, link);
+}
+
+static gboolean result_manager_spill (ResultRun *run)
+{
+	GError *e = NULL;
+
+	if (run->spill_filename != NULL)
+		return TRUE;
+
+	if (manager.spill_run_directory == NULL) {
+		if (g_mkdir_with_parents (manager.spill_directory, 0700) != 0)
+			return FALSE;
+		gchar *template = g_build_filename (manager.spill_directory, "run-XXXXXX", NULL);
+		manager.spill_run_directory = g_mkdtemp (template);
+		if (manager.spill_run_directory == NULL) {
+			g_free (template);
+			return FALSE;
+		}
+	}
+
+	gchar *name = g_strdup_printf ("%u.ogres", manager.next_id++);
+	run->spill_filename = g_build_filename (manager.spill_run_directory, name, NULL);
+	g_free (name);
+
+	if (!sim_data_file_save (run->analyses, run->spill_filename, &e)) {
+		g_warning ("Could not spill simulation results: %s", e->message);
+		g_clear_error (&e);
+		g_clear_pointer (&run->spill_filename, g_free);
+		return FALSE;
+	}
+
+	return TRUE;
+}
+
+/**
+ * Releases the columns of @run, the rest of the analyses (names, units,
+ * functions) stays, so windows showing the run keep working.
+ */
+static void result_manager_evict (ResultRun *run)
+{
+	if (manager.spill_directory != NULL) {
+		if (!result_manager_spill (run)) {
+			// keep it rather than losing data because the disk is full
+			run->spill_failed = TRUE;
+			return;
+		}
+		run->state = RESULT_SPILLED;
+	} else {
+		run->state = RESULT_DROPPED;
+	}
+
+	for (GList *iter = run->analyses; iter; iter = iter->next) {
+		SimulationData *sdat = SIM_DATA (iter->data);
+		for (gint i = 0; i < sdat->n_variables; i++) {
+			g_array_free (sdat->data[i], TRUE);
+			sdat->data[i] = g_array_new (FALSE, FALSE, sizeof(gdouble));
+		}
+	}
+	manager.resident_bytes -= run->bytes;
+	mem_stats_add (MEM_STATS_SIM_DATA, 0, -(gssize)run->bytes);
+
+	NG_DEBUG ("result manager: evicted \"%s\", %" G_GUINT64_FORMAT " bytes resident", run->label,
+	          manager.resident_bytes);
+}
+
+/**
+ * Evicts runs from the least recently used end. The most recently used
+ * run always stays, even if it alone exceeds the budget.
+ */
+static void result_manager_enforce_budget (void)
+{
+	GList *iter = manager.runs.tail;
+
+	while (manager.resident_bytes > manager.budget && iter != NULL && iter != manager.runs.head) {
+		ResultRun *run = iter->data;
+		iter = iter->prev;
+
+		if (run->state == RESULT_RESIDENT && !run->spill_failed && run->holds == 0)
+			result_manager_evict (run);
+	}
+}
+
+static gboolean result_manager_reload (ResultRun *run, GError **error)
+{
+	GList *loaded = sim_data_file_load (run->spill_filename, error);
+	GList *a, *b;
+
+	if (loaded == NULL)
+		return FALSE;
+
+	for (a = run->analyses, b = loaded; a && b; a = a->next, b = b->next)
+		if (SIM_DATA (a->data)->n_variables != SIM_DATA (b->data)->n_variables)
+			break;
+	if (a != NULL || b != NULL) {
+		g_set_error (error, OREGANO_ERROR, OREGANO_RESULT_FILE_BAD_FORMAT,
+		             _ ("The spilled results in %s do not match the run"), run->spill_filename);
+		sim_data_file_free_analyses (loaded);
+		return FALSE;
+	}
+
+	// swap the columns in, the emptied arrays go away with the copy
+	for (a = run->analyses, b = loaded; a && b; a = a->next, b = b->next) {
+		GArray **data = SIM_DATA (a->data)->data;
+		SIM_DATA (a->data)->data = SIM_DATA (b->data)->data;
+		SIM_DATA (b->data)->data = data;
+	}
+	sim_data_file_free_analyses (loaded);
+
+	return TRUE;
+}
+
+/**
+ * Call before accessing the columns of a run. Marks the run as used and
+ * reads it back if it was spilled.
+ *
+ * @returns FALSE if the columns are not available (anymore)
+ */
+gboolean result_manager_ensure_loaded (GObject *owner, GError **error)
+{
+	ResultRun *run = result_manager_find (owner);
+
+	// not managed, so never evicted
+	if (run == NULL)
+		return TRUE;
+
+	result_manager_touch (owner);
+
+	switch (run->state) {
+	case RESULT_RESIDENT:
+		return TRUE;
+	case RESULT_DROPPED:
+		g_set_error (error, OREGANO_ERROR, OREGANO_RESULT_ERROR_DROPPED,
+		             _ ("The results of \"%s\" were released to stay within the memory budget"),
+		             run->label);
+		return FALSE;
+	case RESULT_SPILLED:
+		if (!result_manager_reload (run, error))
+			return FALSE;
+		run->state = RESULT_RESIDENT;
+		manager.resident_bytes += run->bytes;
+		mem_stats_add (MEM_STATS_SIM_DATA, 0, run->bytes);
+		result_manager_enforce_budget ();
+		return TRUE;
+	}
+
+	g_return_val_if_reached (FALSE);
+}
+
+/**
+ * Keeps the run of @owner in memory until result_manager_release, for
+ * code that needs the columns of several runs at the same time.
+ */
+void result_manager_hold (GObject *owner)
+{
+	ResultRun *run = result_manager_find (owner);
+
+	if (run != NULL)
+		run->holds++;
+}
+
+void result_manager_release (GObject *owner)
+{
+	ResultRun *run = result_manager_find (owner);
+
+	if (run == NULL)
+		return;
+	g_return_if_fail (run->holds > 0);
+	if (--run->holds == 0)
+		result_manager_enforce_budget ();
+}
+
+ResultState result_manager_get_state (GObject *owner)
+{
+	ResultRun *run = result_manager_find (owner);
+
+	g_return_val_if_fail (run != NULL, RESULT_DROPPED);
+	return run->state;
+}
+
+const gchar *result_manager_get_label (GObject *owner)
+{
+	ResultRun *run = result_manager_find (owner);
+
+	g_return_val_if_fail (run != NULL, NULL);
+	return run->label;
+}
+
+/**
+ * @returns the owners of all runs, most recently used first. Free the
+ * list with g_list_free.
+ */
+GList *result_manager_get_runs (void)
+{
+	GList *owners = NULL;
+
+	for (GList *iter = manager.runs.tail; iter; iter = iter->prev)
+		owners = g_list_prepend (owners, ((ResultRun *)iter->data)->owner);
+	return owners;
+}
+
+guint64 result_manager_get_resident_bytes (void) { return manager.resident_bytes; }
+
+guint64 result_manager_get_total_bytes (void)
+{
+	guint64 bytes = 0;
+
+	for (GList *iter = manager.runs.head; iter; iter = iter->next)
+		bytes += ((ResultRun *)iter->data)->bytes;
+	return bytes;
+}
+
+/**
+ * Stops tracking all runs and removes the spill files.
+ */
+void result_manager_shutdown (void)
+{
+	ResultRun *run;
+
+	while ((run = g_queue_pop_head (&manager.runs)) != NULL) {
+		g_object_weak_unref (run->owner, result_manager_owner_finalized, NULL);
+		mem_stats_add (MEM_STATS_SIM_DATA, -1,
+		               run->state == RESULT_RESIDENT ? -(gssize)run->bytes : 0);
+		result_run_free (run);
+	}
+	manager.resident_bytes = 0;
+
+	if (manager.spill_run_directory) {
+		g_rmdir (manager.spill_run_directory);
+		g_clear_pointer (&manager.spill_run_directory, g_free);
+	}
+}
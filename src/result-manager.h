@@ -0,0 +1,72 @@
+/*
+ * result-manager.h
+ *
+ *
+ * Authors:
+ *  Michi <st101564@stud.uni-stuttgart.de>
+ *
+ * Web page: https://ahoi.io/project/oregano
+ *
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef RESULT_MANAGER_H_
+#define RESULT_MANAGER_H_
+
+#include <glib-object.h>
+
+/**
+ * Keeps track of the results of all simulation runs of the session.
+ *
+ * A run is identified by the object owning its analyses (the engine).
+ * The manager does not own the results, it only watches the owner and
+ * forgets the run when the owner is finalized.
+ *
+ * If the columns of all runs together exceed the memory budget, the
+ * columns of the least recently used runs are released. With a spill
+ * directory they are written to a result file before and come back
+ * transparently on result_manager_ensure_loaded (), otherwise they are
+ * gone for good.
+ *
+ * Not thread safe, use it from the main loop only.
+ */
+
+typedef enum {
+	RESULT_RESIDENT = 0,
+	RESULT_SPILLED,
+	RESULT_DROPPED
+} ResultState;
+
+void result_manager_set_budget (guint64 bytes);
+guint64 result_manager_get_budget (void);
+void result_manager_set_spill_directory (const gchar *directory);
+
+void result_manager_add (GObject *owner, GList *analyses, const gchar *label);
+void result_manager_touch (GObject *owner);
+gboolean result_manager_ensure_loaded (GObject *owner, GError **error);
+void result_manager_hold (GObject *owner);
+void result_manager_release (GObject *owner);
+ResultState result_manager_get_state (GObject *owner);
+const gchar *result_manager_get_label (GObject *owner);
+GList *result_manager_get_runs (void);
+
+guint64 result_manager_get_resident_bytes (void);
+guint64 result_manager_get_total_bytes (void);
+
+void result_manager_shutdown (void);
+
+#endif /* RESULT_MANAGER_H_ */
@@ -0,0 +1,754 @@
+/*
+ * save-journal.c
+ *
+ *
+ * Authors:
+ *  Michi <st101564@stud.uni-stuttgart.de>
+ *
+ * Web page: https://ahoi.io/project/oregano
+ *
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+#include <glib.h>
+#include <glib/gi18n.h>
+#include <glib/gstdio.h>
+
+#include "save-journal.h"
+#include "save-schematic.h"
+#include "load-schematic.h"
+#include "oregano.h"
+#include "errors.h"
+#include "tools/task-scheduler.h"
+
+static const gchar magic[8] = "OREGJNL";
+
+#define HEADER_LENGTH (sizeof(magic) + 4 + 3 * 8)
+#define DIGEST_LENGTH 32
+
+typedef struct
+{
+	guint64 size;
+	guint64 mtime;
+	guint64 inode;
+} FileStamp;
+
+typedef struct _SaveJournalRewrite SaveJournalRewrite;
+
+struct _SaveJournal
+{
+	// the file the journal belongs to, NULL while there is none
+	gchar *filename;
+	FileStamp stamp;
+	// end of the last complete batch, 0 if the journal has to be started over
+	gsize length;
+	// number of items per key in the file and the journal together
+	GHashTable *saved;
+	// digest of everything but the items, see schematic_write_settings_key
+	gchar *settings;
+
+	Task *rewrite_task;
+	SaveJournalRewrite *rewrite;
+};
+
+struct _SaveJournalRewrite
+{
+	// NULL once the rewrite was finished
+	SaveJournal *journal;
+	SchematicWriter *writer;
+	gboolean success;
+	GError *error;
+};
+
+typedef struct
+{
+	const guint8 *data;
+	gsize length;
+	gsize position;
+	gboolean failed;
+} JournalReader;
+
+static gconstpointer reader_get (JournalReader *reader, gsize length)
+{
+	if (reader->failed || length > reader->length - reader->position) {
+		reader->failed = TRUE;
+		return NULL;
+	}
+	gconstpointer data = reader->data + reader->position;
+	reader->position += length;
+	return data;
+}
+
+static guint32 reader_get_u32 (JournalReader *reader)
+{
+	guint32 value;
+	gconstpointer data = reader_get (reader, sizeof(value));
+
+	if (data == NULL)
+		return 0;
+	memcpy (&value, data, sizeof(value));
+	return GUINT32_FROM_LE (value);
+}
+
+static guint64 reader_get_u64 (JournalReader *reader)
+{
+	guint64 value;
+	gconstpointer data = reader_get (reader, sizeof(value));
+
+	if (data == NULL)
+		return 0;
+	memcpy (&value, data, sizeof(value));
+	return GUINT64_FROM_LE (value);
+}
+
+static void put_u32 (GByteArray *buffer, guint32 value)
+{
+	value = GUINT32_TO_LE (value);
+	g_byte_array_append (buffer, (const guint8 *)&value, sizeof(value));
+}
+
+static void put_u64 (GByteArray *buffer, guint64 value)
+{
+	value = GUINT64_TO_LE (value);
+	g_byte_array_append (buffer, (const guint8 *)&value, sizeof(value));
+}
+
+static void put_record (GByteArray *buffer, SaveJournalRecord kind, gconstpointer payload,
+                        gsize length)
+{
+	put_u32 (buffer, kind);
+	put_u32 (buffer, length);
+	g_byte_array_append (buffer, payload, length);
+}
+
+static void get_digest (const guint8 *data, gsize length, guint8 digest[DIGEST_LENGTH])
+{
+	GChecksum *checksum = g_checksum_new (G_CHECKSUM_SHA256);
+	gsize digest_length = DIGEST_LENGTH;
+
+	g_checksum_update (checksum, data, length);
+	g_checksum_get_digest (checksum, digest, &digest_length);
+	g_checksum_free (checksum);
+}
+
+static gboolean get_file_stamp (const gchar *filename, FileStamp *stamp)
+{
+	GStatBuf st;
+
+	if (g_stat (filename, &st) != 0)
+		return FALSE;
+
+	stamp->size = st.st_size;
+	stamp->mtime = st.st_mtime;
+#ifdef G_OS_WIN32
+	stamp->inode = 0;
+#else
+	stamp->inode = st.st_ino;
+#endif
+	return TRUE;
+}
+
+static gboolean file_stamp_equal (const FileStamp *a, const FileStamp *b)
+{
+	return a->size == b->size && a->mtime == b->mtime && a->inode == b->inode;
+}
+
+static gchar *get_item_key (ItemData *data)
+{
+	GString *key = g_string_new (NULL);
+
+	schematic_write_item_key (data, key);
+	return g_string_free (key, FALSE);
+}
+
+static gchar *get_settings_digest (Schematic *sm)
+{
+	GString *key = g_string_new (NULL);
+	gchar *digest;
+
+	schematic_write_settings_key (sm, key);
+	digest = g_compute_checksum_for_data (G_CHECKSUM_SHA256, (const guchar *)key->str, key->len);
+	g_string_free (key, TRUE);
+
+	return digest;
+}
+
+static void add_by_key (GHashTable *table, gchar *key, ItemData *data)
+{
+	GPtrArray *same = g_hash_table_lookup (table, key);
+
+	if (same == NULL) {
+		same = g_ptr_array_new ();
+		g_hash_table_insert (table, key, same);
+	} else {
+		g_free (key);
+	}
+	g_ptr_array_add (same, data);
+}
+
+static GHashTable *new_key_table (void)
+{
+	return g_hash_table_new_full (g_str_hash, g_str_equal, g_free,
+	                              (GDestroyNotify)g_ptr_array_unref);
+}
+
+// key -> GPtrArray of the items of @sm with that key
+static GHashTable *get_items_by_key (Schematic *sm)
+{
+	GHashTable *items = new_key_table ();
+	GList *iter;
+
+	for (iter = schematic_get_items (sm); iter; iter = iter->next)
+		add_by_key (items, get_item_key (iter->data), iter->data);
+
+	return items;
+}
+
+// key -> number of items with that key
+static GHashTable *count_items (GHashTable *items)
+{
+	GHashTable *counts = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+	GHashTableIter iter;
+	gpointer key, value;
+
+	g_hash_table_iter_init (&iter, items);
+	while (g_hash_table_iter_next (&iter, &key, &value))
+		g_hash_table_insert (counts, g_strdup (key),
+		                     GUINT_TO_POINTER (((GPtrArray *)value)->len));
+
+	return counts;
+}
+
+static void save_journal_take_snapshot (SaveJournal *journal, Schematic *sm)
+{
+	GHashTable *items = get_items_by_key (sm);
+
+	g_clear_pointer (&journal->saved, g_hash_table_unref);
+	journal->saved = count_items (items);
+	g_hash_table_unref (items);
+
+	g_free (journal->settings);
+	journal->settings = get_settings_digest (sm);
+}
+
+static void save_journal_unbind (SaveJournal *journal)
+{
+	g_clear_pointer (&journal->filename, g_free);
+	g_clear_pointer (&journal->saved, g_hash_table_unref);
+	g_clear_pointer (&journal->settings, g_free);
+	journal->length = 0;
+}
+
+static void remove_journal_file (const gchar *filename)
+{
+	gchar *journal_filename = save_journal_get_filename (filename);
+
+	if (g_unlink (journal_filename) != 0 && errno != ENOENT)
+		g_warning ("Could not remove %s: %s", journal_filename, g_strerror (errno));
+	g_free (journal_filename);
+}
+
+/**
+ * Writes @data at @offset and drops whatever came after it, the rest of
+ * a batch that was not committed.
+ */
+static gboolean write_journal_file (const gchar *filename, gsize offset, GByteArray *data,
+                                    GError **error)
+{
+	gsize written = 0;
+	ssize_t n;
+	int fd, saved_errno = 0;
+
+	fd = g_open (filename, O_WRONLY | O_CREAT, 0666);
+	if (fd < 0) {
+		saved_errno = errno;
+	} else {
+		if (ftruncate (fd, offset) != 0 || lseek (fd, offset, SEEK_SET) < 0)
+			saved_errno = errno;
+
+		while (saved_errno == 0 && written < data->len) {
+			n = write (fd, data->data + written, data->len - written);
+			if (n < 0 && errno != EINTR)
+				saved_errno = errno;
+			else if (n > 0)
+				written += n;
+		}
+
+		if (saved_errno == 0 && fsync (fd) != 0)
+			saved_errno = errno;
+		close (fd);
+	}
+
+	if (saved_errno != 0) {
+		g_set_error (error, G_FILE_ERROR, g_file_error_from_errno (saved_errno),
+		             _ ("Could not write %s: %s"), filename, g_strerror (saved_errno));
+		return FALSE;
+	}
+	return TRUE;
+}
+
+/**
+ * Rewrite
+ */
+
+static void save_journal_rewrite_free (SaveJournalRewrite *rewrite)
+{
+	schematic_writer_free (rewrite->writer);
+	g_clear_error (&rewrite->error);
+	g_free (rewrite);
+}
+
+static void save_journal_rewrite_func (SaveJournalRewrite *rewrite, CancelInfo *cancel_info)
+{
+	rewrite->success = schematic_writer_write (rewrite->writer, &rewrite->error);
+}
+
+// Waits for the rewrite, the file contains everything of the journal then.
+static void save_journal_finish_rewrite (SaveJournal *journal)
+{
+	SaveJournalRewrite *rewrite = journal->rewrite;
+
+	if (rewrite == NULL)
+		return;
+
+	task_wait (journal->rewrite_task);
+	rewrite->journal = NULL;
+	journal->rewrite = NULL;
+
+	if (rewrite->success) {
+		remove_journal_file (journal->filename);
+		journal->length = 0;
+		if (!get_file_stamp (journal->filename, &journal->stamp))
+			save_journal_unbind (journal);
+	} else {
+		// the journal still belongs to the old file
+		g_warning ("Could not compact %s: %s", journal->filename, rewrite->error->message);
+	}
+
+	task_unref (journal->rewrite_task);
+	journal->rewrite_task = NULL;
+}
+
+static void save_journal_rewrite_done (SaveJournalRewrite *rewrite, gboolean canceled)
+{
+	if (rewrite->journal != NULL)
+		save_journal_finish_rewrite (rewrite->journal);
+}
+
+/**
+ * Replay
+ */
+
+typedef struct
+{
+	// key -> items of the file
+	GHashTable *loaded;
+	// key -> items of the journal that were not removed again
+	GHashTable *added;
+	// all items of the journal in order, owns them
+	GPtrArray *order;
+	// items of the journal that were removed again
+	GHashTable *canceled;
+	// items of the file to remove
+	GList *removed;
+	gboolean mismatch;
+} SaveJournalReplay;
+
+static void replay_remove (SaveJournalReplay *replay, const gchar *payload, gsize length)
+{
+	gchar *key = g_strndup (payload, length);
+	GPtrArray *same;
+
+	same = g_hash_table_lookup (replay->added, key);
+	if (same != NULL && same->len > 0) {
+		g_hash_table_add (replay->canceled, g_ptr_array_remove_index (same, same->len - 1));
+	} else {
+		same = g_hash_table_lookup (replay->loaded, key);
+		if (same != NULL && same->len > 0)
+			replay->removed =
+			    g_list_prepend (replay->removed, g_ptr_array_remove_index (same, same->len - 1));
+		else
+			replay->mismatch = TRUE;
+	}
+	g_free (key);
+}
+
+static void replay_add (SaveJournalReplay *replay, const gchar *payload, gsize length)
+{
+	GList *items, *iter;
+	GError *e = NULL;
+
+	items = schematic_parse_xml_items (payload, length, &e);
+	if (e) {
+		g_warning ("Could not read the journal: %s", e->message);
+		g_clear_error (&e);
+		return;
+	}
+
+	for (iter = items; iter; iter = iter->next) {
+		add_by_key (replay->added, get_item_key (iter->data), iter->data);
+		g_ptr_array_add (replay->order, iter->data);
+	}
+	g_list_free (items);
+}
+
+static void replay_batch (SaveJournalReplay *replay, const guint8 *data, gsize length)
+{
+	JournalReader reader = {data, length, 0, FALSE};
+	guint32 kind, size;
+	const gchar *payload;
+
+	while (reader.position < reader.length) {
+		kind = reader_get_u32 (&reader);
+		size = reader_get_u32 (&reader);
+		payload = reader_get (&reader, size);
+		if (reader.failed)
+			break;
+
+		if (kind == SAVE_JOURNAL_REMOVE)
+			replay_remove (replay, payload, size);
+		else if (kind == SAVE_JOURNAL_ADD)
+			replay_add (replay, payload, size);
+	}
+}
+
+/**
+ * Collects the committed batches first, so an item that was added and
+ * removed again never makes it to the schematic.
+ */
+static gboolean save_journal_apply (SaveJournal *journal, Schematic *sm, const guint8 *data,
+                                    gsize length, GError **error)
+{
+	JournalReader reader = {data, length, 0, FALSE};
+	SaveJournalReplay replay = {0};
+	FileStamp stamp;
+	gconstpointer header, payload;
+	guint8 digest[DIGEST_LENGTH];
+	gsize batch_start, record_start;
+	guint32 version, kind, size;
+	GList *iter;
+
+	header = reader_get (&reader, sizeof(magic));
+	version = reader_get_u32 (&reader);
+	stamp.size = reader_get_u64 (&reader);
+	stamp.mtime = reader_get_u64 (&reader);
+	stamp.inode = reader_get_u64 (&reader);
+
+	if (reader.failed || memcmp (header, magic, sizeof(magic)) != 0) {
+		g_set_error (error, OREGANO_ERROR, OREGANO_SCHEMATIC_BAD_FILE_FORMAT,
+		             _ ("The journal of %s is damaged."), journal->filename);
+		return FALSE;
+	}
+	if (version != SAVE_JOURNAL_VERSION) {
+		g_set_error (error, OREGANO_ERROR, OREGANO_SCHEMATIC_BAD_FILE_FORMAT,
+		             _ ("The journal of %s has the unknown version %u."), journal->filename,
+		             version);
+		return FALSE;
+	}
+	// left over from before the file was saved as a whole
+	if (!file_stamp_equal (&stamp, &journal->stamp))
+		return TRUE;
+
+	replay.loaded = get_items_by_key (sm);
+	replay.added = new_key_table ();
+	replay.order = g_ptr_array_new_with_free_func (g_object_unref);
+	replay.canceled = g_hash_table_new (NULL, NULL);
+
+	journal->length = HEADER_LENGTH;
+	batch_start = reader.position;
+	while (reader.position < reader.length) {
+		record_start = reader.position;
+		kind = reader_get_u32 (&reader);
+		size = reader_get_u32 (&reader);
+		payload = reader_get (&reader, size);
+		// the end of a batch that was not committed
+		if (reader.failed)
+			break;
+		if (kind != SAVE_JOURNAL_COMMIT)
+			continue;
+
+		get_digest (data + batch_start, record_start - batch_start, digest);
+		if (size != DIGEST_LENGTH || memcmp (payload, digest, DIGEST_LENGTH) != 0)
+			break;
+
+		replay_batch (&replay, data + batch_start, record_start - batch_start);
+		journal->length = reader.position;
+		batch_start = reader.position;
+	}
+
+	if (replay.mismatch)
+		g_warning ("The journal of %s removes items the file does not contain.",
+		           journal->filename);
+
+	for (iter = replay.removed; iter; iter = iter->next)
+		schematic_remove_item (sm, iter->data);
+
+	for (guint i = 0; i < replay.order->len; i++) {
+		ItemData *data = g_ptr_array_index (replay.order, i);
+
+		if (g_hash_table_contains (replay.canceled, data))
+			continue;
+		// takes over the reference
+		g_object_ref (data);
+		if (!schematic_add_item (sm, data))
+			g_object_unref (data);
+	}
+
+	g_list_free (replay.removed);
+	g_hash_table_unref (replay.canceled);
+	g_ptr_array_unref (replay.order);
+	g_hash_table_unref (replay.added);
+	g_hash_table_unref (replay.loaded);
+
+	return TRUE;
+}
+
+/**
+ * API
+ */
+
+SaveJournal *save_journal_new (void) { return g_new0 (SaveJournal, 1); }
+
+void save_journal_free (SaveJournal *journal)
+{
+	if (journal == NULL)
+		return;
+
+	save_journal_finish_rewrite (journal);
+	save_journal_unbind (journal);
+	g_free (journal);
+}
+
+gchar *save_journal_get_filename (const gchar *filename)
+{
+	return g_strconcat (filename, ".journal", NULL);
+}
+
+/**
+ * Applies the committed batches of the journal of @filename to @sm. A
+ * journal that was left behind by an older version of the file is
+ * ignored and started over by the next save.
+ */
+gboolean save_journal_replay (SaveJournal *journal, Schematic *sm, const gchar *filename,
+                              GError **error)
+{
+	gchar *journal_filename, *contents = NULL;
+	gsize length;
+	GError *e = NULL;
+	gboolean success = TRUE;
+
+	g_return_val_if_fail (journal != NULL, FALSE);
+	g_return_val_if_fail (IS_SCHEMATIC (sm), FALSE);
+	g_return_val_if_fail (filename != NULL, FALSE);
+
+	save_journal_finish_rewrite (journal);
+	save_journal_unbind (journal);
+
+	if (!get_file_stamp (filename, &journal->stamp))
+		return TRUE;
+	journal->filename = g_strdup (filename);
+
+	journal_filename = save_journal_get_filename (filename);
+	if (g_file_get_contents (journal_filename, &contents, &length, &e)) {
+		success = save_journal_apply (journal, sm, (const guint8 *)contents, length, error);
+		g_free (contents);
+	} else if (!g_error_matches (e, G_FILE_ERROR, G_FILE_ERROR_NOENT)) {
+		g_propagate_error (error, e);
+		e = NULL;
+		success = FALSE;
+	}
+	g_clear_error (&e);
+	g_free (journal_filename);
+
+	if (!success) {
+		// do not append to a journal that could not be read
+		save_journal_unbind (journal);
+		return FALSE;
+	}
+
+	save_journal_take_snapshot (journal, sm);
+	return TRUE;
+}
+
+/**
+ * Appends a batch with the items that were removed and added since the
+ * last save. Everything else has to be saved as a whole, and so does a
+ * file that was changed by someone else.
+ */
+gboolean save_journal_append (SaveJournal *journal, Schematic *sm, GError **error)
+{
+	GHashTable *current;
+	GHashTableIter iter;
+	GByteArray *batch;
+	GList *added = NULL;
+	GBytes *fragment;
+	FileStamp stamp;
+	gpointer key, value;
+	gchar *filename, *journal_filename, *settings;
+	guint8 digest[DIGEST_LENGTH];
+	gsize records_start;
+	guint i, n, saved;
+	gboolean success;
+
+	g_return_val_if_fail (journal != NULL, FALSE);
+	g_return_val_if_fail (IS_SCHEMATIC (sm), FALSE);
+
+	// a full save must not race the rewrite
+	save_journal_finish_rewrite (journal);
+
+	filename = schematic_get_filename (sm);
+	if (!oregano.incremental_save || journal->filename == NULL ||
+	    g_strcmp0 (filename, journal->filename) != 0)
+		return FALSE;
+
+	if (!get_file_stamp (filename, &stamp) || !file_stamp_equal (&stamp, &journal->stamp))
+		return FALSE;
+
+	settings = get_settings_digest (sm);
+	success = g_strcmp0 (settings, journal->settings) == 0;
+	g_free (settings);
+	if (!success)
+		return FALSE;
+
+	current = get_items_by_key (sm);
+	batch = g_byte_array_new ();
+	if (journal->length == 0) {
+		g_byte_array_append (batch, (const guint8 *)magic, sizeof(magic));
+		put_u32 (batch, SAVE_JOURNAL_VERSION);
+		put_u64 (batch, journal->stamp.size);
+		put_u64 (batch, journal->stamp.mtime);
+		put_u64 (batch, journal->stamp.inode);
+	}
+	records_start = batch->len;
+
+	g_hash_table_iter_init (&iter, journal->saved);
+	while (g_hash_table_iter_next (&iter, &key, &value)) {
+		GPtrArray *same = g_hash_table_lookup (current, key);
+
+		n = same ? same->len : 0;
+		for (i = n; i < GPOINTER_TO_UINT (value); i++)
+			put_record (batch, SAVE_JOURNAL_REMOVE, key, strlen (key));
+	}
+
+	g_hash_table_iter_init (&iter, current);
+	while (g_hash_table_iter_next (&iter, &key, &value)) {
+		GPtrArray *same = value;
+
+		saved = GPOINTER_TO_UINT (g_hash_table_lookup (journal->saved, key));
+		for (i = saved; i < same->len; i++)
+			added = g_list_prepend (added, g_ptr_array_index (same, i));
+	}
+
+	if (added != NULL) {
+		fragment = schematic_write_xml_items (added);
+		if (fragment != NULL) {
+			put_record (batch, SAVE_JOURNAL_ADD, g_bytes_get_data (fragment, NULL),
+			            g_bytes_get_size (fragment));
+			g_bytes_unref (fragment);
+		}
+		g_list_free (added);
+	}
+
+	success = TRUE;
+	if (batch->len > records_start) {
+		get_digest (batch->data + records_start, batch->len - records_start, digest);
+		put_record (batch, SAVE_JOURNAL_COMMIT, digest, DIGEST_LENGTH);
+
+		journal_filename = save_journal_get_filename (filename);
+		success = write_journal_file (journal_filename, journal->length, batch, error);
+		g_free (journal_filename);
+	}
+
+	if (success && batch->len > records_start) {
+		journal->length += batch->len;
+		g_hash_table_unref (journal->saved);
+		journal->saved = count_items (current);
+	}
+
+	g_byte_array_unref (batch);
+	g_hash_table_unref (current);
+
+	return success;
+}
+
+/**
+ * The file contains everything now, the journal starts over with the
+ * next save.
+ */
+void save_journal_reset (SaveJournal *journal, Schematic *sm)
+{
+	gchar *filename;
+
+	g_return_if_fail (journal != NULL);
+	g_return_if_fail (IS_SCHEMATIC (sm));
+
+	save_journal_finish_rewrite (journal);
+	save_journal_unbind (journal);
+
+	filename = schematic_get_filename (sm);
+	if (filename == NULL)
+		return;
+
+	remove_journal_file (filename);
+	if (!oregano.incremental_save || !get_file_stamp (filename, &journal->stamp))
+		return;
+
+	journal->filename = g_strdup (filename);
+	save_journal_take_snapshot (journal, sm);
+}
+
+void save_journal_compact_if_needed (SaveJournal *journal, Schematic *sm)
+{
+	SaveJournalRewrite *rewrite;
+	SchematicWriter *writer;
+	GError *e = NULL;
+	Task *task;
+
+	g_return_if_fail (journal != NULL);
+	g_return_if_fail (IS_SCHEMATIC (sm));
+
+	if (journal->rewrite != NULL || journal->filename == NULL)
+		return;
+	if (journal->length < MAX (SAVE_JOURNAL_COMPACT_SIZE, journal->stamp.size / 4))
+		return;
+
+	// the schematic is not touched by the worker
+	writer = schematic_writer_new (sm, journal->filename, &e);
+	if (writer == NULL) {
+		g_warning ("Could not compact %s: %s", journal->filename, e ? e->message : "");
+		g_clear_error (&e);
+		return;
+	}
+
+	rewrite = g_new0 (SaveJournalRewrite, 1);
+	rewrite->journal = journal;
+	rewrite->writer = writer;
+
+	task = task_new ((TaskFunc)save_journal_rewrite_func, rewrite,
+	                 (GDestroyNotify)save_journal_rewrite_free);
+	task_set_flags (task, TASK_FLAG_BLOCKING);
+	task_set_done_func (task, (TaskDoneFunc)save_journal_rewrite_done, NULL);
+
+	journal->rewrite = rewrite;
+	journal->rewrite_task = task_ref (task);
+	task_scheduler_submit (task_scheduler_get_default (), task);
+}
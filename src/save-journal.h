@@ -0,0 +1,87 @@
+/*
+ * save-journal.h
+ *
+ *
+ * Authors:
+ *  Michi <st101564@stud.uni-stuttgart.de>
+ *
+ * Web page: https://ahoi.io/project/oregano
+ *
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+
+#ifndef SAVE_JOURNAL_H_
+#define SAVE_JOURNAL_H_
+
+#include <glib.h>
+
+#include "schematic.h"
+
+/**
+ * Incremental saving for large schematics.
+ *
+ * Instead of rewriting the whole file, a save appends the items that
+ * were removed and added since the last save to <file>.journal. Loading
+ * replays it on top of the file. Once the journal gets too large, the
+ * file is rewritten on a worker thread and the journal starts over.
+ *
+ * Everything is little endian:
+ *
+ *   "OREGJNL" '\0'                               magic
+ *   u32 version
+ *   u64 size, u64 mtime, u64 inode of the file   the journal belongs to
+ *   records: u32 kind, u32 length, payload
+ *
+ * A save is a batch of records that ends with a COMMIT record, its
+ * payload is the SHA-256 of the records of the batch. Batches without
+ * a valid COMMIT (a crash while appending) are ignored and overwritten.
+ */
+
+#define SAVE_JOURNAL_VERSION 1
+
+// Rewrite the file when the journal reaches this size or a quarter of
+// the size of the file, whatever is larger.
+#define SAVE_JOURNAL_COMPACT_SIZE (1 << 20)
+
+typedef enum {
+	// payload: key of the removed item, see schematic_write_item_key
+	SAVE_JOURNAL_REMOVE = 1,
+	// payload: added items, see schematic_write_xml_items
+	SAVE_JOURNAL_ADD,
+	// payload: SHA-256 of the batch
+	SAVE_JOURNAL_COMMIT
+} SaveJournalRecord;
+
+typedef struct _SaveJournal SaveJournal;
+
+SaveJournal *save_journal_new (void);
+// Waits for a rewrite that is in progress.
+void save_journal_free (SaveJournal *journal);
+gchar *save_journal_get_filename (const gchar *filename);
+
+// After @sm was loaded from @filename.
+gboolean save_journal_replay (SaveJournal *journal, Schematic *sm, const gchar *filename,
+                              GError **error);
+// FALSE if the changes could not be appended, the caller saves the whole file then.
+gboolean save_journal_append (SaveJournal *journal, Schematic *sm, GError **error);
+// After the whole file was written.
+void save_journal_reset (SaveJournal *journal, Schematic *sm);
+// Rewrites the file in the background if the journal got too large.
+void save_journal_compact_if_needed (SaveJournal *journal, Schematic *sm);
+
+#endif /* SAVE_JOURNAL_H_ */
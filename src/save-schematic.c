@@ -34,6 +34,12 @@
  * Boston, MA 02110-1301, USA.
  */
 
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <glib/gi18n.h>
+#include <glib/gstdio.h>
+
 #include "xml-compat.h"
 #include "oregano.h"
 #include "schematic.h"
@@ -62,8 +68,19 @@ typedef struct
 	xmlNodePtr node_labels;  // For saving of labels.
 	xmlNodePtr node_wires;   // For saving of wires.
 	xmlNodePtr node_textboxes;
+
+	// Split wires at their nodes, like the files always did. Fragments
+	// keep every wire in one piece.
+	gboolean split_wires;
 } parseXmlContext;
 
+struct _SchematicWriter
+{
+	xmlDocPtr doc;
+	gchar *filename;
+	gboolean compress;
+};
+
 static void write_xml_sim_settings (xmlNodePtr cur, parseXmlContext *ctxt, Schematic *sm)
 {
 	xmlNodePtr sim_settings_node, child, analysis, options;
@@ -381,6 +398,13 @@ static void write_xml_wire (Wire *wire, parseXmlContext *ctxt)
 	wire_get_start_pos (wire, &start_pos);
 	wire_get_end_pos (wire, &end_pos);
 
+	if (!ctxt->split_wires) {
+		str = g_strdup_printf ("(%g %g)(%g %g)", start_pos.x, start_pos.y, end_pos.x, end_pos.y);
+		xmlNewChild (node_wire, ctxt->ns, BAD_CAST "points", BAD_CAST str);
+		g_free (str);
+		return;
+	}
+
 	Node *node;
 	Coords last, current, tmp;
 	GSList *iter, *copy;
@@ -446,26 +470,12 @@ static void write_xml_textbox (Textbox *textbox, parseXmlContext *ctxt)
 	xmlNewChild (node_textbox, ctxt->ns, BAD_CAST "text", BAD_CAST str);
 }
 
-// Create an XML subtree of doc equivalent to the given Schematic.
-static xmlNodePtr write_xml_schematic (parseXmlContext *ctxt, Schematic *sm, GError **error)
+// Everything of the Schematic but the items.
+static void write_xml_settings (xmlNodePtr cur, parseXmlContext *ctxt, Schematic *sm)
 {
-	xmlNodePtr cur;
 	xmlNodePtr grid;
-	xmlNsPtr ogo;
 	gchar *str;
 
-	cur = xmlNewDocNode (ctxt->doc, ctxt->ns, BAD_CAST "schematic", NULL);
-	if (cur == NULL) {
-		printf ("%s:%d NULL that shall be not NULL!\n", __FILE__, __LINE__);
-		return NULL;
-	}
-
-	if (ctxt->ns == NULL) {
-		ogo = xmlNewNs (cur, BAD_CAST "https://beerbach.me/project/oregano/ns/v1", BAD_CAST "ogo");
-		xmlSetNs (cur, ogo);
-		ctxt->ns = ogo;
-	}
-
 	// General information about the Schematic.
 	str = g_strdup_printf ("%s", schematic_get_author (sm));
 	xmlNewChild (cur, ctxt->ns, BAD_CAST "author",
@@ -494,6 +504,27 @@ static xmlNodePtr write_xml_schematic (parseXmlContext *ctxt, Schematic *sm, GEr
 
 	// Simulation settings.
 	write_xml_sim_settings (cur, ctxt, sm);
+}
+
+// Create an XML subtree of doc equivalent to the given Schematic.
+static xmlNodePtr write_xml_schematic (parseXmlContext *ctxt, Schematic *sm, GError **error)
+{
+	xmlNodePtr cur;
+	xmlNsPtr ogo;
+
+	cur = xmlNewDocNode (ctxt->doc, ctxt->ns, BAD_CAST "schematic", NULL);
+	if (cur == NULL) {
+		printf ("%s:%d NULL that shall be not NULL!\n", __FILE__, __LINE__);
+		return NULL;
+	}
+
+	if (ctxt->ns == NULL) {
+		ogo = xmlNewNs (cur, BAD_CAST "https://beerbach.me/project/oregano/ns/v1", BAD_CAST "ogo");
+		xmlSetNs (cur, ogo);
+		ctxt->ns = ogo;
+	}
+
+	write_xml_settings (cur, ctxt, sm);
 
 	// Parts.
 	ctxt->node_parts = xmlNewChild (cur, ctxt->ns, BAD_CAST "parts", NULL);
@@ -510,54 +541,251 @@ static xmlNodePtr write_xml_schematic (parseXmlContext *ctxt, Schematic *sm, GEr
 	return cur;
 }
 
-// schematic_write_xml
-//
-// Save a Sheet to an XML file.
-gboolean schematic_write_xml (Schematic *sm, GError **error)
+/**
+ * Builds the document of @sm for @filename right away. Writing it does
+ * not touch the schematic anymore and may happen on any thread.
+ */
+SchematicWriter *schematic_writer_new (Schematic *sm, const gchar *filename, GError **error)
 {
-	int ret = -1;
+	SchematicWriter *writer;
 	xmlDocPtr xml;
-	parseXmlContext ctxt;
+	parseXmlContext ctxt = {0};
 	GError *err = NULL;
 
-	g_return_val_if_fail (sm != NULL, FALSE);
+	g_return_val_if_fail (sm != NULL, NULL);
+	g_return_val_if_fail (filename != NULL, NULL);
 
 	// Create the tree.
 	xml = xmlNewDoc (BAD_CAST "1.0");
 	if (xml == NULL) {
-		return FALSE;
+		return NULL;
 	}
 
 	ctxt.ns = NULL;
 	ctxt.doc = xml;
+	ctxt.split_wires = TRUE;
 
 	xmlDocSetRootElement (xml, write_xml_schematic (&ctxt, sm, &err));
 
 	if (err) {
 		g_propagate_error (error, err);
-		return FALSE;
+		xmlFreeDoc (xml);
+		return NULL;
 	}
 
+	writer = g_new0 (SchematicWriter, 1);
+	writer->doc = xml;
+	writer->filename = g_strdup (filename);
+	writer->compress = oregano.compress_files;
+
+	return writer;
+}
+
+/**
+ * The document is written to a temporary file, flushed to the disk and
+ * renamed, so a crash leaves either the old or the new file behind.
+ */
+gboolean schematic_writer_write (SchematicWriter *writer, GError **error)
+{
+	gchar *tmp_filename;
+	int fd, saved_errno = 0;
+	gboolean success = TRUE;
+
+	g_return_val_if_fail (writer != NULL, FALSE);
+
+	tmp_filename = g_strconcat (writer->filename, ".tmp", NULL);
+
 	// Dump the tree.
-	xmlSetDocCompressMode (xml, oregano.compress_files ? 9 : 0);
-
-	{
-		char *s = schematic_get_filename (sm);
-		if (s != NULL) {
-			ret = xmlSaveFormatFile (s, xml, 1);
-		} else {
-			g_warning ("Schematic has no filename!!\n");
+	xmlSetDocCompressMode (writer->doc, writer->compress ? 9 : 0);
+
+	errno = 0;
+	if (xmlSaveFormatFile (tmp_filename, writer->doc, 1) < 0) {
+		saved_errno = errno ? errno : EIO;
+		success = FALSE;
+	}
+
+	if (success) {
+		fd = g_open (tmp_filename, O_RDONLY, 0);
+		if (fd < 0 || fsync (fd) != 0) {
+			saved_errno = errno;
+			success = FALSE;
 		}
+		if (fd >= 0)
+			close (fd);
 	}
 
-	if (xml != NULL) {
-		xmlFreeDoc (xml);
-	} else {
-		g_warning ("XML object is NULL\n");
+	if (success && g_rename (tmp_filename, writer->filename) != 0) {
+		saved_errno = errno;
+		success = FALSE;
+	}
+
+	if (!success) {
+		g_set_error (error, G_FILE_ERROR, g_file_error_from_errno (saved_errno),
+		             _ ("Could not write %s: %s"), writer->filename, g_strerror (saved_errno));
+		g_unlink (tmp_filename);
 	}
+	g_free (tmp_filename);
 
-	if (ret < 0)
+	return success;
+}
+
+void schematic_writer_free (SchematicWriter *writer)
+{
+	if (writer == NULL)
+		return;
+
+	xmlFreeDoc (writer->doc);
+	g_free (writer->filename);
+	g_free (writer);
+}
+
+// schematic_write_xml
+//
+// Save a Sheet to an XML file.
+gboolean schematic_write_xml (Schematic *sm, GError **error)
+{
+	SchematicWriter *writer;
+	gboolean success;
+	char *s;
+
+	g_return_val_if_fail (sm != NULL, FALSE);
+
+	s = schematic_get_filename (sm);
+	if (s == NULL) {
+		g_warning ("Schematic has no filename!!\n");
+		return FALSE;
+	}
+
+	writer = schematic_writer_new (sm, s, error);
+	if (writer == NULL)
 		return FALSE;
 
-	return TRUE;
+	success = schematic_writer_write (writer, error);
+	schematic_writer_free (writer);
+
+	return success;
+}
+
+static void append_key_property (Property *prop, GString *key)
+{
+	// Loading numbers the parts anew, see schematic_add_item.
+	if (g_ascii_strcasecmp (prop->name, "refdes") == 0)
+		return;
+
+	g_string_append_printf (key, "%s=%s\n", prop->name, prop->value);
+}
+
+static void append_key_label (PartLabel *label, GString *key)
+{
+	g_string_append_printf (key, "%s:%s (%g %g)\n", label->name, label->text, label->pos.x,
+	                        label->pos.y);
+}
+
+/**
+ * Appends everything of @data that ends up in a file, formatted like in
+ * the file, except for the reference designator. Items with the same key
+ * are loaded the same way.
+ */
+void schematic_write_item_key (ItemData *data, GString *key)
+{
+	Coords pos, end;
+
+	g_return_if_fail (IS_ITEM_DATA (data));
+
+	item_data_get_pos (data, &pos);
+
+	if (IS_PART (data)) {
+		PartPriv *priv = PART (data)->priv;
+
+		g_string_append_printf (key, "part %s %s %s (%g %g) %d %d\n", priv->library->name,
+		                        priv->name, priv->symbol_name, pos.x, pos.y,
+		                        part_get_rotation (PART (data)), priv->flip);
+		g_slist_foreach (priv->properties, (GFunc)append_key_property, key);
+		g_slist_foreach (priv->labels, (GFunc)append_key_label, key);
+	} else if (IS_WIRE (data)) {
+		wire_get_start_pos (WIRE (data), &pos);
+		wire_get_end_pos (WIRE (data), &end);
+		g_string_append_printf (key, "wire (%g %g)(%g %g)\n", pos.x, pos.y, end.x, end.y);
+	} else if (IS_TEXTBOX (data)) {
+		g_string_append_printf (key, "textbox (%g %g) %s\n", pos.x, pos.y,
+		                        textbox_get_text (TEXTBOX (data)));
+	}
+}
+
+/**
+ * Appends everything of @sm that ends up in a file but the items.
+ */
+void schematic_write_settings_key (Schematic *sm, GString *key)
+{
+	xmlDocPtr xml;
+	xmlNodePtr cur;
+	xmlChar *buffer = NULL;
+	int length = 0;
+	parseXmlContext ctxt = {0};
+
+	g_return_if_fail (IS_SCHEMATIC (sm));
+
+	xml = xmlNewDoc (BAD_CAST "1.0");
+	if (xml == NULL)
+		return;
+
+	ctxt.doc = xml;
+	cur = xmlNewDocNode (xml, NULL, BAD_CAST "schematic", NULL);
+	ctxt.ns = xmlNewNs (cur, BAD_CAST "https://beerbach.me/project/oregano/ns/v1", BAD_CAST "ogo");
+	xmlSetNs (cur, ctxt.ns);
+	xmlDocSetRootElement (xml, cur);
+	write_xml_settings (cur, &ctxt, sm);
+
+	xmlDocDumpMemory (xml, &buffer, &length);
+	if (buffer != NULL)
+		g_string_append_len (key, (const gchar *)buffer, length);
+	xmlFree (buffer);
+	xmlFreeDoc (xml);
+}
+
+/**
+ * Writes @items in the format of a schematic file, without the settings
+ * of the schematic. schematic_parse_xml_items reads it back.
+ */
+GBytes *schematic_write_xml_items (GList *items)
+{
+	xmlDocPtr xml;
+	xmlNodePtr cur;
+	xmlChar *buffer = NULL;
+	int length = 0;
+	parseXmlContext ctxt;
+	GList *iter;
+
+	xml = xmlNewDoc (BAD_CAST "1.0");
+	if (xml == NULL)
+		return NULL;
+
+	ctxt.doc = xml;
+	ctxt.split_wires = FALSE;
+	cur = xmlNewDocNode (xml, NULL, BAD_CAST "schematic", NULL);
+	ctxt.ns = xmlNewNs (cur, BAD_CAST "https://beerbach.me/project/oregano/ns/v1", BAD_CAST "ogo");
+	xmlSetNs (cur, ctxt.ns);
+	xmlDocSetRootElement (xml, cur);
+
+	ctxt.node_parts = xmlNewChild (cur, ctxt.ns, BAD_CAST "parts", NULL);
+	ctxt.node_wires = xmlNewChild (cur, ctxt.ns, BAD_CAST "wires", NULL);
+	ctxt.node_textboxes = xmlNewChild (cur, ctxt.ns, BAD_CAST "textboxes", NULL);
+
+	for (iter = items; iter; iter = iter->next) {
+		if (IS_PART (iter->data))
+			write_xml_part (PART (iter->data), &ctxt);
+		else if (IS_WIRE (iter->data))
+			write_xml_wire (WIRE (iter->data), &ctxt);
+		else if (IS_TEXTBOX (iter->data))
+			write_xml_textbox (TEXTBOX (iter->data), &ctxt);
+	}
+
+	// not formatted, it is only read by oregano
+	xmlDocDumpMemory (xml, &buffer, &length);
+	xmlFreeDoc (xml);
+
+	if (buffer == NULL)
+		return NULL;
+
+	return g_bytes_new_with_free_func (buffer, length, (GDestroyNotify)xmlFree, buffer);
 }
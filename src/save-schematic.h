@@ -37,6 +37,15 @@
 
 #include "schematic.h"
 
+typedef struct _SchematicWriter SchematicWriter;
+
 gboolean schematic_write_xml (Schematic *sm, GError **error);
+GBytes *schematic_write_xml_items (GList *items);
+void schematic_write_item_key (ItemData *data, GString *key);
+void schematic_write_settings_key (Schematic *sm, GString *key);
+
+SchematicWriter *schematic_writer_new (Schematic *sm, const gchar *filename, GError **error);
+gboolean schematic_writer_write (SchematicWriter *writer, GError **error);
+void schematic_writer_free (SchematicWriter *writer);
 
 #endif
@@ -64,6 +64,10 @@ static GtkActionEntry entries[] = {
      G_CALLBACK (close_cmd)},
     {"Quit", GTK_STOCK_QUIT, N_ ("_Quit"), "<control>Q", N_ ("Close all schematics"),
      G_CALLBACK (quit_cmd)},
+    {"Undo", GTK_STOCK_UNDO, N_ ("_Undo"), "<control>Z", N_ ("Undo the last change"),
+     G_CALLBACK (undo_cmd)},
+    {"Redo", GTK_STOCK_REDO, N_ ("_Redo"), "<control><shift>Z", N_ ("Redo the undone change"),
+     G_CALLBACK (redo_cmd)},
     {"Cut", GTK_STOCK_CUT, N_ ("C_ut"), "<control>X", NULL, G_CALLBACK (cut_cmd)},
     {"Copy", GTK_STOCK_COPY, N_ ("_Copy"), "<control>C", NULL, G_CALLBACK (copy_cmd)},
     {"Paste", GTK_STOCK_PASTE, N_ ("_Paste"), "<control>V", NULL, G_CALLBACK (paste_cmd)},
@@ -87,6 +91,8 @@ static GtkActionEntry entries[] = {
      G_CALLBACK (settings_show)},
     {"Simulate", GTK_STOCK_EXECUTE, N_ ("_Simulate"), "F5", N_ ("Run a simulation"),
      G_CALLBACK (simulate_cmd)},
+    {"OperatingPoint", NULL, N_ ("_Operating Point"), "F6",
+     N_ ("Show the DC operating point on the schematic"), G_CALLBACK (op_values_cmd)},
     {"Netlist", NULL, N_ ("_Generate netlist"), NULL, N_ ("Generate a netlist"),
      G_CALLBACK (netlist_cmd)},
     {"SmartSearch", NULL, N_ ("Smart Search"), NULL, N_ ("Search a part within all the librarys"),
@@ -95,6 +101,8 @@ static GtkActionEntry entries[] = {
     {"NetlistView", NULL, N_ ("N_etlist"), NULL, N_ ("View the circuit netlist"),
      G_CALLBACK (netlist_view_cmd)},
     {"About", GTK_STOCK_HELP, N_ ("_About"), NULL, N_ ("About Oregano"), G_CALLBACK (about_cmd)},
+    {"MemoryStats", NULL, N_ ("_Memory Usage"), NULL,
+     N_ ("Show the memory held by each part of Oregano"), G_CALLBACK (memory_stats_cmd)},
     {"UserManual", NULL, N_ ("User's Manual"), NULL, N_ ("Oregano User's Manual"),
      G_CALLBACK (show_help)},
     {"ZoomIn", GTK_STOCK_ZOOM_IN, N_ ("Zoom _In"), NULL, N_ ("Zoom in"), G_CALLBACK (zoom_in_cmd)},
@@ -111,6 +119,9 @@ static GtkToggleActionEntry toggle_entries[] = {
      G_CALLBACK (grid_toggle_snap_cmd), TRUE},
     {"LogView", GTK_STOCK_DIALOG_WARNING, N_ ("LogView"), NULL, N_ ("Toggle log view visibility"),
      G_CALLBACK (log_toggle_visibility_cmd), TRUE},
+    {"AutoSimulate", NULL, N_ ("_Automatic Simulation"), NULL,
+     N_ ("Simulate again after every change of the schematic"), G_CALLBACK (auto_simulate_cmd),
+     FALSE},
 };
 
 static GtkRadioActionEntry zoom_entries[] = {
@@ -148,6 +159,9 @@ static const char *ui_description = "<ui>"
                                     "      <menuitem action='Quit'/>"
                                     "    </menu>"
                                     "    <menu action='MenuEdit'>"
+                                    "      <menuitem action='Undo'/>"
+                                    "      <menuitem action='Redo'/>"
+                                    "      <separator/>"
                                     "      <menuitem action='Cut'/>"
                                     "      <menuitem action='Copy'/>"
                                     "      <menuitem action='Paste'/>"
@@ -167,6 +181,8 @@ static const char *ui_description = "<ui>"
                                     "    </menu>"
                                     "    <menu action='MenuTools'>"
                                     "      <menuitem action='Simulate'/>"
+                                    "      <menuitem action='AutoSimulate'/>"
+                                    "      <menuitem action='OperatingPoint'/>"
                                     "      <separator/>"
                                     "      <menuitem action='Netlist'/>"
                                     "      <separator/>"
@@ -187,6 +203,7 @@ static const char *ui_description = "<ui>"
                                     "    </menu>"
                                     "    <menu action='MenuHelp'>"
                                     "      <menuitem action='UserManual'/>"
+                                    "      <menuitem action='MemoryStats'/>"
                                     "      <menuitem action='About'/>"
                                     "    </menu>"
                                     "  </menubar>"
@@ -198,6 +215,8 @@ static const char *ui_description = "<ui>"
                                     "    <toolitem action='Cut'/>"
                                     "    <toolitem action='Copy'/>"
                                     "    <toolitem action='Paste'/>"
+                                    "    <toolitem action='Undo'/>"
+                                    "    <toolitem action='Redo'/>"
                                     "    <separator/>"
                                     "    <toolitem action='Arrow'/>"
                                     "    <toolitem action='Text'/>"
@@ -59,6 +59,8 @@
 #include "textbox-item.h"
 #include "log-view.h"
 #include "log.h"
+#include "edit-journal.h"
+#include "clipboard.h"
 #include "debug.h"
 
 #define ZOOM_MIN 0.35
@@ -139,6 +141,8 @@ static void data_received (GtkWidget *widget, GdkDragContext *context, gint x, g
                            GtkSelectionData *selection_data, guint info, guint32 time,
                            SchematicView *sv);
 static void item_data_added_callback (Schematic *schematic, ItemData *data, SchematicView *sv);
+static void item_data_removed_callback (Schematic *schematic, ItemData *data, SchematicView *sv);
+static void journal_changed_callback (Schematic *schematic, SchematicView *sv);
 static void item_selection_changed_callback (SheetItem *item, gboolean selected, SchematicView *sv);
 static void reset_tool_cb (Sheet *sheet, SchematicView *sv);
 
@@ -586,6 +590,24 @@ static void delete_cmd (GtkWidget *widget, SchematicView *sv)
 	sheet_delete_selection (sv->priv->sheet);
 }
 
+static void undo_cmd (GtkWidget *widget, SchematicView *sv)
+{
+	if (sv->priv->sheet->state != SHEET_STATE_NONE)
+		return;
+
+	sheet_select_all (sv->priv->sheet, FALSE);
+	edit_journal_undo (schematic_get_journal (sv->priv->schematic));
+}
+
+static void redo_cmd (GtkWidget *widget, SchematicView *sv)
+{
+	if (sv->priv->sheet->state != SHEET_STATE_NONE)
+		return;
+
+	sheet_select_all (sv->priv->sheet, FALSE);
+	edit_journal_redo (schematic_get_journal (sv->priv->schematic));
+}
+
 static void rotate_cmd (GtkWidget *widget, SchematicView *sv)
 {
 	if (sv->priv->sheet->state == SHEET_STATE_NONE)
@@ -623,27 +645,21 @@ static void object_properties_cmd (GtkWidget *widget, SchematicView *sv)
  */
 static void copy_cmd (GtkWidget *widget, SchematicView *sv)
 {
-	SheetItem *item;
-	GList *iter;
+	GList *iter, *items = NULL;
 
 	if (sv->priv->sheet->state != SHEET_STATE_NONE)
 		return;
 
 	sheet_clear_ghosts (sv->priv->sheet);
-	clipboard_empty ();
 
 	iter = sheet_get_selection (sv->priv->sheet);
-	for (; iter; iter = iter->next) {
-		item = iter->data;
-		clipboard_add_object (G_OBJECT (item));
-	}
+	for (; iter; iter = iter->next)
+		items = g_list_prepend (items, sheet_item_get_data (SHEET_ITEM (iter->data)));
 
-	if (clipboard_is_empty ())
-		gtk_action_set_sensitive (
-		    gtk_ui_manager_get_action (sv->priv->ui_manager, "/MainMenu/MenuEdit/Paste"), FALSE);
-	else
-		gtk_action_set_sensitive (
-		    gtk_ui_manager_get_action (sv->priv->ui_manager, "/MainMenu/MenuEdit/Paste"), TRUE);
+	// the Paste action follows the owner of the clipboard
+	if (items)
+		clipboard_set_items (items);
+	g_list_free (items);
 }
 
 /**
@@ -656,32 +672,57 @@ static void cut_cmd (GtkWidget *widget, SchematicView *sv)
 
 	copy_cmd (NULL, sv);
 	sheet_delete_selection (sv->priv->sheet);
-
-	if (clipboard_is_empty ())
-		gtk_action_set_sensitive (
-		    gtk_ui_manager_get_action (sv->priv->ui_manager, "/MainMenu/MenuEdit/Paste"), FALSE);
-	else
-		gtk_action_set_sensitive (
-		    gtk_ui_manager_get_action (sv->priv->ui_manager, "/MainMenu/MenuEdit/Paste"), TRUE);
 }
 
-static void paste_objects (gpointer data, Sheet *sheet) { sheet_item_paste (sheet, data); }
+static void paste_items_received (GList *items, SchematicView *sv)
+{
+	Sheet *sheet = sv->priv->sheet;
+
+	// the user might have started something else in the meantime
+	if (items == NULL || sheet->state != SHEET_STATE_NONE) {
+		g_list_free_full (items, g_object_unref);
+		g_object_unref (sv);
+		return;
+	}
+
+	if (sheet_get_floating_objects (sheet))
+		sheet_clear_ghosts (sheet);
+
+	sheet_select_all (sheet, FALSE);
+	sheet_item_paste_items (sheet, items);
+	if (sheet_get_floating_objects (sheet))
+		sheet_connect_part_item_to_floating_group (sheet, (gpointer)sv);
+
+	g_object_unref (sv);
+}
 
 static void paste_cmd (GtkWidget *widget, SchematicView *sv)
 {
 	if (sv->priv->sheet->state != SHEET_STATE_NONE)
 		return;
-	if (sheet_get_floating_objects (sv->priv->sheet))
-		sheet_clear_ghosts (sv->priv->sheet);
 
-	sheet_select_all (sv->priv->sheet, FALSE);
-	clipboard_foreach ((ClipBoardFunction)paste_objects, sv->priv->sheet);
-	if (sheet_get_floating_objects (sv->priv->sheet))
-		sheet_connect_part_item_to_floating_group (sv->priv->sheet, (gpointer)sv);
+	clipboard_request_items ((ClipboardItemsFunc)paste_items_received, g_object_ref (sv));
+}
+
+static void paste_available_received (gboolean available, SchematicView *sv)
+{
+	gtk_action_set_sensitive (
+	    gtk_ui_manager_get_action (sv->priv->ui_manager, "/MainMenu/MenuEdit/Paste"), available);
+	g_object_unref (sv);
+}
+
+// Any instance of oregano, or any other program, took the clipboard.
+static void clipboard_owner_changed_callback (GtkClipboard *clipboard, GdkEvent *event,
+                                              SchematicView *sv)
+{
+	clipboard_request_available ((ClipboardAvailableFunc)paste_available_received,
+	                             g_object_ref (sv));
 }
 
 static void about_cmd (GtkWidget *widget, Schematic *sm) { dialog_about (); }
 
+static void memory_stats_cmd (GtkWidget *widget, Schematic *sm) { dialog_memory_stats (); }
+
 static void log_cmd (GtkWidget *widget, SchematicView *sv) { schematic_view_log_show (sv, TRUE); }
 
 static void show_label_cmd (GtkToggleAction *toggle, SchematicView *sv)
@@ -937,6 +978,16 @@ static void simulate_cmd (GtkWidget *widget, SchematicView *sv)
 	return;
 }
 
+static void op_values_cmd (GtkWidget *widget, SchematicView *sv)
+{
+	simulation_show_op_values (NULL, sv);
+}
+
+static void auto_simulate_cmd (GtkToggleAction *action, SchematicView *sv)
+{
+	simulation_set_auto (sv, gtk_toggle_action_get_active (action));
+}
+
 static void schematic_view_class_init (SchematicViewClass *klass)
 {
 	GObjectClass *object_class;
@@ -1002,6 +1053,7 @@ static void schematic_view_dispose (GObject *object)
 	g_signal_handlers_disconnect_by_func (G_OBJECT (sv->toplevel), G_CALLBACK (delete_event), sv);
 
 	if (sv->priv) {
+		simulation_detach_view (sv);
 		g_object_unref (G_OBJECT (sv->priv->schematic));
 	}
 	G_OBJECT_CLASS (parent_class)->dispose (object);
@@ -1184,6 +1236,9 @@ SchematicView *schematic_view_new (Schematic *schematic)
 
 	g_signal_connect_object (G_OBJECT (sv), "reset_tool", G_CALLBACK (reset_tool_cb), G_OBJECT (sv),
 	                         0);
+	g_signal_connect_object (G_OBJECT (clipboard_get ()), "owner-change",
+	                         G_CALLBACK (clipboard_owner_changed_callback), G_OBJECT (sv), 0);
+	clipboard_owner_changed_callback (clipboard_get (), NULL, sv);
 
 	set_window_size (sv);
 
@@ -1218,6 +1273,11 @@ static void schematic_view_load (SchematicView *sv, Schematic *sm)
 	                         G_OBJECT (sv), 0);
 	g_signal_connect_object (G_OBJECT (sm), "item_data_added",
 	                         G_CALLBACK (item_data_added_callback), G_OBJECT (sv), 0);
+	g_signal_connect_object (G_OBJECT (sm), "item_data_removed",
+	                         G_CALLBACK (item_data_removed_callback), G_OBJECT (sv), 0);
+	g_signal_connect_object (G_OBJECT (sm), "journal_changed",
+	                         G_CALLBACK (journal_changed_callback), G_OBJECT (sv), 0);
+	journal_changed_callback (sm, sv);
 
 	list = schematic_get_items (sm);
 
@@ -1285,6 +1345,24 @@ static void item_data_added_callback (Schematic *schematic, ItemData *data, Sche
 	}
 }
 
+// An ItemData left the schematic (deleted or undone); drop its Item.
+static void item_data_removed_callback (Schematic *schematic, ItemData *data, SchematicView *sv)
+{
+	sheet_remove_item_for_data (sv->priv->sheet, data);
+}
+
+static void journal_changed_callback (Schematic *schematic, SchematicView *sv)
+{
+	EditJournal *journal = schematic_get_journal (schematic);
+
+	gtk_action_set_sensitive (
+	    gtk_ui_manager_get_action (sv->priv->ui_manager, "/MainMenu/MenuEdit/Undo"),
+	    edit_journal_can_undo (journal));
+	gtk_action_set_sensitive (
+	    gtk_ui_manager_get_action (sv->priv->ui_manager, "/MainMenu/MenuEdit/Redo"),
+	    edit_journal_can_redo (journal));
+}
+
 static void title_changed_callback (Schematic *schematic, char *new_title, SchematicView *sv)
 {
 	g_return_if_fail (schematic != NULL);
@@ -1527,6 +1605,61 @@ void schematic_view_set_browser (SchematicView *sv, gpointer p)
 	sv->priv->browser = p;
 }
 
+// Libraries parsed after the window was opened show up in every part browser.
+void schematic_view_libraries_changed (void)
+{
+	GList *iter;
+
+	for (iter = schematic_view_list; iter; iter = iter->next) {
+		SchematicView *sv = iter->data;
+
+		if (sv->priv->browser)
+			part_browser_update_libraries (sv->priv->browser);
+	}
+}
+
+/**
+ * A library was parsed again, @new_library is NULL if its file is gone.
+ * The parts of a removed library stay bound to the old definitions.
+ */
+void schematic_view_library_reloaded (Library *old_library, Library *new_library)
+{
+	GList *iter;
+
+	for (iter = schematic_view_list; iter; iter = iter->next) {
+		SchematicView *sv = iter->data;
+
+		if (old_library != NULL && new_library != NULL)
+			schematic_rebind_library (sv->priv->schematic, old_library, new_library);
+		if (sv->priv->browser)
+			part_browser_reload_libraries (sv->priv->browser);
+	}
+}
+
+static void find_model (Part *part, gpointer *data)
+{
+	gchar *model = part_get_property (part, "model");
+
+	if (g_strcmp0 (model, data[0]) == 0)
+		data[1] = GINT_TO_POINTER (TRUE);
+	g_free (model);
+}
+
+// The netlist includes the model file, so only the simulation has to be run again.
+void schematic_view_model_changed (const gchar *model)
+{
+	GList *iter;
+
+	for (iter = schematic_view_list; iter; iter = iter->next) {
+		SchematicView *sv = iter->data;
+		gpointer data[2] = {(gpointer)model, GINT_TO_POINTER (FALSE)};
+
+		schematic_parts_foreach (sv->priv->schematic, (ForeachItemDataFunc)find_model, data);
+		if (GPOINTER_TO_INT (data[1]))
+			g_signal_emit_by_name (sv->priv->schematic, "changed");
+	}
+}
+
 static gboolean log_window_delete_event (GtkWidget *widget, GdkEvent *event, SchematicView *sv)
 {
 	sv->priv->log_info->log_window = NULL;
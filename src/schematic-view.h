@@ -68,6 +68,9 @@ void schematic_view_reset_tool (SchematicView *sv);
 // Misc.
 void schematic_view_set_browser (SchematicView *sv, gpointer p);
 gpointer schematic_view_get_browser (SchematicView *sv);
+void schematic_view_libraries_changed (void);
+void schematic_view_library_reloaded (Library *old_library, Library *new_library);
+void schematic_view_model_changed (const gchar *model);
 void schematic_view_set_parent (SchematicView *sv, GtkDialog *dialog);
 
 // Logging.
@@ -58,6 +58,7 @@ typedef struct
 	GtkWidget *w_show_log;
 
 	GtkWidget *w_compress_files;
+	GtkWidget *w_incremental_save;
 	GtkWidget *w_engine;
 } Settings;
 
@@ -70,6 +71,8 @@ static void apply_callback (GtkWidget *w, Settings *s)
 {
 	oregano.engine = GPOINTER_TO_INT (g_object_get_data (G_OBJECT (s->w_engine), "id"));
 	oregano.compress_files = gtk_toggle_button_get_active (GTK_TOGGLE_BUTTON (s->w_compress_files));
+	oregano.incremental_save =
+	    gtk_toggle_button_get_active (GTK_TOGGLE_BUTTON (s->w_incremental_save));
 	oregano.show_log = gtk_toggle_button_get_active (GTK_TOGGLE_BUTTON (s->w_show_log));
 	oregano.show_splash = gtk_toggle_button_get_active (GTK_TOGGLE_BUTTON (s->w_show_splash));
 
@@ -184,6 +187,9 @@ void settings_show (GtkWidget *widget, SchematicView *sv)
 	w = GTK_WIDGET (gtk_builder_get_object (gui, "compress-enable"));
 	s->w_compress_files = w;
 	gtk_toggle_button_set_active (GTK_TOGGLE_BUTTON (w), oregano.compress_files);
+	w = GTK_WIDGET (gtk_builder_get_object (gui, "incremental-enable"));
+	s->w_incremental_save = w;
+	gtk_toggle_button_set_active (GTK_TOGGLE_BUTTON (w), oregano.incremental_save);
 	w = GTK_WIDGET (gtk_builder_get_object (gui, "log-enable"));
 	s->w_show_log = w;
 	gtk_toggle_button_set_active (GTK_TOGGLE_BUTTON (w), oregano.show_log);
@@ -46,6 +46,7 @@
 #include "create-wire.h"
 #include "wire.h"
 #include "sheet-private.h"
+#include "edit-journal.h"
 
 #include "debug.h"
 
@@ -252,6 +253,8 @@ inline static gboolean create_wire_discard (Sheet *sheet, GdkEvent *event)
 inline static Wire *create_wire_spawn (Sheet *sheet, Coords start_pos, Coords end_pos)
 {
 	Wire *wire = NULL;
+	Schematic *schematic;
+	GList *added;
 	Coords length;
 
 	NG_DEBUG ("=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=- spawning...");
@@ -265,7 +268,12 @@ inline static Wire *create_wire_spawn (Sheet *sheet, Coords start_pos, Coords en
 	wire_set_length (wire, &length);
 
 	item_data_set_pos (ITEM_DATA (wire), &start_pos);
-	schematic_add_item (schematic_view_get_schematic_from_sheet (sheet), ITEM_DATA (wire));
+	schematic = schematic_view_get_schematic_from_sheet (sheet);
+	if (schematic_add_item (schematic, ITEM_DATA (wire))) {
+		added = g_list_prepend (NULL, wire);
+		edit_journal_add (schematic_get_journal (schematic), added);
+		g_list_free (added);
+	}
 
 	NG_DEBUG ("=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=- spawning wire %p", wire);
 
@@ -0,0 +1,160 @@
+/*
+ * op-overlay.c
+ *
+ *
+ * Authors:
+ *  Michi <st101564@stud.uni-stuttgart.de>
+ *
+ * Web page: https://ahoi.io/project/oregano
+ *
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include "op-overlay.h"
+
+#define OP_OVERLAY_FONT_SIZE 8.0
+
+G_DEFINE_TYPE (OpOverlay, op_overlay, GOO_TYPE_CANVAS_ITEM_SIMPLE);
+
+static void op_overlay_label_clear (OpOverlayLabel *label) { g_free (label->text); }
+
+GArray *op_overlay_labels_new (void)
+{
+	GArray *labels = g_array_new (FALSE, FALSE, sizeof(OpOverlayLabel));
+
+	g_array_set_clear_func (labels, (GDestroyNotify)op_overlay_label_clear);
+	return labels;
+}
+
+/**
+ * @text: (transfer full)
+ */
+void op_overlay_labels_add (GArray *labels, const Coords *pos, gchar *text)
+{
+	OpOverlayLabel label = {*pos, text, 0.};
+
+	g_array_append_val (labels, label);
+}
+
+static void op_overlay_set_font (cairo_t *cr)
+{
+	cairo_select_font_face (cr, "Sans", CAIRO_FONT_SLANT_NORMAL, CAIRO_FONT_WEIGHT_NORMAL);
+	cairo_set_font_size (cr, OP_OVERLAY_FONT_SIZE);
+}
+
+static void op_overlay_update (GooCanvasItemSimple *simple, cairo_t *cr)
+{
+	OpOverlay *overlay = OP_OVERLAY (simple);
+	GooCanvasBounds *bounds = &simple->bounds;
+	cairo_text_extents_t extents;
+	guint i;
+
+	bounds->x1 = bounds->y1 = bounds->x2 = bounds->y2 = 0.;
+	if (overlay->labels->len == 0)
+		return;
+
+	bounds->x1 = bounds->y1 = G_MAXDOUBLE;
+	bounds->x2 = bounds->y2 = -G_MAXDOUBLE;
+
+	op_overlay_set_font (cr);
+	for (i = 0; i < overlay->labels->len; i++) {
+		OpOverlayLabel *label = &g_array_index (overlay->labels, OpOverlayLabel, i);
+
+		cairo_text_extents (cr, label->text, &extents);
+		label->width = extents.x_advance;
+
+		bounds->x1 = MIN (bounds->x1, label->pos.x);
+		bounds->y1 = MIN (bounds->y1, label->pos.y - OP_OVERLAY_FONT_SIZE);
+		bounds->x2 = MAX (bounds->x2, label->pos.x + label->width);
+		bounds->y2 = MAX (bounds->y2, label->pos.y + OP_OVERLAY_FONT_SIZE / 2.);
+	}
+
+	goo_canvas_item_simple_user_bounds_to_device (simple, cr, bounds);
+}
+
+static void op_overlay_paint (GooCanvasItemSimple *simple, cairo_t *cr,
+                              const GooCanvasBounds *bounds)
+{
+	OpOverlay *overlay = OP_OVERLAY (simple);
+	guint i;
+
+	op_overlay_set_font (cr);
+	cairo_set_source_rgb (cr, 0.0, 0.45, 0.0);
+
+	// the overlay is never transformed, so its coordinates are the ones
+	// of the canvas
+	for (i = 0; i < overlay->labels->len; i++) {
+		OpOverlayLabel *label = &g_array_index (overlay->labels, OpOverlayLabel, i);
+
+		if (label->pos.x > bounds->x2 || label->pos.x + label->width < bounds->x1 ||
+		    label->pos.y - OP_OVERLAY_FONT_SIZE > bounds->y2 ||
+		    label->pos.y + OP_OVERLAY_FONT_SIZE / 2. < bounds->y1)
+			continue;
+
+		cairo_move_to (cr, label->pos.x, label->pos.y);
+		cairo_show_text (cr, label->text);
+	}
+}
+
+// Never in the way of the mouse.
+static gboolean op_overlay_is_item_at (GooCanvasItemSimple *simple, gdouble x, gdouble y,
+                                       cairo_t *cr, gboolean is_pointer_event)
+{
+	return FALSE;
+}
+
+static void op_overlay_finalize (GObject *object)
+{
+	g_array_unref (OP_OVERLAY (object)->labels);
+
+	G_OBJECT_CLASS (op_overlay_parent_class)->finalize (object);
+}
+
+static void op_overlay_class_init (OpOverlayClass *klass)
+{
+	GObjectClass *object_class = G_OBJECT_CLASS (klass);
+	GooCanvasItemSimpleClass *simple_class = GOO_CANVAS_ITEM_SIMPLE_CLASS (klass);
+
+	object_class->finalize = op_overlay_finalize;
+
+	simple_class->simple_update = op_overlay_update;
+	simple_class->simple_paint = op_overlay_paint;
+	simple_class->simple_is_item_at = op_overlay_is_item_at;
+}
+
+static void op_overlay_init (OpOverlay *overlay) { overlay->labels = op_overlay_labels_new (); }
+
+GooCanvasItem *op_overlay_new (GooCanvasItem *parent)
+{
+	GooCanvasItem *item = g_object_new (TYPE_OP_OVERLAY, "pointer-events", GOO_CANVAS_EVENTS_NONE, NULL);
+
+	goo_canvas_item_add_child (parent, item, -1);
+	g_object_unref (item);
+
+	return item;
+}
+
+void op_overlay_set_labels (OpOverlay *overlay, GArray *labels)
+{
+	g_return_if_fail (IS_OP_OVERLAY (overlay));
+
+	g_array_unref (overlay->labels);
+	overlay->labels = labels != NULL ? labels : op_overlay_labels_new ();
+
+	// recomputes the bounds and repaints the old and the new area
+	goo_canvas_item_simple_changed (GOO_CANVAS_ITEM_SIMPLE (overlay), TRUE);
+}
@@ -0,0 +1,75 @@
+/*
+ * op-overlay.h
+ *
+ *
+ * Authors:
+ *  Michi <st101564@stud.uni-stuttgart.de>
+ *
+ * Web page: https://ahoi.io/project/oregano
+ *
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef __OP_OVERLAY_H
+#define __OP_OVERLAY_H
+
+#include <gtk/gtk.h>
+#include <goocanvas.h>
+
+#include "coords.h"
+
+/**
+ * One canvas item that draws all values of an operating point, instead
+ * of one GooCanvasText per value. Setting new labels updates it in place
+ * and only the labels inside the exposed area are painted.
+ */
+
+#define TYPE_OP_OVERLAY (op_overlay_get_type ())
+#define OP_OVERLAY(obj) (G_TYPE_CHECK_INSTANCE_CAST ((obj), TYPE_OP_OVERLAY, OpOverlay))
+#define IS_OP_OVERLAY(obj) (G_TYPE_CHECK_INSTANCE_TYPE ((obj), TYPE_OP_OVERLAY))
+
+typedef struct _OpOverlay OpOverlay;
+typedef struct _OpOverlayClass OpOverlayClass;
+
+typedef struct
+{
+	// baseline start, in sheet coordinates
+	Coords pos;
+	gchar *text;
+	// filled in by the overlay
+	gdouble width;
+} OpOverlayLabel;
+
+struct _OpOverlay
+{
+	GooCanvasItemSimple parent;
+	GArray *labels;
+};
+
+struct _OpOverlayClass
+{
+	GooCanvasItemSimpleClass parent_class;
+};
+
+GType op_overlay_get_type (void);
+GooCanvasItem *op_overlay_new (GooCanvasItem *parent);
+GArray *op_overlay_labels_new (void);
+void op_overlay_labels_add (GArray *labels, const Coords *pos, gchar *text);
+// Takes @labels, NULL removes all.
+void op_overlay_set_labels (OpOverlay *overlay, GArray *labels);
+
+#endif
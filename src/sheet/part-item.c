@@ -69,7 +69,6 @@ static void update_canvas_labels (PartItem *part_item);
 static gboolean is_in_area (SheetItem *object, Coords *p1, Coords *p2);
 inline static void get_cached_bounds (PartItem *item, Coords *p1, Coords *p2);
 static void show_labels (SheetItem *sheet_item, gboolean show);
-static void part_item_paste (Sheet *sheet, ItemData *data);
 static void part_rotated_callback (ItemData *data, int angle, SheetItem *item);
 static void part_flipped_callback (ItemData *data, IDFlip direction, SheetItem *sheet_item);
 static void part_moved_callback (ItemData *data, Coords *pos, SheetItem *item);
@@ -158,7 +157,6 @@ static void part_item_class_init (PartItemClass *part_item_class)
 	sheet_item_class->moved = part_item_moved;
 	sheet_item_class->is_in_area = is_in_area;
 	sheet_item_class->show_labels = show_labels;
-	sheet_item_class->paste = part_item_paste;
 	sheet_item_class->edit_properties = edit_properties;
 	sheet_item_class->selection_changed = (gpointer)selection_changed;
 
@@ -905,16 +903,6 @@ inline static void get_cached_bounds (PartItem *item, Coords *p1, Coords *p2)
 	}
 }
 
-static void part_item_paste (Sheet *sheet, ItemData *data)
-{
-	g_return_if_fail (sheet != NULL);
-	g_return_if_fail (IS_SHEET (sheet));
-	g_return_if_fail (data != NULL);
-	g_return_if_fail (IS_PART (data));
-
-	sheet_add_ghost_item (sheet, data);
-}
-
 PartItem *part_item_new (Sheet *sheet, Part *part)
 {
 	Library *library;
@@ -41,6 +41,7 @@
 
 #include "rubberband.h"
 #include "sheet-private.h"
+#include "stall-detector.h"
 
 #include "debug.h"
 
@@ -215,9 +216,11 @@ gboolean rubberband_update (Sheet *sheet, GdkEvent *event)
 		cmax.x = cmin.x + width_ng;
 		cmax.y = cmin.y + height_ng;
 #if 1
+		stall_detector_begin ("rubberband_update");
 		for (iter = sheet->priv->items; iter; iter = iter->next) {
 			sheet_item_select_in_area (iter->data, &cmin, &cmax);
 		}
+		stall_detector_end ();
 #endif
 
 		g_object_set (GOO_CANVAS_ITEM (rubberband_info->rectangle), "x", cmin.x, "y", cmin.y,
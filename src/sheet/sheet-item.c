@@ -44,8 +44,8 @@
 #include "sheet-private.h"
 #include "sheet-item.h"
 #include "stock.h"
-#include "clipboard.h"
 #include "options.h"
+#include "edit-journal.h"
 
 static void sheet_item_class_init (SheetItemClass *klass);
 static void sheet_item_init (SheetItem *item);
@@ -152,7 +152,6 @@ static void sheet_item_class_init (SheetItemClass *sheet_item_class)
 
 	sheet_item_class->is_in_area = NULL;
 	sheet_item_class->show_labels = NULL;
-	sheet_item_class->paste = NULL;
 
 	sheet_item_class->moved = NULL;
 	sheet_item_class->selection_changed = NULL;
@@ -315,7 +314,9 @@ gboolean sheet_item_event (GooCanvasItem *sheet_item, GooCanvasItem *sheet_targe
 	// Remember the last position of the mouse cursor.
 	GooCanvas *canvas;
 	SheetPriv *priv;
-	GList *list;
+	GList *list, *moved;
+	GArray *deltas;
+	gboolean any_moved;
 
 	static Coords last, current, snapped;
 	// snapped : Mouse cursor position in window coordinates, snapped to the grid
@@ -415,14 +416,35 @@ gboolean sheet_item_event (GooCanvasItem *sheet_item, GooCanvasItem *sheet_targe
 				sheet_item_reparent (SHEET_ITEM (list->data), sheet->object_group);
 			}
 
+			moved = NULL;
+			any_moved = FALSE;
+			deltas = g_array_new (FALSE, FALSE, sizeof (Coords));
 			for (list = priv->selected_objects; list; list = list->next) {
 				ItemData *item_data;
+				Coords before, after;
 
 				item_data = SHEET_ITEM (list->data)->priv->data;
+				item_data_get_pos (item_data, &before);
 				item_data_move (item_data, &delta);
 				item_data_snap (item_data, sheet->grid);
 				item_data_register (item_data);
+
+				// snapping may move every item by a different delta
+				item_data_get_pos (item_data, &after);
+				if (!coords_equal (&after, &before))
+					any_moved = TRUE;
+				after = coords_sub (&after, &before);
+				g_array_append_val (deltas, after);
+				moved = g_list_prepend (moved, item_data);
 			}
+			moved = g_list_reverse (moved);
+			// a click that snapped back keeps the redo steps
+			if (any_moved)
+				edit_journal_move_each (
+				    schematic_get_journal (schematic_view_get_schematic_from_sheet (sheet)),
+				    moved, (Coords *)deltas->data);
+			g_list_free (moved);
+			g_array_free (deltas, TRUE);
 			break;
 		}
 
@@ -576,7 +598,7 @@ void sheet_item_cancel_floating (Sheet *sheet)
 int sheet_item_floating_event (Sheet *sheet, const GdkEvent *event)
 {
 	SheetPriv *priv;
-	GList *list;
+	GList *list, *placed = NULL;
 	static gboolean keep = FALSE;
 
 	// Remember the start position of the mouse cursor.
@@ -643,12 +665,20 @@ int sheet_item_floating_event (Sheet *sheet, const GdkEvent *event)
 				item_data_set_pos (floating_data, &snapped);
 				item_data_snap (floating_data, sheet->grid);
 
-				schematic_add_item (schematic_view_get_schematic_from_sheet (sheet), floating_data);
+				if (schematic_add_item (schematic_view_get_schematic_from_sheet (sheet),
+				                        floating_data))
+					placed = g_list_prepend (placed, floating_data);
 
 				if (!keep)
 					g_object_unref (G_OBJECT (floating_item));
 			}
 
+			// one step for everything placed with this click
+			edit_journal_add (
+			    schematic_get_journal (schematic_view_get_schematic_from_sheet (sheet)), placed);
+			g_list_free (placed);
+			placed = NULL;
+
 			if (keep) {
 				g_object_set (G_OBJECT (priv->floating_group), "x", snapped.x, "y", snapped.y,
 				              NULL);
@@ -827,28 +857,21 @@ void sheet_item_rotate (SheetItem *sheet_item, int angle, Coords *center)
 	item_data_rotate (sheet_item->priv->data, angle, center);
 }
 
-void sheet_item_paste (Sheet *sheet, ClipboardData *data)
+/**
+ * Adds @items, parsed from the clipboard, as ghosts of the sheet in one
+ * go. The sheet takes the references of the items, the list is freed.
+ */
+void sheet_item_paste_items (Sheet *sheet, GList *items)
 {
-	SheetItemClass *item_class;
-	ItemDataClass *id_class;
-	ItemData *item_data, *clone;
+	GList *iter;
 
 	g_return_if_fail (sheet != NULL);
 	g_return_if_fail (IS_SHEET (sheet));
-	g_return_if_fail (data != NULL);
-
-	item_data = ITEM_DATA (clipboard_data_get_item_data (data));
 
-	id_class = ITEM_DATA_CLASS (G_OBJECT_GET_CLASS (item_data));
-	if (id_class->clone == NULL)
-		return;
+	for (iter = items; iter; iter = iter->next)
+		sheet_add_ghost_item (sheet, ITEM_DATA (iter->data));
 
-	// Duplicate the data for the item and paste the item on the sheet.
-	item_class = SHEET_ITEM_CLASS (clipboard_data_get_item_class (data));
-	if (item_class->paste) {
-		clone = id_class->clone (item_data);
-		item_class->paste (sheet, clone);
-	}
+	g_list_free (items);
 }
 
 ItemData *sheet_item_get_data (SheetItem *item)
@@ -49,7 +49,6 @@ typedef struct _SheetItemClass SheetItemClass;
 typedef struct _SheetItemPriv SheetItemPriv;
 
 #include "sheet.h"
-#include "clipboard.h"
 
 struct _SheetItem
 {
@@ -69,7 +68,6 @@ struct _SheetItemClass
 	gboolean (*is_in_area)(SheetItem *item, Coords *p1, Coords *p2);
 	void (*show_labels)(SheetItem *sheet_item, gboolean show);
 	void (*edit_properties)(SheetItem *item);
-	void (*paste)(Sheet *sheet, ItemData *data);
 	void (*place)(SheetItem *item, Sheet *sheet);
 	void (*place_ghost)(SheetItem *item, Sheet *sheet);
 
@@ -89,7 +87,7 @@ int sheet_item_floating_event (Sheet *sheet, const GdkEvent *event);
 void sheet_item_cancel_floating (Sheet *sheet);
 void sheet_item_edit_properties (SheetItem *item);
 ItemData *sheet_item_get_data (SheetItem *item);
-void sheet_item_paste (Sheet *sheet, ClipboardData *data);
+void sheet_item_paste_items (Sheet *sheet, GList *items);
 void sheet_item_rotate (SheetItem *sheet_item, int angle, Coords *center);
 gboolean sheet_item_get_selected (SheetItem *item);
 gboolean sheet_item_get_preserve_selection (SheetItem *item);
@@ -57,12 +57,14 @@ struct _SheetPriv
 	GList *floating_objects;
 
 	GList *items;
+	// ItemData -> SheetItem of items
+	GHashTable *item_for_data;
 	RubberbandInfo *rubberband_info;
 	GList *preserve_selection_items;
 	GooCanvasClass *sheet_parent_class;
 
-	GList *voltmeter_items; // List of GooCanvasItem
-	GHashTable *voltmeter_nodes;
+	// operating point values, created when they are shown the first time
+	GooCanvasItem *op_overlay;
 
 	CreateWireInfo *create_wire_info; // Wire context for each schematic
 
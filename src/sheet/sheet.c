@@ -50,6 +50,8 @@
 #include "options.h"
 #include "rubberband.h"
 #include "create-wire.h"
+#include "op-overlay.h"
+#include "edit-journal.h"
 
 static void sheet_class_init (SheetClass *klass);
 static void sheet_init (Sheet *sheet);
@@ -61,6 +63,7 @@ static GList *sheet_preserve_selection (Sheet *sheet);
 static void rotate_items (Sheet *sheet, GList *items, gint angle);
 static void move_items (Sheet *sheet, GList *items, const Coords *delta);
 static void flip_items (Sheet *sheet, GList *items, IDFlip direction);
+static EditJournal *sheet_get_journal (Sheet *sheet);
 static void node_dot_added_callback (Schematic *schematic, Coords *pos, Sheet *sheet);
 static void node_dot_removed_callback (Schematic *schematic, Coords *pos, Sheet *sheet);
 static void sheet_finalize (GObject *object);
@@ -132,8 +135,7 @@ static void sheet_init (Sheet *sheet)
 	sheet->priv->create_wire_info = NULL;
 	sheet->priv->preserve_selection_items = NULL;
 	sheet->priv->sheet_parent_class = g_type_class_ref (GOO_TYPE_CANVAS);
-	sheet->priv->voltmeter_items = NULL;
-	sheet->priv->voltmeter_nodes = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_free);
+	sheet->priv->op_overlay = NULL;
 
 	sheet->state = SHEET_STATE_NONE;
 }
@@ -145,6 +147,8 @@ static void sheet_finalize (GObject *object)
 	if (sheet->priv) {
 		if (sheet->priv->node_dots)
 			g_hash_table_destroy (sheet->priv->node_dots);
+		if (sheet->priv->item_for_data)
+			g_hash_table_destroy (sheet->priv->item_for_data);
 		g_free (sheet->priv);
 	}
 	if (G_OBJECT_CLASS (sheet_parent_class)->finalize)
@@ -497,6 +501,7 @@ GtkWidget *sheet_new (gdouble height, gdouble width)
 
 	// Hash table that maps coordinates to a specific dot.
 	sheet->priv->node_dots = g_hash_table_new_full (dot_hash, dot_equal, g_free, NULL);
+	sheet->priv->item_for_data = g_hash_table_new (NULL, NULL);
 
 	// this requires object_group to be setup properly
 	sheet->priv->rubberband_info = rubberband_info_new (sheet);
@@ -641,6 +646,7 @@ void sheet_add_item (Sheet *sheet, SheetItem *item)
 	g_return_if_fail (IS_SHEET_ITEM (item));
 
 	sheet->priv->items = g_list_prepend (sheet->priv->items, item);
+	g_hash_table_insert (sheet->priv->item_for_data, sheet_item_get_data (item), item);
 }
 
 /**
@@ -872,6 +878,12 @@ void sheet_rotate_ghosts (Sheet *sheet)
 		rotate_items (sheet, sheet->priv->floating_objects, 90);
 }
 
+// edits of the selection are journaled, ghosts are not part of the schematic yet
+static EditJournal *sheet_get_journal (Sheet *sheet)
+{
+	return schematic_get_journal (schematic_view_get_schematic_from_sheet (sheet));
+}
+
 static void rotate_items (Sheet *sheet, GList *items, gint angle)
 {
 	GList *list, *item_data_list;
@@ -902,12 +914,15 @@ static void rotate_items (Sheet *sheet, GList *items, gint angle)
 			item_data_register (item_data);
 	}
 
+	if (sheet->state == SHEET_STATE_NONE)
+		edit_journal_rotate (sheet_get_journal (sheet), item_data_list, angle, &center);
+
 	g_list_free (item_data_list);
 }
 
 static void move_items (Sheet *sheet, GList *items, const Coords *trans)
 {
-	GList *list;
+	GList *list, *item_data_list = NULL;
 
 	for (list = items; list; list = list->next) {
 		g_assert (list->data != NULL);
@@ -921,7 +936,13 @@ static void move_items (Sheet *sheet, GList *items, const Coords *trans)
 
 		if (sheet->state == SHEET_STATE_NONE)
 			item_data_register (item_data);
+
+		item_data_list = g_list_prepend (item_data_list, item_data);
 	}
+
+	if (sheet->state == SHEET_STATE_NONE)
+		edit_journal_move (sheet_get_journal (sheet), item_data_list, trans);
+	g_list_free (item_data_list);
 }
 
 /**
@@ -930,7 +951,8 @@ static void move_items (Sheet *sheet, GList *items, const Coords *trans)
  */
 void sheet_delete_selection (Sheet *sheet)
 {
-	GList *copy, *iter;
+	Schematic *sm;
+	GList *data_list, *iter;
 
 	g_return_if_fail (sheet != NULL);
 	g_return_if_fail (IS_SHEET (sheet));
@@ -938,17 +960,19 @@ void sheet_delete_selection (Sheet *sheet)
 	if (sheet->state != SHEET_STATE_NONE)
 		return;
 
-	copy = g_list_copy (sheet->priv->selected_objects);
+	sm = schematic_view_get_schematic_from_sheet (sheet);
 
-	for (iter = copy; iter; iter = iter->next) {
-		sheet_remove_item_in_sheet (SHEET_ITEM (iter->data), sheet);
-		goo_canvas_item_remove (GOO_CANVAS_ITEM (iter->data));
-	}
-	g_list_free (copy);
+	data_list = NULL;
+	for (iter = sheet->priv->selected_objects; iter; iter = iter->next)
+		data_list = g_list_prepend (data_list, sheet_item_get_data (SHEET_ITEM (iter->data)));
+
+	// the journal keeps the items alive, the schematic drops them and
+	// their canvas items (see <sheet_remove_item_for_data>)
+	edit_journal_remove (schematic_get_journal (sm), data_list);
+	for (iter = data_list; iter; iter = iter->next)
+		schematic_remove_item (sm, ITEM_DATA (iter->data));
+	g_list_free (data_list);
 
-	// function <sheet_remove_item_in_sheet>
-	// requires selected_objects, items, floating_objects
-	// to be not NULL!
 	g_list_free (sheet->priv->selected_objects);
 	sheet->priv->selected_objects = NULL;
 }
@@ -1036,12 +1060,15 @@ static void flip_items (Sheet *sheet, GList *items, IDFlip direction)
 {
 	GList *iter, *item_data_list;
 	Coords center, b1, b2;
-	Coords after;
+	Coords before, after;
+	Coords *snapped;
+	guint i = 0;
 
 	item_data_list = NULL;
 	for (iter = items; iter; iter = iter->next) {
 		item_data_list = g_list_prepend (item_data_list, sheet_item_get_data (iter->data));
 	}
+	snapped = g_new (Coords, g_list_length (item_data_list));
 
 	item_data_list_get_absolute_bbox (item_data_list, &b1, &b2);
 
@@ -1060,35 +1087,51 @@ static void flip_items (Sheet *sheet, GList *items, IDFlip direction)
 		item_data_flip (item_data, direction, &center);
 
 		// Make sure we snap to grid.
-		item_data_get_pos (item_data, &after);
+		item_data_get_pos (item_data, &before);
+		after = before;
 
 		snap_to_grid (sheet->grid, &after.x, &after.y);
 
 		item_data_set_pos (item_data, &after);
+		snapped[i++] = coords_sub (&after, &before);
 
 		if (sheet->state == SHEET_STATE_NONE)
 			item_data_register (item_data);
 	}
 
+	if (sheet->state == SHEET_STATE_NONE)
+		edit_journal_flip (sheet_get_journal (sheet), item_data_list, direction, &center,
+		                   snapped);
+
+	g_free (snapped);
 	g_list_free (item_data_list);
 }
 
 void sheet_clear_op_values (Sheet *sheet)
 {
-	GList *iter;
-
 	g_return_if_fail (sheet != NULL);
 	g_return_if_fail (IS_SHEET (sheet));
 
-	for (iter = sheet->priv->voltmeter_items; iter; iter = iter->next) {
-		g_object_unref (G_OBJECT (iter->data));
-	}
+	if (sheet->priv->op_overlay != NULL)
+		op_overlay_set_labels (OP_OVERLAY (sheet->priv->op_overlay), NULL);
+}
+
+/**
+ * Replaces the operating point values on the sheet.
+ *
+ * @labels: (transfer full) see op_overlay_labels_new ()
+ */
+void sheet_show_op_values (Sheet *sheet, GArray *labels)
+{
+	g_return_if_fail (sheet != NULL);
+	g_return_if_fail (IS_SHEET (sheet));
 
-	g_list_free (sheet->priv->voltmeter_items);
-	sheet->priv->voltmeter_items = NULL;
+	if (sheet->priv->op_overlay == NULL)
+		sheet->priv->op_overlay = op_overlay_new (goo_canvas_get_root_item (GOO_CANVAS (sheet)));
+	else
+		goo_canvas_item_raise (sheet->priv->op_overlay, NULL);
 
-	g_hash_table_destroy (sheet->priv->voltmeter_nodes);
-	sheet->priv->voltmeter_nodes = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+	op_overlay_set_labels (OP_OVERLAY (sheet->priv->op_overlay), labels);
 }
 
 void sheet_provide_object_properties (Sheet *sheet)
@@ -1283,29 +1326,28 @@ void sheet_connect_node_dots_to_signals (Sheet *sheet)
 }
 
 /**
- * remove a single item from the sheet
+ * remove the canvas item of an item that left the schematic,
+ * the item data is not touched
  */
-void sheet_remove_item_in_sheet (SheetItem *item, Sheet *sheet)
+void sheet_remove_item_for_data (Sheet *sheet, ItemData *data)
 {
+	SheetItem *item;
+
 	g_return_if_fail (sheet != NULL);
 	g_return_if_fail (IS_SHEET (sheet));
-	g_return_if_fail (item != NULL);
-	g_return_if_fail (IS_SHEET_ITEM (item));
 
+	item = g_hash_table_lookup (sheet->priv->item_for_data, data);
+	if (item == NULL)
+		return;
+
+	g_hash_table_remove (sheet->priv->item_for_data, data);
 	sheet->priv->items = g_list_remove (sheet->priv->items, item);
 
 	//  Remove the object from the selected-list before destroying.
 	sheet_remove_selected_object (sheet, item);
 	sheet_remove_floating_object (sheet, item);
 
-	ItemData *data = sheet_item_get_data (item);
-	g_return_if_fail (data != NULL);
-	g_return_if_fail (IS_ITEM_DATA (data));
-
-	// properly unregister the itemdata from the sheet
-	item_data_unregister (data);
-	// Destroy the item-data (model) associated to the sheet-item
-	g_object_unref (data);
+	goo_canvas_item_remove (GOO_CANVAS_ITEM (item));
 }
 
 inline static guint32 extract_time (GdkEvent *event)
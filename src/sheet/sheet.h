@@ -115,6 +115,7 @@ void sheet_rotate_ghosts (Sheet *sheet);
 void sheet_flip_selection (Sheet *sheet, IDFlip direction);
 void sheet_flip_ghosts (Sheet *sheet, IDFlip direction);
 void sheet_clear_op_values (Sheet *sheet);
+void sheet_show_op_values (Sheet *sheet, GArray *labels);
 void sheet_provide_object_properties (Sheet *sheet);
 void sheet_clear_ghosts (Sheet *sheet);
 guint sheet_get_selected_objects_length (Sheet *sheet);
@@ -124,7 +125,7 @@ GList *sheet_get_items (const Sheet *sheet);
 void sheet_stop_create_wire (Sheet *sheet);
 void sheet_initiate_create_wire (Sheet *sheet);
 void sheet_connect_node_dots_to_signals (Sheet *sheet);
-void sheet_remove_item_in_sheet (SheetItem *item, Sheet *sheet);
+void sheet_remove_item_for_data (Sheet *sheet, ItemData *data);
 gboolean sheet_get_pointer_pixel (Sheet *sheet, gdouble *x, gdouble *y);
 gboolean sheet_get_pointer (Sheet *sheet, gdouble *x, gdouble *y);
 gboolean sheet_get_pointer_snapped (Sheet *sheet, gdouble *x, gdouble *y);
@@ -40,6 +40,7 @@
 #include "textbox-item.h"
 #include "textbox.h"
 #include "dialogs.h"
+#include "edit-journal.h"
 
 #define NORMAL_COLOR "black"
 #define SELECTED_COLOR "green"
@@ -53,7 +54,6 @@ static void textbox_rotated_callback (ItemData *data, int angle, SheetItem *shee
 static void textbox_flipped_callback (ItemData *data, IDFlip direction, SheetItem *sheet_item);
 static void textbox_moved_callback (ItemData *data, Coords *pos, SheetItem *item);
 static void textbox_text_changed_callback (ItemData *data, gchar *new_text, SheetItem *item);
-static void textbox_item_paste (Sheet *sheet, ItemData *data);
 static void selection_changed (TextboxItem *item, gboolean select, gpointer user_data);
 static int select_idle_callback (TextboxItem *item);
 static int deselect_idle_callback (TextboxItem *item);
@@ -111,7 +111,6 @@ static void textbox_item_class_init (TextboxItemClass *textbox_item_class)
 	object_class->finalize = textbox_item_finalize;
 
 	sheet_item_class->moved = textbox_item_moved;
-	sheet_item_class->paste = textbox_item_paste;
 	sheet_item_class->is_in_area = is_in_area;
 	sheet_item_class->selection_changed = (gpointer)selection_changed;
 	sheet_item_class->edit_properties = edit_textbox;
@@ -318,16 +317,6 @@ inline static void get_cached_bounds (TextboxItem *item, Coords *p1, Coords *p2)
 	memcpy (p2, &priv->bbox_end, sizeof(Coords));
 }
 
-static void textbox_item_paste (Sheet *sheet, ItemData *data)
-{
-	g_return_if_fail (sheet != NULL);
-	g_return_if_fail (IS_SHEET (sheet));
-	g_return_if_fail (data != NULL);
-	g_return_if_fail (IS_TEXTBOX (data));
-
-	sheet_add_ghost_item (sheet, data);
-}
-
 // This is called when the textbox data was moved. Update the view accordingly.
 static void textbox_moved_callback (ItemData *data, Coords *pos, SheetItem *item)
 {
@@ -400,6 +389,8 @@ static gboolean create_textbox_event (Sheet *sheet, GdkEvent *event)
 
 		if (sheet->state == SHEET_STATE_TEXTBOX_START) {
 			Textbox *textbox;
+			Schematic *schematic;
+			GList *added;
 			Coords pos;
 
 			sheet->state = SHEET_STATE_NONE;
@@ -410,8 +401,12 @@ static gboolean create_textbox_event (Sheet *sheet, GdkEvent *event)
 			textbox_set_text (textbox, _ ("Label"));
 
 			item_data_set_pos (ITEM_DATA (textbox), &pos);
-			schematic_add_item (schematic_view_get_schematic_from_sheet (sheet),
-			                    ITEM_DATA (textbox));
+			schematic = schematic_view_get_schematic_from_sheet (sheet);
+			if (schematic_add_item (schematic, ITEM_DATA (textbox))) {
+				added = g_list_prepend (NULL, textbox);
+				edit_journal_add (schematic_get_journal (schematic), added);
+				g_list_free (added);
+			}
 
 			schematic_view_reset_tool (schematic_view_get_schematicview_from_sheet (sheet));
 			g_signal_handlers_disconnect_by_func (G_OBJECT (sheet),
@@ -58,8 +58,6 @@ static void wire_rotated_callback (ItemData *data, int angle, SheetItem *sheet_i
 static void wire_flipped_callback (ItemData *data, IDFlip horizontal, SheetItem *sheet_item);
 static void wire_moved_callback (ItemData *data, Coords *pos, SheetItem *item);
 static void wire_changed_callback (Wire *, WireItem *item);
-static void wire_delete_callback (Wire *, WireItem *item);
-static void wire_item_paste (Sheet *sheet, ItemData *data);
 static void selection_changed (WireItem *item, gboolean select, gpointer user_data);
 static int select_idle_callback (WireItem *item);
 static int deselect_idle_callback (WireItem *item);
@@ -113,7 +111,6 @@ static void wire_item_class_init (WireItemClass *wire_item_class)
 	object_class->get_property = wire_item_get_property;
 
 	sheet_item_class->moved = wire_item_moved;
-	sheet_item_class->paste = wire_item_paste;
 	sheet_item_class->is_in_area = is_in_area;
 	sheet_item_class->selection_changed = selection_changed;
 	sheet_item_class->place = wire_item_place;
@@ -263,8 +260,6 @@ WireItem *wire_item_new (Sheet *sheet, Wire *wire)
 	item_data->changed_handler_id = g_signal_connect_object (
 	    G_OBJECT (wire), "changed", G_CALLBACK (wire_changed_callback), G_OBJECT (wire_item), 0);
 
-	g_signal_connect (wire, "delete", G_CALLBACK (wire_delete_callback), wire_item);
-
 	wire_update_bbox (wire);
 
 	return wire_item;
@@ -430,7 +425,9 @@ void wire_item_signal_connect_placed (WireItem *wire_item, Sheet *sheet)
 
 	g_signal_connect (wire_item, "mouse_over", G_CALLBACK (mouse_over_wire_callback), sheet);
 
-	g_signal_connect (item, "highlight", G_CALLBACK (highlight_wire_callback), wire_item);
+	// the wire outlives the item if its removal is undone
+	g_signal_connect_object (item, "highlight", G_CALLBACK (highlight_wire_callback), wire_item,
+	                         0);
 }
 
 static void wire_rotated_callback (ItemData *data, int angle, SheetItem *sheet_item)
@@ -608,16 +605,6 @@ inline static void get_boundingbox (WireItem *item, Coords *p1, Coords *p2)
 		*p2 = priv->bbox_end;
 }
 
-static void wire_item_paste (Sheet *sheet, ItemData *data)
-{
-	g_return_if_fail (sheet != NULL);
-	g_return_if_fail (IS_SHEET (sheet));
-	g_return_if_fail (data != NULL);
-	g_return_if_fail (IS_WIRE (data));
-
-	sheet_add_ghost_item (sheet, data);
-}
-
 static void wire_traverse (Wire *wire);
 
 static void node_traverse (Node *node)
@@ -772,12 +759,3 @@ static void wire_changed_callback (Wire *wire, WireItem *item)
 
 	goo_canvas_item_request_update (GOO_CANVAS_ITEM (item->priv->line));
 }
-
-static void wire_delete_callback (Wire *wire, WireItem *item)
-{
-	// no clue why does work but canvas item does not disappear
-	//	g_clear_object (&item);
-	//	g_assert (item==NULL);
-	goo_canvas_item_remove (GOO_CANVAS_ITEM (item));
-	//	g_object_unref (wire); //FIXME this causes a segfault
-}
@@ -0,0 +1,563 @@
+/*
+ * sim-compare.c
+ *
+ *
+ * Authors:
+ *  Michi <st101564@stud.uni-stuttgart.de>
+ *
+ * Web page: https://ahoi.io/project/oregano
+ *
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include <math.h>
+#include <string.h>
+#include <glib.h>
+#include <glib/gi18n.h>
+
+#include "sim-compare.h"
+#include "measure.h"
+#include "tools/task-scheduler.h"
+#include "errors.h"
+
+/*
+ * Resampling happens in two passes. The segment of every query point is
+ * found by walking both sorted axes side by side, which is linear in
+ * the number of points. Then the interpolation runs in blocks: the
+ * segment ends are gathered into small arrays and evaluated by a loop
+ * without branches, which the compiler vectorizes.
+ */
+#define SIM_COMPARE_BLOCK_SIZE 256
+
+/**
+ * The part of the natural spline system that only depends on the x
+ * axis. It is shared by all variables of a run, so each of them only
+ * costs one forward and one backward substitution.
+ */
+typedef struct {
+	gdouble *upper;
+	gdouble *inv_denominator;
+} SimCompareSpline;
+
+typedef struct {
+	gchar *name;
+	gdouble *reference;
+	gdouble *other;
+} SimCompareColumn;
+
+/**
+ * Copy of the compared columns, so the worker thread does not depend on
+ * the SimulationData staying around (or resident) while it runs.
+ */
+typedef struct {
+	SimCompareInterpolation interpolation;
+	gdouble *x_reference;
+	gsize n_reference;
+	gdouble *x_other;
+	gsize n_other;
+	// SimCompareColumn *
+	GPtrArray *columns;
+} SimCompareInput;
+
+static void sim_compare_column_free (SimCompareColumn *column)
+{
+	g_free (column->name);
+	g_free (column->reference);
+	g_free (column->other);
+	g_free (column);
+}
+
+static void sim_compare_input_free (SimCompareInput *input)
+{
+	g_free (input->x_reference);
+	g_free (input->x_other);
+	g_ptr_array_free (input->columns, TRUE);
+	g_free (input);
+}
+
+static void sim_compare_trace_free (SimCompareTrace *trace)
+{
+	g_free (trace->name);
+	g_free (trace->reference);
+	g_free (trace->other);
+	g_free (trace->difference);
+	g_free (trace);
+}
+
+void sim_compare_result_free (SimCompareResult *result)
+{
+	if (result == NULL)
+		return;
+	g_free (result->x);
+	g_ptr_array_free (result->traces, TRUE);
+	g_free (result);
+}
+
+/**
+ * @returns the x values of both axes inside the range they share, sorted
+ * and without duplicates, or NULL if they do not overlap
+ */
+gdouble *sim_compare_common_axis (const gdouble *xa, gsize na, const gdouble *xb, gsize nb,
+                                  gsize *n)
+{
+	*n = 0;
+	if (na == 0 || nb == 0)
+		return NULL;
+
+	gdouble lo = MAX (xa[0], xb[0]);
+	gdouble hi = MIN (xa[na - 1], xb[nb - 1]);
+	if (lo > hi)
+		return NULL;
+
+	gsize ia = measure_lower_bound (xa, na, lo);
+	gsize ib = measure_lower_bound (xb, nb, lo);
+	gdouble *x = g_new (gdouble, (na - ia) + (nb - ib));
+	gsize count = 0;
+
+	while (ia < na || ib < nb) {
+		gdouble next;
+
+		if (ib >= nb || (ia < na && xa[ia] <= xb[ib]))
+			next = xa[ia++];
+		else
+			next = xb[ib++];
+
+		if (next > hi)
+			break;
+		if (count == 0 || next > x[count - 1])
+			x[count++] = next;
+	}
+
+	*n = count;
+	return x;
+}
+
+/**
+ * seg[k] is the index i of the segment [x[i], x[i + 1]] that contains
+ * xq[k], clamped to the first and last segment. Needs n >= 2.
+ */
+static void sim_compare_locate (const gdouble *x, gsize n, const gdouble *xq, gsize nq, gsize *seg)
+{
+	gsize i = 0;
+
+	for (gsize k = 0; k < nq; k++) {
+		while (i + 2 < n && x[i + 1] <= xq[k])
+			i++;
+		seg[k] = i;
+	}
+}
+
+static void sim_compare_linear (const gdouble *x, const gdouble *y, const gsize *seg,
+                                const gdouble *xq, gdouble *yq, gsize nq)
+{
+	gdouble x0[SIM_COMPARE_BLOCK_SIZE], dx[SIM_COMPARE_BLOCK_SIZE];
+	gdouble y0[SIM_COMPARE_BLOCK_SIZE], dy[SIM_COMPARE_BLOCK_SIZE];
+
+	for (gsize begin = 0; begin < nq; begin += SIM_COMPARE_BLOCK_SIZE) {
+		gsize count = MIN (SIM_COMPARE_BLOCK_SIZE, nq - begin);
+
+		for (gsize k = 0; k < count; k++) {
+			gsize i = seg[begin + k];
+			x0[k] = x[i];
+			dx[k] = x[i + 1] - x[i];
+			y0[k] = y[i];
+			dy[k] = y[i + 1] - y[i];
+		}
+		for (gsize k = 0; k < count; k++)
+			yq[begin + k] = y0[k] + (xq[begin + k] - x0[k]) * dy[k] / dx[k];
+	}
+}
+
+static void sim_compare_spline_init (SimCompareSpline *spline, const gdouble *x, gsize n)
+{
+	spline->upper = g_new0 (gdouble, n);
+	spline->inv_denominator = g_new0 (gdouble, n);
+
+	// rows 1 .. n - 2 of the tridiagonal system, the natural spline has
+	// zero curvature at both ends
+	for (gsize i = 1; i + 1 < n; i++) {
+		gdouble h0 = x[i] - x[i - 1];
+		gdouble h1 = x[i + 1] - x[i];
+		gdouble denominator = 2.0 * (h0 + h1) - h0 * spline->upper[i - 1];
+
+		spline->inv_denominator[i] = 1.0 / denominator;
+		spline->upper[i] = h1 / denominator;
+	}
+}
+
+static void sim_compare_spline_clear (SimCompareSpline *spline)
+{
+	g_free (spline->upper);
+	g_free (spline->inv_denominator);
+}
+
+/**
+ * @m receives the second derivatives, n values
+ */
+static void sim_compare_spline_solve (const SimCompareSpline *spline, const gdouble *x,
+                                      const gdouble *y, gsize n, gdouble *m)
+{
+	m[0] = 0.0;
+	m[n - 1] = 0.0;
+
+	// forward substitution, m holds the intermediate values
+	for (gsize i = 1; i + 1 < n; i++) {
+		gdouble h0 = x[i] - x[i - 1];
+		gdouble h1 = x[i + 1] - x[i];
+		gdouble rhs = 6.0 * ((y[i + 1] - y[i]) / h1 - (y[i] - y[i - 1]) / h0);
+
+		m[i] = (rhs - h0 * m[i - 1]) * spline->inv_denominator[i];
+	}
+	for (gsize i = n - 2; i >= 1; i--)
+		m[i] -= spline->upper[i] * m[i + 1];
+}
+
+static void sim_compare_cubic (const gdouble *x, const gdouble *y, const gdouble *m,
+                               const gsize *seg, const gdouble *xq, gdouble *yq, gsize nq)
+{
+	gdouble x0[SIM_COMPARE_BLOCK_SIZE], x1[SIM_COMPARE_BLOCK_SIZE];
+	gdouble y0[SIM_COMPARE_BLOCK_SIZE], y1[SIM_COMPARE_BLOCK_SIZE];
+	gdouble m0[SIM_COMPARE_BLOCK_SIZE], m1[SIM_COMPARE_BLOCK_SIZE];
+
+	for (gsize begin = 0; begin < nq; begin += SIM_COMPARE_BLOCK_SIZE) {
+		gsize count = MIN (SIM_COMPARE_BLOCK_SIZE, nq - begin);
+
+		for (gsize k = 0; k < count; k++) {
+			gsize i = seg[begin + k];
+			x0[k] = x[i];
+			x1[k] = x[i + 1];
+			y0[k] = y[i];
+			y1[k] = y[i + 1];
+			m0[k] = m[i];
+			m1[k] = m[i + 1];
+		}
+		for (gsize k = 0; k < count; k++) {
+			gdouble h = x1[k] - x0[k];
+			gdouble a = (x1[k] - xq[begin + k]) / h;
+			gdouble b = 1.0 - a;
+
+			yq[begin + k] = a * y0[k] + b * y1[k] +
+			                ((a * a * a - a) * m0[k] + (b * b * b - b) * m1[k]) * h * h / 6.0;
+		}
+	}
+}
+
+/**
+ * Resampling with everything that only depends on the axes prepared by
+ * the caller. @m is scratch space for n values.
+ */
+static void sim_compare_resample_prepared (const gdouble *x, const gdouble *y, gsize n,
+                                           const gsize *seg, const SimCompareSpline *spline,
+                                           gdouble *m, const gdouble *xq, gdouble *yq, gsize nq)
+{
+	if (n == 0) {
+		for (gsize k = 0; k < nq; k++)
+			yq[k] = NAN;
+	} else if (n == 1) {
+		for (gsize k = 0; k < nq; k++)
+			yq[k] = y[0];
+	} else if (spline != NULL && n > 2) {
+		sim_compare_spline_solve (spline, x, y, n, m);
+		sim_compare_cubic (x, y, m, seg, xq, yq, nq);
+	} else {
+		sim_compare_linear (x, y, seg, xq, yq, nq);
+	}
+}
+
+/**
+ * Evaluates the curve (@x, @y) at the @nq points @xq. A cubic spline
+ * needs at least three points, shorter curves are resampled linearly.
+ */
+void sim_compare_resample (const gdouble *x, const gdouble *y, gsize n, const gdouble *xq,
+                           gdouble *yq, gsize nq, SimCompareInterpolation interpolation)
+{
+	SimCompareSpline spline;
+	gsize *seg = g_new (gsize, nq);
+	gdouble *m = NULL;
+	gboolean cubic = interpolation == SIM_COMPARE_CUBIC && n > 2;
+
+	if (n >= 2)
+		sim_compare_locate (x, n, xq, nq, seg);
+	if (cubic) {
+		sim_compare_spline_init (&spline, x, n);
+		m = g_new (gdouble, n);
+	}
+
+	sim_compare_resample_prepared (x, y, n, seg, cubic ? &spline : NULL, m, xq, yq, nq);
+
+	if (cubic)
+		sim_compare_spline_clear (&spline);
+	g_free (m);
+	g_free (seg);
+}
+
+static void sim_compare_metrics (SimCompareTrace *trace, const gdouble *x, gsize n)
+{
+	const gdouble *d = trace->difference;
+	gdouble sum = 0.0;
+
+	trace->max_abs = 0.0;
+	trace->x_max_abs = n > 0 ? x[0] : NAN;
+	for (gsize k = 0; k < n; k++) {
+		if (fabs (d[k]) > trace->max_abs) {
+			trace->max_abs = fabs (d[k]);
+			trace->x_max_abs = x[k];
+		}
+	}
+
+	if (n > 1 && x[n - 1] > x[0]) {
+		for (gsize k = 0; k + 1 < n; k++)
+			sum += 0.5 * (d[k] * d[k] + d[k + 1] * d[k + 1]) * (x[k + 1] - x[k]);
+		trace->rms = sqrt (sum / (x[n - 1] - x[0]));
+	} else if (n > 0) {
+		for (gsize k = 0; k < n; k++)
+			sum += d[k] * d[k];
+		trace->rms = sqrt (sum / n);
+	} else {
+		trace->rms = NAN;
+	}
+}
+
+static SimCompareResult *sim_compare_input_run (SimCompareInput *input, GCancellable *cancellable,
+                                                GError **error)
+{
+	SimCompareResult *result = g_new0 (SimCompareResult, 1);
+	SimCompareSpline spline_reference, spline_other;
+	gboolean cubic = input->interpolation == SIM_COMPARE_CUBIC;
+
+	result->traces = g_ptr_array_new_with_free_func ((GDestroyNotify)sim_compare_trace_free);
+	result->x = sim_compare_common_axis (input->x_reference, input->n_reference, input->x_other,
+	                                     input->n_other, &result->n);
+	if (result->x == NULL) {
+		g_set_error_literal (error, OREGANO_ERROR, OREGANO_COMPARE_ERROR_NO_OVERLAP,
+		                     _ ("The simulations do not share any range of the x axis"));
+		sim_compare_result_free (result);
+		return NULL;
+	}
+
+	gsize n = result->n;
+	gsize *seg_reference = g_new0 (gsize, n);
+	gsize *seg_other = g_new0 (gsize, n);
+	gdouble *m = g_new (gdouble, MAX (input->n_reference, input->n_other));
+
+	if (input->n_reference >= 2)
+		sim_compare_locate (input->x_reference, input->n_reference, result->x, n, seg_reference);
+	if (input->n_other >= 2)
+		sim_compare_locate (input->x_other, input->n_other, result->x, n, seg_other);
+	if (cubic) {
+		sim_compare_spline_init (&spline_reference, input->x_reference, input->n_reference);
+		sim_compare_spline_init (&spline_other, input->x_other, input->n_other);
+	}
+
+	for (guint i = 0; i < input->columns->len; i++) {
+		SimCompareColumn *column = g_ptr_array_index (input->columns, i);
+		SimCompareTrace *trace;
+
+		if (g_cancellable_set_error_if_cancelled (cancellable, error)) {
+			g_clear_pointer (&result, sim_compare_result_free);
+			break;
+		}
+
+		trace = g_new0 (SimCompareTrace, 1);
+		trace->name = g_strdup (column->name);
+		trace->reference = g_new (gdouble, n);
+		trace->other = g_new (gdouble, n);
+		trace->difference = g_new (gdouble, n);
+
+		sim_compare_resample_prepared (input->x_reference, column->reference, input->n_reference,
+		                               seg_reference, cubic ? &spline_reference : NULL, m,
+		                               result->x, trace->reference, n);
+		sim_compare_resample_prepared (input->x_other, column->other, input->n_other, seg_other,
+		                               cubic ? &spline_other : NULL, m, result->x, trace->other, n);
+		for (gsize k = 0; k < n; k++)
+			trace->difference[k] = trace->other[k] - trace->reference[k];
+		sim_compare_metrics (trace, result->x, n);
+
+		g_ptr_array_add (result->traces, trace);
+	}
+
+	if (cubic) {
+		sim_compare_spline_clear (&spline_reference);
+		sim_compare_spline_clear (&spline_other);
+	}
+	g_free (m);
+	g_free (seg_other);
+	g_free (seg_reference);
+
+	return result;
+}
+
+/**
+ * Number of complete rows, the last row of an aborted simulation may
+ * be missing some columns.
+ */
+static gsize sim_compare_get_n_rows (const SimulationData *sdat)
+{
+	gsize rows = G_MAXSIZE;
+
+	for (gint i = 0; i < sdat->n_variables; i++)
+		rows = MIN (rows, sdat->data[i]->len);
+	return sdat->n_variables > 0 ? rows : 0;
+}
+
+/**
+ * Indices of the rows with a strictly increasing x value. Spice emits
+ * the same time twice around breakpoints, which neither the segment
+ * search nor the spline can handle.
+ */
+static GArray *sim_compare_get_rows (const SimulationData *sdat)
+{
+	gsize n = sim_compare_get_n_rows (sdat);
+	GArray *rows = g_array_sized_new (FALSE, FALSE, sizeof(gsize), n);
+	const gdouble *x = n > 0 ? (const gdouble *)sdat->data[0]->data : NULL;
+
+	for (gsize i = 0; i < n; i++) {
+		if (isnan (x[i]))
+			continue;
+		if (rows->len > 0 && x[i] <= x[g_array_index (rows, gsize, rows->len - 1)])
+			continue;
+		g_array_append_val (rows, i);
+	}
+	return rows;
+}
+
+static gdouble *sim_compare_gather (const GArray *column, const GArray *rows)
+{
+	gdouble *values = g_new (gdouble, MAX (rows->len, 1));
+
+	for (guint i = 0; i < rows->len; i++)
+		values[i] = g_array_index (column, gdouble, g_array_index (rows, gsize, i));
+	return values;
+}
+
+static SimCompareInput *sim_compare_input_new (const SimulationData *reference,
+                                               const SimulationData *other,
+                                               SimCompareInterpolation interpolation,
+                                               GError **error)
+{
+	if (reference->type != other->type) {
+		g_set_error_literal (error, OREGANO_ERROR, OREGANO_COMPARE_ERROR_MISMATCH,
+		                     _ ("Only results of the same kind of analysis can be compared"));
+		return NULL;
+	}
+
+	SimCompareInput *input = g_new0 (SimCompareInput, 1);
+	GArray *rows_reference = sim_compare_get_rows (reference);
+	GArray *rows_other = sim_compare_get_rows (other);
+
+	input->interpolation = interpolation;
+	input->columns = g_ptr_array_new_with_free_func ((GDestroyNotify)sim_compare_column_free);
+	input->n_reference = rows_reference->len;
+	input->n_other = rows_other->len;
+	if (reference->n_variables > 0)
+		input->x_reference = sim_compare_gather (reference->data[0], rows_reference);
+	if (other->n_variables > 0)
+		input->x_other = sim_compare_gather (other->data[0], rows_other);
+
+	for (gint i = 1; i < reference->n_variables; i++) {
+		for (gint j = 1; j < other->n_variables; j++) {
+			if (g_strcmp0 (reference->var_names[i], other->var_names[j]) != 0)
+				continue;
+
+			SimCompareColumn *column = g_new0 (SimCompareColumn, 1);
+			column->name = g_strdup (reference->var_names[i]);
+			column->reference = sim_compare_gather (reference->data[i], rows_reference);
+			column->other = sim_compare_gather (other->data[j], rows_other);
+			g_ptr_array_add (input->columns, column);
+			break;
+		}
+	}
+
+	g_array_free (rows_reference, TRUE);
+	g_array_free (rows_other, TRUE);
+
+	if (input->columns->len == 0) {
+		g_set_error_literal (error, OREGANO_ERROR, OREGANO_COMPARE_ERROR_MISMATCH,
+		                     _ ("The simulations have no variables in common"));
+		sim_compare_input_free (input);
+		return NULL;
+	}
+
+	return input;
+}
+
+/**
+ * Compares the variables of @other with the ones of the same name in
+ * @reference.
+ */
+SimCompareResult *sim_compare (const SimulationData *reference, const SimulationData *other,
+                               SimCompareInterpolation interpolation, GCancellable *cancellable,
+                               GError **error)
+{
+	g_return_val_if_fail (reference != NULL, NULL);
+	g_return_val_if_fail (other != NULL, NULL);
+
+	SimCompareInput *input = sim_compare_input_new (reference, other, interpolation, error);
+	if (input == NULL)
+		return NULL;
+
+	SimCompareResult *result = sim_compare_input_run (input, cancellable, error);
+	sim_compare_input_free (input);
+	return result;
+}
+
+static void sim_compare_task (GTask *task, CancelInfo *cancel_info)
+{
+	GError *e = NULL;
+	SimCompareResult *result = sim_compare_input_run (g_task_get_task_data (task),
+	                                                  g_task_get_cancellable (task), &e);
+
+	if (result == NULL)
+		g_task_return_error (task, e);
+	else
+		g_task_return_pointer (task, result, (GDestroyNotify)sim_compare_result_free);
+}
+
+/**
+ * Like sim_compare, but the comparison runs in the task scheduler. The
+ * columns are copied before this returns, so the analyses may change
+ * or go away afterwards. @callback is invoked in the thread default
+ * main context of the caller.
+ */
+void sim_compare_async (const SimulationData *reference, const SimulationData *other,
+                        SimCompareInterpolation interpolation, GCancellable *cancellable,
+                        GAsyncReadyCallback callback, gpointer user_data)
+{
+	GError *e = NULL;
+	GTask *task = g_task_new (NULL, cancellable, callback, user_data);
+	SimCompareInput *input;
+
+	g_task_set_source_tag (task, sim_compare_async);
+
+	input = sim_compare_input_new (reference, other, interpolation, &e);
+	if (input == NULL) {
+		g_task_return_error (task, e);
+	} else {
+		g_task_set_task_data (task, input, (GDestroyNotify)sim_compare_input_free);
+		task_scheduler_submit (task_scheduler_get_default (),
+		                       task_new ((TaskFunc)sim_compare_task, g_object_ref (task),
+		                                 g_object_unref));
+	}
+	g_object_unref (task);
+}
+
+SimCompareResult *sim_compare_finish (GAsyncResult *result, GError **error)
+{
+	g_return_val_if_fail (g_task_is_valid (result, NULL), NULL);
+
+	return g_task_propagate_pointer (G_TASK (result), error);
+}
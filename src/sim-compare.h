@@ -0,0 +1,91 @@
+/*
+ * sim-compare.h
+ *
+ *
+ * Authors:
+ *  Michi <st101564@stud.uni-stuttgart.de>
+ *
+ * Web page: https://ahoi.io/project/oregano
+ *
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef SIM_COMPARE_H_
+#define SIM_COMPARE_H_
+
+#include <glib.h>
+#include <gio/gio.h>
+
+#include "simulation.h"
+
+/**
+ * Comparison of two results of the same analysis, e.g. before and after
+ * a part was changed. The runs have different x axes because of the
+ * adaptive step size, so both are resampled onto a common axis (all x
+ * values of both runs inside the range they share) and compared there
+ * variable by variable. Variables are matched by name.
+ */
+
+typedef enum {
+	SIM_COMPARE_LINEAR = 0,
+	// natural cubic spline
+	SIM_COMPARE_CUBIC
+} SimCompareInterpolation;
+
+typedef struct {
+	gchar *name;
+	// n values each, on SimCompareResult.x
+	gdouble *reference;
+	gdouble *other;
+	// other - reference
+	gdouble *difference;
+
+	gdouble max_abs;
+	// where max_abs is reached
+	gdouble x_max_abs;
+	// weighted with the distance between the points, so dense regions
+	// of the adaptive step size do not dominate
+	gdouble rms;
+} SimCompareTrace;
+
+typedef struct {
+	gdouble *x;
+	gsize n;
+	// SimCompareTrace *
+	GPtrArray *traces;
+} SimCompareResult;
+
+SimCompareResult *sim_compare (const SimulationData *reference, const SimulationData *other,
+                               SimCompareInterpolation interpolation, GCancellable *cancellable,
+                               GError **error);
+void sim_compare_async (const SimulationData *reference, const SimulationData *other,
+                        SimCompareInterpolation interpolation, GCancellable *cancellable,
+                        GAsyncReadyCallback callback, gpointer user_data);
+SimCompareResult *sim_compare_finish (GAsyncResult *result, GError **error);
+void sim_compare_result_free (SimCompareResult *result);
+
+/*
+ * Kernels working on plain arrays. x has to be strictly increasing, xq
+ * non-decreasing. Values outside of x are extrapolated from the first
+ * or last segment.
+ */
+gdouble *sim_compare_common_axis (const gdouble *xa, gsize na, const gdouble *xb, gsize nb,
+                                  gsize *n);
+void sim_compare_resample (const gdouble *x, const gdouble *y, gsize n, const gdouble *xq,
+                           gdouble *yq, gsize nq, SimCompareInterpolation interpolation);
+
+#endif /* SIM_COMPARE_H_ */
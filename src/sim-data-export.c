@@ -0,0 +1,494 @@
+/*
+ * sim-data-export.c
+ *
+ *
+ * Authors:
+ *  Michi <st101564@stud.uni-stuttgart.de>
+ *
+ * Web page: https://ahoi.io/project/oregano
+ *
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include <errno.h>
+#include <float.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <glib.h>
+#include <glib/gi18n.h>
+#include <glib/gstdio.h>
+
+#include "sim-data-export.h"
+
+static const gchar sim_data_export_magic[8] = "OREGCOL";
+
+#define SIM_DATA_EXPORT_BUFFER_SIZE (256 * 1024)
+
+// significant digits that bring every double back
+#define SIM_DATA_EXPORT_DIGITS 17
+// fewer digits tried first, enough for most values
+#define SIM_DATA_EXPORT_SHORT_DIGITS 15
+
+/*
+ * The SIM_DATA_EXPORT_DIGITS significant digits of the positive @value
+ * as a number, with the decimal @exponent of the first one. Digits
+ * past SIM_DATA_EXPORT_SHORT_DIGITS are zero if the shorter form comes
+ * back to @value. This is the C library's exact conversion, several
+ * times slower than the one below.
+ */
+static guint64 significant_digits_printf (gdouble value, gint *exponent)
+{
+	gchar text[G_ASCII_DTOSTR_BUF_SIZE];
+	gchar format[8];
+	guint64 mantissa = 0;
+	gint n_digits = SIM_DATA_EXPORT_SHORT_DIGITS;
+	const gchar *p;
+
+	g_snprintf (format, sizeof (format), "%%.%de", n_digits - 1);
+	g_ascii_formatd (text, sizeof (text), format, value);
+	if (g_ascii_strtod (text, NULL) != value) {
+		n_digits = SIM_DATA_EXPORT_DIGITS;
+		g_snprintf (format, sizeof (format), "%%.%de", n_digits - 1);
+		g_ascii_formatd (text, sizeof (text), format, value);
+	}
+
+	// d.ddde[+-]xx
+	for (p = text; *p != 'e'; p++)
+		if (g_ascii_isdigit (*p))
+			mantissa = mantissa * 10 + (*p - '0');
+	for (gint i = n_digits; i < SIM_DATA_EXPORT_DIGITS; i++)
+		mantissa *= 10;
+	*exponent = atoi (p + 1);
+
+	return mantissa;
+}
+
+#if LDBL_MANT_DIG >= 64
+/*
+ * The powers of ten a long double holds exactly, the scaling of most
+ * values gets by with one multiplication or division by them.
+ */
+static const long double powers_of_ten[] = {
+    1e0L,  1e1L,  1e2L,  1e3L,  1e4L,  1e5L,  1e6L,  1e7L,  1e8L,  1e9L,
+    1e10L, 1e11L, 1e12L, 1e13L, 1e14L, 1e15L, 1e16L, 1e17L, 1e18L, 1e19L,
+    1e20L, 1e21L, 1e22L, 1e23L, 1e24L, 1e25L, 1e26L, 1e27L};
+
+static long double power_of_ten (gint exponent)
+{
+	if (exponent < (gint)G_N_ELEMENTS (powers_of_ten))
+		return powers_of_ten[exponent];
+	return powl (10.0L, exponent);
+}
+
+/*
+ * @value * 10^@shift, in the precision of a long double. That has at
+ * least 11 bits more than a double, way more than the rounding to
+ * SIM_DATA_EXPORT_DIGITS digits needs to round trip.
+ */
+static long double scale (gdouble value, gint shift)
+{
+	if (shift >= 0)
+		return (long double)value * power_of_ten (shift);
+	return (long double)value / power_of_ten (-shift);
+}
+
+static long double unscale (long double mantissa, gint shift)
+{
+	if (shift >= 0)
+		return mantissa / power_of_ten (shift);
+	return mantissa * power_of_ten (-shift);
+}
+
+// significant_digits_printf, but in long double arithmetic
+static guint64 significant_digits (gdouble value, gint *exponent)
+{
+	guint64 mantissa, low = 1, high;
+	gint shift;
+	long double scaled;
+
+	for (gint i = 1; i < SIM_DATA_EXPORT_DIGITS; i++)
+		low *= 10;
+	high = low * 10;
+
+	// log10 may be off by one close to powers of ten
+	*exponent = (gint)floor (log10 (value));
+	for (;;) {
+		shift = SIM_DATA_EXPORT_DIGITS - 1 - *exponent;
+		scaled = scale (value, shift);
+		mantissa = (guint64)llrintl (scaled);
+		if (mantissa >= high)
+			(*exponent)++;
+		else if (mantissa < low)
+			(*exponent)--;
+		else
+			break;
+	}
+
+	{
+		const gint drop = SIM_DATA_EXPORT_DIGITS - SIM_DATA_EXPORT_SHORT_DIGITS;
+		long double unit = power_of_ten (drop);
+		long double shorter = llrintl (scaled / unit) * unit;
+		long double back = unscale (shorter, shift);
+		// the gap above a power of two is twice the one below
+		long double ulp = back > value ? MAX (ldexp (DBL_EPSILON, ilogb (value)), DBL_TRUE_MIN)
+		                               : value - nextafter (value, 0.0);
+		long double error = fabsl (back - value);
+
+		// about half a ulp, closer than the long double arithmetic can tell
+		if (error >= ulp / 2 - ulp / 512 && error < ulp / 2 + ulp / 512)
+			return significant_digits_printf (value, exponent);
+		if (error < ulp / 2) {
+			mantissa = (guint64)shorter;
+			// rounded up to the next power of ten
+			if (mantissa >= high) {
+				mantissa /= 10;
+				(*exponent)++;
+			}
+		}
+	}
+
+	return mantissa;
+}
+#else
+// without a long double wider than a double, e.g. MSVC or ARM64 macOS
+static guint64 significant_digits (gdouble value, gint *exponent)
+{
+	return significant_digits_printf (value, exponent);
+}
+#endif
+
+/**
+ * The shortest form is not searched for, that needs big numbers. The
+ * value is rounded to SIM_DATA_EXPORT_SHORT_DIGITS digits if those
+ * come back to it, else to SIM_DATA_EXPORT_DIGITS digits, which always
+ * do.
+ */
+gchar *sim_data_export_format_double (gchar *buffer, gdouble value)
+{
+	gchar digits[SIM_DATA_EXPORT_DIGITS];
+	gchar *p = buffer;
+	guint64 mantissa;
+	gint exponent, n_digits;
+
+	if (isnan (value)) {
+		memcpy (p, "nan", 3);
+		return p + 3;
+	}
+	if (signbit (value)) {
+		*p++ = '-';
+		value = -value;
+	}
+	if (isinf (value)) {
+		memcpy (p, "inf", 3);
+		return p + 3;
+	}
+	if (value == 0.0) {
+		*p++ = '0';
+		return p;
+	}
+
+	mantissa = significant_digits (value, &exponent);
+
+	for (gint i = SIM_DATA_EXPORT_DIGITS - 1; i >= 0; i--) {
+		digits[i] = '0' + mantissa % 10;
+		mantissa /= 10;
+	}
+	n_digits = SIM_DATA_EXPORT_DIGITS;
+	while (n_digits > 1 && digits[n_digits - 1] == '0')
+		n_digits--;
+
+	// the same choice printf's %g makes
+	if (exponent >= -4 && exponent < SIM_DATA_EXPORT_DIGITS) {
+		if (exponent < 0) {
+			*p++ = '0';
+			*p++ = '.';
+			for (gint i = -1; i > exponent; i--)
+				*p++ = '0';
+			memcpy (p, digits, n_digits);
+			p += n_digits;
+		} else {
+			for (gint i = 0; i <= exponent; i++)
+				*p++ = i < n_digits ? digits[i] : '0';
+			if (n_digits > exponent + 1) {
+				*p++ = '.';
+				memcpy (p, digits + exponent + 1, n_digits - exponent - 1);
+				p += n_digits - exponent - 1;
+			}
+		}
+	} else {
+		*p++ = digits[0];
+		if (n_digits > 1) {
+			*p++ = '.';
+			memcpy (p, digits + 1, n_digits - 1);
+			p += n_digits - 1;
+		}
+		*p++ = 'e';
+		*p++ = exponent < 0 ? '-' : '+';
+		exponent = ABS (exponent);
+		if (exponent >= 100)
+			*p++ = '0' + exponent / 100;
+		*p++ = '0' + exponent / 10 % 10;
+		*p++ = '0' + exponent % 10;
+	}
+
+	return p;
+}
+
+SimDataExportFormat sim_data_export_format_from_filename (const gchar *filename)
+{
+	g_return_val_if_fail (filename != NULL, SIM_DATA_EXPORT_CSV);
+
+	if (g_str_has_suffix (filename, ".tsv") || g_str_has_suffix (filename, ".txt"))
+		return SIM_DATA_EXPORT_TSV;
+	if (g_str_has_suffix (filename, ".oregcol"))
+		return SIM_DATA_EXPORT_BINARY;
+	return SIM_DATA_EXPORT_CSV;
+}
+
+/*
+ * Everything goes through one big buffer, a multi-million row result
+ * ends up in the file with a few hundred writes.
+ */
+typedef struct
+{
+	FILE *file;
+	gchar *buffer;
+	gsize used;
+	gboolean failed;
+} ExportWriter;
+
+static void writer_flush (ExportWriter *writer)
+{
+	if (!writer->failed && writer->used > 0)
+		writer->failed = fwrite (writer->buffer, 1, writer->used, writer->file) != writer->used;
+	writer->used = 0;
+}
+
+// Room for @length more bytes in the buffer.
+static gchar *writer_reserve (ExportWriter *writer, gsize length)
+{
+	if (writer->used + length > SIM_DATA_EXPORT_BUFFER_SIZE)
+		writer_flush (writer);
+	return writer->buffer + writer->used;
+}
+
+static void writer_put (ExportWriter *writer, gconstpointer data, gsize length)
+{
+	if (length > SIM_DATA_EXPORT_BUFFER_SIZE) {
+		writer_flush (writer);
+		if (!writer->failed)
+			writer->failed = fwrite (data, 1, length, writer->file) != length;
+		return;
+	}
+	memcpy (writer_reserve (writer, length), data, length);
+	writer->used += length;
+}
+
+static void writer_put_u32 (ExportWriter *writer, guint32 value)
+{
+	value = GUINT32_TO_LE (value);
+	writer_put (writer, &value, sizeof(value));
+}
+
+static void writer_put_u64 (ExportWriter *writer, guint64 value)
+{
+	value = GUINT64_TO_LE (value);
+	writer_put (writer, &value, sizeof(value));
+}
+
+static void writer_put_string (ExportWriter *writer, const gchar *string)
+{
+	guint32 length;
+
+	if (string == NULL || *string == '\0') {
+		writer_put_u32 (writer, 0);
+		return;
+	}
+
+	length = strlen (string);
+	writer_put_u32 (writer, length);
+	writer_put (writer, string, length);
+}
+
+static void writer_put_doubles (ExportWriter *writer, const gdouble *values, gsize n)
+{
+#if G_BYTE_ORDER == G_LITTLE_ENDIAN
+	writer_put (writer, values, n * sizeof(gdouble));
+#else
+	for (gsize i = 0; i < n; i++) {
+		guint64 bits;
+		memcpy (&bits, &values[i], sizeof(bits));
+		writer_put_u64 (writer, bits);
+	}
+#endif
+}
+
+/**
+ * Names with the separator, quotes or line breaks in them are quoted
+ * the CSV way. TSV has no quoting, those become spaces.
+ */
+static void writer_put_name (ExportWriter *writer, const gchar *name, gchar separator)
+{
+	if (name == NULL)
+		return;
+
+	if (separator == '\t') {
+		for (const gchar *c = name; *c; c++) {
+			gchar ch = (*c == '\t' || *c == '\n' || *c == '\r') ? ' ' : *c;
+			writer_put (writer, &ch, 1);
+		}
+	} else if (strpbrk (name, ",\"\n\r") != NULL) {
+		writer_put (writer, "\"", 1);
+		for (const gchar *c = name; *c; c++) {
+			if (*c == '"')
+				writer_put (writer, "\"", 1);
+			writer_put (writer, c, 1);
+		}
+		writer_put (writer, "\"", 1);
+	} else {
+		writer_put (writer, name, strlen (name));
+	}
+}
+
+static void sim_data_export_text (ExportWriter *writer, const SimulationData *sdat,
+                                  const guint *columns, guint n_columns, guint64 rows,
+                                  gchar separator)
+{
+	for (guint c = 0; c < n_columns; c++) {
+		if (c > 0)
+			writer_put (writer, &separator, 1);
+		writer_put_name (writer, sdat->var_names[columns[c]], separator);
+	}
+	writer_put (writer, "\n", 1);
+
+	for (guint64 row = 0; row < rows && !writer->failed; row++) {
+		for (guint c = 0; c < n_columns; c++) {
+			gchar *p = writer_reserve (writer, SIM_DATA_EXPORT_DOUBLE_SIZE + 1);
+
+			if (c > 0)
+				*p++ = separator;
+			p = sim_data_export_format_double (
+			    p, g_array_index (sdat->data[columns[c]], gdouble, row));
+			writer->used = p - writer->buffer;
+		}
+		*writer_reserve (writer, 1) = '\n';
+		writer->used++;
+	}
+}
+
+static void sim_data_export_binary (ExportWriter *writer, const SimulationData *sdat,
+                                    const guint *columns, guint n_columns, guint64 rows)
+{
+	static const gchar padding[8] = {0};
+	gsize header = sizeof(sim_data_export_magic) + 2 * sizeof(guint32) + sizeof(guint64);
+
+	writer_put (writer, sim_data_export_magic, sizeof(sim_data_export_magic));
+	writer_put_u32 (writer, SIM_DATA_EXPORT_VERSION);
+	writer_put_u32 (writer, n_columns);
+	writer_put_u64 (writer, rows);
+
+	for (guint c = 0; c < n_columns; c++) {
+		const gchar *name = sdat->var_names[columns[c]];
+		const gchar *unit = sdat->var_units ? sdat->var_units[columns[c]] : NULL;
+
+		writer_put_string (writer, name);
+		writer_put_string (writer, unit);
+		header += 2 * sizeof(guint32) + (name ? strlen (name) : 0) + (unit ? strlen (unit) : 0);
+	}
+	writer_put (writer, padding, (8 - header % 8) % 8);
+
+	for (guint c = 0; c < n_columns; c++)
+		writer_put_doubles (writer, (const gdouble *)sdat->data[columns[c]]->data, rows);
+}
+
+/**
+ * Like sim_data_file_save the data goes to a temporary file first, an
+ * export that fails half way does not clobber an older one.
+ */
+gboolean sim_data_export (const SimulationData *sdat, const guint *columns, guint n_columns,
+                          SimDataExportFormat format, const gchar *filename, GError **error)
+{
+	g_return_val_if_fail (sdat != NULL, FALSE);
+	g_return_val_if_fail (filename != NULL, FALSE);
+
+	// before anything is allocated or created
+	for (guint c = 0; columns != NULL && c < n_columns; c++)
+		g_return_val_if_fail (columns[c] < (guint)sdat->n_variables, FALSE);
+
+	guint *all = NULL;
+	if (columns == NULL) {
+		n_columns = sdat->n_variables;
+		columns = all = g_new (guint, MAX (n_columns, 1));
+		for (guint c = 0; c < n_columns; c++)
+			all[c] = c;
+	}
+
+	// the simulator fills the columns in lockstep, a short one is cut off
+	// while the results come in
+	guint64 rows = n_columns > 0 ? G_MAXUINT64 : 0;
+	for (guint c = 0; c < n_columns; c++)
+		rows = MIN (rows, sdat->data[columns[c]]->len);
+
+	gchar *tmp_filename = g_strconcat (filename, ".tmp", NULL);
+	FILE *file = g_fopen (tmp_filename, "wb");
+	if (file == NULL) {
+		int saved_errno = errno;
+		g_set_error (error, G_FILE_ERROR, g_file_error_from_errno (saved_errno),
+		             _ ("Could not write %s: %s"), tmp_filename, g_strerror (saved_errno));
+		g_free (tmp_filename);
+		g_free (all);
+		return FALSE;
+	}
+
+	ExportWriter writer = {file, g_malloc (SIM_DATA_EXPORT_BUFFER_SIZE), 0, FALSE};
+	switch (format) {
+	case SIM_DATA_EXPORT_CSV:
+		sim_data_export_text (&writer, sdat, columns, n_columns, rows, ',');
+		break;
+	case SIM_DATA_EXPORT_TSV:
+		sim_data_export_text (&writer, sdat, columns, n_columns, rows, '\t');
+		break;
+	case SIM_DATA_EXPORT_BINARY:
+		sim_data_export_binary (&writer, sdat, columns, n_columns, rows);
+		break;
+	}
+	writer_flush (&writer);
+	g_free (writer.buffer);
+	g_free (all);
+
+	gboolean success = !writer.failed;
+	int saved_errno = errno;
+	if (fclose (file) != 0 && success) {
+		saved_errno = errno;
+		success = FALSE;
+	}
+
+	if (success && g_rename (tmp_filename, filename) != 0) {
+		saved_errno = errno;
+		success = FALSE;
+	}
+	if (!success) {
+		g_set_error (error, G_FILE_ERROR, g_file_error_from_errno (saved_errno),
+		             _ ("Could not write %s: %s"), filename, g_strerror (saved_errno));
+		g_unlink (tmp_filename);
+	}
+	g_free (tmp_filename);
+
+	return success;
+}
@@ -0,0 +1,83 @@
+/*
+ * sim-data-export.h
+ *
+ *
+ * Authors:
+ *  Michi <st101564@stud.uni-stuttgart.de>
+ *
+ * Web page: https://ahoi.io/project/oregano
+ *
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+
+#ifndef SIM_DATA_EXPORT_H_
+#define SIM_DATA_EXPORT_H_
+
+#include <glib.h>
+
+#include "simulation.h"
+
+/**
+ * Export of simulation results for other programs.
+ *
+ * CSV and TSV have a header line with the variable names and one line
+ * per point. The numbers are written with 15 significant digits, 17 if
+ * 15 do not read back to the very same double. That is not always the
+ * shortest form that does.
+ *
+ * The binary columnar format, everything little endian:
+ *
+ *   "OREGCOL" '\0'                        magic
+ *   u32 version, u32 number of columns, u64 number of rows
+ *   per column: u32 length + name, u32 length + unit
+ *   zero padding up to a multiple of 8 bytes
+ *   per column: rows x f64
+ *
+ * so every column can be mapped, e.g. numpy.memmap with an offset.
+ */
+
+#define SIM_DATA_EXPORT_VERSION 1
+
+typedef enum {
+	SIM_DATA_EXPORT_CSV,
+	SIM_DATA_EXPORT_TSV,
+	SIM_DATA_EXPORT_BINARY
+} SimDataExportFormat;
+
+// room sim_data_export_format_double needs at most
+#define SIM_DATA_EXPORT_DOUBLE_SIZE 32
+
+// .tsv and .txt are TSV, .oregcol binary, anything else CSV
+SimDataExportFormat sim_data_export_format_from_filename (const gchar *filename);
+
+/**
+ * Writes the variables @columns of @sdat to @filename, all of them if
+ * @columns is NULL. The first variable is the x axis (time, frequency
+ * or the swept source), pass 0 first to have it in the file.
+ */
+gboolean sim_data_export (const SimulationData *sdat, const guint *columns, guint n_columns,
+                          SimDataExportFormat format, const gchar *filename, GError **error);
+
+/**
+ * Writes @value to @buffer with 15 or 17 digits as above, where long
+ * double is wider than double several times faster than g_ascii_dtostr.
+ * Returns the end of the text, it is not terminated.
+ */
+gchar *sim_data_export_format_double (gchar *buffer, gdouble value);
+
+#endif /* SIM_DATA_EXPORT_H_ */
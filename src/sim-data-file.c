@@ -0,0 +1,479 @@
+/*
+ * sim-data-file.c
+ *
+ *
+ * Authors:
+ *  Michi <st101564@stud.uni-stuttgart.de>
+ *
+ * Web page: https://ahoi.io/project/oregano
+ *
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include <errno.h>
+#include <string.h>
+#include <stdio.h>
+#include <glib.h>
+#include <glib/gi18n.h>
+#include <glib/gstdio.h>
+
+#include "sim-data-file.h"
+#include "errors.h"
+
+static const gchar sim_data_file_magic[8] = "OREGRES";
+
+#define SIM_DATA_FILE_N_PARAMETERS 4
+
+/*
+ * Writing goes through a callback, so the same code serializes into
+ * memory and streams into a file without holding a second copy of the
+ * data.
+ */
+typedef gboolean (*SimDataFileWriteFunc) (gconstpointer data, gsize length, gpointer user_data);
+
+typedef struct
+{
+	SimDataFileWriteFunc write;
+	gpointer user_data;
+	gboolean failed;
+} SimDataFileWriter;
+
+static void writer_put (SimDataFileWriter *writer, gconstpointer data, gsize length)
+{
+	if (!writer->failed && length > 0)
+		writer->failed = !writer->write (data, length, writer->user_data);
+}
+
+static void writer_put_u32 (SimDataFileWriter *writer, guint32 value)
+{
+	value = GUINT32_TO_LE (value);
+	writer_put (writer, &value, sizeof(value));
+}
+
+static void writer_put_doubles (SimDataFileWriter *writer, const gdouble *values, gsize n)
+{
+#if G_BYTE_ORDER == G_LITTLE_ENDIAN
+	writer_put (writer, values, n * sizeof(gdouble));
+#else
+	for (gsize i = 0; i < n; i++) {
+		guint64 bits;
+		memcpy (&bits, &values[i], sizeof(bits));
+		bits = GUINT64_TO_LE (bits);
+		writer_put (writer, &bits, sizeof(bits));
+	}
+#endif
+}
+
+static void writer_put_string (SimDataFileWriter *writer, const gchar *string)
+{
+	guint32 length = string ? strlen (string) : 0;
+
+	writer_put_u32 (writer, length);
+	writer_put (writer, string, length);
+}
+
+/**
+ * The fields of the Analysis union that are not part of SimulationData.
+ */
+static void sim_data_file_get_parameters (const SimulationData *sdat, gdouble *parameters)
+{
+	const Analysis *analysis = (const Analysis *)sdat;
+
+	memset (parameters, 0, SIM_DATA_FILE_N_PARAMETERS * sizeof(gdouble));
+	switch (sdat->type) {
+	case ANALYSIS_TYPE_TRANSIENT:
+		parameters[0] = analysis->transient.sim_length;
+		parameters[1] = analysis->transient.step_size;
+		break;
+	case ANALYSIS_TYPE_AC:
+		parameters[0] = analysis->ac.sim_length;
+		parameters[1] = analysis->ac.start;
+		parameters[2] = analysis->ac.stop;
+		break;
+	case ANALYSIS_TYPE_DC_TRANSFER:
+		parameters[0] = analysis->dc.sim_length;
+		parameters[1] = analysis->dc.start;
+		parameters[2] = analysis->dc.stop;
+		parameters[3] = analysis->dc.step;
+		break;
+	case ANALYSIS_TYPE_FOURIER:
+		parameters[0] = analysis->fourier.freq;
+		parameters[1] = analysis->fourier.nb_var;
+		break;
+	default:
+		break;
+	}
+}
+
+static void sim_data_file_set_parameters (SimulationData *sdat, const gdouble *parameters)
+{
+	Analysis *analysis = ANALYSIS (sdat);
+
+	switch (sdat->type) {
+	case ANALYSIS_TYPE_TRANSIENT:
+		analysis->transient.sim_length = parameters[0];
+		analysis->transient.step_size = parameters[1];
+		break;
+	case ANALYSIS_TYPE_AC:
+		analysis->ac.sim_length = parameters[0];
+		analysis->ac.start = parameters[1];
+		analysis->ac.stop = parameters[2];
+		break;
+	case ANALYSIS_TYPE_DC_TRANSFER:
+		analysis->dc.sim_length = parameters[0];
+		analysis->dc.start = parameters[1];
+		analysis->dc.stop = parameters[2];
+		analysis->dc.step = parameters[3];
+		break;
+	case ANALYSIS_TYPE_FOURIER:
+		analysis->fourier.freq = parameters[0];
+		analysis->fourier.nb_var = parameters[1];
+		break;
+	default:
+		break;
+	}
+}
+
+static gboolean sim_data_file_write (SimDataFileWriter *writer, GList *analyses)
+{
+	writer_put (writer, sim_data_file_magic, sizeof(sim_data_file_magic));
+	writer_put_u32 (writer, SIM_DATA_FILE_VERSION);
+	writer_put_u32 (writer, g_list_length (analyses));
+
+	for (GList *iter = analyses; iter; iter = iter->next) {
+		const SimulationData *sdat = SIM_DATA (iter->data);
+		gdouble parameters[SIM_DATA_FILE_N_PARAMETERS];
+
+		writer_put_u32 (writer, sdat->type);
+		writer_put_u32 (writer, sdat->n_variables);
+		sim_data_file_get_parameters (sdat, parameters);
+		writer_put_doubles (writer, parameters, SIM_DATA_FILE_N_PARAMETERS);
+
+		for (gint i = 0; i < sdat->n_variables; i++) {
+			writer_put_string (writer, sdat->var_names ? sdat->var_names[i] : NULL);
+			writer_put_string (writer, sdat->var_units ? sdat->var_units[i] : NULL);
+		}
+
+		gboolean has_min_max = sdat->min_data != NULL && sdat->max_data != NULL;
+		writer_put_u32 (writer, has_min_max);
+		if (has_min_max) {
+			writer_put_doubles (writer, sdat->min_data, sdat->n_variables);
+			writer_put_doubles (writer, sdat->max_data, sdat->n_variables);
+		}
+
+		writer_put_u32 (writer, g_list_length (sdat->functions));
+		for (GList *f = sdat->functions; f; f = f->next) {
+			const SimulationFunction *function = f->data;
+			writer_put_u32 (writer, function->type);
+			writer_put_u32 (writer, function->first);
+			writer_put_u32 (writer, function->second);
+		}
+
+		for (gint i = 0; i < sdat->n_variables; i++) {
+			GArray *column = sdat->data[i];
+			writer_put_u32 (writer, column ? column->len : 0);
+			if (column)
+				writer_put_doubles (writer, (const gdouble *)column->data, column->len);
+		}
+	}
+
+	return !writer->failed;
+}
+
+static gboolean sim_data_file_write_string (gconstpointer data, gsize length, gpointer user_data)
+{
+	g_string_append_len (user_data, data, length);
+	return TRUE;
+}
+
+static gboolean sim_data_file_write_stream (gconstpointer data, gsize length, gpointer user_data)
+{
+	return fwrite (data, 1, length, user_data) == length;
+}
+
+/**
+ * @returns the binary representation of @analyses
+ */
+GString *sim_data_file_serialize (GList *analyses)
+{
+	GString *buffer = g_string_new (NULL);
+	SimDataFileWriter writer = {sim_data_file_write_string, buffer, FALSE};
+
+	sim_data_file_write (&writer, analyses);
+
+	return buffer;
+}
+
+/**
+ * Streams @analyses into @filename. The data is written to a temporary
+ * file first and renamed afterwards, so a crash never leaves a half
+ * written result file behind.
+ */
+gboolean sim_data_file_save (GList *analyses, const gchar *filename, GError **error)
+{
+	g_return_val_if_fail (filename != NULL, FALSE);
+
+	gchar *tmp_filename = g_strconcat (filename, ".tmp", NULL);
+	FILE *file = g_fopen (tmp_filename, "wb");
+	if (file == NULL) {
+		int saved_errno = errno;
+		g_set_error (error, G_FILE_ERROR, g_file_error_from_errno (saved_errno),
+		             _ ("Could not write %s: %s"), tmp_filename, g_strerror (saved_errno));
+		g_free (tmp_filename);
+		return FALSE;
+	}
+
+	SimDataFileWriter writer = {sim_data_file_write_stream, file, FALSE};
+	gboolean success = sim_data_file_write (&writer, analyses);
+	int saved_errno = errno;
+	if (fclose (file) != 0 && success) {
+		saved_errno = errno;
+		success = FALSE;
+	}
+
+	if (success && g_rename (tmp_filename, filename) != 0) {
+		saved_errno = errno;
+		success = FALSE;
+	}
+	if (!success) {
+		g_set_error (error, G_FILE_ERROR, g_file_error_from_errno (saved_errno),
+		             _ ("Could not write %s: %s"), filename, g_strerror (saved_errno));
+		g_unlink (tmp_filename);
+	}
+	g_free (tmp_filename);
+
+	return success;
+}
+
+typedef struct
+{
+	const guint8 *data;
+	gsize length;
+	gsize position;
+	gboolean failed;
+} SimDataFileReader;
+
+static gconstpointer reader_get (SimDataFileReader *reader, gsize length)
+{
+	if (reader->failed || length > reader->length - reader->position) {
+		reader->failed = TRUE;
+		return NULL;
+	}
+	gconstpointer data = reader->data + reader->position;
+	reader->position += length;
+	return data;
+}
+
+static guint32 reader_get_u32 (SimDataFileReader *reader)
+{
+	guint32 value;
+	gconstpointer data = reader_get (reader, sizeof(value));
+
+	if (data == NULL)
+		return 0;
+	memcpy (&value, data, sizeof(value));
+	return GUINT32_FROM_LE (value);
+}
+
+static gboolean reader_get_doubles (SimDataFileReader *reader, gdouble *values, gsize n)
+{
+	if (n > G_MAXSIZE / sizeof(gdouble)) {
+		reader->failed = TRUE;
+		return FALSE;
+	}
+	gconstpointer data = reader_get (reader, n * sizeof(gdouble));
+
+	if (data == NULL)
+		return FALSE;
+	memcpy (values, data, n * sizeof(gdouble));
+#if G_BYTE_ORDER != G_LITTLE_ENDIAN
+	for (gsize i = 0; i < n; i++) {
+		guint64 bits;
+		memcpy (&bits, &values[i], sizeof(bits));
+		bits = GUINT64_FROM_LE (bits);
+		memcpy (&values[i], &bits, sizeof(bits));
+	}
+#endif
+	return TRUE;
+}
+
+static gchar *reader_get_string (SimDataFileReader *reader)
+{
+	guint32 length = reader_get_u32 (reader);
+	const gchar *data = reader_get (reader, length);
+
+	if (data == NULL)
+		return NULL;
+	return g_strndup (data, length);
+}
+
+/**
+ * Allocates an Analysis, so the result can be used like the results of
+ * the engines (ANALYSIS () casts are valid).
+ */
+static SimulationData *sim_data_file_read_analysis (SimDataFileReader *reader)
+{
+	SimulationData *sdat = SIM_DATA (g_new0 (Analysis, 1));
+	gdouble parameters[SIM_DATA_FILE_N_PARAMETERS];
+
+	sdat->type = reader_get_u32 (reader);
+	guint32 n_variables = reader_get_u32 (reader);
+	reader_get_doubles (reader, parameters, SIM_DATA_FILE_N_PARAMETERS);
+	if (reader->failed || sdat->type > ANALYSIS_TYPE_UNKNOWN ||
+	    n_variables > (reader->length - reader->position) / (3 * sizeof(guint32))) {
+		reader->failed = TRUE;
+		return sdat;
+	}
+	sim_data_file_set_parameters (sdat, parameters);
+
+	sdat->n_variables = n_variables;
+	sdat->var_names = g_new0 (gchar *, n_variables + 1);
+	sdat->var_units = g_new0 (gchar *, n_variables + 1);
+	sdat->data = g_new0 (GArray *, n_variables);
+	for (guint32 i = 0; i < n_variables; i++) {
+		sdat->var_names[i] = reader_get_string (reader);
+		sdat->var_units[i] = reader_get_string (reader);
+		// keep the arrays valid even if the file is truncated, the
+		// caller frees everything in that case
+		sdat->data[i] = g_array_new (FALSE, FALSE, sizeof(gdouble));
+	}
+
+	if (reader_get_u32 (reader)) {
+		sdat->min_data = g_new (gdouble, n_variables);
+		sdat->max_data = g_new (gdouble, n_variables);
+		reader_get_doubles (reader, sdat->min_data, n_variables);
+		reader_get_doubles (reader, sdat->max_data, n_variables);
+	}
+
+	guint32 n_functions = reader_get_u32 (reader);
+	for (guint32 i = 0; i < n_functions && !reader->failed; i++) {
+		SimulationFunction *function = g_new0 (SimulationFunction, 1);
+		function->type = reader_get_u32 (reader);
+		function->first = reader_get_u32 (reader);
+		function->second = reader_get_u32 (reader);
+		sdat->functions = g_list_append (sdat->functions, function);
+	}
+
+	for (guint32 i = 0; i < n_variables && !reader->failed; i++) {
+		guint32 n_points = reader_get_u32 (reader);
+		if (reader->failed || n_points > (reader->length - reader->position) / sizeof(gdouble)) {
+			reader->failed = TRUE;
+			break;
+		}
+		g_array_set_size (sdat->data[i], n_points);
+		reader_get_doubles (reader, (gdouble *)sdat->data[i]->data, n_points);
+	}
+	sdat->got_var = n_variables;
+	sdat->got_points = n_variables > 0 ? sdat->data[0]->len : 0;
+
+	return sdat;
+}
+
+/**
+ * @returns a list of analyses, free with sim_data_file_free_analyses
+ */
+GList *sim_data_file_deserialize (const gchar *buffer, gsize length, GError **error)
+{
+	SimDataFileReader reader = {(const guint8 *)buffer, length, 0, FALSE};
+	GList *analyses = NULL;
+
+	const gchar *magic = reader_get (&reader, sizeof(sim_data_file_magic));
+	guint32 version = reader_get_u32 (&reader);
+	if (magic == NULL || memcmp (magic, sim_data_file_magic, sizeof(sim_data_file_magic)) != 0 ||
+	    version != SIM_DATA_FILE_VERSION) {
+		g_set_error_literal (error, OREGANO_ERROR, OREGANO_RESULT_FILE_BAD_FORMAT,
+		                     _ ("Not a simulation result file or unsupported version"));
+		return NULL;
+	}
+
+	guint32 n_analyses = reader_get_u32 (&reader);
+	for (guint32 i = 0; i < n_analyses && !reader.failed; i++)
+		analyses = g_list_prepend (analyses, sim_data_file_read_analysis (&reader));
+	analyses = g_list_reverse (analyses);
+
+	if (reader.failed) {
+		g_set_error_literal (error, OREGANO_ERROR, OREGANO_RESULT_FILE_BAD_FORMAT,
+		                     _ ("The simulation result file is truncated or corrupt"));
+		sim_data_file_free_analyses (analyses);
+		return NULL;
+	}
+
+	return analyses;
+}
+
+/**
+ * The file is mapped, not read, so only the columns end up in memory
+ * once.
+ */
+GList *sim_data_file_load (const gchar *filename, GError **error)
+{
+	g_return_val_if_fail (filename != NULL, NULL);
+
+	GMappedFile *file = g_mapped_file_new (filename, FALSE, error);
+	if (file == NULL)
+		return NULL;
+
+	GList *analyses = sim_data_file_deserialize (g_mapped_file_get_contents (file),
+	                                             g_mapped_file_get_length (file), error);
+	g_mapped_file_unref (file);
+
+	return analyses;
+}
+
+void sim_data_file_free_analyses (GList *analyses)
+{
+	for (GList *iter = analyses; iter; iter = iter->next) {
+		SimulationData *sdat = SIM_DATA (iter->data);
+
+		for (gint i = 0; i < sdat->n_variables; i++) {
+			if (sdat->data[i])
+				g_array_free (sdat->data[i], TRUE);
+		}
+		g_strfreev (sdat->var_names);
+		g_strfreev (sdat->var_units);
+		g_free (sdat->data);
+		g_free (sdat->min_data);
+		g_free (sdat->max_data);
+		g_list_free_full (sdat->functions, g_free);
+		g_free (sdat);
+	}
+	g_list_free (analyses);
+}
+
+/**
+ * @returns the number of bytes the data of @sdat occupies, the columns
+ * dominate by far
+ */
+gsize sim_data_get_size (const SimulationData *sdat)
+{
+	gsize size = sizeof(Analysis);
+
+	g_return_val_if_fail (sdat != NULL, 0);
+
+	for (gint i = 0; i < sdat->n_variables; i++) {
+		if (sdat->data && sdat->data[i])
+			size += sizeof(GArray) + sdat->data[i]->len * sizeof(gdouble);
+		if (sdat->var_names && sdat->var_names[i])
+			size += strlen (sdat->var_names[i]) + 1;
+		if (sdat->var_units && sdat->var_units[i])
+			size += strlen (sdat->var_units[i]) + 1;
+	}
+	if (sdat->min_data)
+		size += 2 * sdat->n_variables * sizeof(gdouble);
+
+	return size;
+}
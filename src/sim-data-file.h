@@ -0,0 +1,63 @@
+/*
+ * sim-data-file.h
+ *
+ *
+ * Authors:
+ *  Michi <st101564@stud.uni-stuttgart.de>
+ *
+ * Web page: https://ahoi.io/project/oregano
+ *
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef SIM_DATA_FILE_H_
+#define SIM_DATA_FILE_H_
+
+#include <glib.h>
+
+#include "simulation.h"
+
+/**
+ * Binary file format for simulation results (a list of analyses).
+ *
+ * Everything is little endian:
+ *
+ *   "OREGRES" '\0'                        magic
+ *   u32 version, u32 number of analyses
+ *   per analysis:
+ *     u32 type, u32 number of variables
+ *     4 x f64 analysis parameters (see sim_data_file.c)
+ *     per variable: u32 length + name, u32 length + unit
+ *     u32 has min/max, [n x f64 min, n x f64 max]
+ *     u32 number of functions, per function 3 x u32 (type, first, second)
+ *     per variable: u32 number of points, points x f64
+ *
+ * The columns come last and are contiguous, so they can be read without
+ * any parsing.
+ */
+
+#define SIM_DATA_FILE_VERSION 1
+
+gboolean sim_data_file_save (GList *analyses, const gchar *filename, GError **error);
+GList *sim_data_file_load (const gchar *filename, GError **error);
+GString *sim_data_file_serialize (GList *analyses);
+GList *sim_data_file_deserialize (const gchar *buffer, gsize length, GError **error);
+void sim_data_file_free_analyses (GList *analyses);
+
+gsize sim_data_get_size (const SimulationData *sdat);
+
+#endif /* SIM_DATA_FILE_H_ */
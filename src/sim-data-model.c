@@ -0,0 +1,274 @@
+/*
+ * sim-data-model.c
+ *
+ *
+ * Authors:
+ *  Michi <st101564@stud.uni-stuttgart.de>
+ *
+ * Web page: https://ahoi.io/project/oregano
+ *
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include <math.h>
+
+#include "sim-data-model.h"
+
+struct _SimDataModelPriv
+{
+	SimulationData *sdat;
+	// model column -> column of sdat->data
+	guint *columns;
+	guint n_columns;
+	gint n_rows;
+
+	// keeps sdat alive, usually the engine that produced it
+	GObject *owner;
+
+	// iters are only valid for the model they were created by
+	gint stamp;
+};
+
+static void sim_data_model_tree_model_init (GtkTreeModelIface *iface);
+
+G_DEFINE_TYPE_WITH_CODE (SimDataModel, sim_data_model, G_TYPE_OBJECT,
+                         G_IMPLEMENT_INTERFACE (GTK_TYPE_TREE_MODEL,
+                                                sim_data_model_tree_model_init));
+
+static void sim_data_model_finalize (GObject *object)
+{
+	SimDataModel *model = SIM_DATA_MODEL (object);
+
+	if (model->priv) {
+		g_free (model->priv->columns);
+		if (model->priv->owner)
+			g_object_unref (model->priv->owner);
+		g_free (model->priv);
+	}
+
+	G_OBJECT_CLASS (sim_data_model_parent_class)->finalize (object);
+}
+
+static void sim_data_model_class_init (SimDataModelClass *klass)
+{
+	GObjectClass *object_class = G_OBJECT_CLASS (klass);
+
+	object_class->finalize = sim_data_model_finalize;
+}
+
+static void sim_data_model_init (SimDataModel *model)
+{
+	model->priv = g_new0 (SimDataModelPriv, 1);
+	model->priv->stamp = g_random_int ();
+}
+
+/**
+ * @columns indices into sdat->data, one per model column. If NULL all
+ * columns of @sdat are shown in their original order.
+ * @owner (nullable) is referenced for the lifetime of the model, so the
+ * arrays of @sdat are not freed under the view's feet.
+ */
+SimDataModel *sim_data_model_new (SimulationData *sdat, const guint *columns, guint n_columns,
+                                  GObject *owner)
+{
+	g_return_val_if_fail (sdat != NULL, NULL);
+
+	SimDataModel *model = g_object_new (TYPE_SIM_DATA_MODEL, NULL);
+	SimDataModelPriv *priv = model->priv;
+
+	priv->sdat = sdat;
+	if (columns == NULL) {
+		priv->n_columns = sdat->n_variables;
+		priv->columns = g_new (guint, priv->n_columns);
+		for (guint i = 0; i < priv->n_columns; i++)
+			priv->columns[i] = i;
+	} else {
+		priv->n_columns = n_columns;
+		priv->columns = g_memdup (columns, n_columns * sizeof(guint));
+	}
+
+	// rows are limited by the shortest column, a simulation that was
+	// aborted may have left the last row incomplete
+	priv->n_rows = sdat->n_variables > 0 ? G_MAXINT : 0;
+	for (guint i = 0; i < priv->n_columns; i++) {
+		g_return_val_if_fail (priv->columns[i] < (guint)sdat->n_variables, model);
+		priv->n_rows = MIN (priv->n_rows, (gint)sdat->data[priv->columns[i]]->len);
+	}
+	if (priv->n_columns == 0)
+		priv->n_rows = 0;
+
+	if (owner)
+		priv->owner = g_object_ref (owner);
+
+	return model;
+}
+
+/**
+ * @returns the column of the SimulationData that is shown in model
+ * column @column
+ */
+guint sim_data_model_get_data_column (SimDataModel *model, gint column)
+{
+	g_return_val_if_fail (IS_SIM_DATA_MODEL (model), 0);
+	g_return_val_if_fail (column >= 0 && column < (gint)model->priv->n_columns, 0);
+
+	return model->priv->columns[column];
+}
+
+static inline void sim_data_model_set_iter (SimDataModel *model, GtkTreeIter *iter, gint row)
+{
+	iter->stamp = model->priv->stamp;
+	iter->user_data = GINT_TO_POINTER (row);
+}
+
+static inline gint sim_data_model_iter_row (GtkTreeIter *iter)
+{
+	return GPOINTER_TO_INT (iter->user_data);
+}
+
+static GtkTreeModelFlags sim_data_model_get_flags (GtkTreeModel *tree_model)
+{
+	return GTK_TREE_MODEL_LIST_ONLY | GTK_TREE_MODEL_ITERS_PERSIST;
+}
+
+static gint sim_data_model_get_n_columns (GtkTreeModel *tree_model)
+{
+	return SIM_DATA_MODEL (tree_model)->priv->n_columns;
+}
+
+static GType sim_data_model_get_column_type (GtkTreeModel *tree_model, gint index)
+{
+	return G_TYPE_DOUBLE;
+}
+
+static gboolean sim_data_model_get_iter (GtkTreeModel *tree_model, GtkTreeIter *iter,
+                                         GtkTreePath *path)
+{
+	SimDataModel *model = SIM_DATA_MODEL (tree_model);
+
+	if (gtk_tree_path_get_depth (path) != 1)
+		return FALSE;
+
+	gint row = gtk_tree_path_get_indices (path)[0];
+	if (row < 0 || row >= model->priv->n_rows)
+		return FALSE;
+
+	sim_data_model_set_iter (model, iter, row);
+	return TRUE;
+}
+
+static GtkTreePath *sim_data_model_get_path (GtkTreeModel *tree_model, GtkTreeIter *iter)
+{
+	g_return_val_if_fail (iter->stamp == SIM_DATA_MODEL (tree_model)->priv->stamp, NULL);
+
+	return gtk_tree_path_new_from_indices (sim_data_model_iter_row (iter), -1);
+}
+
+static void sim_data_model_get_value (GtkTreeModel *tree_model, GtkTreeIter *iter, gint column,
+                                      GValue *value)
+{
+	SimDataModelPriv *priv = SIM_DATA_MODEL (tree_model)->priv;
+
+	g_return_if_fail (iter->stamp == priv->stamp);
+	g_return_if_fail (column >= 0 && column < (gint)priv->n_columns);
+
+	GArray *array = priv->sdat->data[priv->columns[column]];
+	gint row = sim_data_model_iter_row (iter);
+	g_value_init (value, G_TYPE_DOUBLE);
+	// the result manager may have released the columns in the meantime
+	g_value_set_double (value, (guint)row < array->len ? g_array_index (array, gdouble, row) : NAN);
+}
+
+static gboolean sim_data_model_iter_next (GtkTreeModel *tree_model, GtkTreeIter *iter)
+{
+	SimDataModel *model = SIM_DATA_MODEL (tree_model);
+	gint row = sim_data_model_iter_row (iter) + 1;
+
+	if (row >= model->priv->n_rows) {
+		iter->stamp = 0;
+		return FALSE;
+	}
+	sim_data_model_set_iter (model, iter, row);
+	return TRUE;
+}
+
+static gboolean sim_data_model_iter_previous (GtkTreeModel *tree_model, GtkTreeIter *iter)
+{
+	SimDataModel *model = SIM_DATA_MODEL (tree_model);
+	gint row = sim_data_model_iter_row (iter) - 1;
+
+	if (row < 0) {
+		iter->stamp = 0;
+		return FALSE;
+	}
+	sim_data_model_set_iter (model, iter, row);
+	return TRUE;
+}
+
+static gboolean sim_data_model_iter_nth_child (GtkTreeModel *tree_model, GtkTreeIter *iter,
+                                               GtkTreeIter *parent, gint n)
+{
+	SimDataModel *model = SIM_DATA_MODEL (tree_model);
+
+	// it is a list, rows have no children
+	if (parent != NULL || n < 0 || n >= model->priv->n_rows)
+		return FALSE;
+
+	sim_data_model_set_iter (model, iter, n);
+	return TRUE;
+}
+
+static gboolean sim_data_model_iter_children (GtkTreeModel *tree_model, GtkTreeIter *iter,
+                                              GtkTreeIter *parent)
+{
+	return sim_data_model_iter_nth_child (tree_model, iter, parent, 0);
+}
+
+static gboolean sim_data_model_iter_has_child (GtkTreeModel *tree_model, GtkTreeIter *iter)
+{
+	return FALSE;
+}
+
+static gint sim_data_model_iter_n_children (GtkTreeModel *tree_model, GtkTreeIter *iter)
+{
+	if (iter != NULL)
+		return 0;
+	return SIM_DATA_MODEL (tree_model)->priv->n_rows;
+}
+
+static gboolean sim_data_model_iter_parent (GtkTreeModel *tree_model, GtkTreeIter *iter,
+                                            GtkTreeIter *child)
+{
+	return FALSE;
+}
+
+static void sim_data_model_tree_model_init (GtkTreeModelIface *iface)
+{
+	iface->get_flags = sim_data_model_get_flags;
+	iface->get_n_columns = sim_data_model_get_n_columns;
+	iface->get_column_type = sim_data_model_get_column_type;
+	iface->get_iter = sim_data_model_get_iter;
+	iface->get_path = sim_data_model_get_path;
+	iface->get_value = sim_data_model_get_value;
+	iface->iter_next = sim_data_model_iter_next;
+	iface->iter_previous = sim_data_model_iter_previous;
+	iface->iter_children = sim_data_model_iter_children;
+	iface->iter_has_child = sim_data_model_iter_has_child;
+	iface->iter_n_children = sim_data_model_iter_n_children;
+	iface->iter_nth_child = sim_data_model_iter_nth_child;
+	iface->iter_parent = sim_data_model_iter_parent;
+}
@@ -0,0 +1,74 @@
+/*
+ * sim-data-model.h
+ *
+ *
+ * Authors:
+ *  Michi <st101564@stud.uni-stuttgart.de>
+ *
+ * Web page: https://ahoi.io/project/oregano
+ *
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef SIM_DATA_MODEL_H_
+#define SIM_DATA_MODEL_H_
+
+#include <gtk/gtk.h>
+
+#include "simulation.h"
+
+G_BEGIN_DECLS
+
+/**
+ * A flat GtkTreeModel that reads the values straight out of the column
+ * arrays of a SimulationData. Nothing is copied: a row is just an index
+ * and every cell is fetched on demand when the view draws it, so results
+ * with millions of points can be browsed without a GtkListStore.
+ *
+ * Every model column is of type G_TYPE_DOUBLE.
+ */
+
+#define TYPE_SIM_DATA_MODEL (sim_data_model_get_type ())
+#define SIM_DATA_MODEL(obj) (G_TYPE_CHECK_INSTANCE_CAST ((obj), TYPE_SIM_DATA_MODEL, SimDataModel))
+#define SIM_DATA_MODEL_CLASS(klass)                                                               \
+	(G_TYPE_CHECK_CLASS_CAST ((klass), TYPE_SIM_DATA_MODEL, SimDataModelClass))
+#define IS_SIM_DATA_MODEL(obj) (G_TYPE_CHECK_INSTANCE_TYPE ((obj), TYPE_SIM_DATA_MODEL))
+
+typedef struct _SimDataModel SimDataModel;
+typedef struct _SimDataModelClass SimDataModelClass;
+typedef struct _SimDataModelPriv SimDataModelPriv;
+
+struct _SimDataModel
+{
+	GObject parent;
+
+	SimDataModelPriv *priv;
+};
+
+struct _SimDataModelClass
+{
+	GObjectClass parent_class;
+};
+
+GType sim_data_model_get_type (void);
+SimDataModel *sim_data_model_new (SimulationData *sdat, const guint *columns, guint n_columns,
+                                  GObject *owner);
+guint sim_data_model_get_data_column (SimDataModel *model, gint column);
+
+G_END_DECLS
+
+#endif /* SIM_DATA_MODEL_H_ */
@@ -528,3 +528,149 @@ void sim_settings_add_option (SimSettings *sim_settings, SimOption *opt)
 	}
 	sim_settings->options = g_list_append (sim_settings->options, opt);
 }
+
+/*
+ * Key file layout of sim_settings_to_data, the fields are looked up by
+ * offset so that saving and loading can not drift apart.
+ */
+#define SIM_SETTINGS_GROUP "simulation"
+#define SIM_SETTINGS_GROUP_OPTIONS "options"
+
+typedef struct
+{
+	const gchar *key;
+	gsize offset;
+} SimSettingsField;
+
+static const SimSettingsField sim_settings_booleans[] = {
+    {"trans-enable", G_STRUCT_OFFSET (SimSettings, trans_enable)},
+    {"trans-init-cond", G_STRUCT_OFFSET (SimSettings, trans_init_cond)},
+    {"trans-analyze-all", G_STRUCT_OFFSET (SimSettings, trans_analyze_all)},
+    {"trans-step-enable", G_STRUCT_OFFSET (SimSettings, trans_step_enable)},
+    {"ac-enable", G_STRUCT_OFFSET (SimSettings, ac_enable)},
+    {"dc-enable", G_STRUCT_OFFSET (SimSettings, dc_enable)},
+    {"fourier-enable", G_STRUCT_OFFSET (SimSettings, fourier_enable)},
+    {"noise-enable", G_STRUCT_OFFSET (SimSettings, noise_enable)},
+};
+
+static const SimSettingsField sim_settings_strings[] = {
+    {"trans-start", G_STRUCT_OFFSET (SimSettings, trans_start)},
+    {"trans-stop", G_STRUCT_OFFSET (SimSettings, trans_stop)},
+    {"trans-step", G_STRUCT_OFFSET (SimSettings, trans_step)},
+    {"ac-vout", G_STRUCT_OFFSET (SimSettings, ac_vout)},
+    {"ac-type", G_STRUCT_OFFSET (SimSettings, ac_type)},
+    {"ac-npoints", G_STRUCT_OFFSET (SimSettings, ac_npoints)},
+    {"ac-start", G_STRUCT_OFFSET (SimSettings, ac_start)},
+    {"ac-stop", G_STRUCT_OFFSET (SimSettings, ac_stop)},
+    {"dc-vin", G_STRUCT_OFFSET (SimSettings, dc_vin)},
+    {"dc-vout", G_STRUCT_OFFSET (SimSettings, dc_vout)},
+    {"dc-start", G_STRUCT_OFFSET (SimSettings, dc_start)},
+    {"dc-stop", G_STRUCT_OFFSET (SimSettings, dc_stop)},
+    {"dc-step", G_STRUCT_OFFSET (SimSettings, dc_step)},
+    {"fourier-frequency", G_STRUCT_OFFSET (SimSettings, fourier_frequency)},
+    {"noise-vin", G_STRUCT_OFFSET (SimSettings, noise_vin)},
+    {"noise-vout", G_STRUCT_OFFSET (SimSettings, noise_vout)},
+    {"noise-type", G_STRUCT_OFFSET (SimSettings, noise_type)},
+    {"noise-npoints", G_STRUCT_OFFSET (SimSettings, noise_npoints)},
+    {"noise-start", G_STRUCT_OFFSET (SimSettings, noise_start)},
+    {"noise-stop", G_STRUCT_OFFSET (SimSettings, noise_stop)},
+};
+
+/**
+ * Flattens the settings into a key file, e.g. to hand them to another
+ * process together with the netlist.
+ */
+gchar *sim_settings_to_data (const SimSettings *sim_settings, gsize *length)
+{
+	GKeyFile *key_file = g_key_file_new ();
+	gint i;
+
+	for (i = 0; i < G_N_ELEMENTS (sim_settings_booleans); i++)
+		g_key_file_set_boolean (
+		    key_file, SIM_SETTINGS_GROUP, sim_settings_booleans[i].key,
+		    G_STRUCT_MEMBER (gboolean, sim_settings, sim_settings_booleans[i].offset));
+
+	for (i = 0; i < G_N_ELEMENTS (sim_settings_strings); i++) {
+		const gchar *value =
+		    G_STRUCT_MEMBER (gchar *, sim_settings, sim_settings_strings[i].offset);
+		if (value != NULL)
+			g_key_file_set_string (key_file, SIM_SETTINGS_GROUP, sim_settings_strings[i].key,
+			                       value);
+	}
+
+	if (sim_settings->fourier_vout != NULL) {
+		guint n = g_slist_length (sim_settings->fourier_vout);
+		const gchar **nodes = g_new0 (const gchar *, n + 1);
+		GSList *iter;
+
+		for (i = 0, iter = sim_settings->fourier_vout; iter; iter = iter->next)
+			nodes[i++] = iter->data;
+		g_key_file_set_string_list (key_file, SIM_SETTINGS_GROUP, "fourier-vout", nodes, n);
+		g_free (nodes);
+	}
+
+	for (GList *iter = sim_settings->options; iter; iter = iter->next) {
+		SimOption *option = iter->data;
+		g_key_file_set_string (key_file, SIM_SETTINGS_GROUP_OPTIONS, option->name,
+		                       option->value ? option->value : "");
+	}
+
+	gchar *data = g_key_file_to_data (key_file, length, NULL);
+	g_key_file_free (key_file);
+	return data;
+}
+
+/**
+ * Counterpart of sim_settings_to_data. Missing keys keep the defaults of
+ * sim_settings_new.
+ */
+SimSettings *sim_settings_new_from_data (const gchar *data, gsize length, GError **error)
+{
+	GKeyFile *key_file = g_key_file_new ();
+	gint i;
+
+	if (!g_key_file_load_from_data (key_file, data, length, G_KEY_FILE_NONE, error)) {
+		g_key_file_free (key_file);
+		return NULL;
+	}
+
+	SimSettings *sim_settings = sim_settings_new ();
+
+	for (i = 0; i < G_N_ELEMENTS (sim_settings_booleans); i++) {
+		const gchar *key = sim_settings_booleans[i].key;
+		if (g_key_file_has_key (key_file, SIM_SETTINGS_GROUP, key, NULL))
+			G_STRUCT_MEMBER (gboolean, sim_settings, sim_settings_booleans[i].offset) =
+			    g_key_file_get_boolean (key_file, SIM_SETTINGS_GROUP, key, NULL);
+	}
+
+	for (i = 0; i < G_N_ELEMENTS (sim_settings_strings); i++) {
+		gchar *value =
+		    g_key_file_get_string (key_file, SIM_SETTINGS_GROUP, sim_settings_strings[i].key, NULL);
+		if (value != NULL) {
+			gchar **field =
+			    &G_STRUCT_MEMBER (gchar *, sim_settings, sim_settings_strings[i].offset);
+			g_free (*field);
+			*field = value;
+		}
+	}
+
+	gchar **nodes =
+	    g_key_file_get_string_list (key_file, SIM_SETTINGS_GROUP, "fourier-vout", NULL, NULL);
+	for (i = 0; nodes && nodes[i]; i++)
+		sim_settings->fourier_vout =
+		    g_slist_append (sim_settings->fourier_vout, g_strdup (nodes[i]));
+	g_strfreev (nodes);
+
+	gchar **names = g_key_file_get_keys (key_file, SIM_SETTINGS_GROUP_OPTIONS, NULL, NULL);
+	for (i = 0; names && names[i]; i++) {
+		SimOption *option = g_new0 (SimOption, 1);
+		option->name = g_strdup (names[i]);
+		option->value =
+		    g_key_file_get_string (key_file, SIM_SETTINGS_GROUP_OPTIONS, names[i], NULL);
+		sim_settings->options = g_list_append (sim_settings->options, option);
+	}
+	g_strfreev (names);
+
+	g_key_file_free (key_file);
+	return sim_settings;
+}
@@ -214,4 +214,8 @@ void sim_settings_add_option (SimSettings *, SimOption *);
 
 gchar *fourier_add_vout(SimSettings *sim_settings, gboolean result, guint i);
 
+gchar *sim_settings_to_data (const SimSettings *sim_settings, gsize *length);
+
+SimSettings *sim_settings_new_from_data (const gchar *data, gsize length, GError **error);
+
 #endif
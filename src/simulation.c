@@ -34,6 +34,7 @@
 
 #include <gtk/gtk.h>
 #include <locale.h>
+#include <string.h>
 #include <glib/gi18n.h>
 
 #include "oregano.h"
@@ -46,6 +47,11 @@
 #include "plot.h"
 #include "gnucap.h"
 #include "log.h"
+#include "result-manager.h"
+#include "resim-scheduler.h"
+#include "op-values.h"
+#include "op-overlay.h"
+#include "node-store.h"
 
 //NULL terminated
 const char const *SimulationFunctionTypeString[] = {
@@ -60,19 +66,30 @@ typedef struct
 	SchematicView *sv;
 	GtkDialog *dialog;
 	OreganoEngine *engine;
+	GCancellable *cancellable;
 	GtkProgressBar *progress_solver;
 	GtkLabel *progress_label_solver;
 	GtkProgressBar *progress_reader;
 	GtkLabel *progress_label_reader;
 	int progress_timeout_id;
 	Log *logstore;
+
+	// automatic simulation after edits, see simulation_set_auto ()
+	ResimScheduler *resim;
+	gulong changed_handler;
+	SchematicView *auto_sv;
+	OreganoEngine *auto_engine;
+	GtkWidget *auto_plot;
+
+	// operating point shown on the sheet
+	GCancellable *op_cancellable;
+	SchematicView *op_sv;
 } Simulation;
 
 static int progress_bar_timeout_cb (Simulation *s);
 static void cancel_cb (GtkWidget *widget, gint arg1, Simulation *s);
-static void engine_done_cb (OreganoEngine *engine, Simulation *s);
-static void engine_aborted_cb (OreganoEngine *engine, Simulation *s);
-static gboolean simulate_cmd (Simulation *s);
+static void engine_run_cb (OreganoEngine *engine, GAsyncResult *result, Simulation *s);
+static gboolean simulate_cmd (Simulation *s, GBytes *netlist);
 
 static int delete_event_cb (GtkWidget *widget, GdkEvent *event, gpointer data) { return FALSE; }
 
@@ -88,7 +105,10 @@ gpointer simulation_new (Schematic *sm, Log *logstore)
 	return s;
 }
 
-void simulation_show_progress_bar (GtkWidget *widget, SchematicView *sv)
+/**
+ * @netlist: nullable, simulated instead of the netlist of the schematic
+ */
+static void simulation_start (SchematicView *sv, GBytes *netlist)
 {
 	GtkWidget *w;
 	GtkBuilder *gui;
@@ -156,7 +176,24 @@ void simulation_show_progress_bar (GtkWidget *widget, SchematicView *sv)
 
 	s->sv = sv;
 
-	simulate_cmd (s);
+	simulate_cmd (s, netlist);
+}
+
+void simulation_show_progress_bar (GtkWidget *widget, SchematicView *sv)
+{
+	simulation_start (sv, NULL);
+}
+
+/**
+ * Simulates @netlist with the engine and the simulation settings of the
+ * schematic of @sv, the results end up in the plot window like the ones
+ * of the schematic.
+ */
+void simulation_run_netlist (SchematicView *sv, GBytes *netlist)
+{
+	g_return_if_fail (netlist != NULL);
+
+	simulation_start (sv, netlist);
 }
 
 static int progress_bar_timeout_cb (Simulation *s)
@@ -189,7 +226,7 @@ static int progress_bar_timeout_cb (Simulation *s)
 	return TRUE;
 }
 
-static void engine_done_cb (OreganoEngine *engine, Simulation *s)
+static void engine_done (OreganoEngine *engine, Simulation *s)
 {
 	if (s->progress_timeout_id != 0) {
 		g_source_remove (s->progress_timeout_id);
@@ -203,6 +240,18 @@ static void engine_done_cb (OreganoEngine *engine, Simulation *s)
 	gtk_widget_destroy (GTK_WIDGET (s->dialog));
 	s->dialog = NULL;
 
+	// older runs may be moved out of memory from here on, the plot window
+	// keeps the engine and therefore the run alive
+	{
+		GDateTime *now = g_date_time_new_now_local ();
+		gchar *time = g_date_time_format (now, "%H:%M:%S");
+		gchar *label = g_strdup_printf ("%s (%s)", schematic_get_title (s->sm), time);
+		result_manager_add (G_OBJECT (s->engine), oregano_engine_get_results (s->engine), label);
+		g_free (label);
+		g_free (time);
+		g_date_time_unref (now);
+	}
+
 	plot_show (s->engine);
 
 	if (oregano_engine_has_warnings (s->engine)) {
@@ -220,7 +269,7 @@ static void engine_done_cb (OreganoEngine *engine, Simulation *s)
 	s->engine = NULL;
 }
 
-static void engine_aborted_cb (OreganoEngine *engine, Simulation *s)
+static void engine_aborted (OreganoEngine *engine, Simulation *s)
 {
 	if (s->progress_timeout_id != 0) {
 		g_source_remove (s->progress_timeout_id);
@@ -241,6 +290,30 @@ static void engine_aborted_cb (OreganoEngine *engine, Simulation *s)
 	s->engine = NULL;
 }
 
+static void engine_run_cb (OreganoEngine *engine, GAsyncResult *result, Simulation *s)
+{
+	GError *e = NULL;
+
+	oregano_engine_run_finish (engine, result, &e);
+
+	// a canceled run that ends after the next one was started
+	if (engine != s->engine) {
+		g_clear_error (&e);
+		return;
+	}
+	g_clear_object (&s->cancellable);
+
+	if (e == NULL) {
+		engine_done (engine, s);
+	} else if (g_error_matches (e, G_IO_ERROR, G_IO_ERROR_CANCELLED)) {
+		// cancel_cb did the rest already
+		g_clear_object (&s->engine);
+	} else {
+		engine_aborted (engine, s);
+	}
+	g_clear_error (&e);
+}
+
 static void cancel_cb (GtkWidget *widget, gint arg1, Simulation *s)
 {
 	g_return_if_fail (s != NULL);
@@ -250,8 +323,8 @@ static void cancel_cb (GtkWidget *widget, gint arg1, Simulation *s)
 		s->progress_timeout_id = 0;
 	}
 
-	if (s->engine)
-		oregano_engine_stop (s->engine);
+	if (s->cancellable)
+		g_cancellable_cancel (s->cancellable);
 
 	gtk_widget_destroy (GTK_WIDGET (s->dialog));
 	s->dialog = NULL;
@@ -260,7 +333,7 @@ static void cancel_cb (GtkWidget *widget, gint arg1, Simulation *s)
 	log_append (s->logstore, _ ("Simulation"), _ ("Canceled."));
 }
 
-static gboolean simulate_cmd (Simulation *s)
+static gboolean simulate_cmd (Simulation *s, GBytes *netlist)
 {
 	OreganoEngine *engine;
 
@@ -269,15 +342,258 @@ static gboolean simulate_cmd (Simulation *s)
 	}
 
 	engine = oregano_engine_factory_create_engine (oregano.engine, s->sm);
+	if (netlist != NULL)
+		oregano_engine_set_netlist (engine, netlist);
 	s->engine = engine;
 
 	s->progress_timeout_id = g_timeout_add (250, (GSourceFunc)progress_bar_timeout_cb, s);
 
+	g_clear_object (&s->cancellable);
+	s->cancellable = g_cancellable_new ();
+	oregano_engine_run_async (engine, s->cancellable, (GAsyncReadyCallback)engine_run_cb, s);
 
-	g_signal_connect (G_OBJECT (engine), "done", G_CALLBACK (engine_done_cb), s);
-	g_signal_connect (G_OBJECT (engine), "aborted", G_CALLBACK (engine_aborted_cb), s);
+	return TRUE;
+}
 
-	oregano_engine_start (engine);
+static void auto_run_cb (OreganoEngine *engine, GAsyncResult *result, Simulation *s)
+{
+	GError *e = NULL;
+	GtkWidget *plot;
+	gboolean canceled, done, replaced;
+	gint x = 0, y = 0;
+	ResimSchedulerStats stats;
 
-	return TRUE;
+	oregano_engine_run_finish (engine, result, &e);
+
+	// automatic simulation was switched off in the meantime
+	if (engine != s->auto_engine) {
+		g_clear_error (&e);
+		return;
+	}
+
+	canceled = g_error_matches (e, G_IO_ERROR, G_IO_ERROR_CANCELLED);
+	done = e == NULL;
+	if (done) {
+		GDateTime *now = g_date_time_new_now_local ();
+		gchar *time = g_date_time_format (now, "%H:%M:%S");
+		gchar *label = g_strdup_printf (_ ("%s (%s, automatic)"), schematic_get_title (s->sm), time);
+		result_manager_add (G_OBJECT (engine), oregano_engine_get_results (engine), label);
+		g_free (label);
+		g_free (time);
+		g_date_time_unref (now);
+
+		// the plot of the previous run is replaced instead of piling up windows
+		replaced = s->auto_plot != NULL;
+		if (replaced) {
+			gtk_window_get_position (GTK_WINDOW (s->auto_plot), &x, &y);
+			gtk_widget_destroy (s->auto_plot);
+		}
+		plot = plot_show_window (engine);
+		if (plot != NULL) {
+			if (replaced)
+				gtk_window_move (GTK_WINDOW (plot), x, y);
+			g_object_add_weak_pointer (G_OBJECT (plot), (gpointer *)&s->auto_plot);
+		}
+		s->auto_plot = plot;
+
+		sheet_clear_op_values (schematic_view_get_sheet (s->auto_sv));
+	} else if (!canceled) {
+		log_append (s->logstore, _ ("Simulation"),
+		            _ ("Automatic simulation aborted. See lines below for details."));
+		schematic_view_log_show (s->auto_sv, TRUE);
+	}
+	g_clear_error (&e);
+	g_clear_object (&s->auto_engine);
+
+	resim_scheduler_run_done (s->resim, canceled);
+
+	if (done) {
+		gchar *str;
+
+		resim_scheduler_get_stats (s->resim, &stats);
+		str = g_strdup_printf (_ ("Finished automatic run %u (%u edits, %u runs canceled)."),
+		                       stats.completed, stats.requested, stats.canceled);
+		log_append (s->logstore, _ ("Simulation"), str);
+		g_free (str);
+	}
+}
+
+static void auto_run (GCancellable *cancellable, Simulation *s)
+{
+	s->auto_engine = oregano_engine_factory_create_engine (oregano.engine, s->sm);
+	oregano_engine_run_async (s->auto_engine, cancellable, (GAsyncReadyCallback)auto_run_cb, s);
+}
+
+static void auto_changed_cb (Schematic *sm, Simulation *s) { resim_scheduler_touch (s->resim); }
+
+/**
+ * Simulates the schematic of @sv again whenever it is edited, with a
+ * single plot window that follows the latest run.
+ */
+void simulation_set_auto (SchematicView *sv, gboolean enable)
+{
+	Simulation *s;
+
+	g_return_if_fail (sv != NULL);
+
+	s = schematic_get_simulation (schematic_view_get_schematic (sv));
+
+	if (enable && s->resim == NULL) {
+		s->auto_sv = sv;
+		s->resim = resim_scheduler_new (500, (ResimSchedulerRunFunc)auto_run, s);
+		s->changed_handler =
+		    g_signal_connect (s->sm, "changed", G_CALLBACK (auto_changed_cb), s);
+		// the current state of the schematic is simulated right away
+		resim_scheduler_touch (s->resim);
+	} else if (!enable && s->resim != NULL && s->auto_sv == sv) {
+		g_signal_handler_disconnect (s->sm, s->changed_handler);
+		s->changed_handler = 0;
+		// auto_run_cb ignores the canceled run
+		resim_scheduler_free (s->resim);
+		s->resim = NULL;
+		g_clear_object (&s->auto_engine);
+		s->auto_sv = NULL;
+	}
+}
+
+/**
+ * The name ngspice knows a part by: the first word of its template,
+ * like V_@refdes.
+ */
+static gchar *op_device_name (Part *part)
+{
+	gchar *template, *refdes, **split, *name;
+
+	template = part_get_property (part, "template");
+	if (template == NULL)
+		return NULL;
+
+	g_strstrip (template);
+	split = g_strsplit (template, " ", 2);
+	refdes = part_get_property (part, "refdes");
+	if (refdes != NULL && g_str_has_suffix (split[0], "@refdes")) {
+		split[0][strlen (split[0]) - strlen ("@refdes")] = '\0';
+		name = g_strconcat (split[0], refdes, NULL);
+	} else {
+		name = g_strdup (split[0]);
+	}
+
+	g_free (refdes);
+	g_strfreev (split);
+	g_free (template);
+	return name;
+}
+
+/**
+ * One voltage per net, at one of its nodes, and the current of every
+ * part ngspice reports one for (the voltage sources).
+ */
+static GArray *op_create_labels (Schematic *sm, const OpValues *values)
+{
+	GArray *labels = op_overlay_labels_new ();
+	GHashTable *nets = g_hash_table_new (g_str_hash, g_str_equal);
+	NodeStore *store = schematic_get_store (sm);
+	GList *nodes, *iter;
+	gdouble value;
+	Coords pos;
+
+	nodes = node_store_get_nodes (store);
+	for (iter = nodes; iter; iter = iter->next) {
+		Node *node = iter->data;
+		const gchar *net = node->netlist_node_name;
+
+		if (net == NULL || g_hash_table_contains (nets, net) ||
+		    !op_values_get_voltage (values, net, &value))
+			continue;
+		g_hash_table_add (nets, (gpointer)net);
+
+		pos.x = node->key.x + 3.;
+		pos.y = node->key.y - 3.;
+		op_overlay_labels_add (labels, &pos, g_strdup_printf ("%.4g V", value));
+	}
+	g_list_free (nodes);
+
+	for (iter = store->parts; iter; iter = iter->next) {
+		Part *part = iter->data;
+		gchar *device = op_device_name (part);
+
+		if (device != NULL && op_values_get_current (values, device, &value)) {
+			item_data_get_pos (ITEM_DATA (part), &pos);
+			pos.y -= 3.;
+			op_overlay_labels_add (labels, &pos, g_strdup_printf ("%.4g A", value));
+		}
+		g_free (device);
+	}
+
+	g_hash_table_destroy (nets);
+	return labels;
+}
+
+static void op_run_cb (GObject *source, GAsyncResult *result, Simulation *s)
+{
+	GError *e = NULL;
+	OpValues *values;
+
+	values = op_values_run_finish (result, &e);
+	if (g_error_matches (e, G_IO_ERROR, G_IO_ERROR_CANCELLED)) {
+		// a newer run took over or the view was closed
+		g_clear_error (&e);
+		return;
+	}
+	g_clear_object (&s->op_cancellable);
+
+	if (values == NULL) {
+		log_append_error (s->logstore, _ ("Simulation"),
+		                  _ ("Could not compute the operating point."), e);
+		schematic_view_log_show (s->op_sv, TRUE);
+		g_clear_error (&e);
+		return;
+	}
+
+	sheet_show_op_values (schematic_view_get_sheet (s->op_sv), op_create_labels (s->sm, values));
+	op_values_free (values);
+}
+
+/**
+ * Computes only the DC operating point and annotates the sheet of @sv
+ * with its node voltages and branch currents.
+ */
+void simulation_show_op_values (GtkWidget *widget, SchematicView *sv)
+{
+	Simulation *s;
+
+	g_return_if_fail (sv != NULL);
+
+	s = schematic_get_simulation (schematic_view_get_schematic (sv));
+
+	if (oregano.engine != OREGANO_ENGINE_NGSPICE) {
+		log_append (s->logstore, _ ("Simulation"),
+		            _ ("The operating point can only be shown with ngspice."));
+		schematic_view_log_show (sv, TRUE);
+		return;
+	}
+
+	if (s->op_cancellable != NULL)
+		g_cancellable_cancel (s->op_cancellable);
+	g_clear_object (&s->op_cancellable);
+
+	s->op_cancellable = g_cancellable_new ();
+	s->op_sv = sv;
+	op_values_run_async (s->sm, s->op_cancellable, (GAsyncReadyCallback)op_run_cb, s);
+}
+
+/**
+ * Stops everything that still refers to @sv, which is about to go away.
+ */
+void simulation_detach_view (SchematicView *sv)
+{
+	Simulation *s = schematic_get_simulation (schematic_view_get_schematic (sv));
+
+	simulation_set_auto (sv, FALSE);
+
+	if (s->op_sv == sv && s->op_cancellable != NULL) {
+		g_cancellable_cancel (s->op_cancellable);
+		g_clear_object (&s->op_cancellable);
+	}
+	s->op_sv = NULL;
 }
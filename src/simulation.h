@@ -137,6 +137,10 @@ typedef union
 } Analysis;
 
 void simulation_show_progress_bar (GtkWidget *widget, SchematicView *sv);
+void simulation_run_netlist (SchematicView *sv, GBytes *netlist);
+void simulation_set_auto (SchematicView *sv, gboolean enable);
+void simulation_show_op_values (GtkWidget *widget, SchematicView *sv);
+void simulation_detach_view (SchematicView *sv);
 gpointer simulation_new (Schematic *sm, Log *logstore);
 
 #define SIM_DATA(obj) ((SimulationData *)(obj))
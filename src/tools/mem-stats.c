@@ -0,0 +1,80 @@
+/*
+ * mem-stats.c
+ *
+ *
+ * Authors:
+ *  Michi <st101564@stud.uni-stuttgart.de>
+ *
+ * Web page: https://ahoi.io/project/oregano
+ *
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include <glib.h>
+#include <glib/gi18n.h>
+
+#include "mem-stats.h"
+
+static struct {
+	gssize objects;
+	gssize bytes;
+} mem_stats_counters[MEM_STATS_N_SUBSYSTEMS];
+
+static const gchar *mem_stats_names[MEM_STATS_N_SUBSYSTEMS] = {
+	[MEM_STATS_NODE_STORE] = N_("Node stores"),
+	[MEM_STATS_LIBRARY] = N_("Libraries"),
+	[MEM_STATS_SIM_DATA] = N_("Simulation data"),
+	[MEM_STATS_PLOT_LINES] = N_("Plot lines"),
+	[MEM_STATS_THREAD_PIPE] = N_("Thread pipes"),
+};
+
+void mem_stats_add(MemStatsSubsystem subsystem, gssize objects, gssize bytes) {
+	g_return_if_fail(subsystem < MEM_STATS_N_SUBSYSTEMS);
+
+	if (objects != 0)
+		g_atomic_pointer_add(&mem_stats_counters[subsystem].objects, objects);
+	if (bytes != 0)
+		g_atomic_pointer_add(&mem_stats_counters[subsystem].bytes, bytes);
+}
+
+void mem_stats_get(MemStatsSubsystem subsystem, MemStatsCounter *counter) {
+	g_return_if_fail(subsystem < MEM_STATS_N_SUBSYSTEMS);
+
+	counter->objects = (gssize)g_atomic_pointer_get(&mem_stats_counters[subsystem].objects);
+	counter->bytes = (gssize)g_atomic_pointer_get(&mem_stats_counters[subsystem].bytes);
+}
+
+const gchar *mem_stats_get_name(MemStatsSubsystem subsystem) {
+	g_return_val_if_fail(subsystem < MEM_STATS_N_SUBSYSTEMS, NULL);
+
+	return _(mem_stats_names[subsystem]);
+}
+
+gchar *mem_stats_dump() {
+	GString *dump = g_string_new(NULL);
+	MemStatsCounter counter;
+
+	for (MemStatsSubsystem subsystem = 0; subsystem < MEM_STATS_N_SUBSYSTEMS; subsystem++) {
+		mem_stats_get(subsystem, &counter);
+
+		g_autofree gchar *size = g_format_size(MAX(counter.bytes, 0));
+		g_string_append_printf(dump, "%-20s %10" G_GINT64_FORMAT " objects %12s\n",
+				mem_stats_get_name(subsystem), counter.objects, size);
+	}
+
+	return g_string_free(dump, FALSE);
+}
@@ -0,0 +1,68 @@
+/*
+ * mem-stats.h
+ *
+ *
+ * Authors:
+ *  Michi <st101564@stud.uni-stuttgart.de>
+ *
+ * Web page: https://ahoi.io/project/oregano
+ *
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef TOOLS_MEM_STATS_H_
+#define TOOLS_MEM_STATS_H_
+
+#include <glib.h>
+
+/**
+ * Object and byte counters per subsystem, to find out which one holds
+ * the memory of a long session.
+ *
+ * The counters are updated where the subsystem allocates and frees its
+ * data, they are not exact (allocator overhead, small strings) but they
+ * go back to where they were once the data is gone. They are atomic, so
+ * worker threads may update them too.
+ */
+
+typedef enum {
+	// NodeStore and its nodes
+	MEM_STATS_NODE_STORE,
+	// libraries, their parts and symbols
+	MEM_STATS_LIBRARY,
+	// columns of the runs in the result manager
+	MEM_STATS_SIM_DATA,
+	// copies of the plotted data
+	MEM_STATS_PLOT_LINES,
+	// blocks waiting in thread pipes
+	MEM_STATS_THREAD_PIPE,
+	MEM_STATS_N_SUBSYSTEMS
+} MemStatsSubsystem;
+
+typedef struct {
+	gint64 objects;
+	gint64 bytes;
+} MemStatsCounter;
+
+void mem_stats_add(MemStatsSubsystem subsystem, gssize objects, gssize bytes);
+void mem_stats_get(MemStatsSubsystem subsystem, MemStatsCounter *counter);
+const gchar *mem_stats_get_name(MemStatsSubsystem subsystem);
+
+// One line per subsystem, for the debug dialog and --debug-memory.
+gchar *mem_stats_dump();
+
+#endif /* TOOLS_MEM_STATS_H_ */
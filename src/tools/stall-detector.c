@@ -0,0 +1,208 @@
+/*
+ * stall-detector.c
+ *
+ *
+ * Authors:
+ *  Michi <st101564@stud.uni-stuttgart.de>
+ *
+ * Web page: https://ahoi.io/project/oregano
+ *
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include <string.h>
+#include <glib.h>
+
+#include "stall-detector.h"
+
+// how often the main loop is asked to dispatch the tick
+#define STALL_DETECTOR_TICK_MS 10
+#define STALL_DETECTOR_UNATTRIBUTED "(unattributed)"
+
+// upper bounds of the histogram buckets, the last one takes the rest
+static const guint stall_detector_buckets[] = {16, 33, 50, 100, 250, 500, 1000, 2000, G_MAXUINT};
+
+typedef struct {
+	const gchar *operation;
+	guint stalls;
+	gint64 total;
+	gint64 max;
+} StallDetectorOffender;
+
+typedef struct {
+	const gchar *operation;
+	gint64 start;
+} StallDetectorFrame;
+
+static struct {
+	gboolean running;
+	gint64 threshold;
+	guint tick_id;
+	gint64 last_tick;
+	// a stall since the last tick was blamed on an operation already
+	gboolean attributed;
+	guint histogram[G_N_ELEMENTS(stall_detector_buckets)];
+	guint ticks;
+	// of StallDetectorFrame, the operations in progress
+	GArray *stack;
+	// operation -> StallDetectorOffender
+	GHashTable *offenders;
+} stall_detector;
+
+static void stall_detector_add_stall(const gchar *operation, gint64 duration) {
+	StallDetectorOffender *offender = g_hash_table_lookup(stall_detector.offenders, operation);
+
+	if (offender == NULL) {
+		offender = g_new0(StallDetectorOffender, 1);
+		offender->operation = operation;
+		g_hash_table_insert(stall_detector.offenders, (gpointer)operation, offender);
+	}
+	offender->stalls++;
+	offender->total += duration;
+	offender->max = MAX(offender->max, duration);
+}
+
+static gboolean stall_detector_tick(gpointer user_data) {
+	gint64 now = g_get_monotonic_time();
+	gint64 delay = (now - stall_detector.last_tick) / 1000 - STALL_DETECTOR_TICK_MS;
+	int bucket = 0;
+
+	stall_detector.last_tick = now;
+	stall_detector.ticks++;
+
+	delay = MAX(delay, 0);
+	while (delay >= stall_detector_buckets[bucket])
+		bucket++;
+	stall_detector.histogram[bucket]++;
+
+	if (delay >= stall_detector.threshold && !stall_detector.attributed)
+		stall_detector_add_stall(STALL_DETECTOR_UNATTRIBUTED, delay);
+	stall_detector.attributed = FALSE;
+
+	return G_SOURCE_CONTINUE;
+}
+
+void stall_detector_start(guint threshold_ms) {
+	g_return_if_fail(!stall_detector.running);
+
+	stall_detector.running = TRUE;
+	stall_detector.threshold = threshold_ms;
+	stall_detector.attributed = FALSE;
+	stall_detector.ticks = 0;
+	memset(stall_detector.histogram, 0, sizeof(stall_detector.histogram));
+	stall_detector.stack = g_array_new(FALSE, FALSE, sizeof(StallDetectorFrame));
+	stall_detector.offenders = g_hash_table_new_full(g_str_hash, g_str_equal, NULL, g_free);
+
+	// high priority, so a busy but responsive loop does not look stalled
+	stall_detector.last_tick = g_get_monotonic_time();
+	stall_detector.tick_id = g_timeout_add_full(G_PRIORITY_HIGH, STALL_DETECTOR_TICK_MS, stall_detector_tick, NULL, NULL);
+}
+
+void stall_detector_stop() {
+	g_return_if_fail(stall_detector.running);
+
+	stall_detector.running = FALSE;
+	g_source_remove(stall_detector.tick_id);
+	stall_detector.tick_id = 0;
+	g_clear_pointer(&stall_detector.stack, g_array_unref);
+	g_clear_pointer(&stall_detector.offenders, g_hash_table_destroy);
+}
+
+gboolean stall_detector_is_running() {
+	return stall_detector.running;
+}
+
+void stall_detector_begin(const gchar *operation) {
+	if (!stall_detector.running)
+		return;
+
+	StallDetectorFrame frame = {operation, g_get_monotonic_time()};
+	g_array_append_val(stall_detector.stack, frame);
+}
+
+void stall_detector_end() {
+	if (!stall_detector.running || stall_detector.stack->len == 0)
+		return;
+
+	StallDetectorFrame *frame = &g_array_index(stall_detector.stack, StallDetectorFrame, stall_detector.stack->len - 1);
+	gint64 duration = (g_get_monotonic_time() - frame->start) / 1000;
+
+	// nested operations are blamed too, the innermost one tells the most
+	if (duration >= stall_detector.threshold) {
+		stall_detector_add_stall(frame->operation, duration);
+		stall_detector.attributed = TRUE;
+	}
+	g_array_set_size(stall_detector.stack, stall_detector.stack->len - 1);
+}
+
+guint stall_detector_get_stalls(const gchar *operation) {
+	g_return_val_if_fail(stall_detector.running, 0);
+
+	if (operation != NULL) {
+		StallDetectorOffender *offender = g_hash_table_lookup(stall_detector.offenders, operation);
+		return offender ? offender->stalls : 0;
+	}
+
+	guint stalls = 0;
+	GHashTableIter iter;
+	StallDetectorOffender *offender;
+	g_hash_table_iter_init(&iter, stall_detector.offenders);
+	while (g_hash_table_iter_next(&iter, NULL, (gpointer *)&offender))
+		stalls += offender->stalls;
+	return stalls;
+}
+
+static gint stall_detector_compare_offenders(gconstpointer a, gconstpointer b) {
+	const StallDetectorOffender *offender_a = a;
+	const StallDetectorOffender *offender_b = b;
+
+	if (offender_a->total != offender_b->total)
+		return offender_a->total < offender_b->total ? 1 : -1;
+	return g_strcmp0(offender_a->operation, offender_b->operation);
+}
+
+gchar *stall_detector_report(guint top_n) {
+	g_return_val_if_fail(stall_detector.running, NULL);
+
+	GString *report = g_string_new(NULL);
+	guint lower = 0;
+
+	g_string_append_printf(report, "Main loop delay in %u ticks:\n", stall_detector.ticks);
+	for (int i = 0; i < G_N_ELEMENTS(stall_detector_buckets); i++) {
+		if (stall_detector_buckets[i] == G_MAXUINT)
+			g_string_append_printf(report, "  >= %4u ms %8u\n", lower, stall_detector.histogram[i]);
+		else
+			g_string_append_printf(report, "  <  %4u ms %8u\n", stall_detector_buckets[i], stall_detector.histogram[i]);
+		lower = stall_detector_buckets[i];
+	}
+
+	GList *offenders = g_hash_table_get_values(stall_detector.offenders);
+	offenders = g_list_sort(offenders, stall_detector_compare_offenders);
+
+	g_string_append_printf(report, "Stalls of %" G_GINT64_FORMAT " ms and more, worst first:\n", stall_detector.threshold);
+	guint n = 0;
+	for (GList *iter = offenders; iter && n < top_n; iter = iter->next, n++) {
+		StallDetectorOffender *offender = iter->data;
+		g_string_append_printf(report, "  %-30s %6u stalls %8" G_GINT64_FORMAT " ms total %8" G_GINT64_FORMAT " ms max\n",
+				offender->operation, offender->stalls, offender->total, offender->max);
+	}
+	if (offenders == NULL)
+		g_string_append(report, "  none\n");
+	g_list_free(offenders);
+
+	return g_string_free(report, FALSE);
+}
@@ -0,0 +1,63 @@
+/*
+ * stall-detector.h
+ *
+ *
+ * Authors:
+ *  Michi <st101564@stud.uni-stuttgart.de>
+ *
+ * Web page: https://ahoi.io/project/oregano
+ *
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef TOOLS_STALL_DETECTOR_H_
+#define TOOLS_STALL_DETECTOR_H_
+
+#include <glib.h>
+
+/**
+ * Watches how long the main loop is kept from running, for
+ * --debug-stalls.
+ *
+ * A tick in the default main context measures how late it is
+ * dispatched and puts the delay into a histogram. Work that is known to
+ * run on the GUI thread for a while is put between stall_detector_begin
+ * and stall_detector_end, every such operation that takes longer than
+ * the threshold is reported as the offender. Stalls without an operation
+ * are reported as unattributed.
+ *
+ * Only to be used from the main thread. Without a running detector
+ * begin and end do nothing.
+ */
+
+#define STALL_DETECTOR_THRESHOLD_DEFAULT 100
+
+void stall_detector_start(guint threshold_ms);
+void stall_detector_stop();
+gboolean stall_detector_is_running();
+
+// @operation has to stay valid until the detector is stopped, a string literal
+void stall_detector_begin(const gchar *operation);
+void stall_detector_end();
+
+// Number of stalls caused by @operation, all stalls for NULL.
+guint stall_detector_get_stalls(const gchar *operation);
+
+// Histogram of the tick delays and the @top_n worst offenders.
+gchar *stall_detector_report(guint top_n);
+
+#endif /* TOOLS_STALL_DETECTOR_H_ */
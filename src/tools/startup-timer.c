@@ -0,0 +1,130 @@
+/*
+ * startup-timer.c
+ *
+ *
+ * Authors:
+ *  Michi <st101564@stud.uni-stuttgart.de>
+ *
+ * Web page: https://ahoi.io/project/oregano
+ *
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include <glib.h>
+
+#include "startup-timer.h"
+
+typedef struct {
+	const gchar *phase;
+	// µs since the start
+	gint64 end;
+	gboolean deferred;
+} StartupTimerPhase;
+
+static struct {
+	gboolean running;
+	gint64 budget;
+	gint64 start;
+	gint64 last;
+	// µs since the start, -1 before the first window
+	gint64 first_window;
+	// of StartupTimerPhase, in the order they are done
+	GArray *phases;
+} startup_timer;
+
+void startup_timer_start(guint budget_ms) {
+	g_return_if_fail(!startup_timer.running);
+
+	startup_timer.running = TRUE;
+	startup_timer.budget = budget_ms;
+	startup_timer.start = g_get_monotonic_time();
+	startup_timer.last = 0;
+	startup_timer.first_window = -1;
+	startup_timer.phases = g_array_new(FALSE, FALSE, sizeof(StartupTimerPhase));
+}
+
+void startup_timer_stop() {
+	g_return_if_fail(startup_timer.running);
+
+	startup_timer.running = FALSE;
+	g_clear_pointer(&startup_timer.phases, g_array_unref);
+}
+
+gboolean startup_timer_is_running() {
+	return startup_timer.running;
+}
+
+void startup_timer_mark(const gchar *phase) {
+	if (!startup_timer.running)
+		return;
+
+	StartupTimerPhase entry = {phase, g_get_monotonic_time() - startup_timer.start, startup_timer.first_window >= 0};
+	g_array_append_val(startup_timer.phases, entry);
+	startup_timer.last = entry.end;
+}
+
+void startup_timer_first_window() {
+	if (!startup_timer.running || startup_timer.first_window >= 0)
+		return;
+
+	startup_timer_mark("first window drawn");
+	startup_timer.first_window = startup_timer.last;
+}
+
+gint64 startup_timer_get_time_to_first_window_ms() {
+	g_return_val_if_fail(startup_timer.running, -1);
+
+	if (startup_timer.first_window < 0)
+		return -1;
+	return startup_timer.first_window / 1000;
+}
+
+gboolean startup_timer_is_over_budget() {
+	g_return_val_if_fail(startup_timer.running, FALSE);
+
+	gint64 time = startup_timer_get_time_to_first_window_ms();
+	return time < 0 || time > startup_timer.budget;
+}
+
+gchar *startup_timer_report() {
+	g_return_val_if_fail(startup_timer.running, NULL);
+
+	GString *report = g_string_new("Startup, duration and time since the start:\n");
+	gint64 previous = 0;
+	gboolean deferred = FALSE;
+
+	for (guint i = 0; i < startup_timer.phases->len; i++) {
+		StartupTimerPhase *entry = &g_array_index(startup_timer.phases, StartupTimerPhase, i);
+
+		if (entry->deferred && !deferred) {
+			g_string_append(report, "Deferred to idle time or first use:\n");
+			deferred = TRUE;
+		}
+		g_string_append_printf(report, "  %-30s %8.1f ms %8.1f ms\n",
+				entry->phase, (entry->end - previous) / 1000., entry->end / 1000.);
+		previous = entry->end;
+	}
+
+	gint64 time = startup_timer_get_time_to_first_window_ms();
+	if (time < 0)
+		g_string_append_printf(report, "No window was drawn, budget %" G_GINT64_FORMAT " ms\n", startup_timer.budget);
+	else
+		g_string_append_printf(report, "Time to first window: %" G_GINT64_FORMAT " ms, budget %" G_GINT64_FORMAT " ms%s\n",
+				time, startup_timer.budget, time > startup_timer.budget ? ", OVER BUDGET" : "");
+
+	return g_string_free(report, FALSE);
+}
@@ -0,0 +1,62 @@
+/*
+ * startup-timer.h
+ *
+ *
+ * Authors:
+ *  Michi <st101564@stud.uni-stuttgart.de>
+ *
+ * Web page: https://ahoi.io/project/oregano
+ *
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef TOOLS_STARTUP_TIMER_H_
+#define TOOLS_STARTUP_TIMER_H_
+
+#include <glib.h>
+
+/**
+ * Time line of the start of Oregano, for --debug-startup.
+ *
+ * The timer is started as early as possible in main and every step of
+ * the start marks itself as done. The critical path ends when the first
+ * window has been drawn; the work that is deferred to idle time is
+ * marked after that and does not count against the budget.
+ *
+ * Only to be used from the main thread. Without a running timer the
+ * marks do nothing.
+ */
+
+#define STARTUP_TIMER_BUDGET_DEFAULT 500
+
+void startup_timer_start(guint budget_ms);
+void startup_timer_stop();
+gboolean startup_timer_is_running();
+
+// @phase is done, it has to stay valid until the timer is stopped, a string literal
+void startup_timer_mark(const gchar *phase);
+// The first window was drawn, only the first call counts.
+void startup_timer_first_window();
+
+// From the start to the first window, -1 as long as there is none.
+gint64 startup_timer_get_time_to_first_window_ms();
+gboolean startup_timer_is_over_budget();
+
+// The phases with their duration and the time to the first window.
+gchar *startup_timer_report();
+
+#endif /* TOOLS_STARTUP_TIMER_H_ */
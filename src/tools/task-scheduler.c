@@ -0,0 +1,465 @@
+/*
+ * task-scheduler.c
+ *
+ *
+ * Authors:
+ *  Michi <st101564@stud.uni-stuttgart.de>
+ *
+ * Web page: https://ahoi.io/project/oregano
+ *
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/*
+ * One pool of threads for all the background work of oregano, instead
+ * of a new thread (and main loop) for every little job.
+ *
+ * The number of queued tasks is counted in "pending". Workers only go
+ * to sleep if it is 0. A submitter wakes a sleeping worker after it
+ * increased the counter. Both sides first write their counter and
+ * then read the one of the other side, so at least one of them sees
+ * the other and no wake up is lost.
+ */
+
+#include "task-scheduler.h"
+
+struct _Task {
+	gint ref_count;
+
+	TaskFunc func;
+	gpointer data;
+	GDestroyNotify destroy;
+
+	TaskPriority priority;
+	TaskFlags flags;
+	CancelInfo *cancel_info;
+	TaskDoneFunc done_func;
+	GMainContext *done_context;
+
+	GMutex mutex;
+	GCond cond;
+	gboolean done;
+};
+
+typedef struct {
+	TaskScheduler *scheduler;
+	guint index;
+	GThread *thread;
+
+	GMutex mutex;
+	GQueue queues[TASK_PRIORITY_COUNT];
+} TaskWorker;
+
+struct _TaskScheduler {
+	guint n_workers;
+	TaskWorker *workers;
+
+	// tasks submitted from threads that are not workers
+	GMutex mutex;
+	GQueue queues[TASK_PRIORITY_COUNT];
+
+	gint pending;
+	gint sleeping;
+	gboolean shutdown;
+	GMutex sleep_mutex;
+	GCond sleep_cond;
+
+	GThreadPool *blocking_pool;
+
+	GMutex io_mutex;
+	GMainContext *io_context;
+	GMainLoop *io_loop;
+	GThread *io_thread;
+};
+
+// the worker that runs in the current thread, NULL for other threads
+static GPrivate task_current_worker;
+
+static void task_finalize(Task *task);
+static void task_run(Task *task);
+static Task *task_scheduler_find_work(TaskScheduler *scheduler, TaskWorker *worker);
+
+/**
+ * Task
+ */
+
+Task *task_new(TaskFunc func, gpointer data, GDestroyNotify destroy) {
+	g_return_val_if_fail(func != NULL, NULL);
+
+	Task *task = g_new0(Task, 1);
+	task->ref_count = 1;
+	task->func = func;
+	task->data = data;
+	task->destroy = destroy;
+	task->priority = TASK_PRIORITY_DEFAULT;
+	task->cancel_info = cancel_info_new();
+	g_mutex_init(&task->mutex);
+	g_cond_init(&task->cond);
+
+	return task;
+}
+
+Task *task_ref(Task *task) {
+	g_return_val_if_fail(task != NULL, NULL);
+
+	g_atomic_int_inc(&task->ref_count);
+	return task;
+}
+
+void task_unref(Task *task) {
+	if (task == NULL)
+		return;
+
+	if (g_atomic_int_dec_and_test(&task->ref_count))
+		task_finalize(task);
+}
+
+static void task_finalize(Task *task) {
+	if (task->destroy != NULL)
+		task->destroy(task->data);
+	cancel_info_unsubscribe(task->cancel_info);
+	if (task->done_context != NULL)
+		g_main_context_unref(task->done_context);
+	g_mutex_clear(&task->mutex);
+	g_cond_clear(&task->cond);
+	g_free(task);
+}
+
+void task_set_priority(Task *task, TaskPriority priority) {
+	g_return_if_fail(task != NULL);
+	g_return_if_fail(priority < TASK_PRIORITY_COUNT);
+
+	task->priority = priority;
+}
+
+void task_set_flags(Task *task, TaskFlags flags) {
+	g_return_if_fail(task != NULL);
+
+	task->flags = flags;
+}
+
+void task_set_cancel_info(Task *task, CancelInfo *cancel_info) {
+	g_return_if_fail(task != NULL);
+	g_return_if_fail(cancel_info != NULL);
+
+	cancel_info_subscribe(cancel_info);
+	cancel_info_unsubscribe(task->cancel_info);
+	task->cancel_info = cancel_info;
+}
+
+void task_set_done_func(Task *task, TaskDoneFunc done_func, GMainContext *context) {
+	g_return_if_fail(task != NULL);
+
+	if (context == NULL)
+		context = g_main_context_default();
+	if (task->done_context != NULL)
+		g_main_context_unref(task->done_context);
+
+	task->done_func = done_func;
+	task->done_context = g_main_context_ref(context);
+}
+
+void task_cancel(Task *task) {
+	g_return_if_fail(task != NULL);
+
+	cancel_info_set_cancel(task->cancel_info);
+}
+
+gboolean task_is_done(Task *task) {
+	g_return_val_if_fail(task != NULL, FALSE);
+
+	g_mutex_lock(&task->mutex);
+	gboolean done = task->done;
+	g_mutex_unlock(&task->mutex);
+
+	return done;
+}
+
+void task_wait(Task *task) {
+	g_return_if_fail(task != NULL);
+
+	TaskWorker *worker = g_private_get(&task_current_worker);
+
+	while (worker != NULL && !task_is_done(task)) {
+		Task *other = task_scheduler_find_work(worker->scheduler, worker);
+		if (other != NULL) {
+			task_run(other);
+			continue;
+		}
+
+		// the task runs on another thread, but look for new work from time to time
+		g_mutex_lock(&task->mutex);
+		if (!task->done)
+			g_cond_wait_until(&task->cond, &task->mutex, g_get_monotonic_time() + 10 * G_TIME_SPAN_MILLISECOND);
+		g_mutex_unlock(&task->mutex);
+	}
+
+	g_mutex_lock(&task->mutex);
+	while (!task->done)
+		g_cond_wait(&task->cond, &task->mutex);
+	g_mutex_unlock(&task->mutex);
+}
+
+static gboolean task_done_dispatch(Task *task) {
+	task->done_func(task->data, cancel_info_is_cancel(task->cancel_info));
+	return G_SOURCE_REMOVE;
+}
+
+/**
+ * Runs the task and drops the reference of the scheduler.
+ */
+static void task_run(Task *task) {
+	task->func(task->data, task->cancel_info);
+
+	g_mutex_lock(&task->mutex);
+	task->done = TRUE;
+	g_cond_broadcast(&task->cond);
+	g_mutex_unlock(&task->mutex);
+
+	if (task->done_func != NULL) {
+		// not g_main_context_invoke, it calls directly if the context is free
+		GSource *source = g_idle_source_new();
+		g_source_set_priority(source, G_PRIORITY_DEFAULT);
+		g_source_set_callback(source, (GSourceFunc)task_done_dispatch, task_ref(task), (GDestroyNotify)task_unref);
+		g_source_attach(source, task->done_context);
+		g_source_unref(source);
+	}
+
+	task_unref(task);
+}
+
+/**
+ * Scheduler
+ */
+
+static Task *task_scheduler_pop(GMutex *mutex, GQueue *queue, gboolean head) {
+	g_mutex_lock(mutex);
+	Task *task = head ? g_queue_pop_head(queue) : g_queue_pop_tail(queue);
+	g_mutex_unlock(mutex);
+
+	return task;
+}
+
+/**
+ * Takes the next task out of the queues, NULL if there is none.
+ */
+static Task *task_scheduler_find_work(TaskScheduler *scheduler, TaskWorker *worker) {
+	if (g_atomic_int_get(&scheduler->pending) <= 0)
+		return NULL;
+
+	for (int priority = 0; priority < TASK_PRIORITY_COUNT; priority++) {
+		Task *task = task_scheduler_pop(&worker->mutex, &worker->queues[priority], TRUE);
+
+		if (task == NULL)
+			task = task_scheduler_pop(&scheduler->mutex, &scheduler->queues[priority], TRUE);
+
+		// steal the oldest task of someone else
+		for (guint i = 1; task == NULL && i < scheduler->n_workers; i++) {
+			TaskWorker *victim = &scheduler->workers[(worker->index + i) % scheduler->n_workers];
+			task = task_scheduler_pop(&victim->mutex, &victim->queues[priority], FALSE);
+		}
+
+		if (task != NULL) {
+			g_atomic_int_add(&scheduler->pending, -1);
+			return task;
+		}
+	}
+
+	return NULL;
+}
+
+/**
+ * Waits for new tasks. Returns FALSE if the worker should quit.
+ */
+static gboolean task_scheduler_sleep(TaskScheduler *scheduler) {
+	g_mutex_lock(&scheduler->sleep_mutex);
+	g_atomic_int_inc(&scheduler->sleeping);
+	while (g_atomic_int_get(&scheduler->pending) <= 0 && !scheduler->shutdown)
+		g_cond_wait(&scheduler->sleep_cond, &scheduler->sleep_mutex);
+	g_atomic_int_add(&scheduler->sleeping, -1);
+	gboolean keep_running = g_atomic_int_get(&scheduler->pending) > 0 || !scheduler->shutdown;
+	g_mutex_unlock(&scheduler->sleep_mutex);
+
+	return keep_running;
+}
+
+static gpointer task_scheduler_worker_main(TaskWorker *worker) {
+	g_private_set(&task_current_worker, worker);
+
+	do {
+		Task *task;
+		while ((task = task_scheduler_find_work(worker->scheduler, worker)) != NULL)
+			task_run(task);
+	} while (task_scheduler_sleep(worker->scheduler));
+
+	return NULL;
+}
+
+static void task_scheduler_blocking_main(Task *task, TaskScheduler *scheduler) {
+	task_run(task);
+}
+
+static gint task_scheduler_compare_priority(const Task *a, const Task *b, gpointer user_data) {
+	return (gint)a->priority - (gint)b->priority;
+}
+
+TaskScheduler *task_scheduler_new(guint n_workers) {
+	TaskScheduler *scheduler = g_new0(TaskScheduler, 1);
+
+	if (n_workers == 0)
+		n_workers = g_get_num_processors();
+	scheduler->n_workers = n_workers;
+
+	g_mutex_init(&scheduler->mutex);
+	g_mutex_init(&scheduler->sleep_mutex);
+	g_cond_init(&scheduler->sleep_cond);
+	g_mutex_init(&scheduler->io_mutex);
+	for (int priority = 0; priority < TASK_PRIORITY_COUNT; priority++)
+		g_queue_init(&scheduler->queues[priority]);
+
+	// Blocking tasks often wait for each other (e.g. a consumer for its
+	// producer), a limited number of threads could dead lock.
+	scheduler->blocking_pool = g_thread_pool_new((GFunc)task_scheduler_blocking_main, scheduler, -1, FALSE, NULL);
+	g_thread_pool_set_sort_function(scheduler->blocking_pool, (GCompareDataFunc)task_scheduler_compare_priority, NULL);
+
+	scheduler->workers = g_new0(TaskWorker, n_workers);
+	for (guint i = 0; i < n_workers; i++) {
+		TaskWorker *worker = &scheduler->workers[i];
+		worker->scheduler = scheduler;
+		worker->index = i;
+		g_mutex_init(&worker->mutex);
+		for (int priority = 0; priority < TASK_PRIORITY_COUNT; priority++)
+			g_queue_init(&worker->queues[priority]);
+	}
+	// start them after all queues exist, they steal from each other
+	for (guint i = 0; i < n_workers; i++) {
+		gchar *name = g_strdup_printf("task worker %u", i);
+		scheduler->workers[i].thread = g_thread_new(name, (GThreadFunc)task_scheduler_worker_main, &scheduler->workers[i]);
+		g_free(name);
+	}
+
+	return scheduler;
+}
+
+static gboolean task_scheduler_io_quit(GMainLoop *loop) {
+	g_main_loop_quit(loop);
+	return G_SOURCE_REMOVE;
+}
+
+void task_scheduler_free(TaskScheduler *scheduler) {
+	g_return_if_fail(scheduler != NULL);
+
+	g_mutex_lock(&scheduler->sleep_mutex);
+	scheduler->shutdown = TRUE;
+	g_cond_broadcast(&scheduler->sleep_cond);
+	g_mutex_unlock(&scheduler->sleep_mutex);
+
+	for (guint i = 0; i < scheduler->n_workers; i++) {
+		g_thread_join(scheduler->workers[i].thread);
+		g_mutex_clear(&scheduler->workers[i].mutex);
+	}
+	g_thread_pool_free(scheduler->blocking_pool, FALSE, TRUE);
+
+	if (scheduler->io_thread != NULL) {
+		// a plain g_main_loop_quit gets lost if the loop did not start yet
+		GSource *source = g_idle_source_new();
+		g_source_set_callback(source, (GSourceFunc)task_scheduler_io_quit, scheduler->io_loop, NULL);
+		g_source_attach(source, scheduler->io_context);
+		g_source_unref(source);
+
+		g_thread_join(scheduler->io_thread);
+		g_main_loop_unref(scheduler->io_loop);
+		g_main_context_unref(scheduler->io_context);
+	}
+
+	g_mutex_clear(&scheduler->mutex);
+	g_mutex_clear(&scheduler->sleep_mutex);
+	g_cond_clear(&scheduler->sleep_cond);
+	g_mutex_clear(&scheduler->io_mutex);
+	g_free(scheduler->workers);
+	g_free(scheduler);
+}
+
+TaskScheduler *task_scheduler_get_default() {
+	static gsize scheduler = 0;
+
+	if (g_once_init_enter(&scheduler))
+		g_once_init_leave(&scheduler, (gsize)task_scheduler_new(0));
+
+	return (TaskScheduler *)scheduler;
+}
+
+void task_scheduler_submit(TaskScheduler *scheduler, Task *task) {
+	g_return_if_fail(scheduler != NULL);
+	g_return_if_fail(task != NULL);
+
+	if (task->flags & TASK_FLAG_BLOCKING) {
+		g_thread_pool_push(scheduler->blocking_pool, task, NULL);
+		return;
+	}
+
+	TaskWorker *worker = g_private_get(&task_current_worker);
+	if (worker != NULL && worker->scheduler == scheduler) {
+		// likely to work on the same data as the submitter, keep it close
+		g_mutex_lock(&worker->mutex);
+		g_queue_push_head(&worker->queues[task->priority], task);
+		g_mutex_unlock(&worker->mutex);
+	} else {
+		g_mutex_lock(&scheduler->mutex);
+		g_queue_push_tail(&scheduler->queues[task->priority], task);
+		g_mutex_unlock(&scheduler->mutex);
+	}
+
+	g_atomic_int_inc(&scheduler->pending);
+	if (g_atomic_int_get(&scheduler->sleeping) > 0) {
+		g_mutex_lock(&scheduler->sleep_mutex);
+		g_cond_signal(&scheduler->sleep_cond);
+		g_mutex_unlock(&scheduler->sleep_mutex);
+	}
+}
+
+Task *task_scheduler_run(TaskScheduler *scheduler, TaskFunc func, gpointer data, GDestroyNotify destroy, TaskPriority priority) {
+	g_return_val_if_fail(scheduler != NULL, NULL);
+
+	Task *task = task_new(func, data, destroy);
+	task_set_priority(task, priority);
+	task_scheduler_submit(scheduler, task_ref(task));
+
+	return task;
+}
+
+static gpointer task_scheduler_io_main(TaskScheduler *scheduler) {
+	g_main_context_push_thread_default(scheduler->io_context);
+	g_main_loop_run(scheduler->io_loop);
+	g_main_context_pop_thread_default(scheduler->io_context);
+
+	return NULL;
+}
+
+GMainContext *task_scheduler_get_io_context(TaskScheduler *scheduler) {
+	g_return_val_if_fail(scheduler != NULL, NULL);
+
+	g_mutex_lock(&scheduler->io_mutex);
+	if (scheduler->io_context == NULL) {
+		scheduler->io_context = g_main_context_new();
+		scheduler->io_loop = g_main_loop_new(scheduler->io_context, FALSE);
+		scheduler->io_thread = g_thread_new("task io", (GThreadFunc)task_scheduler_io_main, scheduler);
+	}
+	g_mutex_unlock(&scheduler->io_mutex);
+
+	return scheduler->io_context;
+}
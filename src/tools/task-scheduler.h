@@ -0,0 +1,110 @@
+/*
+ * task-scheduler.h
+ *
+ *
+ * Authors:
+ *  Michi <st101564@stud.uni-stuttgart.de>
+ *
+ * Web page: https://ahoi.io/project/oregano
+ *
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef TOOLS_TASK_SCHEDULER_H_
+#define TOOLS_TASK_SCHEDULER_H_
+
+#include <glib.h>
+#include "cancel-info.h"
+
+typedef enum {
+	TASK_PRIORITY_HIGH = 0,
+	TASK_PRIORITY_DEFAULT,
+	TASK_PRIORITY_LOW,
+	TASK_PRIORITY_COUNT
+} TaskPriority;
+
+typedef enum {
+	TASK_FLAG_NONE = 0,
+	// The task waits most of the time (for a pipe, a child process, ...).
+	// It gets a thread of its own, so it does not keep a worker busy.
+	TASK_FLAG_BLOCKING = 1 << 0
+} TaskFlags;
+
+typedef struct _Task Task;
+typedef struct _TaskScheduler TaskScheduler;
+
+/**
+ * Cancellation is cooperative: the function is always called, also if
+ * the task was canceled before it started, so it can release what it
+ * owns (e.g. the reading end of a ThreadPipe). It should return early
+ * if cancel_info_is_cancel(cancel_info) says so.
+ */
+typedef void (*TaskFunc)(gpointer data, CancelInfo *cancel_info);
+typedef void (*TaskDoneFunc)(gpointer data, gboolean canceled);
+
+/**
+ * Task
+ */
+Task *task_new(TaskFunc func, gpointer data, GDestroyNotify destroy);
+Task *task_ref(Task *task);
+// data is destroyed with the last reference
+void task_unref(Task *task);
+
+// setters have to be called before the task is submitted
+void task_set_priority(Task *task, TaskPriority priority);
+void task_set_flags(Task *task, TaskFlags flags);
+// shares the cancel info of someone else, by default a task has its own
+void task_set_cancel_info(Task *task, CancelInfo *cancel_info);
+// done_func is invoked in @context (NULL for the main context) after func returned
+void task_set_done_func(Task *task, TaskDoneFunc done_func, GMainContext *context);
+
+void task_cancel(Task *task);
+gboolean task_is_done(Task *task);
+// Blocks until func returned. Called on a worker, the worker runs other
+// tasks meanwhile, so tasks may wait for tasks they submitted.
+void task_wait(Task *task);
+
+/**
+ * Scheduler
+ *
+ * Every worker has its own queues, one per priority. Tasks submitted
+ * by a worker go to the front of its own queue, tasks submitted from
+ * outside to a shared queue. Idle workers take from their own queue
+ * first, then from the shared one, and steal from the back of the
+ * queues of the others at last. Higher priorities always come first.
+ */
+TaskScheduler *task_scheduler_new(guint n_workers);
+// Finishes all submitted tasks first. Tasks must not submit new ones
+// meanwhile.
+void task_scheduler_free(TaskScheduler *scheduler);
+// one worker per processor, lives as long as the application
+TaskScheduler *task_scheduler_get_default();
+
+// takes over the reference of @task
+void task_scheduler_submit(TaskScheduler *scheduler, Task *task);
+// shortcut for new and submit, returns a reference for waiting
+Task *task_scheduler_run(TaskScheduler *scheduler, TaskFunc func, gpointer data, GDestroyNotify destroy, TaskPriority priority);
+
+/**
+ * A main context that is iterated by a thread of the scheduler. Attach
+ * watches for pipes and child processes to it instead of running a
+ * main loop of your own. The callbacks must not block, submit a
+ * blocking task for that.
+ */
+GMainContext *task_scheduler_get_io_context(TaskScheduler *scheduler);
+
+#endif /* TOOLS_TASK_SCHEDULER_H_ */
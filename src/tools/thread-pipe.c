@@ -117,6 +117,7 @@
 #include <unistd.h>
 
 #include "thread-pipe.h"
+#include "mem-stats.h"
 
 typedef struct _ThreadPipeData ThreadPipeData;
 
@@ -126,6 +127,8 @@ typedef struct _ThreadPipeData ThreadPipeData;
 struct _ThreadPipeData {
 	// introduced for efficient string support
 	gpointer malloc_address;
+	// size of malloc_address, for the memory statistics
+	gsize malloc_size;
 	// data block
 	gpointer data;
 	// size of data block
@@ -471,6 +474,8 @@ ThreadPipe *thread_pipe_pop_line(ThreadPipe *pipe_in, gchar **string_out, gsize
 		g_free(*old_data);
 	*old_data = line;
 	*old_size = line_size;
+	mem_stats_add(MEM_STATS_THREAD_PIPE, 0, (gssize)line_size - (gssize)pipe_in->read_data->malloc_size);
+	pipe_in->read_data->malloc_size = line_size;
 
 	*string_out = *old_data;
 	*size_out = *old_size;
@@ -562,7 +567,9 @@ static ThreadPipeData *thread_pipe_data_new(gpointer data, gsize size) {
 		memcpy(pipe_data->malloc_address, data, size);
 		pipe_data->data = pipe_data->malloc_address;
 		pipe_data->size = size;
+		pipe_data->malloc_size = size;
 	}
+	mem_stats_add(MEM_STATS_THREAD_PIPE, 1, sizeof(ThreadPipeData) + pipe_data->malloc_size);
 
 	return pipe_data;
 }
@@ -579,6 +586,7 @@ static ThreadPipeData *thread_pipe_data_destroy(ThreadPipe *pipe) {
 	ThreadPipeData *next = pipe_data->next;
 	if (pipe_data->malloc_address != NULL)
 		g_free(pipe_data->malloc_address);
+	mem_stats_add(MEM_STATS_THREAD_PIPE, -1, -(gssize)(sizeof(ThreadPipeData) + pipe_data->malloc_size));
 	g_free(pipe_data);
 	if (next != NULL) {
 		pipe->read_buffer_data.block_counter--;
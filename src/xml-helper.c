@@ -37,17 +37,11 @@
 
 // A modified version of XmlSAXParseFile in gnome-xml. This one lets us set
 // the user_data that is passed to the various callbacks, to make it possible
-// to avoid lots of global variables.
-gboolean oreganoXmlSAXParseFile (xmlSAXHandlerPtr sax, gpointer user_data, const gchar *filename)
+// to avoid lots of global variables. The context is freed.
+static gboolean oreganoXmlSAXParse (xmlParserCtxtPtr ctxt, xmlSAXHandlerPtr sax, gpointer user_data)
 {
-	g_return_val_if_fail (filename != NULL, FALSE);
-
 	gboolean ret = TRUE;
-	xmlParserCtxtPtr ctxt;
-
-	ctxt = xmlCreateFileParserCtxt (filename);
-	if (ctxt == NULL)
-		return FALSE;
+	xmlSAXHandlerPtr own_sax = ctxt->sax;
 
 	ctxt->sax = sax;
 	ctxt->userData = user_data;
@@ -55,20 +49,53 @@ gboolean oreganoXmlSAXParseFile (xmlSAXHandlerPtr sax, gpointer user_data, const
 #if defined(LIBXML_VERSION) && LIBXML_VERSION >= 20000
 	xmlKeepBlanksDefault (0);
 #endif
-	if (xmlParseDocument (ctxt) < 0) {
-		// FIXME post a message to the log buffer with as much details as possible
-		g_message ("Failed to parse \"%s\"", filename);
+	if (xmlParseDocument (ctxt) < 0)
 		ret = FALSE;
-	} else {
+	else
 		ret = ctxt->wellFormed ? TRUE : FALSE;
-		if (sax != NULL)
-			ctxt->sax = NULL;
-	}
+
+	// the handler belongs to the caller, also if the parser failed
+	ctxt->sax = own_sax;
 	xmlFreeParserCtxt (ctxt);
 
 	return ret;
 }
 
+gboolean oreganoXmlSAXParseFile (xmlSAXHandlerPtr sax, gpointer user_data, const gchar *filename)
+{
+	g_return_val_if_fail (filename != NULL, FALSE);
+
+	gboolean ret;
+	xmlParserCtxtPtr ctxt;
+
+	ctxt = xmlCreateFileParserCtxt (filename);
+	if (ctxt == NULL)
+		return FALSE;
+
+	ret = oreganoXmlSAXParse (ctxt, sax, user_data);
+	if (!ret)
+		// FIXME post a message to the log buffer with as much details as possible
+		g_message ("Failed to parse \"%s\"", filename);
+
+	return ret;
+}
+
+// Like oreganoXmlSAXParseFile, for a document that is already in memory.
+gboolean oreganoXmlSAXParseMemory (xmlSAXHandlerPtr sax, gpointer user_data, const gchar *buffer,
+                                   gsize length)
+{
+	xmlParserCtxtPtr ctxt;
+
+	g_return_val_if_fail (buffer != NULL, FALSE);
+	g_return_val_if_fail (length <= G_MAXINT, FALSE);
+
+	ctxt = xmlCreateMemoryParserCtxt (buffer, (int)length);
+	if (ctxt == NULL)
+		return FALSE;
+
+	return oreganoXmlSAXParse (ctxt, sax, user_data);
+}
+
 // Set coodinate for a node, carried as the content of a child.
 void xmlSetCoordinate (xmlNodePtr node, const char *name, double x, double y)
 {
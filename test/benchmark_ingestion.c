@@ -0,0 +1,197 @@
+/*
+ * benchmark_ingestion.c
+ *
+ *
+ * Authors:
+ *  Michi <st101564@stud.uni-stuttgart.de>
+ *
+ * Web page: https://ahoi.io/project/oregano
+ *
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+
+/**
+ * Measures how fast simulator output gets through the whole ingestion
+ * chain: the watcher reading stdout, the thread pipes, the parser and
+ * the saver. The simulator is fake-ngspice from the same directory, so
+ * neither ngspice nor a circuit is needed and every run gets the same
+ * bytes.
+ *
+ *   benchmark-ingestion --rows 200000 --columns 12 --runs 5
+ */
+
+#include <glib.h>
+#include <glib/gstdio.h>
+#include <glib/gprintf.h>
+
+#include "../src/engines/ngspice-watcher.h"
+
+static gint64 rows = 100000;
+static gint columns = 8;
+static gint runs = 3;
+static gdouble rate = 0;
+
+static GOptionEntry entries[] = {
+	{"rows", 0, 0, G_OPTION_ARG_INT64, &rows, "Number of time points", "N"},
+	{"columns", 0, 0, G_OPTION_ARG_INT, &columns, "Number of node voltages", "N"},
+	{"runs", 0, 0, G_OPTION_ARG_INT, &runs, "Number of runs", "N"},
+	{"rate", 0, 0, G_OPTION_ARG_DOUBLE, &rate, "Rows per second the simulator prints, 0 for as fast as possible", "ROWS"},
+	{NULL}
+};
+
+typedef struct {
+	OreganoNgSpice *ngspice;
+	GMainLoop *loop;
+	// everything on stderr, only shown if the run fails
+	GList *errors;
+} BenchmarkIngestionRun;
+
+static void benchmark_ingestion_log(GList **errors, const gchar *message) {
+	*errors = g_list_append(*errors, g_strdup(message));
+}
+
+/**
+ * One run through the watcher, like a simulation started from the GUI.
+ * Returns the seconds until the data was parsed and saved, or a
+ * negative number if the run failed.
+ */
+static gdouble benchmark_ingestion_run(const gchar * const *simulator, const gchar *netlist_file, const gchar *result_file) {
+	BenchmarkIngestionRun run = {0};
+	SimSettings *sim_settings = sim_settings_new();
+	g_autofree gchar *trans_stop = g_strdup_printf("%g", (rows - 1) * 1e-9);
+
+	sim_settings->trans_enable = TRUE;
+	sim_settings->ac_enable = FALSE;
+	sim_settings->dc_enable = FALSE;
+	sim_settings->fourier_enable = FALSE;
+	sim_settings_set_trans_stop(sim_settings, trans_stop);
+
+	run.ngspice = OREGANO_NGSPICE(oregano_ngspice_new(NULL));
+	run.loop = g_main_loop_new(NULL, FALSE);
+	g_signal_connect_swapped(G_OBJECT(run.ngspice), "done", G_CALLBACK(g_main_loop_quit), run.loop);
+	g_signal_connect_swapped(G_OBJECT(run.ngspice), "aborted", G_CALLBACK(g_main_loop_quit), run.loop);
+
+	NgspiceWatcherBuildAndLaunchResources *resources = g_new0(NgspiceWatcherBuildAndLaunchResources, 1);
+	OreganoNgSpicePriv *priv = run.ngspice->priv;
+	resources->aborted = &priv->aborted;
+	resources->analysis = &priv->analysis;
+	resources->child_pid = &priv->child_pid;
+	resources->saver = &priv->saver;
+	resources->current = &priv->current;
+	resources->emit_instance = run.ngspice;
+	resources->log.log = (gpointer)&run.errors;
+	resources->log.log_append = (LogFunction)benchmark_ingestion_log;
+	resources->log.log_append_error = (LogFunction)benchmark_ingestion_log;
+	resources->num_analysis = &priv->num_analysis;
+	resources->progress_ngspice = &priv->progress_ngspice;
+	resources->progress_reader = &priv->progress_reader;
+	resources->sim_settings = sim_settings;
+	resources->netlist_file = g_strdup(netlist_file);
+	resources->ngspice_result_file = g_strdup(result_file);
+	resources->simulator = simulator;
+	resources->cancel_info = priv->cancel_info;
+	cancel_info_subscribe(resources->cancel_info);
+
+	gint64 start = g_get_monotonic_time();
+	ngspice_watcher_build_and_launch(resources);
+	g_main_loop_run(run.loop);
+	if (priv->saver != NULL) {
+		task_wait(priv->saver);
+		task_unref(priv->saver);
+		priv->saver = NULL;
+	}
+	gdouble seconds = (g_get_monotonic_time() - start) / (gdouble)G_USEC_PER_SEC;
+
+	// everything has to arrive, a fast but lossy chain does not count
+	SimulationData *sdat = priv->analysis ? SIM_DATA(priv->analysis->data) : NULL;
+	if (priv->aborted || sdat == NULL || sdat->got_points != rows || sdat->n_variables != columns + 1) {
+		for (GList *error = run.errors; error; error = error->next)
+			g_fprintf(stderr, "%s", (gchar *)error->data);
+		g_fprintf(stderr, "run failed: %u of %" G_GINT64_FORMAT " points\n", sdat ? sdat->got_points : 0, rows);
+		seconds = -1;
+	}
+
+	ngspice_watcher_build_and_launch_resources_finalize(resources);
+	g_list_free_full(run.errors, g_free);
+	g_main_loop_unref(run.loop);
+	g_object_unref(run.ngspice);
+	sim_settings_finalize(sim_settings);
+
+	return seconds;
+}
+
+int main(int argc, char *argv[]) {
+	GError *e = NULL;
+	GOptionContext *context = g_option_context_new("- measure the ingestion of simulator output");
+
+	g_option_context_add_main_entries(context, entries, NULL);
+	if (!g_option_context_parse(context, &argc, &argv, &e)) {
+		g_fprintf(stderr, "%s\n", e->message);
+		g_clear_error(&e);
+		g_option_context_free(context);
+		return 1;
+	}
+	g_option_context_free(context);
+
+	g_autofree gchar *exe = g_file_read_link("/proc/self/exe", NULL);
+	g_autofree gchar *dir = g_path_get_dirname(exe ? exe : argv[0]);
+	g_autofree gchar *fake_ngspice = g_build_filename(dir, "fake-ngspice", NULL);
+	g_autofree gchar *rows_arg = g_strdup_printf("--rows=%" G_GINT64_FORMAT, rows);
+	g_autofree gchar *columns_arg = g_strdup_printf("--columns=%d", columns);
+	g_autofree gchar *rate_arg = g_strdup_printf("--rate=%g", rate);
+	const gchar *simulator[] = {fake_ngspice, rows_arg, columns_arg, rate_arg, "-b", NULL};
+
+	g_autofree gchar *tmp_dir = g_dir_make_tmp("oregano-benchmark-ingestion-XXXXXX", &e);
+	if (tmp_dir == NULL) {
+		g_fprintf(stderr, "%s\n", e->message);
+		g_clear_error(&e);
+		return 1;
+	}
+	g_autofree gchar *netlist_file = g_build_filename(tmp_dir, "netlist", NULL);
+	g_autofree gchar *result_file = g_build_filename(tmp_dir, "result", NULL);
+	// the parser finds the analysis by the title ending in oregano
+	g_file_set_contents(netlist_file, "* benchmark.oregano\n.end\n", -1, NULL);
+
+	gdouble total_seconds = 0;
+	gdouble total_bytes = 0;
+	int status = 0;
+	for (int i = 0; i < runs; i++) {
+		gdouble seconds = benchmark_ingestion_run(simulator, netlist_file, result_file);
+		if (seconds < 0) {
+			status = 1;
+			break;
+		}
+
+		// the saver writes out every byte the simulator printed
+		GStatBuf stat_buf;
+		gdouble bytes = g_stat(result_file, &stat_buf) == 0 ? stat_buf.st_size : 0;
+		g_printf("run %d: %8.3f s %10.2f MB/s %12.0f rows/s\n", i + 1, seconds, bytes / seconds / 1e6, rows / seconds);
+
+		total_seconds += seconds;
+		total_bytes += bytes;
+	}
+	if (status == 0 && runs > 0)
+		g_printf("mean:  %8.3f s %10.2f MB/s %12.0f rows/s\n", total_seconds / runs,
+				total_bytes / total_seconds / 1e6, rows * runs / total_seconds);
+
+	g_remove(netlist_file);
+	g_remove(result_file);
+	g_rmdir(tmp_dir);
+
+	return status;
+}
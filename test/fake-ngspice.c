@@ -0,0 +1,245 @@
+/*
+ * fake-ngspice.c
+ *
+ *
+ * Authors:
+ *  Michi <st101564@stud.uni-stuttgart.de>
+ *
+ * Web page: https://ahoi.io/project/oregano
+ *
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+
+/**
+ * Stands in for "ngspice -b" in benchmarks and tests: prints the output
+ * of one transient analysis the way ngspice does (page breaks, the
+ * table header on every page, the columns in blocks of three, the
+ * progress lines on stderr), with as many rows and columns as asked
+ * for and at a given rate. The title is taken from the first line of
+ * the netlist, the rest of it is not read.
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include <glib.h>
+#include <glib/gprintf.h>
+
+// columns printed per block next to the index and the time, ngspice fits 80 characters
+#define FAKE_NGSPICE_COLUMNS_PER_BLOCK 3
+#define FAKE_NGSPICE_DASHES "--------------------------------------------------------------------------------\n"
+#define FAKE_NGSPICE_DEFAULT_TITLE "* fake-ngspice.oregano"
+
+static gint64 rows = 1000;
+static gint columns = 4;
+static gint page_rows = 58;
+static gdouble step = 1e-9;
+static gdouble rate = 0;
+static gint progress_lines = 20;
+static gchar *rawfile = NULL;
+static gboolean batch = FALSE;
+
+static GOptionEntry entries[] = {
+	{"rows", 0, 0, G_OPTION_ARG_INT64, &rows, "Number of time points", "N"},
+	{"columns", 0, 0, G_OPTION_ARG_INT, &columns, "Number of node voltages", "N"},
+	{"page-rows", 0, 0, G_OPTION_ARG_INT, &page_rows, "Rows per page", "N"},
+	{"step", 0, 0, G_OPTION_ARG_DOUBLE, &step, "Time between two points", "SECONDS"},
+	{"rate", 0, 0, G_OPTION_ARG_DOUBLE, &rate, "Rows printed per second, 0 for as fast as possible", "ROWS"},
+	{"progress-lines", 0, 0, G_OPTION_ARG_INT, &progress_lines, "Progress lines on stderr", "N"},
+	{"rawfile", 'r', 0, G_OPTION_ARG_FILENAME, &rawfile, "Also write an ASCII rawfile", "FILE"},
+	{"batch", 'b', 0, G_OPTION_ARG_NONE, &batch, "Accepted like ngspice, always on", NULL},
+	{NULL}
+};
+
+static gdouble fake_ngspice_value(gint64 row, gint column) {
+	gdouble time = row * step;
+
+	// one sine per node, they differ in amplitude and phase
+	return (column + 1) * sin(2 * G_PI * time / (step * 100) + column);
+}
+
+// the same widths as ngspice: 7 significant digits, negative numbers lose one
+static void fake_ngspice_print_number(FILE *out, gdouble number) {
+	if (number < 0)
+		fprintf(out, "%.5e\t", number);
+	else
+		fprintf(out, "%.6e\t", number);
+}
+
+static void fake_ngspice_print_title(FILE *out, const gchar *title, const gchar *date) {
+	fprintf(out, "                      %s\n", title);
+	fprintf(out, "                      Transient Analysis  %s\n", date);
+	fputs(FAKE_NGSPICE_DASHES, out);
+}
+
+static void fake_ngspice_print_header(FILE *out, gint first_column, gint n_columns) {
+	fprintf(out, "%-8s%-16s", "Index", "time");
+	for (gint column = first_column; column < first_column + n_columns; column++) {
+		g_autofree gchar *name = g_strdup_printf("V(%d)", column + 1);
+		fprintf(out, "%-16s", name);
+	}
+	fputs("\n" FAKE_NGSPICE_DASHES, out);
+}
+
+/**
+ * Sleeps until @printed rows are due at the requested rate.
+ */
+static void fake_ngspice_throttle(FILE *out, gint64 start, gint64 printed) {
+	if (rate <= 0)
+		return;
+
+	gint64 due = start + (gint64)(printed / rate * G_USEC_PER_SEC);
+	gint64 now = g_get_monotonic_time();
+	if (due > now) {
+		fflush(out);
+		g_usleep(due - now);
+	}
+}
+
+static void fake_ngspice_print_initial_solution(FILE *out) {
+	fputs("\n\nNo. of Data Rows : 1\n\n", out);
+	fputs("Initial Transient Solution\n--------------------------\n\n", out);
+	fprintf(out, "%-39s%s\n", "Node", "Voltage");
+	fprintf(out, "%-39s%s\n", "----", "-------");
+	for (gint column = 0; column < columns; column++) {
+		g_autofree gchar *name = g_strdup_printf("%d", column + 1);
+		fprintf(out, "%-39s%10g\n", name, fake_ngspice_value(0, column));
+	}
+	fprintf(out, "\n\nNo. of Data Rows : %" G_GINT64_FORMAT "\n", rows);
+}
+
+static void fake_ngspice_print_progress() {
+	gdouble stop = (rows - 1) * step;
+
+	for (gint i = 1; i <= progress_lines; i++)
+		g_fprintf(stderr, "Reference value :  %.5e\r", stop * i / progress_lines);
+	g_fprintf(stderr, "\n");
+}
+
+static void fake_ngspice_print_table(FILE *out, const gchar *title, const gchar *date) {
+	gint64 start = g_get_monotonic_time();
+	gint64 printed = 0;
+
+	fputc('\n', out);
+	for (gint first_column = 0; first_column < columns; first_column += FAKE_NGSPICE_COLUMNS_PER_BLOCK) {
+		gint n_columns = MIN(FAKE_NGSPICE_COLUMNS_PER_BLOCK, columns - first_column);
+		// the title takes the place of three rows on the first page of a block
+		gint page_left = page_rows - 3;
+
+		if (first_column > 0)
+			fputs("\f\n", out);
+		fake_ngspice_print_title(out, title, date);
+		fake_ngspice_print_header(out, first_column, n_columns);
+
+		for (gint64 row = 0; row < rows; row++) {
+			if (page_left == 0) {
+				fputs("\f\n", out);
+				fake_ngspice_print_header(out, first_column, n_columns);
+				page_left = page_rows;
+			}
+			page_left--;
+
+			fprintf(out, "%" G_GINT64_FORMAT "\t", row);
+			fake_ngspice_print_number(out, row * step);
+			for (gint column = first_column; column < first_column + n_columns; column++)
+				fake_ngspice_print_number(out, fake_ngspice_value(row, column));
+			fputc('\n', out);
+
+			fake_ngspice_throttle(out, start, ++printed);
+		}
+	}
+	fputc('\n', out);
+}
+
+static gboolean fake_ngspice_write_rawfile(const gchar *title, const gchar *date, GError **error) {
+	GString *raw = g_string_new(NULL);
+
+	g_string_append_printf(raw, "Title: %s\nDate: %s\nPlotname: Transient Analysis\nFlags: real\n", title, date);
+	g_string_append_printf(raw, "No. Variables: %d\nNo. Points: %" G_GINT64_FORMAT "\nVariables:\n", columns + 1, rows);
+	g_string_append(raw, "\t0\ttime\ttime\n");
+	for (gint column = 0; column < columns; column++)
+		g_string_append_printf(raw, "\t%d\tV(%d)\tvoltage\n", column + 1, column + 1);
+	g_string_append(raw, "Values:\n");
+	for (gint64 row = 0; row < rows; row++) {
+		g_string_append_printf(raw, " %" G_GINT64_FORMAT "\t%.15e\n", row, row * step);
+		for (gint column = 0; column < columns; column++)
+			g_string_append_printf(raw, "\t%.15e\n", fake_ngspice_value(row, column));
+	}
+
+	gboolean success = g_file_set_contents(rawfile, raw->str, raw->len, error);
+	g_string_free(raw, TRUE);
+	return success;
+}
+
+static gchar *fake_ngspice_read_title(const gchar *netlist) {
+	gchar *content = NULL;
+
+	if (netlist == NULL || !g_file_get_contents(netlist, &content, NULL, NULL))
+		return g_strdup(FAKE_NGSPICE_DEFAULT_TITLE);
+
+	gchar *end = strchr(content, '\n');
+	if (end != NULL)
+		*end = '\0';
+	if (*g_strstrip(content) == '\0') {
+		g_free(content);
+		return g_strdup(FAKE_NGSPICE_DEFAULT_TITLE);
+	}
+	return content;
+}
+
+int main(int argc, char *argv[]) {
+	GError *e = NULL;
+	GOptionContext *context = g_option_context_new("[NETLIST] - print ngspice output of a transient analysis");
+
+	g_option_context_add_main_entries(context, entries, NULL);
+	if (!g_option_context_parse(context, &argc, &argv, &e)) {
+		g_fprintf(stderr, "%s\n", e->message);
+		g_clear_error(&e);
+		g_option_context_free(context);
+		return 1;
+	}
+	g_option_context_free(context);
+
+	if (rows < 1 || columns < 1 || page_rows < 4) {
+		g_fprintf(stderr, "fake-ngspice: at least one row, one column and four rows per page\n");
+		return 1;
+	}
+
+	g_autofree gchar *title = fake_ngspice_read_title(argc > 1 ? argv[1] : NULL);
+	// fixed, so two runs print the same bytes
+	const gchar *date = "Thu Jan  1 00:00:00  1970";
+
+	// ngspice blocks its output, so do we
+	static gchar buffer[1 << 16];
+	setvbuf(stdout, buffer, _IOFBF, sizeof(buffer));
+
+	printf("\nCircuit: %s\n\n", title);
+	printf("Doing analysis at TEMP = 27.000000 and TNOM = 27.000000\n\n");
+	fake_ngspice_print_initial_solution(stdout);
+	fake_ngspice_print_progress();
+	fake_ngspice_print_table(stdout, title, date);
+	printf("Total CPU time: 0.000 seconds.\n\n");
+
+	if (rawfile != NULL && !fake_ngspice_write_rawfile(title, date, &e)) {
+		g_fprintf(stderr, "%s\n", e->message);
+		g_clear_error(&e);
+		return 1;
+	}
+
+	return fflush(stdout) == 0 ? 0 : 1;
+}
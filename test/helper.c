@@ -1,5 +1,11 @@
 #include <glib.h>
 #include <math.h>
+#include <string.h>
+
+#include "../src/model/schematic.h"
+#include "../src/save-schematic.h"
+#include "../src/load-library.h"
+#include "../src/oregano.h"
 
 gchar* get_test_base_dir() {
 	g_autofree gchar *cwd = g_get_current_dir();
@@ -221,3 +227,55 @@ double xy_data_metric(const XYData *element_1, const XYData *element_2) {
 
 	return distance;
 }
+
+/**
+ * Loads simple.oregano with the default library, which has to stay
+ * loaded as long as the schematic lives.
+ *
+ * Use {@link #unload_test_schematic} with @libraries_before if you are done.
+ */
+Schematic *load_test_schematic(GList **libraries_before) {
+	GError *e = NULL;
+	g_autofree gchar *test_dir = get_test_base_dir();
+	g_autofree gchar *library_file = g_strdup_printf("%s/../data/libraries/default.oreglib", test_dir);
+	g_autofree gchar *schematic_file = g_strdup_printf("%s/../data/examples/simple.oregano", test_dir);
+
+	*libraries_before = oregano.libraries;
+	oregano.libraries = g_list_append(NULL, library_parse_xml_file(library_file));
+
+	Schematic *schematic = schematic_read(schematic_file, &e);
+	g_assert_no_error(e);
+	g_assert_nonnull(schematic);
+	return schematic;
+}
+
+void unload_test_schematic(Schematic *schematic, GList *libraries_before) {
+	g_object_unref(schematic);
+	g_list_free_full(oregano.libraries, (GDestroyNotify)library_unref);
+	oregano.libraries = libraries_before;
+}
+
+static gint compare_item_keys(gconstpointer a, gconstpointer b) {
+	return strcmp(*(const gchar **)a, *(const gchar **)b);
+}
+
+/**
+ * The keys of all items of @schematic, sorted, so two schematics with
+ * the same items give the same text.
+ */
+gchar *get_schematic_item_keys(Schematic *schematic) {
+	GPtrArray *keys = g_ptr_array_new_with_free_func(g_free);
+	GString *all = g_string_new(NULL);
+
+	for (GList *iter = schematic_get_items(schematic); iter; iter = iter->next) {
+		GString *key = g_string_new(NULL);
+		schematic_write_item_key(iter->data, key);
+		g_ptr_array_add(keys, g_string_free(key, FALSE));
+	}
+	g_ptr_array_sort(keys, compare_item_keys);
+	for (guint i = 0; i < keys->len; i++)
+		g_string_append(all, g_ptr_array_index(keys, i));
+
+	g_ptr_array_unref(keys);
+	return g_string_free(all, FALSE);
+}
@@ -0,0 +1,213 @@
+/*
+ * perf-helper.c
+ *
+ *
+ * Authors:
+ *  Michi <st101564@stud.uni-stuttgart.de>
+ *
+ * Web page: https://ahoi.io/project/oregano
+ *
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+
+#ifndef PERF_HELPER_H_
+#define PERF_HELPER_H_
+
+/**
+ * Micro-benchmarks for hot paths, run with "microtests -m perf -p /perf".
+ *
+ * A benchmark is warmed up until it ran for PERF_WARM_UP_USEC. That also
+ * tells how many calls fit into one sample of at least
+ * PERF_SAMPLE_MIN_USEC, so the timer resolution does not matter. Then
+ * PERF_SAMPLES samples are taken and the median and the percentiles of
+ * the time per call are reported.
+ *
+ * The medians are compared with test/perf-baseline.txt, a benchmark
+ * fails if it got slower by more than OREGANO_PERF_TOLERANCE (a factor,
+ * default 0.25). With OREGANO_PERF_WRITE_BASELINE=1 the baseline is
+ * written instead. Baselines only make sense on the machine they were
+ * taken on.
+ */
+
+#include <stdlib.h>
+#include <glib.h>
+#include <glib/gstdio.h>
+
+#define PERF_WARM_UP_USEC 100000
+#define PERF_SAMPLE_MIN_USEC 2000
+#define PERF_SAMPLES 31
+#define PERF_TOLERANCE_DEFAULT 0.25
+
+typedef void (*PerfFunc)(gpointer data);
+
+typedef struct {
+	// nanoseconds per call
+	gdouble median;
+	gdouble p90;
+	gdouble p99;
+	gdouble min;
+	guint64 calls_per_sample;
+} PerfResult;
+
+gchar* get_test_base_dir();
+
+static gint perf_compare_doubles(gconstpointer a, gconstpointer b) {
+	gdouble x = *(const gdouble *)a;
+	gdouble y = *(const gdouble *)b;
+	return (x > y) - (x < y);
+}
+
+// nearest rank
+static gdouble perf_percentile(const gdouble *sorted, guint n, guint percent) {
+	guint rank = (percent * n + 99) / 100;
+	return sorted[MAX(rank, 1) - 1];
+}
+
+static gchar *perf_get_baseline_file() {
+	const gchar *file = g_getenv("OREGANO_PERF_BASELINE");
+	if (file != NULL)
+		return g_strdup(file);
+
+	g_autofree gchar *test_dir = get_test_base_dir();
+	return g_build_filename(test_dir, "perf-baseline.txt", NULL);
+}
+
+/**
+ * name -> median in nanoseconds, as gdouble*
+ */
+static GHashTable *perf_read_baseline(const gchar *file) {
+	GHashTable *baseline = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, g_free);
+	g_autofree gchar *content = NULL;
+
+	if (!g_file_get_contents(file, &content, NULL, NULL))
+		return baseline;
+
+	gchar **lines = g_strsplit(content, "\n", -1);
+	for (gchar **line = lines; *line != NULL; line++) {
+		gchar **fields = g_strsplit_set(g_strstrip(*line), " \t", 2);
+		if (fields[0] != NULL && fields[1] != NULL && fields[0][0] != '#') {
+			gdouble *median = g_new(gdouble, 1);
+			*median = g_ascii_strtod(fields[1], NULL);
+			g_hash_table_insert(baseline, g_strdup(fields[0]), median);
+		}
+		g_strfreev(fields);
+	}
+	g_strfreev(lines);
+
+	return baseline;
+}
+
+/**
+ * Rewrites @file with the medians of @baseline. The comment lines of
+ * the old file explain how to take it, they are kept on top.
+ */
+static void perf_write_baseline(const gchar *file, GHashTable *baseline) {
+	GString *content = g_string_new(NULL);
+	GList *names = g_list_sort(g_hash_table_get_keys(baseline), (GCompareFunc)g_strcmp0);
+	g_autofree gchar *old_content = NULL;
+
+	if (g_file_get_contents(file, &old_content, NULL, NULL)) {
+		gchar **lines = g_strsplit(old_content, "\n", -1);
+		for (gchar **line = lines; *line != NULL; line++) {
+			if ((*line)[0] == '#')
+				g_string_append_printf(content, "%s\n", *line);
+		}
+		g_strfreev(lines);
+	}
+	if (content->len == 0)
+		g_string_append(content, "# median nanoseconds per call, written by OREGANO_PERF_WRITE_BASELINE=1 microtests -m perf -p /perf\n");
+
+	for (GList *name = names; name; name = name->next) {
+		gchar number[G_ASCII_DTOSTR_BUF_SIZE];
+		gdouble *median = g_hash_table_lookup(baseline, name->data);
+		g_string_append_printf(content, "%s %s\n", (gchar *)name->data, g_ascii_formatd(number, sizeof(number), "%.1f", *median));
+	}
+	g_list_free(names);
+
+	g_file_set_contents(file, content->str, content->len, NULL);
+	g_string_free(content, TRUE);
+}
+
+/**
+ * Compares @result with the baseline of @name, or stores it there.
+ */
+static void perf_check_baseline(const gchar *name, const PerfResult *result) {
+	g_autofree gchar *file = perf_get_baseline_file();
+	GHashTable *baseline = perf_read_baseline(file);
+	const gchar *tolerance_env = g_getenv("OREGANO_PERF_TOLERANCE");
+	gdouble tolerance = tolerance_env ? g_ascii_strtod(tolerance_env, NULL) : PERF_TOLERANCE_DEFAULT;
+
+	if (g_strcmp0(g_getenv("OREGANO_PERF_WRITE_BASELINE"), "1") == 0) {
+		gdouble *median = g_new(gdouble, 1);
+		*median = result->median;
+		g_hash_table_insert(baseline, g_strdup(name), median);
+		perf_write_baseline(file, baseline);
+	} else {
+		gdouble *median = g_hash_table_lookup(baseline, name);
+		if (median == NULL) {
+			g_test_message("%s: no baseline", name);
+		} else if (result->median > *median * (1 + tolerance)) {
+			g_test_message("%s: %.1f ns, %.0f%% slower than the baseline of %.1f ns",
+					name, result->median, (result->median / *median - 1) * 100, *median);
+			g_test_fail();
+		}
+	}
+
+	g_hash_table_destroy(baseline);
+}
+
+static gdouble perf_time_calls(PerfFunc func, gpointer data, guint64 calls) {
+	gint64 start = g_get_monotonic_time();
+	for (guint64 i = 0; i < calls; i++)
+		func(data);
+	return g_get_monotonic_time() - start;
+}
+
+/**
+ * Measures @func, reports the result and checks it against the baseline.
+ * @name is the key in the baseline file.
+ */
+static void perf_measure(const gchar *name, PerfFunc func, gpointer data, PerfResult *result) {
+	gdouble samples[PERF_SAMPLES];
+	guint64 calls = 1;
+	gint64 warm_up_end = g_get_monotonic_time() + PERF_WARM_UP_USEC;
+
+	// doubles the calls per sample until one sample is long enough
+	do {
+		if (perf_time_calls(func, data, calls) < PERF_SAMPLE_MIN_USEC)
+			calls *= 2;
+	} while (g_get_monotonic_time() < warm_up_end);
+
+	for (int i = 0; i < PERF_SAMPLES; i++)
+		samples[i] = perf_time_calls(func, data, calls) * 1000 / calls;
+	qsort(samples, PERF_SAMPLES, sizeof(gdouble), perf_compare_doubles);
+
+	result->median = perf_percentile(samples, PERF_SAMPLES, 50);
+	result->p90 = perf_percentile(samples, PERF_SAMPLES, 90);
+	result->p99 = perf_percentile(samples, PERF_SAMPLES, 99);
+	result->min = samples[0];
+	result->calls_per_sample = calls;
+
+	g_test_minimized_result(result->median, "%s: median %.1f ns", name, result->median);
+	g_test_message("%s: median %.1f ns, p90 %.1f ns, p99 %.1f ns, min %.1f ns, %" G_GUINT64_FORMAT " calls per sample",
+			name, result->median, result->p90, result->p99, result->min, calls);
+
+	perf_check_baseline(name, result);
+}
+
+#endif
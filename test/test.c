@@ -6,12 +6,35 @@
 #endif
 
 #include "helper.c"
+#include "perf-helper.c"
 #include "test_wire.c"
 #include "test_engine.c"
 #include "test_nodestore.c"
 #include "test_update_connection_designators.c"
 #include "test_thread_pipe.c"
 #include "test_engine_ngspice.c"
+#include "test_engine_run.c"
+#include "test_measure.c"
+#include "test_result_manager.c"
+#include "test_sim_compare.c"
+#include "test_task_scheduler.c"
+#include "test_sim_daemon.c"
+#include "test_resim_scheduler.c"
+#include "test_op_values.c"
+#include "test_mem_stats.c"
+#include "test_stall_detector.c"
+#include "test_startup_timer.c"
+#include "test_netlist_helper.c"
+#include "test_perf.c"
+#include "test_edit_journal.c"
+#include "test_clipboard.c"
+#include "test_print_layout.c"
+#include "test_save_journal.c"
+#include "test_binary_schematic.c"
+#include "test_library_monitor.c"
+#include "test_gplot_lines.c"
+#include "test_sim_data_export.c"
+#include "test_netlist_pager.c"
 
 #if DEBUG_FORCE_FAIL
 void
@@ -38,6 +61,28 @@ main (int argc, char *argv[])
 	add_funcs_test_update_connection_designators();
 	add_funcs_test_thread_pipe_buffered();
 	add_funcs_test_engine_ngspice();
+	add_funcs_test_engine_run();
+	add_funcs_test_measure();
+	add_funcs_test_result_manager();
+	add_funcs_test_sim_compare();
+	add_funcs_test_task_scheduler();
+	add_funcs_test_sim_daemon();
+	add_funcs_test_resim_scheduler();
+	add_funcs_test_op_values();
+	add_funcs_test_mem_stats();
+	add_funcs_test_stall_detector();
+	add_funcs_test_startup_timer();
+	add_funcs_test_netlist_helper();
+	add_funcs_test_perf();
+	add_funcs_test_edit_journal();
+	add_funcs_test_clipboard();
+	add_funcs_test_print_layout();
+	add_funcs_test_save_journal();
+	add_funcs_test_binary_schematic();
+	add_funcs_test_library_monitor();
+	add_funcs_test_gplot_lines();
+	add_funcs_test_sim_data_export();
+	add_funcs_test_netlist_pager();
 #if DEBUG_FORCE_FAIL
 	g_test_add_func ("/false", test_false);
 #endif
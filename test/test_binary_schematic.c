@@ -0,0 +1,130 @@
+/*
+ * test_binary_schematic.c
+ *
+ *
+ * Authors:
+ *  Michi <st101564@stud.uni-stuttgart.de>
+ *
+ * Web page: https://ahoi.io/project/oregano
+ *
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+
+#ifndef TEST_BINARY_SCHEMATIC_H_
+#define TEST_BINARY_SCHEMATIC_H_
+
+#include <glib/gstdio.h>
+
+#include "../src/binary-schematic.h"
+#include "../src/save-schematic.h"
+#include "../src/errors.h"
+
+static void test_binary_schematic_convert();
+static void test_binary_schematic_bad_file();
+
+void add_funcs_test_binary_schematic() {
+	g_test_add_func("/core/binary_schematic/convert", test_binary_schematic_convert);
+	g_test_add_func("/core/binary_schematic/bad_file", test_binary_schematic_bad_file);
+}
+
+static gchar *test_binary_schematic_get_settings(Schematic *schematic) {
+	GString *key = g_string_new(NULL);
+	schematic_write_settings_key(schematic, key);
+	return g_string_free(key, FALSE);
+}
+
+// saved under the other extension and read back, nothing may change
+static void test_binary_schematic_assert_converted(Schematic *schematic, const gchar *filename) {
+	GError *e = NULL;
+
+	schematic_set_filename(schematic, filename);
+	g_assert_true(schematic_save_file(schematic, &e));
+	g_assert_no_error(e);
+
+	Schematic *converted = schematic_read(filename, &e);
+	g_assert_no_error(e);
+
+	g_autofree gchar *expected_items = get_schematic_item_keys(schematic);
+	g_autofree gchar *actual_items = get_schematic_item_keys(converted);
+	g_assert_cmpstr(actual_items, ==, expected_items);
+
+	g_autofree gchar *expected_settings = test_binary_schematic_get_settings(schematic);
+	g_autofree gchar *actual_settings = test_binary_schematic_get_settings(converted);
+	g_assert_cmpstr(actual_settings, ==, expected_settings);
+
+	g_object_unref(converted);
+}
+
+static void test_binary_schematic_convert() {
+	GError *e = NULL;
+	GList *libraries_before;
+	Schematic *schematic = load_test_schematic(&libraries_before);
+	g_autofree gchar *dir = g_dir_make_tmp("oregano-test-binary-schematic-XXXXXX", NULL);
+	g_autofree gchar *binary_filename = g_build_filename(dir, "simple.oregbin", NULL);
+	g_autofree gchar *xml_filename = g_build_filename(dir, "simple.oregano", NULL);
+
+	test_binary_schematic_assert_converted(schematic, binary_filename);
+
+	// and back from the binary file to XML
+	Schematic *binary = schematic_read(binary_filename, &e);
+	g_assert_no_error(e);
+	test_binary_schematic_assert_converted(binary, xml_filename);
+	g_autofree gchar *expected = get_schematic_item_keys(schematic);
+	g_autofree gchar *actual = get_schematic_item_keys(binary);
+	g_assert_cmpstr(actual, ==, expected);
+	g_object_unref(binary);
+
+	unload_test_schematic(schematic, libraries_before);
+	g_unlink(binary_filename);
+	g_unlink(xml_filename);
+	g_rmdir(dir);
+}
+
+static void test_binary_schematic_bad_file() {
+	GError *e = NULL;
+	GList *libraries_before;
+	Schematic *schematic = load_test_schematic(&libraries_before);
+	g_autofree gchar *dir = g_dir_make_tmp("oregano-test-binary-schematic-XXXXXX", NULL);
+	g_autofree gchar *filename = g_build_filename(dir, "simple.oregbin", NULL);
+	gchar *contents;
+	gsize length;
+
+	schematic_set_filename(schematic, filename);
+	g_assert_true(schematic_write_binary(schematic, &e));
+	g_assert_no_error(e);
+	g_file_get_contents(filename, &contents, &length, &e);
+	g_assert_no_error(e);
+
+	// cut off in the middle of the section table and of the last section
+	gsize lengths[] = {0, 5, 40, length - 1};
+	for (int i = 0; i < G_N_ELEMENTS(lengths); i++) {
+		g_file_set_contents(filename, contents, lengths[i], &e);
+		g_assert_no_error(e);
+
+		g_assert_null(schematic_read(filename, &e));
+		g_assert_error(e, OREGANO_ERROR, OREGANO_SCHEMATIC_BAD_FILE_FORMAT);
+		g_clear_error(&e);
+	}
+
+	g_free(contents);
+	unload_test_schematic(schematic, libraries_before);
+	g_unlink(filename);
+	g_rmdir(dir);
+}
+
+#endif
@@ -0,0 +1,135 @@
+/*
+ * test_clipboard.c
+ *
+ *
+ * Authors:
+ *  Michi <st101564@stud.uni-stuttgart.de>
+ *
+ * Web page: https://ahoi.io/project/oregano
+ *
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+
+#ifndef TEST_CLIPBOARD_H_
+#define TEST_CLIPBOARD_H_
+
+#include "../src/load-schematic.h"
+#include "../src/save-schematic.h"
+#include "../src/model/textbox.h"
+#include "../src/errors.h"
+
+static void test_clipboard_round_trip();
+static void test_clipboard_bad_format();
+
+void add_funcs_test_clipboard() {
+	g_test_add_func("/core/clipboard/round_trip", test_clipboard_round_trip);
+	g_test_add_func("/core/clipboard/bad_format", test_clipboard_bad_format);
+}
+
+// the items of one type keep their order in the fragment
+static GList *test_clipboard_filter(GList *items, GType type) {
+	GList *filtered = NULL;
+
+	for (GList *iter = items; iter; iter = iter->next)
+		if (G_TYPE_CHECK_INSTANCE_TYPE(iter->data, type))
+			filtered = g_list_prepend(filtered, iter->data);
+	return g_list_reverse(filtered);
+}
+
+static void test_clipboard_assert_same_pos(ItemData *expected, ItemData *actual) {
+	Coords expected_pos, actual_pos;
+
+	item_data_get_pos(expected, &expected_pos);
+	item_data_get_pos(actual, &actual_pos);
+	g_assert_cmpfloat(actual_pos.x, ==, expected_pos.x);
+	g_assert_cmpfloat(actual_pos.y, ==, expected_pos.y);
+}
+
+static void test_clipboard_round_trip() {
+	GError *e = NULL;
+	GList *libraries_before;
+	Schematic *schematic = load_test_schematic(&libraries_before);
+	Textbox *textbox = textbox_new(NULL);
+	Coords pos = {30, 40};
+
+	textbox_set_text(textbox, "copied");
+	item_data_set_pos(ITEM_DATA(textbox), &pos);
+
+	GList *items = g_list_append(g_list_copy(schematic_get_items(schematic)), textbox);
+	GBytes *bytes = schematic_write_xml_items(items);
+	g_assert_nonnull(bytes);
+
+	gsize length;
+	const gchar *data = g_bytes_get_data(bytes, &length);
+	GList *pasted = schematic_parse_xml_items(data, length, &e);
+	g_assert_no_error(e);
+	g_assert_cmpuint(g_list_length(pasted), ==, g_list_length(items));
+
+	GList *parts = test_clipboard_filter(items, TYPE_PART);
+	GList *pasted_parts = test_clipboard_filter(pasted, TYPE_PART);
+	g_assert_cmpuint(g_list_length(pasted_parts), ==, 6);
+	for (GList *a = parts, *b = pasted_parts; a; a = a->next, b = b->next) {
+		g_autofree gchar *expected = part_get_property(a->data, "refdes");
+		g_autofree gchar *actual = part_get_property(b->data, "refdes");
+
+		test_clipboard_assert_same_pos(a->data, b->data);
+		g_assert_cmpstr(actual, ==, expected);
+		g_assert_cmpint(part_get_rotation(b->data), ==, part_get_rotation(a->data));
+	}
+
+	GList *wires = test_clipboard_filter(items, TYPE_WIRE);
+	GList *pasted_wires = test_clipboard_filter(pasted, TYPE_WIRE);
+	g_assert_cmpuint(g_list_length(pasted_wires), ==, g_list_length(wires));
+	for (GList *a = wires, *b = pasted_wires; a; a = a->next, b = b->next) {
+		Coords expected_start, actual_start;
+
+		wire_get_start_pos(a->data, &expected_start);
+		wire_get_start_pos(b->data, &actual_start);
+		g_assert_true(coords_equal(&actual_start, &expected_start));
+	}
+
+	GList *pasted_textboxes = test_clipboard_filter(pasted, TYPE_TEXTBOX);
+	g_assert_cmpuint(g_list_length(pasted_textboxes), ==, 1);
+	test_clipboard_assert_same_pos(ITEM_DATA(textbox), pasted_textboxes->data);
+	g_assert_cmpstr(textbox_get_text(pasted_textboxes->data), ==, "copied");
+
+	// the pasted items are not added to any schematic
+	g_assert_cmpuint(g_list_length(schematic_get_items(schematic)), ==, g_list_length(items) - 1);
+
+	g_list_free(parts);
+	g_list_free(pasted_parts);
+	g_list_free(wires);
+	g_list_free(pasted_wires);
+	g_list_free(pasted_textboxes);
+	g_list_free_full(pasted, g_object_unref);
+	g_list_free(items);
+	g_bytes_unref(bytes);
+	g_object_unref(textbox);
+	unload_test_schematic(schematic, libraries_before);
+}
+
+static void test_clipboard_bad_format() {
+	GError *e = NULL;
+	const gchar *text = "some text copied from another program";
+
+	g_assert_null(schematic_parse_xml_items(text, strlen(text), &e));
+	g_assert_error(e, OREGANO_ERROR, OREGANO_SCHEMATIC_BAD_FILE_FORMAT);
+	g_clear_error(&e);
+}
+
+#endif
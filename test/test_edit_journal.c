@@ -0,0 +1,226 @@
+/*
+ * test_edit_journal.c
+ *
+ *
+ * Authors:
+ *  Michi <st101564@stud.uni-stuttgart.de>
+ *
+ * Web page: https://ahoi.io/project/oregano
+ *
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+
+#ifndef TEST_EDIT_JOURNAL_H_
+#define TEST_EDIT_JOURNAL_H_
+
+#include "../src/model/edit-journal.h"
+#include "../src/model/schematic.h"
+#include "../src/model/part.h"
+
+static void test_edit_journal_move();
+static void test_edit_journal_rotate();
+static void test_edit_journal_remove();
+static void test_edit_journal_limits();
+
+void add_funcs_test_edit_journal() {
+	g_test_add_func("/core/edit_journal/move", test_edit_journal_move);
+	g_test_add_func("/core/edit_journal/rotate", test_edit_journal_rotate);
+	g_test_add_func("/core/edit_journal/remove", test_edit_journal_remove);
+	g_test_add_func("/core/edit_journal/limits", test_edit_journal_limits);
+}
+
+static void test_edit_journal_changed(Schematic *schematic, guint *count) {
+	(*count)++;
+}
+
+// unlike wires, moved parts are never merged by the node store
+static Part *test_edit_journal_get_part(Schematic *schematic, Part *other_than) {
+	for (GList *iter = schematic_get_items(schematic); iter; iter = iter->next)
+		if (IS_PART(iter->data) && iter->data != other_than)
+			return iter->data;
+	g_assert_not_reached();
+}
+
+static void test_edit_journal_assert_pos(ItemData *data, gdouble x, gdouble y) {
+	Coords pos;
+
+	item_data_get_pos(data, &pos);
+	g_assert_cmpfloat(pos.x, ==, x);
+	g_assert_cmpfloat(pos.y, ==, y);
+}
+
+// like the sheet does it
+static void test_edit_journal_move_item(ItemData *data, const Coords *delta) {
+	item_data_unregister(data);
+	item_data_move(data, delta);
+	item_data_register(data);
+}
+
+static void test_edit_journal_move() {
+	GList *libraries_before;
+	Schematic *schematic = load_test_schematic(&libraries_before);
+	EditJournal *journal = schematic_get_journal(schematic);
+	guint changed = 0;
+	Coords pos;
+
+	g_signal_connect(schematic, "journal_changed", G_CALLBACK(test_edit_journal_changed), &changed);
+
+	ItemData *data = ITEM_DATA(test_edit_journal_get_part(schematic, NULL));
+	GList *items = g_list_append(NULL, data);
+	item_data_get_pos(data, &pos);
+	g_assert_false(edit_journal_can_undo(journal));
+
+	const Coords delta = {20., -10.};
+	test_edit_journal_move_item(data, &delta);
+	edit_journal_move(journal, items, &delta);
+	g_assert_true(edit_journal_can_undo(journal));
+	g_assert_cmpuint(changed, ==, 1);
+
+	g_assert_true(edit_journal_undo(journal));
+	test_edit_journal_assert_pos(data, pos.x, pos.y);
+	g_assert_false(edit_journal_can_undo(journal));
+	g_assert_true(edit_journal_can_redo(journal));
+
+	g_assert_true(edit_journal_redo(journal));
+	test_edit_journal_assert_pos(data, pos.x + 20., pos.y - 10.);
+	g_assert_false(edit_journal_redo(journal));
+
+	// a different delta per item
+	ItemData *other = ITEM_DATA(test_edit_journal_get_part(schematic, PART(data)));
+	Coords other_pos;
+	item_data_get_pos(other, &other_pos);
+	items = g_list_append(items, other);
+	const Coords deltas[] = {{10., 0.}, {0., 30.}};
+	test_edit_journal_move_item(data, &deltas[0]);
+	test_edit_journal_move_item(other, &deltas[1]);
+	edit_journal_move_each(journal, items, deltas);
+
+	g_assert_true(edit_journal_undo(journal));
+	test_edit_journal_assert_pos(data, pos.x + 20., pos.y - 10.);
+	test_edit_journal_assert_pos(other, other_pos.x, other_pos.y);
+	g_assert_true(edit_journal_undo(journal));
+	test_edit_journal_assert_pos(data, pos.x, pos.y);
+	g_assert_cmpuint(changed, ==, 6);
+
+	g_list_free(items);
+	unload_test_schematic(schematic, libraries_before);
+}
+
+static void test_edit_journal_assert_matrix(const cairo_matrix_t *actual, const cairo_matrix_t *expected) {
+	g_assert_true(fabs(actual->xx - expected->xx) < 1e-9);
+	g_assert_true(fabs(actual->xy - expected->xy) < 1e-9);
+	g_assert_true(fabs(actual->yx - expected->yx) < 1e-9);
+	g_assert_true(fabs(actual->yy - expected->yy) < 1e-9);
+}
+
+static void test_edit_journal_rotate() {
+	GList *libraries_before;
+	Schematic *schematic = load_test_schematic(&libraries_before);
+	EditJournal *journal = schematic_get_journal(schematic);
+	Coords pos, after, b1, b2;
+
+	ItemData *data = ITEM_DATA(test_edit_journal_get_part(schematic, NULL));
+	GList *items = g_list_append(NULL, data);
+	item_data_get_pos(data, &pos);
+	const cairo_matrix_t rotate = *item_data_get_rotate(data);
+
+	item_data_get_absolute_bbox(data, &b1, &b2);
+	Coords center = coords_average(&b1, &b2);
+	item_data_unregister(data);
+	item_data_rotate(data, 90, &center);
+	item_data_register(data);
+	edit_journal_rotate(journal, items, 90, &center);
+	const cairo_matrix_t rotated = *item_data_get_rotate(data);
+
+	// rotated back around the same center
+	g_assert_true(edit_journal_undo(journal));
+	test_edit_journal_assert_matrix(item_data_get_rotate(data), &rotate);
+	item_data_get_pos(data, &after);
+	g_assert_true(coords_equal(&after, &pos));
+
+	g_assert_true(edit_journal_redo(journal));
+	test_edit_journal_assert_matrix(item_data_get_rotate(data), &rotated);
+
+	g_list_free(items);
+	unload_test_schematic(schematic, libraries_before);
+}
+
+static void test_edit_journal_remove() {
+	GList *libraries_before;
+	Schematic *schematic = load_test_schematic(&libraries_before);
+	EditJournal *journal = schematic_get_journal(schematic);
+	const guint n_items = g_list_length(schematic_get_items(schematic));
+
+	Part *part = test_edit_journal_get_part(schematic, NULL);
+	g_autofree gchar *refdes = part_get_property(part, "refdes");
+	const guint n_parts = g_list_length(node_store_get_parts(schematic_get_store(schematic)));
+
+	// the journal keeps the removed part alive
+	GList *items = g_list_append(NULL, part);
+	edit_journal_remove(journal, items);
+	schematic_remove_item(schematic, ITEM_DATA(part));
+	g_assert_cmpuint(g_list_length(schematic_get_items(schematic)), ==, n_items - 1);
+	g_assert_null(g_list_find(node_store_get_parts(schematic_get_store(schematic)), part));
+
+	g_assert_true(edit_journal_undo(journal));
+	g_assert_cmpuint(g_list_length(schematic_get_items(schematic)), ==, n_items);
+	g_assert_cmpuint(g_list_length(node_store_get_parts(schematic_get_store(schematic))), ==, n_parts);
+	g_autofree gchar *readded_refdes = part_get_property(part, "refdes");
+	g_assert_cmpstr(readded_refdes, ==, refdes);
+
+	g_assert_true(edit_journal_redo(journal));
+	g_assert_cmpuint(g_list_length(schematic_get_items(schematic)), ==, n_items - 1);
+
+	// undoing the adding removes it again
+	g_assert_true(edit_journal_undo(journal));
+	edit_journal_add(journal, items);
+	g_assert_false(edit_journal_can_redo(journal));
+	g_assert_true(edit_journal_undo(journal));
+	g_assert_cmpuint(g_list_length(schematic_get_items(schematic)), ==, n_items - 1);
+
+	g_list_free(items);
+	unload_test_schematic(schematic, libraries_before);
+}
+
+static void test_edit_journal_limits() {
+	GList *libraries_before;
+	Schematic *schematic = load_test_schematic(&libraries_before);
+	EditJournal *journal = schematic_get_journal(schematic);
+	GList *items = schematic_get_items(schematic);
+	const guint n_items = g_list_length(items);
+	const Coords delta = {10., 10.};
+
+	edit_journal_set_limits(journal, 3, 1000);
+	for (int i = 0; i < 5; i++)
+		edit_journal_move(journal, items, &delta);
+	g_assert_cmpuint(edit_journal_get_n_steps(journal), ==, 3);
+	g_assert_cmpuint(edit_journal_get_n_items(journal), ==, 3 * n_items);
+
+	// the newest edit is kept even if it is too big on its own
+	edit_journal_set_limits(journal, 3, n_items - 1);
+	g_assert_cmpuint(edit_journal_get_n_steps(journal), ==, 1);
+	g_assert_cmpuint(edit_journal_get_n_items(journal), ==, n_items);
+
+	edit_journal_clear(journal);
+	g_assert_false(edit_journal_can_undo(journal));
+	g_assert_cmpuint(edit_journal_get_n_items(journal), ==, 0);
+
+	unload_test_schematic(schematic, libraries_before);
+}
+
+#endif
@@ -34,12 +34,14 @@ gchar* get_test_base_dir();
 static void test_engine_ngspice_basic();
 static void test_engine_ngspice_error_no_such_file_or_directory();
 static void test_engine_ngspice_error_step_zero();
+static void test_engine_ngspice_fake();
 
 void
 add_funcs_test_engine_ngspice() {
 	g_test_add_func ("/core/engine/ngspice/watcher/basic", test_engine_ngspice_basic);
 	g_test_add_func ("/core/engine/ngspice/watcher/error/no_such_file_or_directory", test_engine_ngspice_error_no_such_file_or_directory);
 	g_test_add_func ("/core/engine/ngspice/watcher/error/step_zero", test_engine_ngspice_error_step_zero);
+	g_test_add_func ("/core/engine/ngspice/watcher/fake", test_engine_ngspice_fake);
 }
 
 static void test_engine_ngspice_log_append_error(GList **list, const gchar *string) {
@@ -288,10 +290,11 @@ static void test_engine_ngspice_basic() {
 	ngspice_analysis_finalize(expected_analysis);
 
 	/**
-	 * Wait for saver thread to finish saving.
+	 * Wait for saver task to finish saving.
 	 */
 	if (test_resources->ngspice->priv->saver != NULL) {
-		g_thread_join(test_resources->ngspice->priv->saver);
+		task_wait(test_resources->ngspice->priv->saver);
+		task_unref(test_resources->ngspice->priv->saver);
 		test_resources->ngspice->priv->saver = NULL;
 	}
 	/**
@@ -376,3 +379,53 @@ static void test_engine_ngspice_error_step_zero() {
 
 	test_engine_ngspice_resources_finalize(test_resources);
 }
+
+/**
+ * fake-ngspice is built next to the tests. Several column blocks and
+ * many pages, so every state of the parser is passed.
+ */
+static void test_engine_ngspice_fake() {
+	TestEngineNgspiceResources *test_resources = test_engine_ngspice_resources_new();
+	g_autofree gchar *exe = g_file_read_link("/proc/self/exe", NULL);
+	g_autofree gchar *dir = g_path_get_dirname(exe);
+	g_autofree gchar *fake_ngspice = g_build_filename(dir, "fake-ngspice", NULL);
+	const gchar *simulator[] = {fake_ngspice, "--rows=500", "--columns=7", "-b", NULL};
+
+	if (!g_file_test(fake_ngspice, G_FILE_TEST_IS_EXECUTABLE)) {
+		g_test_skip("fake-ngspice is not built");
+		test_engine_ngspice_resources_finalize(test_resources);
+		return;
+	}
+
+	g_file_set_contents(test_resources->resources->netlist_file, "* fake.oregano\n.end\n", -1, NULL);
+	test_resources->resources->simulator = simulator;
+	test_resources->sim_settings->trans_enable = TRUE;
+	test_resources->sim_settings->ac_enable = FALSE;
+	test_resources->sim_settings->dc_enable = FALSE;
+	test_resources->sim_settings->fourier_enable = FALSE;
+
+	ngspice_watcher_build_and_launch(test_resources->resources);
+	g_main_loop_run(test_resources->loop);
+	if (test_resources->ngspice->priv->saver != NULL) {
+		task_wait(test_resources->ngspice->priv->saver);
+		task_unref(test_resources->ngspice->priv->saver);
+		test_resources->ngspice->priv->saver = NULL;
+	}
+
+	g_assert_false(test_resources->ngspice->priv->aborted);
+	g_assert_cmpuint(g_list_length(test_resources->ngspice->priv->analysis), ==, 1);
+
+	SimulationData *sdat = SIM_DATA(test_resources->ngspice->priv->analysis->data);
+	g_assert_cmpint(sdat->type, ==, ANALYSIS_TYPE_TRANSIENT);
+	g_assert_cmpint(sdat->n_variables, ==, 8);
+	g_assert_cmpuint(sdat->got_points, ==, 500);
+	g_assert_cmpstr(sdat->var_names[0], ==, "time");
+	g_assert_cmpstr(sdat->var_names[7], ==, "V(7)");
+	g_assert_cmpfloat(fabs(g_array_index(sdat->data[0], gdouble, 499) - 499e-9), <, 1e-15);
+	// V(2) = 2 sin(1) at the start
+	g_assert_cmpfloat(fabs(g_array_index(sdat->data[2], gdouble, 0) - 1.682942), <, 1e-6);
+
+	g_remove(test_resources->resources->netlist_file);
+	g_remove(test_resources->resources->ngspice_result_file);
+	test_engine_ngspice_resources_finalize(test_resources);
+}
@@ -0,0 +1,219 @@
+/*
+ * test_engine_run.c
+ *
+ *
+ * Authors:
+ *  Michi <st101564@stud.uni-stuttgart.de>
+ *
+ * Web page: https://ahoi.io/project/oregano
+ *
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef TEST_ENGINE_RUN_H_
+#define TEST_ENGINE_RUN_H_
+
+#include "../src/engines/engine.h"
+#include "../src/engines/engine-internal.h"
+#include "../src/errors.h"
+
+static void test_engine_run_done();
+static void test_engine_run_aborted();
+static void test_engine_run_cancel();
+static void test_engine_run_parallel();
+
+void add_funcs_test_engine_run() {
+	g_test_add_func("/core/engine/run/done", test_engine_run_done);
+	g_test_add_func("/core/engine/run/aborted", test_engine_run_aborted);
+	g_test_add_func("/core/engine/run/cancel", test_engine_run_cancel);
+	g_test_add_func("/core/engine/run/parallel", test_engine_run_parallel);
+}
+
+/**
+ * An engine that does not simulate anything. It reports the end of the
+ * run from the main loop like the real engines, and like gnucap it does
+ * not report anything after it was stopped.
+ */
+typedef struct {
+	GObject parent;
+	gboolean fail;
+	gboolean started;
+	gboolean stopped;
+	guint source_id;
+	GList *results;
+} TestEngineRunFake;
+
+typedef struct {
+	GObjectClass parent;
+} TestEngineRunFakeClass;
+
+static void test_engine_run_fake_interface_init(OreganoEngineClass *iface);
+
+G_DEFINE_TYPE_WITH_CODE(TestEngineRunFake, test_engine_run_fake, G_TYPE_OBJECT,
+		G_IMPLEMENT_INTERFACE(OREGANO_TYPE_ENGINE, test_engine_run_fake_interface_init))
+
+static gboolean test_engine_run_fake_finish(TestEngineRunFake *fake) {
+	fake->source_id = 0;
+	g_signal_emit_by_name(fake, fake->fail ? "aborted" : "done");
+	return G_SOURCE_REMOVE;
+}
+
+static void test_engine_run_fake_start(OreganoEngine *engine) {
+	TestEngineRunFake *fake = (TestEngineRunFake *)engine;
+
+	fake->started = TRUE;
+	fake->source_id = g_idle_add((GSourceFunc)test_engine_run_fake_finish, fake);
+}
+
+static void test_engine_run_fake_stop(OreganoEngine *engine) {
+	TestEngineRunFake *fake = (TestEngineRunFake *)engine;
+
+	fake->stopped = TRUE;
+	if (fake->source_id != 0)
+		g_source_remove(fake->source_id);
+	fake->source_id = 0;
+}
+
+static GList *test_engine_run_fake_get_results(OreganoEngine *engine) {
+	return ((TestEngineRunFake *)engine)->results;
+}
+
+static void test_engine_run_fake_interface_init(OreganoEngineClass *iface) {
+	iface->start = test_engine_run_fake_start;
+	iface->stop = test_engine_run_fake_stop;
+	iface->get_results = test_engine_run_fake_get_results;
+}
+
+static void test_engine_run_fake_finalize(GObject *object) {
+	g_list_free(((TestEngineRunFake *)object)->results);
+	G_OBJECT_CLASS(test_engine_run_fake_parent_class)->finalize(object);
+}
+
+static void test_engine_run_fake_class_init(TestEngineRunFakeClass *klass) {
+	G_OBJECT_CLASS(klass)->finalize = test_engine_run_fake_finalize;
+}
+
+static void test_engine_run_fake_init(TestEngineRunFake *fake) {
+	// the results are only compared by address
+	fake->results = g_list_append(NULL, fake);
+}
+
+static void test_engine_run_ready(GObject *source, GAsyncResult *result, GAsyncResult **slot) {
+	*slot = g_object_ref(result);
+}
+
+static GAsyncResult *test_engine_run_wait(TestEngineRunFake *fake, GCancellable *cancellable, gboolean cancel_after_start) {
+	GAsyncResult *result = NULL;
+
+	oregano_engine_run_async(OREGANO_ENGINE(fake), cancellable, (GAsyncReadyCallback)test_engine_run_ready, &result);
+	if (cancel_after_start)
+		g_cancellable_cancel(cancellable);
+	while (result == NULL)
+		g_main_context_iteration(NULL, TRUE);
+
+	return result;
+}
+
+static void test_engine_run_done() {
+	GError *e = NULL;
+	TestEngineRunFake *fake = g_object_new(test_engine_run_fake_get_type(), NULL);
+
+	GAsyncResult *result = test_engine_run_wait(fake, NULL, FALSE);
+	GList *results = oregano_engine_run_finish(OREGANO_ENGINE(fake), result, &e);
+	g_assert_no_error(e);
+	g_assert(results == fake->results);
+	g_object_unref(result);
+
+	// the run does not keep signal handlers around
+	g_signal_emit_by_name(fake, "done");
+
+	g_object_unref(fake);
+}
+
+static void test_engine_run_aborted() {
+	GError *e = NULL;
+	TestEngineRunFake *fake = g_object_new(test_engine_run_fake_get_type(), NULL);
+
+	fake->fail = TRUE;
+	GAsyncResult *result = test_engine_run_wait(fake, NULL, FALSE);
+	g_assert_null(oregano_engine_run_finish(OREGANO_ENGINE(fake), result, &e));
+	g_assert_error(e, OREGANO_ERROR, OREGANO_SIMULATE_ERROR_ABORTED);
+	g_clear_error(&e);
+	g_object_unref(result);
+
+	g_object_unref(fake);
+}
+
+static void test_engine_run_cancel() {
+	GError *e = NULL;
+	TestEngineRunFake *fake = g_object_new(test_engine_run_fake_get_type(), NULL);
+	GCancellable *cancellable = g_cancellable_new();
+
+	// while it runs, the engine is stopped and the run ends without waiting for it
+	GAsyncResult *result = test_engine_run_wait(fake, cancellable, TRUE);
+	g_assert_null(oregano_engine_run_finish(OREGANO_ENGINE(fake), result, &e));
+	g_assert_error(e, G_IO_ERROR, G_IO_ERROR_CANCELLED);
+	g_assert_true(fake->started);
+	g_assert_true(fake->stopped);
+	g_clear_error(&e);
+	g_object_unref(result);
+	g_object_unref(fake);
+
+	// canceled before, the engine does not even start
+	fake = g_object_new(test_engine_run_fake_get_type(), NULL);
+	result = test_engine_run_wait(fake, cancellable, FALSE);
+	g_assert_null(oregano_engine_run_finish(OREGANO_ENGINE(fake), result, &e));
+	g_assert_error(e, G_IO_ERROR, G_IO_ERROR_CANCELLED);
+	g_assert_false(fake->started);
+	g_clear_error(&e);
+	g_object_unref(result);
+	g_object_unref(fake);
+
+	g_object_unref(cancellable);
+}
+
+static void test_engine_run_parallel() {
+	TestEngineRunFake *fakes[8];
+	GAsyncResult *results[G_N_ELEMENTS(fakes)] = {NULL};
+
+	for (int i = 0; i < G_N_ELEMENTS(fakes); i++) {
+		fakes[i] = g_object_new(test_engine_run_fake_get_type(), NULL);
+		fakes[i]->fail = i % 2;
+		oregano_engine_run_async(OREGANO_ENGINE(fakes[i]), NULL, (GAsyncReadyCallback)test_engine_run_ready, &results[i]);
+	}
+
+	for (int i = 0; i < G_N_ELEMENTS(fakes); i++) {
+		GError *e = NULL;
+
+		while (results[i] == NULL)
+			g_main_context_iteration(NULL, TRUE);
+
+		// every run reports its own engine
+		GList *list = oregano_engine_run_finish(OREGANO_ENGINE(fakes[i]), results[i], &e);
+		if (fakes[i]->fail) {
+			g_assert_error(e, OREGANO_ERROR, OREGANO_SIMULATE_ERROR_ABORTED);
+			g_clear_error(&e);
+		} else {
+			g_assert_no_error(e);
+			g_assert(list == fakes[i]->results);
+		}
+		g_object_unref(results[i]);
+		g_object_unref(fakes[i]);
+	}
+}
+
+#endif
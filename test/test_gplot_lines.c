@@ -0,0 +1,224 @@
+/*
+ * test_gplot_lines.c
+ *
+ *
+ * Authors:
+ *  Michi <st101564@stud.uni-stuttgart.de>
+ *
+ * Web page: https://ahoi.io/project/oregano
+ *
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+
+#ifndef TEST_GPLOT_LINES_H_
+#define TEST_GPLOT_LINES_H_
+
+#include "../src/gplot/gplotlines.h"
+
+static void test_gplot_lines_value();
+static void test_gplot_lines_value_descending();
+static void test_gplot_lines_value_pulse();
+static void test_gplot_lines_range();
+static void test_gplot_lines_range_descending();
+
+void add_funcs_test_gplot_lines() {
+	g_test_add_func("/core/gplot/lines/value", test_gplot_lines_value);
+	g_test_add_func("/core/gplot/lines/value_descending", test_gplot_lines_value_descending);
+	g_test_add_func("/core/gplot/lines/value_pulse", test_gplot_lines_value_pulse);
+	g_test_add_func("/core/gplot/lines/range", test_gplot_lines_range);
+	g_test_add_func("/core/gplot/lines/range_descending", test_gplot_lines_range_descending);
+}
+
+// takes over @x and @y like g_plot_lines_new
+static GPlotFunction *test_gplot_lines_new(const gdouble *x, const gdouble *y, guint points) {
+	return g_plot_lines_new(g_memdup(x, points * sizeof(gdouble)), g_memdup(y, points * sizeof(gdouble)), points);
+}
+
+static void test_gplot_lines_value() {
+	// the simulator repeats the time of a breakpoint
+	const gdouble x[] = {0.0, 1.0, 2.0, 2.0, 4.0};
+	const gdouble y[] = {0.0, 10.0, 20.0, -20.0, -40.0};
+	GPlotFunction *f = test_gplot_lines_new(x, y, G_N_ELEMENTS(x));
+	gdouble value;
+
+	g_assert_true(g_plot_function_get_value(f, 0.0, &value));
+	g_assert_cmpfloat_with_epsilon(value, 0.0, 1e-12);
+	g_assert_true(g_plot_function_get_value(f, 0.25, &value));
+	g_assert_cmpfloat_with_epsilon(value, 2.5, 1e-12);
+	g_assert_true(g_plot_function_get_value(f, 1.0, &value));
+	g_assert_cmpfloat_with_epsilon(value, 10.0, 1e-12);
+	g_assert_true(g_plot_function_get_value(f, 2.0, &value));
+	g_assert_cmpfloat_with_epsilon(value, -20.0, 1e-12);
+	g_assert_true(g_plot_function_get_value(f, 3.0, &value));
+	g_assert_cmpfloat_with_epsilon(value, -30.0, 1e-12);
+	g_assert_true(g_plot_function_get_value(f, 4.0, &value));
+	g_assert_cmpfloat_with_epsilon(value, -40.0, 1e-12);
+
+	g_assert_false(g_plot_function_get_value(f, -0.1, &value));
+	g_assert_false(g_plot_function_get_value(f, 4.1, &value));
+
+	g_object_unref(f);
+
+	// a long trace, every sample is found
+	guint points = 100000;
+	gdouble *xs = g_new(gdouble, points);
+	gdouble *ys = g_new(gdouble, points);
+	for (guint i = 0; i < points; i++) {
+		xs[i] = i * 1e-6;
+		ys[i] = i % 7;
+	}
+	f = g_plot_lines_new(xs, ys, points);
+	for (guint i = 0; i < points; i += 997) {
+		g_assert_true(g_plot_function_get_value(f, xs[i], &value));
+		g_assert_cmpfloat_with_epsilon(value, i % 7, 1e-9);
+	}
+	g_object_unref(f);
+
+	f = g_plot_lines_new(NULL, NULL, 0);
+	g_assert_false(g_plot_function_get_value(f, 0.0, &value));
+	g_object_unref(f);
+}
+
+static void test_gplot_lines_value_descending() {
+	// a DC sweep from 5 V down to 0 V
+	const gdouble x[] = {5.0, 4.0, 2.0, 0.0};
+	const gdouble y[] = {1.0, 2.0, 4.0, 8.0};
+	GPlotFunction *f = test_gplot_lines_new(x, y, G_N_ELEMENTS(x));
+	gdouble value;
+
+	g_assert_true(g_plot_function_get_value(f, 4.5, &value));
+	g_assert_cmpfloat_with_epsilon(value, 1.5, 1e-12);
+	g_assert_true(g_plot_function_get_value(f, 1.0, &value));
+	g_assert_cmpfloat_with_epsilon(value, 6.0, 1e-12);
+	g_assert_true(g_plot_function_get_value(f, 0.0, &value));
+	g_assert_cmpfloat_with_epsilon(value, 8.0, 1e-12);
+	g_assert_false(g_plot_function_get_value(f, 5.5, &value));
+	g_assert_false(g_plot_function_get_value(f, -0.5, &value));
+
+	g_object_unref(f);
+}
+
+static void test_gplot_lines_value_pulse() {
+	const gdouble x[] = {0.0, 100.0, 200.0};
+	const gdouble y[] = {3.0, 1.0, 2.0};
+	GPlotFunction *f = test_gplot_lines_new(x, y, G_N_ELEMENTS(x));
+	gdouble value;
+
+	// spectral lines are not interpolated
+	g_object_set(G_OBJECT(f), "graph-type", FREQUENCY_PULSE, "shift", 10.0, NULL);
+	g_assert_true(g_plot_function_get_value(f, 55.0, &value));
+	g_assert_cmpfloat_with_epsilon(value, 3.0, 1e-12);
+	g_assert_true(g_plot_function_get_value(f, 70.0, &value));
+	g_assert_cmpfloat_with_epsilon(value, 1.0, 1e-12);
+	g_assert_false(g_plot_function_get_value(f, 5.0, &value));
+
+	g_object_unref(f);
+}
+
+// what the range pyramid has to come up with, looking at every sample
+static gboolean test_gplot_lines_range_expected(GPlotFunction *f, const gdouble *x, const gdouble *y, guint points, gdouble xmin, gdouble xmax, gdouble *ymin, gdouble *ymax) {
+	gboolean found = FALSE;
+	gdouble value;
+
+	*ymin = G_MAXDOUBLE;
+	*ymax = -G_MAXDOUBLE;
+	for (guint i = 0; i < points; i++) {
+		if (x[i] >= xmin && x[i] <= xmax) {
+			*ymin = MIN(*ymin, y[i]);
+			*ymax = MAX(*ymax, y[i]);
+			found = TRUE;
+		}
+	}
+	// the curve is cut at the borders
+	if (g_plot_function_get_value(f, xmin, &value)) {
+		*ymin = MIN(*ymin, value);
+		*ymax = MAX(*ymax, value);
+		found = TRUE;
+	}
+	if (g_plot_function_get_value(f, xmax, &value)) {
+		*ymin = MIN(*ymin, value);
+		*ymax = MAX(*ymax, value);
+		found = TRUE;
+	}
+	return found;
+}
+
+static void test_gplot_lines_range_check(gboolean ascending) {
+	guint points = 100003;
+	gdouble *x = g_new(gdouble, points);
+	gdouble *y = g_new(gdouble, points);
+	GRand *rand = g_rand_new_with_seed(98);
+
+	for (guint i = 0; i < points; i++) {
+		x[i] = ascending ? i : points - 1 - i;
+		y[i] = g_rand_double_range(rand, -1.0, 1.0);
+	}
+	GPlotFunction *f = test_gplot_lines_new(x, y, points);
+
+	for (guint n = 0; n < 1000; n++) {
+		gdouble a = g_rand_double_range(rand, -10.0, points + 10.0);
+		// small windows as well as most of the run
+		gdouble b = a + (n % 2 ? g_rand_double_range(rand, 0.0, 50.0) : g_rand_double_range(rand, 0.0, points));
+		gdouble ymin, ymax, expected_min, expected_max;
+
+		gboolean expected = test_gplot_lines_range_expected(f, x, y, points, a, b, &expected_min, &expected_max);
+		g_assert_cmpint(g_plot_function_get_range(f, a, b, &ymin, &ymax), ==, expected);
+		if (expected) {
+			g_assert_cmpfloat(ymin, ==, expected_min);
+			g_assert_cmpfloat(ymax, ==, expected_max);
+		}
+	}
+
+	// left of all samples
+	gdouble ymin, ymax;
+	g_assert_false(g_plot_function_get_range(f, -20.0, -10.0, &ymin, &ymax));
+
+	g_rand_free(rand);
+	g_object_unref(f);
+	g_free(x);
+	g_free(y);
+}
+
+static void test_gplot_lines_range() {
+	test_gplot_lines_range_check(TRUE);
+
+	// between two samples only the cut at the borders counts
+	const gdouble x[] = {0.0, 10.0};
+	const gdouble y[] = {0.0, 100.0};
+	GPlotFunction *f = test_gplot_lines_new(x, y, G_N_ELEMENTS(x));
+	gdouble ymin, ymax;
+
+	g_assert_true(g_plot_function_get_range(f, 2.0, 3.0, &ymin, &ymax));
+	g_assert_cmpfloat_with_epsilon(ymin, 20.0, 1e-12);
+	g_assert_cmpfloat_with_epsilon(ymax, 30.0, 1e-12);
+
+	// spectral lines start at zero
+	g_object_set(G_OBJECT(f), "graph-type", FREQUENCY_PULSE, NULL);
+	g_assert_true(g_plot_function_get_range(f, 5.0, 15.0, &ymin, &ymax));
+	g_assert_cmpfloat(ymin, ==, 0.0);
+	g_assert_cmpfloat(ymax, ==, 100.0);
+	g_assert_false(g_plot_function_get_range(f, 2.0, 3.0, &ymin, &ymax));
+
+	g_object_unref(f);
+}
+
+static void test_gplot_lines_range_descending() {
+	test_gplot_lines_range_check(FALSE);
+}
+
+#endif
@@ -0,0 +1,170 @@
+/*
+ * test_library_monitor.c
+ *
+ *
+ * Authors:
+ *  Michi <st101564@stud.uni-stuttgart.de>
+ *
+ * Web page: https://ahoi.io/project/oregano
+ *
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+
+#ifndef TEST_LIBRARY_MONITOR_H_
+#define TEST_LIBRARY_MONITOR_H_
+
+#include <glib/gstdio.h>
+
+#include "../src/library-monitor.h"
+#include "../src/oregano-config.h"
+
+static void test_library_monitor_reload();
+static void test_library_monitor_remove();
+
+void add_funcs_test_library_monitor() {
+	g_test_add_func("/core/library_monitor/reload", test_library_monitor_reload);
+	g_test_add_func("/core/library_monitor/remove", test_library_monitor_remove);
+}
+
+// a copy of the default library, which is the only one loaded
+static gchar *test_library_monitor_copy_library(const gchar *dir, GList **libraries_before) {
+	g_autofree gchar *test_dir = get_test_base_dir();
+	g_autofree gchar *source = g_strdup_printf("%s/../data/libraries/default.oreglib", test_dir);
+	gchar *filename = g_build_filename(dir, "default.oreglib", NULL);
+	g_autofree gchar *contents = NULL;
+	GError *e = NULL;
+
+	g_file_get_contents(source, &contents, NULL, &e);
+	g_assert_no_error(e);
+	g_file_set_contents(filename, contents, -1, &e);
+	g_assert_no_error(e);
+
+	*libraries_before = oregano.libraries;
+	oregano.libraries = g_list_append(NULL, library_parse_xml_file(filename));
+	return filename;
+}
+
+static void test_library_monitor_edit_library(const gchar *filename) {
+	g_autofree gchar *contents = NULL;
+	GError *e = NULL;
+
+	g_file_get_contents(filename, &contents, NULL, &e);
+	g_assert_no_error(e);
+	g_auto(GStrv) parts = g_strsplit(contents, "Used to add a model", 2);
+	g_assert_cmpuint(g_strv_length(parts), ==, 2);
+	g_autofree gchar *edited = g_strjoinv("Used to add an edited model", parts);
+	g_file_set_contents(filename, edited, -1, &e);
+	g_assert_no_error(e);
+}
+
+static void test_library_monitor_check_library(Part *part, Library *library) {
+	g_assert_true(part_get_library(part) == library);
+}
+
+static void test_library_monitor_reload() {
+	GError *e = NULL;
+	GList *libraries_before;
+	g_autofree gchar *dir = g_dir_make_tmp("oregano-test-library-monitor-XXXXXX", NULL);
+	g_autofree gchar *filename = test_library_monitor_copy_library(dir, &libraries_before);
+	g_autofree gchar *test_dir = get_test_base_dir();
+	g_autofree gchar *schematic_file = g_strdup_printf("%s/../data/examples/simple.oregano", test_dir);
+	Library *old_library = oregano.libraries->data;
+
+	MemStatsCounter baseline, counter;
+
+	Schematic *schematic = schematic_read(schematic_file, &e);
+	g_assert_no_error(e);
+	schematic_set_dirty(schematic, FALSE);
+	g_autofree gchar *keys = get_schematic_item_keys(schematic);
+	mem_stats_get(MEM_STATS_LIBRARY, &baseline);
+
+	// a burst of changes is handled once, after the delay
+	test_library_monitor_edit_library(filename);
+	library_monitor_file_changed(filename);
+	library_monitor_file_changed(filename);
+	while (oregano.libraries->data == old_library)
+		g_main_context_iteration(NULL, TRUE);
+
+	// replaced at its place
+	g_assert_cmpuint(g_list_length(oregano.libraries), ==, 1);
+	Library *new_library = oregano.libraries->data;
+	g_assert_cmpstr(new_library->filename, ==, filename);
+	LibraryPart *library_part = library_get_part(new_library, "Model");
+	g_assert_nonnull(strstr(library_part->description, "an edited model"));
+
+	// the parts follow without reading the schematic again
+	schematic_rebind_library(schematic, old_library, new_library);
+	schematic_parts_foreach(schematic, (ForeachItemDataFunc)test_library_monitor_check_library, new_library);
+	g_autofree gchar *rebound_keys = get_schematic_item_keys(schematic);
+	g_assert_cmpstr(rebound_keys, ==, keys);
+	g_assert_false(schematic_is_dirty(schematic));
+
+	// the old library went with the last part that referred to it
+	mem_stats_get(MEM_STATS_LIBRARY, &counter);
+	g_assert_cmpint(counter.objects, ==, baseline.objects);
+
+	// other files in the directory are none of its business
+	g_autofree gchar *other = g_build_filename(dir, "default.oreglib~", NULL);
+	library_monitor_file_changed(other);
+	library_monitor_flush();
+	g_assert_true(oregano.libraries->data == new_library);
+
+	g_object_unref(schematic);
+	g_list_free_full(oregano.libraries, (GDestroyNotify)library_unref);
+	oregano.libraries = libraries_before;
+	g_unlink(filename);
+	g_rmdir(dir);
+}
+
+static void test_library_monitor_remove() {
+	GList *libraries_before;
+	g_autofree gchar *dir = g_dir_make_tmp("oregano-test-library-monitor-XXXXXX", NULL);
+	g_autofree gchar *filename = test_library_monitor_copy_library(dir, &libraries_before);
+	g_autofree gchar *added = g_build_filename(dir, "added.oreglib", NULL);
+	g_autofree gchar *contents = NULL;
+	GError *e = NULL;
+	MemStatsCounter baseline, counter;
+
+	// a new file is appended
+	mem_stats_get(MEM_STATS_LIBRARY, &baseline);
+	g_file_get_contents(filename, &contents, NULL, &e);
+	g_assert_no_error(e);
+	g_file_set_contents(added, contents, -1, &e);
+	g_assert_no_error(e);
+	library_monitor_file_changed(added);
+	library_monitor_flush();
+	g_assert_cmpuint(g_list_length(oregano.libraries), ==, 2);
+	g_assert_cmpstr(((Library *)oregano.libraries->next->data)->filename, ==, added);
+
+	// and dropped again when it is gone
+	g_unlink(added);
+	library_monitor_file_changed(added);
+	library_monitor_flush();
+	g_assert_cmpuint(g_list_length(oregano.libraries), ==, 1);
+	g_assert_cmpstr(((Library *)oregano.libraries->data)->filename, ==, filename);
+	mem_stats_get(MEM_STATS_LIBRARY, &counter);
+	g_assert_cmpint(counter.objects, ==, baseline.objects);
+	g_assert_cmpint(counter.bytes, ==, baseline.bytes);
+
+	g_list_free_full(oregano.libraries, (GDestroyNotify)library_unref);
+	oregano.libraries = libraries_before;
+	g_unlink(filename);
+	g_rmdir(dir);
+}
+
+#endif
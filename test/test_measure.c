@@ -0,0 +1,332 @@
+/*
+ * test_measure.c
+ *
+ *
+ * Authors:
+ *  Michi <st101564@stud.uni-stuttgart.de>
+ *
+ * Web page: https://ahoi.io/project/oregano
+ *
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef TEST_MEASURE_H_
+#define TEST_MEASURE_H_
+
+#include <math.h>
+#include "../src/measure.h"
+#include "../src/errors.h"
+
+static void test_measure_kernels();
+static void test_measure_sine();
+static void test_measure_edges();
+static void test_measure_step_response();
+static void test_measure_errors();
+static void test_measure_table();
+
+void add_funcs_test_measure() {
+	g_test_add_func("/core/measure/kernels", test_measure_kernels);
+	g_test_add_func("/core/measure/sine", test_measure_sine);
+	g_test_add_func("/core/measure/edges", test_measure_edges);
+	g_test_add_func("/core/measure/step_response", test_measure_step_response);
+	g_test_add_func("/core/measure/errors", test_measure_errors);
+	g_test_add_func("/core/measure/table", test_measure_table);
+}
+
+typedef gdouble (*TestMeasureWaveform)(gdouble t, gdouble parameter);
+
+/**
+ * Creates a transient result with the columns "time" and "v(out)"
+ * holding @n samples of @waveform on [0, @length].
+ */
+static SimulationData *test_measure_sim_data_new(TestMeasureWaveform waveform, gdouble parameter, gdouble length, guint n) {
+	SimulationData *sdat = g_new0(SimulationData, 1);
+
+	sdat->type = ANALYSIS_TYPE_TRANSIENT;
+	sdat->n_variables = 2;
+	sdat->var_names = g_new0(gchar *, 3);
+	sdat->var_names[0] = g_strdup("time");
+	sdat->var_names[1] = g_strdup("v(out)");
+	sdat->data = g_new0(GArray *, 2);
+	for (int i = 0; i < 2; i++)
+		sdat->data[i] = g_array_sized_new(FALSE, FALSE, sizeof(gdouble), n);
+
+	for (guint i = 0; i < n; i++) {
+		gdouble t = length * i / (n - 1);
+		gdouble y = waveform(t, parameter);
+		g_array_append_val(sdat->data[0], t);
+		g_array_append_val(sdat->data[1], y);
+	}
+	sdat->got_points = n;
+	sdat->got_var = 2;
+
+	return sdat;
+}
+
+static void test_measure_sim_data_free(SimulationData *sdat) {
+	for (int i = 0; i < sdat->n_variables; i++)
+		g_array_free(sdat->data[i], TRUE);
+	g_free(sdat->data);
+	g_strfreev(sdat->var_names);
+	g_free(sdat);
+}
+
+static gdouble test_measure_sine_wave(gdouble t, gdouble frequency) {
+	return sin(2 * G_PI * frequency * t);
+}
+
+static gdouble test_measure_cosine_wave(gdouble t, gdouble frequency) {
+	return cos(2 * G_PI * frequency * t);
+}
+
+/**
+ * Trapezoidal pulse train with period 1, the level is 1 for @duty of
+ * the period (measured at the half level).
+ */
+static gdouble test_measure_pulse_wave(gdouble t, gdouble duty) {
+	gdouble edge = 0.01;
+	gdouble phase = t - floor(t);
+	if (phase < edge)
+		return phase / edge;
+	if (phase < duty)
+		return 1;
+	if (phase < duty + edge)
+		return 1 - (phase - duty) / edge;
+	return 0;
+}
+
+static gdouble test_measure_ramp(gdouble t, gdouble unused) {
+	return CLAMP(t - 1, 0, 1);
+}
+
+/**
+ * Unit step response of a second order system with damping @zeta and
+ * natural frequency 1.
+ */
+static gdouble test_measure_second_order(gdouble t, gdouble zeta) {
+	gdouble wd = sqrt(1 - zeta * zeta);
+	return 1 - exp(-zeta * t) * (cos(wd * t) + zeta / wd * sin(wd * t));
+}
+
+static gdouble test_measure_evaluate(Measurement *m, const SimulationData *sdat) {
+	GError *e = NULL;
+	gdouble result = NAN;
+
+	gboolean success = measurement_evaluate(m, sdat, &result, &e);
+	g_assert_no_error(e);
+	g_assert_true(success);
+	measurement_free(m);
+
+	return result;
+}
+
+static void test_measure_kernels() {
+	gdouble x[] = {0, 1, 2, 2, 3, 5};
+	gdouble y[] = {0, 2, 4, 4, 0, 0};
+	gsize n = G_N_ELEMENTS(x);
+
+	g_assert_cmpuint(measure_lower_bound(x, n, -1), ==, 0);
+	g_assert_cmpuint(measure_lower_bound(x, n, 2), ==, 2);
+	g_assert_cmpuint(measure_lower_bound(x, n, 2.5), ==, 4);
+	g_assert_cmpuint(measure_lower_bound(x, n, 6), ==, n);
+
+	g_assert_cmpfloat(measure_interpolate(x, y, n, 0.5), ==, 1);
+	g_assert_cmpfloat(measure_interpolate(x, y, n, 2.5), ==, 2);
+	g_assert_cmpfloat(measure_interpolate(x, y, n, 10), ==, 0);
+
+	gdouble crossings[4];
+	g_assert_cmpuint(measure_crossings(x, y, 0, n, 1, MEASURE_EDGE_ANY, NULL, 0), ==, 2);
+	g_assert_cmpuint(measure_crossings(x, y, 0, n, 1, MEASURE_EDGE_ANY, crossings, 4), ==, 2);
+	g_assert_cmpfloat(crossings[0], ==, 0.5);
+	g_assert_cmpfloat(crossings[1], ==, 2.75);
+	g_assert_cmpuint(measure_crossings(x, y, 0, n, 1, MEASURE_EDGE_FALL, crossings, 4), ==, 1);
+	g_assert_cmpfloat(crossings[0], ==, 2.75);
+
+	MeasureStats stats;
+	g_assert_true(measure_window_stats(x, y, n, 0.5, 4, &stats));
+	g_assert_cmpfloat(stats.min, ==, 0);
+	g_assert_cmpfloat(stats.max, ==, 4);
+	g_assert_cmpfloat(stats.x_max, ==, 2);
+	// 0.75 + 3 + 2
+	g_assert_cmpfloat_with_epsilon(stats.integral, 5.75, 1e-12);
+	g_assert_false(measure_window_stats(x, y, n, 6, 7, &stats));
+}
+
+static void test_measure_sine() {
+	// 5 periods of 1 kHz, enough samples to span several blocks
+	SimulationData *sdat = test_measure_sim_data_new(test_measure_sine_wave, 1e3, 5e-3, 20001);
+
+	Measurement *m = measurement_new("period", MEASURE_PERIOD, "v(out)");
+	m->threshold = 0.5;
+	g_assert_cmpfloat_with_epsilon(test_measure_evaluate(m, sdat), 1e-3, 1e-9);
+
+	m = measurement_new("freq", MEASURE_FREQUENCY, "V(OUT)");
+	g_assert_cmpfloat_with_epsilon(test_measure_evaluate(m, sdat), 1e3, 1e-3);
+
+	m = measurement_new("rms", MEASURE_RMS, "v(out)");
+	g_assert_cmpfloat_with_epsilon(test_measure_evaluate(m, sdat), 1 / sqrt(2), 1e-5);
+
+	m = measurement_new("avg", MEASURE_AVG, "v(out)");
+	g_assert_cmpfloat_with_epsilon(test_measure_evaluate(m, sdat), 0, 1e-9);
+
+	m = measurement_new("pp", MEASURE_PEAK_TO_PEAK, "v(out)");
+	g_assert_cmpfloat_with_epsilon(test_measure_evaluate(m, sdat), 2, 1e-6);
+
+	// integral of the first positive half wave
+	m = measurement_new("integ", MEASURE_INTEGRAL, "v(out)");
+	m->from = 0;
+	m->to = 0.5e-3;
+	g_assert_cmpfloat_with_epsilon(test_measure_evaluate(m, sdat), 1 / (G_PI * 1e3), 1e-9);
+
+	// third falling zero crossing
+	m = measurement_new("cross", MEASURE_CROSS, "v(out)");
+	m->threshold = 0;
+	m->edge = MEASURE_EDGE_FALL;
+	m->occurrence = 3;
+	g_assert_cmpfloat_with_epsilon(test_measure_evaluate(m, sdat), 2.5e-3, 1e-9);
+
+	m = measurement_new("max", MEASURE_MAX, "v(out)");
+	m->from = 1e-3;
+	m->to = 1.1e-3;
+	g_assert_cmpfloat_with_epsilon(test_measure_evaluate(m, sdat), sin(2 * G_PI * 0.1), 1e-9);
+
+	test_measure_sim_data_free(sdat);
+}
+
+static void test_measure_edges() {
+	SimulationData *ramp = test_measure_sim_data_new(test_measure_ramp, 0, 3, 3001);
+
+	Measurement *m = measurement_new("rise", MEASURE_RISE_TIME, "v(out)");
+	g_assert_cmpfloat_with_epsilon(test_measure_evaluate(m, ramp), 0.8, 1e-9);
+
+	m = measurement_new("rise", MEASURE_RISE_TIME, "v(out)");
+	m->low = 0.2;
+	m->high = 0.7;
+	g_assert_cmpfloat_with_epsilon(test_measure_evaluate(m, ramp), 0.5, 1e-9);
+
+	test_measure_sim_data_free(ramp);
+
+	SimulationData *pulse = test_measure_sim_data_new(test_measure_pulse_wave, 0.25, 4, 4001);
+
+	m = measurement_new("duty", MEASURE_DUTY_CYCLE, "v(out)");
+	g_assert_cmpfloat_with_epsilon(test_measure_evaluate(m, pulse), 0.25, 1e-9);
+
+	m = measurement_new("fall", MEASURE_FALL_TIME, "v(out)");
+	g_assert_cmpfloat_with_epsilon(test_measure_evaluate(m, pulse), 0.008, 1e-9);
+
+	m = measurement_new("period", MEASURE_PERIOD, "v(out)");
+	m->edge = MEASURE_EDGE_FALL;
+	g_assert_cmpfloat_with_epsilon(test_measure_evaluate(m, pulse), 1, 1e-9);
+
+	test_measure_sim_data_free(pulse);
+}
+
+static void test_measure_step_response() {
+	gdouble zeta = 0.5;
+	SimulationData *sdat = test_measure_sim_data_new(test_measure_second_order, zeta, 40, 40001);
+
+	Measurement *m = measurement_new("overshoot", MEASURE_OVERSHOOT, "v(out)");
+	gdouble expected = exp(-G_PI * zeta / sqrt(1 - zeta * zeta));
+	g_assert_cmpfloat_with_epsilon(test_measure_evaluate(m, sdat), expected, 1e-4);
+
+	m = measurement_new("settling", MEASURE_SETTLING_TIME, "v(out)");
+	gdouble settling = test_measure_evaluate(m, sdat);
+	// the usual estimate is 4 / (zeta * omega)
+	g_assert_cmpfloat(settling, >, 5);
+	g_assert_cmpfloat(settling, <, 9);
+	for (gdouble t = settling + 0.01; t < 40; t += 0.01)
+		g_assert_cmpfloat(fabs(test_measure_second_order(t, zeta) - 1), <=, 0.02);
+
+	test_measure_sim_data_free(sdat);
+}
+
+static void test_measure_errors() {
+	SimulationData *sdat = test_measure_sim_data_new(test_measure_ramp, 0, 3, 31);
+	GError *e = NULL;
+	gdouble result;
+
+	Measurement *m = measurement_new("missing", MEASURE_MAX, "v(in)");
+	g_assert_false(measurement_evaluate(m, sdat, &result, &e));
+	g_assert_error(e, OREGANO_ERROR, OREGANO_MEASURE_ERROR_NO_SUCH_VARIABLE);
+	g_clear_error(&e);
+	measurement_free(m);
+
+	m = measurement_new("period", MEASURE_PERIOD, "v(out)");
+	g_assert_false(measurement_evaluate(m, sdat, &result, &e));
+	g_assert_error(e, OREGANO_ERROR, OREGANO_MEASURE_ERROR_NOT_FOUND);
+	g_clear_error(&e);
+	measurement_free(m);
+
+	m = measurement_new("window", MEASURE_AVG, "v(out)");
+	m->from = 4;
+	g_assert_false(measurement_evaluate(m, sdat, &result, &e));
+	g_assert_error(e, OREGANO_ERROR, OREGANO_MEASURE_ERROR_BAD_DATA);
+	g_clear_error(&e);
+	measurement_free(m);
+
+	g_assert_cmpint(measurement_type_from_string("RMS"), ==, MEASURE_RMS);
+	g_assert_cmpint(measurement_type_from_string("nonsense"), ==, MEASURE_N_TYPES);
+
+	test_measure_sim_data_free(sdat);
+}
+
+static void test_measure_table() {
+	const gdouble frequencies[] = {2, 5, 10, 20, 50, 100, 200, 500};
+	const guint n_runs = G_N_ELEMENTS(frequencies);
+	SimulationData *runs[G_N_ELEMENTS(frequencies)];
+	MeasureTable *table = measure_table_new();
+
+	measure_table_add_measurement(table, measurement_new("freq", MEASURE_FREQUENCY, "v(out)"));
+	measure_table_add_measurement(table, measurement_new("rms", MEASURE_RMS, "v(out)"));
+	measure_table_add_measurement(table, measurement_new("bad", MEASURE_MAX, "v(in)"));
+
+	for (guint i = 0; i < n_runs; i++) {
+		gchar *label = g_strdup_printf("f=%g", frequencies[i]);
+		runs[i] = test_measure_sim_data_new(test_measure_cosine_wave, frequencies[i], 1, 100001);
+		measure_table_add_run(table, label, runs[i]);
+		g_free(label);
+	}
+
+	g_assert_cmpuint(measure_table_get_n_runs(table), ==, n_runs);
+	g_assert_cmpuint(measure_table_get_n_measurements(table), ==, 3);
+	g_assert_true(isnan(measure_table_get(table, 0, 0)));
+
+	measure_table_evaluate(table);
+
+	for (guint i = 0; i < n_runs; i++) {
+		g_assert_cmpfloat_with_epsilon(measure_table_get(table, i, 0), frequencies[i], frequencies[i] * 1e-6);
+		g_assert_cmpfloat_with_epsilon(measure_table_get(table, i, 1), 1 / sqrt(2), 1e-4);
+		g_assert_true(isnan(measure_table_get(table, i, 2)));
+		g_assert_nonnull(measure_table_get_error(table, i, 2));
+		g_assert_null(measure_table_get_error(table, i, 0));
+	}
+
+	gchar *csv = measure_table_to_csv(table);
+	gchar **lines = g_strsplit(csv, "\n", -1);
+	g_assert_cmpstr(lines[0], ==, "run,freq,rms,bad");
+	g_assert_true(g_str_has_prefix(lines[1], "f=2,"));
+	g_assert_true(g_str_has_suffix(lines[1], ","));
+	g_assert_cmpuint(g_strv_length(lines), ==, n_runs + 2);
+	g_strfreev(lines);
+	g_free(csv);
+
+	measure_table_free(table);
+	for (guint i = 0; i < n_runs; i++)
+		test_measure_sim_data_free(runs[i]);
+}
+
+#endif /* TEST_MEASURE_H_ */
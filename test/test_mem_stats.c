@@ -0,0 +1,115 @@
+/*
+ * test_mem_stats.c
+ *
+ *
+ * Authors:
+ *  Michi <st101564@stud.uni-stuttgart.de>
+ *
+ * Web page: https://ahoi.io/project/oregano
+ *
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+
+#ifndef TEST_MEM_STATS_H_
+#define TEST_MEM_STATS_H_
+
+#include "../src/tools/mem-stats.h"
+#include "../src/tools/thread-pipe.h"
+#include "../src/model/schematic.h"
+#include "../src/load-library.h"
+#include "../src/oregano.h"
+
+static void test_mem_stats_thread_pipe();
+static void test_mem_stats_schematic();
+
+void add_funcs_test_mem_stats() {
+	g_test_add_func("/core/mem_stats/thread_pipe", test_mem_stats_thread_pipe);
+	g_test_add_func("/core/mem_stats/schematic", test_mem_stats_schematic);
+}
+
+static void test_mem_stats_thread_pipe() {
+	MemStatsCounter baseline, counter;
+	gchar block[] = "first line\nsecond line\n";
+	gchar *line;
+	gsize size;
+
+	mem_stats_get(MEM_STATS_THREAD_PIPE, &baseline);
+
+	ThreadPipe *pipe = thread_pipe_new(THREAD_PIPE_MAX_BUFFER_BLOCK_COUNTER_DEFAULT, THREAD_PIPE_MAX_BUFFER_SIZE_TOTAL_DEFAULT);
+	for (int i = 0; i < 3; i++)
+		thread_pipe_push(pipe, block, sizeof(block) - 1);
+	thread_pipe_set_write_eof(pipe);
+
+	// the blocks waiting in the pipe are counted
+	mem_stats_get(MEM_STATS_THREAD_PIPE, &counter);
+	g_assert_cmpint(counter.objects, >, baseline.objects);
+	g_assert_cmpint(counter.bytes, >=, baseline.bytes + 3 * (gint64)(sizeof(block) - 1));
+
+	// the pipe destroys itself after the last line
+	int lines = 0;
+	while ((pipe = thread_pipe_pop_line(pipe, &line, &size)) != NULL)
+		lines++;
+	g_assert_cmpint(lines, ==, 6);
+
+	mem_stats_get(MEM_STATS_THREAD_PIPE, &counter);
+	g_assert_cmpint(counter.objects, ==, baseline.objects);
+	g_assert_cmpint(counter.bytes, ==, baseline.bytes);
+}
+
+/**
+ * Loads and unloads the same schematic again and again, nothing of it
+ * may stay behind.
+ */
+static void test_mem_stats_schematic() {
+	GError *e = NULL;
+	MemStatsCounter baseline, counter;
+	g_autofree gchar *test_dir = get_test_base_dir();
+	g_autofree gchar *library_file = g_strdup_printf("%s/../data/libraries/default.oreglib", test_dir);
+	g_autofree gchar *schematic_file = g_strdup_printf("%s/../data/examples/simple.oregano", test_dir);
+	GList *libraries = oregano.libraries;
+
+	mem_stats_get(MEM_STATS_LIBRARY, &baseline);
+	Library *library = library_parse_xml_file(library_file);
+	g_assert_nonnull(library);
+	oregano.libraries = g_list_append(NULL, library);
+
+	// libraries stay loaded for the whole session
+	mem_stats_get(MEM_STATS_LIBRARY, &counter);
+	g_assert_cmpint(counter.objects, >, baseline.objects);
+	g_assert_cmpint(counter.bytes, >, baseline.bytes);
+
+	mem_stats_get(MEM_STATS_NODE_STORE, &baseline);
+	for (int i = 0; i < 5; i++) {
+		Schematic *schematic = schematic_read(schematic_file, &e);
+		g_assert_no_error(e);
+		g_assert_nonnull(schematic);
+
+		mem_stats_get(MEM_STATS_NODE_STORE, &counter);
+		g_assert_cmpint(counter.objects, >, baseline.objects);
+
+		g_object_unref(schematic);
+		mem_stats_get(MEM_STATS_NODE_STORE, &counter);
+		g_assert_cmpint(counter.objects, ==, baseline.objects);
+		g_assert_cmpint(counter.bytes, ==, baseline.bytes);
+	}
+
+	g_list_free(oregano.libraries);
+	oregano.libraries = libraries;
+}
+
+#endif
@@ -0,0 +1,119 @@
+/*
+ * test_netlist_helper.c
+ *
+ *
+ * Authors:
+ *  Michi <st101564@stud.uni-stuttgart.de>
+ *
+ * Web page: https://ahoi.io/project/oregano
+ *
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+
+#ifndef TEST_NETLIST_HELPER_H_
+#define TEST_NETLIST_HELPER_H_
+
+#include "../src/model/schematic.h"
+#include "../src/engines/netlist-helper.h"
+#include "../src/load-library.h"
+#include "../src/oregano.h"
+
+static void test_netlist_helper_parallel();
+
+void add_funcs_test_netlist_helper() {
+	g_test_add_func("/core/netlist_helper/parallel", test_netlist_helper_parallel);
+}
+
+/**
+ * The template of the netlist, or NULL together with @error.
+ */
+static gchar *test_netlist_helper_create(Schematic *schematic, GError **error) {
+	Netlist netlist = {0};
+
+	netlist_helper_create(schematic, &netlist, error);
+	g_list_free_full(netlist.models, g_free);
+	if (netlist.template == NULL)
+		return NULL;
+	return g_string_free(netlist.template, FALSE);
+}
+
+static void test_netlist_helper_parallel() {
+	g_autofree gchar *test_dir = get_test_base_dir();
+	g_autofree gchar *library_dir = g_build_filename(test_dir, "..", "data", "libraries", NULL);
+	g_autofree gchar *example_dir = g_build_filename(test_dir, "..", "data", "examples", NULL);
+	GList *libraries_before = oregano.libraries;
+	const gchar *name;
+	guint n_compared = 0;
+
+	oregano.libraries = NULL;
+	GDir *dir = g_dir_open(library_dir, 0, NULL);
+	g_assert_nonnull(dir);
+	while ((name = g_dir_read_name(dir)) != NULL) {
+		if (!g_str_has_suffix(name, ".oreglib"))
+			continue;
+		g_autofree gchar *file = g_build_filename(library_dir, name, NULL);
+		Library *library = library_parse_xml_file(file);
+		if (library != NULL)
+			oregano.libraries = g_list_append(oregano.libraries, library);
+	}
+	g_dir_close(dir);
+
+	dir = g_dir_open(example_dir, 0, NULL);
+	g_assert_nonnull(dir);
+	while ((name = g_dir_read_name(dir)) != NULL) {
+		GError *e = NULL, *e_parallel = NULL;
+
+		if (!g_str_has_suffix(name, ".oregano"))
+			continue;
+		g_autofree gchar *file = g_build_filename(example_dir, name, NULL);
+		Schematic *schematic = schematic_read(file, &e);
+		if (schematic == NULL) {
+			g_clear_error(&e);
+			continue;
+		}
+
+		netlist_helper_set_parallel(0, NETLIST_HELPER_PARALLEL_CHUNK_PARTS);
+		g_autofree gchar *serial = test_netlist_helper_create(schematic, &e);
+
+		// one part per chunk, as many chunks as possible
+		netlist_helper_set_parallel(1, 1);
+		g_autofree gchar *parallel = test_netlist_helper_create(schematic, &e_parallel);
+
+		// byte by byte the same, and failing the same way
+		g_assert_cmpstr(parallel, ==, serial);
+		if (e != NULL) {
+			g_assert_error(e_parallel, e->domain, e->code);
+			g_clear_error(&e);
+			g_clear_error(&e_parallel);
+		} else {
+			g_assert_no_error(e_parallel);
+			n_compared++;
+		}
+
+		g_object_unref(schematic);
+	}
+	g_dir_close(dir);
+
+	netlist_helper_set_parallel(NETLIST_HELPER_PARALLEL_MIN_PARTS, NETLIST_HELPER_PARALLEL_CHUNK_PARTS);
+	g_list_free(oregano.libraries);
+	oregano.libraries = libraries_before;
+
+	g_assert_cmpuint(n_compared, >, 0);
+}
+
+#endif
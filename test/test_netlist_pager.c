@@ -0,0 +1,170 @@
+/*
+ * test_netlist_pager.c
+ *
+ *
+ * Authors:
+ *  Michi <st101564@stud.uni-stuttgart.de>
+ *
+ * Web page: https://ahoi.io/project/oregano
+ *
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+
+
+#ifndef TEST_NETLIST_PAGER_H_
+#define TEST_NETLIST_PAGER_H_
+
+#include <string.h>
+#include <glib/gstdio.h>
+#include "../src/netlist-pager.h"
+
+static void test_netlist_pager_lines();
+static void test_netlist_pager_find();
+static void test_netlist_pager_empty();
+
+void add_funcs_test_netlist_pager() {
+	g_test_add_func("/core/netlist_pager/lines", test_netlist_pager_lines);
+	g_test_add_func("/core/netlist_pager/find", test_netlist_pager_find);
+	g_test_add_func("/core/netlist_pager/empty", test_netlist_pager_empty);
+}
+
+static NetlistPager *test_netlist_pager_new(const gchar *contents, gsize length) {
+	GError *e = NULL;
+	gchar *filename = NULL;
+	gint fd = g_file_open_tmp("oregano-test-netlist-pager-XXXXXX", &filename, &e);
+	g_assert_no_error(e);
+	close(fd);
+	g_file_set_contents(filename, contents, length, &e);
+	g_assert_no_error(e);
+
+	NetlistPager *pager = netlist_pager_new(filename, &e);
+	g_assert_no_error(e);
+	// the mapping stays valid
+	g_unlink(filename);
+	g_free(filename);
+	return pager;
+}
+
+static void test_netlist_pager_lines() {
+	GString *text = g_string_new(NULL);
+	GArray *starts = g_array_new(FALSE, FALSE, sizeof(gsize));
+	GRand *rand = g_rand_new_with_seed(42);
+
+	// empty lines, lines across the index stride, a last line without break
+	for (guint i = 0; i < 10 * NETLIST_PAGER_INDEX_STRIDE + 7; i++) {
+		g_array_append_val(starts, text->len);
+		for (gint n = g_rand_int_range(rand, 0, 20); n > 0; n--)
+			g_string_append_c(text, 'a' + g_rand_int_range(rand, 0, 26));
+		g_string_append_c(text, '\n');
+	}
+	g_array_append_val(starts, text->len);
+	g_string_append(text, ".end");
+	guint64 n_lines = starts->len;
+	g_array_append_val(starts, text->len);
+
+	NetlistPager *pager = test_netlist_pager_new(text->str, text->len);
+	g_assert_cmpuint(netlist_pager_get_size(pager), ==, text->len);
+	g_assert_cmpuint(netlist_pager_get_n_lines(pager), ==, n_lines);
+
+	for (guint64 line = 0; line <= n_lines; line++)
+		g_assert_cmpuint(netlist_pager_get_line_offset(pager, line), ==, g_array_index(starts, gsize, line));
+	g_assert_cmpuint(netlist_pager_get_line_offset(pager, n_lines + 5), ==, text->len);
+
+	for (guint64 line = 0; line < n_lines; line++) {
+		gsize start = g_array_index(starts, gsize, line);
+		gsize end = g_array_index(starts, gsize, line + 1);
+		for (gsize offset = start; offset < end; offset++)
+			g_assert_cmpuint(netlist_pager_get_line_at(pager, offset), ==, line);
+	}
+
+	for (guint i = 0; i < 1000; i++) {
+		guint64 first = g_rand_int_range(rand, 0, n_lines + 2);
+		guint64 n = g_rand_int_range(rand, 0, 3 * NETLIST_PAGER_INDEX_STRIDE);
+		guint64 last = MIN(first + n, n_lines);
+		gsize length;
+		const gchar *lines = netlist_pager_get_lines(pager, first, n, &length);
+
+		first = MIN(first, n_lines);
+		g_assert_cmpuint(length, ==, g_array_index(starts, gsize, last) - g_array_index(starts, gsize, first));
+		g_assert_true(memcmp(lines, text->str + g_array_index(starts, gsize, first), length) == 0);
+	}
+
+	netlist_pager_free(pager);
+	g_rand_free(rand);
+	g_array_free(starts, TRUE);
+	g_string_free(text, TRUE);
+}
+
+static void test_netlist_pager_find() {
+	const gchar *text = "* test\nV1 1 0 DC 5\nr1 1 2 1k\nR2 2 0 1K\n.END";
+	NetlistPager *pager = test_netlist_pager_new(text, strlen(text));
+	const struct {
+		const gchar *needle;
+		gsize offset;
+		gboolean found;
+		gsize match;
+	} cases[] = {
+		{"r1", 0, TRUE, 19},
+		{"R1", 0, TRUE, 19},
+		{"r", 20, TRUE, 29},
+		{"1k\n", 0, TRUE, 26},
+		{"1k", 27, TRUE, 36},
+		{"1k", 37, FALSE, 0},
+		{".end", 0, TRUE, 39},
+		{".end", 40, FALSE, 0},
+		{".ends", 0, FALSE, 0},
+		{"\n", 0, TRUE, 6},
+		{"v1 1 0 dc 5", 0, TRUE, 7},
+		{"", 0, FALSE, 0},
+	};
+
+	for (guint i = 0; i < G_N_ELEMENTS(cases); i++) {
+		gsize match = G_MAXSIZE;
+		gboolean found = netlist_pager_find(pager, cases[i].needle, cases[i].offset, &match);
+
+		g_assert_cmpint(found, ==, cases[i].found);
+		if (found)
+			g_assert_cmpuint(match, ==, cases[i].match);
+	}
+
+	// past the end
+	gsize match;
+	g_assert_false(netlist_pager_find(pager, "e", strlen(text) + 1, &match));
+
+	netlist_pager_free(pager);
+}
+
+static void test_netlist_pager_empty() {
+	NetlistPager *pager = test_netlist_pager_new("", 0);
+	gsize length = 1, match;
+
+	g_assert_cmpuint(netlist_pager_get_n_lines(pager), ==, 0);
+	g_assert_cmpuint(netlist_pager_get_line_offset(pager, 0), ==, 0);
+	g_assert_cmpuint(netlist_pager_get_line_at(pager, 0), ==, 0);
+	netlist_pager_get_lines(pager, 0, 10, &length);
+	g_assert_cmpuint(length, ==, 0);
+	g_assert_false(netlist_pager_find(pager, "x", 0, &match));
+
+	GBytes *bytes = netlist_pager_get_bytes(pager);
+	g_assert_cmpuint(g_bytes_get_size(bytes), ==, 0);
+	g_bytes_unref(bytes);
+
+	netlist_pager_free(pager);
+}
+
+#endif
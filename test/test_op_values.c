@@ -0,0 +1,81 @@
+/*
+ * test_op_values.c
+ *
+ *
+ * Authors:
+ *  Michi <st101564@stud.uni-stuttgart.de>
+ *
+ * Web page: https://ahoi.io/project/oregano
+ *
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef TEST_OP_VALUES_H_
+#define TEST_OP_VALUES_H_
+
+#include "../src/engines/op-values.h"
+
+static void test_op_values_parse();
+
+void add_funcs_test_op_values() {
+	g_test_add_func("/core/op_values/parse", test_op_values_parse);
+}
+
+static void test_op_values_parse() {
+	// what ngspice -b prints for "op" followed by "print all"
+	const gchar *output =
+			"\n"
+			"Note: No compatibility mode selected!\n"
+			"\n"
+			"\n"
+			"Circuit: * divider\n"
+			"\n"
+			"Doing analysis at TEMP = 27.000000 and TNOM = 27.000000\n"
+			"\n"
+			"v(1) = 5.000000e+00\n"
+			"v(out) = 2.500000e+00\n"
+			"2 = 1.250000e+00\n"
+			"v_v1#branch = -2.50000e-03\n"
+			"@r1[i] = 2.500000e-03\n"
+			"broken = 1.0V\n";
+	gdouble value;
+
+	OpValues *values = op_values_parse(output);
+
+	g_assert_true(op_values_get_voltage(values, "1", &value));
+	g_assert_cmpfloat(value, ==, 5.0);
+	// marker names are upper case in the schematic
+	g_assert_true(op_values_get_voltage(values, "OUT", &value));
+	g_assert_cmpfloat(value, ==, 2.5);
+	g_assert_true(op_values_get_voltage(values, "2", &value));
+	g_assert_cmpfloat(value, ==, 1.25);
+	g_assert_true(op_values_get_voltage(values, "0", &value));
+	g_assert_cmpfloat(value, ==, 0.0);
+
+	g_assert_true(op_values_get_current(values, "V_V1", &value));
+	g_assert_cmpfloat(value, ==, -2.5e-3);
+
+	g_assert_false(op_values_get_voltage(values, "3", &value));
+	g_assert_false(op_values_get_voltage(values, "broken", &value));
+	g_assert_false(op_values_get_current(values, "@r1[i]", &value));
+	g_assert_cmpuint(g_hash_table_size(values->voltages), ==, 3);
+	g_assert_cmpuint(g_hash_table_size(values->currents), ==, 1);
+
+	op_values_free(values);
+}
+
+#endif
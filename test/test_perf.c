@@ -0,0 +1,171 @@
+/*
+ * test_perf.c
+ *
+ *
+ * Authors:
+ *  Michi <st101564@stud.uni-stuttgart.de>
+ *
+ * Web page: https://ahoi.io/project/oregano
+ *
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+
+#ifndef TEST_PERF_H_
+#define TEST_PERF_H_
+
+#include "../src/tools/thread-pipe.h"
+#include "../src/model/schematic.h"
+#include "../src/model/node-store.h"
+#include "../src/model/part.h"
+#include "../src/engines/netlist-helper.h"
+#include "../src/load-library.h"
+#include "../src/oregano.h"
+
+static void test_perf_node_store_add_wire();
+static void test_perf_thread_pipe_push_pop();
+static void test_perf_part_get_property_ref();
+static void test_perf_netlist_helper_create();
+
+void add_funcs_test_perf() {
+	g_test_add_func("/perf/node_store/add_wire", test_perf_node_store_add_wire);
+	g_test_add_func("/perf/thread_pipe/push_pop", test_perf_thread_pipe_push_pop);
+	g_test_add_func("/perf/part/get_property_ref", test_perf_part_get_property_ref);
+	g_test_add_func("/perf/netlist_helper/create", test_perf_netlist_helper_create);
+}
+
+static gboolean test_perf_enabled() {
+	if (g_test_perf())
+		return TRUE;
+	g_test_skip("only with -m perf");
+	return FALSE;
+}
+
+typedef struct {
+	NodeStore *store;
+	Wire *wire;
+} TestPerfNodeStore;
+
+// adding and removing again, so every call finds the same store
+static void test_perf_node_store_add_wire_func(TestPerfNodeStore *perf) {
+	node_store_add_wire(perf->store, perf->wire);
+	node_store_remove_wire(perf->store, perf->wire);
+}
+
+static void test_perf_node_store_add_wire() {
+	if (!test_perf_enabled())
+		return;
+
+	TestPerfNodeStore perf;
+	PerfResult result;
+	perf.store = node_store_new();
+
+	// a grid of 20 by 20 wires, the new one crosses 20 of them
+	for (int i = 0; i < 20; i++) {
+		for (int horizontal = 0; horizontal < 2; horizontal++) {
+			Wire *wire = wire_new();
+			Coords pos = {horizontal ? 0 : i * 10., horizontal ? i * 10. : 0};
+			Coords length = {horizontal ? 200. : 0, horizontal ? 0 : 200.};
+			item_data_set_pos(ITEM_DATA(wire), &pos);
+			wire_set_length(wire, &length);
+			node_store_add_wire(perf.store, wire);
+		}
+	}
+
+	perf.wire = wire_new();
+	Coords pos = {5., 0};
+	Coords length = {0, 200.};
+	item_data_set_pos(ITEM_DATA(perf.wire), &pos);
+	wire_set_length(perf.wire, &length);
+
+	perf_measure("node_store_add_wire", (PerfFunc)test_perf_node_store_add_wire_func, &perf, &result);
+
+	g_object_unref(perf.wire);
+	g_object_unref(perf.store);
+}
+
+// one block of the watcher: 20 lines in, 20 lines out
+static void test_perf_thread_pipe_push_pop_func(ThreadPipe *pipe) {
+	static gchar line[] = "42\t4.200000e-09\t1.234567e+00\t-1.23456e+00\t0.000000e+00\t\n";
+	gpointer data;
+	gsize size;
+
+	for (int i = 0; i < 20; i++)
+		thread_pipe_push(pipe, line, sizeof(line));
+	for (int i = 0; i < 20; i++)
+		thread_pipe_pop(pipe, &data, &size);
+}
+
+static void test_perf_thread_pipe_push_pop() {
+	if (!test_perf_enabled())
+		return;
+
+	PerfResult result;
+	ThreadPipe *pipe = thread_pipe_new(THREAD_PIPE_MAX_BUFFER_BLOCK_COUNTER_DEFAULT, THREAD_PIPE_MAX_BUFFER_SIZE_TOTAL_DEFAULT);
+
+	perf_measure("thread_pipe_push_pop", (PerfFunc)test_perf_thread_pipe_push_pop_func, pipe, &result);
+
+	thread_pipe_set_write_eof(pipe);
+	thread_pipe_set_read_eof(pipe);
+}
+
+static void test_perf_part_get_property_ref_func(Part *part) {
+	// not there, so every property is looked at
+	g_assert_null(part_get_property_ref(part, "NoSuchProperty"));
+}
+
+static void test_perf_part_get_property_ref() {
+	if (!test_perf_enabled())
+		return;
+
+	GList *libraries;
+	PerfResult result;
+	Schematic *schematic = load_test_schematic(&libraries);
+	NodeStore *store = schematic_get_store(schematic);
+	g_assert_nonnull(store->parts);
+
+	perf_measure("part_get_property_ref", (PerfFunc)test_perf_part_get_property_ref_func, store->parts->data, &result);
+
+	unload_test_schematic(schematic, libraries);
+}
+
+static void test_perf_netlist_helper_create_func(Schematic *schematic) {
+	GError *e = NULL;
+	Netlist netlist = {0};
+
+	netlist_helper_create(schematic, &netlist, &e);
+	g_assert_no_error(e);
+
+	if (netlist.template != NULL)
+		g_string_free(netlist.template, TRUE);
+	g_list_free_full(netlist.models, g_free);
+}
+
+static void test_perf_netlist_helper_create() {
+	if (!test_perf_enabled())
+		return;
+
+	GList *libraries;
+	PerfResult result;
+	Schematic *schematic = load_test_schematic(&libraries);
+
+	perf_measure("netlist_helper_create", (PerfFunc)test_perf_netlist_helper_create_func, schematic, &result);
+
+	unload_test_schematic(schematic, libraries);
+}
+
+#endif
@@ -0,0 +1,109 @@
+/*
+ * test_print_layout.c
+ *
+ *
+ * Authors:
+ *  Michi <st101564@stud.uni-stuttgart.de>
+ *
+ * Web page: https://ahoi.io/project/oregano
+ *
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+
+#ifndef TEST_PRINT_LAYOUT_H_
+#define TEST_PRINT_LAYOUT_H_
+
+#include "../src/model/print-layout.h"
+
+static void test_print_layout_fit();
+static void test_print_layout_tile();
+static void test_print_layout_empty();
+
+void add_funcs_test_print_layout() {
+	g_test_add_func("/core/print_layout/fit", test_print_layout_fit);
+	g_test_add_func("/core/print_layout/tile", test_print_layout_tile);
+	g_test_add_func("/core/print_layout/empty", test_print_layout_empty);
+}
+
+static void test_print_layout_fit() {
+	PrintLayout layout;
+	NodeRect bounds = {-100, 0, 300, 100};
+	NodeRect tile;
+
+	// the width limits the scale
+	print_layout_fit(&layout, &bounds, 200, 200);
+	g_assert_cmpint(print_layout_get_n_pages(&layout), ==, 1);
+	g_assert_cmpfloat(layout.scale, ==, 0.5);
+
+	print_layout_get_tile(&layout, 0, NULL, NULL, &tile);
+	g_assert_cmpfloat(tile.x0, ==, -100);
+	g_assert_cmpfloat(tile.y0, ==, 0);
+	g_assert_cmpfloat(tile.x1, ==, 300);
+	g_assert_cmpfloat(tile.y1, ==, 400);
+}
+
+static void test_print_layout_tile() {
+	PrintLayout layout;
+	// 1000 by 300 model units, a page holds 250 by 250 of them
+	NodeRect bounds = {0, 0, 1000, 300};
+	NodeRect tile, left;
+	gint column, row;
+
+	print_layout_tile(&layout, &bounds, 100, 100, 0.4, 10);
+	g_assert_cmpfloat(layout.tile_w, ==, 250);
+	g_assert_cmpfloat(layout.step_x, ==, 225);
+
+	// 250 + 3 * 225 < 1000 <= 250 + 4 * 225
+	g_assert_cmpint(layout.columns, ==, 5);
+	g_assert_cmpint(layout.rows, ==, 2);
+	g_assert_cmpint(print_layout_get_n_pages(&layout), ==, 10);
+
+	// row by row
+	print_layout_get_tile(&layout, 6, &column, &row, &tile);
+	g_assert_cmpint(column, ==, 1);
+	g_assert_cmpint(row, ==, 1);
+	g_assert_cmpfloat(tile.x0, ==, 225);
+	g_assert_cmpfloat(tile.y0, ==, 225);
+
+	// the last tiles reach the bounds, neighbours share the overlap
+	print_layout_get_tile(&layout, 9, NULL, NULL, &tile);
+	g_assert_cmpfloat(tile.x1, >=, bounds.x1);
+	g_assert_cmpfloat(tile.y1, >=, bounds.y1);
+	print_layout_get_tile(&layout, 8, NULL, NULL, &left);
+	g_assert_cmpfloat(left.x1 - tile.x0, ==, 10 / 0.4);
+
+	// exactly one page
+	bounds = (NodeRect){0, 0, 250, 250};
+	print_layout_tile(&layout, &bounds, 100, 100, 0.4, 10);
+	g_assert_cmpint(print_layout_get_n_pages(&layout), ==, 1);
+}
+
+static void test_print_layout_empty() {
+	PrintLayout layout;
+	// like node_store_get_bounds of an empty store
+	NodeRect bounds = {G_MAXDOUBLE, G_MAXDOUBLE, -G_MAXDOUBLE, -G_MAXDOUBLE};
+
+	print_layout_fit(&layout, &bounds, 200, 100);
+	g_assert_cmpint(print_layout_get_n_pages(&layout), ==, 1);
+	g_assert_cmpfloat(layout.scale, ==, PRINT_LAYOUT_DEFAULT_SCALE);
+
+	print_layout_tile(&layout, &bounds, 200, 100, 1.0, 10);
+	g_assert_cmpint(print_layout_get_n_pages(&layout), ==, 1);
+}
+
+#endif
@@ -0,0 +1,151 @@
+/*
+ * test_resim_scheduler.c
+ *
+ *
+ * Authors:
+ *  Michi <st101564@stud.uni-stuttgart.de>
+ *
+ * Web page: https://ahoi.io/project/oregano
+ *
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef TEST_RESIM_SCHEDULER_H_
+#define TEST_RESIM_SCHEDULER_H_
+
+#include "../src/resim-scheduler.h"
+
+#define TEST_RESIM_SCHEDULER_DELAY 20
+
+static void test_resim_scheduler_coalesce();
+static void test_resim_scheduler_latest_wins();
+static void test_resim_scheduler_free();
+
+void add_funcs_test_resim_scheduler() {
+	g_test_add_func("/core/resim_scheduler/coalesce", test_resim_scheduler_coalesce);
+	g_test_add_func("/core/resim_scheduler/latest_wins", test_resim_scheduler_latest_wins);
+	g_test_add_func("/core/resim_scheduler/free", test_resim_scheduler_free);
+}
+
+/**
+ * A run that does nothing until the test ends it.
+ */
+typedef struct {
+	guint runs;
+	GCancellable *cancellable;
+} TestResimSchedulerRuns;
+
+static void test_resim_scheduler_run(GCancellable *cancellable, TestResimSchedulerRuns *runs) {
+	runs->runs++;
+	g_clear_object(&runs->cancellable);
+	runs->cancellable = g_object_ref(cancellable);
+}
+
+// iterates the main loop for @ms, or until there were @runs runs if @runs > 0
+static void test_resim_scheduler_wait(TestResimSchedulerRuns *runs, guint n_runs, guint ms) {
+	gint64 end = g_get_monotonic_time() + ms * G_TIME_SPAN_MILLISECOND;
+
+	while (g_get_monotonic_time() < end && (n_runs == 0 || runs->runs < n_runs))
+		g_main_context_iteration(NULL, FALSE);
+}
+
+static void test_resim_scheduler_coalesce() {
+	TestResimSchedulerRuns runs = {0};
+	ResimSchedulerStats stats;
+	ResimScheduler *scheduler = resim_scheduler_new(TEST_RESIM_SCHEDULER_DELAY, (ResimSchedulerRunFunc)test_resim_scheduler_run, &runs);
+
+	// a burst of edits is one run
+	for (int i = 0; i < 10; i++)
+		resim_scheduler_touch(scheduler);
+	g_assert_cmpuint(runs.runs, ==, 0);
+
+	test_resim_scheduler_wait(&runs, 1, 5000);
+	g_assert_cmpuint(runs.runs, ==, 1);
+	g_assert_true(resim_scheduler_is_running(scheduler));
+	resim_scheduler_run_done(scheduler, FALSE);
+	g_assert_false(resim_scheduler_is_running(scheduler));
+
+	// and nothing follows
+	test_resim_scheduler_wait(&runs, 0, 3 * TEST_RESIM_SCHEDULER_DELAY);
+	g_assert_cmpuint(runs.runs, ==, 1);
+
+	resim_scheduler_get_stats(scheduler, &stats);
+	g_assert_cmpuint(stats.requested, ==, 10);
+	g_assert_cmpuint(stats.coalesced, ==, 9);
+	g_assert_cmpuint(stats.started, ==, 1);
+	g_assert_cmpuint(stats.completed, ==, 1);
+	g_assert_cmpuint(stats.canceled, ==, 0);
+
+	g_clear_object(&runs.cancellable);
+	resim_scheduler_free(scheduler);
+}
+
+static void test_resim_scheduler_latest_wins() {
+	TestResimSchedulerRuns runs = {0};
+	ResimSchedulerStats stats;
+	ResimScheduler *scheduler = resim_scheduler_new(TEST_RESIM_SCHEDULER_DELAY, (ResimSchedulerRunFunc)test_resim_scheduler_run, &runs);
+
+	resim_scheduler_touch(scheduler);
+	test_resim_scheduler_wait(&runs, 1, 5000);
+	g_assert_cmpuint(runs.runs, ==, 1);
+	GCancellable *stale = g_object_ref(runs.cancellable);
+
+	// an edit makes the run in flight stale at once
+	resim_scheduler_touch(scheduler);
+	g_assert_true(g_cancellable_is_cancelled(stale));
+
+	// the next run waits for the stale one, edits meanwhile only replace it
+	test_resim_scheduler_wait(&runs, 0, 3 * TEST_RESIM_SCHEDULER_DELAY);
+	resim_scheduler_touch(scheduler);
+	test_resim_scheduler_wait(&runs, 0, 3 * TEST_RESIM_SCHEDULER_DELAY);
+	g_assert_cmpuint(runs.runs, ==, 1);
+
+	resim_scheduler_run_done(scheduler, TRUE);
+	g_assert_cmpuint(runs.runs, ==, 2);
+	g_assert_false(g_cancellable_is_cancelled(runs.cancellable));
+	resim_scheduler_run_done(scheduler, FALSE);
+
+	resim_scheduler_get_stats(scheduler, &stats);
+	g_assert_cmpuint(stats.requested, ==, 3);
+	g_assert_cmpuint(stats.coalesced, ==, 1);
+	g_assert_cmpuint(stats.started, ==, 2);
+	g_assert_cmpuint(stats.completed, ==, 1);
+	g_assert_cmpuint(stats.canceled, ==, 1);
+
+	g_object_unref(stale);
+	g_clear_object(&runs.cancellable);
+	resim_scheduler_free(scheduler);
+}
+
+static void test_resim_scheduler_free() {
+	TestResimSchedulerRuns runs = {0};
+	ResimScheduler *scheduler = resim_scheduler_new(TEST_RESIM_SCHEDULER_DELAY, (ResimSchedulerRunFunc)test_resim_scheduler_run, &runs);
+
+	resim_scheduler_touch(scheduler);
+	test_resim_scheduler_wait(&runs, 1, 5000);
+
+	// the run in flight is canceled, the waiting one never starts
+	resim_scheduler_touch(scheduler);
+	resim_scheduler_free(scheduler);
+	g_assert_true(g_cancellable_is_cancelled(runs.cancellable));
+	test_resim_scheduler_wait(&runs, 0, 3 * TEST_RESIM_SCHEDULER_DELAY);
+	g_assert_cmpuint(runs.runs, ==, 1);
+
+	g_clear_object(&runs.cancellable);
+}
+
+#endif
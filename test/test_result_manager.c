@@ -0,0 +1,245 @@
+/*
+ * test_result_manager.c
+ *
+ *
+ * Authors:
+ *  Michi <st101564@stud.uni-stuttgart.de>
+ *
+ * Web page: https://ahoi.io/project/oregano
+ *
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef TEST_RESULT_MANAGER_H_
+#define TEST_RESULT_MANAGER_H_
+
+#include <math.h>
+#include <string.h>
+#include <glib/gstdio.h>
+#include "../src/result-manager.h"
+#include "../src/sim-data-file.h"
+#include "../src/errors.h"
+
+static void test_result_manager_file_round_trip();
+static void test_result_manager_file_bad_format();
+static void test_result_manager_spill();
+static void test_result_manager_drop();
+
+void add_funcs_test_result_manager() {
+	g_test_add_func("/core/result_manager/file_round_trip", test_result_manager_file_round_trip);
+	g_test_add_func("/core/result_manager/file_bad_format", test_result_manager_file_bad_format);
+	g_test_add_func("/core/result_manager/spill", test_result_manager_spill);
+	g_test_add_func("/core/result_manager/drop", test_result_manager_drop);
+}
+
+/**
+ * Creates a list with one transient analysis holding the columns "time"
+ * and "v(out)" with @n points each.
+ */
+static GList *test_result_manager_analyses_new(guint n, gdouble offset) {
+	SimulationData *sdat = SIM_DATA(g_new0(Analysis, 1));
+	SimulationFunction *func = g_new0(SimulationFunction, 1);
+
+	sdat->type = ANALYSIS_TYPE_TRANSIENT;
+	sdat->n_variables = 2;
+	sdat->var_names = g_new0(gchar *, 3);
+	sdat->var_names[0] = g_strdup("time");
+	sdat->var_names[1] = g_strdup("v(out)");
+	sdat->var_units = g_new0(gchar *, 3);
+	sdat->var_units[0] = g_strdup("time");
+	sdat->var_units[1] = g_strdup("voltage");
+	sdat->data = g_new0(GArray *, 2);
+	for (int i = 0; i < 2; i++)
+		sdat->data[i] = g_array_sized_new(FALSE, FALSE, sizeof(gdouble), n);
+	for (guint i = 0; i < n; i++) {
+		gdouble t = 1e-6 * i;
+		gdouble y = offset + sin(2 * G_PI * 1e3 * t);
+		g_array_append_val(sdat->data[0], t);
+		g_array_append_val(sdat->data[1], y);
+	}
+	sdat->got_points = n;
+	sdat->got_var = 2;
+	((Analysis *)sdat)->transient.sim_length = 1e-6 * n;
+	((Analysis *)sdat)->transient.step_size = 1e-6;
+
+	func->type = FUNCTION_SUBTRACT;
+	func->first = 1;
+	func->second = 0;
+	sdat->functions = g_list_append(NULL, func);
+
+	return g_list_append(NULL, sdat);
+}
+
+static void test_result_manager_assert_equal(GList *expected, GList *actual) {
+	g_assert_cmpuint(g_list_length(expected), ==, g_list_length(actual));
+
+	for (; expected && actual; expected = expected->next, actual = actual->next) {
+		SimulationData *a = SIM_DATA(expected->data);
+		SimulationData *b = SIM_DATA(actual->data);
+
+		g_assert_cmpint(a->type, ==, b->type);
+		g_assert_cmpint(a->n_variables, ==, b->n_variables);
+		g_assert_cmpfloat(((Analysis *)a)->transient.step_size, ==, ((Analysis *)b)->transient.step_size);
+		g_assert_cmpuint(g_list_length(a->functions), ==, g_list_length(b->functions));
+		for (int i = 0; i < a->n_variables; i++) {
+			g_assert_cmpstr(a->var_names[i], ==, b->var_names[i]);
+			g_assert_cmpstr(a->var_units[i], ==, b->var_units[i]);
+			g_assert_cmpuint(a->data[i]->len, ==, b->data[i]->len);
+			g_assert(memcmp(a->data[i]->data, b->data[i]->data, a->data[i]->len * sizeof(gdouble)) == 0);
+		}
+	}
+}
+
+static void test_result_manager_file_round_trip() {
+	GError *e = NULL;
+	GList *analyses = test_result_manager_analyses_new(1000, 0.0);
+
+	GString *buffer = sim_data_file_serialize(analyses);
+	GList *copy = sim_data_file_deserialize(buffer->str, buffer->len, &e);
+	g_assert_no_error(e);
+	test_result_manager_assert_equal(analyses, copy);
+	sim_data_file_free_analyses(copy);
+	g_string_free(buffer, TRUE);
+
+	gchar *directory = g_dir_make_tmp("oregano-test-XXXXXX", &e);
+	g_assert_no_error(e);
+	gchar *filename = g_build_filename(directory, "results.ogres", NULL);
+
+	g_assert_true(sim_data_file_save(analyses, filename, &e));
+	g_assert_no_error(e);
+	copy = sim_data_file_load(filename, &e);
+	g_assert_no_error(e);
+	test_result_manager_assert_equal(analyses, copy);
+	sim_data_file_free_analyses(copy);
+
+	g_unlink(filename);
+	g_rmdir(directory);
+	g_free(filename);
+	g_free(directory);
+	sim_data_file_free_analyses(analyses);
+}
+
+static void test_result_manager_file_bad_format() {
+	GError *e = NULL;
+	GList *analyses = test_result_manager_analyses_new(100, 0.0);
+	GString *buffer = sim_data_file_serialize(analyses);
+
+	// truncated in the middle of the columns
+	g_assert_null(sim_data_file_deserialize(buffer->str, buffer->len - 4, &e));
+	g_assert_error(e, OREGANO_ERROR, OREGANO_RESULT_FILE_BAD_FORMAT);
+	g_clear_error(&e);
+
+	// not a result file at all
+	buffer->str[0] = 'X';
+	g_assert_null(sim_data_file_deserialize(buffer->str, buffer->len, &e));
+	g_assert_error(e, OREGANO_ERROR, OREGANO_RESULT_FILE_BAD_FORMAT);
+	g_clear_error(&e);
+
+	g_string_free(buffer, TRUE);
+	sim_data_file_free_analyses(analyses);
+}
+
+static void test_result_manager_spill() {
+	GError *e = NULL;
+	GObject *owners[3];
+	GList *analyses[3], *expected[3];
+
+	gchar *directory = g_dir_make_tmp("oregano-test-XXXXXX", &e);
+	g_assert_no_error(e);
+	result_manager_set_spill_directory(directory);
+
+	for (int i = 0; i < 3; i++) {
+		owners[i] = g_object_new(G_TYPE_OBJECT, NULL);
+		analyses[i] = test_result_manager_analyses_new(10000, i);
+		expected[i] = test_result_manager_analyses_new(10000, i);
+	}
+	// room for two of the three runs
+	gsize size = sim_data_get_size(SIM_DATA(analyses[0]->data));
+	result_manager_set_budget(2 * size + size / 2);
+
+	for (int i = 0; i < 3; i++)
+		result_manager_add(owners[i], analyses[i], "run");
+
+	// the oldest run went to disk, the columns are empty now
+	g_assert_cmpint(result_manager_get_state(owners[0]), ==, RESULT_SPILLED);
+	g_assert_cmpint(result_manager_get_state(owners[1]), ==, RESULT_RESIDENT);
+	g_assert_cmpint(result_manager_get_state(owners[2]), ==, RESULT_RESIDENT);
+	g_assert_cmpuint(SIM_DATA(analyses[0]->data)->data[1]->len, ==, 0);
+	g_assert_cmpuint(result_manager_get_resident_bytes(), ==, 2 * size);
+
+	// looking at it again brings it back and evicts the least recently used one
+	g_assert_true(result_manager_ensure_loaded(owners[0], &e));
+	g_assert_no_error(e);
+	test_result_manager_assert_equal(expected[0], analyses[0]);
+	g_assert_cmpint(result_manager_get_state(owners[1]), ==, RESULT_SPILLED);
+
+	GList *runs = result_manager_get_runs();
+	g_assert(runs->data == owners[0]);
+	g_assert(runs->next->data == owners[2]);
+	g_list_free(runs);
+
+	// runs disappear with their owner
+	for (int i = 0; i < 3; i++) {
+		g_object_unref(owners[i]);
+		sim_data_file_free_analyses(analyses[i]);
+		sim_data_file_free_analyses(expected[i]);
+	}
+	g_assert_null(result_manager_get_runs());
+	g_assert_cmpuint(result_manager_get_resident_bytes(), ==, 0);
+
+	result_manager_shutdown();
+	g_assert_cmpint(g_rmdir(directory), ==, 0);
+	g_free(directory);
+	result_manager_set_spill_directory(NULL);
+	result_manager_set_budget(0);
+}
+
+static void test_result_manager_drop() {
+	GError *e = NULL;
+	GObject *old = g_object_new(G_TYPE_OBJECT, NULL);
+	GObject *new = g_object_new(G_TYPE_OBJECT, NULL);
+	GList *old_analyses = test_result_manager_analyses_new(1000, 0.0);
+	GList *new_analyses = test_result_manager_analyses_new(1000, 1.0);
+
+	result_manager_set_spill_directory(NULL);
+	result_manager_set_budget(1);
+
+	// the most recently used run stays, even if it exceeds the budget
+	result_manager_add(old, old_analyses, "old");
+	g_assert_cmpint(result_manager_get_state(old), ==, RESULT_RESIDENT);
+
+	// held runs stay until they are released
+	result_manager_hold(old);
+	result_manager_add(new, new_analyses, "new");
+	g_assert_cmpint(result_manager_get_state(old), ==, RESULT_RESIDENT);
+	result_manager_release(old);
+	g_assert_cmpint(result_manager_get_state(old), ==, RESULT_DROPPED);
+	g_assert_cmpint(result_manager_get_state(new), ==, RESULT_RESIDENT);
+
+	g_assert_false(result_manager_ensure_loaded(old, &e));
+	g_assert_error(e, OREGANO_ERROR, OREGANO_RESULT_ERROR_DROPPED);
+	g_clear_error(&e);
+
+	result_manager_shutdown();
+	g_object_unref(old);
+	g_object_unref(new);
+	sim_data_file_free_analyses(old_analyses);
+	sim_data_file_free_analyses(new_analyses);
+	result_manager_set_budget(0);
+}
+
+#endif
@@ -0,0 +1,194 @@
+/*
+ * test_save_journal.c
+ *
+ *
+ * Authors:
+ *  Michi <st101564@stud.uni-stuttgart.de>
+ *
+ * Web page: https://ahoi.io/project/oregano
+ *
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+
+#ifndef TEST_SAVE_JOURNAL_H_
+#define TEST_SAVE_JOURNAL_H_
+
+#include <glib/gstdio.h>
+
+#include "../src/save-journal.h"
+#include "../src/save-schematic.h"
+#include "../src/model/textbox.h"
+
+static void test_save_journal_replay();
+static void test_save_journal_full_save();
+static void test_save_journal_compact();
+
+void add_funcs_test_save_journal() {
+	g_test_add_func("/core/save_journal/replay", test_save_journal_replay);
+	g_test_add_func("/core/save_journal/full_save", test_save_journal_full_save);
+	g_test_add_func("/core/save_journal/compact", test_save_journal_compact);
+}
+
+static void test_save_journal_assert_reloaded(const gchar *filename, const gchar *expected) {
+	GError *e = NULL;
+	Schematic *reloaded = schematic_read(filename, &e);
+	g_assert_no_error(e);
+
+	g_autofree gchar *actual = get_schematic_item_keys(reloaded);
+	g_assert_cmpstr(actual, ==, expected);
+	g_object_unref(reloaded);
+}
+
+// a part is moved, a wire removed and a text box added
+static void test_save_journal_edit(Schematic *schematic) {
+	Coords delta = {10, 0}, pos = {30, 40};
+	Textbox *textbox = textbox_new(NULL);
+	ItemData *part = NULL, *wire = NULL;
+
+	for (GList *iter = schematic_get_items(schematic); iter; iter = iter->next) {
+		if (part == NULL && IS_PART(iter->data))
+			part = iter->data;
+		if (wire == NULL && IS_WIRE(iter->data))
+			wire = iter->data;
+	}
+	g_assert_nonnull(part);
+	g_assert_nonnull(wire);
+
+	item_data_move(part, &delta);
+	schematic_remove_item(schematic, wire);
+
+	textbox_set_text(textbox, "journaled");
+	item_data_set_pos(ITEM_DATA(textbox), &pos);
+	schematic_add_item(schematic, ITEM_DATA(textbox));
+}
+
+static void test_save_journal_replay() {
+	GError *e = NULL;
+	GList *libraries_before;
+	Schematic *schematic = load_test_schematic(&libraries_before);
+	g_autofree gchar *dir = g_dir_make_tmp("oregano-test-save-journal-XXXXXX", NULL);
+	g_autofree gchar *filename = g_build_filename(dir, "simple.oregano", NULL);
+	g_autofree gchar *journal_filename = save_journal_get_filename(filename);
+
+	oregano.incremental_save = TRUE;
+
+	// the first save writes the whole file
+	schematic_set_filename(schematic, filename);
+	g_assert_true(schematic_save_file(schematic, &e));
+	g_assert_no_error(e);
+	g_assert_false(g_file_test(journal_filename, G_FILE_TEST_EXISTS));
+
+	test_save_journal_edit(schematic);
+	g_assert_true(schematic_save_file(schematic, &e));
+	g_assert_no_error(e);
+	g_assert_true(g_file_test(journal_filename, G_FILE_TEST_EXISTS));
+
+	g_autofree gchar *expected = get_schematic_item_keys(schematic);
+	test_save_journal_assert_reloaded(filename, expected);
+
+	// the start of a batch that was never committed
+	FILE *journal = g_fopen(journal_filename, "ab");
+	fwrite("\x02\x00\x00\x00\xff\x00", 1, 6, journal);
+	fclose(journal);
+	test_save_journal_assert_reloaded(filename, expected);
+
+	oregano.incremental_save = FALSE;
+	unload_test_schematic(schematic, libraries_before);
+	g_unlink(journal_filename);
+	g_unlink(filename);
+	g_rmdir(dir);
+}
+
+static void test_save_journal_full_save() {
+	GError *e = NULL;
+	GList *libraries_before;
+	Schematic *schematic = load_test_schematic(&libraries_before);
+	g_autofree gchar *dir = g_dir_make_tmp("oregano-test-save-journal-XXXXXX", NULL);
+	g_autofree gchar *filename = g_build_filename(dir, "simple.oregano", NULL);
+	g_autofree gchar *journal_filename = save_journal_get_filename(filename);
+
+	oregano.incremental_save = TRUE;
+	schematic_set_filename(schematic, filename);
+	g_assert_true(schematic_save_file(schematic, &e));
+	test_save_journal_edit(schematic);
+	g_assert_true(schematic_save_file(schematic, &e));
+	g_assert_true(g_file_test(journal_filename, G_FILE_TEST_EXISTS));
+
+	// switched off, the next save takes the journal into the file
+	oregano.incremental_save = FALSE;
+	g_assert_true(schematic_save_file(schematic, &e));
+	g_assert_no_error(e);
+	g_assert_false(g_file_test(journal_filename, G_FILE_TEST_EXISTS));
+
+	g_autofree gchar *expected = get_schematic_item_keys(schematic);
+	test_save_journal_assert_reloaded(filename, expected);
+
+	unload_test_schematic(schematic, libraries_before);
+	g_unlink(filename);
+	g_rmdir(dir);
+}
+
+static void test_save_journal_compact() {
+	GError *e = NULL;
+	GList *libraries_before;
+	Schematic *schematic = load_test_schematic(&libraries_before);
+	g_autofree gchar *dir = g_dir_make_tmp("oregano-test-save-journal-XXXXXX", NULL);
+	g_autofree gchar *filename = g_build_filename(dir, "simple.oregano", NULL);
+	g_autofree gchar *journal_filename = save_journal_get_filename(filename);
+	g_autofree gchar *text = g_strnfill(SAVE_JOURNAL_COMPACT_SIZE, 'x');
+	Textbox *textbox = textbox_new(NULL);
+	Coords pos = {30, 40};
+
+	oregano.incremental_save = TRUE;
+	schematic_set_filename(schematic, filename);
+	g_assert_true(schematic_save_file(schematic, &e));
+	g_assert_no_error(e);
+
+	// one text box is enough to take the journal past the limit
+	textbox_set_text(textbox, text);
+	item_data_set_pos(ITEM_DATA(textbox), &pos);
+	schematic_add_item(schematic, ITEM_DATA(textbox));
+	g_assert_true(schematic_save_file(schematic, &e));
+	g_assert_no_error(e);
+	g_autofree gchar *expected = get_schematic_item_keys(schematic);
+
+	// the rewrite removes the journal once it is done
+	gint64 deadline = g_get_monotonic_time() + 10 * G_TIME_SPAN_SECOND;
+	while (g_file_test(journal_filename, G_FILE_TEST_EXISTS) && g_get_monotonic_time() < deadline) {
+		if (!g_main_context_iteration(NULL, FALSE))
+			g_usleep(1000);
+	}
+	g_assert_false(g_file_test(journal_filename, G_FILE_TEST_EXISTS));
+	test_save_journal_assert_reloaded(filename, expected);
+
+	// and the journal starts over on top of the rewritten file
+	test_save_journal_edit(schematic);
+	g_assert_true(schematic_save_file(schematic, &e));
+	g_assert_no_error(e);
+	g_assert_true(g_file_test(journal_filename, G_FILE_TEST_EXISTS));
+	g_autofree gchar *edited = get_schematic_item_keys(schematic);
+	test_save_journal_assert_reloaded(filename, edited);
+
+	oregano.incremental_save = FALSE;
+	unload_test_schematic(schematic, libraries_before);
+	g_unlink(journal_filename);
+	g_unlink(filename);
+	g_rmdir(dir);
+}
+
+#endif
@@ -0,0 +1,266 @@
+/*
+ * test_sim_compare.c
+ *
+ *
+ * Authors:
+ *  Michi <st101564@stud.uni-stuttgart.de>
+ *
+ * Web page: https://ahoi.io/project/oregano
+ *
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef TEST_SIM_COMPARE_H_
+#define TEST_SIM_COMPARE_H_
+
+#include <math.h>
+#include "../src/sim-compare.h"
+#include "../src/errors.h"
+
+static void test_sim_compare_common_axis();
+static void test_sim_compare_resample();
+static void test_sim_compare_runs();
+static void test_sim_compare_async();
+static void test_sim_compare_errors();
+
+void add_funcs_test_sim_compare() {
+	g_test_add_func("/core/sim_compare/common_axis", test_sim_compare_common_axis);
+	g_test_add_func("/core/sim_compare/resample", test_sim_compare_resample);
+	g_test_add_func("/core/sim_compare/runs", test_sim_compare_runs);
+	g_test_add_func("/core/sim_compare/async", test_sim_compare_async);
+	g_test_add_func("/core/sim_compare/errors", test_sim_compare_errors);
+}
+
+/**
+ * A transient result with the columns "time", "v(in)" and "v(out)" on
+ * [0, @length], the points get denser towards the end like with an
+ * adaptive step size. v(out) is a sine of 1 kHz shifted by @offset.
+ */
+static SimulationData *test_sim_compare_sim_data_new(guint n, gdouble length, gdouble offset) {
+	SimulationData *sdat = g_new0(SimulationData, 1);
+
+	sdat->type = ANALYSIS_TYPE_TRANSIENT;
+	sdat->n_variables = 3;
+	sdat->var_names = g_new0(gchar *, 4);
+	sdat->var_names[0] = g_strdup("time");
+	sdat->var_names[1] = g_strdup("v(in)");
+	sdat->var_names[2] = g_strdup("v(out)");
+	sdat->data = g_new0(GArray *, 3);
+	for (int i = 0; i < 3; i++)
+		sdat->data[i] = g_array_sized_new(FALSE, FALSE, sizeof(gdouble), n);
+
+	for (guint i = 0; i < n; i++) {
+		gdouble s = (gdouble)i / (n - 1);
+		gdouble t = length * sqrt(s);
+		gdouble in = 1.0;
+		gdouble out = offset + sin(2 * G_PI * 1e3 * t);
+		g_array_append_val(sdat->data[0], t);
+		g_array_append_val(sdat->data[1], in);
+		g_array_append_val(sdat->data[2], out);
+	}
+
+	return sdat;
+}
+
+static void test_sim_compare_sim_data_free(SimulationData *sdat) {
+	for (int i = 0; i < sdat->n_variables; i++) {
+		g_array_free(sdat->data[i], TRUE);
+		g_free(sdat->var_names[i]);
+	}
+	g_free(sdat->data);
+	g_free(sdat->var_names);
+	g_free(sdat);
+}
+
+static void test_sim_compare_common_axis() {
+	const gdouble xa[] = {0.0, 1.0, 2.0, 3.0, 4.0};
+	const gdouble xb[] = {0.5, 1.0, 1.5, 5.0};
+	const gdouble expected[] = {0.5, 1.0, 1.5, 2.0, 3.0, 4.0};
+	gsize n;
+
+	gdouble *x = sim_compare_common_axis(xa, G_N_ELEMENTS(xa), xb, G_N_ELEMENTS(xb), &n);
+	g_assert_cmpuint(n, ==, G_N_ELEMENTS(expected));
+	for (gsize i = 0; i < n; i++)
+		g_assert_cmpfloat(x[i], ==, expected[i]);
+	g_free(x);
+
+	// no shared range
+	const gdouble xc[] = {10.0, 11.0};
+	g_assert_null(sim_compare_common_axis(xa, G_N_ELEMENTS(xa), xc, G_N_ELEMENTS(xc), &n));
+	g_assert_cmpuint(n, ==, 0);
+}
+
+static void test_sim_compare_resample() {
+	const guint n = 50, nq = 1000;
+	gdouble x[n], y[n], line[n];
+	gdouble *xq = g_new(gdouble, nq), *yq = g_new(gdouble, nq);
+	gdouble error_linear = 0.0, error_cubic = 0.0;
+
+	for (guint i = 0; i < n; i++) {
+		x[i] = 1e-3 * i / (n - 1);
+		y[i] = sin(2 * G_PI * 1e3 * x[i]);
+		line[i] = 3.0 * x[i] - 1.0;
+	}
+	for (guint k = 0; k < nq; k++)
+		xq[k] = 1e-3 * k / (nq - 1);
+
+	// a straight line comes out exact with both methods
+	sim_compare_resample(x, line, n, xq, yq, nq, SIM_COMPARE_LINEAR);
+	for (guint k = 0; k < nq; k++)
+		g_assert_cmpfloat(fabs(yq[k] - (3.0 * xq[k] - 1.0)), <, 1e-12);
+	sim_compare_resample(x, line, n, xq, yq, nq, SIM_COMPARE_CUBIC);
+	for (guint k = 0; k < nq; k++)
+		g_assert_cmpfloat(fabs(yq[k] - (3.0 * xq[k] - 1.0)), <, 1e-12);
+
+	// the spline follows a smooth curve much closer, away from the ends
+	// where the natural boundary condition does not hold for a sine
+	sim_compare_resample(x, y, n, xq, yq, nq, SIM_COMPARE_LINEAR);
+	for (guint k = nq / 10; k < nq - nq / 10; k++)
+		error_linear = MAX(error_linear, fabs(yq[k] - sin(2 * G_PI * 1e3 * xq[k])));
+	sim_compare_resample(x, y, n, xq, yq, nq, SIM_COMPARE_CUBIC);
+	for (guint k = nq / 10; k < nq - nq / 10; k++)
+		error_cubic = MAX(error_cubic, fabs(yq[k] - sin(2 * G_PI * 1e3 * xq[k])));
+	g_assert_cmpfloat(error_linear, <, 1e-2);
+	g_assert_cmpfloat(error_cubic, <, error_linear / 10);
+
+	// the sample points themselves are reproduced
+	sim_compare_resample(x, y, n, x, yq, n, SIM_COMPARE_CUBIC);
+	for (guint i = 0; i < n; i++)
+		g_assert_cmpfloat(fabs(yq[i] - y[i]), <, 1e-12);
+
+	g_free(xq);
+	g_free(yq);
+}
+
+static void test_sim_compare_assert_offset(SimCompareResult *result, gdouble offset) {
+	g_assert_nonnull(result);
+	g_assert_cmpuint(result->traces->len, ==, 2);
+	g_assert_cmpuint(result->n, >, 2000);
+
+	SimCompareTrace *in = g_ptr_array_index(result->traces, 0);
+	SimCompareTrace *out = g_ptr_array_index(result->traces, 1);
+	g_assert_cmpstr(in->name, ==, "v(in)");
+	g_assert_cmpstr(out->name, ==, "v(out)");
+
+	g_assert_cmpfloat(in->max_abs, ==, 0.0);
+	g_assert_cmpfloat(in->rms, ==, 0.0);
+
+	// the interpolation error of the spline is far below the offset
+	g_assert_cmpfloat(fabs(out->max_abs - fabs(offset)), <, 1e-3);
+	g_assert_cmpfloat(fabs(out->rms - fabs(offset)), <, 1e-3);
+	for (gsize k = 0; k < result->n; k++)
+		g_assert_cmpfloat(fabs(out->difference[k] - offset), <, 1e-3);
+}
+
+static void test_sim_compare_runs() {
+	GError *e = NULL;
+	SimulationData *reference = test_sim_compare_sim_data_new(2000, 2e-3, 0.0);
+	SimulationData *other = test_sim_compare_sim_data_new(1500, 2.5e-3, 0.1);
+	gdouble t;
+
+	// spice repeats time points around breakpoints
+	t = g_array_index(other->data[0], gdouble, 700);
+	g_array_index(other->data[0], gdouble, 701) = t;
+
+	SimCompareResult *result = sim_compare(reference, other, SIM_COMPARE_CUBIC, NULL, &e);
+	g_assert_no_error(e);
+	test_sim_compare_assert_offset(result, 0.1);
+
+	// compared on the shared range only
+	g_assert_cmpfloat(result->x[0], ==, 0.0);
+	g_assert_cmpfloat(result->x[result->n - 1], ==, 2e-3);
+	for (gsize k = 1; k < result->n; k++)
+		g_assert_cmpfloat(result->x[k], >, result->x[k - 1]);
+
+	sim_compare_result_free(result);
+	test_sim_compare_sim_data_free(reference);
+	test_sim_compare_sim_data_free(other);
+}
+
+static void test_sim_compare_async_done(GObject *source, GAsyncResult *res, gpointer user_data) {
+	GAsyncResult **result = user_data;
+	*result = g_object_ref(res);
+}
+
+static SimCompareResult *test_sim_compare_run_async(SimulationData *reference, SimulationData *other, GCancellable *cancellable, GError **error) {
+	GAsyncResult *res = NULL;
+
+	sim_compare_async(reference, other, SIM_COMPARE_CUBIC, cancellable, test_sim_compare_async_done, &res);
+	while (res == NULL)
+		g_main_context_iteration(NULL, TRUE);
+
+	SimCompareResult *result = sim_compare_finish(res, error);
+	g_object_unref(res);
+	return result;
+}
+
+static void test_sim_compare_async() {
+	GError *e = NULL;
+	SimulationData *reference = test_sim_compare_sim_data_new(4000, 2e-3, 0.0);
+	SimulationData *other = test_sim_compare_sim_data_new(3000, 2e-3, -0.2);
+
+	SimCompareResult *result = test_sim_compare_run_async(reference, other, NULL, &e);
+	g_assert_no_error(e);
+	test_sim_compare_assert_offset(result, -0.2);
+	sim_compare_result_free(result);
+
+	GCancellable *cancellable = g_cancellable_new();
+	g_cancellable_cancel(cancellable);
+	g_assert_null(test_sim_compare_run_async(reference, other, cancellable, &e));
+	g_assert_error(e, G_IO_ERROR, G_IO_ERROR_CANCELLED);
+	g_clear_error(&e);
+	g_object_unref(cancellable);
+
+	test_sim_compare_sim_data_free(reference);
+	test_sim_compare_sim_data_free(other);
+}
+
+static void test_sim_compare_errors() {
+	GError *e = NULL;
+	SimulationData *reference = test_sim_compare_sim_data_new(100, 1e-3, 0.0);
+	SimulationData *later = test_sim_compare_sim_data_new(100, 1e-3, 0.0);
+	SimulationData *renamed = test_sim_compare_sim_data_new(100, 1e-3, 0.0);
+
+	// different kind of analysis
+	later->type = ANALYSIS_TYPE_AC;
+	g_assert_null(sim_compare(reference, later, SIM_COMPARE_LINEAR, NULL, &e));
+	g_assert_error(e, OREGANO_ERROR, OREGANO_COMPARE_ERROR_MISMATCH);
+	g_clear_error(&e);
+
+	// no shared range of the x axis
+	later->type = ANALYSIS_TYPE_TRANSIENT;
+	for (guint i = 0; i < later->data[0]->len; i++)
+		g_array_index(later->data[0], gdouble, i) += 1.0;
+	g_assert_null(sim_compare(reference, later, SIM_COMPARE_LINEAR, NULL, &e));
+	g_assert_error(e, OREGANO_ERROR, OREGANO_COMPARE_ERROR_NO_OVERLAP);
+	g_clear_error(&e);
+
+	// nothing to compare
+	for (int i = 1; i < renamed->n_variables; i++) {
+		g_free(renamed->var_names[i]);
+		renamed->var_names[i] = g_strdup_printf("v(%d)", i);
+	}
+	g_assert_null(sim_compare(reference, renamed, SIM_COMPARE_LINEAR, NULL, &e));
+	g_assert_error(e, OREGANO_ERROR, OREGANO_COMPARE_ERROR_MISMATCH);
+	g_clear_error(&e);
+
+	test_sim_compare_sim_data_free(reference);
+	test_sim_compare_sim_data_free(later);
+	test_sim_compare_sim_data_free(renamed);
+}
+
+#endif
@@ -0,0 +1,207 @@
+/*
+ * test_sim_daemon.c
+ *
+ *
+ * Authors:
+ *  Michi <st101564@stud.uni-stuttgart.de>
+ *
+ * Web page: https://ahoi.io/project/oregano
+ *
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef TEST_SIM_DAEMON_H_
+#define TEST_SIM_DAEMON_H_
+
+#include <sys/wait.h>
+#include <glib/gstdio.h>
+#include <gio/gunixsocketaddress.h>
+
+#include "../src/engines/sim-daemon.h"
+#include "../src/sim-data-file.h"
+#include "../src/errors.h"
+
+#define TEST_SIM_DAEMON_SOCKET_ENV "OREGANO_TEST_SIM_DAEMON_SOCKET"
+#define TEST_SIM_DAEMON_NETLIST "* the simulator of the test does not read it\n.end\n"
+
+static void test_sim_daemon_clients();
+static void test_sim_daemon_client();
+static void test_sim_daemon_error();
+static void test_sim_daemon_oversized();
+
+void add_funcs_test_sim_daemon() {
+	g_test_add_func("/core/sim_daemon/clients", test_sim_daemon_clients);
+	g_test_add_func("/core/sim_daemon/client", test_sim_daemon_client);
+	g_test_add_func("/core/sim_daemon/error", test_sim_daemon_error);
+	g_test_add_func("/core/sim_daemon/oversized", test_sim_daemon_oversized);
+}
+
+static gchar *test_sim_daemon_get_expected_file() {
+	g_autofree gchar *test_dir = get_test_base_dir();
+	return g_strdup_printf("%s/test-files/test_engine_ngspice_watcher/basic/result/expected.txt", test_dir);
+}
+
+/**
+ * One client process. Only run as a subprocess of
+ * /core/sim_daemon/clients, which tells it where the daemon is.
+ */
+static void test_sim_daemon_client() {
+	if (!g_test_subprocess()) {
+		g_test_skip("started by /core/sim_daemon/clients");
+		return;
+	}
+
+	GError *e = NULL;
+	SimSettings *sim_settings = sim_settings_new();
+	g_autofree gchar *expected_file = test_sim_daemon_get_expected_file();
+
+	GList *actual_analysis = sim_daemon_client_run(g_getenv(TEST_SIM_DAEMON_SOCKET_ENV), TEST_SIM_DAEMON_NETLIST, sim_settings, NULL, &e);
+	g_assert_no_error(e);
+
+	// parsed by the daemon like it is parsed locally
+	GList *expected_analysis = test_engine_ngspice_parse_file(expected_file);
+	g_assert_cmpuint(g_list_length(actual_analysis), ==, g_list_length(expected_analysis));
+	for (GList *actual = actual_analysis, *expected = expected_analysis; actual; actual = actual->next, expected = expected->next)
+		assert_equal_analysis(expected, actual);
+
+	ngspice_analysis_finalize(expected_analysis);
+	sim_data_file_free_analyses(actual_analysis);
+	sim_settings_finalize(sim_settings);
+}
+
+static void test_sim_daemon_clients() {
+	GError *e = NULL;
+	g_autofree gchar *dir = g_dir_make_tmp("oregano-test-sim-daemon-XXXXXX", NULL);
+	g_autofree gchar *socket_path = g_build_filename(dir, "sim.sock", NULL);
+	g_autofree gchar *expected_file = test_sim_daemon_get_expected_file();
+	// prints the recorded output of ngspice, the netlist is appended as $0
+	const gchar *simulator[] = {"/bin/sh", "-c", "cat \"$0\"", expected_file, NULL};
+	gchar *argv[] = {"/proc/self/exe", "-q", "-p", "/core/sim_daemon/client", "--GTestSubprocess", NULL};
+	GPid clients[6];
+
+	// fewer simulators than clients, some of them have to wait
+	SimDaemon *daemon = sim_daemon_new(socket_path, 2, &e);
+	g_assert_no_error(e);
+	sim_daemon_set_simulator(daemon, simulator);
+
+	gchar **envp = g_environ_setenv(g_get_environ(), TEST_SIM_DAEMON_SOCKET_ENV, socket_path, TRUE);
+	for (int i = 0; i < G_N_ELEMENTS(clients); i++) {
+		g_spawn_async(NULL, argv, envp, G_SPAWN_DO_NOT_REAP_CHILD, NULL, NULL, &clients[i], &e);
+		g_assert_no_error(e);
+	}
+	for (int i = 0; i < G_N_ELEMENTS(clients); i++) {
+		int status;
+		waitpid(clients[i], &status, 0);
+		g_spawn_check_exit_status(status, &e);
+		g_assert_no_error(e);
+		g_spawn_close_pid(clients[i]);
+	}
+	g_strfreev(envp);
+
+	// the socket is taken
+	g_assert_null(sim_daemon_new(socket_path, 1, &e));
+	g_assert_error(e, G_IO_ERROR, G_IO_ERROR_ADDRESS_IN_USE);
+	g_clear_error(&e);
+
+	sim_daemon_free(daemon);
+	g_assert_false(g_file_test(socket_path, G_FILE_TEST_EXISTS));
+	g_rmdir(dir);
+}
+
+static void test_sim_daemon_ready(GObject *source, GAsyncResult *result, GAsyncResult **slot) {
+	*slot = g_object_ref(result);
+}
+
+static void test_sim_daemon_error() {
+	GError *e = NULL;
+	GAsyncResult *result = NULL;
+	g_autofree gchar *dir = g_dir_make_tmp("oregano-test-sim-daemon-XXXXXX", NULL);
+	g_autofree gchar *socket_path = g_build_filename(dir, "sim.sock", NULL);
+	const gchar *simulator[] = {"/bin/sh", "-c", "echo 'netlist broken' >&2; exit 1", NULL};
+	SimSettings *sim_settings = sim_settings_new();
+
+	SimDaemon *daemon = sim_daemon_new(socket_path, 1, &e);
+	g_assert_no_error(e);
+	sim_daemon_set_simulator(daemon, simulator);
+
+	// the client reports the stderr of the simulator
+	sim_daemon_client_run_async(socket_path, TEST_SIM_DAEMON_NETLIST, sim_settings, NULL, (GAsyncReadyCallback)test_sim_daemon_ready, &result);
+	while (result == NULL)
+		g_main_context_iteration(NULL, TRUE);
+	g_assert_null(sim_daemon_client_run_finish(result, &e));
+	g_assert_error(e, OREGANO_ERROR, OREGANO_SIMULATE_ERROR_ABORTED);
+	g_assert_cmpstr(e->message, ==, "netlist broken");
+	g_clear_error(&e);
+	g_object_unref(result);
+
+	sim_daemon_free(daemon);
+
+	// nobody listens anymore
+	g_assert_false(sim_daemon_client_is_available(socket_path));
+	g_assert_null(sim_daemon_client_run(socket_path, TEST_SIM_DAEMON_NETLIST, sim_settings, NULL, &e));
+	g_assert_nonnull(e);
+	g_clear_error(&e);
+
+	sim_settings_finalize(sim_settings);
+	g_rmdir(dir);
+}
+
+/**
+ * A peer that answers every connection with the start of an analysis
+ * frame of 0xffffffff bytes and then waits for the client to hang up.
+ */
+static gpointer test_sim_daemon_oversized_peer(GSocketListener *listener) {
+	// kind, length, little endian
+	const guint8 frame[] = {SIM_DAEMON_FRAME_ANALYSIS, 0, 0, 0, 0xff, 0xff, 0xff, 0xff};
+	gchar buffer[256];
+
+	GSocketConnection *connection = g_socket_listener_accept(listener, NULL, NULL, NULL);
+	g_assert_nonnull(connection);
+	g_output_stream_write_all(g_io_stream_get_output_stream(G_IO_STREAM(connection)), frame, sizeof(frame), NULL, NULL, NULL);
+	while (g_input_stream_read(g_io_stream_get_input_stream(G_IO_STREAM(connection)), buffer, sizeof(buffer), NULL, NULL) > 0)
+		;
+	g_object_unref(connection);
+	return NULL;
+}
+
+static void test_sim_daemon_oversized() {
+	GError *e = NULL;
+	g_autofree gchar *dir = g_dir_make_tmp("oregano-test-sim-daemon-XXXXXX", NULL);
+	g_autofree gchar *socket_path = g_build_filename(dir, "sim.sock", NULL);
+	GSocketAddress *address = g_unix_socket_address_new(socket_path);
+	GSocketListener *listener = g_socket_listener_new();
+	SimSettings *sim_settings = sim_settings_new();
+
+	g_socket_listener_add_address(listener, address, G_SOCKET_TYPE_STREAM, G_SOCKET_PROTOCOL_DEFAULT, NULL, NULL, &e);
+	g_assert_no_error(e);
+	GThread *peer = g_thread_new("oversized-peer", (GThreadFunc)test_sim_daemon_oversized_peer, listener);
+
+	// refused before anything is allocated
+	g_assert_null(sim_daemon_client_run(socket_path, TEST_SIM_DAEMON_NETLIST, sim_settings, NULL, &e));
+	g_assert_error(e, G_IO_ERROR, G_IO_ERROR_INVALID_DATA);
+	g_clear_error(&e);
+	g_thread_join(peer);
+
+	g_socket_listener_close(listener);
+	g_object_unref(listener);
+	g_object_unref(address);
+	sim_settings_finalize(sim_settings);
+	g_unlink(socket_path);
+	g_rmdir(dir);
+}
+
+#endif
@@ -0,0 +1,259 @@
+/*
+ * test_sim_data_export.c
+ *
+ *
+ * Authors:
+ *  Michi <st101564@stud.uni-stuttgart.de>
+ *
+ * Web page: https://ahoi.io/project/oregano
+ *
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+
+#ifndef TEST_SIM_DATA_EXPORT_H_
+#define TEST_SIM_DATA_EXPORT_H_
+
+#include <float.h>
+#include <string.h>
+#include <glib/gstdio.h>
+#include "../src/sim-data-export.h"
+#include "../src/sim-data-file.h"
+
+static void test_sim_data_export_format_double();
+static void test_sim_data_export_text();
+static void test_sim_data_export_binary();
+
+void add_funcs_test_sim_data_export() {
+	g_test_add_func("/core/sim_data_export/format_double", test_sim_data_export_format_double);
+	g_test_add_func("/core/sim_data_export/text", test_sim_data_export_text);
+	g_test_add_func("/core/sim_data_export/binary", test_sim_data_export_binary);
+}
+
+static gchar *test_sim_data_export_format(gdouble value) {
+	gchar buffer[SIM_DATA_EXPORT_DOUBLE_SIZE];
+	gchar *end = sim_data_export_format_double(buffer, value);
+
+	g_assert_cmpint(end - buffer, <, SIM_DATA_EXPORT_DOUBLE_SIZE);
+	return g_strndup(buffer, end - buffer);
+}
+
+static void test_sim_data_export_assert_round_trip(gdouble value) {
+	g_autofree gchar *text = test_sim_data_export_format(value);
+	gchar *end;
+	gdouble back = g_ascii_strtod(text, &end);
+
+	g_assert_cmpint(*end, ==, '\0');
+	g_assert_true(memcmp(&back, &value, sizeof(gdouble)) == 0);
+
+	// 15 significant digits where those come back, 17 only otherwise
+	gchar shorter[G_ASCII_DTOSTR_BUF_SIZE];
+	GString *digits = g_string_new(NULL);
+
+	for (const gchar *p = text; *p && *p != 'e'; p++)
+		if (g_ascii_isdigit(*p) && (digits->len > 0 || *p != '0'))
+			g_string_append_c(digits, *p);
+	while (digits->len > 0 && digits->str[digits->len - 1] == '0')
+		g_string_truncate(digits, digits->len - 1);
+	guint n_digits = digits->len;
+	g_string_free(digits, TRUE);
+
+	g_assert_cmpuint(n_digits, <=, 17);
+	g_ascii_formatd(shorter, sizeof(shorter), "%.14e", value);
+	if (n_digits > 15)
+		g_assert_cmpfloat(g_ascii_strtod(shorter, NULL), !=, value);
+}
+
+static void test_sim_data_export_format_double() {
+	const struct {
+		gdouble value;
+		const gchar *text;
+	} cases[] = {
+		{0.0, "0"}, {-0.0, "-0"}, {1.0, "1"}, {-2.5, "-2.5"}, {100.0, "100"},
+		{0.1, "0.1"}, {1e-6, "1e-06"}, {2.5e-5, "2.5e-05"}, {0.0001, "0.0001"},
+		{1e17, "1e+17"}, {1e100, "1e+100"}, {123456.789, "123456.789"},
+		{1.0 / 3.0, "0.33333333333333331"}, {0.1 + 0.2, "0.30000000000000004"},
+		// 15 digits half way between two doubles, read back as this one
+		{61917028402807296.0, "61917028402807300"},
+		{INFINITY, "inf"}, {-INFINITY, "-inf"}, {NAN, "nan"},
+	};
+
+	for (guint i = 0; i < G_N_ELEMENTS(cases); i++) {
+		g_autofree gchar *text = test_sim_data_export_format(cases[i].value);
+		g_assert_cmpstr(text, ==, cases[i].text);
+	}
+
+	const gdouble extremes[] = {DBL_MAX, -DBL_MAX, DBL_MIN, DBL_TRUE_MIN, DBL_EPSILON, 9007199254740993.0, 5e-324, 1.7976931348623157e308, 2.2250738585072009e-308};
+	for (guint i = 0; i < G_N_ELEMENTS(extremes); i++)
+		test_sim_data_export_assert_round_trip(extremes[i]);
+
+	// any bit pattern comes back
+	GRand *rand = g_rand_new_with_seed(99);
+	for (guint i = 0; i < 200000; i++) {
+		guint64 bits = ((guint64)g_rand_int(rand) << 32) | g_rand_int(rand);
+		gdouble value;
+
+		memcpy(&value, &bits, sizeof(value));
+		if (isnan(value) || isinf(value))
+			continue;
+		test_sim_data_export_assert_round_trip(value);
+		// and the kind of numbers a simulation produces
+		test_sim_data_export_assert_round_trip(g_rand_double_range(rand, -1.0, 1.0) * pow(10.0, g_rand_int_range(rand, -15, 6)));
+	}
+	g_rand_free(rand);
+}
+
+/**
+ * Reads the file the export wrote back and compares it with the columns
+ * of @sdat, every value has to be the very same double.
+ */
+static void test_sim_data_export_check_text(SimulationData *sdat, const gchar *filename, gchar separator, const gchar *header) {
+	g_autofree gchar *contents = NULL;
+	GError *e = NULL;
+	gchar separators[] = {separator, '\0'};
+
+	g_file_get_contents(filename, &contents, NULL, &e);
+	g_assert_no_error(e);
+
+	gchar **lines = g_strsplit(contents, "\n", -1);
+	g_assert_cmpstr(lines[0], ==, header);
+	g_assert_cmpuint(g_strv_length(lines), ==, sdat->data[0]->len + 2);
+	g_assert_cmpstr(lines[sdat->data[0]->len + 1], ==, "");
+
+	for (guint row = 0; row < sdat->data[0]->len; row++) {
+		gchar **cells = g_strsplit(lines[row + 1], separators, -1);
+
+		g_assert_cmpuint(g_strv_length(cells), ==, sdat->n_variables);
+		for (gint c = 0; c < sdat->n_variables; c++) {
+			gchar *end;
+			gdouble value = g_ascii_strtod(cells[c], &end);
+
+			g_assert_cmpint(*end, ==, '\0');
+			g_assert_cmpfloat(value, ==, g_array_index(sdat->data[c], gdouble, row));
+		}
+		g_strfreev(cells);
+	}
+	g_strfreev(lines);
+}
+
+static void test_sim_data_export_text() {
+	GError *e = NULL;
+	GList *analyses = test_result_manager_analyses_new(10000, 0.5);
+	SimulationData *sdat = SIM_DATA(analyses->data);
+	g_autofree gchar *directory = g_dir_make_tmp("oregano-test-XXXXXX", &e);
+	g_assert_no_error(e);
+	g_autofree gchar *csv = g_build_filename(directory, "results.csv", NULL);
+	g_autofree gchar *tsv = g_build_filename(directory, "results.tsv", NULL);
+
+	// quoted the CSV way
+	g_free(sdat->var_names[1]);
+	sdat->var_names[1] = g_strdup("v(\"a\",b)");
+
+	g_assert_cmpint(sim_data_export_format_from_filename(csv), ==, SIM_DATA_EXPORT_CSV);
+	g_assert_true(sim_data_export(sdat, NULL, 0, SIM_DATA_EXPORT_CSV, csv, &e));
+	g_assert_no_error(e);
+	test_sim_data_export_check_text(sdat, csv, ',', "time,\"v(\"\"a\"\",b)\"");
+
+	g_assert_cmpint(sim_data_export_format_from_filename(tsv), ==, SIM_DATA_EXPORT_TSV);
+	g_assert_true(sim_data_export(sdat, NULL, 0, SIM_DATA_EXPORT_TSV, tsv, &e));
+	g_assert_no_error(e);
+	test_sim_data_export_check_text(sdat, tsv, '\t', "time\tv(\"a\",b)");
+
+	g_unlink(csv);
+	g_unlink(tsv);
+	g_rmdir(directory);
+	sim_data_file_free_analyses(analyses);
+}
+
+static void test_sim_data_export_binary() {
+	GError *e = NULL;
+	GList *analyses = test_result_manager_analyses_new(10000, 0.0);
+	SimulationData *sdat = SIM_DATA(analyses->data);
+	g_autofree gchar *directory = g_dir_make_tmp("oregano-test-XXXXXX", &e);
+	g_assert_no_error(e);
+	g_autofree gchar *filename = g_build_filename(directory, "results.oregcol", NULL);
+	// only the second column
+	const guint columns[] = {1};
+
+	g_assert_cmpint(sim_data_export_format_from_filename(filename), ==, SIM_DATA_EXPORT_BINARY);
+	g_assert_true(sim_data_export(sdat, columns, G_N_ELEMENTS(columns), SIM_DATA_EXPORT_BINARY, filename, &e));
+	g_assert_no_error(e);
+
+	g_autofree gchar *contents = NULL;
+	gsize length;
+	g_file_get_contents(filename, &contents, &length, &e);
+	g_assert_no_error(e);
+
+	// "OREGCOL", version 1, 1 column, 10000 rows
+	const gchar *p = contents;
+	guint32 u32;
+	guint64 u64;
+	g_assert_true(memcmp(p, "OREGCOL", 8) == 0);
+	p += 8;
+	memcpy(&u32, p, 4);
+	g_assert_cmpuint(GUINT32_FROM_LE(u32), ==, SIM_DATA_EXPORT_VERSION);
+	memcpy(&u32, p + 4, 4);
+	g_assert_cmpuint(GUINT32_FROM_LE(u32), ==, 1);
+	memcpy(&u64, p + 8, 8);
+	g_assert_cmpuint(GUINT64_FROM_LE(u64), ==, 10000);
+	p += 16;
+
+	// "v(out)", "voltage"
+	memcpy(&u32, p, 4);
+	g_assert_cmpuint(GUINT32_FROM_LE(u32), ==, 6);
+	g_assert_true(memcmp(p + 4, "v(out)", 6) == 0);
+	p += 10;
+	memcpy(&u32, p, 4);
+	g_assert_cmpuint(GUINT32_FROM_LE(u32), ==, 7);
+	g_assert_true(memcmp(p + 4, "voltage", 7) == 0);
+	p += 11;
+
+	// the column starts aligned and is the column in memory
+	gsize offset = p - contents;
+	offset = (offset + 7) / 8 * 8;
+	g_assert_cmpuint(offset, ==, 48);
+	g_assert_cmpuint(length, ==, offset + 10000 * sizeof(gdouble));
+#if G_BYTE_ORDER == G_LITTLE_ENDIAN
+	g_assert_true(memcmp(contents + offset, sdat->data[1]->data, 10000 * sizeof(gdouble)) == 0);
+#endif
+
+	// no unit, only its length is written
+	g_free(sdat->var_units[1]);
+	sdat->var_units[1] = g_strdup("");
+	g_assert_true(sim_data_export(sdat, columns, G_N_ELEMENTS(columns), SIM_DATA_EXPORT_BINARY, filename, &e));
+	g_assert_no_error(e);
+	g_autofree gchar *no_unit = NULL;
+	g_file_get_contents(filename, &no_unit, &length, &e);
+	g_assert_no_error(e);
+	memcpy(&u32, no_unit + 34, 4);
+	g_assert_cmpuint(GUINT32_FROM_LE(u32), ==, 0);
+	g_assert_cmpuint(length, ==, 40 + 10000 * sizeof(gdouble));
+
+	// an invalid column is refused before the temporary file is made
+	const guint invalid[] = {0, sdat->n_variables};
+	g_autofree gchar *tmp_filename = g_strconcat(filename, ".tmp", NULL);
+	g_test_expect_message(NULL, G_LOG_LEVEL_CRITICAL, "*n_variables*");
+	g_assert_false(sim_data_export(sdat, invalid, G_N_ELEMENTS(invalid), SIM_DATA_EXPORT_BINARY, filename, NULL));
+	g_test_assert_expected_messages();
+	g_assert_false(g_file_test(tmp_filename, G_FILE_TEST_EXISTS));
+
+	g_unlink(filename);
+	g_rmdir(directory);
+	sim_data_file_free_analyses(analyses);
+}
+
+#endif
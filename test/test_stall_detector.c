@@ -0,0 +1,128 @@
+/*
+ * test_stall_detector.c
+ *
+ *
+ * Authors:
+ *  Michi <st101564@stud.uni-stuttgart.de>
+ *
+ * Web page: https://ahoi.io/project/oregano
+ *
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+
+#ifndef TEST_STALL_DETECTOR_H_
+#define TEST_STALL_DETECTOR_H_
+
+#include <string.h>
+
+#include "../src/tools/stall-detector.h"
+
+static void test_stall_detector_attribution();
+static void test_stall_detector_nesting();
+
+void add_funcs_test_stall_detector() {
+	g_test_add_func("/core/stall_detector/attribution", test_stall_detector_attribution);
+	g_test_add_func("/core/stall_detector/nesting", test_stall_detector_nesting);
+}
+
+static gboolean test_stall_detector_slow_operation(gpointer user_data) {
+	stall_detector_begin("fast operation");
+	stall_detector_end();
+
+	stall_detector_begin("slow operation");
+	g_usleep(60 * 1000);
+	stall_detector_end();
+	return G_SOURCE_REMOVE;
+}
+
+static gboolean test_stall_detector_unknown_work(gpointer user_data) {
+	g_usleep(60 * 1000);
+	return G_SOURCE_REMOVE;
+}
+
+static gboolean test_stall_detector_quit(gpointer user_data) {
+	g_main_loop_quit(user_data);
+	return G_SOURCE_REMOVE;
+}
+
+static void test_stall_detector_attribution() {
+	GMainLoop *loop = g_main_loop_new(NULL, FALSE);
+
+	stall_detector_start(20);
+
+	g_idle_add(test_stall_detector_slow_operation, NULL);
+	g_timeout_add(150, test_stall_detector_unknown_work, NULL);
+	g_timeout_add(300, test_stall_detector_quit, loop);
+	g_main_loop_run(loop);
+
+	/*
+	 * The slow operation is blamed once, the tick after it does not count
+	 * it again. A busy machine may add unattributed stalls of its own, so
+	 * only the attribution is exact.
+	 */
+	g_assert_cmpuint(stall_detector_get_stalls("slow operation"), ==, 1);
+	g_assert_cmpuint(stall_detector_get_stalls("fast operation"), ==, 0);
+	g_assert_cmpuint(stall_detector_get_stalls("(unattributed)"), >=, 1);
+	g_assert_cmpuint(stall_detector_get_stalls(NULL), >=, 2);
+
+	// which of the two is the worst depends on those extra stalls
+	g_autofree gchar *report = stall_detector_report(1);
+	g_assert_true((strstr(report, "slow operation") != NULL) != (strstr(report, "(unattributed)") != NULL));
+	g_autofree gchar *full_report = stall_detector_report(10);
+	g_assert_nonnull(strstr(full_report, "slow operation"));
+	g_assert_nonnull(strstr(full_report, "(unattributed)"));
+
+	stall_detector_stop();
+	g_assert_false(stall_detector_is_running());
+	g_main_loop_unref(loop);
+}
+
+/**
+ * No main loop runs here, so there are no ticks and every stall comes
+ * from the stack of operations.
+ */
+static void test_stall_detector_nesting() {
+	// begun before the detector ran, its end has nothing to close
+	stall_detector_begin("outer operation");
+	stall_detector_start(20);
+	stall_detector_end();
+	g_assert_cmpuint(stall_detector_get_stalls(NULL), ==, 0);
+
+	// a slow inner operation makes the outer one slow as well
+	stall_detector_begin("outer operation");
+	stall_detector_begin("quick inner operation");
+	stall_detector_end();
+	stall_detector_begin("inner operation");
+	g_usleep(30 * 1000);
+	stall_detector_end();
+	stall_detector_end();
+	g_assert_cmpuint(stall_detector_get_stalls("inner operation"), ==, 1);
+	g_assert_cmpuint(stall_detector_get_stalls("outer operation"), ==, 1);
+	g_assert_cmpuint(stall_detector_get_stalls("quick inner operation"), ==, 0);
+
+	// left open by one run, it is not ended by the next one
+	stall_detector_begin("open operation");
+	stall_detector_stop();
+	stall_detector_start(20);
+	g_usleep(30 * 1000);
+	stall_detector_end();
+	g_assert_cmpuint(stall_detector_get_stalls(NULL), ==, 0);
+	stall_detector_stop();
+}
+
+#endif
@@ -0,0 +1,117 @@
+/*
+ * test_startup_timer.c
+ *
+ *
+ * Authors:
+ *  Michi <st101564@stud.uni-stuttgart.de>
+ *
+ * Web page: https://ahoi.io/project/oregano
+ *
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+
+#ifndef TEST_STARTUP_TIMER_H_
+#define TEST_STARTUP_TIMER_H_
+
+#include <string.h>
+
+#include "../src/tools/startup-timer.h"
+
+static void test_startup_timer_phases();
+static void test_startup_timer_restart();
+
+void add_funcs_test_startup_timer() {
+	g_test_add_func("/core/startup_timer/phases", test_startup_timer_phases);
+	g_test_add_func("/core/startup_timer/restart", test_startup_timer_restart);
+}
+
+static void test_startup_timer_phases() {
+	startup_timer_start(1000);
+
+	g_usleep(20 * 1000);
+	startup_timer_mark("slow phase");
+	startup_timer_mark("fast phase");
+
+	// nothing drawn yet, which is never within the budget
+	g_assert_cmpint(startup_timer_get_time_to_first_window_ms(), ==, -1);
+	g_assert_true(startup_timer_is_over_budget());
+
+	startup_timer_first_window();
+	gint64 time = startup_timer_get_time_to_first_window_ms();
+	g_assert_cmpint(time, >=, 20);
+	g_assert_false(startup_timer_is_over_budget());
+
+	// only the first window counts
+	g_usleep(5 * 1000);
+	startup_timer_first_window();
+	g_assert_cmpint(startup_timer_get_time_to_first_window_ms(), ==, time);
+
+	startup_timer_mark("idle phase");
+
+	g_autofree gchar *report = startup_timer_report();
+	const gchar *slow = strstr(report, "slow phase");
+	const gchar *deferred = strstr(report, "Deferred");
+	g_assert_nonnull(slow);
+	g_assert_nonnull(deferred);
+	// in order, the deferred work after the first window
+	g_assert_true(slow < strstr(report, "first window drawn"));
+	g_assert_true(deferred < strstr(report, "idle phase"));
+	g_assert_null(strstr(report, "OVER BUDGET"));
+
+	startup_timer_stop();
+	g_assert_false(startup_timer_is_running());
+
+	// the same start against a budget it cannot keep
+	startup_timer_start(0);
+	g_usleep(2 * 1000);
+	startup_timer_first_window();
+	g_assert_true(startup_timer_is_over_budget());
+	g_autofree gchar *over_report = startup_timer_report();
+	g_assert_nonnull(strstr(over_report, "OVER BUDGET"));
+	startup_timer_stop();
+}
+
+static void test_startup_timer_restart() {
+	// marks without a timer are dropped, not kept for the next start
+	startup_timer_mark("before the start");
+	startup_timer_first_window();
+
+	startup_timer_start(STARTUP_TIMER_BUDGET_DEFAULT);
+	startup_timer_first_window();
+	g_assert_cmpint(startup_timer_get_time_to_first_window_ms(), >=, 0);
+	startup_timer_stop();
+
+	// a new start is a new time line, the window has to be drawn again
+	g_usleep(20 * 1000);
+	startup_timer_start(STARTUP_TIMER_BUDGET_DEFAULT);
+	g_assert_cmpint(startup_timer_get_time_to_first_window_ms(), ==, -1);
+	startup_timer_mark("early phase");
+
+	g_autofree gchar *report = startup_timer_report();
+	g_assert_nonnull(strstr(report, "early phase"));
+	g_assert_null(strstr(report, "before the start"));
+	g_assert_null(strstr(report, "first window drawn"));
+	g_assert_nonnull(strstr(report, "No window"));
+
+	// the time between the runs does not count
+	startup_timer_first_window();
+	g_assert_cmpint(startup_timer_get_time_to_first_window_ms(), <, 20);
+	startup_timer_stop();
+}
+
+#endif
@@ -0,0 +1,289 @@
+/*
+ * test_task_scheduler.c
+ *
+ *
+ * Authors:
+ *  Michi <st101564@stud.uni-stuttgart.de>
+ *
+ * Web page: https://ahoi.io/project/oregano
+ *
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef TEST_TASK_SCHEDULER_H_
+#define TEST_TASK_SCHEDULER_H_
+
+#include "../src/tools/task-scheduler.h"
+
+static void test_task_scheduler_priority();
+static void test_task_scheduler_steal();
+static void test_task_scheduler_nested_wait();
+static void test_task_scheduler_blocking();
+static void test_task_scheduler_cancel();
+static void test_task_scheduler_done_func();
+
+void add_funcs_test_task_scheduler() {
+	g_test_add_func("/core/task_scheduler/priority", test_task_scheduler_priority);
+	g_test_add_func("/core/task_scheduler/steal", test_task_scheduler_steal);
+	g_test_add_func("/core/task_scheduler/nested_wait", test_task_scheduler_nested_wait);
+	g_test_add_func("/core/task_scheduler/blocking", test_task_scheduler_blocking);
+	g_test_add_func("/core/task_scheduler/cancel", test_task_scheduler_cancel);
+	g_test_add_func("/core/task_scheduler/done_func", test_task_scheduler_done_func);
+}
+
+/**
+ * Keeps a worker busy until it is opened, so the tasks behind it queue up.
+ */
+typedef struct {
+	GMutex mutex;
+	GCond cond;
+	gboolean entered;
+	gboolean open;
+} TestTaskSchedulerGate;
+
+static void test_task_scheduler_gate_func(TestTaskSchedulerGate *gate, CancelInfo *cancel_info) {
+	g_mutex_lock(&gate->mutex);
+	gate->entered = TRUE;
+	g_cond_broadcast(&gate->cond);
+	while (!gate->open)
+		g_cond_wait(&gate->cond, &gate->mutex);
+	g_mutex_unlock(&gate->mutex);
+}
+
+static void test_task_scheduler_gate_wait_entered(TestTaskSchedulerGate *gate) {
+	g_mutex_lock(&gate->mutex);
+	while (!gate->entered)
+		g_cond_wait(&gate->cond, &gate->mutex);
+	g_mutex_unlock(&gate->mutex);
+}
+
+static void test_task_scheduler_gate_open(TestTaskSchedulerGate *gate) {
+	g_mutex_lock(&gate->mutex);
+	gate->open = TRUE;
+	g_cond_broadcast(&gate->cond);
+	g_mutex_unlock(&gate->mutex);
+}
+
+typedef struct {
+	GMutex mutex;
+	GString *order;
+} TestTaskSchedulerLog;
+
+typedef struct {
+	TestTaskSchedulerLog *log;
+	gchar name;
+} TestTaskSchedulerLogEntry;
+
+static void test_task_scheduler_log_func(TestTaskSchedulerLogEntry *entry, CancelInfo *cancel_info) {
+	g_mutex_lock(&entry->log->mutex);
+	g_string_append_c(entry->log->order, entry->name);
+	g_mutex_unlock(&entry->log->mutex);
+}
+
+static void test_task_scheduler_priority() {
+	TaskScheduler *scheduler = task_scheduler_new(1);
+	TestTaskSchedulerGate gate = {0};
+	TestTaskSchedulerLog log = {0};
+	TestTaskSchedulerLogEntry entries[] = {{&log, 'l'}, {&log, 'd'}, {&log, 'h'}, {&log, 'L'}, {&log, 'H'}};
+	const TaskPriority priorities[] = {TASK_PRIORITY_LOW, TASK_PRIORITY_DEFAULT, TASK_PRIORITY_HIGH, TASK_PRIORITY_LOW, TASK_PRIORITY_HIGH};
+	Task *tasks[G_N_ELEMENTS(entries)];
+
+	log.order = g_string_new("");
+	Task *gate_task = task_scheduler_run(scheduler, (TaskFunc)test_task_scheduler_gate_func, &gate, NULL, TASK_PRIORITY_DEFAULT);
+	test_task_scheduler_gate_wait_entered(&gate);
+
+	for (int i = 0; i < G_N_ELEMENTS(entries); i++)
+		tasks[i] = task_scheduler_run(scheduler, (TaskFunc)test_task_scheduler_log_func, &entries[i], NULL, priorities[i]);
+
+	// the only worker is busy, everything waits in the queues
+	g_assert_false(task_is_done(tasks[0]));
+
+	test_task_scheduler_gate_open(&gate);
+	for (int i = 0; i < G_N_ELEMENTS(entries); i++) {
+		task_wait(tasks[i]);
+		task_unref(tasks[i]);
+	}
+	task_wait(gate_task);
+	task_unref(gate_task);
+
+	// by priority, in order of submission within a priority
+	g_assert_cmpstr(log.order->str, ==, "hHdlL");
+
+	g_string_free(log.order, TRUE);
+	task_scheduler_free(scheduler);
+}
+
+typedef struct {
+	TaskScheduler *scheduler;
+	GMutex mutex;
+	GHashTable *threads;
+	gint sum;
+} TestTaskSchedulerSplit;
+
+static void test_task_scheduler_leaf_func(TestTaskSchedulerSplit *split, CancelInfo *cancel_info) {
+	g_mutex_lock(&split->mutex);
+	g_hash_table_add(split->threads, g_thread_self());
+	g_mutex_unlock(&split->mutex);
+
+	g_atomic_int_inc(&split->sum);
+	g_usleep(500);
+}
+
+/**
+ * Submits its children to the queue of its own worker and waits for
+ * them. The other workers only get something to do by stealing.
+ */
+static void test_task_scheduler_root_func(TestTaskSchedulerSplit *split, CancelInfo *cancel_info) {
+	Task *children[200];
+
+	for (int i = 0; i < G_N_ELEMENTS(children); i++)
+		children[i] = task_scheduler_run(split->scheduler, (TaskFunc)test_task_scheduler_leaf_func, split, NULL, TASK_PRIORITY_DEFAULT);
+	for (int i = 0; i < G_N_ELEMENTS(children); i++) {
+		task_wait(children[i]);
+		task_unref(children[i]);
+	}
+}
+
+static void test_task_scheduler_steal() {
+	TestTaskSchedulerSplit split = {0};
+
+	split.scheduler = task_scheduler_new(4);
+	g_mutex_init(&split.mutex);
+	split.threads = g_hash_table_new(NULL, NULL);
+
+	Task *root = task_scheduler_run(split.scheduler, (TaskFunc)test_task_scheduler_root_func, &split, NULL, TASK_PRIORITY_DEFAULT);
+	task_wait(root);
+	task_unref(root);
+
+	g_assert_cmpint(split.sum, ==, 200);
+	g_assert_cmpuint(g_hash_table_size(split.threads), >, 1);
+
+	g_hash_table_destroy(split.threads);
+	g_mutex_clear(&split.mutex);
+	task_scheduler_free(split.scheduler);
+}
+
+static void test_task_scheduler_nested_wait() {
+	TestTaskSchedulerSplit split = {0};
+
+	// the only worker has to run the children itself while it waits
+	split.scheduler = task_scheduler_new(1);
+	g_mutex_init(&split.mutex);
+	split.threads = g_hash_table_new(NULL, NULL);
+
+	Task *root = task_scheduler_run(split.scheduler, (TaskFunc)test_task_scheduler_root_func, &split, NULL, TASK_PRIORITY_DEFAULT);
+	task_wait(root);
+	task_unref(root);
+
+	g_assert_cmpint(split.sum, ==, 200);
+	g_assert_cmpuint(g_hash_table_size(split.threads), ==, 1);
+
+	g_hash_table_destroy(split.threads);
+	g_mutex_clear(&split.mutex);
+	task_scheduler_free(split.scheduler);
+}
+
+static void test_task_scheduler_blocking() {
+	TaskScheduler *scheduler = task_scheduler_new(1);
+	TestTaskSchedulerGate gate = {0};
+
+	// waits on a thread of its own, the worker stays free
+	Task *blocking = task_new((TaskFunc)test_task_scheduler_gate_func, &gate, NULL);
+	task_set_flags(blocking, TASK_FLAG_BLOCKING);
+	task_scheduler_submit(scheduler, task_ref(blocking));
+
+	Task *opener = task_scheduler_run(scheduler, (TaskFunc)test_task_scheduler_gate_open, &gate, NULL, TASK_PRIORITY_LOW);
+	task_wait(blocking);
+	task_wait(opener);
+	task_unref(blocking);
+	task_unref(opener);
+
+	task_scheduler_free(scheduler);
+}
+
+typedef struct {
+	gboolean saw_cancel;
+	gboolean done_canceled;
+	GThread *done_thread;
+	GMainLoop *loop;
+} TestTaskSchedulerResult;
+
+static void test_task_scheduler_check_cancel_func(TestTaskSchedulerResult *result, CancelInfo *cancel_info) {
+	result->saw_cancel = cancel_info_is_cancel(cancel_info);
+}
+
+static void test_task_scheduler_done(TestTaskSchedulerResult *result, gboolean canceled) {
+	result->done_canceled = canceled;
+	result->done_thread = g_thread_self();
+	g_main_loop_quit(result->loop);
+}
+
+static void test_task_scheduler_cancel() {
+	TaskScheduler *scheduler = task_scheduler_new(1);
+	TestTaskSchedulerGate gate = {0};
+	TestTaskSchedulerResult result = {0};
+	CancelInfo *cancel_info = cancel_info_new();
+
+	Task *gate_task = task_scheduler_run(scheduler, (TaskFunc)test_task_scheduler_gate_func, &gate, NULL, TASK_PRIORITY_DEFAULT);
+	test_task_scheduler_gate_wait_entered(&gate);
+
+	// canceled while it waits in the queue, still runs to clean up
+	Task *task = task_new((TaskFunc)test_task_scheduler_check_cancel_func, &result, NULL);
+	task_set_cancel_info(task, cancel_info);
+	task_scheduler_submit(scheduler, task_ref(task));
+	cancel_info_set_cancel(cancel_info);
+
+	test_task_scheduler_gate_open(&gate);
+	task_wait(task);
+	g_assert_true(task_is_done(task));
+	g_assert_true(result.saw_cancel);
+
+	task_unref(task);
+	task_unref(gate_task);
+	cancel_info_unsubscribe(cancel_info);
+	task_scheduler_free(scheduler);
+}
+
+static void test_task_scheduler_done_func() {
+	TaskScheduler *scheduler = task_scheduler_new(2);
+	TestTaskSchedulerResult result = {0};
+
+	result.loop = g_main_loop_new(NULL, FALSE);
+
+	Task *task = task_new((TaskFunc)test_task_scheduler_check_cancel_func, &result, NULL);
+	task_set_done_func(task, (TaskDoneFunc)test_task_scheduler_done, NULL);
+	task_scheduler_submit(scheduler, task);
+	g_main_loop_run(result.loop);
+
+	g_assert_false(result.done_canceled);
+	g_assert(result.done_thread == g_thread_self());
+
+	// a canceled task reports it to the main loop
+	task = task_new((TaskFunc)test_task_scheduler_check_cancel_func, &result, NULL);
+	task_set_done_func(task, (TaskDoneFunc)test_task_scheduler_done, NULL);
+	task_cancel(task);
+	task_scheduler_submit(scheduler, task);
+	g_main_loop_run(result.loop);
+
+	g_assert_true(result.saw_cancel);
+	g_assert_true(result.done_canceled);
+
+	g_main_loop_unref(result.loop);
+	task_scheduler_free(scheduler);
+}
+
+#endif